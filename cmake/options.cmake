@@ -83,8 +83,9 @@ OPTION(ENABLE_UNICE68 "Enable UnICE68 for Atari ST SNDH files. (GPLv3)" ON)
 # Enable libmspack-xenia for Xbox 360 executables.
 OPTION(ENABLE_LIBMSPACK "Enable libmspack-xenia for Xbox 360 executables." ON)
 
-# Enable the PowerVR Native SDK subset for PVRTC decompression.
-OPTION(ENABLE_PVRTC "Enable the PowerVR Native SDK subset for PVRTC decompression." ON)
+# Enable PVRTC decompression.
+# The PowerVR Native SDK subset is used as a reference decoder for the test suite.
+OPTION(ENABLE_PVRTC "Enable PVRTC decompression." ON)
 
 # Enable precompiled headers.
 # FIXME: Not working properly on older gcc. Use cmake-3.16.0's built-in PCH?
@@ -8,15 +8,22 @@
 
 #include "stdafx.h"
 #include "CairoImageConv.hpp"
+#include "RpCairoBackend.hpp"
 
 // C++ STL classes.
 using std::array;
 
 // librptexture
+#include "librptexture/decoder/ImageDecoder.hpp"
 using LibRpTexture::rp_image;
 
 /**
  * Convert an rp_image to cairo_surface_t.
+ *
+ * If the rp_image is ARGB32 and uses RpCairoBackend,
+ * the backend's surface is used without copying the
+ * image data.
+ *
  * @param img		[in] rp_image.
  * @param premultiply	[in] If true, premultiply. Needed for display; NOT needed for PNG.
  * @return GdkPixbuf, or nullptr on error.
@@ -27,6 +34,40 @@ cairo_surface_t *CairoImageConv::rp_image_to_cairo_surface_t(const rp_image *img
 	if (unlikely(!img || !img->isValid()))
 		return nullptr;
 
+	if (img->format() == rp_image::Format::ARGB32 &&
+	    dynamic_cast<const RpCairoBackend*>(img->backend()) != nullptr)
+	{
+		// The image data is already stored in a Cairo surface.
+		const rp_image *img_prex;
+		if (premultiply) {
+			// Premultiply a copy of the image.
+			// NOTE: dup() uses the same backend.
+			img_prex = img->dup();
+			const_cast<rp_image*>(img_prex)->premultiply();
+		} else {
+			// No premultiplication.
+			// NOTE: The surface shares its image data with
+			// the rp_image, so it must not be modified.
+			img_prex = img->ref();
+		}
+
+		const RpCairoBackend *const backend =
+			dynamic_cast<const RpCairoBackend*>(img_prex->backend());
+		assert(backend != nullptr);
+		cairo_surface_t *const surface = (backend
+			? cairo_surface_reference(backend->surface())
+			: nullptr);
+		img_prex->unref();
+		if (surface) {
+			// The image data was written directly to the surface,
+			// so Cairo must be told that it was modified.
+			cairo_surface_flush(surface);
+			cairo_surface_mark_dirty(surface);
+			return surface;
+		}
+		// Fall back to copying the image data.
+	}
+
 	// NOTE: cairo_image_surface_create_for_data() doesn't do a
 	// deep copy, so we can't use it.
 	// NOTE 2: cairo_image_surface_create() always returns a valid
@@ -100,6 +141,8 @@ cairo_surface_t *CairoImageConv::rp_image_to_cairo_surface_t(const rp_image *img
 				break;
 
 			// Premultiply the palette.
+			// NOTE: expandCI8toARGB32() requires a 256-color palette,
+			// so smaller palettes are copied even if not premultiplying.
 			std::array<uint32_t, 256> pal_prex;
 			const uint32_t *pal_toUse;
 			if (premultiply) {
@@ -111,36 +154,18 @@ cairo_surface_t *CairoImageConv::rp_image_to_cairo_surface_t(const rp_image *img
 					memset(&pal_prex[palette_len], 0, (pal_prex.size() - palette_len) * sizeof(uint32_t));
 				}
 				pal_toUse = pal_prex.data();
+			} else if (palette_len < (int)pal_prex.size()) {
+				memcpy(pal_prex.data(), palette, palette_len * sizeof(uint32_t));
+				memset(&pal_prex[palette_len], 0, (pal_prex.size() - palette_len) * sizeof(uint32_t));
+				pal_toUse = pal_prex.data();
 			} else {
 				pal_toUse = palette;
 			}
 
-			// Copy the image data.
-			const uint8_t *img_buf = static_cast<const uint8_t*>(img->bits());
-			const int dest_stride_adj = (cairo_image_surface_get_stride(surface) / sizeof(uint32_t)) - width;
-			const int src_stride_adj = img->stride() - width;
-
-			for (unsigned int y = (unsigned int)height; y > 0; y--) {
-				unsigned int x;
-				for (x = (unsigned int)width; x > 3; x -= 4) {
-					px_dest[0] = pal_toUse[img_buf[0]];
-					px_dest[1] = pal_toUse[img_buf[1]];
-					px_dest[2] = pal_toUse[img_buf[2]];
-					px_dest[3] = pal_toUse[img_buf[3]];
-					px_dest += 4;
-					img_buf += 4;
-				}
-				for (; x > 0; x--, px_dest++, img_buf++) {
-					// Last pixels.
-					*px_dest = pal_toUse[*img_buf];
-					px_dest++;
-					img_buf++;
-				}
-
-				// Next line.
-				img_buf += src_stride_adj;
-				px_dest += dest_stride_adj;
-			}
+			// Convert the image data from CI8 to ARGB32.
+			LibRpTexture::ImageDecoder::expandCI8toARGB32(px_dest, cairo_image_surface_get_stride(surface),
+				static_cast<const uint8_t*>(img->bits()), img->stride(),
+				width, height, pal_toUse);
 
 			// Mark the surface as dirty.
 			cairo_surface_mark_dirty(surface);
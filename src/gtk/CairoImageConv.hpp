@@ -10,7 +10,8 @@
 #define __ROMPROPERTIES_GTK_CAIROIMAGECONV_HPP__
 
 // NOTE: Cairo doesn't natively support 8bpp. Because of this,
-// we can't simply make a cairo_surface_t rp_image backend.
+// RpCairoBackend only uses a cairo_surface_t for ARGB32 images,
+// and CI8 images still need to be converted.
 
 #include "common.h"
 #include "librpcpu/cpu_dispatch.h"
@@ -31,6 +32,11 @@ class CairoImageConv
 	public:
 		/**
 		 * Convert an rp_image to cairo_surface_t.
+		 *
+		 * If the rp_image is ARGB32 and uses RpCairoBackend,
+		 * the backend's surface is used without copying the
+		 * image data.
+		 *
 		 * @param img		[in] rp_image.
 		 * @param premultiply	[in] If true, premultiply. Needed for display; NOT needed for PNG.
 		 * @return cairo_surface_t, or nullptr on error.
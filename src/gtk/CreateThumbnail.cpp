@@ -11,6 +11,9 @@
 // librpbase, librptexture
 using namespace LibRpBase;
 using LibRpTexture::rp_image;
+#ifdef RP_GTK_USE_CAIRO
+# include "RpCairoBackend.hpp"
+#endif /* RP_GTK_USE_CAIRO */
 
 // libromdata
 #include "libromdata/RomDataFactory.hpp"
@@ -64,6 +67,13 @@ class CreateThumbnailPrivate : public TCreateThumbnail<PIMGTYPE>
 			return rp_image_to_PIMGTYPE(img, false);
 		}
 
+		/**
+		 * Wrapper function to convert ImgClass to rp_image*.
+		 * @param imgClass ImgClass
+		 * @return rp_image (ARGB32), or nullptr on error.
+		 */
+		rp_image *imgClassToRpImage(const PIMGTYPE &imgClass) const final;
+
 		/**
 		 * Wrapper function to check if an ImgClass is valid.
 		 * @param imgClass ImgClass
@@ -122,6 +132,53 @@ class CreateThumbnailPrivate : public TCreateThumbnail<PIMGTYPE>
 CreateThumbnailPrivate::CreateThumbnailPrivate()
 { }
 
+/**
+ * Wrapper function to convert ImgClass to rp_image*.
+ * @param imgClass ImgClass
+ * @return rp_image (ARGB32), or nullptr on error.
+ */
+rp_image *CreateThumbnailPrivate::imgClassToRpImage(const PIMGTYPE &imgClass) const
+{
+	ImgSize sz;
+	getImgClassSize(imgClass, &sz);
+	if (sz.width <= 0 || sz.height <= 0)
+		return nullptr;
+
+	rp_image *const img = new rp_image(sz.width, sz.height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		img->unref();
+		return nullptr;
+	}
+
+#ifdef RP_GTK_USE_CAIRO
+	// NOTE: rpImageToImgClass() doesn't premultiply the image,
+	// so the Cairo surface can be copied as-is.
+	cairo_surface_flush(imgClass);
+	const uint8_t *pixels = cairo_image_surface_get_data(imgClass);
+	const int rowstride = cairo_image_surface_get_stride(imgClass);
+	const int row_bytes = img->row_bytes();
+	for (int y = 0; y < sz.height; y++, pixels += rowstride) {
+		memcpy(img->scanLine(y), pixels, row_bytes);
+	}
+#else /* !RP_GTK_USE_CAIRO */
+	// GdkPixbuf uses RGB or RGBA byte order.
+	const uint8_t *pixels = gdk_pixbuf_get_pixels(imgClass);
+	const int rowstride = gdk_pixbuf_get_rowstride(imgClass);
+	const bool has_alpha = !!gdk_pixbuf_get_has_alpha(imgClass);
+	const int n_channels = gdk_pixbuf_get_n_channels(imgClass);
+	for (int y = 0; y < sz.height; y++, pixels += rowstride) {
+		const uint8_t *src = pixels;
+		uint32_t *dest = static_cast<uint32_t*>(img->scanLine(y));
+		for (int x = sz.width; x > 0; x--, src += n_channels, dest++) {
+			const uint32_t a = (has_alpha ? src[3] : 0xFF);
+			*dest = (a << 24) | (src[0] << 16) | (src[1] << 8) | src[2];
+		}
+	}
+#endif /* RP_GTK_USE_CAIRO */
+
+	return img;
+}
+
 /**
  * Get the size of the specified ImgClass.
  * @param imgClass	[in] ImgClass object.
@@ -308,6 +365,12 @@ G_MODULE_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const
 	g_type_init();
 #endif
 
+#ifdef RP_GTK_USE_CAIRO
+	// Register RpCairoBackend.
+	// TODO: Static initializer somewhere?
+	rp_image::setBackendCreatorFn(RpCairoBackend::creator_fn);
+#endif /* RP_GTK_USE_CAIRO */
+
 	// NOTE: TCreateThumbnail() has wrappers for opening the
 	// ROM file and getting RomData*, but we're doing it here
 	// in order to return better error codes.
@@ -13,6 +13,7 @@
 using std::array;
 
 // librptexture
+#include "librptexture/decoder/ImageDecoder.hpp"
 using LibRpTexture::rp_image;
 
 /**
@@ -106,30 +107,10 @@ GdkPixbuf *GdkImageConv::rp_image_to_GdkPixbuf_cpp(const rp_image *img)
 				memset(&palette[src_pal_len], 0, (palette.size() - src_pal_len) * sizeof(uint32_t));
 			}
 
-			// Copy the image data.
-			const uint8_t *img_buf = static_cast<const uint8_t*>(img->bits());
-			const int src_stride_adj = img->stride() - width;
-			for (unsigned int y = (unsigned int)height; y > 0; y--) {
-				unsigned int x;
-				for (x = (unsigned int)width; x > 3; x -= 4) {
-					px_dest[0] = palette[img_buf[0]];
-					px_dest[1] = palette[img_buf[1]];
-					px_dest[2] = palette[img_buf[2]];
-					px_dest[3] = palette[img_buf[3]];
-					px_dest += 4;
-					img_buf += 4;
-				}
-				for (; x > 0; x--, px_dest++, img_buf++) {
-					// Last pixels.
-					*px_dest = palette[*img_buf];
-					px_dest++;
-					img_buf++;
-				}
-
-				// Next line.
-				img_buf += src_stride_adj;
-				px_dest += dest_stride_adj;
-			}
+			// Convert the image data from CI8 to ARGB32.
+			LibRpTexture::ImageDecoder::expandCI8toARGB32(px_dest, gdk_pixbuf_get_rowstride(pixbuf),
+				static_cast<const uint8_t*>(img->bits()), img->stride(),
+				width, height, palette.data());
 			break;
 		}
 
@@ -22,6 +22,7 @@ namespace LibRpTexture {
 #if defined(RP_CPU_I386) || defined(RP_CPU_AMD64)
 # include "librpcpu/cpuflags_x86.h"
 # define GDKIMAGECONV_HAS_SSSE3 1
+# define GDKIMAGECONV_HAS_AVX2 1
 #endif
 
 class GdkImageConv
@@ -51,6 +52,16 @@ class GdkImageConv
 		static GdkPixbuf *rp_image_to_GdkPixbuf_ssse3(const LibRpTexture::rp_image *img);
 #endif /* GDKIMAGECONV_HAS_SSSE3 */
 
+#ifdef GDKIMAGECONV_HAS_AVX2
+		/**
+		 * Convert an rp_image to GdkPixbuf.
+		 * AVX2-optimized version.
+		 * @param img	[in] rp_image.
+		 * @return GdkPixbuf, or nullptr on error.
+		 */
+		static GdkPixbuf *rp_image_to_GdkPixbuf_avx2(const LibRpTexture::rp_image *img);
+#endif /* GDKIMAGECONV_HAS_AVX2 */
+
 		/**
 		 * Convert an rp_image to GdkPixbuf.
 		 * @param img	[in] rp_image.
@@ -71,6 +82,11 @@ class GdkImageConv
  */
 inline GdkPixbuf *GdkImageConv::rp_image_to_GdkPixbuf(const LibRpTexture::rp_image *img)
 {
+#ifdef GDKIMAGECONV_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return rp_image_to_GdkPixbuf_avx2(img);
+	} else
+#endif /* GDKIMAGECONV_HAS_AVX2 */
 #ifdef GDKIMAGECONV_HAS_SSSE3
 	if (RP_CPU_HasSSSE3()) {
 		return rp_image_to_GdkPixbuf_ssse3(img);
@@ -20,6 +20,11 @@
 #include "DragImage.hpp"
 #include "MessageWidget.hpp"
 
+// Image backend
+#ifdef RP_GTK_USE_CAIRO
+# include "RpCairoBackend.hpp"
+#endif /* RP_GTK_USE_CAIRO */
+
 // librpbase, librpfile, librptexture
 #include "librpbase/TextOut.hpp"
 using namespace LibRpBase;
@@ -348,6 +353,12 @@ rom_data_view_init(RomDataView *page)
 	// Default description format type.
 	page->desc_format_type = RP_DFT_XFCE;
 
+#ifdef RP_GTK_USE_CAIRO
+	// Register RpCairoBackend.
+	// TODO: Static initializer somewhere?
+	rp_image::setBackendCreatorFn(RpCairoBackend::creator_fn);
+#endif /* RP_GTK_USE_CAIRO */
+
 	/**
 	 * Base class is:
 	 * - GTK+ 2.x: GtkVBox
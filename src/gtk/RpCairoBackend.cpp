@@ -0,0 +1,231 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (GTK+ 3.x)                         *
+ * RpCairoBackend.cpp: rp_image_backend using cairo_surface_t.             *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "RpCairoBackend.hpp"
+
+// librptexture
+using LibRpTexture::rp_image;
+using LibRpTexture::rp_image_backend;
+
+// User data key for the surface's memory buffer.
+// For shrunken surfaces, this is the original surface.
+static const cairo_user_data_key_t data_key = { 0 };
+
+RpCairoBackend::RpCairoBackend(int width, int height, rp_image::Format format)
+	: super(width, height, format)
+	, m_surface(nullptr)
+	, m_data(nullptr)
+	, m_palette(nullptr)
+{
+	if (this->width == 0 || this->height == 0) {
+		// Error initializing the backend.
+		// (Width, height, or format is probably broken.)
+		return;
+	}
+
+	switch (format) {
+		case rp_image::Format::ARGB32: {
+			// Allocate our own memory buffer.
+			// This is needed in order to use 16-byte row alignment.
+			// NOTE: Cairo requires the stride to be at least
+			// cairo_format_stride_for_width(), which is 4-byte aligned.
+			assert(this->stride >= cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, width));
+			uint8_t *const data = static_cast<uint8_t*>(aligned_malloc(16, height * this->stride));
+			if (!data) {
+				// Error allocating the memory buffer.
+				clear_properties();
+				return;
+			}
+
+			// NOTE: cairo_image_surface_create() always returns a valid
+			// pointer, but the status may be set to an error.
+			m_surface = cairo_image_surface_create_for_data(data,
+				CAIRO_FORMAT_ARGB32, width, height, this->stride);
+			if (cairo_surface_status(m_surface) != CAIRO_STATUS_SUCCESS) {
+				// Error creating the surface.
+				cairo_surface_destroy(m_surface);
+				m_surface = nullptr;
+				aligned_free(data);
+				clear_properties();
+				return;
+			}
+
+			// The surface owns the memory buffer, since it may
+			// be referenced after the rp_image is deleted.
+			if (cairo_surface_set_user_data(m_surface, &data_key, data, aligned_free) != CAIRO_STATUS_SUCCESS) {
+				// Error setting the user data.
+				cairo_surface_destroy(m_surface);
+				m_surface = nullptr;
+				aligned_free(data);
+				clear_properties();
+				return;
+			}
+			break;
+		}
+
+		case rp_image::Format::CI8: {
+			// Cairo doesn't support 8bpp indexed surfaces.
+			// Use a regular memory buffer.
+			m_data = static_cast<uint8_t*>(aligned_malloc(16, height * this->stride));
+			if (!m_data) {
+				// Error allocating the memory buffer.
+				clear_properties();
+				return;
+			}
+
+			// Palette is initialized to 0 to ensure
+			// there's no weird artifacts if the caller
+			// is converting a lower-color image.
+			const size_t palette_sz = 256*sizeof(*m_palette);
+			m_palette = static_cast<uint32_t*>(aligned_malloc(16, palette_sz));
+			if (!m_palette) {
+				// Error allocating the palette.
+				aligned_free(m_data);
+				m_data = nullptr;
+				clear_properties();
+				return;
+			}
+			memset(m_palette, 0, palette_sz);
+			break;
+		}
+
+		default:
+			assert(!"Unsupported rp_image::Format.");
+			clear_properties();
+			return;
+	}
+}
+
+RpCairoBackend::~RpCairoBackend()
+{
+	if (m_surface) {
+		cairo_surface_destroy(m_surface);
+	}
+	aligned_free(m_data);
+	aligned_free(m_palette);
+}
+
+/**
+ * Creator function for rp_image::setBackendCreatorFn().
+ */
+rp_image_backend *RpCairoBackend::creator_fn(int width, int height, rp_image::Format format)
+{
+	return new RpCairoBackend(width, height, format);
+}
+
+void *RpCairoBackend::data(void)
+{
+	// NOTE: Cairo doesn't draw to this surface until it's been
+	// handed off by CairoImageConv, so no flush is needed here.
+	if (m_surface) {
+		return cairo_image_surface_get_data(m_surface);
+	}
+	return m_data;
+}
+
+const void *RpCairoBackend::data(void) const
+{
+	if (m_surface) {
+		return cairo_image_surface_get_data(m_surface);
+	}
+	return m_data;
+}
+
+size_t RpCairoBackend::data_len(void) const
+{
+	// We're using the full stride for the last row
+	// to make it easier to manage.
+	return static_cast<size_t>(this->height) * this->stride;
+}
+
+uint32_t *RpCairoBackend::palette(void)
+{
+	return m_palette;
+}
+
+const uint32_t *RpCairoBackend::palette(void) const
+{
+	return m_palette;
+}
+
+int RpCairoBackend::palette_len(void) const
+{
+	return (m_palette ? 256 : 0);
+}
+
+/**
+ * Shrink image dimensions.
+ * @param width New width.
+ * @param height New height.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpCairoBackend::shrink(int width, int height)
+{
+	assert(width > 0);
+	assert(height > 0);
+	assert(this->width > 0);
+	assert(this->height > 0);
+	assert(width <= this->width);
+	assert(height <= this->height);
+	if (width <= 0 || height <= 0 ||
+	    this->width <= 0 || this->height <= 0 ||
+	    width > this->width || height > this->height)
+	{
+		return -EINVAL;
+	}
+
+	if (m_surface) {
+		// Cairo doesn't support changing the surface size in-place,
+		// so create a new surface using the same memory buffer.
+		cairo_surface_flush(m_surface);
+		cairo_surface_t *const newSurface = cairo_image_surface_create_for_data(
+			cairo_image_surface_get_data(m_surface),
+			CAIRO_FORMAT_ARGB32, width, height, this->stride);
+		if (cairo_surface_status(newSurface) != CAIRO_STATUS_SUCCESS) {
+			// Error creating the surface.
+			cairo_surface_destroy(newSurface);
+			return -ENOMEM;
+		}
+
+		// The new surface keeps our reference to the original
+		// surface, which owns the memory buffer.
+		if (cairo_surface_set_user_data(newSurface, &data_key, m_surface,
+			reinterpret_cast<cairo_destroy_func_t>(cairo_surface_destroy)) != CAIRO_STATUS_SUCCESS)
+		{
+			// Error setting the user data.
+			cairo_surface_destroy(newSurface);
+			return -ENOMEM;
+		}
+		m_surface = newSurface;
+	}
+
+	// We can simply reduce width/height without actually
+	// adjusting the image data.
+	this->width = width;
+	this->height = height;
+	return 0;
+}
+
+/**
+ * Get the underlying Cairo image surface.
+ *
+ * NOTE: The surface shares its pixel data with the rp_image.
+ * Call cairo_surface_reference() to keep it after the
+ * rp_image is deleted.
+ *
+ * NOTE 2: The surface is not marked as dirty. The caller must
+ * call cairo_surface_mark_dirty() before using the surface if
+ * the image data was modified through rp_image.
+ *
+ * @return Cairo image surface, or nullptr if this isn't an ARGB32 image.
+ */
+cairo_surface_t *RpCairoBackend::surface(void) const
+{
+	return m_surface;
+}
@@ -0,0 +1,89 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (GTK+ 3.x)                         *
+ * RpCairoBackend.hpp: rp_image_backend using cairo_surface_t.             *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_GTK_RPCAIROBACKEND_HPP__
+#define __ROMPROPERTIES_GTK_RPCAIROBACKEND_HPP__
+
+// librptexture
+#include "librptexture/img/rp_image_backend.hpp"
+
+// Cairo
+#include <cairo.h>
+
+/**
+ * rp_image data storage class using cairo_surface_t.
+ *
+ * ARGB32 images are stored in a Cairo image surface, so decoders
+ * write directly into the surface that will be displayed or saved.
+ * CAIRO_FORMAT_ARGB32 has the same pixel layout as rp_image's ARGB32,
+ * except Cairo expects premultiplied alpha.
+ *
+ * Cairo doesn't support 8bpp indexed surfaces, so CI8 images
+ * use a regular memory buffer and have to be converted.
+ */
+class RpCairoBackend : public LibRpTexture::rp_image_backend
+{
+	public:
+		RpCairoBackend(int width, int height, LibRpTexture::rp_image::Format format);
+		virtual ~RpCairoBackend();
+
+	private:
+		typedef LibRpTexture::rp_image_backend super;
+		RP_DISABLE_COPY(RpCairoBackend)
+
+	public:
+		/**
+		 * Creator function for rp_image::setBackendCreatorFn().
+		 */
+		static LibRpTexture::rp_image_backend *creator_fn(int width, int height, LibRpTexture::rp_image::Format format);
+
+		// Image data.
+		void *data(void) final;
+		const void *data(void) const final;
+		size_t data_len(void) const final;
+
+		// Image palette.
+		uint32_t *palette(void) final;
+		const uint32_t *palette(void) const final;
+		int palette_len(void) const final;
+
+	public:
+		/**
+		 * Shrink image dimensions.
+		 * @param width New width.
+		 * @param height New height.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int shrink(int width, int height) final;
+
+	public:
+		/**
+		 * Get the underlying Cairo image surface.
+		 *
+		 * NOTE: The surface shares its pixel data with the rp_image.
+		 * Call cairo_surface_reference() to keep it after the
+		 * rp_image is deleted.
+		 *
+		 * NOTE 2: The surface is not marked as dirty. The caller must
+		 * call cairo_surface_mark_dirty() before using the surface if
+		 * the image data was modified through rp_image.
+		 *
+		 * @return Cairo image surface, or nullptr if this isn't an ARGB32 image.
+		 */
+		cairo_surface_t *surface(void) const;
+
+	protected:
+		// ARGB32: Cairo image surface.
+		cairo_surface_t *m_surface;
+
+		// CI8: Memory buffer and palette.
+		uint8_t *m_data;
+		uint32_t *m_palette;
+};
+
+#endif /* __ROMPROPERTIES_GTK_RPCAIROBACKEND_HPP__ */
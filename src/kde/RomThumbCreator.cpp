@@ -84,6 +84,16 @@ class RomThumbCreatorPrivate : public TCreateThumbnail<QImage>
 			return rpToQImage(img);
 		}
 
+		/**
+		 * Wrapper function to convert ImgClass to rp_image*.
+		 * @param imgClass ImgClass
+		 * @return rp_image (ARGB32), or nullptr on error.
+		 */
+		inline rp_image *imgClassToRpImage(const QImage &imgClass) const final
+		{
+			return qImageToRp(imgClass);
+		}
+
 		/**
 		 * Wrapper function to check if an ImgClass is valid.
 		 * @param imgClass ImgClass
@@ -50,6 +50,34 @@ QImage rpToQImage(const rp_image *image)
 	return backend->getQImage();
 }
 
+/**
+ * Convert a QImage to rp_image.
+ * @param qImage QImage.
+ * @return rp_image (ARGB32), or nullptr on error.
+ */
+rp_image *qImageToRp(const QImage &qImage)
+{
+	if (qImage.isNull())
+		return nullptr;
+
+	// rp_image::Format::ARGB32 is equivalent to QImage::Format_ARGB32.
+	const QImage argbImage = qImage.convertToFormat(QImage::Format_ARGB32);
+	if (argbImage.isNull())
+		return nullptr;
+
+	rp_image *const img = new rp_image(argbImage.width(), argbImage.height(), rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		img->unref();
+		return nullptr;
+	}
+
+	const int row_bytes = img->row_bytes();
+	for (int y = 0; y < argbImage.height(); y++) {
+		memcpy(img->scanLine(y), argbImage.constScanLine(y), row_bytes);
+	}
+	return img;
+}
+
 /**
  * Localize a QUrl.
  * This function automatically converts certain URL schemes, e.g. desktop:/, to local paths.
@@ -80,6 +80,13 @@ static inline QString U82Q(const char *str, int len = -1)
  */
 QImage rpToQImage(const LibRpTexture::rp_image *image);
 
+/**
+ * Convert a QImage to rp_image.
+ * @param qImage QImage.
+ * @return rp_image (ARGB32), or nullptr on error.
+ */
+LibRpTexture::rp_image *qImageToRp(const QImage &qImage);
+
 /**
  * Localize a QUrl.
  * This function automatically converts certain URL schemes, e.g. desktop:/, to local paths.
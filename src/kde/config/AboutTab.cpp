@@ -317,12 +317,9 @@ void AboutTabPrivate::initLibrariesTab(void)
 	/** libpng **/
 #ifdef HAVE_PNG
 	// APNG suffix.
+	// NOTE: APNG_unref() must be called even if APNG_ref() fails.
 	const bool APNG_is_supported = (APNG_ref() == 0);
-	if (APNG_is_supported) {
-		// APNG is supported.
-		// Unreference it to prevent leaks.
-		APNG_unref();
-	}
+	APNG_unref();
 
 	const uint32_t png_version_number = png_access_version_number();
 	char pngVersion[48];
@@ -0,0 +1,317 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libcachecommon)                   *
+ * DerivedCache.cpp: Cache for data derived from local files.              *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "config.libcachecommon.h"
+#include "DerivedCache.hpp"
+#include "CacheDir.hpp"
+
+// C includes.
+#include <sys/stat.h>
+#include <sys/types.h>
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// C++ STL classes.
+#include <algorithm>
+#include <vector>
+using std::string;
+using std::vector;
+
+// OS-specific includes.
+#ifdef _WIN32
+# include "libwin32common/RpWin32_sdk.h"
+# include "libwin32common/MiniU82T.hpp"
+# include <sys/utime.h>
+using LibWin32Common::T2U8_c;
+using LibWin32Common::U82T_s;
+using LibWin32Common::U82W_s;
+using std::tstring;
+# define DIR_SEP_CHR '\\'
+#else /* !_WIN32 */
+# include <dirent.h>
+# include <unistd.h>
+# include <utime.h>
+# define DIR_SEP_CHR '/'
+#endif /* _WIN32 */
+
+namespace LibCacheCommon {
+
+/**
+ * FNV-1a hash. (64-bit)
+ * @param hash Initial hash value.
+ * @param data Data.
+ * @param len Length of data.
+ * @return Updated hash value.
+ */
+static uint64_t fnv1a_64(uint64_t hash, const void *data, size_t len)
+{
+	const uint8_t *p = static_cast<const uint8_t*>(data);
+	for (; len > 0; len--, p++) {
+		hash ^= *p;
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+/**
+ * Get a local file's identity.
+ * @param filename	[in] Local filename. (UTF-8)
+ * @param pFileId	[out] File identity.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int getFileIdentity(const char *filename, FileIdentity *pFileId)
+{
+	assert(filename != nullptr);
+	assert(pFileId != nullptr);
+	if (!filename || filename[0] == '\0' || !pFileId)
+		return -EINVAL;
+
+#ifdef _WIN32
+	// NOTE: st_ino is always 0 on Windows.
+	struct _stati64 sb;
+	if (_wstati64(U82W_s(filename).c_str(), &sb) != 0) {
+		int err = -errno;
+		return (err != 0 ? err : -EIO);
+	}
+#else /* !_WIN32 */
+	struct stat sb;
+	if (stat(filename, &sb) != 0) {
+		int err = -errno;
+		return (err != 0 ? err : -EIO);
+	}
+#endif /* _WIN32 */
+
+	// Make sure this is a regular file.
+	// Directories, device files, etc. are not cached.
+	if ((sb.st_mode & S_IFMT) != S_IFREG) {
+		return -EISDIR;
+	}
+
+	pFileId->size = static_cast<int64_t>(sb.st_size);
+	pFileId->mtime = static_cast<int64_t>(sb.st_mtime);
+	pFileId->inode = static_cast<uint64_t>(sb.st_ino);
+	pFileId->dev = static_cast<uint64_t>(sb.st_dev);
+	return 0;
+}
+
+/**
+ * Get a derived cache filename.
+ *
+ * The source file's identity is retrieved using getFileIdentity().
+ * If the source file cannot be accessed, or if the cache directory
+ * is not available, an empty string will be returned.
+ *
+ * @param subdir	[in] Cache subdirectory, e.g. "thumbs".
+ * @param filename	[in] Source filename. (UTF-8)
+ * @param variant	[in,opt] Variant data to include in the key.
+ * @param variant_len	[in] Length of variant.
+ * @param ext		[in] File extension, including the leading dot.
+ * @param pFileId	[out,opt] Source file identity.
+ * @return Cache filename, or empty string on error.
+ */
+string getDerivedCacheFilename(const char *subdir, const char *filename,
+	const void *variant, size_t variant_len, const char *ext,
+	FileIdentity *pFileId)
+{
+	assert(subdir != nullptr);
+	assert(ext != nullptr);
+	string cache_filename;
+
+	FileIdentity fileId;
+	if (getFileIdentity(filename, &fileId) != 0) {
+		// Unable to get the file identity.
+		return cache_filename;
+	}
+	if (pFileId) {
+		*pFileId = fileId;
+	}
+
+	const string &cache_dir = getCacheDirectory();
+	if (cache_dir.empty()) {
+		// Cache directory is not available.
+		return cache_filename;
+	}
+
+	// Hash the key: filename, file identity, variant data.
+	// NOTE: Fields are hashed individually to avoid struct padding.
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	hash = fnv1a_64(hash, filename, strlen(filename) + 1);
+	hash = fnv1a_64(hash, &fileId.size, sizeof(fileId.size));
+	hash = fnv1a_64(hash, &fileId.mtime, sizeof(fileId.mtime));
+	hash = fnv1a_64(hash, &fileId.inode, sizeof(fileId.inode));
+	hash = fnv1a_64(hash, &fileId.dev, sizeof(fileId.dev));
+	if (variant && variant_len > 0) {
+		hash = fnv1a_64(hash, variant, variant_len);
+	}
+
+	char hash_str[24];
+	snprintf(hash_str, sizeof(hash_str), "%08X%08X",
+		static_cast<unsigned int>(hash >> 32),
+		static_cast<unsigned int>(hash & 0xFFFFFFFFU));
+
+	cache_filename.reserve(cache_dir.size() + strlen(subdir) + 24 + strlen(ext));
+	cache_filename = cache_dir;
+	cache_filename += DIR_SEP_CHR;
+	cache_filename += subdir;
+	cache_filename += DIR_SEP_CHR;
+	cache_filename += hash_str;
+	cache_filename += ext;
+	return cache_filename;
+}
+
+/**
+ * Mark a derived cache file as recently used.
+ * This updates the file's mtime for LRU pruning.
+ * @param cache_filename Cache filename.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int touchDerivedCacheFile(const string &cache_filename)
+{
+	// nullptr == set atime and mtime to the current time.
+#ifdef _WIN32
+	int ret = _wutime(U82W_s(cache_filename).c_str(), nullptr);
+#else /* !_WIN32 */
+	int ret = utime(cache_filename.c_str(), nullptr);
+#endif /* _WIN32 */
+	if (ret != 0) {
+		int err = -errno;
+		return (err != 0 ? err : -EIO);
+	}
+	return 0;
+}
+
+/**
+ * Cache file entry for LRU pruning.
+ */
+struct CacheFileEntry {
+	string filename;	// Filename (without path)
+	int64_t size;		// File size
+	int64_t mtime;		// Last access time (mtime)
+
+	bool operator<(const CacheFileEntry &other) const
+	{
+		return (this->mtime < other.mtime);
+	}
+};
+
+/**
+ * Prune a derived cache subdirectory.
+ *
+ * If the total size of all files in the subdirectory exceeds
+ * maxSize, the least-recently-used files will be deleted until
+ * the total size is at most 3/4 of maxSize. This prevents
+ * pruning from happening every time a file is added.
+ *
+ * @param subdir	[in] Cache subdirectory, e.g. "thumbs".
+ * @param maxSize	[in] Maximum total size, in bytes.
+ * @return Number of files deleted, or negative POSIX error code on error.
+ */
+int pruneDerivedCache(const char *subdir, int64_t maxSize)
+{
+	assert(subdir != nullptr);
+	assert(maxSize > 0);
+	if (!subdir || subdir[0] == '\0' || maxSize <= 0)
+		return -EINVAL;
+
+	const string &cache_dir = getCacheDirectory();
+	if (cache_dir.empty()) {
+		// Cache directory is not available.
+		return -ENOENT;
+	}
+
+	string path = cache_dir;
+	path += DIR_SEP_CHR;
+	path += subdir;
+	path += DIR_SEP_CHR;
+
+	// Get all files in the subdirectory.
+	vector<CacheFileEntry> entries;
+	int64_t totalSize = 0;
+
+#ifdef _WIN32
+	const tstring tpath = U82T_s(path);
+	WIN32_FIND_DATA findData;
+	HANDLE hFind = FindFirstFile((tpath + _T('*')).c_str(), &findData);
+	if (hFind == INVALID_HANDLE_VALUE) {
+		// No files, or the directory doesn't exist.
+		return 0;
+	}
+	do {
+		if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+			continue;
+
+		CacheFileEntry entry;
+		entry.filename = T2U8_c(findData.cFileName);
+		entry.size = (static_cast<int64_t>(findData.nFileSizeHigh) << 32) |
+			      static_cast<int64_t>(findData.nFileSizeLow);
+		// NOTE: FILETIME is only compared, so it doesn't
+		// need to be converted to a UNIX timestamp.
+		entry.mtime = (static_cast<int64_t>(findData.ftLastWriteTime.dwHighDateTime) << 32) |
+			       static_cast<int64_t>(findData.ftLastWriteTime.dwLowDateTime);
+		totalSize += entry.size;
+		entries.push_back(std::move(entry));
+	} while (FindNextFile(hFind, &findData));
+	FindClose(hFind);
+#else /* !_WIN32 */
+	DIR *const pdir = opendir(path.c_str());
+	if (!pdir) {
+		// No files, or the directory doesn't exist.
+		return 0;
+	}
+	struct dirent *dirent;
+	while ((dirent = readdir(pdir)) != nullptr) {
+		if (dirent->d_name[0] == '.') {
+			// "." or "..", or a hidden file.
+			continue;
+		}
+
+		const string filename = path + dirent->d_name;
+		struct stat sb;
+		if (stat(filename.c_str(), &sb) != 0 || !S_ISREG(sb.st_mode))
+			continue;
+
+		CacheFileEntry entry;
+		entry.filename = dirent->d_name;
+		entry.size = static_cast<int64_t>(sb.st_size);
+		entry.mtime = static_cast<int64_t>(sb.st_mtime);
+		totalSize += entry.size;
+		entries.push_back(std::move(entry));
+	}
+	closedir(pdir);
+#endif /* _WIN32 */
+
+	if (totalSize <= maxSize) {
+		// Nothing to prune.
+		return 0;
+	}
+
+	// Delete the least-recently-used files first.
+	std::sort(entries.begin(), entries.end());
+	const int64_t targetSize = maxSize - (maxSize / 4);
+	int count = 0;
+	for (auto iter = entries.cbegin(); iter != entries.cend() && totalSize > targetSize; ++iter) {
+		const string filename = path + iter->filename;
+#ifdef _WIN32
+		const bool ok = !!DeleteFile(U82T_s(filename).c_str());
+#else /* !_WIN32 */
+		const bool ok = (unlink(filename.c_str()) == 0);
+#endif /* _WIN32 */
+		if (ok) {
+			totalSize -= iter->size;
+			count++;
+		}
+	}
+
+	return count;
+}
+
+}
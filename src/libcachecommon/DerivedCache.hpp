@@ -0,0 +1,98 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libcachecommon)                   *
+ * DerivedCache.hpp: Cache for data derived from local files.              *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBCACHECOMMON_DERIVEDCACHE_HPP__
+#define __ROMPROPERTIES_LIBCACHECOMMON_DERIVEDCACHE_HPP__
+
+// C includes.
+#include <stddef.h>
+#include <stdint.h>
+
+// C++ includes.
+#include <string>
+
+/**
+ * The derived cache stores data that was generated from a local
+ * file, e.g. rendered thumbnails, so it doesn't have to be
+ * regenerated the next time the same file is accessed.
+ *
+ * Cache files are stored in a subdirectory of the rom-properties
+ * cache directory. Filenames are a hash of the source file's
+ * identity plus caller-specified variant data, so any change
+ * to the source file results in a cache miss.
+ *
+ * Each subdirectory has a size limit. When the limit is exceeded,
+ * the least-recently-used files are deleted. Callers should update
+ * the mtime of cache files on access so LRU pruning works correctly.
+ */
+
+namespace LibCacheCommon {
+
+/**
+ * Source file identity.
+ * If any of these fields change, derived data is considered stale.
+ */
+struct FileIdentity {
+	int64_t size;		// File size
+	int64_t mtime;		// Modification time (UNIX timestamp)
+	uint64_t inode;		// Inode number (0 if not available)
+	uint64_t dev;		// Device number (0 if not available)
+};
+
+/**
+ * Get a local file's identity.
+ * @param filename	[in] Local filename. (UTF-8)
+ * @param pFileId	[out] File identity.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int getFileIdentity(const char *filename, FileIdentity *pFileId);
+
+/**
+ * Get a derived cache filename.
+ *
+ * The source file's identity is retrieved using getFileIdentity().
+ * If the source file cannot be accessed, or if the cache directory
+ * is not available, an empty string will be returned.
+ *
+ * @param subdir	[in] Cache subdirectory, e.g. "thumbs".
+ * @param filename	[in] Source filename. (UTF-8)
+ * @param variant	[in,opt] Variant data to include in the key.
+ * @param variant_len	[in] Length of variant.
+ * @param ext		[in] File extension, including the leading dot.
+ * @param pFileId	[out,opt] Source file identity.
+ * @return Cache filename, or empty string on error.
+ */
+std::string getDerivedCacheFilename(const char *subdir, const char *filename,
+	const void *variant, size_t variant_len, const char *ext,
+	FileIdentity *pFileId = nullptr);
+
+/**
+ * Mark a derived cache file as recently used.
+ * This updates the file's mtime for LRU pruning.
+ * @param cache_filename Cache filename.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int touchDerivedCacheFile(const std::string &cache_filename);
+
+/**
+ * Prune a derived cache subdirectory.
+ *
+ * If the total size of all files in the subdirectory exceeds
+ * maxSize, the least-recently-used files will be deleted until
+ * the total size is at most 3/4 of maxSize. This prevents
+ * pruning from happening every time a file is added.
+ *
+ * @param subdir	[in] Cache subdirectory, e.g. "thumbs".
+ * @param maxSize	[in] Maximum total size, in bytes.
+ * @return Number of files deleted, or negative POSIX error code on error.
+ */
+int pruneDerivedCache(const char *subdir, int64_t maxSize);
+
+}
+
+#endif /* __ROMPROPERTIES_LIBCACHECOMMON_DERIVEDCACHE_HPP__ */
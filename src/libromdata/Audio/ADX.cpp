@@ -68,6 +68,7 @@ ADX::ADX(IRpFile *file)
 {
 	RP_D(ADX);
 	d->className = "ADX";
+	d->fieldCacheable = true;
 	d->mimeType = "audio/x-adx";	// unofficial, not on fd.o
 	d->fileType = FileType::AudioFile;
 
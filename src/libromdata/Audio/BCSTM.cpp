@@ -125,6 +125,7 @@ BCSTM::BCSTM(IRpFile *file)
 {
 	RP_D(BCSTM);
 	d->className = "BCSTM";
+	d->fieldCacheable = true;
 	d->fileType = FileType::AudioFile;
 
 	if (!d->file) {
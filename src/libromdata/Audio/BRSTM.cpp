@@ -92,6 +92,7 @@ BRSTM::BRSTM(IRpFile *file)
 {
 	RP_D(BRSTM);
 	d->className = "BRSTM";
+	d->fieldCacheable = true;
 	d->mimeType = "audio/x-brstm";	// unofficial, not on fd.o
 	d->fileType = FileType::AudioFile;
 
@@ -66,6 +66,7 @@ GBS::GBS(IRpFile *file)
 {
 	RP_D(GBS);
 	d->className = "GBS";
+	d->fieldCacheable = true;
 	d->mimeType = "audio/x-gbs";	// unofficial
 	d->fileType = FileType::AudioFile;
 
@@ -66,6 +66,7 @@ NSF::NSF(IRpFile *file)
 {
 	RP_D(NSF);
 	d->className = "NSF";
+	d->fieldCacheable = true;
 	d->mimeType = "audio/x-nsf";	// unofficial
 	d->fileType = FileType::AudioFile;
 
@@ -356,6 +356,7 @@ PSF::PSF(IRpFile *file)
 {
 	RP_D(PSF);
 	d->className = "PSF";
+	d->fieldCacheable = true;
 	d->mimeType = "audio/x-psf";	// unofficial (TODO: x-minipsf?)
 	d->fileType = FileType::AudioFile;
 
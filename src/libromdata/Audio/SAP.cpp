@@ -435,6 +435,7 @@ SAP::SAP(IRpFile *file)
 {
 	RP_D(SAP);
 	d->className = "SAP";
+	d->fieldCacheable = true;
 	d->mimeType = "audio/x-sap";	// unofficial
 	d->fileType = FileType::AudioFile;
 
@@ -66,6 +66,7 @@ SID::SID(IRpFile *file)
 {
 	RP_D(SID);
 	d->className = "SID";
+	d->fieldCacheable = true;
 	d->mimeType = "audio/prs.sid";	// official
 	d->fileType = FileType::AudioFile;
 
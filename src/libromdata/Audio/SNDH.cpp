@@ -612,6 +612,7 @@ SNDH::SNDH(IRpFile *file)
 {
 	RP_D(SNDH);
 	d->className = "SNDH";
+	d->fieldCacheable = true;
 	d->mimeType = "audio/x-sndh";	// unofficial, not on fd.o
 	d->fileType = FileType::AudioFile;
 
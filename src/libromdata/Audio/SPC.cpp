@@ -499,6 +499,7 @@ SPC::SPC(IRpFile *file)
 {
 	RP_D(SPC);
 	d->className = "SPC";
+	d->fieldCacheable = true;
 	d->mimeType = "audio/x-spc";	// unofficial
 	d->fileType = FileType::AudioFile;
 
@@ -190,6 +190,7 @@ VGM::VGM(IRpFile *file)
 {
 	RP_D(VGM);
 	d->className = "VGM";
+	d->fieldCacheable = true;
 	d->mimeType = "audio/x-vgm";	// unofficial
 	d->fileType = FileType::AudioFile;
 
@@ -296,6 +296,7 @@ Dreamcast::Dreamcast(IRpFile *file)
 	// This class handles disc images.
 	RP_D(Dreamcast);
 	d->className = "Dreamcast";
+	d->fieldCacheable = true;
 	d->fileType = FileType::DiscImage;
 
 	if (!d->file) {
@@ -477,8 +477,13 @@ const rp_image *DreamcastSavePrivate::loadIcon(void)
 		(vms_header.icon_anim_speed * 100) / 30
 	};
 
+	// All icons share the same palette.
+	const uint64_t pal_hash = IconAnimData::hashData(buf.palette.u16, sizeof(buf.palette.u16));
+
 	// Load the icons. (32x32, 4bpp)
 	// Icons are stored contiguously immediately after the palette.
+	// NOTE: Repeated icons are only decoded once.
+	int seq_count = 0;
 	for (int i = 0; i < icon_count; i++) {
 		size = file->read(buf.icon_color.u8, sizeof(buf.icon_color.u8));
 		if (size != sizeof(buf.icon_color)) {
@@ -491,28 +496,29 @@ const rp_image *DreamcastSavePrivate::loadIcon(void)
 			__byte_swap_32_array(buf.icon_color.u32, sizeof(buf.icon_color.u32));
 		}
 
-		iconAnimData->delays[i] = delay;
-		iconAnimData->frames[i] = ImageDecoder::fromLinearCI4(
-			ImageDecoder::PXF_ARGB4444, true,
-			DC_VMS_ICON_W, DC_VMS_ICON_H,
-			buf.icon_color.u8, sizeof(buf.icon_color.u8),
-			buf.palette.u16, sizeof(buf.palette.u16));
-		if (!iconAnimData->frames[i])
-			break;
+		const uint64_t hash = IconAnimData::hashData(buf.icon_color.u8, sizeof(buf.icon_color.u8), pal_hash);
+		int frame = iconAnimData->findFrame(hash);
+		if (frame < 0) {
+			rp_image *const img = ImageDecoder::fromLinearCI4(
+				ImageDecoder::PXF_ARGB4444, true,
+				DC_VMS_ICON_W, DC_VMS_ICON_H,
+				buf.icon_color.u8, sizeof(buf.icon_color.u8),
+				buf.palette.u16, sizeof(buf.palette.u16));
+			if (!img)
+				break;
+			frame = iconAnimData->addFrame(img, hash);
+		}
 
 		// Icon loaded.
-		iconAnimData->count++;
+		iconAnimData->delays[i] = delay;
+		iconAnimData->seq_index[i] = static_cast<uint8_t>(frame);
+		seq_count++;
 	}
 
 	// NOTE: We're not deleting iconAnimData even if we only have
 	// a single icon because iconAnimData() will call loadIcon()
 	// if iconAnimData is nullptr.
-
-	// Set up the icon animation sequence.
-	for (int i = 0; i < iconAnimData->count; i++) {
-		iconAnimData->seq_index[i] = i;
-	}
-	iconAnimData->seq_count = iconAnimData->count;
+	iconAnimData->seq_count = seq_count;
 
 	// Return the first frame.
 	return iconAnimData->frames[0];
@@ -751,6 +757,7 @@ DreamcastSave::DreamcastSave(IRpFile *file)
 	// This class handles save files.
 	RP_D(DreamcastSave);
 	d->className = "DreamcastSave";
+	d->fieldCacheable = true;
 	d->fileType = FileType::SaveFile;
 
 	if (!d->file) {
@@ -909,6 +916,7 @@ DreamcastSave::DreamcastSave(IRpFile *vms_file, IRpFile *vmi_file)
 	// This class handles save files.
 	RP_D(DreamcastSave);
 	d->className = "DreamcastSave";
+	d->fieldCacheable = true;
 	d->fileType = FileType::SaveFile;
 
 	if (!d->file) {
@@ -660,6 +660,7 @@ GameCube::GameCube(IRpFile *file)
 	// This class handles disc images.
 	RP_D(GameCube);
 	d->className = "GameCube";
+	d->fieldCacheable = true;
 	d->fileType = FileType::DiscImage;
 
 	if (!d->file) {
@@ -1472,6 +1473,69 @@ uint32_t GameCube::imgpf(ImageType imageType) const
 	return 0;
 }
 
+/**
+ * Open the partition containing this ROM image's file system.
+ * For Wii discs, this is the game partition.
+ * NOTE: The caller must unref() the partition when done.
+ * @return New reference to the IPartition, or nullptr if this ROM image doesn't have a file system.
+ */
+IPartition *GameCube::openFstPartition(void)
+{
+	RP_D(GameCube);
+	if (!d->isValid || !d->discReader) {
+		// Unknown disc type.
+		return nullptr;
+	}
+
+	switch (d->discType & GameCubePrivate::DISC_SYSTEM_MASK) {
+		case GameCubePrivate::DISC_SYSTEM_GCN: {
+			GcnPartition *const gcnPartition = new GcnPartition(d->discReader, 0);
+			if (!gcnPartition->isOpen()) {
+				// Could not open the partition.
+				gcnPartition->unref();
+				return nullptr;
+			}
+			return gcnPartition;
+		}
+
+		case GameCubePrivate::DISC_SYSTEM_WII:
+			// Make sure the partition tables are loaded.
+			// NOTE: Standalone partitions are loaded in the constructor.
+			if (d->fileType != FileType::Partition) {
+				d->loadWiiPartitionTables();
+			}
+			if (!d->gamePartition) {
+				// No game partition.
+				return nullptr;
+			}
+			d->gamePartition->ref();
+			return d->gamePartition;
+
+		default:
+			break;
+	}
+
+	// Not supported.
+	return nullptr;
+}
+
+/**
+ * Open a reader for this ROM image's logical contents.
+ * For GCZ, CISO, NASOS, and WBFS images, this is the
+ * decompressed disc image.
+ * NOTE: The caller must unref() the reader when done.
+ * @return New reference to the IDiscReader, or nullptr if the file can be read directly.
+ */
+IDiscReader *GameCube::openDataReader(void)
+{
+	RP_D(GameCube);
+	if (!d->isValid || !d->discReader) {
+		// Unknown disc type.
+		return nullptr;
+	}
+	return d->discReader->ref();
+}
+
 /**
  * Load field data.
  * Called by RomData::fields() if the field data hasn't been loaded yet.
@@ -20,6 +20,8 @@ ROMDATA_DECL_IMGSUPPORT()
 ROMDATA_DECL_IMGPF()
 ROMDATA_DECL_IMGINT()
 ROMDATA_DECL_IMGEXT()
+ROMDATA_DECL_FSTPARTITION()
+ROMDATA_DECL_DATAREADER()
 ROMDATA_DECL_END()
 
 }
@@ -226,6 +226,7 @@ GameCubeBNR::GameCubeBNR(IRpFile *file)
 	// settings as GameCube.
 	RP_D(GameCubeBNR);
 	d->className = "GameCube";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-gamecube-bnr";	// unofficial, not on fd.o
 	d->fileType = FileType::BannerFile;
 
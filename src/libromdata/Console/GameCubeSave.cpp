@@ -357,7 +357,16 @@ const rp_image *GameCubeSavePrivate::loadIcon(void)
 	this->iconAnimData = new IconAnimData();
 	iconAnimData->count = 0;
 
+	// Hash of the shared CI8 palette.
+	uint64_t pal_CI8_shared_hash = 0;
+	if (pal_CI8_shared) {
+		pal_CI8_shared_hash = IconAnimData::hashData(pal_CI8_shared, 256*2);
+	}
+
+	// NOTE: Repeated icons are only decoded once.
+	// Each icon is identified by a hash of its source data.
 	unsigned int iconaddr_cur = 0;
+	int icon_count = 0;
 	iconfmt = direntry.iconfmt;
 	iconspeed = direntry.iconspeed;
 	for (int i = 0; i < CARD_MAXICONS; i++, iconfmt >>= 2, iconspeed >>= 2) {
@@ -374,14 +383,21 @@ const rp_image *GameCubeSavePrivate::loadIcon(void)
 		iconAnimData->delays[i].denom = 8;
 		iconAnimData->delays[i].ms = delay * 125;
 
+		const uint8_t *const pIcon = icondata.get() + iconaddr_cur;
+		int frame = -1;
 		switch (iconfmt & CARD_ICON_MASK) {
 			case CARD_ICON_RGB: {
 				// RGB5A3
 				static const unsigned int iconsize = CARD_ICON_W * CARD_ICON_H * 2;
-				iconAnimData->frames[i] = ImageDecoder::fromGcn16(ImageDecoder::PXF_RGB5A3,
-					CARD_ICON_W, CARD_ICON_H,
-					reinterpret_cast<const uint16_t*>(icondata.get() + iconaddr_cur),
-					iconsize);
+				const uint64_t hash = IconAnimData::hashData(pIcon, iconsize);
+				frame = iconAnimData->findFrame(hash);
+				if (frame < 0) {
+					frame = iconAnimData->addFrame(
+						ImageDecoder::fromGcn16(ImageDecoder::PXF_RGB5A3,
+							CARD_ICON_W, CARD_ICON_H,
+							reinterpret_cast<const uint16_t*>(pIcon), iconsize),
+						hash);
+				}
 				iconaddr_cur += iconsize;
 				break;
 			}
@@ -390,20 +406,32 @@ const rp_image *GameCubeSavePrivate::loadIcon(void)
 				// CI8 with a unique palette.
 				// Palette is located immediately after the icon.
 				static const unsigned int iconsize = CARD_ICON_W * CARD_ICON_H * 1;
-				iconAnimData->frames[i] = ImageDecoder::fromGcnCI8(
-					CARD_ICON_W, CARD_ICON_H,
-					icondata.get() + iconaddr_cur, iconsize,
-					reinterpret_cast<const uint16_t*>(icondata.get() + iconaddr_cur + iconsize), 256*2);
+				const uint8_t *const pPal = pIcon + iconsize;
+				const uint64_t hash = IconAnimData::hashData(pIcon, iconsize,
+					IconAnimData::hashData(pPal, 256*2));
+				frame = iconAnimData->findFrame(hash);
+				if (frame < 0) {
+					frame = iconAnimData->addFrame(
+						ImageDecoder::fromGcnCI8(CARD_ICON_W, CARD_ICON_H,
+							pIcon, iconsize,
+							reinterpret_cast<const uint16_t*>(pPal), 256*2),
+						hash);
+				}
 				iconaddr_cur += iconsize + (256*2);
 				break;
 			}
 
 			case CARD_ICON_CI_SHARED: {
 				static const unsigned int iconsize = CARD_ICON_W * CARD_ICON_H * 1;
-				iconAnimData->frames[i] = ImageDecoder::fromGcnCI8(
-					CARD_ICON_W, CARD_ICON_H,
-					icondata.get() + iconaddr_cur, iconsize,
-					pal_CI8_shared, 256*2);
+				const uint64_t hash = IconAnimData::hashData(pIcon, iconsize, pal_CI8_shared_hash);
+				frame = iconAnimData->findFrame(hash);
+				if (frame < 0) {
+					frame = iconAnimData->addFrame(
+						ImageDecoder::fromGcnCI8(CARD_ICON_W, CARD_ICON_H,
+							pIcon, iconsize,
+							pal_CI8_shared, 256*2),
+						hash);
+				}
 				iconaddr_cur += iconsize;
 				break;
 			}
@@ -411,11 +439,13 @@ const rp_image *GameCubeSavePrivate::loadIcon(void)
 			default:
 				// No icon.
 				// Add a nullptr as a placeholder.
-				iconAnimData->frames[i] = 0;
+				frame = iconAnimData->addFrame(nullptr, 0);
 				break;
 		}
 
-		iconAnimData->count++;
+		assert(frame >= 0);
+		iconAnimData->seq_index[i] = static_cast<uint8_t>(frame >= 0 ? frame : 0);
+		icon_count++;
 	}
 
 	// NOTE: We're not deleting iconAnimData even if we only have
@@ -423,17 +453,15 @@ const rp_image *GameCubeSavePrivate::loadIcon(void)
 	// if iconAnimData is nullptr.
 
 	// Set up the icon animation sequence.
+	// The first icon_count entries were set above.
 	// FIXME: This isn't done correctly if blank frames are present
 	// and the icon uses the "bounce" animation.
 	// 'rpcli -a' fails as a result.
-	int idx = 0;
-	for (int i = 0; i < iconAnimData->count; i++, idx++) {
-		iconAnimData->seq_index[idx] = i;
-	}
+	int idx = icon_count;
 	if (direntry.bannerfmt & CARD_ANIM_MASK) {
 		// "Bounce" the icon.
-		for (int i = iconAnimData->count-2; i > 0; i--, idx++) {
-			iconAnimData->seq_index[idx] = i;
+		for (int i = icon_count-2; i > 0; i--, idx++) {
+			iconAnimData->seq_index[idx] = iconAnimData->seq_index[i];
 			iconAnimData->delays[idx] = iconAnimData->delays[i];
 		}
 	}
@@ -527,6 +555,7 @@ GameCubeSave::GameCubeSave(IRpFile *file)
 	// This class handles save files.
 	RP_D(GameCubeSave);
 	d->className = "GameCubeSave";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-gamecube-save";	// unofficial, not on fd.o
 	d->fileType = FileType::SaveFile;
 
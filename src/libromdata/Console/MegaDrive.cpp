@@ -14,8 +14,10 @@
 #include "MegaDriveRegions.hpp"
 #include "CopierFormats.h"
 #include "utils/SuperMagicDrive.hpp"
+#include "utils/SmdFile.hpp"
 
 // librpbase, librpfile
+#include "librpbase/disc/DiscReader.hpp"
 using namespace LibRpBase;
 using LibRpFile::IRpFile;
 
@@ -524,6 +526,7 @@ MegaDrive::MegaDrive(IRpFile *file)
 {
 	RP_D(MegaDrive);
 	d->className = "MegaDrive";
+	d->fieldCacheable = true;
 
 	if (!d->file) {
 		// Could not ref() the file handle.
@@ -1018,4 +1021,37 @@ int MegaDrive::loadFieldData(void)
 	return static_cast<int>(d->fields->count());
 }
 
+/**
+ * Open a reader for this ROM image's logical contents.
+ * For SMD-format ROMs, this is the deinterleaved binary ROM image.
+ * NOTE: The caller must unref() the reader when done.
+ * @return New reference to the IDiscReader, or nullptr if the file can be read directly.
+ */
+IDiscReader *MegaDrive::openDataReader(void)
+{
+	RP_D(MegaDrive);
+	if (!d->isValid || !d->file ||
+	    (d->romType & MegaDrivePrivate::ROM_FORMAT_MASK) != MegaDrivePrivate::ROM_FORMAT_CART_SMD)
+	{
+		// Not an SMD-format ROM.
+		return nullptr;
+	}
+
+	SmdFile *const smdFile = new SmdFile(d->file);
+	if (!smdFile->isOpen()) {
+		// Unable to open the SMD file.
+		smdFile->unref();
+		return nullptr;
+	}
+
+	DiscReader *const discReader = new DiscReader(smdFile);
+	smdFile->unref();	// smdFile is ref()'d by DiscReader.
+	if (!discReader->isOpen()) {
+		// Unable to open the DiscReader.
+		discReader->unref();
+		return nullptr;
+	}
+	return discReader;
+}
+
 }
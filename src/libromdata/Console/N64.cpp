@@ -81,6 +81,7 @@ N64::N64(IRpFile *file)
 {
 	RP_D(N64);
 	d->className = "N64";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-n64-rom";	// unofficial
 
 	if (!d->file) {
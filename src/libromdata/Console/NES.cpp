@@ -172,6 +172,7 @@ NES::NES(IRpFile *file)
 {
 	RP_D(NES);
 	d->className = "NES";
+	d->fieldCacheable = true;
 
 	if (!d->file) {
 		// Could not ref() the file handle.
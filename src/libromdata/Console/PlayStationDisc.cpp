@@ -318,6 +318,7 @@ PlayStationDisc::PlayStationDisc(IRpFile *file)
 	// This class handles disc images.
 	RP_D(PlayStationDisc);
 	d->className = "PlayStationDisc";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-cd-image";	// unofficial
 	d->fileType = FileType::DiscImage;
 
@@ -653,6 +654,23 @@ const char *const *PlayStationDisc::supportedMimeTypes_static(void)
 	return mimeTypes;
 }
 
+/**
+ * Open the partition containing this ROM image's file system.
+ * NOTE: The caller must unref() the partition when done.
+ * @return New reference to the IPartition, or nullptr if this ROM image doesn't have a file system.
+ */
+IPartition *PlayStationDisc::openFstPartition(void)
+{
+	RP_D(PlayStationDisc);
+	if (!d->isoPartition || !d->isoPartition->isOpen()) {
+		// ISO partition isn't open.
+		return nullptr;
+	}
+
+	d->isoPartition->ref();
+	return d->isoPartition;
+}
+
 /**
  * Load field data.
  * Called by RomData::fields() if the field data hasn't been loaded yet.
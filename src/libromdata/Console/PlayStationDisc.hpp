@@ -27,6 +27,7 @@ ROMDATA_DECL_CLOSE()
 			const ISO_Primary_Volume_Descriptor *pvd);
 
 ROMDATA_DECL_METADATA()
+ROMDATA_DECL_FSTPARTITION()
 ROMDATA_DECL_END()
 
 }
@@ -70,6 +70,7 @@ PlayStationEXE::PlayStationEXE(IRpFile *file)
 	// This class handles executables.
 	RP_D(PlayStationEXE);
 	d->className = "PlayStationEXE";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-ps1-executable";	// unofficial, not on fd.o
 	d->fileType = FileType::Executable;
 
@@ -101,6 +102,7 @@ PlayStationEXE::PlayStationEXE(IRpFile *file, uint32_t sp_override)
 	// This class handles executables.
 	RP_D(PlayStationEXE);
 	d->className = "PlayStationEXE";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-ps1-executable";	// unofficial, not on fd.o
 	d->fileType = FileType::Executable;
 
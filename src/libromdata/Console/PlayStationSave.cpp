@@ -190,6 +190,7 @@ PlayStationSave::PlayStationSave(IRpFile *file)
 	// This class handles save files.
 	RP_D(PlayStationSave);
 	d->className = "PlayStationSave";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-ps1-save";	// unofficial, not on fd.o
 	d->fileType = FileType::SaveFile;
 
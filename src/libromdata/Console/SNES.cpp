@@ -723,6 +723,7 @@ SNES::SNES(IRpFile *file)
 {
 	RP_D(SNES);
 	d->className = "SNES";
+	d->fieldCacheable = true;
 	d->mimeType = "application/vnd.nintendo.snes.rom";	// vendor-specific
 
 	if (!d->file) {
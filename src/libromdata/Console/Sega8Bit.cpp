@@ -200,6 +200,7 @@ Sega8Bit::Sega8Bit(IRpFile *file)
 {
 	RP_D(Sega8Bit);
 	d->className = "Sega8Bit";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-sms-rom";	// unofficial (TODO: SMS vs. GG)
 
 	if (!d->file) {
@@ -305,6 +305,7 @@ SegaSaturn::SegaSaturn(IRpFile *file)
 	// This class handles disc images.
 	RP_D(SegaSaturn);
 	d->className = "SegaSaturn";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-saturn-rom";	// unofficial
 	d->fileType = FileType::DiscImage;
 
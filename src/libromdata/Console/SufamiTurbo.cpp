@@ -127,6 +127,7 @@ SufamiTurbo::SufamiTurbo(IRpFile *file)
 	RP_D(SufamiTurbo);
 	// NOTE: Handling Sufami Turbo ROMs as if they're Super NES.
 	d->className = "SNES";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-sufami-turbo-rom";	// unofficial, not on fd.o
 
 	if (!d->file) {
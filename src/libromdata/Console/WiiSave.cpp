@@ -128,6 +128,7 @@ WiiSave::WiiSave(IRpFile *file)
 	// This class handles application packages.
 	RP_D(WiiSave);
 	d->className = "WiiSave";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-wii-save";	// unofficial, not on fd.o
 	d->fileType = FileType::SaveFile;
 
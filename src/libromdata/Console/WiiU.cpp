@@ -99,6 +99,7 @@ WiiU::WiiU(IRpFile *file)
 	// This class handles disc images.
 	RP_D(WiiU);
 	d->className = "WiiU";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-wii-u-rom";	// unofficial, not on fd.o
 	d->fileType = FileType::DiscImage;
 
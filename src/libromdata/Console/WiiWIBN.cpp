@@ -231,6 +231,7 @@ WiiWIBN::WiiWIBN(IRpFile *file)
 	// settings as WiiSave.
 	RP_D(WiiWIBN);
 	d->className = "WiiSave";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-wii-wibn";	// unofficial, not on fd.o
 	d->fileType = FileType::BannerFile;
 
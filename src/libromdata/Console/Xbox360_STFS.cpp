@@ -17,9 +17,11 @@
 #include "xbox360_xdbf_structs.h"
 #include "data/XboxLanguage.hpp"
 
+// STFS file reader.
+#include "disc/StfsReader.hpp"
+
 // librpbase, librpfile, librptexture
 #include "librpbase/img/RpPng.hpp"
-#include "librpbase/disc/DiscReader.hpp"
 #include "librpbase/disc/PartitionFile.hpp"
 #include "librpfile/RpMemFile.hpp"
 using namespace LibRpBase;
@@ -104,38 +106,12 @@ class Xbox360_STFS_Private final : public RomDataPrivate
 
 	public:
 		// XEX executable.
-		DiscReader *xexReader;
+		StfsReader *xexReader;
 		Xbox360_XEX *xex;
 
 		// File table.
 		ao::uvector<STFS_DirEntry_t> fileTable;
 
-		/**
-		 * Convert a block number to an offset.
-		 * @param blockNumber Block number.
-		 * @return Offset, or -1 on error.
-		 */
-		inline int32_t blockNumberToOffset(int blockNumber)
-		{
-			// Reference: https://github.com/Free60Project/wiki/blob/master/STFS.md
-			int ret;
-			if (blockNumber > 0xFFFFFF) {
-				ret = -1;
-			} else {
-				ret = (((be32_to_cpu(stfsMetadata.header_size) + 0xFFF) & 0xF000) +
-				        (blockNumber * STFS_BLOCK_SIZE));
-			}
-			return ret;
-		}
-
-		/**
-		 * Convert a data block number to a physical block number.
-		 * Data block numbers don't include hash blocks.
-		 * @param dataBlockNumber Data block number.
-		 * @return physBlockNumber Physical block number.
-		 */
-		int32_t dataBlockNumberToPhys(int dataBlockNumber);
-
 		/**
 		 * Load the file table.
 		 * @return 0 on success; negative POSIX error code on error.
@@ -317,53 +293,8 @@ int Xbox360_STFS_Private::loadHeader(unsigned int header)
 		if (ret == 0) {
 			ret = -EIO;
 		}
-	}
-
-	return ret;
-}
-
-/**
- * Convert a data block number to a physical block number.
- * Data block numbers don't include hash blocks.
- * @param dataBlockNumber Data block number.
- * @return physBlockNumber Physical block number.
- */
-int32_t Xbox360_STFS_Private::dataBlockNumberToPhys(int dataBlockNumber)
-{
-	// Reference: https://github.com/Free60Project/wiki/blob/master/STFS.md
-	int blockShift;
-	if (((be32_to_cpu(stfsMetadata.header_size) + 0xFFF) & 0xF000) == 0xB000) {
-		blockShift = 1;
 	} else {
-		if ((stfsMetadata.stfs_desc.block_separation & 1) == 1) {
-			blockShift = 0;
-		} else {
-			blockShift = 1;
-		}
-	}
-
-	int32_t base = ((dataBlockNumber + 0xAA) / 0xAA);
-	if (stfsType == StfsType::CON) {
-		base <<= blockShift;
-	}
-
-	int32_t ret = (base + dataBlockNumber);
-	if (dataBlockNumber > 0xAA) {
-		base = ((dataBlockNumber + 0x70E4) / 0x70E4);
-		if (stfsType == StfsType::CON) {
-			base <<= blockShift;
-		}
-		ret += base;
-
-		if (dataBlockNumber > 0x70E4) {
-			base = ((dataBlockNumber + 0x4AF768) / 0x4AF768);
-			// FIXME: Originally compared magic to blockShift,
-			// which doesn't make sense...
-			if (stfsType == StfsType::CON) {
-				base <<= blockShift;
-			}
-			ret += base;
-		}
+		headers_loaded |= header;
 	}
 
 	return ret;
@@ -406,20 +337,23 @@ int Xbox360_STFS_Private::loadFileTable(void)
 		(stfsMetadata.stfs_desc.file_table_block_number[0] << 16) |
 		(stfsMetadata.stfs_desc.file_table_block_number[1] <<  8) |
 		 stfsMetadata.stfs_desc.file_table_block_number[2];
-	const int32_t offset = blockNumberToOffset(dataBlockNumberToPhys(blockNumber));
-	if (offset < 0) {
-		// Invalid block number.
-		return -EIO;
-	}
 
 	// Load the file table.
-	size_t fileTableSize = ((uint32_t)blockCount * STFS_BLOCK_SIZE);
-	assert(fileTableSize % sizeof(STFS_DirEntry_t) == 0);
-	if (fileTableSize % sizeof(STFS_DirEntry_t) != 0) {
-		fileTableSize += sizeof(STFS_DirEntry_t);
+	// NOTE: The file table blocks aren't necessarily consecutive,
+	// so StfsReader follows the block chain in the hash tables.
+	const size_t fileTableSize = ((uint32_t)blockCount * STFS_BLOCK_SIZE);
+	static_assert(STFS_BLOCK_SIZE % sizeof(STFS_DirEntry_t) == 0,
+		"STFS_BLOCK_SIZE is not a multiple of sizeof(STFS_DirEntry_t).");
+	StfsReader *const ftReader = new StfsReader(this->file, &stfsMetadata,
+		(stfsType == StfsType::CON), blockNumber, blockCount, fileTableSize, false);
+	if (!ftReader->isOpen()) {
+		// Unable to resolve the file table blocks.
+		ftReader->unref();
+		return -EIO;
 	}
 	fileTable.resize(fileTableSize / sizeof(STFS_DirEntry_t));
-	size_t size = file->seekAndRead(offset, fileTable.data(), fileTableSize);
+	size_t size = ftReader->seekAndRead(0, fileTable.data(), fileTableSize);
+	ftReader->unref();
 	if (size != fileTableSize) {
 		// Seek and/or read error.
 		fileTable.clear();
@@ -461,7 +395,7 @@ Xbox360_XEX *Xbox360_STFS_Private::openDefaultXex(void)
 	const auto fileTable_cend = fileTable.cend();
 	for (auto iter = fileTable.cbegin(); iter != fileTable_cend; ++iter) {
 		// Make sure this isn't a subdirectory.
-		if (iter->flags_len & 0x80) {
+		if (iter->flags_len & STFS_DIRENTRY_FLAG_DIRECTORY) {
 			// It's a subdirectory.
 			continue;
 		}
@@ -497,21 +431,31 @@ Xbox360_XEX *Xbox360_STFS_Private::openDefaultXex(void)
 		return nullptr;
 	}
 
-	// Offset and filesize.
-	// NOTE: Block number is **little-endian** here.
+	// Block number, block count, and filesize.
+	// NOTE: Block numbers are **little-endian** here.
 	const int32_t blockNumber =
 		(dirEntry->block_number[2] << 16) |
 		(dirEntry->block_number[1] <<  8) |
 		 dirEntry->block_number[0];
-	const int32_t offset = blockNumberToOffset(dataBlockNumberToPhys(blockNumber));
+	int32_t blockCount =
+		(dirEntry->blocks[2] << 16) |
+		(dirEntry->blocks[1] <<  8) |
+		 dirEntry->blocks[0];
 	const uint32_t filesize = be32_to_cpu(dirEntry->filesize);
+	const int32_t blockCount_min = static_cast<int32_t>(
+		(static_cast<off64_t>(filesize) + STFS_BLOCK_SIZE - 1) / STFS_BLOCK_SIZE);
+	if (blockCount < blockCount_min) {
+		blockCount = blockCount_min;
+	}
 
 	// Load default.xexp.
-	// FIXME: Maybe add a reader class to handle the hashes,
-	// though we only need the XEX header right now.
-	DiscReader *discReader = new DiscReader(this->file);
+	// StfsReader resolves the data blocks using the hash tables
+	// and reads contiguous blocks all at once.
+	StfsReader *discReader = new StfsReader(this->file, &stfsMetadata,
+		(stfsType == StfsType::CON), blockNumber, blockCount, filesize,
+		!!(dirEntry->flags_len & STFS_DIRENTRY_FLAG_CONSECUTIVE));
 	if (discReader->isOpen()) {
-		PartitionFile *const xexFile_tmp = new PartitionFile(discReader, offset, filesize);
+		PartitionFile *const xexFile_tmp = new PartitionFile(discReader, 0, filesize);
 		if (xexFile_tmp->isOpen()) {
 			Xbox360_XEX *const xex_tmp = new Xbox360_XEX(xexFile_tmp);
 			if (xex_tmp->isOpen()) {
@@ -552,6 +496,7 @@ Xbox360_STFS::Xbox360_STFS(IRpFile *file)
 	// TODO: Change to Save File if the content is a save file.
 	RP_D(Xbox360_STFS);
 	d->className = "Xbox360_STFS";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-xbox360-stfs";	// unofficial, not on fd.o
 	d->fileType = FileType::ApplicationPackage;
 
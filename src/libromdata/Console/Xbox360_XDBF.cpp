@@ -1150,6 +1150,7 @@ Xbox360_XDBF::Xbox360_XDBF(IRpFile *file)
 	// This class handles XDBF files and/or sections only.
 	RP_D(Xbox360_XDBF);
 	d->className = "Xbox360_XEX";	// Using the same image settings as Xbox360_XEX.
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-xbox360-xdbf";	// unofficial, not on fd.o
 	d->fileType = FileType::ResourceFile;
 
@@ -1181,6 +1182,7 @@ Xbox360_XDBF::Xbox360_XDBF(IRpFile *file, bool xex)
 	// This class handles XDBF files and/or sections only.
 	RP_D(Xbox360_XDBF);
 	d->className = "Xbox360_XEX";	// Using the same image settings as Xbox360_XEX.
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-xbox360-xdbf";	// unofficial, not on fd.o
 	d->fileType = FileType::ResourceFile;
 
@@ -1323,6 +1323,7 @@ Xbox360_XEX::Xbox360_XEX(IRpFile *file)
 	// This class handles executables.
 	RP_D(Xbox360_XEX);
 	d->className = "Xbox360_XEX";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-xbox360-executable";	// unofficial, not on fd.o
 	d->fileType = FileType::Executable;
 
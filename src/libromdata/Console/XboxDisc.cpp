@@ -292,6 +292,7 @@ XboxDisc::XboxDisc(IRpFile *file)
 	// This class handles disc images.
 	RP_D(XboxDisc);
 	d->className = "XboxDisc";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-cd-image";	// unofficial
 	d->fileType = FileType::DiscImage;
 
@@ -686,6 +687,23 @@ uint32_t XboxDisc::imgpf(ImageType imageType) const
 	return 0;
 }
 
+/**
+ * Open the partition containing this ROM image's file system.
+ * NOTE: The caller must unref() the partition when done.
+ * @return New reference to the IPartition, or nullptr if this ROM image doesn't have a file system.
+ */
+IPartition *XboxDisc::openFstPartition(void)
+{
+	RP_D(XboxDisc);
+	if (!d->xdvdfsPartition || !d->xdvdfsPartition->isOpen()) {
+		// XDVDFS partition isn't open.
+		return nullptr;
+	}
+
+	d->xdvdfsPartition->ref();
+	return d->xdvdfsPartition;
+}
+
 /**
  * Load field data.
  * Called by RomData::fields() if the field data hasn't been loaded yet.
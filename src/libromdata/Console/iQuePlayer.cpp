@@ -376,6 +376,7 @@ iQuePlayer::iQuePlayer(IRpFile *file)
 {
 	RP_D(iQuePlayer);
 	d->className = "iQuePlayer";
+	d->fieldCacheable = true;
 	d->fileType = FileType::MetadataFile;
 
 	if (!d->file) {
@@ -256,12 +256,50 @@ typedef enum {
 	STFS_TRANSFER_FLAG_BIT_PROFILE_TRANSFER		= (1U << 7),
 } STFS_Transfer_Flags_e;
 
+/**
+ * STFS: Hash table entry.
+ * Each hash table block has 0xAA entries.
+ *
+ * For level 0 tables, each entry describes a data block.
+ * For level 1 and 2 tables, each entry describes a lower-level
+ * hash table block.
+ *
+ * All fields are in big-endian.
+ */
+#define STFS_HASH_ENTRIES_PER_BLOCK 0xAA
+typedef struct _STFS_Hash_Entry {
+	uint8_t sha1[0x14];		// [0x000] SHA-1 hash of the block
+	uint8_t status;			// [0x014] Status (See STFS_Hash_Status_e)
+	uint8_t next_block[3];		// [0x015] Next data block number (BE24; level 0 only)
+} STFS_Hash_Entry;
+ASSERT_STRUCT(STFS_Hash_Entry, 0x18);
+
+/**
+ * STFS: Hash table entry status.
+ */
+typedef enum {
+	// For level 1 and 2 entries: If set, the lower-level
+	// hash table is stored in the second block of the pair.
+	// (CON packages only)
+	STFS_HASH_STATUS_ALT_TABLE	= 0x40,
+} STFS_Hash_Status_e;
+
+/**
+ * STFS: Hash table block.
+ * All fields are in big-endian.
+ */
+typedef struct _STFS_Hash_Table {
+	STFS_Hash_Entry entries[STFS_HASH_ENTRIES_PER_BLOCK];	// [0x000]
+	uint8_t padding[0x10];					// [0xFF0]
+} STFS_Hash_Table;
+ASSERT_STRUCT(STFS_Hash_Table, STFS_BLOCK_SIZE);
+
 /**
  * STFS: Directory entry.
  */
 typedef struct _STFS_DirEntry_t {
 	char filename[0x28];		// [0x000] Filename, NULL-terminated.
-	uint8_t flags_len;		// [0x028] Flags, plus filename length. (mask with 0x3F)
+	uint8_t flags_len;		// [0x028] Flags, plus filename length. (mask with 0x3F; see STFS_DirEntry_Flags_e)
 	uint8_t blocks[3];		// [0x029] Blocks. (LE24)
 	uint8_t blocks2[3];		// [0x02B] Copy of blocks. (LE24)
 	uint8_t block_number[3];	// [0x02F] Starting block number. (LE24)
@@ -272,6 +310,14 @@ typedef struct _STFS_DirEntry_t {
 } STFS_DirEntry_t;
 ASSERT_STRUCT(STFS_DirEntry_t, 0x40);
 
+/**
+ * STFS: Directory entry flags. (stored in flags_len)
+ */
+typedef enum {
+	STFS_DIRENTRY_FLAG_CONSECUTIVE	= 0x40,	// Data blocks are consecutive.
+	STFS_DIRENTRY_FLAG_DIRECTORY	= 0x80,	// Entry is a subdirectory.
+} STFS_DirEntry_Flags_e;
+
 #ifdef __cplusplus
 }
 #endif
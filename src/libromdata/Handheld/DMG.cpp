@@ -543,6 +543,7 @@ DMG::DMG(IRpFile *file)
 {
 	RP_D(DMG);
 	d->className = "DMG";
+	d->fieldCacheable = true;
 
 	if (!d->file) {
 		// Could not ref() the file handle.
@@ -112,6 +112,7 @@ GameBoyAdvance::GameBoyAdvance(IRpFile *file)
 {
 	RP_D(GameBoyAdvance);
 	d->className = "GameBoyAdvance";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-gba-rom";	// unofficial
 
 	if (!d->file) {
@@ -259,6 +259,7 @@ GameCom::GameCom(IRpFile *file)
 {
 	RP_D(GameCom);
 	d->className = "GameCom";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-game-com-rom";	// unofficial, not on fd.o
 
 	if (!d->file) {
@@ -62,6 +62,7 @@ Lynx::Lynx(IRpFile *file)
 {
 	RP_D(Lynx);
 	d->className = "Lynx";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-atari-lynx-rom";	// unofficial
 
 	if (!d->file) {
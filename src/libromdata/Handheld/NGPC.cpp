@@ -95,6 +95,7 @@ NGPC::NGPC(IRpFile *file)
 {
 	RP_D(NGPC);
 	d->className = "NGPC";
+	d->fieldCacheable = true;
 
 	if (!d->file) {
 		// Could not ref() the file handle.
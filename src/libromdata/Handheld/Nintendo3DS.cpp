@@ -14,6 +14,9 @@
 #include "Nintendo3DS_p.hpp"
 #include "n3ds_structs.h"
 
+// librpbase
+#include "librpbase/config/Config.hpp"
+
 // librpbase, librpfile, librptexture
 using namespace LibRpBase;
 using namespace LibRpFile;
@@ -2373,6 +2376,17 @@ int Nintendo3DS::loadFieldData(void)
 		d->addFields_permissions();
 	}
 
+	// Verify the content hashes if enabled.
+	// This reads the entire ROM image, so it's disabled by default.
+	if (d->romType == Nintendo3DSPrivate::RomType::CCI ||
+	    d->romType == Nintendo3DSPrivate::RomType::CIA ||
+	    d->romType == Nintendo3DSPrivate::RomType::NCCH)
+	{
+		if (Config::instance()->verifyContentHashes()) {
+			d->addFields_verify();
+		}
+	}
+
 	// Finished reading the field data.
 	return static_cast<int>(d->fields->count());
 }
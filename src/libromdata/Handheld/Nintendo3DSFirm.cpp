@@ -74,6 +74,7 @@ Nintendo3DSFirm::Nintendo3DSFirm(IRpFile *file)
 {
 	RP_D(Nintendo3DSFirm);
 	d->className = "Nintendo3DSFirm";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-nintendo-3ds-firm";	// unofficial, not on fd.o
 	d->fileType = FileType::FirmwareBinary;
 
@@ -227,6 +227,7 @@ Nintendo3DS_SMDH::Nintendo3DS_SMDH(IRpFile *file)
 	// This class handles SMDH files and/or sections only.
 	RP_D(Nintendo3DS_SMDH);
 	d->className = "Nintendo3DS";	// Using the same image settings as Nintendo3DS.
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-nintendo-3ds-smdh";	// unofficial, not on fd.o
 	d->fileType = FileType::IconFile;
 
@@ -255,6 +255,17 @@ class Nintendo3DSPrivate final : public LibRpBase::RomDataPrivate
 		 * @return 0 on success; non-zero on error.
 		 */
 		int addFields_permissions(void);
+
+		/**
+		 * Add the hash verification fields.
+		 * A separate tab is created for the results.
+		 *
+		 * This checks the CIA content hashes from the TMD
+		 * and the primary NCCH's internal hashes.
+		 *
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int addFields_verify(void);
 };
 
 }
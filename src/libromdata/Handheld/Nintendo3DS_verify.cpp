@@ -0,0 +1,146 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * Nintendo3DS_verify.cpp: Nintendo 3DS ROM reader. (Hash verification)    *
+ * Handles CCI/3DS, CIA, and SMDH files.                                   *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "librpbase/config.librpbase.h"
+
+#include "Nintendo3DS.hpp"
+#include "Nintendo3DS_p.hpp"
+
+// librpbase
+#include "librpbase/crypto/Hash.hpp"
+#include "librpbase/crypto/StreamHasher.hpp"
+using LibRpBase::Hash;
+using LibRpBase::RomFields;
+using LibRpBase::rp_sprintf;
+using LibRpBase::StreamHasher;
+
+// NCCH and CIA readers.
+#include "disc/NCCHReader.hpp"
+#include "disc/CIAReader.hpp"
+
+// C++ STL classes.
+using std::string;
+using std::vector;
+
+namespace LibRomData {
+
+/** Nintendo3DSPrivate **/
+
+/**
+ * Add the hash verification fields.
+ * A separate tab is created for the results.
+ *
+ * This checks the CIA content hashes from the TMD
+ * and the primary NCCH's internal hashes.
+ *
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int Nintendo3DSPrivate::addFields_verify(void)
+{
+	if (!Hash(Hash::Algorithm::SHA256).isUsable()) {
+		// SHA-256 isn't available.
+		return -ENOTSUP;
+	}
+
+	vector<NCCHReader::HashResult> results;
+
+	if (romType == RomType::CIA && loadTicketAndTMD() == 0) {
+		// Check the content hashes from the TMD.
+		// The hashes cover the contents after removing the CIA
+		// title key encryption. CIAReader handles decryption in
+		// StreamHasher's reader thread, so decryption of the next
+		// buffer overlaps hashing of the current buffer.
+		StreamHasher hasher(1U << static_cast<int>(Hash::Algorithm::SHA256));
+		off64_t offset = mxh.content_start_addr;
+		const auto content_chunks_cend = content_chunks.cend();
+		for (auto iter = content_chunks.cbegin();
+		     iter != content_chunks_cend; ++iter)
+		{
+			const off64_t length = static_cast<off64_t>(be64_to_cpu(iter->size));
+			const uint16_t content_index = be16_to_cpu(iter->index);
+			const N3DS_Ticket_t *const ticket =
+				(iter->type & cpu_to_be16(N3DS_CONTENT_CHUNK_ENCRYPTED))
+					? &mxh.ticket : nullptr;
+
+			NCCHReader::HashResult result;
+			result.name = rp_sprintf(C_("Nintendo3DS|Verify", "Content #%u"), content_index);
+
+			CIAReader *const ciaReader = new CIAReader(file, offset, length, ticket, content_index);
+			if (!ciaReader->isOpen()) {
+				// Unable to decrypt the content.
+				result.status = NCCHReader::HashStatus::Unknown;
+			} else if (hasher.process(ciaReader) != 0) {
+				// Read error.
+				result.status = NCCHReader::HashStatus::Error;
+			} else {
+				uint8_t sha256[32];
+				hasher.getHash(Hash::Algorithm::SHA256, sha256, sizeof(sha256));
+				result.status = (memcmp(sha256, iter->sha256, sizeof(sha256)) == 0
+					? NCCHReader::HashStatus::OK
+					: NCCHReader::HashStatus::Mismatch);
+			}
+			ciaReader->unref();
+			results.emplace_back(std::move(result));
+
+			// Next chunk.
+			offset += toNext64(length);
+		}
+	}
+
+	// Check the primary NCCH's internal hashes.
+	NCCHReader *const ncch = loadNCCH();
+	if (ncch && ncch->isOpen()) {
+		ncch->verifyHashes(results);
+	}
+
+	if (results.empty()) {
+		// Nothing to verify.
+		return -ENOENT;
+	}
+
+	static const char *const status_tbl[] = {
+		NOP_C_("Nintendo3DS|HashStatus", "Unknown"),
+		NOP_C_("Nintendo3DS|HashStatus", "OK"),
+		NOP_C_("Nintendo3DS|HashStatus", "Mismatch"),
+		NOP_C_("Nintendo3DS|HashStatus", "Read error"),
+	};
+
+	auto vv_hashes = new RomFields::ListData_t();
+	vv_hashes->reserve(results.size());
+	const auto results_cend = results.cend();
+	for (auto iter = results.cbegin(); iter != results_cend; ++iter) {
+		const size_t vidx = vv_hashes->size();
+		vv_hashes->resize(vidx+1);
+		auto &data_row = vv_hashes->at(vidx);
+		data_row.reserve(2);
+
+		data_row.emplace_back(iter->name);
+		const unsigned int status = static_cast<unsigned int>(iter->status);
+		assert(status < ARRAY_SIZE(status_tbl));
+		data_row.emplace_back(dpgettext_expr(RP_I18N_DOMAIN, "Nintendo3DS|HashStatus",
+			status_tbl[status < ARRAY_SIZE(status_tbl) ? status : 0]));
+	}
+
+	static const char *const verify_names[] = {
+		NOP_C_("Nintendo3DS|Verify", "Section"),
+		NOP_C_("Nintendo3DS|Verify", "Status"),
+	};
+	vector<string> *const v_verify_names = RomFields::strArrayToVector_i18n(
+		"Nintendo3DS|Verify", verify_names, ARRAY_SIZE(verify_names));
+
+	fields->addTab(C_("Nintendo3DS", "Verification"));
+	RomFields::AFLD_PARAMS params(RomFields::RFT_LISTDATA_SEPARATE_ROW, 0);
+	params.headers = v_verify_names;
+	params.data.single = vv_hashes;
+	fields->addField_listData(C_("Nintendo3DS", "Hashes"), &params);
+	return 0;
+}
+
+}
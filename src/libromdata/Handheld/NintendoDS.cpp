@@ -172,7 +172,6 @@ const rp_image *NintendoDSPrivate::loadIcon(void)
 		arr_bmpUsed.fill(0xFF);
 
 		// Parse the icon sequence.
-		uint8_t bmp_idx = 0;
 		int seq_idx;
 		for (seq_idx = 0; seq_idx < ARRAY_SIZE(nds_icon_title.dsi_icon_seq); seq_idx++) {
 			const uint16_t seq = le16_to_cpu(nds_icon_title.dsi_icon_seq[seq_idx]);
@@ -195,39 +194,54 @@ const rp_image *NintendoDSPrivate::loadIcon(void)
 			// of 64 bitmaps.
 			uint8_t high_token = (seq >> 8);
 			if (arr_bmpUsed[high_token] == 0xFF) {
-				// Not used yet. Create the bitmap.
+				// Not used yet.
 				const uint8_t bmp = (high_token & 7);
 				const uint8_t pal = (high_token >> 3) & 7;
-				rp_image *img = ImageDecoder::fromNDS_CI4(32, 32,
-					nds_icon_title.dsi_icon_data[bmp],
-					sizeof(nds_icon_title.dsi_icon_data[bmp]),
-					nds_icon_title.dsi_icon_pal[pal],
-					sizeof(nds_icon_title.dsi_icon_pal[pal]));
-				if (high_token & (3U << 6)) {
-					// At least one flip bit is set.
-					rp_image::FlipOp flipOp = rp_image::FLIP_NONE;
-					if (high_token & (1U << 6)) {
-						// H-flip
-						flipOp = rp_image::FLIP_H;
-					}
-					if (high_token & (1U << 7)) {
-						// V-flip
-						flipOp = static_cast<rp_image::FlipOp>(flipOp | rp_image::FLIP_V);
+
+				// Different tokens may still result in identical frames,
+				// e.g. if the icon has duplicate bitmaps or palettes.
+				// Check the source data hash before decoding.
+				const uint8_t flip = (high_token >> 6);
+				const uint64_t hash = IconAnimData::hashData(
+					nds_icon_title.dsi_icon_data[bmp], sizeof(nds_icon_title.dsi_icon_data[bmp]),
+					IconAnimData::hashData(
+						nds_icon_title.dsi_icon_pal[pal], sizeof(nds_icon_title.dsi_icon_pal[pal]),
+						IconAnimData::hashData(&flip, sizeof(flip))));
+				int frame = iconAnimData->findFrame(hash);
+				if (frame < 0) {
+					// Create the bitmap.
+					rp_image *img = ImageDecoder::fromNDS_CI4(32, 32,
+						nds_icon_title.dsi_icon_data[bmp],
+						sizeof(nds_icon_title.dsi_icon_data[bmp]),
+						nds_icon_title.dsi_icon_pal[pal],
+						sizeof(nds_icon_title.dsi_icon_pal[pal]));
+					if (img && flip != 0) {
+						// At least one flip bit is set.
+						rp_image::FlipOp flipOp = rp_image::FLIP_NONE;
+						if (high_token & (1U << 6)) {
+							// H-flip
+							flipOp = rp_image::FLIP_H;
+						}
+						if (high_token & (1U << 7)) {
+							// V-flip
+							flipOp = static_cast<rp_image::FlipOp>(flipOp | rp_image::FLIP_V);
+						}
+						rp_image *const flipimg = img->flip(flipOp);
+						img->unref();
+						img = flipimg;
 					}
-					rp_image *const flipimg = img->flip(flipOp);
-					img->unref();
-					img = flipimg;
+					// NOTE: dsi_icon_seq is limited to 64 entries,
+					// so this can't run out of frames.
+					frame = iconAnimData->addFrame(img, hash);
+					assert(frame >= 0);
 				}
-				iconAnimData->frames[bmp_idx] = img;
-				arr_bmpUsed[high_token] = bmp_idx;
-				bmp_idx++;
+				arr_bmpUsed[high_token] = static_cast<uint8_t>(frame);
 			}
 			iconAnimData->seq_index[seq_idx] = arr_bmpUsed[high_token];
 			iconAnimData->delays[seq_idx].numer = static_cast<uint16_t>(delay);
 			iconAnimData->delays[seq_idx].denom = 60;
 			iconAnimData->delays[seq_idx].ms = delay * 1000 / 60;
 		}
-		iconAnimData->count = bmp_idx;
 		iconAnimData->seq_count = seq_idx;
 	}
 
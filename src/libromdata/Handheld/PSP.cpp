@@ -200,6 +200,7 @@ PSP::PSP(IRpFile *file)
 	// This class handles disc images.
 	RP_D(PSP);
 	d->className = "PSP";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-cd-image";	// unofficial
 	d->fileType = FileType::DiscImage;
 
@@ -692,4 +693,20 @@ int PSP::loadMetaData(void)
 	return static_cast<int>(d->metaData->count());
 }
 
+/**
+ * Open a reader for this ROM image's logical contents.
+ * For CSO images, this is the decompressed disc image.
+ * NOTE: The caller must unref() the reader when done.
+ * @return New reference to the IDiscReader, or nullptr if the file can be read directly.
+ */
+IDiscReader *PSP::openDataReader(void)
+{
+	RP_D(PSP);
+	if (!d->isValid || !d->discReader) {
+		// Unknown disc type.
+		return nullptr;
+	}
+	return d->discReader->ref();
+}
+
 }
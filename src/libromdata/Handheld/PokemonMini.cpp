@@ -65,6 +65,7 @@ PokemonMini::PokemonMini(IRpFile *file)
 {
 	RP_D(PokemonMini);
 	d->className = "PokemonMini";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-pokemon-mini-rom";	// unofficial, not on fd.o
 
 	if (!d->file) {
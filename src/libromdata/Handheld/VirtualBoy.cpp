@@ -124,6 +124,7 @@ VirtualBoy::VirtualBoy(IRpFile *file)
 {
 	RP_D(VirtualBoy);
 	d->className = "VirtualBoy";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-virtual-boy-rom";	// unofficial
 
 	if (!d->file) {
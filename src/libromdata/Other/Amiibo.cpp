@@ -97,6 +97,7 @@ Amiibo::Amiibo(IRpFile *file)
 	// This class handles NFC dumps.
 	RP_D(Amiibo);
 	d->className = "Amiibo";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-nintendo-amiibo";	// unofficial, not on fd.o
 	d->fileType = FileType::NFC_Dump;
 
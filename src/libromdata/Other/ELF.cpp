@@ -753,6 +753,7 @@ ELF::ELF(IRpFile *file)
 	// d->fileType will be set later.
 	RP_D(ELF);
 	d->className = "ELF";
+	d->fieldCacheable = true;
 	d->fileType = FileType::Unknown;
 
 	if (!d->file) {
@@ -398,6 +398,7 @@ EXE::EXE(IRpFile *file)
 	// d->fileType will be set later.
 	RP_D(EXE);
 	d->className = "EXE";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-ms-dos-executable";	// unofficial (TODO: More types?)
 	d->fileType = FileType::Unknown;
 
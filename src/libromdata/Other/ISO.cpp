@@ -22,6 +22,11 @@
 using namespace LibRpBase;
 using LibRpFile::IRpFile;
 
+// DiscReader
+#include "librpbase/disc/DiscReader.hpp"
+#include "../disc/Cdrom2352Reader.hpp"
+#include "../disc/IsoPartition.hpp"
+
 // C includes. (C++ namespace)
 #include <cassert>
 #include <cerrno>
@@ -407,6 +412,7 @@ ISO::ISO(IRpFile *file)
 	// This class handles disc images.
 	RP_D(ISO);
 	d->className = "ISO";
+	d->fieldCacheable = true;
 	d->mimeType = "application/x-cd-image";	// unofficial [TODO: Others?]
 	d->fileType = FileType::DiscImage;
 
@@ -621,6 +627,45 @@ const char *const *ISO::supportedMimeTypes_static(void)
 	return mimeTypes;
 }
 
+/**
+ * Open the partition containing this ROM image's file system.
+ * NOTE: The caller must unref() the partition when done.
+ * @return New reference to the IPartition, or nullptr if this ROM image doesn't have a file system.
+ */
+IPartition *ISO::openFstPartition(void)
+{
+	RP_D(ISO);
+	if (!d->isValid || !d->file) {
+		// Unknown disc type.
+		return nullptr;
+	} else if (d->discType != ISOPrivate::DiscType::ISO9660) {
+		// IsoPartition only supports ISO-9660.
+		return nullptr;
+	}
+
+	IDiscReader *discReader;
+	if (d->sector_size == ISO_SECTOR_SIZE_MODE1_RAW) {
+		discReader = new Cdrom2352Reader(d->file);
+	} else {
+		discReader = new DiscReader(d->file);
+	}
+	if (!discReader->isOpen()) {
+		// Unable to open the DiscReader.
+		discReader->unref();
+		return nullptr;
+	}
+
+	// NOTE: IsoPartition takes its own reference to the DiscReader.
+	IsoPartition *const isoPartition = new IsoPartition(discReader, 0, 0);
+	discReader->unref();
+	if (!isoPartition->isOpen()) {
+		// Unable to open the ISO partition.
+		isoPartition->unref();
+		return nullptr;
+	}
+	return isoPartition;
+}
+
 /**
  * Load field data.
  * Called by RomData::fields() if the field data hasn't been loaded yet.
@@ -143,6 +143,7 @@ MachO::MachO(IRpFile *file)
 	// d->fileType will be set later.
 	RP_D(MachO);
 	d->className = "MachO";
+	d->fieldCacheable = true;
 	d->fileType = FileType::Unknown;
 
 	if (!d->file) {
@@ -398,6 +398,7 @@ NintendoBadge::NintendoBadge(IRpFile *file)
 	// This class handles texture files.
 	RP_D(NintendoBadge);
 	d->className = "NintendoBadge";
+	d->fieldCacheable = true;
 	d->fileType = FileType::TextureFile;
 
 	if (!d->file) {
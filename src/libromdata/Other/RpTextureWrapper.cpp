@@ -76,6 +76,7 @@ RpTextureWrapper::RpTextureWrapper(IRpFile *file)
 	// This class handles texture files.
 	RP_D(RpTextureWrapper);
 	d->className = "RpTextureWrapper";
+	d->fieldCacheable = true;
 	d->fileType = FileType::TextureFile;
 
 	if (!d->file) {
@@ -13,6 +13,7 @@
 #include "RomDataFactory.hpp"
 
 // librpbase, librpfile
+#include "librpbase/config/Config.hpp"
 #include "librpfile/RelatedFile.hpp"
 using namespace LibRpBase;
 using namespace LibRpFile;
@@ -220,6 +221,15 @@ class RomDataFactoryPrivate
 		 * @return Game-specific RomData subclass, or nullptr if none are supported.
 		 */
 		static RomData *checkISO(IRpFile *file);
+
+		/**
+		 * Create a RomData subclass for the specified ROM file.
+		 * Internal function; see RomDataFactory::create().
+		 * @param file ROM file.
+		 * @param attrs RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
+		 * @return RomData subclass, or nullptr if the ROM isn't supported.
+		 */
+		static RomData *create(IRpFile *file, unsigned int attrs);
 };
 
 /** RomDataFactoryPrivate **/
@@ -532,24 +542,14 @@ RomData *RomDataFactoryPrivate::checkISO(IRpFile *file)
 	return new ISO(file);
 }
 
-/** RomDataFactory **/
-
 /**
  * Create a RomData subclass for the specified ROM file.
- *
- * NOTE: RomData::isValid() is checked before returning a
- * created RomData instance, so returned objects can be
- * assumed to be valid as long as they aren't nullptr.
- *
- * If imgbf is non-zero, at least one of the specified image
- * types must be supported by the RomData subclass in order to
- * be returned.
- *
+ * Internal function; see RomDataFactory::create().
  * @param file ROM file.
  * @param attrs RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
  * @return RomData subclass, or nullptr if the ROM isn't supported.
  */
-RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
+RomData *RomDataFactoryPrivate::create(IRpFile *file, unsigned int attrs)
 {
 	RomData::DetectInfo info;
 
@@ -736,7 +736,7 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 
 		if (fns->isRomSupported(&info) >= 0) {
 			RomData *romData;
-			if (fns->attrs & RDA_CHECK_ISO) {
+			if (fns->attrs & ATTR_CHECK_ISO) {
 				// Check for a game-specific ISO subclass.
 				romData = RomDataFactoryPrivate::checkISO(file);
 			} else {
@@ -809,6 +809,35 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 	return nullptr;
 }
 
+/** RomDataFactory **/
+
+/**
+ * Create a RomData subclass for the specified ROM file.
+ *
+ * NOTE: RomData::isValid() is checked before returning a
+ * created RomData instance, so returned objects can be
+ * assumed to be valid as long as they aren't nullptr.
+ *
+ * If imgbf is non-zero, at least one of the specified image
+ * types must be supported by the RomData subclass in order to
+ * be returned.
+ *
+ * @param file ROM file.
+ * @param attrs RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
+ * @return RomData subclass, or nullptr if the ROM isn't supported.
+ */
+RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
+{
+	RomData *const romData = RomDataFactoryPrivate::create(file, attrs);
+	if (romData && Config::instance()->showHashTab()) {
+		// Only show the hash tab for ROM images opened by the user.
+		// RomData subclasses created internally, e.g. for the ISO-9660
+		// file system on a disc image, don't go through the factory.
+		romData->setShowHashTab(true);
+	}
+	return romData;
+}
+
 /**
  * Initialize the vector of supported file extensions.
  * Used for Win32 COM registration.
@@ -27,7 +27,7 @@ class CIAReaderPrivate
 {
 	public:
 		CIAReaderPrivate(CIAReader *q,
-			off64_t content_offset, uint32_t content_length,
+			off64_t content_offset, off64_t content_length,
 			const N3DS_Ticket_t *ticket,
 			uint16_t tmd_content_index);
 		~CIAReaderPrivate();
@@ -51,7 +51,7 @@ class CIAReaderPrivate
 /** CIAReaderPrivate **/
 
 CIAReaderPrivate::CIAReaderPrivate(CIAReader *q,
-	off64_t content_offset, uint32_t content_length,
+	off64_t content_offset, off64_t content_length,
 	const N3DS_Ticket_t *ticket, uint16_t tmd_content_index)
 	: q_ptr(q)
 	, cbcReader(nullptr)
@@ -196,7 +196,7 @@ CIAReaderPrivate::~CIAReaderPrivate()
  * @param tmd_content_index	[in,opt] TMD content index for decryption.
  */
 CIAReader::CIAReader(IRpFile *file,
-		off64_t content_offset, uint32_t content_length,
+		off64_t content_offset, off64_t content_length,
 		const N3DS_Ticket_t *ticket,
 		uint16_t tmd_content_index)
 	: super(file)
@@ -33,7 +33,7 @@ class CIAReader : public LibRpBase::IPartition
 		 * @param tmd_content_index	[in,opt] TMD content index for decryption.
 		 */
 		CIAReader(LibRpFile::IRpFile *file,
-			off64_t content_offset, uint32_t content_length,
+			off64_t content_offset, off64_t content_length,
 			const N3DS_Ticket_t *ticket,
 			uint16_t tmd_content_index);
 	protected:
@@ -40,6 +40,27 @@ class Cdrom2352ReaderPrivate : public SparseDiscReaderPrivate {
 
 		// Number of 2352-byte blocks.
 		unsigned int blockCount;
+
+		// Maximum number of sectors to read at once.
+		// 32 sectors == 75,264 bytes.
+		static const unsigned int MAX_BATCH_SECTORS = 32;
+
+		/**
+		 * Extract the user data from multiple 2352-byte sectors.
+		 * @param dest		[out] Output buffer. (count * 2048 bytes)
+		 * @param sectors	[in] Sectors.
+		 * @param count		[in] Number of sectors.
+		 */
+		static inline void extractUserData(uint8_t *dest, const CDROM_2352_Sector_t *sectors, size_t count)
+		{
+			// NOTE: The user data area is 2048 bytes, aligned to a
+			// 4-byte boundary in both Mode 1 and Mode 2 sectors.
+			// memcpy() will use vector instructions for this.
+			const CDROM_2352_Sector_t *const sectors_end = sectors + count;
+			for (; sectors < sectors_end; sectors++, dest += 2048) {
+				memcpy(dest, cdromSectorDataPtr(sectors), 2048);
+			}
+		}
 };
 
 /** Cdrom2352ReaderPrivate **/
@@ -120,6 +141,72 @@ int Cdrom2352Reader::isDiscSupported(const uint8_t *pHeader, size_t szHeader) co
 	return isDiscSupported_static(pHeader, szHeader);
 }
 
+/**
+ * Read the user data from multiple 2352-byte sectors.
+ *
+ * Sectors are read in batches, with a single I/O operation
+ * per batch. The 2048-byte user data area is then extracted
+ * from each sector. Mode 1 and Mode 2 (XA) sectors can be mixed.
+ *
+ * @param file		[in] File to read from.
+ * @param physAddr	[in] Physical address of the first sector.
+ * @param ptr		[out] Output data buffer. (Must be at least sectorCount * 2048 bytes!)
+ * @param sectorCount	[in] Number of sectors to read.
+ * @return Number of sectors read.
+ */
+size_t Cdrom2352Reader::readSectors(IRpFile *file, off64_t physAddr, void *ptr, size_t sectorCount)
+{
+	assert(file != nullptr);
+	if (unlikely(sectorCount == 0)) {
+		// Nothing to read.
+		return 0;
+	}
+
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	if (sectorCount == 1) {
+		// Single sector. Use a stack buffer.
+		CDROM_2352_Sector_t sector;
+		size_t sz_read = file->seekAndRead(physAddr, &sector, sizeof(sector));
+		if (sz_read != sizeof(sector)) {
+			// Read error.
+			return 0;
+		}
+		Cdrom2352ReaderPrivate::extractUserData(ptr8, &sector, 1);
+		return 1;
+	}
+
+	// Multiple sectors.
+	// Sectors are contiguous, so only one seek is needed.
+	if (file->seek(physAddr) != 0) {
+		// Seek error.
+		return 0;
+	}
+
+	const size_t batchSectors = std::min(sectorCount,
+		static_cast<size_t>(Cdrom2352ReaderPrivate::MAX_BATCH_SECTORS));
+	ao::uvector<CDROM_2352_Sector_t> sectors;
+	sectors.resize(batchSectors);
+
+	size_t sectorsRead = 0;
+	while (sectorsRead < sectorCount) {
+		const size_t count = std::min(sectorCount - sectorsRead, batchSectors);
+		const size_t sz_read = file->read(sectors.data(), count * sizeof(CDROM_2352_Sector_t));
+
+		// Extract the user data from all complete sectors.
+		const size_t full = sz_read / sizeof(CDROM_2352_Sector_t);
+		Cdrom2352ReaderPrivate::extractUserData(ptr8, sectors.data(), full);
+		ptr8 += full * 2048;
+		sectorsRead += full;
+
+		if (full != count) {
+			// Short read.
+			break;
+		}
+	}
+
+	return sectorsRead;
+}
+
 /** SparseDiscReader functions. **/
 
 /**
@@ -190,4 +277,30 @@ int Cdrom2352Reader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t siz
 	return size;
 }
 
+/**
+ * Read multiple full blocks.
+ * @param blockIdx	[in] First block index.
+ * @param ptr		[out] Output data buffer. (Must be at least blockCount * block_size bytes!)
+ * @param blockCount	[in] Number of blocks to read.
+ * @return Number of full blocks read.
+ */
+size_t Cdrom2352Reader::readBlocks(uint32_t blockIdx, void *ptr, size_t blockCount)
+{
+	// NOTE: This can only be called by SparseDiscReader,
+	// so the main assertions are already checked there.
+	RP_D(const Cdrom2352Reader);
+	if (blockIdx >= d->blockCount) {
+		// Out of range.
+		return 0;
+	}
+	if (blockCount > d->blockCount - blockIdx) {
+		blockCount = d->blockCount - blockIdx;
+	}
+
+	const off64_t physBlockAddr = static_cast<off64_t>(blockIdx) * d->physBlockSize;
+	const size_t blocksRead = readSectors(m_file, physBlockAddr, ptr, blockCount);
+	m_lastError = m_file->lastError();
+	return blocksRead;
+}
+
 }
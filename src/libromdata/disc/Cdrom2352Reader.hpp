@@ -50,6 +50,22 @@ class Cdrom2352Reader : public LibRpBase::SparseDiscReader
 		 */
 		int isDiscSupported(const uint8_t *pHeader, size_t szHeader) const final;
 
+	public:
+		/**
+		 * Read the user data from multiple 2352-byte sectors.
+		 *
+		 * Sectors are read in batches, with a single I/O operation
+		 * per batch. The 2048-byte user data area is then extracted
+		 * from each sector. Mode 1 and Mode 2 (XA) sectors can be mixed.
+		 *
+		 * @param file		[in] File to read from.
+		 * @param physAddr	[in] Physical address of the first sector.
+		 * @param ptr		[out] Output data buffer. (Must be at least sectorCount * 2048 bytes!)
+		 * @param sectorCount	[in] Number of sectors to read.
+		 * @return Number of sectors read.
+		 */
+		static size_t readSectors(LibRpFile::IRpFile *file, off64_t physAddr, void *ptr, size_t sectorCount);
+
 	protected:
 		/** SparseDiscReader functions. **/
 
@@ -75,6 +91,15 @@ class Cdrom2352Reader : public LibRpBase::SparseDiscReader
 		 */
 		ATTR_ACCESS_SIZE(write_only, 4, 5)
 		int readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size) final;
+
+		/**
+		 * Read multiple full blocks.
+		 * @param blockIdx	[in] First block index.
+		 * @param ptr		[out] Output data buffer. (Must be at least blockCount * block_size bytes!)
+		 * @param blockCount	[in] Number of blocks to read.
+		 * @return Number of full blocks read.
+		 */
+		size_t readBlocks(uint32_t blockIdx, void *ptr, size_t blockCount) final;
 };
 
 }
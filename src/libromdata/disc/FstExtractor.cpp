@@ -0,0 +1,730 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * FstExtractor.cpp: File system lister and extractor for IPartition.      *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "FstExtractor.hpp"
+
+// librpbase, librpfile
+using namespace LibRpBase;
+using LibRpFile::IRpFile;
+using LibRpFile::RpFile;
+
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+#include "librpthreads/Semaphore.hpp"
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+using LibRpThreads::Semaphore;
+
+// C++ STL classes.
+#include <deque>
+#include <thread>
+using std::deque;
+using std::string;
+using std::vector;
+
+// Native directory separator.
+// NOTE: DIR_SEP_CHR from tcharx.h is a TCHAR.
+#ifdef _WIN32
+static const char dir_sep_chr = '\\';
+#else /* !_WIN32 */
+static const char dir_sep_chr = '/';
+#endif /* _WIN32 */
+
+namespace LibRomData {
+
+class FstExtractorPrivate
+{
+	public:
+		explicit FstExtractorPrivate(IPartition *partition);
+		~FstExtractorPrivate();
+
+	private:
+		RP_DISABLE_COPY(FstExtractorPrivate)
+
+	public:
+		IPartition *partition;
+
+		// Options.
+		size_t bufferSize;
+		unsigned int bufferCount;	// 0 for default
+		unsigned int writerCount;	// 0 for default
+
+		// Statistics from the last extract().
+		unsigned int filesExtracted;
+		off64_t bytesExtracted;
+
+		// Reusable buffers.
+		vector<ao::uvector<uint8_t> > buffers;
+
+		// Maximum directory depth.
+		// Deeper directories are probably a directory loop.
+		static const unsigned int MAX_DEPTH = 64;
+
+		// Maximum number of entries for list().
+		static const size_t MAX_ENTRIES = 1U << 20;
+
+		/**
+		 * Is a filename safe to use as a path component?
+		 * @param name Filename.
+		 * @return True if safe; false if not.
+		 */
+		static bool isSafeName(const char *name);
+
+		/**
+		 * List a directory tree. (recursive function)
+		 * @param path		[in] Directory path, without a trailing slash. (Root == empty string)
+		 * @param depth		[in] Current depth.
+		 * @param entries	[out] Directory entries.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int listDir(const string &path, unsigned int depth, vector<FstExtractor::Entry> &entries);
+
+	public:
+		/**
+		 * File to extract.
+		 */
+		struct FileJob {
+			const FstExtractor::Entry *entry;
+			string outPath;		// Output filename. (native separators)
+		};
+
+		/**
+		 * Buffer write request for a writer thread.
+		 */
+		struct WriteTask {
+			const FileJob *job;	// nullptr to stop the thread
+			int bufIdx;		// Buffer index, or -1 for an empty file.
+			size_t size;		// Amount of data in the buffer.
+			bool first;		// First chunk: Create the file.
+			bool last;		// Last chunk: Close the file.
+		};
+
+		/**
+		 * Writer thread queue.
+		 */
+		struct WriterQueue {
+			Semaphore sem;		// Number of queued tasks.
+			Mutex mutex;
+			deque<WriteTask> tasks;
+
+			WriterQueue() : sem(0) { }
+		};
+
+		// Free buffers.
+		Semaphore *freeSem;
+		Mutex freeMutex;
+		vector<int> freeList;
+
+		// First error encountered by a writer thread.
+		Mutex resultMutex;
+		int writeError;
+
+		/**
+		 * Return a buffer to the free list.
+		 * @param bufIdx Buffer index.
+		 */
+		void releaseBuffer(int bufIdx);
+
+		/**
+		 * Set the write error, if one isn't set already.
+		 * @param err Negative POSIX error code.
+		 */
+		void setWriteError(int err);
+
+		/**
+		 * Get the write error.
+		 * @return Negative POSIX error code, or 0 if no error.
+		 */
+		int getWriteError(void);
+
+		/**
+		 * Writer thread function.
+		 * @param queue Writer queue.
+		 */
+		void writerThread(WriterQueue *queue);
+
+		/**
+		 * Extract files.
+		 * Files are read in the order specified.
+		 * @param jobs Files to extract.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int extractFiles(const vector<FileJob> &jobs);
+};
+
+/** FstExtractorPrivate **/
+
+FstExtractorPrivate::FstExtractorPrivate(IPartition *partition)
+	: partition(partition ? static_cast<IPartition*>(partition->ref()) : nullptr)
+	, bufferSize(1024*1024)
+	, bufferCount(0)
+	, writerCount(0)
+	, filesExtracted(0)
+	, bytesExtracted(0)
+	, freeSem(nullptr)
+	, writeError(0)
+{ }
+
+FstExtractorPrivate::~FstExtractorPrivate()
+{
+	UNREF(partition);
+}
+
+/**
+ * Is a filename safe to use as a path component?
+ * @param name Filename.
+ * @return True if safe; false if not.
+ */
+bool FstExtractorPrivate::isSafeName(const char *name)
+{
+	if (!name || name[0] == '\0') {
+		// Empty filename.
+		return false;
+	} else if (!strcmp(name, ".") || !strcmp(name, "..")) {
+		// Current or parent directory.
+		return false;
+	}
+
+#ifdef _WIN32
+	return (strpbrk(name, "/\\:") == nullptr);
+#else /* !_WIN32 */
+	return (strpbrk(name, "/\\") == nullptr);
+#endif /* _WIN32 */
+}
+
+/**
+ * List a directory tree. (recursive function)
+ * @param path		[in] Directory path, without a trailing slash. (Root == empty string)
+ * @param depth		[in] Current depth.
+ * @param entries	[out] Directory entries.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int FstExtractorPrivate::listDir(const string &path, unsigned int depth, vector<FstExtractor::Entry> &entries)
+{
+	if (depth >= MAX_DEPTH) {
+		// Too deep. This is probably a directory loop.
+		return -ELOOP;
+	}
+
+	IFst::Dir *const dirp = partition->opendir(path.empty() ? "/" : path.c_str());
+	if (!dirp) {
+		const int err = partition->lastError();
+		return (err != 0 ? -err : -ENOENT);
+	}
+
+	// Read all entries first, since recursing into a
+	// subdirectory may invalidate the current DirEnt.
+	vector<FstExtractor::Entry> dirEntries;
+	const IFst::DirEnt *dirent;
+	while ((dirent = partition->readdir(dirp)) != nullptr) {
+		if (!isSafeName(dirent->name)) {
+			// Skip invalid filenames.
+			continue;
+		} else if (entries.size() + dirEntries.size() >= MAX_ENTRIES) {
+			// Too many entries. This is probably a directory loop.
+			partition->closedir(dirp);
+			return -ELOOP;
+		}
+
+		FstExtractor::Entry entry;
+		entry.path = path + '/' + dirent->name;
+		entry.offset = dirent->offset;
+		entry.size = dirent->size;
+		entry.type = dirent->type;
+		dirEntries.push_back(std::move(entry));
+	}
+	partition->closedir(dirp);
+
+	// Each subdirectory's contents are listed after the subdirectory.
+	for (auto iter = dirEntries.begin(); iter != dirEntries.end(); ++iter) {
+		const bool isDir = (iter->type == DT_DIR);
+		entries.push_back(std::move(*iter));
+		if (isDir) {
+			// NOTE: Copying the path, since entries may be reallocated.
+			const string subPath = entries.back().path;
+			int ret = listDir(subPath, depth + 1, entries);
+			if (ret != 0) {
+				return ret;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Return a buffer to the free list.
+ * @param bufIdx Buffer index.
+ */
+void FstExtractorPrivate::releaseBuffer(int bufIdx)
+{
+	if (bufIdx < 0) {
+		// No buffer.
+		return;
+	}
+
+	{
+		MutexLocker locker(freeMutex);
+		freeList.push_back(bufIdx);
+	}
+	freeSem->release();
+}
+
+/**
+ * Set the write error, if one isn't set already.
+ * @param err Negative POSIX error code.
+ */
+void FstExtractorPrivate::setWriteError(int err)
+{
+	MutexLocker locker(resultMutex);
+	if (writeError == 0) {
+		writeError = err;
+	}
+}
+
+/**
+ * Get the write error.
+ * @return Negative POSIX error code, or 0 if no error.
+ */
+int FstExtractorPrivate::getWriteError(void)
+{
+	MutexLocker locker(resultMutex);
+	return writeError;
+}
+
+/**
+ * Writer thread function.
+ * @param queue Writer queue.
+ */
+void FstExtractorPrivate::writerThread(WriterQueue *queue)
+{
+	RpFile *file = nullptr;
+	bool fileError = false;
+
+	while (true) {
+		queue->sem.obtain();
+		WriteTask task;
+		{
+			MutexLocker locker(queue->mutex);
+			task = queue->tasks.front();
+			queue->tasks.pop_front();
+		}
+
+		if (!task.job) {
+			// Stop the thread.
+			break;
+		}
+
+		if (task.first) {
+			// Create the output file.
+			assert(file == nullptr);
+			UNREF_AND_NULL(file);
+			file = new RpFile(task.job->outPath, RpFile::FM_CREATE_WRITE);
+			fileError = !file->isOpen();
+			if (fileError) {
+				const int err = file->lastError();
+				setWriteError(err != 0 ? -err : -EIO);
+			}
+		}
+
+		if (!fileError && task.size > 0) {
+			const size_t size = file->write(buffers[task.bufIdx].data(), task.size);
+			if (size != task.size) {
+				const int err = file->lastError();
+				setWriteError(err != 0 ? -err : -EIO);
+				fileError = true;
+			} else {
+				MutexLocker locker(resultMutex);
+				bytesExtracted += size;
+			}
+		}
+		releaseBuffer(task.bufIdx);
+
+		if (task.last) {
+			// Close the output file.
+			UNREF_AND_NULL(file);
+			if (!fileError) {
+				MutexLocker locker(resultMutex);
+				filesExtracted++;
+			}
+		}
+	}
+
+	// If extraction was aborted, a file may still be open.
+	UNREF(file);
+}
+
+/**
+ * Extract files.
+ * Files are read in the order specified.
+ * @param jobs Files to extract.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int FstExtractorPrivate::extractFiles(const vector<FileJob> &jobs)
+{
+	// Determine the number of writer threads and buffers.
+	unsigned int nWriters = writerCount;
+	if (nWriters == 0) {
+		nWriters = std::thread::hardware_concurrency();
+		if (nWriters == 0) {
+			nWriters = 1;
+		} else if (nWriters > 4) {
+			nWriters = 4;
+		}
+	}
+	const unsigned int nBuffers = (bufferCount != 0 ? bufferCount : nWriters * 2);
+
+	// Allocate the buffers.
+	// Buffers are kept allocated for subsequent extract() calls.
+	if (buffers.size() != nBuffers || (!buffers.empty() && buffers[0].size() != bufferSize)) {
+		buffers.clear();
+		buffers.resize(nBuffers);
+		for (auto iter = buffers.begin(); iter != buffers.end(); ++iter) {
+			iter->resize(bufferSize);
+		}
+	}
+
+	Semaphore sem(static_cast<int>(nBuffers));
+	freeSem = &sem;
+	freeList.clear();
+	for (int i = static_cast<int>(nBuffers) - 1; i >= 0; i--) {
+		freeList.push_back(i);
+	}
+	writeError = 0;
+
+	// Start the writer threads.
+	vector<WriterQueue> queues(nWriters);
+	vector<std::thread> threads;
+	threads.reserve(nWriters);
+	for (unsigned int i = 0; i < nWriters; i++) {
+		threads.emplace_back(&FstExtractorPrivate::writerThread, this, &queues[i]);
+	}
+
+	// Read the files and queue the buffers.
+	int ret = 0;
+	unsigned int writerIdx = 0;
+	for (auto iter = jobs.cbegin(); iter != jobs.cend() && ret == 0; ++iter) {
+		ret = getWriteError();
+		if (ret != 0) {
+			// A writer thread failed.
+			break;
+		}
+
+		IRpFile *const f_src = partition->open(iter->entry->path.c_str());
+		if (!f_src) {
+			const int err = partition->lastError();
+			ret = (err != 0 ? -err : -EIO);
+			break;
+		}
+
+		// Each file is written by a single thread.
+		WriterQueue &queue = queues[writerIdx];
+		writerIdx = (writerIdx + 1) % nWriters;
+
+		off64_t remain = f_src->size();
+		bool first = true;
+		do {
+			WriteTask task;
+			task.job = &(*iter);
+			task.bufIdx = -1;
+			task.size = 0;
+			task.first = first;
+
+			if (remain > 0) {
+				// Get a free buffer.
+				freeSem->obtain();
+				{
+					MutexLocker locker(freeMutex);
+					task.bufIdx = freeList.back();
+					freeList.pop_back();
+				}
+
+				task.size = (remain > static_cast<off64_t>(bufferSize)
+					? bufferSize : static_cast<size_t>(remain));
+				const size_t size = f_src->read(buffers[task.bufIdx].data(), task.size);
+				if (size != task.size) {
+					// Short read.
+					const int err = f_src->lastError();
+					ret = (err != 0 ? -err : -EIO);
+					releaseBuffer(task.bufIdx);
+					break;
+				}
+				remain -= task.size;
+			}
+			task.last = (remain <= 0);
+
+			{
+				MutexLocker locker(queue.mutex);
+				queue.tasks.push_back(task);
+			}
+			queue.sem.release();
+			first = false;
+		} while (remain > 0);
+
+		f_src->unref();
+	}
+
+	// Stop the writer threads.
+	for (auto iter = queues.begin(); iter != queues.end(); ++iter) {
+		WriteTask task;
+		task.job = nullptr;
+		task.bufIdx = -1;
+		task.size = 0;
+		task.first = false;
+		task.last = false;
+		{
+			MutexLocker locker(iter->mutex);
+			iter->tasks.push_back(task);
+		}
+		iter->sem.release();
+	}
+	for (auto iter = threads.begin(); iter != threads.end(); ++iter) {
+		iter->join();
+	}
+
+	// Semaphores must be fully released before deletion.
+	freeSem = nullptr;
+	if (ret == 0) {
+		ret = writeError;
+	}
+	return ret;
+}
+
+/** FstExtractor **/
+
+/**
+ * Create an FstExtractor for the specified partition.
+ * The partition must implement the IFst wrapper functions.
+ *
+ * NOTE: The partition is ref()'d.
+ *
+ * @param partition IPartition.
+ */
+FstExtractor::FstExtractor(IPartition *partition)
+	: d_ptr(new FstExtractorPrivate(partition))
+{ }
+
+FstExtractor::~FstExtractor()
+{
+	delete d_ptr;
+}
+
+/**
+ * List a directory tree.
+ *
+ * Directories are listed before their contents.
+ * Entries with invalid names, e.g. "..", are skipped.
+ *
+ * @param path		[in] Directory path. ("/" for the root directory)
+ * @param entries	[out] Directory entries.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int FstExtractor::list(const char *path, vector<Entry> &entries)
+{
+	RP_D(FstExtractor);
+	entries.clear();
+	if (!d->partition) {
+		return -EBADF;
+	}
+
+	// Remove trailing slashes.
+	string s_path(path ? path : "");
+	while (!s_path.empty() && s_path[s_path.size()-1] == '/') {
+		s_path.resize(s_path.size()-1);
+	}
+	if (!s_path.empty() && s_path[0] != '/') {
+		s_path.insert(s_path.begin(), '/');
+	}
+
+	int ret = d->listDir(s_path, 0, entries);
+	if (ret != 0) {
+		entries.clear();
+	}
+	return ret;
+}
+
+/**
+ * Extract a file or directory tree.
+ *
+ * If path is a directory, its contents are extracted
+ * into outDir. If path is a file, it's extracted into
+ * outDir using its base filename.
+ *
+ * Files are read in order of their starting addresses
+ * using a pool of reusable buffers, and the buffers are
+ * written by multiple writer threads.
+ *
+ * @param path	[in] File or directory path.
+ * @param outDir	[in] Output directory. (UTF-8)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int FstExtractor::extract(const char *path, const char *outDir)
+{
+	RP_D(FstExtractor);
+	d->filesExtracted = 0;
+	d->bytesExtracted = 0;
+	if (!d->partition) {
+		return -EBADF;
+	}
+	assert(path != nullptr);
+	assert(outDir != nullptr);
+	if (!path || !outDir || outDir[0] == '\0') {
+		return -EINVAL;
+	}
+
+	// Remove trailing slashes.
+	string s_path(path);
+	while (!s_path.empty() && s_path[s_path.size()-1] == '/') {
+		s_path.resize(s_path.size()-1);
+	}
+	if (!s_path.empty() && s_path[0] != '/') {
+		s_path.insert(s_path.begin(), '/');
+	}
+
+	// Is this a file or a directory?
+	vector<Entry> entries;
+	size_t baseLen;
+	IFst::Dir *const dirp = d->partition->opendir(s_path.empty() ? "/" : s_path.c_str());
+	if (dirp) {
+		// Directory. Extract its contents.
+		d->partition->closedir(dirp);
+		int ret = list(s_path.c_str(), entries);
+		if (ret != 0) {
+			return ret;
+		}
+		baseLen = s_path.size() + 1;
+	} else {
+		// Not a directory. Check if it's a file.
+		IRpFile *const f_src = d->partition->open(s_path.c_str());
+		if (!f_src) {
+			const int err = d->partition->lastError();
+			return (err != 0 ? -err : -ENOENT);
+		}
+
+		const size_t slash_pos = s_path.rfind('/');
+		baseLen = (slash_pos != string::npos ? slash_pos + 1 : 0);
+		if (!FstExtractorPrivate::isSafeName(s_path.c_str() + baseLen)) {
+			f_src->unref();
+			return -EINVAL;
+		}
+
+		Entry entry;
+		entry.path = s_path;
+		entry.offset = 0;
+		entry.size = f_src->size();
+		entry.type = DT_REG;
+		entries.push_back(std::move(entry));
+		f_src->unref();
+	}
+
+	// Output directory, with a trailing separator.
+	string s_outDir(outDir);
+	if (s_outDir[s_outDir.size()-1] != dir_sep_chr) {
+		s_outDir += dir_sep_chr;
+	}
+	int ret = LibRpFile::FileSystem::rmkdir(s_outDir);
+	if (ret != 0) {
+		return ret;
+	}
+
+	// Create the subdirectories and determine the output filenames.
+	vector<FstExtractorPrivate::FileJob> jobs;
+	jobs.reserve(entries.size());
+	for (auto iter = entries.cbegin(); iter != entries.cend(); ++iter) {
+		string outPath = s_outDir + iter->path.substr(baseLen);
+#ifdef _WIN32
+		std::replace(outPath.begin() + s_outDir.size(), outPath.end(), '/', dir_sep_chr);
+#endif /* _WIN32 */
+
+		if (iter->type == DT_DIR) {
+			outPath += dir_sep_chr;
+			ret = LibRpFile::FileSystem::rmkdir(outPath);
+			if (ret != 0) {
+				return ret;
+			}
+			continue;
+		}
+
+		FstExtractorPrivate::FileJob job;
+		job.entry = &(*iter);
+		job.outPath = std::move(outPath);
+		jobs.push_back(std::move(job));
+	}
+
+	// Read the files in order of their starting addresses
+	// in order to keep reads sequential.
+	std::stable_sort(jobs.begin(), jobs.end(),
+		[](const FstExtractorPrivate::FileJob &a, const FstExtractorPrivate::FileJob &b) {
+			return (a.entry->offset < b.entry->offset);
+		});
+
+	return d->extractFiles(jobs);
+}
+
+/** Extraction options **/
+
+/**
+ * Set the size of each buffer.
+ * Default is 1 MiB.
+ * @param bufferSize Buffer size, in bytes.
+ */
+void FstExtractor::setBufferSize(size_t bufferSize)
+{
+	RP_D(FstExtractor);
+	assert(bufferSize > 0);
+	if (bufferSize > 0) {
+		d->bufferSize = bufferSize;
+	}
+}
+
+/**
+ * Set the number of buffers.
+ * Default is twice the number of writer threads.
+ * @param bufferCount Number of buffers. (0 for default)
+ */
+void FstExtractor::setBufferCount(unsigned int bufferCount)
+{
+	RP_D(FstExtractor);
+	d->bufferCount = bufferCount;
+}
+
+/**
+ * Set the number of writer threads.
+ * Default is based on the number of CPUs, up to 4.
+ * @param writerCount Number of writer threads. (0 for default)
+ */
+void FstExtractor::setWriterCount(unsigned int writerCount)
+{
+	RP_D(FstExtractor);
+	d->writerCount = writerCount;
+}
+
+/** Statistics from the last extract() **/
+
+/**
+ * Get the number of files extracted.
+ * @return Number of files extracted.
+ */
+unsigned int FstExtractor::filesExtracted(void) const
+{
+	RP_D(const FstExtractor);
+	return d->filesExtracted;
+}
+
+/**
+ * Get the number of bytes extracted.
+ * @return Number of bytes extracted.
+ */
+off64_t FstExtractor::bytesExtracted(void) const
+{
+	RP_D(const FstExtractor);
+	return d->bytesExtracted;
+}
+
+}
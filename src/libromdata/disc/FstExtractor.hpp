@@ -0,0 +1,130 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * FstExtractor.hpp: File system lister and extractor for IPartition.      *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBROMDATA_DISC_FSTEXTRACTOR_HPP__
+#define __ROMPROPERTIES_LIBROMDATA_DISC_FSTEXTRACTOR_HPP__
+
+#include "common.h"
+
+// C includes.
+#include <stdint.h>
+
+// C++ includes.
+#include <string>
+#include <vector>
+
+namespace LibRpBase {
+	class IPartition;
+}
+
+namespace LibRomData {
+
+class FstExtractorPrivate;
+class FstExtractor
+{
+	public:
+		/**
+		 * Create an FstExtractor for the specified partition.
+		 * The partition must implement the IFst wrapper functions.
+		 *
+		 * NOTE: The partition is ref()'d.
+		 *
+		 * @param partition IPartition.
+		 */
+		explicit FstExtractor(LibRpBase::IPartition *partition);
+		~FstExtractor();
+
+	private:
+		RP_DISABLE_COPY(FstExtractor)
+	private:
+		friend class FstExtractorPrivate;
+		FstExtractorPrivate *const d_ptr;
+
+	public:
+		/**
+		 * File system entry.
+		 */
+		struct Entry {
+			std::string path;	// Full path, with a leading slash. (UTF-8)
+			off64_t offset;		// Starting address in the partition.
+			off64_t size;		// File size.
+			uint8_t type;		// File type. (DT_DIR or DT_REG)
+		};
+
+		/**
+		 * List a directory tree.
+		 *
+		 * Directories are listed before their contents.
+		 * Entries with invalid names, e.g. "..", are skipped.
+		 *
+		 * @param path		[in] Directory path. ("/" for the root directory)
+		 * @param entries	[out] Directory entries.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int list(const char *path, std::vector<Entry> &entries);
+
+		/**
+		 * Extract a file or directory tree.
+		 *
+		 * If path is a directory, its contents are extracted
+		 * into outDir. If path is a file, it's extracted into
+		 * outDir using its base filename.
+		 *
+		 * Files are read in order of their starting addresses
+		 * using a pool of reusable buffers, and the buffers are
+		 * written by multiple writer threads.
+		 *
+		 * @param path	[in] File or directory path.
+		 * @param outDir	[in] Output directory. (UTF-8)
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int extract(const char *path, const char *outDir);
+
+	public:
+		/** Extraction options **/
+
+		/**
+		 * Set the size of each buffer.
+		 * Default is 1 MiB.
+		 * @param bufferSize Buffer size, in bytes.
+		 */
+		void setBufferSize(size_t bufferSize);
+
+		/**
+		 * Set the number of buffers.
+		 * Default is twice the number of writer threads.
+		 * @param bufferCount Number of buffers. (0 for default)
+		 */
+		void setBufferCount(unsigned int bufferCount);
+
+		/**
+		 * Set the number of writer threads.
+		 * Default is based on the number of CPUs, up to 4.
+		 * @param writerCount Number of writer threads. (0 for default)
+		 */
+		void setWriterCount(unsigned int writerCount);
+
+	public:
+		/** Statistics from the last extract() **/
+
+		/**
+		 * Get the number of files extracted.
+		 * @return Number of files extracted.
+		 */
+		unsigned int filesExtracted(void) const;
+
+		/**
+		 * Get the number of bytes extracted.
+		 * @return Number of bytes extracted.
+		 */
+		off64_t bytesExtracted(void) const;
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBROMDATA_DISC_FSTEXTRACTOR_HPP__ */
@@ -16,8 +16,10 @@
 using namespace LibRpBase;
 
 // C++ STL classes.
+using std::pair;
 using std::string;
 using std::unordered_map;
+using std::vector;
 
 namespace LibRomData {
 
@@ -52,6 +54,23 @@ class GcnFstPrivate
 		// IFst::Dir* reference counter.
 		int fstDirCount;
 
+		// Path index.
+		// - Key: Normalized path, e.g. "/dir/file.bin".
+		// - Value: FST entry index.
+		// This is built after PATH_INDEX_THRESHOLD lookups,
+		// since most RomData subclasses only look up a few
+		// files and building the index requires reading
+		// every entry name.
+		mutable unordered_map<string, uint32_t> path_index;
+		mutable unsigned int find_path_count;
+		enum class PathIndexState : uint8_t {
+			None,		// Not built yet.
+			Ready,		// Index is built.
+			Failed,		// FST is inconsistent. Use linear lookups.
+		};
+		mutable PathIndexState path_index_state;
+		static const unsigned int PATH_INDEX_THRESHOLD = 4;
+
 		/**
 		 * Check if an fst_entry is a directory.
 		 * @return True if this is a directory; false if it's a regular file.
@@ -77,6 +96,28 @@ class GcnFstPrivate
 		 */
 		const GCN_FST_Entry *entry(int idx, const char **ppszName = nullptr) const;
 
+		/**
+		 * Normalize a path for the path index.
+		 * Empty path components and trailing slashes are removed,
+		 * and a leading slash is added.
+		 * @param path	[in] Path.
+		 * @param out	[out] Normalized path. (empty for the root directory)
+		 */
+		static void normalize_path(const char *path, string &out);
+
+		/**
+		 * Build the path index.
+		 * @return True on success; false if the FST is inconsistent.
+		 */
+		bool build_path_index(void) const;
+
+		/**
+		 * Find a path by scanning the FST.
+		 * @param path Path. (Absolute paths only!)
+		 * @return fst_entry if found, or nullptr if not.
+		 */
+		const GCN_FST_Entry *find_path_linear(const char *path) const;
+
 		/**
 		 * Find a path.
 		 * @param path Path. (Absolute paths only!)
@@ -95,6 +136,8 @@ GcnFstPrivate::GcnFstPrivate(const uint8_t *fstData, uint32_t len, uint8_t offse
 	, string_table_sz(0)
 	, offsetShift(offsetShift)
 	, fstDirCount(0)
+	, find_path_count(0)
+	, path_index_state(PathIndexState::None)
 {
 	assert(fstData != nullptr);
 	assert(len >= sizeof(GCN_FST_Entry));
@@ -222,12 +265,148 @@ const GCN_FST_Entry *GcnFstPrivate::entry(int idx, const char **ppszName) const
 	return &fstData[idx];
 }
 
+/**
+ * Normalize a path for the path index.
+ * Empty path components and trailing slashes are removed,
+ * and a leading slash is added.
+ * @param path	[in] Path.
+ * @param out	[out] Normalized path. (empty for the root directory)
+ */
+void GcnFstPrivate::normalize_path(const char *path, string &out)
+{
+	out.clear();
+	while (*path != '\0') {
+		// Skip slashes.
+		if (*path == '/') {
+			path++;
+			continue;
+		}
+
+		// Copy the path component.
+		const char *const start = path;
+		while (*path != '\0' && *path != '/') {
+			path++;
+		}
+		out += '/';
+		out.append(start, path - start);
+	}
+}
+
+/**
+ * Build the path index.
+ * @return True on success; false if the FST is inconsistent.
+ */
+bool GcnFstPrivate::build_path_index(void) const
+{
+	assert(fstData != nullptr);
+	if (!fstData) {
+		return false;
+	}
+
+	const uint32_t file_count = be32_to_cpu(fstData[0].root_dir.file_count);
+#ifdef HAVE_UNORDERED_MAP_RESERVE
+	// NOTE: file_count includes the root directory entry.
+	path_index.reserve(file_count - 1);
+#endif
+
+	// Directory stack.
+	// - first: Index *after* the last entry in the directory.
+	// - second: Length of the directory's path. (string::npos if unreachable)
+	vector<pair<uint32_t, size_t> > dir_stack;
+	dir_stack.reserve(16);
+	dir_stack.emplace_back(file_count, 0);
+
+	string path;
+	path.reserve(256);
+	for (uint32_t idx = 1; idx < file_count; idx++) {
+		// Leave any directories that end here.
+		// NOTE: The root directory ends at file_count,
+		// so the stack will never be empty.
+		while (idx >= dir_stack.back().first) {
+			dir_stack.pop_back();
+		}
+
+		const GCN_FST_Entry *const fst_entry = &fstData[idx];
+		const char *const pName = entry_name(fst_entry);
+
+		// NOTE: Entries with empty names can't be looked up,
+		// and neither can anything in their subdirectories.
+		// string::npos is used to indicate this.
+		const size_t parent_len = dir_stack.back().second;
+		size_t path_len = string::npos;
+		if (parent_len != string::npos && pName && pName[0] != '\0') {
+			path.resize(parent_len);
+			path += '/';
+			path += pName;
+			path_len = path.size();
+
+			// NOTE: If a directory has duplicate names, the
+			// first entry wins, same as the linear search.
+			path_index.emplace(path, idx);
+		}
+
+		if (is_dir(fst_entry)) {
+			// Subdirectories must end within the parent directory.
+			const uint32_t next_idx = be32_to_cpu(fst_entry->dir.next_offset);
+			if (next_idx <= idx || next_idx > dir_stack.back().first) {
+				// FST is inconsistent.
+				path_index.clear();
+				return false;
+			}
+			dir_stack.emplace_back(next_idx, path_len);
+		}
+	}
+
+	return true;
+}
+
 /**
  * Find a path.
  * @param path Path. (Absolute paths only!)
  * @return fst_entry if found, or nullptr if not.
  */
 const GCN_FST_Entry *GcnFstPrivate::find_path(const char *path) const
+{
+	if (!path || !fstData) {
+		// Invalid path, or no FST.
+		return nullptr;
+	}
+
+	if (path_index_state == PathIndexState::None) {
+		// Build the path index if enough lookups have been done.
+		if (++find_path_count < PATH_INDEX_THRESHOLD) {
+			return find_path_linear(path);
+		}
+		path_index_state = (build_path_index()
+			? PathIndexState::Ready
+			: PathIndexState::Failed);
+	}
+	if (path_index_state != PathIndexState::Ready) {
+		// Path index isn't available.
+		return find_path_linear(path);
+	}
+
+	string s_path;
+	normalize_path(path, s_path);
+	if (s_path.empty()) {
+		// Root directory.
+		return &fstData[0];
+	}
+
+	auto iter = path_index.find(s_path);
+	if (iter == path_index.end()) {
+		// Not found.
+		return nullptr;
+	}
+	return &fstData[iter->second];
+}
+
+/**
+ * Find a path by scanning the FST.
+ * @param path Path. (Absolute paths only!)
+ * @return fst_entry if found, or nullptr if not.
+ */
+const GCN_FST_Entry *GcnFstPrivate::find_path_linear(const char *path) const
 {
 	if (!path) {
 		// Invalid path.
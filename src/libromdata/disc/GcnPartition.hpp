@@ -102,7 +102,7 @@ class GcnPartition : public LibRpBase::IPartition
 		 * @param path	[in] Directory path.
 		 * @return IFst::Dir*, or nullptr on error.
 		 */
-		LibRpBase::IFst::Dir *opendir(const char *path);
+		LibRpBase::IFst::Dir *opendir(const char *path) final;
 
 		/**
 		 * Open a directory.
@@ -120,21 +120,21 @@ class GcnPartition : public LibRpBase::IPartition
 		 * @return IFst::DirEnt, or nullptr if end of directory or on error.
 		 * (TODO: Add lastError()?)
 		 */
-		LibRpBase::IFst::DirEnt *readdir(LibRpBase::IFst::Dir *dirp);
+		LibRpBase::IFst::DirEnt *readdir(LibRpBase::IFst::Dir *dirp) final;
 
 		/**
 		 * Close an opened directory.
 		 * @param dirp IFst::Dir pointer.
 		 * @return 0 on success; negative POSIX error code on error.
 		 */
-		int closedir(LibRpBase::IFst::Dir *dirp);
+		int closedir(LibRpBase::IFst::Dir *dirp) final;
 
 		/**
 		 * Open a file. (read-only)
 		 * @param filename Filename.
 		 * @return IRpFile*, or nullptr on error.
 		 */
-		LibRpFile::IRpFile *open(const char *filename);
+		LibRpFile::IRpFile *open(const char *filename) final;
 };
 
 }
@@ -11,6 +11,7 @@
 #include "librpbase/disc/SparseDiscReader_p.hpp"
 
 #include "../cdrom_structs.h"
+#include "Cdrom2352Reader.hpp"
 #include "IsoPartition.hpp"
 
 // librpbase, librpfile
@@ -83,6 +84,14 @@ class GdiReaderPrivate : public SparseDiscReaderPrivate {
 		 * @return 0 on success; negative POSIX error code on error.
 		 */
 		int openTrack(int trackNumber);
+
+		/**
+		 * Find the block range containing the specified block.
+		 * The track will be opened if it isn't open already.
+		 * @param blockIdx Block index.
+		 * @return Block range, or nullptr if not found.
+		 */
+		const BlockRange *findBlockRange(uint32_t blockIdx);
 };
 
 /** GdiReaderPrivate **/
@@ -300,6 +309,46 @@ int GdiReaderPrivate::openTrack(int trackNumber)
 	return 0;
 }
 
+/**
+ * Find the block range containing the specified block.
+ * The track will be opened if it isn't open already.
+ * @param blockIdx Block index.
+ * @return Block range, or nullptr if not found.
+ */
+const GdiReaderPrivate::BlockRange *GdiReaderPrivate::findBlockRange(uint32_t blockIdx)
+{
+	// TODO: Cache this lookup somewhere or something.
+	const auto blockRanges_cend = blockRanges.cend();
+	for (auto iter = blockRanges.cbegin(); iter != blockRanges_cend; ++iter) {
+		// NOTE: Using volatile because it can change in openTrack().
+		const volatile BlockRange *const vbr = &(*iter);
+		if (blockIdx < vbr->blockStart) {
+			// Not in this track.
+			continue;
+		}
+
+		// Is the track loaded?
+		if (vbr->blockEnd == 0) {
+			// Track isn't loaded. Load it.
+			int ret = openTrack(vbr->trackNumber);
+			if (ret != 0) {
+				// Unable to load the track.
+				// Skip for now.
+				continue;
+			}
+		}
+
+		// Check the end block.
+		if (vbr->blockEnd != 0 && blockIdx <= vbr->blockEnd) {
+			// Found the track.
+			return (const BlockRange*)vbr;
+		}
+	}
+
+	// Not found in any block range.
+	return nullptr;
+}
+
 /** GdiReader **/
 
 GdiReader::GdiReader(IRpFile *file)
@@ -505,36 +554,7 @@ int GdiReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 	}
 
 	// Find the block.
-	// TODO: Cache this lookup somewhere or something.
-	const GdiReaderPrivate::BlockRange *blockRange = nullptr;
-	const auto blockRanges_cend = d->blockRanges.cend();
-	for (auto iter = d->blockRanges.cbegin(); iter != blockRanges_cend; ++iter) {
-		// NOTE: Using volatile because it can change in d->openTrack().
-		const volatile GdiReaderPrivate::BlockRange *const vbr = &(*iter);
-		if (blockIdx < vbr->blockStart) {
-			// Not in this track.
-			continue;
-		}
-
-		// Is the track loaded?
-		if (vbr->blockEnd == 0) {
-			// Track isn't loaded. Load it.
-			int ret = d->openTrack(vbr->trackNumber);
-			if (ret != 0) {
-				// Unable to load the track.
-				// Skip for now.
-				continue;
-			}
-		}
-
-		// Check the end block.
-		if (vbr->blockEnd != 0 && blockIdx <= vbr->blockEnd) {
-			// Found the track.
-			blockRange = (const GdiReaderPrivate::BlockRange*)vbr;
-			break;
-		}
-	}
-
+	const GdiReaderPrivate::BlockRange *const blockRange = d->findBlockRange(blockIdx);
 	if (!blockRange) {
 		// Not found in any block range.
 		return 0;
@@ -570,6 +590,64 @@ int GdiReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 	return (sz_read > 0 ? (int)sz_read : -1);
 }
 
+/**
+ * Read multiple full blocks.
+ * @param blockIdx	[in] First block index.
+ * @param ptr		[out] Output data buffer. (Must be at least blockCount * block_size bytes!)
+ * @param blockCount	[in] Number of blocks to read.
+ * @return Number of full blocks read.
+ */
+size_t GdiReader::readBlocks(uint32_t blockIdx, void *ptr, size_t blockCount)
+{
+	// NOTE: This can only be called by SparseDiscReader,
+	// so the main assertions are already checked there.
+	RP_D(GdiReader);
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t blocksRead = 0;
+
+	// The requested blocks may span multiple tracks.
+	while (blocksRead < blockCount) {
+		if (blockIdx >= d->blockCount) {
+			// Out of range.
+			break;
+		}
+
+		const GdiReaderPrivate::BlockRange *const blockRange = d->findBlockRange(blockIdx);
+		if (!blockRange || !blockRange->file) {
+			// Not found in any block range.
+			break;
+		}
+
+		// Read as many blocks as possible from this track.
+		size_t count = blockCount - blocksRead;
+		if (count > blockRange->blockEnd - blockIdx + 1) {
+			count = blockRange->blockEnd - blockIdx + 1;
+		}
+
+		const off64_t phys_pos = (static_cast<off64_t>(blockIdx - blockRange->blockStart) * blockRange->sectorSize);
+		size_t rd;
+		if (blockRange->sectorSize == 2352) {
+			// 2352-byte sectors.
+			// TODO: Handle audio tracks properly?
+			rd = Cdrom2352Reader::readSectors(blockRange->file, phys_pos, ptr8, count);
+		} else {
+			// 2048-byte sectors.
+			rd = blockRange->file->seekAndRead(phys_pos, ptr8, count * 2048) / 2048;
+		}
+		m_lastError = blockRange->file->lastError();
+
+		blocksRead += rd;
+		blockIdx += static_cast<uint32_t>(rd);
+		ptr8 += rd * 2048;
+		if (rd != count) {
+			// Short read.
+			break;
+		}
+	}
+
+	return blocksRead;
+}
+
 /** GDI-specific functions. **/
 // TODO: "CdromReader" class?
 
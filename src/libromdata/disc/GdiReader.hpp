@@ -83,6 +83,15 @@ class GdiReader : public LibRpBase::SparseDiscReader
 		ATTR_ACCESS_SIZE(write_only, 4, 5)
 		int readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size) final;
 
+		/**
+		 * Read multiple full blocks.
+		 * @param blockIdx	[in] First block index.
+		 * @param ptr		[out] Output data buffer. (Must be at least blockCount * block_size bytes!)
+		 * @param blockCount	[in] Number of blocks to read.
+		 * @return Number of full blocks read.
+		 */
+		size_t readBlocks(uint32_t blockIdx, void *ptr, size_t blockCount) final;
+
 	public:
 		/** GDI-specific functions. **/
 
@@ -7,6 +7,8 @@
  ***************************************************************************/
 
 #include "stdafx.h"
+#include "librpbase/config.librpbase.h"
+
 #include "IsoPartition.hpp"
 #include "iso_structs.h"
 
@@ -17,6 +19,7 @@ using LibRpFile::IRpFile;
 // C++ STL classes.
 using std::string;
 using std::unordered_map;
+using std::vector;
 
 namespace LibRomData {
 
@@ -52,6 +55,28 @@ class IsoPartitionPrivate
 		typedef ao::uvector<uint8_t> DirData_t;
 		unordered_map<string, DirData_t> dir_data;
 
+		// Path table.
+		// - Key: Directory path, WITHOUT leading slash, in lowercase.
+		// - Value: Starting block of the directory.
+		// This allows any directory to be loaded with a single
+		// read instead of walking the directory tree from the root.
+		unordered_map<string, uint32_t> path_table;
+
+		enum class PathTableState : uint8_t {
+			NotLoaded,	// Not loaded yet.
+			Loaded,		// Loaded successfully.
+			Failed,		// Missing or invalid; use the directory tree.
+		};
+		PathTableState path_table_state;
+
+		// Maximum path table size.
+		// Each entry is at least 10 bytes, so this allows
+		// for over 400,000 directories.
+		static const uint32_t PATH_TABLE_SIZE_MAX = 4*1024*1024;
+
+		// Maximum directory size.
+		static const uint32_t DIR_SIZE_MAX = 16*1024*1024;
+
 		/**
 		 * Find the last slash or backslash in a path.
 		 * @param path Path.
@@ -78,6 +103,31 @@ class IsoPartitionPrivate
 		 */
 		const ISO_DirEntry *lookup_int(const DirData_t *pDir, const char *filename, bool bFindDir);
 
+		/**
+		 * Normalize a directory path for the path table.
+		 * Backslashes are converted to slashes, duplicate slashes
+		 * are removed, and the path is converted to lowercase.
+		 * @param path Directory path. (cp1252)
+		 * @return Normalized path, without leading or trailing slashes.
+		 */
+		static string normalizePath(const char *path);
+
+		/**
+		 * Load the path table.
+		 * path_table_state will be set to Loaded or Failed.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int loadPathTable(void);
+
+		/**
+		 * Read a directory.
+		 * @param dir	[out] Directory data.
+		 * @param block	[in] Starting block.
+		 * @param size	[in] Directory size, or 0 to use the size from the "." entry.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int readDirectory(DirData_t &dir, uint32_t block, uint32_t size);
+
 		/**
 		 * Get a directory.
 		 * @param path		[in] Pathname. (cp1252) (For root, specify "" or "/".)
@@ -99,6 +149,14 @@ class IsoPartitionPrivate
 		 * @return Unix time.
 		 */
 		time_t parseTimestamp(const ISO_Dir_DateTime_t *isofiletime);
+
+	public:
+		// IFst::Dir subclass for opendir().
+		struct IsoDir : public IFst::Dir {
+			const DirData_t *pDir;	// Directory data. (owned by dir_data)
+			size_t pos;		// Current position in pDir.
+			string name;		// Current filename. (UTF-8)
+		};
 };
 
 /** IsoPartitionPrivate **/
@@ -109,6 +167,7 @@ IsoPartitionPrivate::IsoPartitionPrivate(IsoPartition *q,
 	, partition_offset(partition_offset)
 	, partition_size(0)
 	, iso_start_offset(iso_start_offset)
+	, path_table_state(PathTableState::NotLoaded)
 {
 	// Clear the PVD struct.
 	memset(&pvd, 0, sizeof(pvd));
@@ -169,11 +228,18 @@ const ISO_DirEntry *IsoPartitionPrivate::lookup_int(const DirData_t *pDir, const
 	int err = ENOENT;
 	const unsigned int filename_len = static_cast<unsigned int>(strlen(filename));
 	const ISO_DirEntry *dirEntry_found = nullptr;
+	const unsigned int block_size = pvd.logical_block_size.he;
 	const uint8_t *p = pDir->data();
 	const uint8_t *const p_end = p + pDir->size();
-	while (p < p_end) {
+	while (p + sizeof(ISO_DirEntry) <= p_end) {
 		const ISO_DirEntry *dirEntry = reinterpret_cast<const ISO_DirEntry*>(p);
-		if (dirEntry->entry_length < sizeof(*dirEntry)) {
+		if (dirEntry->entry_length == 0 && block_size != 0) {
+			// Directory entries can't cross block boundaries,
+			// so the rest of this block is padding.
+			const size_t offset = p - pDir->data();
+			p = pDir->data() + ((offset / block_size) + 1) * block_size;
+			continue;
+		} else if (dirEntry->entry_length < sizeof(*dirEntry)) {
 			// End of directory.
 			break;
 		}
@@ -229,6 +295,232 @@ const ISO_DirEntry *IsoPartitionPrivate::lookup_int(const DirData_t *pDir, const
 	return dirEntry_found;
 }
 
+/**
+ * Normalize a directory path for the path table.
+ * Backslashes are converted to slashes, duplicate slashes
+ * are removed, and the path is converted to lowercase.
+ * @param path Directory path. (cp1252)
+ * @return Normalized path, without leading or trailing slashes.
+ */
+string IsoPartitionPrivate::normalizePath(const char *path)
+{
+	string s_path;
+	s_path.reserve(strlen(path));
+	for (; *path != '\0'; path++) {
+		char chr = *path;
+		if (chr == '/' || chr == '\\') {
+			// Skip leading and duplicate slashes.
+			if (s_path.empty() || s_path[s_path.size()-1] == '/')
+				continue;
+			chr = '/';
+		}
+		s_path += static_cast<char>(TOLOWER(chr));
+	}
+
+	// Remove the trailing slash, if present.
+	if (!s_path.empty() && s_path[s_path.size()-1] == '/') {
+		s_path.resize(s_path.size()-1);
+	}
+	return s_path;
+}
+
+/**
+ * Load the path table.
+ * path_table_state will be set to Loaded or Failed.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int IsoPartitionPrivate::loadPathTable(void)
+{
+	RP_Q(IsoPartition);
+	assert(path_table_state == PathTableState::NotLoaded);
+	path_table_state = PathTableState::Failed;
+
+	// The root directory must be loaded first in order to
+	// determine the ISO start offset.
+	if (iso_start_offset < 0 && !getDirectory("")) {
+		return -EIO;
+	}
+
+	// Check the path table size.
+	// The smallest valid path table has a single root entry.
+	const uint32_t pt_size = pvd.path_table_size.he;
+	if (pt_size < sizeof(ISO_PathTableEntry) + 1 || pt_size > PATH_TABLE_SIZE_MAX) {
+		// Path table is either missing or too big.
+		return -EIO;
+	}
+
+	// Use the L path table if it's present.
+	// Otherwise, use the M path table.
+	bool isM = false;
+	uint32_t pt_block = le32_to_cpu(pvd.path_table_lba_L);
+	if (pt_block == 0) {
+		pt_block = be32_to_cpu(pvd.path_table_lba_M);
+		isM = true;
+	}
+	if (pt_block <= static_cast<unsigned int>(iso_start_offset) + ISO_PVD_LBA) {
+		// Path table can't be located before the PVD.
+		return -EIO;
+	}
+
+	// Load the path table.
+	const unsigned int block_size = pvd.logical_block_size.he;
+	ao::uvector<uint8_t> pt_data;
+	pt_data.resize(pt_size);
+	const off64_t pt_addr = partition_offset +
+		static_cast<off64_t>(pt_block - iso_start_offset) * block_size;
+	size_t size = q->m_discReader->seekAndRead(pt_addr, pt_data.data(), pt_data.size());
+	if (size != pt_data.size()) {
+		// Seek and/or read error.
+		return -EIO;
+	}
+
+	// Full paths of all directories, indexed by directory number - 1.
+	// Entries are sorted by parent directory number, so a
+	// directory's parent is always listed before the directory.
+	vector<string> dir_paths;
+	dir_paths.reserve(pt_size / (sizeof(ISO_PathTableEntry) + 2));
+#ifdef HAVE_UNORDERED_MAP_RESERVE
+	path_table.reserve(pt_size / (sizeof(ISO_PathTableEntry) + 2));
+#endif /* HAVE_UNORDERED_MAP_RESERVE */
+
+	const uint8_t *p = pt_data.data();
+	const uint8_t *const p_end = p + pt_data.size();
+	while (p + sizeof(ISO_PathTableEntry) < p_end) {
+		const ISO_PathTableEntry *const ptEntry = reinterpret_cast<const ISO_PathTableEntry*>(p);
+		if (ptEntry->name_length == 0) {
+			// End of path table.
+			break;
+		}
+
+		const char *const name = reinterpret_cast<const char*>(p) + sizeof(*ptEntry);
+		if (name + ptEntry->name_length > reinterpret_cast<const char*>(p_end)) {
+			// Directory identifier is out of bounds.
+			break;
+		}
+
+		const uint32_t block = (isM ? be32_to_cpu(ptEntry->block) : le32_to_cpu(ptEntry->block));
+		const unsigned int parent_dir_num = (isM
+			? be16_to_cpu(ptEntry->parent_dir_num)
+			: le16_to_cpu(ptEntry->parent_dir_num));
+
+		if (dir_paths.empty()) {
+			// First entry: Root directory.
+			// getDirectory() always loads this from the PVD.
+			dir_paths.emplace_back();
+		} else {
+			if (parent_dir_num == 0 || parent_dir_num > dir_paths.size()) {
+				// Invalid parent directory number.
+				path_table.clear();
+				return -EIO;
+			}
+
+			const string &parent_path = dir_paths[parent_dir_num - 1];
+			string path;
+			path.reserve(parent_path.size() + 1 + ptEntry->name_length);
+			if (!parent_path.empty()) {
+				path = parent_path;
+				path += '/';
+			}
+			for (unsigned int i = 0; i < ptEntry->name_length; i++) {
+				path += static_cast<char>(TOLOWER(name[i]));
+			}
+
+			// NOTE: If a path is duplicated, the first one is used.
+			path_table.emplace(path, block);
+			dir_paths.push_back(std::move(path));
+		}
+
+		// Next entry.
+		// NOTE: Directory identifiers are padded to an even length.
+		p += sizeof(*ptEntry) + ptEntry->name_length + (ptEntry->name_length & 1);
+	}
+
+	if (dir_paths.empty()) {
+		// No entries...
+		return -EIO;
+	}
+
+	path_table_state = PathTableState::Loaded;
+	return 0;
+}
+
+/**
+ * Read a directory.
+ * @param dir	[out] Directory data.
+ * @param block	[in] Starting block.
+ * @param size	[in] Directory size, or 0 to use the size from the "." entry.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int IsoPartitionPrivate::readDirectory(DirData_t &dir, uint32_t block, uint32_t size)
+{
+	RP_Q(IsoPartition);
+	assert(iso_start_offset >= 0);
+	if (block < static_cast<unsigned int>(iso_start_offset) || size > DIR_SIZE_MAX) {
+		// Starting block is invalid, or the directory is too big.
+		q->m_lastError = EIO;
+		return -EIO;
+	}
+
+	// Block size.
+	// Should be 2048, but other values are possible.
+	const unsigned int block_size = pvd.logical_block_size.he;
+
+	// NOTE: Due to variable-length entries, we need to load
+	// the entire directory all at once.
+	const bool checkSize = (size == 0);
+	dir.resize(checkSize ? block_size : size);
+	const off64_t dir_addr = partition_offset +
+		static_cast<off64_t>(block - iso_start_offset) * block_size;
+	size_t sz_read = q->m_discReader->seekAndRead(dir_addr, dir.data(), dir.size());
+	if (sz_read != dir.size()) {
+		// Seek and/or read error.
+		dir.clear();
+		q->m_lastError = q->m_discReader->lastError();
+		if (q->m_lastError == 0) {
+			q->m_lastError = EIO;
+		}
+		return -q->m_lastError;
+	}
+
+	if (checkSize) {
+		// The first entry is always ".", which
+		// contains the size of the directory.
+		const ISO_DirEntry *const dot = reinterpret_cast<const ISO_DirEntry*>(dir.data());
+		const uint32_t dir_size = dot->size.he;
+		if (dot->entry_length < sizeof(*dot) + 1 ||
+		    dot->filename_length != 1 || dir.data()[sizeof(*dot)] != '\0' ||
+		    dot->block.he != block || !(dot->flags & ISO_FLAG_DIRECTORY) ||
+		    dir_size == 0 || dir_size > DIR_SIZE_MAX)
+		{
+			// Not a valid directory.
+			dir.clear();
+			q->m_lastError = EIO;
+			return -EIO;
+		}
+
+		if (dir_size > block_size) {
+			// Read the rest of the directory.
+			// NOTE: Directory extents are contiguous, so no seek is needed.
+			dir.resize(dir_size);
+			const size_t sz_rest = dir_size - block_size;
+			sz_read = q->m_discReader->read(dir.data() + block_size, sz_rest);
+			if (sz_read != sz_rest) {
+				// Read error.
+				dir.clear();
+				q->m_lastError = q->m_discReader->lastError();
+				if (q->m_lastError == 0) {
+					q->m_lastError = EIO;
+				}
+				return -q->m_lastError;
+			}
+		} else {
+			dir.resize(dir_size);
+		}
+	}
+
+	return 0;
+}
+
 /**
  * Get a directory.
  * @param path		[in] Pathname. (cp1252) (For root, specify "" or "/".)
@@ -266,24 +558,11 @@ const IsoPartitionPrivate::DirData_t *IsoPartitionPrivate::getDirectory(const ch
 		return nullptr;
 	}
 
-	// Block size.
-	// Should be 2048, but other values are possible.
-	const unsigned int block_size = pvd.logical_block_size.he;
-
 	if (path[0] == '\0') {
 		// Loading the root directory.
 
 		// Check the root directory entry.
 		const ISO_DirEntry *const rootdir = &pvd.dir_entry_root;
-		if (rootdir->size.he > 16*1024*1024) {
-			// Root directory is too big.
-			q->m_lastError = EIO;
-			if (pError) {
-				*pError = EIO;
-			}
-			return nullptr;
-		}
-
 		if (iso_start_offset >= 0) {
 			// ISO start address was already determined.
 			if (rootdir->block.he < ((unsigned int)iso_start_offset + 2)) {
@@ -312,22 +591,12 @@ const IsoPartitionPrivate::DirData_t *IsoPartitionPrivate::getDirectory(const ch
 		}
 
 		// Load the root directory.
-		// NOTE: Due to variable-length entries, we need to load
-		// the entire root directory all at once.
 		DirData_t dir;
-		dir.resize(rootdir->size.he);
-		const off64_t rootDir_addr = partition_offset +
-			static_cast<off64_t>(rootdir->block.he - iso_start_offset) * block_size;
-		size_t size = q->m_discReader->seekAndRead(rootDir_addr, dir.data(), dir.size());
-		if (size != dir.size()) {
-			// Seek and/or read error.
-			dir.clear();
-			q->m_lastError = q->m_discReader->lastError();
-			if (q->m_lastError == 0) {
-				q->m_lastError = EIO;
-			}
+		int ret = readDirectory(dir, rootdir->block.he, rootdir->size.he);
+		if (ret != 0) {
+			// readDirectory() already set q->lastError().
 			if (pError) {
-				*pError = q->m_lastError;
+				*pError = -ret;
 			}
 			return nullptr;
 		}
@@ -337,8 +606,27 @@ const IsoPartitionPrivate::DirData_t *IsoPartitionPrivate::getDirectory(const ch
 		return &(ins.first->second);
 	}
 
+	// Check the path table first.
+	// If the directory isn't listed, or if it can't be loaded,
+	// fall back to walking the directory tree.
+	if (path_table_state == PathTableState::NotLoaded) {
+		loadPathTable();
+	}
+	if (path_table_state == PathTableState::Loaded) {
+		auto pt_iter = path_table.find(normalizePath(path));
+		if (pt_iter != path_table.end()) {
+			DirData_t dir;
+			if (readDirectory(dir, pt_iter->second, 0) == 0) {
+				// Directory loaded.
+				auto ins = dir_data.emplace(path, std::move(dir));
+				return &(ins.first->second);
+			}
+		}
+	}
+
 	// Get the parent directory.
 	const DirData_t *pDir;
+	const char *const full_path = path;
 	const char *const sl = findLastSlash(path);
 	if (!sl) {
 		// No slash. Parent is root.
@@ -362,32 +650,34 @@ const IsoPartitionPrivate::DirData_t *IsoPartitionPrivate::getDirectory(const ch
 	if (!entry) {
 		// Not found.
 		// lookup_int() already set q->lastError().
+		if (pError) {
+			*pError = q->m_lastError;
+		}
+		return nullptr;
+	} else if (!(entry->flags & ISO_FLAG_DIRECTORY)) {
+		// Not a directory.
+		q->m_lastError = ENOTDIR;
+		if (pError) {
+			*pError = ENOTDIR;
+		}
 		return nullptr;
 	}
 
 	// Load the subdirectory.
-	// NOTE: Due to variable-length entries, we need to load
-	// the entire root directory all at once.
 	DirData_t dir;
-	dir.resize(entry->size.he);
-	const off64_t rootDir_addr = partition_offset +
-		static_cast<off64_t>(entry->block.he - iso_start_offset) * block_size;
-	size_t size = q->m_discReader->seekAndRead(rootDir_addr, dir.data(), dir.size());
-	if (size != dir.size()) {
-		// Seek and/or read error.
-		dir.clear();
-		q->m_lastError = q->m_discReader->lastError();
-		if (q->m_lastError == 0) {
-			q->m_lastError = EIO;
-		}
+	int ret = readDirectory(dir, entry->block.he, entry->size.he);
+	if (ret != 0) {
+		// readDirectory() already set q->lastError().
 		if (pError) {
-			*pError = q->m_lastError;
+			*pError = -ret;
 		}
 		return nullptr;
 	}
 
 	// Subdirectory loaded.
-	auto ins = dir_data.emplace(std::move(s_subdir), std::move(dir));
+	// NOTE: Cached using the full path, since the
+	// same subdirectory name may be used elsewhere.
+	auto ins = dir_data.emplace(full_path, std::move(dir));
 	return &(ins.first->second);
 }
 
@@ -615,11 +905,8 @@ off64_t IsoPartition::partition_size_used(void) const
 
 /** IsoPartition **/
 
-/** GcnFst wrapper functions. **/
+/** IFst wrapper functions. **/
 
-// TODO
-
-#if 0
 /**
  * Open a directory.
  * @param path	[in] Directory path.
@@ -628,51 +915,136 @@ off64_t IsoPartition::partition_size_used(void) const
 IFst::Dir *IsoPartition::opendir(const char *path)
 {
 	RP_D(IsoPartition);
-	if (!d->fst) {
-		// FST isn't loaded.
-		if (d->loadFst() != 0) {
-			// FST load failed.
-			// TODO: Errors?
-			return nullptr;
-		}
+	assert(m_discReader != nullptr);
+	assert(m_discReader->isOpen());
+	if (!m_discReader || !m_discReader->isOpen()) {
+		m_lastError = EBADF;
+		return nullptr;
+	}
+
+	assert(path != nullptr);
+	if (!path) {
+		m_lastError = EINVAL;
+		return nullptr;
+	}
+
+	// Remove leading and trailing slashes.
+	// TODO: Which encoding? Assuming cp1252...
+	string s_path = utf8_to_cp1252(path, -1);
+	while (!s_path.empty() && (s_path[s_path.size()-1] == '/' || s_path[s_path.size()-1] == '\\')) {
+		s_path.resize(s_path.size()-1);
+	}
+	size_t start = 0;
+	while (start < s_path.size() && (s_path[start] == '/' || s_path[start] == '\\')) {
+		start++;
 	}
 
-	return d->fst->opendir(path);
+	const IsoPartitionPrivate::DirData_t *const pDir = d->getDirectory(s_path.c_str() + start);
+	if (!pDir) {
+		// Directory not found.
+		// getDirectory() already set m_lastError.
+		return nullptr;
+	}
+
+	IsoPartitionPrivate::IsoDir *const dirp = new IsoPartitionPrivate::IsoDir;
+	dirp->parent = nullptr;	// not owned by an IFst
+	dirp->dir_idx = 0;
+	dirp->entry.idx = -1;
+	dirp->pDir = pDir;
+	dirp->pos = 0;
+	return dirp;
 }
 
 /**
  * Read a directory entry.
- * @param dirp FstDir pointer.
+ * The "." and ".." entries are skipped, and the ";1"
+ * version suffix is removed from filenames.
+ * @param dirp IFst::Dir pointer.
  * @return IFst::DirEnt*, or nullptr if end of directory or on error.
  * (TODO: Add lastError()?)
  */
 IFst::DirEnt *IsoPartition::readdir(IFst::Dir *dirp)
 {
-	RP_D(IsoPartition);
-	if (!d->fst) {
-		// TODO: Errors?
+	RP_D(const IsoPartition);
+	assert(dirp != nullptr);
+	if (!dirp) {
+		m_lastError = EBADF;
 		return nullptr;
 	}
 
-	return d->fst->readdir(dirp);
+	IsoPartitionPrivate::IsoDir *const isoDir = static_cast<IsoPartitionPrivate::IsoDir*>(dirp);
+	const unsigned int block_size = d->pvd.logical_block_size.he;
+	const uint8_t *const p_start = isoDir->pDir->data();
+	const uint8_t *const p_end = p_start + isoDir->pDir->size();
+	const uint8_t *p = p_start + isoDir->pos;
+	while (p + sizeof(ISO_DirEntry) <= p_end) {
+		const ISO_DirEntry *const dirEntry = reinterpret_cast<const ISO_DirEntry*>(p);
+		if (dirEntry->entry_length == 0 && block_size != 0) {
+			// Directory entries can't cross block boundaries,
+			// so the rest of this block is padding.
+			p = p_start + (((p - p_start) / block_size) + 1) * block_size;
+			continue;
+		} else if (dirEntry->entry_length < sizeof(*dirEntry)) {
+			// End of directory.
+			break;
+		}
+
+		const char *const entry_filename = reinterpret_cast<const char*>(p) + sizeof(*dirEntry);
+		if (entry_filename + dirEntry->filename_length > reinterpret_cast<const char*>(p_end)) {
+			// Filename is out of bounds.
+			break;
+		}
+		p += dirEntry->entry_length;
+
+		// Skip "." and "..", which are stored as 0x00 and 0x01.
+		// "Associated" files can't be opened, so skip them too.
+		unsigned int name_len = dirEntry->filename_length;
+		if (name_len == 0 || (name_len == 1 && static_cast<uint8_t>(entry_filename[0]) <= 1)) {
+			continue;
+		} else if (dirEntry->flags & ISO_FLAG_ASSOCIATED) {
+			continue;
+		}
+
+		const bool isDir = !!(dirEntry->flags & ISO_FLAG_DIRECTORY);
+		if (!isDir && name_len > 2 &&
+		    entry_filename[name_len-2] == ';' && entry_filename[name_len-1] == '1')
+		{
+			// Remove the ";1" suffix.
+			name_len -= 2;
+		}
+
+		isoDir->pos = p - p_start;
+		isoDir->name = cp1252_to_utf8(entry_filename, name_len);
+		dirp->entry.offset = (static_cast<off64_t>(dirEntry->block.he) - d->iso_start_offset) * block_size;
+		dirp->entry.size = dirEntry->size.he;
+		dirp->entry.name = isoDir->name.c_str();
+		dirp->entry.idx++;
+		dirp->entry.type = (isDir ? DT_DIR : DT_REG);
+		return &dirp->entry;
+	}
+
+	// End of directory.
+	isoDir->pos = isoDir->pDir->size();
+	return nullptr;
 }
 
 /**
  * Close an opened directory.
- * @param dirp FstDir pointer.
+ * @param dirp IFst::Dir pointer.
  * @return 0 on success; negative POSIX error code on error.
  */
 int IsoPartition::closedir(IFst::Dir *dirp)
 {
-	RP_D(IsoPartition);
-	if (!d->fst) {
-		// TODO: Errors?
-		return -EBADF;
+	assert(dirp != nullptr);
+	if (!dirp) {
+		// No directory pointer.
+		// In release builds, this is a no-op.
+		return 0;
 	}
 
-	return d->fst->closedir(dirp);
+	delete static_cast<IsoPartitionPrivate::IsoDir*>(dirp);
+	return 0;
 }
-#endif
 
 /**
  * Open a file. (read-only)
@@ -10,7 +10,7 @@
 #define __ROMPROPERTIES_LIBROMDATA_DISC_ISOPARTITION_HPP__
 
 #include "librpbase/disc/IPartition.hpp"
-//#include "librpbase/disc/IFst.hpp"
+#include "librpbase/disc/IFst.hpp"
 
 namespace LibRomData {
 
@@ -94,14 +94,12 @@ class IsoPartition : public LibRpBase::IPartition
 	public:
 		/** IFst wrapper functions. **/
 
-		// TODO
-#if 0
 		/**
 		 * Open a directory.
 		 * @param path	[in] Directory path.
 		 * @return IFst::Dir*, or nullptr on error.
 		 */
-		LibRpBase::IFst::Dir *opendir(const char *path);
+		LibRpBase::IFst::Dir *opendir(const char *path) final;
 
 		/**
 		 * Open a directory.
@@ -119,22 +117,21 @@ class IsoPartition : public LibRpBase::IPartition
 		 * @return IFst::DirEnt, or nullptr if end of directory or on error.
 		 * (TODO: Add lastError()?)
 		 */
-		LibRpBase::IFst::DirEnt *readdir(LibRpBase::IFst::Dir *dirp);
+		LibRpBase::IFst::DirEnt *readdir(LibRpBase::IFst::Dir *dirp) final;
 
 		/**
 		 * Close an opened directory.
 		 * @param dirp IFst::Dir pointer.
 		 * @return 0 on success; negative POSIX error code on error.
 		 */
-		int closedir(LibRpBase::IFst::Dir *dirp);
-#endif
+		int closedir(LibRpBase::IFst::Dir *dirp) final;
 
 		/**
 		 * Open a file. (read-only)
 		 * @param filename Filename.
 		 * @return IRpFile*, or nullptr on error.
 		 */
-		LibRpFile::IRpFile *open(const char *filename);
+		LibRpFile::IRpFile *open(const char *filename) final;
 
 		/**
 		 * Get a file's timestamp.
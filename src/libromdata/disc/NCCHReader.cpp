@@ -16,6 +16,7 @@
 #include "librpbase/crypto/AesCipherFactory.hpp"
 #include "librpbase/crypto/IAesCipher.hpp"
 #endif /* ENABLE_DECRYPTION */
+#include "librpbase/crypto/Hash.hpp"
 using namespace LibRpBase;
 using LibRpFile::IRpFile;
 
@@ -23,6 +24,10 @@ using LibRpFile::IRpFile;
 #include "disc/CIAReader.hpp"
 
 #include "NCCHReader_p.hpp"
+
+// C++ STL classes.
+using std::unique_ptr;
+
 namespace LibRomData {
 
 /** NCCHReaderPrivate **/
@@ -41,6 +46,9 @@ NCCHReaderPrivate::NCCHReaderPrivate(NCCHReader *q,
 #ifdef ENABLE_DECRYPTION
 	, tid_be(0)
 	, cipher(nullptr)
+	, cipher_keyIdx(-1)
+	, cache_address(0)
+	, cache_length(0)
 	, tmd_content_index(0)
 	, isDebug(false)
 #endif /* ENABLE_DECRYPTION */
@@ -49,6 +57,7 @@ NCCHReaderPrivate::NCCHReaderPrivate(NCCHReader *q,
 	memset(&ncch_header, 0, sizeof(ncch_header));
 	memset(&ncch_exheader, 0, sizeof(ncch_exheader));
 	memset(&exefs_header, 0, sizeof(exefs_header));
+	memset(&stats, 0, sizeof(stats));
 
 	// Read the NCCH header.
 	// We're including the signature, since the first 16 bytes
@@ -293,11 +302,14 @@ NCCHReaderPrivate::NCCHReaderPrivate(NCCHReader *q,
 					keyIdx = 1;
 				}
 
+				// NOTE: File sizes aren't necessarily a multiple of 16,
+				// but the files are padded, so round up the section
+				// length to allow reading the last block.
 				encSections.emplace_back(EncSection(
 					exefs_offset + sizeof(exefs_header) +	// Address within NCCH.
 						le32_to_cpu(file_header->offset),
 					exefs_offset,				// Counter base address.
-					le32_to_cpu(file_header->size),
+					(le32_to_cpu(file_header->size) + 15) & ~15U,
 					keyIdx, N3DS_NCCH_SECTION_EXEFS));
 			}
 		}
@@ -347,6 +359,129 @@ int NCCHReaderPrivate::findEncSection(uint32_t address) const
 	// Not an encrypted section.
 	return -1;
 }
+
+/**
+ * Read and decrypt data from an encrypted section.
+ * The cache is not used.
+ *
+ * NOTE: Offset and size must both be multiples of 16.
+ *
+ * @param section	[in] Encrypted section.
+ * @param offset	[in] Starting address, relative to the beginning of the NCCH.
+ * @param ptr		[out] Output buffer.
+ * @param size		[in] Amount of data to read.
+ * @return Number of bytes read and decrypted.
+ */
+size_t NCCHReaderPrivate::decryptFromROM(const EncSection *section, uint32_t offset, uint8_t *ptr, size_t size)
+{
+	assert(section->section > N3DS_NCCH_SECTION_PLAIN);
+	assert(offset % 16 == 0);
+	assert(size % 16 == 0);
+
+	// Read from the ROM image.
+	// This automatically removes the outer CIA
+	// title key encryption if it's present.
+	// NOTE: If a short read occurs, only complete
+	// AES blocks can be decrypted.
+	size_t ret_sz = readFromROM(offset, ptr, size);
+	ret_sz &= ~static_cast<size_t>(15);
+	if (ret_sz == 0) {
+		return 0;
+	}
+
+	// Set the required key if it isn't already loaded.
+	if (cipher_keyIdx != section->keyIdx) {
+		cipher->setKey(ncch_keys[section->keyIdx].u8, sizeof(ncch_keys[section->keyIdx].u8));
+		cipher_keyIdx = section->keyIdx;
+	}
+
+	// Initialize the counter based on section and offset.
+	u128_t ctr;
+	ctr.init_ctr(tid_be, section->section, offset - section->ctr_base);
+	cipher->setIV(ctr.u8, sizeof(ctr.u8));
+
+	// Decrypt the data.
+	ret_sz = cipher->decrypt(ptr, ret_sz);
+	stats.bytesDecrypted += ret_sz;
+	return ret_sz;
+}
+
+/**
+ * Read data from an encrypted section using the decrypted block cache.
+ * Whole cache blocks are decrypted directly into the output buffer.
+ *
+ * NOTE: Offset and size must both be multiples of 16,
+ * and the entire range must be within the section.
+ *
+ * @param section	[in] Encrypted section.
+ * @param offset	[in] Starting address, relative to the beginning of the NCCH.
+ * @param ptr		[out] Output buffer.
+ * @param size		[in] Amount of data to read.
+ * @return Number of bytes read.
+ */
+size_t NCCHReaderPrivate::readEncSection(const EncSection *section, uint32_t offset, uint8_t *ptr, size_t size)
+{
+	assert(offset >= section->address);
+	assert(offset - section->address + size <= section->length);
+
+	size_t sz_total_read = 0;
+	while (size > 0) {
+		if (cache_length == 0 || offset < cache_address || offset >= cache_address + cache_length) {
+			// Not in the cache.
+			// Cache blocks are aligned to the start of the section.
+			const uint32_t section_offset = offset - section->address;
+			const uint32_t block_offset = section_offset % CACHE_BLOCK_SIZE;
+			if (block_offset == 0 && size >= CACHE_BLOCK_SIZE) {
+				// Decrypt whole blocks directly into the output buffer.
+				const size_t sz_direct = size - (size % CACHE_BLOCK_SIZE);
+				const size_t ret_sz = decryptFromROM(section, offset, ptr, sz_direct);
+				sz_total_read += ret_sz;
+				if (ret_sz != sz_direct) {
+					// Short read.
+					break;
+				}
+				offset += static_cast<uint32_t>(ret_sz);
+				ptr += ret_sz;
+				size -= ret_sz;
+				continue;
+			}
+
+			// Load the block into the cache.
+			if (!cache_data) {
+				cache_data.reset(new uint8_t[CACHE_BLOCK_SIZE]);
+			}
+			const uint32_t block_start = section_offset - block_offset;
+			uint32_t block_length = section->length - block_start;
+			if (block_length > CACHE_BLOCK_SIZE) {
+				block_length = CACHE_BLOCK_SIZE;
+			}
+			cache_address = section->address + block_start;
+			cache_length = static_cast<uint32_t>(
+				decryptFromROM(section, cache_address, cache_data.get(), block_length));
+			stats.cacheMisses++;
+			if (offset >= cache_address + cache_length) {
+				// Short read. The requested data isn't available.
+				break;
+			}
+		} else {
+			stats.cacheHits++;
+		}
+
+		// Copy the data from the cache.
+		const uint32_t cache_offset = offset - cache_address;
+		size_t sz_copy = cache_length - cache_offset;
+		if (sz_copy > size) {
+			sz_copy = size;
+		}
+		memcpy(ptr, &cache_data[cache_offset], sz_copy);
+		offset += static_cast<uint32_t>(sz_copy);
+		ptr += sz_copy;
+		size -= sz_copy;
+		sz_total_read += sz_copy;
+	}
+
+	return sz_total_read;
+}
 #endif /* ENABLE_DECRYPTION */
 
 /**
@@ -460,9 +595,10 @@ int NCCHReaderPrivate::loadExHeader(void)
 		memset(exzero, 0, sizeof(ncch_exheader) - exheader_length);
 	}
 
-	// TODO: Verify the ExHeader SHA256.
-	// For now, reject it if some fields are invalid, since this
-	// usually means it's encrypted with a key that isn't available.
+	// NOTE: The ExHeader SHA256 is only checked by verifyHashes(),
+	// since hashing it on every load isn't necessary. Reject the
+	// ExHeader if some fields are invalid, since this usually
+	// means it's encrypted with a key that isn't available.
 	if (ncch_exheader.aci.arm11_local.res_limit_category > N3DS_NCCH_EXHEADER_ACI_ResLimit_Categry_OTHER) {
 		// Invalid application type.
 		return -6;
@@ -486,6 +622,62 @@ int NCCHReaderPrivate::loadExHeader(void)
 	return 0;
 }
 
+/**
+ * Check the SHA-256 hash of a region of the NCCH.
+ *
+ * NOTE: The region is read in multiples of 16 bytes for
+ * decryption purposes, so the region's section must be
+ * padded to a multiple of 16 bytes.
+ *
+ * @param address	[in] Starting address, relative to the beginning of the NCCH.
+ * @param length	[in] Length of the region, in bytes.
+ * @param sha256	[in] Expected SHA-256 hash. (32 bytes)
+ * @return Hash status.
+ */
+NCCHReader::HashStatus NCCHReaderPrivate::checkSHA256(uint32_t address, uint32_t length, const uint8_t *sha256)
+{
+	if (static_cast<off64_t>(address) + length > ncch_length) {
+		// Region is out of range.
+		return NCCHReader::HashStatus::Error;
+	}
+
+	Hash hash(Hash::Algorithm::SHA256);
+	if (!hash.isUsable()) {
+		// SHA-256 isn't available.
+		return NCCHReader::HashStatus::Unknown;
+	}
+
+	RP_Q(NCCHReader);
+	if (q->seek(address) != 0) {
+		// Seek error.
+		return NCCHReader::HashStatus::Error;
+	}
+
+	// Read the region in 64 KB chunks.
+	static const uint32_t BUF_SIZE = 64*1024;
+	unique_ptr<uint8_t[]> buf(new uint8_t[BUF_SIZE]);
+	uint32_t remain = length;
+	while (remain > 0) {
+		const uint32_t sz_hash = std::min(remain, BUF_SIZE);
+		const size_t sz_read = (sz_hash + 15) & ~15U;
+		if (q->read(buf.get(), sz_read) != sz_read) {
+			// Read error.
+			return NCCHReader::HashStatus::Error;
+		}
+		// Only hash the actual region, not the padding.
+		hash.process(buf.get(), sz_hash);
+		remain -= sz_hash;
+	}
+
+	uint8_t digest[32];
+	if (hash.getHash(digest, sizeof(digest)) != 0) {
+		return NCCHReader::HashStatus::Error;
+	}
+	return (memcmp(digest, sha256, sizeof(digest)) == 0
+		? NCCHReader::HashStatus::OK
+		: NCCHReader::HashStatus::Mismatch);
+}
+
 /** NCCHReader **/
 
 /**
@@ -606,24 +798,17 @@ size_t NCCHReader::read(void *ptr, size_t size)
 			}
 		}
 
-		// Read from the ROM image.
-		// This automatically removes the outer CIA
-		// title key encryption if it's present.
-		size_t ret_sz = d->readFromROM(d->pos, ptr8, sz_to_read);
-
-		if (section && section->section > N3DS_NCCH_SECTION_PLAIN) {
-			// Set the required key.
-			// TODO: Don't set the key if it hasn't changed.
-			d->cipher->setKey(d->ncch_keys[section->keyIdx].u8, sizeof(d->ncch_keys[section->keyIdx].u8));
-
-			// Initialize the counter based on section and offset.
-			u128_t ctr;
-			ctr.init_ctr(d->tid_be, section->section, d->pos - section->ctr_base);
-			d->cipher->setIV(ctr.u8, sizeof(ctr.u8));
-
-			// Decrypt the data.
-			// FIXME: Round up to 16 if a short read occurred?
-			ret_sz = d->cipher->decrypt(static_cast<uint8_t*>(ptr), ret_sz);
+		size_t ret_sz;
+		if (section->section > N3DS_NCCH_SECTION_PLAIN) {
+			// Encrypted section.
+			// Decrypted data is cached in blocks.
+			ret_sz = d->readEncSection(section, d->pos, ptr8, sz_to_read);
+		} else {
+			// Plaintext section.
+			// Read from the ROM image.
+			// This automatically removes the outer CIA
+			// title key encryption if it's present.
+			ret_sz = d->readFromROM(d->pos, ptr8, sz_to_read);
 		}
 
 		d->pos += static_cast<uint32_t>(ret_sz);
@@ -1070,4 +1255,108 @@ LibRpFile::IRpFile *NCCHReader::openLogo(void)
 	return this->open(N3DS_NCCH_SECTION_EXEFS, "logo");
 }
 
+/** Hash verification **/
+
+/**
+ * Verify the SHA-256 hashes stored in the NCCH and ExeFS headers.
+ *
+ * This checks the ExHeader, the ExeFS and RomFS superblocks,
+ * and each file in the ExeFS. The RomFS data itself is
+ * protected by the IVFC hash tree, which isn't checked here.
+ *
+ * @param results	[out] Hash verification results.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int NCCHReader::verifyHashes(std::vector<HashResult> &results)
+{
+	RP_D(NCCHReader);
+	assert(isOpen());
+	if (!isOpen()) {
+		m_lastError = EBADF;
+		return -EBADF;
+	} else if (!(d->headers_loaded & NCCHReaderPrivate::HEADER_NCCH)) {
+		// NCCH header wasn't loaded.
+		m_lastError = EIO;
+		return -EIO;
+	} else if (!Hash(Hash::Algorithm::SHA256).isUsable()) {
+		// SHA-256 isn't available.
+		m_lastError = ENOTSUP;
+		return -ENOTSUP;
+	}
+
+	const N3DS_NCCH_Header_NoSig_t *const hdr = &d->ncch_header.hdr;
+	const off64_t prev_pos = d->pos;
+
+	// ExHeader
+	// NOTE: The hash only covers the SCI and ACI. The AccessDesc
+	// is signed separately.
+	if (hdr->exheader_size != cpu_to_le32(0)) {
+		HashResult result;
+		result.name = "ExHeader";
+		result.status = d->checkSHA256(sizeof(N3DS_NCCH_Header_t),
+			N3DS_NCCH_EXHEADER_MIN_SIZE, hdr->exheader_hash);
+		results.emplace_back(std::move(result));
+	}
+
+	// ExeFS
+	const uint32_t exefs_offset = le32_to_cpu(hdr->exefs_offset) << d->media_unit_shift;
+	const uint32_t exefs_hash_region_size = le32_to_cpu(hdr->exefs_hash_region_size) << d->media_unit_shift;
+	if (exefs_hash_region_size > 0) {
+		HashResult result;
+		result.name = "ExeFS";
+		result.status = d->checkSHA256(exefs_offset,
+			exefs_hash_region_size, hdr->exefs_uperblock_hash);
+		results.emplace_back(std::move(result));
+	}
+
+	if (d->headers_loaded & NCCHReaderPrivate::HEADER_EXEFS) {
+		// Check each file in the ExeFS.
+		// NOTE: The hash table is stored in reverse order.
+		const N3DS_ExeFS_Header_t *const exefs_header = &d->exefs_header;
+		for (int i = 0; i < ARRAY_SIZE(exefs_header->files); i++) {
+			const N3DS_ExeFS_File_Header_t *const file_header = &exefs_header->files[i];
+			if (file_header->name[0] == 0)
+				continue;
+
+			HashResult result;
+			result.name = "ExeFS: ";
+			result.name.append(file_header->name,
+				strnlen(file_header->name, sizeof(file_header->name)));
+			result.status = d->checkSHA256(
+				exefs_offset + sizeof(*exefs_header) + le32_to_cpu(file_header->offset),
+				le32_to_cpu(file_header->size),
+				exefs_header->hashes[ARRAY_SIZE(exefs_header->files) - 1 - i]);
+			results.emplace_back(std::move(result));
+		}
+	}
+
+	// RomFS
+	const uint32_t romfs_hash_region_size = le32_to_cpu(hdr->romfs_hash_region_size) << d->media_unit_shift;
+	if (hdr->romfs_size != cpu_to_le32(0) && romfs_hash_region_size > 0) {
+		HashResult result;
+		result.name = "RomFS";
+		result.status = d->checkSHA256(
+			le32_to_cpu(hdr->romfs_offset) << d->media_unit_shift,
+			romfs_hash_region_size, hdr->romfs_uperblock_hash);
+		results.emplace_back(std::move(result));
+	}
+
+	d->pos = prev_pos;
+	return 0;
+}
+
+/** Decryption statistics **/
+
+/**
+ * Get the decryption statistics for this NCCHReader.
+ * Reads that cover whole cache blocks are decrypted
+ * directly, and aren't counted as hits or misses.
+ * @return Decryption statistics.
+ */
+NCCHReader::DecryptStats NCCHReader::decryptStats(void) const
+{
+	RP_D(const NCCHReader);
+	return d->stats;
+}
+
 }
@@ -15,6 +15,10 @@
 #include "librpbase/disc/IPartition.hpp"
 #include "librpbase/crypto/KeyManager.hpp"
 
+// C++ includes.
+#include <string>
+#include <vector>
+
 namespace LibRomData {
 
 class CIAReader;
@@ -201,6 +205,59 @@ class NCCHReader : public LibRpBase::IPartition
 		 * @return IRpFile*, or nullptr on error.
 		 */
 		LibRpFile::IRpFile *openLogo(void);
+
+	public:
+		/** Hash verification **/
+
+		/**
+		 * Hash verification status.
+		 */
+		enum class HashStatus : uint8_t {
+			Unknown = 0,	// Not checked.
+			OK,		// Hash matches.
+			Mismatch,	// Hash does not match.
+			Error,		// Read error.
+		};
+
+		/**
+		 * Hash verification result.
+		 */
+		struct HashResult {
+			std::string name;	// Section name, e.g. "ExHeader" or "ExeFS: .code"
+			HashStatus status;
+		};
+
+		/**
+		 * Verify the SHA-256 hashes stored in the NCCH and ExeFS headers.
+		 *
+		 * This checks the ExHeader, the ExeFS and RomFS superblocks,
+		 * and each file in the ExeFS. The RomFS data itself is
+		 * protected by the IVFC hash tree, which isn't checked here.
+		 *
+		 * @param results	[out] Hash verification results.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int verifyHashes(std::vector<HashResult> &results);
+
+	public:
+		/** Decryption statistics **/
+
+		/**
+		 * Decryption statistics.
+		 */
+		struct DecryptStats {
+			uint64_t bytesDecrypted;	// Total number of bytes decrypted.
+			uint32_t cacheHits;		// Reads handled by the decrypted block cache.
+			uint32_t cacheMisses;		// Blocks loaded into the decrypted block cache.
+		};
+
+		/**
+		 * Get the decryption statistics for this NCCHReader.
+		 * Reads that cover whole cache blocks are decrypted
+		 * directly, and aren't counted as hits or misses.
+		 * @return Decryption statistics.
+		 */
+		DecryptStats decryptStats(void) const;
 };
 
 }
@@ -25,6 +25,7 @@
 #include <stdint.h>
 
 // C++ includes.
+#include <memory>
 #include <vector>
 
 #ifdef ENABLE_DECRYPTION
@@ -111,6 +112,23 @@ class NCCHReaderPrivate
 		 */
 		int loadExHeader(void);
 
+		/**
+		 * Check the SHA-256 hash of a region of the NCCH.
+		 *
+		 * NOTE: The region is read in multiples of 16 bytes for
+		 * decryption purposes, so the region's section must be
+		 * padded to a multiple of 16 bytes.
+		 *
+		 * @param address	[in] Starting address, relative to the beginning of the NCCH.
+		 * @param length	[in] Length of the region, in bytes.
+		 * @param sha256	[in] Expected SHA-256 hash. (32 bytes)
+		 * @return Hash status.
+		 */
+		NCCHReader::HashStatus checkSHA256(uint32_t address, uint32_t length, const uint8_t *sha256);
+
+		// Decryption statistics.
+		NCCHReader::DecryptStats stats;
+
 #ifdef ENABLE_DECRYPTION
 		// Title ID. Used for AES-CTR initialization.
 		// (Big-endian format)
@@ -156,6 +174,48 @@ class NCCHReaderPrivate
 		 */
 		int findEncSection(uint32_t address) const;
 
+		// Key index currently loaded in the cipher. (-1 if none)
+		int8_t cipher_keyIdx;
+
+		// Decrypted block cache.
+		// Encrypted sections are decrypted in blocks of
+		// CACHE_BLOCK_SIZE bytes, aligned to the start of
+		// the section, so small sequential reads don't
+		// need to reinitialize the cipher every time.
+		static const uint32_t CACHE_BLOCK_SIZE = 64*1024;
+		std::unique_ptr<uint8_t[]> cache_data;
+		uint32_t cache_address;	// NCCH-relative address of the cached block.
+		uint32_t cache_length;	// Length of the cached block. (0 if empty)
+
+		/**
+		 * Read and decrypt data from an encrypted section.
+		 * The cache is not used.
+		 *
+		 * NOTE: Offset and size must both be multiples of 16.
+		 *
+		 * @param section	[in] Encrypted section.
+		 * @param offset	[in] Starting address, relative to the beginning of the NCCH.
+		 * @param ptr		[out] Output buffer.
+		 * @param size		[in] Amount of data to read.
+		 * @return Number of bytes read and decrypted.
+		 */
+		size_t decryptFromROM(const EncSection *section, uint32_t offset, uint8_t *ptr, size_t size);
+
+		/**
+		 * Read data from an encrypted section using the decrypted block cache.
+		 * Whole cache blocks are decrypted directly into the output buffer.
+		 *
+		 * NOTE: Offset and size must both be multiples of 16,
+		 * and the entire range must be within the section.
+		 *
+		 * @param section	[in] Encrypted section.
+		 * @param offset	[in] Starting address, relative to the beginning of the NCCH.
+		 * @param ptr		[out] Output buffer.
+		 * @param size		[in] Amount of data to read.
+		 * @return Number of bytes read.
+		 */
+		size_t readEncSection(const EncSection *section, uint32_t offset, uint8_t *ptr, size_t size);
+
 		// TMD content index.
 		uint16_t tmd_content_index;
 
@@ -0,0 +1,518 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * StfsReader.cpp: Microsoft Xbox 360 STFS file reader.                    *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "StfsReader.hpp"
+
+// librpbase, librpfile
+using namespace LibRpBase;
+using LibRpFile::IRpFile;
+
+// C++ STL classes.
+using std::unordered_map;
+using std::vector;
+
+namespace LibRomData {
+
+class StfsReaderPrivate
+{
+	public:
+		StfsReaderPrivate(StfsReader *q,
+			const STFS_Package_Metadata *metadata, bool isCON,
+			int32_t blockNumber, int32_t blockCount,
+			off64_t length, bool consecutive);
+
+	private:
+		RP_DISABLE_COPY(StfsReaderPrivate)
+	protected:
+		StfsReader *const q_ptr;
+
+	public:
+		// Offset of physical block 0.
+		uint32_t dataOffset;
+
+		// Hash table block step. (2 if CON packages have
+		// two copies of each hash table; 1 otherwise.)
+		int32_t tableStep;
+
+		// Top hash table level. (0-2)
+		uint8_t topLevel;
+		// True if the top hash table is stored in the
+		// second block of the pair.
+		bool topAlt;
+
+		// Total number of allocated data blocks.
+		uint32_t totalBlocks;
+
+		// File length and position.
+		off64_t length;
+		off64_t pos;
+
+		// Runs of physically contiguous blocks.
+		struct Extent {
+			uint32_t fileBlock;	// First block, relative to the file.
+			uint32_t physBlock;	// First physical block.
+			uint32_t count;		// Number of blocks.
+		};
+		vector<Extent> extents;
+
+		// Hash table cache.
+		// Key: Physical block number.
+		unordered_map<int32_t, STFS_Hash_Table> hashTables;
+
+		/**
+		 * Convert a data block number to a physical block number.
+		 * Data block numbers don't include hash blocks.
+		 * @param dataBlockNumber Data block number.
+		 * @return Physical block number.
+		 */
+		int32_t dataBlockNumberToPhys(int32_t dataBlockNumber) const;
+
+		/**
+		 * Load a hash table block.
+		 * The block is cached for later use.
+		 * @param physBlock Physical block number.
+		 * @return Hash table, or nullptr on error.
+		 */
+		const STFS_Hash_Table *loadHashTable(int32_t physBlock);
+
+		/**
+		 * Get the level 0 hash entry for a data block.
+		 * This handles selecting the active copy of each
+		 * hash table in CON packages.
+		 * @param dataBlockNumber Data block number.
+		 * @return Hash entry, or nullptr on error.
+		 */
+		const STFS_Hash_Entry *getHashEntry(int32_t dataBlockNumber);
+
+		/**
+		 * Add a physical block to the extent list.
+		 * @param physBlock Physical block number.
+		 */
+		void addBlock(int32_t physBlock);
+};
+
+/** StfsReaderPrivate **/
+
+StfsReaderPrivate::StfsReaderPrivate(StfsReader *q,
+	const STFS_Package_Metadata *metadata, bool isCON,
+	int32_t blockNumber, int32_t blockCount,
+	off64_t length, bool consecutive)
+	: q_ptr(q)
+	, dataOffset(0)
+	, tableStep(1)
+	, topLevel(0)
+	, topAlt(false)
+	, totalBlocks(0)
+	, length(length)
+	, pos(0)
+{
+	assert(q->m_file != nullptr);
+	assert(metadata != nullptr);
+	if (!q->m_file || !metadata) {
+		// No file and/or metadata...
+		UNREF_AND_NULL(q->m_file);
+		return;
+	}
+
+	// Reference: https://github.com/Free60Project/wiki/blob/master/STFS.md
+	const uint32_t headerSize = (be32_to_cpu(metadata->header_size) + 0xFFF) & 0xF000;
+	dataOffset = headerSize;
+
+	// CON packages have two copies of each hash table,
+	// unless the block separation says otherwise.
+	if (isCON) {
+		if (headerSize == 0xB000 || !(metadata->stfs_desc.block_separation & 1)) {
+			tableStep = 2;
+		}
+	}
+	topAlt = (tableStep == 2 && (metadata->stfs_desc.block_separation & 2));
+
+	totalBlocks = be32_to_cpu(metadata->stfs_desc.total_alloc_block_count);
+	if (totalBlocks <= STFS_HASH_ENTRIES_PER_BLOCK) {
+		topLevel = 0;
+	} else if (totalBlocks <= STFS_HASH_ENTRIES_PER_BLOCK * STFS_HASH_ENTRIES_PER_BLOCK) {
+		topLevel = 1;
+	} else {
+		topLevel = 2;
+	}
+
+	if (blockNumber < 0 || blockNumber > 0xFFFFFF || blockCount < 0 || length < 0 ||
+	    length > static_cast<off64_t>(blockCount) * STFS_BLOCK_SIZE)
+	{
+		// Invalid parameters.
+		q->m_lastError = EINVAL;
+		UNREF_AND_NULL_NOCHK(q->m_file);
+		return;
+	}
+
+	// Resolve the block chain.
+	extents.reserve(4);
+	int32_t dataBlock = blockNumber;
+	for (int32_t i = 0; i < blockCount; i++) {
+		addBlock(dataBlockNumberToPhys(dataBlock));
+		if (consecutive) {
+			dataBlock++;
+			continue;
+		}
+
+		// Get the next block from the level 0 hash table.
+		// If the chain is broken, assume the rest of the
+		// blocks are consecutive.
+		const STFS_Hash_Entry *const entry = getHashEntry(dataBlock);
+		if (!entry) {
+			// Read error.
+			q->m_lastError = EIO;
+			UNREF_AND_NULL_NOCHK(q->m_file);
+			return;
+		}
+		const uint32_t nextBlock = (entry->next_block[0] << 16) |
+					   (entry->next_block[1] <<  8) |
+					    entry->next_block[2];
+		if (nextBlock >= totalBlocks) {
+			consecutive = true;
+			dataBlock++;
+		} else {
+			dataBlock = static_cast<int32_t>(nextBlock);
+		}
+	}
+
+	// The block chain is resolved, so the hash tables
+	// aren't needed anymore.
+	hashTables.clear();
+}
+
+/**
+ * Convert a data block number to a physical block number.
+ * Data block numbers don't include hash blocks.
+ * @param dataBlockNumber Data block number.
+ * @return Physical block number.
+ */
+int32_t StfsReaderPrivate::dataBlockNumberToPhys(int32_t dataBlockNumber) const
+{
+	// Reference: https://github.com/Free60Project/wiki/blob/master/STFS.md
+	// Level 0 hash tables precede every 0xAA data blocks.
+	// Level 1 hash tables are inserted every 0x70E4 data blocks,
+	// starting after the first 0xAA data blocks. Level 2 is
+	// inserted after the first 0x70E4 data blocks.
+	int32_t ret = dataBlockNumber +
+		(((dataBlockNumber + 0xAA) / 0xAA) * tableStep);
+	if (dataBlockNumber >= 0xAA) {
+		ret += ((dataBlockNumber + 0x70E4) / 0x70E4) * tableStep;
+		if (dataBlockNumber >= 0x70E4) {
+			ret += ((dataBlockNumber + 0x4AF768) / 0x4AF768) * tableStep;
+		}
+	}
+	return ret;
+}
+
+/**
+ * Load a hash table block.
+ * The block is cached for later use.
+ * @param physBlock Physical block number.
+ * @return Hash table, or nullptr on error.
+ */
+const STFS_Hash_Table *StfsReaderPrivate::loadHashTable(int32_t physBlock)
+{
+	auto iter = hashTables.find(physBlock);
+	if (iter != hashTables.end()) {
+		// Hash table is already cached.
+		return &iter->second;
+	}
+
+	RP_Q(StfsReader);
+	STFS_Hash_Table table;
+	const off64_t offset = dataOffset + (static_cast<off64_t>(physBlock) * STFS_BLOCK_SIZE);
+	size_t size = q->m_file->seekAndRead(offset, &table, sizeof(table));
+	if (size != sizeof(table)) {
+		// Seek and/or read error.
+		return nullptr;
+	}
+
+	auto ins = hashTables.emplace(physBlock, table);
+	return &ins.first->second;
+}
+
+/**
+ * Get the level 0 hash entry for a data block.
+ * This handles selecting the active copy of each
+ * hash table in CON packages.
+ * @param dataBlockNumber Data block number.
+ * @return Hash entry, or nullptr on error.
+ */
+const STFS_Hash_Entry *StfsReaderPrivate::getHashEntry(int32_t dataBlockNumber)
+{
+	static const int32_t L0_BLOCKS = STFS_HASH_ENTRIES_PER_BLOCK;
+	static const int32_t L1_BLOCKS = STFS_HASH_ENTRIES_PER_BLOCK * STFS_HASH_ENTRIES_PER_BLOCK;
+
+	// Each hash table immediately precedes the first data block
+	// it describes, except for the first level 1 and level 2
+	// tables, which follow the first group of data blocks.
+	const int32_t l0Block = dataBlockNumberToPhys(dataBlockNumber - (dataBlockNumber % L0_BLOCKS)) - tableStep;
+
+	bool l0Alt = false;
+	if (tableStep > 1) {
+		// Determine which copy of the level 0 table is active.
+		switch (topLevel) {
+			case 0:
+				l0Alt = topAlt;
+				break;
+
+			case 1:
+			case 2: {
+				const int32_t l1Group = dataBlockNumber / L1_BLOCKS;
+				const int32_t l1Block = dataBlockNumberToPhys(
+					l1Group == 0 ? L0_BLOCKS : (l1Group * L1_BLOCKS)) - (tableStep * 2);
+
+				bool l1Alt = topAlt;
+				if (topLevel == 2) {
+					const int32_t l2Block = dataBlockNumberToPhys(L1_BLOCKS) - (tableStep * 3);
+					const STFS_Hash_Table *const l2 = loadHashTable(l2Block + (topAlt ? 1 : 0));
+					if (!l2 || l1Group >= L0_BLOCKS)
+						return nullptr;
+					l1Alt = !!(l2->entries[l1Group].status & STFS_HASH_STATUS_ALT_TABLE);
+				}
+
+				const STFS_Hash_Table *const l1 = loadHashTable(l1Block + (l1Alt ? 1 : 0));
+				if (!l1)
+					return nullptr;
+				l0Alt = !!(l1->entries[(dataBlockNumber / L0_BLOCKS) % L0_BLOCKS].status & STFS_HASH_STATUS_ALT_TABLE);
+				break;
+			}
+
+			default:
+				assert(!"Invalid top hash table level.");
+				return nullptr;
+		}
+	}
+
+	const STFS_Hash_Table *const l0 = loadHashTable(l0Block + (l0Alt ? 1 : 0));
+	return (l0 ? &l0->entries[dataBlockNumber % L0_BLOCKS] : nullptr);
+}
+
+/**
+ * Add a physical block to the extent list.
+ * @param physBlock Physical block number.
+ */
+void StfsReaderPrivate::addBlock(int32_t physBlock)
+{
+	if (!extents.empty()) {
+		Extent &last = extents.back();
+		if (last.physBlock + last.count == static_cast<uint32_t>(physBlock)) {
+			// Contiguous with the previous run.
+			last.count++;
+			return;
+		}
+	}
+
+	Extent extent;
+	extent.fileBlock = (extents.empty() ? 0 : extents.back().fileBlock + extents.back().count);
+	extent.physBlock = static_cast<uint32_t>(physBlock);
+	extent.count = 1;
+	extents.emplace_back(extent);
+}
+
+/** StfsReader **/
+
+/**
+ * Construct an StfsReader for a file in an STFS package.
+ *
+ * The file's data blocks are resolved to physical blocks
+ * when the reader is constructed. If the blocks aren't
+ * consecutive, the block chain is read from the level 0
+ * hash tables. Physically contiguous blocks are merged,
+ * so read() only needs one read per run of blocks.
+ *
+ * NOTE: The IRpFile *must* remain valid while this
+ * StfsReader is open.
+ *
+ * @param file		[in] IRpFile. (STFS package)
+ * @param metadata	[in] STFS package metadata.
+ * @param isCON		[in] True if this is a console-signed (CON) package.
+ * @param blockNumber	[in] Starting data block number.
+ * @param blockCount	[in] Number of data blocks.
+ * @param length	[in] File length, in bytes.
+ * @param consecutive	[in] True if the data blocks are consecutive.
+ */
+StfsReader::StfsReader(IRpFile *file,
+		const STFS_Package_Metadata *metadata, bool isCON,
+		int32_t blockNumber, int32_t blockCount,
+		off64_t length, bool consecutive)
+	: super(file)
+	, d_ptr(new StfsReaderPrivate(this, metadata, isCON,
+		blockNumber, blockCount, length, consecutive))
+{ }
+
+StfsReader::~StfsReader()
+{
+	delete d_ptr;
+}
+
+/** IDiscReader **/
+
+/**
+ * Read data from the file.
+ * @param ptr Output data buffer.
+ * @param size Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t StfsReader::read(void *ptr, size_t size)
+{
+	RP_D(StfsReader);
+	assert(ptr != nullptr);
+	assert(isOpen());
+	if (!ptr) {
+		m_lastError = EINVAL;
+		return 0;
+	} else if (!isOpen()) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	// Are we already at the end of the file?
+	if (d->pos >= d->length)
+		return 0;
+
+	// Make sure d->pos + size <= d->length.
+	// If it isn't, we'll do a short read.
+	if (d->pos + static_cast<off64_t>(size) >= d->length) {
+		size = static_cast<size_t>(d->length - d->pos);
+	}
+
+	// Find the extent containing the current position.
+	const uint32_t fileBlock = static_cast<uint32_t>(d->pos / STFS_BLOCK_SIZE);
+	auto iter = std::upper_bound(d->extents.cbegin(), d->extents.cend(), fileBlock,
+		[](uint32_t block, const StfsReaderPrivate::Extent &extent) {
+			return block < extent.fileBlock;
+		});
+	assert(iter != d->extents.cbegin());
+	if (iter == d->extents.cbegin()) {
+		// Shouldn't happen...
+		m_lastError = EIO;
+		return 0;
+	}
+	--iter;
+
+	// Read each run of physically contiguous blocks at once.
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t sz_total_read = 0;
+	const auto extents_cend = d->extents.cend();
+	for (; size > 0 && iter != extents_cend; ++iter) {
+		const off64_t extOffset = d->pos - (static_cast<off64_t>(iter->fileBlock) * STFS_BLOCK_SIZE);
+		const off64_t extSize = static_cast<off64_t>(iter->count) * STFS_BLOCK_SIZE;
+		const size_t sz_to_read = static_cast<size_t>(
+			std::min(static_cast<off64_t>(size), extSize - extOffset));
+
+		const off64_t physOffset = d->dataOffset +
+			(static_cast<off64_t>(iter->physBlock) * STFS_BLOCK_SIZE) + extOffset;
+		const size_t sz_read = m_file->seekAndRead(physOffset, ptr8, sz_to_read);
+		d->pos += sz_read;
+		ptr8 += sz_read;
+		sz_total_read += sz_read;
+		size -= sz_read;
+		if (sz_read != sz_to_read) {
+			// Short read.
+			m_lastError = m_file->lastError();
+			if (m_lastError == 0) {
+				m_lastError = EIO;
+			}
+			break;
+		}
+	}
+
+	return sz_total_read;
+}
+
+/**
+ * Set the file position.
+ * @param pos File position.
+ * @return 0 on success; -1 on error.
+ */
+int StfsReader::seek(off64_t pos)
+{
+	RP_D(StfsReader);
+	assert(isOpen());
+	if (!isOpen()) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	// Handle out-of-range cases.
+	if (pos < 0) {
+		// Negative is invalid.
+		m_lastError = EINVAL;
+		return -1;
+	} else if (pos >= d->length) {
+		d->pos = d->length;
+	} else {
+		d->pos = pos;
+	}
+	return 0;
+}
+
+/**
+ * Get the file position.
+ * @return File position on success; -1 on error.
+ */
+off64_t StfsReader::tell(void)
+{
+	RP_D(const StfsReader);
+	assert(isOpen());
+	if (!isOpen()) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	return d->pos;
+}
+
+/**
+ * Get the data size.
+ * @return Data size, or -1 on error.
+ */
+off64_t StfsReader::size(void)
+{
+	RP_D(const StfsReader);
+	assert(isOpen());
+	if (!isOpen()) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	return d->length;
+}
+
+/** IPartition **/
+
+/**
+ * Get the partition size.
+ * This is the size of the file's data blocks.
+ * @return Partition size, or -1 on error.
+ */
+off64_t StfsReader::partition_size(void) const
+{
+	RP_D(const StfsReader);
+	if (!isOpen() || d->extents.empty())
+		return -1;
+
+	const StfsReaderPrivate::Extent &last = d->extents.back();
+	return static_cast<off64_t>(last.fileBlock + last.count) * STFS_BLOCK_SIZE;
+}
+
+/**
+ * Get the used partition size.
+ * This is the size of the file's data blocks.
+ * @return Used partition size, or -1 on error.
+ */
+off64_t StfsReader::partition_size_used(void) const
+{
+	// NOTE: For StfsReader, this is the same as partition_size().
+	return partition_size();
+}
+
+}
@@ -0,0 +1,109 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * StfsReader.hpp: Microsoft Xbox 360 STFS file reader.                    *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBROMDATA_DISC_STFSREADER_HPP__
+#define __ROMPROPERTIES_LIBROMDATA_DISC_STFSREADER_HPP__
+
+#include "../Console/xbox360_stfs_structs.h"
+
+// librpbase
+#include "librpbase/disc/IPartition.hpp"
+
+namespace LibRomData {
+
+class StfsReaderPrivate;
+class StfsReader : public LibRpBase::IPartition
+{
+	public:
+		/**
+		 * Construct an StfsReader for a file in an STFS package.
+		 *
+		 * The file's data blocks are resolved to physical blocks
+		 * when the reader is constructed. If the blocks aren't
+		 * consecutive, the block chain is read from the level 0
+		 * hash tables. Physically contiguous blocks are merged,
+		 * so read() only needs one read per run of blocks.
+		 *
+		 * NOTE: The IRpFile *must* remain valid while this
+		 * StfsReader is open.
+		 *
+		 * @param file		[in] IRpFile. (STFS package)
+		 * @param metadata	[in] STFS package metadata.
+		 * @param isCON		[in] True if this is a console-signed (CON) package.
+		 * @param blockNumber	[in] Starting data block number.
+		 * @param blockCount	[in] Number of data blocks.
+		 * @param length	[in] File length, in bytes.
+		 * @param consecutive	[in] True if the data blocks are consecutive.
+		 */
+		StfsReader(LibRpFile::IRpFile *file,
+			const STFS_Package_Metadata *metadata, bool isCON,
+			int32_t blockNumber, int32_t blockCount,
+			off64_t length, bool consecutive);
+	protected:
+		virtual ~StfsReader();	// call unref() instead
+
+	private:
+		typedef IPartition super;
+		RP_DISABLE_COPY(StfsReader)
+
+	protected:
+		friend class StfsReaderPrivate;
+		StfsReaderPrivate *const d_ptr;
+
+	public:
+		/** IDiscReader **/
+
+		/**
+		 * Read data from the file.
+		 * @param ptr Output data buffer.
+		 * @param size Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 2, 3)
+		size_t read(void *ptr, size_t size) final;
+
+		/**
+		 * Set the file position.
+		 * @param pos File position.
+		 * @return 0 on success; -1 on error.
+		 */
+		int seek(off64_t pos) final;
+
+		/**
+		 * Get the file position.
+		 * @return File position on success; -1 on error.
+		 */
+		off64_t tell(void) final;
+
+		/**
+		 * Get the data size.
+		 * @return Data size, or -1 on error.
+		 */
+		off64_t size(void) final;
+
+	public:
+		/** IPartition **/
+
+		/**
+		 * Get the partition size.
+		 * This is the size of the file's data blocks.
+		 * @return Partition size, or -1 on error.
+		 */
+		off64_t partition_size(void) const final;
+
+		/**
+		 * Get the used partition size.
+		 * This is the size of the file's data blocks.
+		 * @return Used partition size, or -1 on error.
+		 */
+		off64_t partition_size_used(void) const final;
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBROMDATA_DISC_STFSREADER_HPP__ */
@@ -15,6 +15,9 @@
 using namespace LibRpBase;
 using LibRpFile::IRpFile;
 
+// C++ STL classes.
+using std::vector;
+
 namespace LibRomData {
 
 class WbfsReaderPrivate : public SparseDiscReaderPrivate {
@@ -72,6 +75,33 @@ class WbfsReaderPrivate : public SparseDiscReaderPrivate {
 		 * @return Non-sparse size, in bytes.
 		 */
 		off64_t getWbfsDiscSize(const wbfs_disc_t *disc) const;
+
+	public:
+		// Run-length map of the disc, built when the disc is opened.
+		// Each extent is either a run of physically contiguous
+		// blocks or a run of empty blocks. (physBlock == 0)
+		struct Extent {
+			uint32_t blockStart;	// First logical block.
+			uint32_t blockCount;	// Number of blocks.
+			uint32_t physBlock;	// First physical block. (0 == empty)
+		};
+		vector<Extent> extents;
+
+		// Amount of data actually stored in the WBFS image.
+		off64_t size_used;
+
+		/**
+		 * Build the extent map from wlba_table[].
+		 * @param blockCount Number of logical blocks.
+		 */
+		void buildExtentMap(uint32_t blockCount);
+
+		/**
+		 * Find the extent containing the specified logical block.
+		 * @param blockIdx Logical block index.
+		 * @return Extent, or nullptr if out of range.
+		 */
+		const Extent *findExtent(uint32_t blockIdx) const;
 };
 
 /** WbfsReaderPrivate **/
@@ -81,6 +111,7 @@ WbfsReaderPrivate::WbfsReaderPrivate(WbfsReader *q)
 	, m_wbfs(nullptr)
 	, m_wbfs_disc(nullptr)
 	, wlba_table(nullptr)
+	, size_used(0)
 { }
 
 WbfsReaderPrivate::~WbfsReaderPrivate()
@@ -330,6 +361,63 @@ off64_t WbfsReaderPrivate::getWbfsDiscSize(const wbfs_disc_t *disc) const
 	return (static_cast<off64_t>(lastBlock) + 1) * static_cast<off64_t>(p->wbfs_sec_sz);
 }
 
+/**
+ * Build the extent map from wlba_table[].
+ * @param blockCount Number of logical blocks.
+ */
+void WbfsReaderPrivate::buildExtentMap(uint32_t blockCount)
+{
+	extents.clear();
+	size_used = 0;
+
+	uint32_t usedBlocks = 0;
+	for (uint32_t i = 0; i < blockCount; i++) {
+		const uint32_t physBlock = be16_to_cpu(wlba_table[i]);
+		if (physBlock != 0) {
+			usedBlocks++;
+		}
+
+		if (!extents.empty()) {
+			Extent &last = extents.back();
+			if (last.physBlock == 0 && physBlock == 0) {
+				// Continuing a run of empty blocks.
+				last.blockCount++;
+				continue;
+			} else if (last.physBlock != 0 && physBlock == last.physBlock + last.blockCount) {
+				// Continuing a run of contiguous blocks.
+				last.blockCount++;
+				continue;
+			}
+		}
+
+		Extent extent;
+		extent.blockStart = i;
+		extent.blockCount = 1;
+		extent.physBlock = physBlock;
+		extents.emplace_back(extent);
+	}
+
+	size_used = static_cast<off64_t>(usedBlocks) * block_size;
+}
+
+/**
+ * Find the extent containing the specified logical block.
+ * @param blockIdx Logical block index.
+ * @return Extent, or nullptr if out of range.
+ */
+const WbfsReaderPrivate::Extent *WbfsReaderPrivate::findExtent(uint32_t blockIdx) const
+{
+	auto iter = std::upper_bound(extents.cbegin(), extents.cend(), blockIdx,
+		[](uint32_t block, const Extent &extent) {
+			return block < extent.blockStart;
+		});
+	if (iter == extents.cbegin()) {
+		return nullptr;
+	}
+	--iter;
+	return (blockIdx < iter->blockStart + iter->blockCount ? &(*iter) : nullptr);
+}
+
 /** WbfsReader **/
 
 WbfsReader::WbfsReader(IRpFile *file)
@@ -368,6 +456,9 @@ WbfsReader::WbfsReader(IRpFile *file)
 
 	// Get the size of the WBFS disc.
 	d->disc_size = d->getWbfsDiscSize(d->m_wbfs_disc);
+
+	// Build the extent map.
+	d->buildExtentMap(static_cast<uint32_t>(d->disc_size / d->block_size));
 }
 
 /**
@@ -439,4 +530,85 @@ off64_t WbfsReader::getPhysBlockAddr(uint32_t blockIdx) const
 	return (static_cast<off64_t>(physBlockIdx) * d->block_size);
 }
 
+/**
+ * Read multiple full blocks.
+ *
+ * Physically contiguous blocks are read with a single I/O operation.
+ * Empty blocks are zero-filled without reading from the file.
+ *
+ * @param blockIdx	[in] First block index.
+ * @param ptr		[out] Output data buffer. (Must be at least blockCount * block_size bytes!)
+ * @param blockCount	[in] Number of blocks to read.
+ * @return Number of full blocks read.
+ */
+size_t WbfsReader::readBlocks(uint32_t blockIdx, void *ptr, size_t blockCount)
+{
+	// NOTE: This can only be called by SparseDiscReader,
+	// so the main assertions are already checked there.
+	RP_D(const WbfsReader);
+	const unsigned int block_size = d->block_size;
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t blocksRead = 0;
+
+	while (blocksRead < blockCount) {
+		const WbfsReaderPrivate::Extent *const extent = d->findExtent(blockIdx);
+		if (!extent) {
+			// Out of range.
+			break;
+		}
+
+		// Read as many blocks as possible from this extent.
+		size_t count = blockCount - blocksRead;
+		const uint32_t extentRemain = extent->blockStart + extent->blockCount - blockIdx;
+		if (count > extentRemain) {
+			count = extentRemain;
+		}
+
+		size_t rd;
+		if (extent->physBlock == 0) {
+			// Empty blocks.
+			memset(ptr8, 0, count * block_size);
+			rd = count;
+		} else {
+			const off64_t physAddr = static_cast<off64_t>(
+				extent->physBlock + (blockIdx - extent->blockStart)) * block_size;
+			rd = m_file->seekAndRead(physAddr, ptr8, count * block_size) / block_size;
+			if (rd != count) {
+				// Short read.
+				m_lastError = m_file->lastError();
+				if (m_lastError == 0) {
+					m_lastError = EIO;
+				}
+			}
+		}
+
+		blocksRead += rd;
+		blockIdx += static_cast<uint32_t>(rd);
+		ptr8 += rd * block_size;
+		if (rd != count) {
+			// Short read.
+			break;
+		}
+	}
+
+	return blocksRead;
+}
+
+/** WBFS-specific functions. **/
+
+/**
+ * Get the used disc size.
+ * This is the amount of data actually stored in the
+ * WBFS image, i.e. the disc size minus empty blocks.
+ * @return Used disc size, or -1 on error.
+ */
+off64_t WbfsReader::partition_size_used(void) const
+{
+	RP_D(const WbfsReader);
+	if (!m_file) {
+		return -1;
+	}
+	return d->size_used;
+}
+
 }
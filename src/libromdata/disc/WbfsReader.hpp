@@ -62,6 +62,30 @@ class WbfsReader : public LibRpBase::SparseDiscReader
 		 * @return Physical address. (0 == empty block; -1 == invalid block index)
 		 */
 		off64_t getPhysBlockAddr(uint32_t blockIdx) const final;
+
+		/**
+		 * Read multiple full blocks.
+		 *
+		 * Physically contiguous blocks are read with a single I/O operation.
+		 * Empty blocks are zero-filled without reading from the file.
+		 *
+		 * @param blockIdx	[in] First block index.
+		 * @param ptr		[out] Output data buffer. (Must be at least blockCount * block_size bytes!)
+		 * @param blockCount	[in] Number of blocks to read.
+		 * @return Number of full blocks read.
+		 */
+		size_t readBlocks(uint32_t blockIdx, void *ptr, size_t blockCount) final;
+
+	public:
+		/** WBFS-specific functions. **/
+
+		/**
+		 * Get the used disc size.
+		 * This is the amount of data actually stored in the
+		 * WBFS image, i.e. the disc size minus empty blocks.
+		 * @return Used disc size, or -1 on error.
+		 */
+		off64_t partition_size_used(void) const;
 };
 
 }
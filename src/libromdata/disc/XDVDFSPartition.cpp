@@ -17,6 +17,7 @@ using LibRpFile::IRpFile;
 // C++ STL classes.
 using std::string;
 using std::unordered_map;
+using std::vector;
 
 namespace LibRomData {
 
@@ -41,37 +42,95 @@ class XDVDFSPartitionPrivate
 		// All fields are byteswapped in the constructor.
 		XDVDFS_Header xdvdfsHeader;
 
-		// Cached directories.
-		// - Key: Directory. ("/" for root)
-		// - Value: Raw directory table from the disc.
-		// NOTE: Directory entries are variable-length, so this
-		// is a byte array, not an ISO_DirEntry array.
-		unordered_map<std::string, ao::uvector<uint8_t> > dirTables;
+		// Cached directory sectors.
+		// - Key: Sector number, relative to the partition.
+		// - Value: Sector data.
+		// XDVDFS directories are binary trees, so only the
+		// sectors containing the nodes that are visited
+		// during a lookup are loaded.
+		unordered_map<uint32_t, ao::uvector<uint8_t> > dirSectors;
 
 		/**
-		 * Get an entry within a specified directory table.
-		 * @param dirTable Directory table.
-		 * @param filename Filename to find, without subdirectories.
-		 * @return Pointer to XDVDFS_DirEntry within dirTable, or nullptr if not found.
+		 * Directory entry, with byteswapped fields and
+		 * a NULL-terminated filename.
 		 */
-		const XDVDFS_DirEntry *getDirEntry(const ao::uvector<uint8_t> *dirTable, const char *filename);
+		struct DirNode {
+			uint16_t left_offset;	// Offset to left subtree entry, in DWORDs. (0 for none)
+			uint16_t right_offset;	// Offset to right subtree entry, in DWORDs. (0 for none)
+			uint32_t start_sector;	// Starting sector
+			uint32_t file_size;	// File size, in bytes
+			uint8_t attributes;	// Attributes bitfield (See XDVDFS_Attributes_e)
+			uint8_t name_length;	// Filename length, in bytes
+			char name[256];		// Filename (cp1252)
+
+			inline bool isDir(void) const
+			{
+				return !!(attributes & XDVDFS_ATTR_DIRECTORY);
+			}
+		};
 
 		/**
-		 * Get the specified directory.
-		 * This should *only* be the directory, not a filename.
-		 * @param path Directory path.
-		 * @return Pointer to directory table (ao::uvector), or nullptr if not found.
+		 * XDVDFS Dir struct for opendir()/readdir().
+		 * Entries are returned in tree order, which is sorted.
 		 */
-		const ao::uvector<uint8_t> *getDirectory(const char *path);
+		struct XDVDFSDir : public IFst::Dir {
+			uint32_t dir_sector;		// Directory table sector
+			uint32_t dir_size;		// Directory table size, in bytes
+			uint32_t cur;			// Next node to descend into (NO_NODE for none)
+			unsigned int entries_left;	// Maximum number of entries left (loop protection)
+			vector<uint16_t> stack;		// Nodes whose right subtrees haven't been visited
+			string name;			// Current filename (UTF-8)
+		};
+
+		// "No node" value for XDVDFSDir::cur.
+		static const uint32_t NO_NODE = ~0U;
 
 		/**
-		 * XDVDFS strcasecmp() implementation.
+		 * Get a directory sector.
+		 * @param sector Sector number, relative to the partition.
+		 * @return Sector data (XDVDFS_BLOCK_SIZE bytes), or nullptr on error.
+		 */
+		const uint8_t *getDirSector(uint32_t sector);
+
+		/**
+		 * Read a directory entry from a directory table.
+		 * @param dir_sector	[in] Directory table sector.
+		 * @param dir_size	[in] Directory table size, in bytes.
+		 * @param offset	[in] Entry offset, in DWORDs.
+		 * @param node		[out] Directory entry.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int readDirNode(uint32_t dir_sector, uint32_t dir_size, uint32_t offset, DirNode *node);
+
+		/**
+		 * Find an entry in a directory by walking its binary tree.
+		 * @param dir_sector	[in] Directory table sector.
+		 * @param dir_size	[in] Directory table size, in bytes.
+		 * @param name		[in] Filename. (cp1252)
+		 * @param node		[out] Directory entry.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int findInDir(uint32_t dir_sector, uint32_t dir_size, const string &name, DirNode *node);
+
+		/**
+		 * Look up a file or directory by path.
+		 * The root directory is returned as a directory entry with an empty name.
+		 * @param path	[in] Path. (UTF-8)
+		 * @param node	[out] Directory entry.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int lookup(const char *path, DirNode *node);
+
+		/**
+		 * XDVDFS filename comparison.
 		 * Uses generic ASCII handling instead of locale-specific case folding.
 		 * @param s1 String 1
+		 * @param len1 Length of string 1
 		 * @param s2 String 2
+		 * @param len2 Length of string 2
 		 * @return 0 (==), negative (<), or positive (>).
 		 */
-		static int xdvdfs_strcasecmp(const char *s1, const char *s2);
+		static int xdvdfs_strcasecmp(const char *s1, size_t len1, const char *s2, size_t len2);
 };
 
 /** XDVDFSPartitionPrivate **/
@@ -120,205 +179,271 @@ XDVDFSPartitionPrivate::XDVDFSPartitionPrivate(XDVDFSPartition *q,
 
 #if SYS_BYTEORDER == SYS_BIG_ENDIAN
 	// Byteswap the fields.
-	d->xdvdfsHeader.root_dir_sector	= le32_to_cpu(d->xdvdfsHeader.root_dir_sector);
-	d->xdvdfsHeader.root_dir_size	= le32_to_cpu(d->xdvdfsHeader.root_dir_size);
-	d->xdvdfsHeader.timestamp	= le64_to_cpu(d->xdvdfsHeader.timestamp);
+	xdvdfsHeader.root_dir_sector	= le32_to_cpu(xdvdfsHeader.root_dir_sector);
+	xdvdfsHeader.root_dir_size	= le32_to_cpu(xdvdfsHeader.root_dir_size);
+	xdvdfsHeader.timestamp		= le64_to_cpu(xdvdfsHeader.timestamp);
 #endif /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
 
-	// Load the root directory.
-	getDirectory("/");
+	// Root directory size should be less than 16 MB.
+	if (xdvdfsHeader.root_dir_size > 16*1024*1024) {
+		// Root directory is too big.
+		memset(&xdvdfsHeader, 0, sizeof(xdvdfsHeader));
+		UNREF_AND_NULL_NOCHK(q->m_discReader);
+		return;
+	}
+
+	// Load the first sector of the root directory.
+	if (xdvdfsHeader.root_dir_size != 0) {
+		getDirSector(xdvdfsHeader.root_dir_sector);
+	}
 }
 
 XDVDFSPartitionPrivate::~XDVDFSPartitionPrivate()
 { }
 
 /**
- * XDVDFS strcasecmp() implementation.
+ * XDVDFS filename comparison.
  * Uses generic ASCII handling instead of locale-specific case folding.
  * @param s1 String 1
+ * @param len1 Length of string 1
  * @param s2 String 2
+ * @param len2 Length of string 2
  * @return 0 (==), negative (<), or positive (>).
  */
-int XDVDFSPartitionPrivate::xdvdfs_strcasecmp(const char *s1, const char *s2)
+int XDVDFSPartitionPrivate::xdvdfs_strcasecmp(const char *s1, size_t len1, const char *s2, size_t len2)
 {
 	// Reference: https://github.com/XboxDev/extract-xiso/blob/master/extract-xiso.c
 	// av1_compare_key()
-	while (true) {
-		char a = *s1++;
-		char b = *s2++;
+	const size_t len = std::min(len1, len2);
+	for (size_t i = 0; i < len; i++) {
+		char a = s1[i];
+		char b = s2[i];
 
 		// Convert to uppercase.
 		if (a >= 'a' && a <= 'z') a &= ~0x20;
 		if (b >= 'a' && b <= 'z') b &= ~0x20;
 
-		if (a) {
-			if (b) {
-				if (a < b) return -1;
-				if (a > b) return 1;
-			} else return 1;
-		} else return (b ? -1 : 0);
+		if (a < b) return -1;
+		if (a > b) return 1;
 	}
+
+	// If one string is a prefix of the other,
+	// the shorter string is sorted first.
+	if (len1 < len2) return -1;
+	if (len1 > len2) return 1;
+	return 0;
 }
 
 /**
- * Get an entry within a specified directory table.
- * @param dirTable Directory table.
- * @param filename Filename to find, without subdirectories.
- * @return Pointer to XDVDFS_DirEntry within dirTable, or nullptr if not found.
+ * Get a directory sector.
+ * @param sector Sector number, relative to the partition.
+ * @return Sector data (XDVDFS_BLOCK_SIZE bytes), or nullptr on error.
  */
-const XDVDFS_DirEntry *XDVDFSPartitionPrivate::getDirEntry(const ao::uvector<uint8_t> *dirTable, const char *filename)
+const uint8_t *XDVDFSPartitionPrivate::getDirSector(uint32_t sector)
 {
-	assert(dirTable != nullptr);
-	assert(filename != nullptr);
-	if (unlikely(!dirTable || !filename)) {
-		RP_Q(XDVDFSPartition);
-		q->m_lastError = EINVAL;
-		return nullptr;
+	// Is this sector already loaded?
+	auto iter = dirSectors.find(sector);
+	if (iter != dirSectors.end()) {
+		// Sector is already loaded.
+		return iter->second.data();
 	}
 
-	// Convert the filename portion to cp1252 before searching.
-	const string s_filename = utf8_to_cp1252(filename, -1);
-
-	// Find the file in the specified directory.
-	// NOTE: Filenames are case-insensitive.
-	const XDVDFS_DirEntry *dirEntry_found = nullptr;
-	const uint8_t *const p_start = dirTable->data();
-	const uint8_t *const p_end = p_start + dirTable->size();
-	const uint8_t *p = p_start;
-	string s_entry_filename;	// Temporary for NULL termination.
-	while (p < p_end) {
-		const XDVDFS_DirEntry *dirEntry = reinterpret_cast<const XDVDFS_DirEntry*>(p);
-		const char *entry_filename = reinterpret_cast<const char*>(p) + sizeof(*dirEntry);
-		if (entry_filename + dirEntry->name_length > reinterpret_cast<const char*>(p_end)) {
-			// Filename is out of bounds.
-			break;
-		}
-
-		// NOTE: Filename might not be NULL-terminated.
-		// Temporarily cache the filename.
-		s_entry_filename.assign(entry_filename, dirEntry->name_length);
-
-		// Check the filename.
-		// TODO: Use non-locale-specific case-insensitive check? (only letters)
-		uint16_t subtree_offset = 0;
-		int cmp = xdvdfs_strcasecmp(s_filename.c_str(), s_entry_filename.c_str());
-		if (cmp == 0) {
-			// Found it!
-			dirEntry_found = dirEntry;
-			break;
-		} else if (cmp < 0) {
-			// Left subtree.
-			subtree_offset = le16_to_cpu(dirEntry->left_offset);
-		} else if (cmp > 0) {
-			// Right subtree.
-			subtree_offset = le16_to_cpu(dirEntry->right_offset);
-		}
-
-		if (subtree_offset == 0 || subtree_offset == 0xFFFF) {
-			// End of directory.
-			break;
-		}
-		p = p_start + (subtree_offset * sizeof(uint32_t));
+	// DiscReader must be available now.
+	RP_Q(XDVDFSPartition);
+	if (unlikely(!q->m_discReader)) {
+		// DiscReader isn't open.
+		q->m_lastError = EIO;
+		return nullptr;
 	}
 
-	if (!dirEntry_found) {
-		// Not found.
+	const off64_t sector_addr = static_cast<off64_t>(sector) * XDVDFS_BLOCK_SIZE;
+	if (sector_addr + XDVDFS_BLOCK_SIZE > partition_size) {
+		// Sector is out of bounds.
+		q->m_lastError = EIO;
 		return nullptr;
 	}
 
-	// Make sure the file is in bounds.
-	const uint32_t file_size = le32_to_cpu(dirEntry_found->file_size);
-	const off64_t file_addr = static_cast<off64_t>(
-		le32_to_cpu(dirEntry_found->start_sector)) * XDVDFS_BLOCK_SIZE;
-	if (file_addr >= (this->partition_size + this->partition_offset) ||
-	    file_addr > (this->partition_size + this->partition_offset - file_size))
-	{
-		// File is out of bounds.
-		RP_Q(XDVDFSPartition);
-		q->m_lastError = EIO;
+	// Read the sector.
+	ao::uvector<uint8_t> data(XDVDFS_BLOCK_SIZE);
+	size_t size = q->m_discReader->seekAndRead(partition_offset + sector_addr, data.data(), data.size());
+	if (size != data.size()) {
+		// Seek and/or read error.
+		q->m_lastError = q->m_discReader->lastError();
+		if (q->m_lastError == 0) {
+			q->m_lastError = EIO;
+		}
 		return nullptr;
 	}
 
-	// Return the directory entry.
-	return dirEntry_found;
+	auto ins_iter = dirSectors.emplace(sector, std::move(data));
+	return ins_iter.first->second.data();
 }
 
 /**
- * Get the specified directory.
- * This should *only* be the directory, not a filename.
- * @param path Directory path.
- * @return Pointer to directory table (ao::uvector), or nullptr if not found.
+ * Read a directory entry from a directory table.
+ * @param dir_sector	[in] Directory table sector.
+ * @param dir_size	[in] Directory table size, in bytes.
+ * @param offset	[in] Entry offset, in DWORDs.
+ * @param node		[out] Directory entry.
+ * @return 0 on success; negative POSIX error code on error.
  */
-const ao::uvector<uint8_t> *XDVDFSPartitionPrivate::getDirectory(const char *path)
+int XDVDFSPartitionPrivate::readDirNode(uint32_t dir_sector, uint32_t dir_size, uint32_t offset, DirNode *node)
 {
-	RP_Q(XDVDFSPartition);
-	if (unlikely(!path || path[0] != '/')) {
-		// Invalid path.
-		q->m_lastError = EINVAL;
-		return nullptr;
-	} else if (unlikely(xdvdfsHeader.magic[0] == '\0')) {
-		// XDVDFS isn't loaded.
-		q->m_lastError = EIO;
-		return nullptr;
+	// Read the entry header and the filename.
+	// NOTE: Entries usually don't cross sector boundaries,
+	// but this isn't guaranteed, so copy up to two sectors.
+	uint8_t buf[sizeof(XDVDFS_DirEntry) + 255];
+	const uint32_t pos = offset * sizeof(uint32_t);
+	if (pos + sizeof(XDVDFS_DirEntry) > dir_size) {
+		// Entry is out of bounds.
+		return -EIO;
 	}
+	const size_t buf_size = std::min(sizeof(buf), static_cast<size_t>(dir_size - pos));
+
+	size_t copied = 0;
+	do {
+		const uint32_t cur_pos = pos + static_cast<uint32_t>(copied);
+		const uint8_t *const sector = getDirSector(dir_sector + (cur_pos / XDVDFS_BLOCK_SIZE));
+		if (!sector) {
+			// getDirSector() has already set q->m_lastError.
+			return -EIO;
+		}
 
-	// TODO: Remove unnecessary leading and trailing slashes.
+		const uint32_t sector_pos = cur_pos % XDVDFS_BLOCK_SIZE;
+		const size_t sz = std::min(buf_size - copied, static_cast<size_t>(XDVDFS_BLOCK_SIZE - sector_pos));
+		memcpy(&buf[copied], &sector[sector_pos], sz);
+		copied += sz;
 
-	// Is this directory table already loaded?
-	auto iter = dirTables.find(path);
-	if (iter != dirTables.end()) {
-		// Directory table is already loaded.
-		return &(iter->second);
+		if (copied >= sizeof(XDVDFS_DirEntry)) {
+			// Don't read more sectors than needed for the filename.
+			const XDVDFS_DirEntry *const dirEntry = reinterpret_cast<const XDVDFS_DirEntry*>(buf);
+			if (copied >= sizeof(XDVDFS_DirEntry) + dirEntry->name_length)
+				break;
+		}
+	} while (copied < buf_size);
+
+	const XDVDFS_DirEntry *const dirEntry = reinterpret_cast<const XDVDFS_DirEntry*>(buf);
+	node->left_offset = le16_to_cpu(dirEntry->left_offset);
+	node->right_offset = le16_to_cpu(dirEntry->right_offset);
+	if (node->left_offset == 0xFFFF && node->right_offset == 0xFFFF) {
+		// Padding, not a directory entry.
+		return -EIO;
+	}
+	if (sizeof(XDVDFS_DirEntry) + dirEntry->name_length > copied) {
+		// Filename is out of bounds.
+		return -EIO;
 	}
 
-	// DiscReader must be available now.
-	if (unlikely(!q->m_discReader)) {
-		// DiscReader isn't open.
-		q->m_lastError = EIO;
-		return nullptr;
+	node->start_sector = le32_to_cpu(dirEntry->start_sector);
+	node->file_size = le32_to_cpu(dirEntry->file_size);
+	node->attributes = dirEntry->attributes;
+	node->name_length = dirEntry->name_length;
+	memcpy(node->name, &buf[sizeof(XDVDFS_DirEntry)], node->name_length);
+	node->name[node->name_length] = '\0';
+
+	// 0xFFFF indicates the end of the directory.
+	if (node->left_offset == 0xFFFF) {
+		node->left_offset = 0;
+	}
+	if (node->right_offset == 0xFFFF) {
+		node->right_offset = 0;
 	}
+	return 0;
+}
 
-	// Directory table address and size.
-	off64_t dir_addr = 0;
-	uint32_t dir_size = 0;
+/**
+ * Find an entry in a directory by walking its binary tree.
+ * @param dir_sector	[in] Directory table sector.
+ * @param dir_size	[in] Directory table size, in bytes.
+ * @param name		[in] Filename. (cp1252)
+ * @param node		[out] Directory entry.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int XDVDFSPartitionPrivate::findInDir(uint32_t dir_sector, uint32_t dir_size, const string &name, DirNode *node)
+{
+	if (dir_size < sizeof(XDVDFS_DirEntry)) {
+		// Empty directory.
+		return -ENOENT;
+	}
 
-	if (!strcmp(path, "/")) {
-		// Special handling for the root directory.
+	// A valid tree can't have more levels than it has entries.
+	// This prevents infinite loops in corrupted directories.
+	unsigned int levels_left = dir_size / sizeof(XDVDFS_DirEntry);
+	uint32_t offset = 0;
+	do {
+		int ret = readDirNode(dir_sector, dir_size, offset, node);
+		if (ret != 0) {
+			return ret;
+		}
 
-		// Root directory size should be less than 16 MB.
-		if (xdvdfsHeader.root_dir_size > 16*1024*1024) {
-			// Root directory is too big.
-			q->m_lastError = EIO;
-			return nullptr;
+		// NOTE: Filenames are case-insensitive.
+		const int cmp = xdvdfs_strcasecmp(name.data(), name.size(), node->name, node->name_length);
+		if (cmp == 0) {
+			// Found it!
+			return 0;
 		}
 
-		// Root directory offsets.
-		dir_addr = partition_offset + (
-			static_cast<off64_t>(xdvdfsHeader.root_dir_sector) * XDVDFS_BLOCK_SIZE);
-		dir_size = xdvdfsHeader.root_dir_size;
-	} else {
-		// Get the parent directory.
-		// TODO
-		return nullptr;
+		// Go to the left or right subtree.
+		offset = (cmp < 0 ? node->left_offset : node->right_offset);
+	} while (offset != 0 && --levels_left > 0);
+
+	// Not found.
+	return -ENOENT;
+}
+
+/**
+ * Look up a file or directory by path.
+ * The root directory is returned as a directory entry with an empty name.
+ * @param path	[in] Path. (UTF-8)
+ * @param node	[out] Directory entry.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int XDVDFSPartitionPrivate::lookup(const char *path, DirNode *node)
+{
+	if (unlikely(xdvdfsHeader.magic[0] == '\0')) {
+		// XDVDFS isn't loaded.
+		return -EIO;
 	}
 
-	// Read the directory.
-	ao::uvector<uint8_t> dirTable(dir_size);
-	size_t size = q->m_discReader->seekAndRead(dir_addr, dirTable.data(), dirTable.size());
-	if (size != dirTable.size()) {
-		// Seek and/or read error.
-		q->m_lastError = q->m_discReader->lastError();
-		if (q->m_lastError == 0) {
-			q->m_lastError = EIO;
+	// Start with the root directory.
+	node->left_offset = 0;
+	node->right_offset = 0;
+	node->start_sector = xdvdfsHeader.root_dir_sector;
+	node->file_size = xdvdfsHeader.root_dir_size;
+	node->attributes = XDVDFS_ATTR_DIRECTORY;
+	node->name_length = 0;
+	node->name[0] = '\0';
+
+	// Walk the path one component at a time.
+	// NOTE: Leading, trailing, and duplicate slashes are ignored.
+	const char *p = path;
+	while (*p != '\0') {
+		if (*p == '/' || *p == '\\') {
+			p++;
+			continue;
+		}
+
+		const char *p_end = p;
+		while (*p_end != '\0' && *p_end != '/' && *p_end != '\\') {
+			p_end++;
+		}
+
+		if (!node->isDir()) {
+			// Not a directory.
+			return -ENOTDIR;
 		}
-		return nullptr;
-	}
 
-	// Save the directory table for later.
-	auto ins_iter = dirTables.insert(std::make_pair(path, std::move(dirTable)));
+		// TODO: Which encoding?
+		// Assuming cp1252...
+		const string s_name = utf8_to_cp1252(p, static_cast<int>(p_end - p));
+		int ret = findInDir(node->start_sector, node->file_size, s_name, node);
+		if (ret != 0) {
+			return ret;
+		}
+		p = p_end;
+	}
 
-	// Root directory loaded.
-	return &(ins_iter.first->second);
+	return 0;
 }
 
 /** XDVDFSPartition **/
@@ -456,9 +581,6 @@ off64_t XDVDFSPartition::partition_size_used(void) const
 
 /** IFst wrapper functions. **/
 
-// TODO
-
-#if 0
 /**
  * Open a directory.
  * @param path	[in] Directory path.
@@ -467,51 +589,111 @@ off64_t XDVDFSPartition::partition_size_used(void) const
 IFst::Dir *XDVDFSPartition::opendir(const char *path)
 {
 	RP_D(XDVDFSPartition);
-	if (!d->fst) {
-		// FST isn't loaded.
-		if (d->loadFst() != 0) {
-			// FST load failed.
-			// TODO: Errors?
-			return nullptr;
-		}
+	assert(path != nullptr);
+	if (!path) {
+		m_lastError = EINVAL;
+		return nullptr;
 	}
 
-	return d->fst->opendir(path);
+	XDVDFSPartitionPrivate::DirNode node;
+	int ret = d->lookup(path, &node);
+	if (ret != 0) {
+		m_lastError = -ret;
+		return nullptr;
+	} else if (!node.isDir()) {
+		// Not a directory.
+		m_lastError = ENOTDIR;
+		return nullptr;
+	}
+
+	XDVDFSPartitionPrivate::XDVDFSDir *const dirp = new XDVDFSPartitionPrivate::XDVDFSDir;
+	dirp->parent = nullptr;	// not owned by an IFst
+	dirp->dir_idx = static_cast<int>(node.start_sector);
+	memset(&dirp->entry, 0, sizeof(dirp->entry));
+	dirp->dir_sector = node.start_sector;
+	dirp->dir_size = node.file_size;
+	dirp->entries_left = node.file_size / sizeof(XDVDFS_DirEntry);
+	dirp->cur = (dirp->entries_left > 0 ? 0 : XDVDFSPartitionPrivate::NO_NODE);
+	return dirp;
 }
 
 /**
  * Read a directory entry.
- * @param dirp FstDir pointer.
+ * @param dirp IFst::Dir pointer.
  * @return IFst::DirEnt*, or nullptr if end of directory or on error.
  * (TODO: Add lastError()?)
  */
 IFst::DirEnt *XDVDFSPartition::readdir(IFst::Dir *dirp)
 {
 	RP_D(XDVDFSPartition);
-	if (!d->fst) {
-		// TODO: Errors?
+	assert(dirp != nullptr);
+	if (!dirp) {
+		// No directory pointer.
+		return nullptr;
+	}
+	XDVDFSPartitionPrivate::XDVDFSDir *const xdir =
+		static_cast<XDVDFSPartitionPrivate::XDVDFSDir*>(dirp);
+
+	// In-order traversal of the directory's binary tree.
+	// Descend into the left subtree of the current node first.
+	XDVDFSPartitionPrivate::DirNode node;
+	while (xdir->cur != XDVDFSPartitionPrivate::NO_NODE) {
+		if (xdir->stack.size() >= xdir->entries_left) {
+			// Tree is deeper than the number of entries.
+			// The directory is probably corrupted.
+			m_lastError = EIO;
+			return nullptr;
+		}
+		if (d->readDirNode(xdir->dir_sector, xdir->dir_size, xdir->cur, &node) != 0) {
+			// Error reading the directory entry.
+			m_lastError = EIO;
+			return nullptr;
+		}
+		xdir->stack.push_back(static_cast<uint16_t>(xdir->cur));
+		xdir->cur = (node.left_offset != 0 ? node.left_offset : XDVDFSPartitionPrivate::NO_NODE);
+	}
+
+	if (xdir->stack.empty() || xdir->entries_left == 0) {
+		// End of directory.
 		return nullptr;
 	}
 
-	return d->fst->readdir(dirp);
+	// Return the next node, then continue with its right subtree.
+	const uint16_t offset = xdir->stack.back();
+	xdir->stack.pop_back();
+	if (d->readDirNode(xdir->dir_sector, xdir->dir_size, offset, &node) != 0) {
+		// Error reading the directory entry.
+		m_lastError = EIO;
+		return nullptr;
+	}
+	xdir->cur = (node.right_offset != 0 ? node.right_offset : XDVDFSPartitionPrivate::NO_NODE);
+	xdir->entries_left--;
+
+	xdir->name = cp1252_to_utf8(node.name, node.name_length);
+	xdir->entry.offset = static_cast<off64_t>(node.start_sector) * XDVDFS_BLOCK_SIZE;
+	xdir->entry.size = node.file_size;
+	xdir->entry.name = xdir->name.c_str();
+	xdir->entry.idx = offset;
+	xdir->entry.type = (node.isDir() ? DT_DIR : DT_REG);
+	return &xdir->entry;
 }
 
 /**
  * Close an opened directory.
- * @param dirp FstDir pointer.
+ * @param dirp IFst::Dir pointer.
  * @return 0 on success; negative POSIX error code on error.
  */
 int XDVDFSPartition::closedir(IFst::Dir *dirp)
 {
-	RP_D(XDVDFSPartition);
-	if (!d->fst) {
-		// TODO: Errors?
-		return -EBADF;
+	if (!dirp) {
+		// No directory pointer.
+		// In release builds, this is a no-op.
+		return 0;
 	}
 
-	return d->fst->closedir(dirp);
+	delete static_cast<XDVDFSPartitionPrivate::XDVDFSDir*>(dirp);
+	return 0;
 }
-#endif
 
 /**
  * Open a file. (read-only)
@@ -522,61 +704,44 @@ IRpFile *XDVDFSPartition::open(const char *filename)
 {
 	// TODO: File reference counter.
 	// This might be difficult to do because PartitionFile is a separate class.
-
-	// TODO: Support subdirectories.
-
-	// Filename must be valid, and must start with a slash.
-	// Only absolute paths are supported.
-	if (!filename || filename[0] != '/') {
-		// No filename and/or does not start with a slash.
-		// TODO: Prepend a slash like GcnFst, or remove slash prepending from GcnFst?
-		m_lastError = EINVAL;
-		return nullptr;
-	}
-
-	// Remove leading slashes.
-	while (*filename == '/') {
-		filename++;
-	}
-	if (filename[0] == 0) {
-		// Nothing but slashes...
-		return nullptr;
-	}
-
-	// TODO: Handle subdirectories.
-	// For now, assuming the file is in the root directory.
 	RP_D(XDVDFSPartition);
-	const ao::uvector<uint8_t> *const dirTable = d->getDirectory("/");
-	if (!dirTable) {
-		// Directory not found.
-		// getDirectory() has already set m_lastError.
+	if (!filename || filename[0] == '\0') {
+		// No filename.
+		m_lastError = EINVAL;
 		return nullptr;
 	}
 
-	// Find the file in the root directory.
-	const XDVDFS_DirEntry *const dirEntry = d->getDirEntry(dirTable, filename);
-	if (!dirEntry) {
+	XDVDFSPartitionPrivate::DirNode node;
+	int ret = d->lookup(filename, &node);
+	if (ret != 0) {
 		// File not found.
-		// getDirEntry() has already set m_lastError.
+		m_lastError = -ret;
 		return nullptr;
 	}
 
 	// Make sure this is a regular file.
 	// TODO: Check for XDVDFS_ATTR_NORMAL?
-	if (dirEntry->attributes & XDVDFS_ATTR_DIRECTORY) {
+	if (node.isDir()) {
 		// Not a regular file.
 		m_lastError = EISDIR;
 		return nullptr;
 	}
 
-	const uint32_t file_size = le32_to_cpu(dirEntry->file_size);
-	const off64_t file_addr = static_cast<off64_t>(le32_to_cpu(dirEntry->start_sector)) * XDVDFS_BLOCK_SIZE;
+	// Make sure the file is in bounds.
+	const off64_t file_addr = static_cast<off64_t>(node.start_sector) * XDVDFS_BLOCK_SIZE;
+	if (file_addr >= d->partition_size ||
+	    file_addr > d->partition_size - node.file_size)
+	{
+		// File is out of bounds.
+		m_lastError = EIO;
+		return nullptr;
+	}
 
 	// Create the PartitionFile.
 	// This is an IRpFile implementation that uses an
 	// IPartition as the reader and takes an offset
 	// and size as the file parameters.
-	return new PartitionFile(this, file_addr, file_size);
+	return new PartitionFile(this, file_addr, node.file_size);
 }
 
 /** XDVDFSPartition **/
@@ -10,6 +10,7 @@
 #define __ROMPROPERTIES_LIBROMDATA_DISC_XDVDFSPARTITION_HPP__
 
 #include "librpbase/disc/IPartition.hpp"
+#include "librpbase/disc/IFst.hpp"
 
 // C includes. (C++ namespace)
 #include <ctime>
@@ -96,14 +97,12 @@ class XDVDFSPartition : public LibRpBase::IPartition
 	public:
 		/** IFst wrapper functions. **/
 
-		// TODO
-#if 0
 		/**
 		 * Open a directory.
 		 * @param path	[in] Directory path.
 		 * @return IFst::Dir*, or nullptr on error.
 		 */
-		LibRpBase::IFst::Dir *opendir(const char *path);
+		LibRpBase::IFst::Dir *opendir(const char *path) final;
 
 		/**
 		 * Open a directory.
@@ -121,22 +120,21 @@ class XDVDFSPartition : public LibRpBase::IPartition
 		 * @return IFst::DirEnt, or nullptr if end of directory or on error.
 		 * (TODO: Add lastError()?)
 		 */
-		LibRpBase::IFst::DirEnt *readdir(LibRpBase::IFst::Dir *dirp);
+		LibRpBase::IFst::DirEnt *readdir(LibRpBase::IFst::Dir *dirp) final;
 
 		/**
 		 * Close an opened directory.
 		 * @param dirp IFst::Dir pointer.
 		 * @return 0 on success; negative POSIX error code on error.
 		 */
-		int closedir(LibRpBase::IFst::Dir *dirp);
-#endif
+		int closedir(LibRpBase::IFst::Dir *dirp) final;
 
 		/**
 		 * Open a file. (read-only)
 		 * @param filename Filename.
 		 * @return IRpFile*, or nullptr on error.
 		 */
-		LibRpFile::IRpFile *open(const char *filename);
+		LibRpFile::IRpFile *open(const char *filename) final;
 
 	public:
 		/** XDVDFSPartition **/
@@ -10,6 +10,7 @@
 #define __ROMPROPERTIES_LIBROMDATA_IMG_TCREATETHUMBNAIL_CPP__
 
 #include "TCreateThumbnail.hpp"
+#include "config.version.h"
 
 // Cache Manager
 #include "CacheManager.hpp"
@@ -18,10 +19,17 @@
 #include "librpbase/RomData.hpp"
 #include "librpbase/config/Config.hpp"
 #include "librpbase/img/RpImageLoader.hpp"
+#include "librpbase/img/RpPng.hpp"
+#include "librpfile/FileSystem.hpp"
 #include "librpfile/RpFile.hpp"
+#include "librpfile/RpMemFile.hpp"
+#include "librpfile/RpVectorFile.hpp"
 using namespace LibRpBase;
 using namespace LibRpFile;
 
+// libcachecommon
+#include "libcachecommon/DerivedCache.hpp"
+
 // librptexture
 #include "librptexture/img/rp_image.hpp"
 using LibRpTexture::rp_image;
@@ -31,6 +39,7 @@ using LibRpTexture::rp_image;
 
 // C includes. (C++ namespace)
 #include <cassert>
+#include <cerrno>
 #include <cstring>
 
 // C++ includes.
@@ -242,6 +251,187 @@ inline void TCreateThumbnail<ImgClass>::rescale_aspect(ImgSize &rs_size, const I
 	}
 }
 
+/** Thumbnail cache **/
+
+// Thumbnail cache file magic and version.
+#define THUMB_CACHE_MAGIC	'RPTC'
+#define THUMB_CACHE_VERSION	1
+// Thumbnail cache subdirectory.
+#define THUMB_CACHE_SUBDIR	"thumbs"
+// Maximum thumbnail cache size, in bytes.
+#define THUMB_CACHE_MAX_SIZE	(64LL*1024*1024)
+// Maximum size of a single thumbnail cache file, in bytes.
+#define THUMB_CACHE_MAX_FILE_SIZE	(16*1024*1024)
+
+/**
+ * Get the thumbnail cache filename for the specified ROM file.
+ * @param filename	[in] ROM filename.
+ * @param reqSize	[in] Requested image size.
+ * @return Cache filename, or empty string if the thumbnail cache is disabled or unavailable.
+ */
+template<typename ImgClass>
+std::string TCreateThumbnail<ImgClass>::getThumbCacheFilename(const char *filename, int reqSize) const
+{
+	const Config *const config = Config::instance();
+	if (!config->enableThumbnailCache()) {
+		// Thumbnail cache is disabled.
+		return std::string();
+	}
+
+	// Variant data: Everything other than the file itself
+	// that affects which image is selected.
+	const uint32_t variant_u32[4] = {
+		THUMB_CACHE_VERSION,
+		static_cast<uint32_t>(reqSize),
+		config->imgTypePrioChecksum(),
+		(config->useIntIconForSmallSizes() ? (1U << 0) : 0U) |
+		(config->extImgDownloadEnabled()   ? (1U << 1) : 0U) |
+		(config->downloadHighResScans()    ? (1U << 2) : 0U),
+	};
+
+	// Include the program version, since image decoders may
+	// change between releases without a cache format change.
+	std::string variant(reinterpret_cast<const char*>(variant_u32), sizeof(variant_u32));
+	variant += RP_VERSION_STRING;
+
+	return LibCacheCommon::getDerivedCacheFilename(THUMB_CACHE_SUBDIR,
+		filename, variant.data(), variant.size(), ".rptc");
+}
+
+/**
+ * Load a thumbnail from the thumbnail cache.
+ * @param cache_filename	[in] Cache filename.
+ * @param pOutParams		[out] Output parameters.
+ * @return 0 on success; non-zero on error.
+ */
+template<typename ImgClass>
+int TCreateThumbnail<ImgClass>::loadThumbFromCache(const std::string &cache_filename, GetThumbnailOutParams_t *pOutParams)
+{
+	unique_RefBase<RpFile> file(new RpFile(cache_filename, RpFile::FM_OPEN_READ));
+	if (!file->isOpen()) {
+		// Not cached.
+		return -ENOENT;
+	}
+
+	// Read the entire cache file.
+	const off64_t fileSize = file->size();
+	if (fileSize <= static_cast<off64_t>(sizeof(ThumbCacheHeader)) ||
+	    fileSize > THUMB_CACHE_MAX_FILE_SIZE)
+	{
+		// Invalid cache file.
+		return -EIO;
+	}
+	const size_t size = static_cast<size_t>(fileSize);
+	unique_ptr<uint8_t[]> buf(new uint8_t[size]);
+	if (file->read(buf.get(), size) != size) {
+		// Read error.
+		return -EIO;
+	}
+	file->close();
+
+	// Verify the header.
+	ThumbCacheHeader header;
+	memcpy(&header, buf.get(), sizeof(header));
+	if (header.magic != THUMB_CACHE_MAGIC ||
+	    header.version != THUMB_CACHE_VERSION ||
+	    header.thumbSize.width <= 0 || header.thumbSize.height <= 0 ||
+	    header.fullSize.width <= 0 || header.fullSize.height <= 0)
+	{
+		// Invalid header.
+		return -EIO;
+	}
+
+	// Load the PNG image.
+	unique_RefBase<RpMemFile> pngData(new RpMemFile(
+		buf.get() + sizeof(header), size - sizeof(header)));
+	rp_image *const img = RpImageLoader::load(pngData.get());
+	if (!img) {
+		// Unable to load the image.
+		return -EIO;
+	}
+	if (img->width() != header.thumbSize.width ||
+	    img->height() != header.thumbSize.height)
+	{
+		// Image size doesn't match the header.
+		img->unref();
+		return -EIO;
+	}
+
+	ImgClass ret_img = rpImageToImgClass(img);
+	img->unref();
+	if (!isImgClassValid(ret_img)) {
+		// Unable to convert the image.
+		return -EIO;
+	}
+
+	pOutParams->thumbSize = header.thumbSize;
+	pOutParams->fullSize = header.fullSize;
+	pOutParams->sBIT = header.sBIT;
+	pOutParams->retImg = ret_img;
+
+	// Update the mtime for LRU pruning.
+	LibCacheCommon::touchDerivedCacheFile(cache_filename);
+	return 0;
+}
+
+/**
+ * Save a thumbnail to the thumbnail cache.
+ * @param cache_filename	[in] Cache filename.
+ * @param pOutParams		[in] Output parameters from getThumbnail_int().
+ * @return 0 on success; negative POSIX error code on error.
+ */
+template<typename ImgClass>
+int TCreateThumbnail<ImgClass>::saveThumbToCache(const std::string &cache_filename, const GetThumbnailOutParams_t *pOutParams)
+{
+	rp_image *const img = imgClassToRpImage(pOutParams->retImg);
+	if (!img) {
+		// Caching isn't supported by this frontend.
+		return -ENOTSUP;
+	}
+
+	// Encode the thumbnail as PNG.
+	unique_RefBase<RpVectorFile> pngData(new RpVectorFile());
+	int ret = RpPng::save(pngData.get(), img);
+	const ImgSize thumbSize = {img->width(), img->height()};
+	img->unref();
+	if (ret != 0) {
+		return ret;
+	}
+
+	ThumbCacheHeader header;
+	header.magic = THUMB_CACHE_MAGIC;
+	header.version = THUMB_CACHE_VERSION;
+	header.thumbSize = thumbSize;
+	header.fullSize = pOutParams->fullSize;
+	header.sBIT = pOutParams->sBIT;
+	memset(header.reserved, 0, sizeof(header.reserved));
+
+	// Make sure the cache subdirectory exists.
+	if (FileSystem::rmkdir(cache_filename) != 0) {
+		return -EIO;
+	}
+
+	unique_RefBase<RpFile> file(new RpFile(cache_filename, RpFile::FM_CREATE_WRITE));
+	if (!file->isOpen()) {
+		ret = -file->lastError();
+		return (ret != 0 ? ret : -EIO);
+	}
+	const std::vector<uint8_t> &vec = pngData->vector();
+	if (file->write(&header, sizeof(header)) != sizeof(header) ||
+	    file->write(vec.data(), vec.size()) != vec.size())
+	{
+		// Write error. Delete the incomplete file.
+		file->close();
+		FileSystem::delete_file(cache_filename);
+		return -EIO;
+	}
+	file->close();
+
+	// Prune the thumbnail cache if it's too big.
+	LibCacheCommon::pruneDerivedCache(THUMB_CACHE_SUBDIR, THUMB_CACHE_MAX_SIZE);
+	return 0;
+}
+
 /**
  * Create a thumbnail for the specified ROM file.
  * @param romData	[in] RomData object.
@@ -260,6 +450,56 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const RomData *romData, int reqSize
 		return RPCT_INVALID_IMAGE_SIZE;
 	}
 
+	// Check the thumbnail cache.
+	// NOTE: This only skips image decoding, since the
+	// RomData object has already been created.
+	std::string cache_filename;
+	const char *const filename = romData->filename();
+	if (filename) {
+		cache_filename = getThumbCacheFilename(filename, reqSize);
+		if (!cache_filename.empty() && loadThumbFromCache(cache_filename, pOutParams) == 0) {
+			// Thumbnail loaded from the cache.
+			return RPCT_SUCCESS;
+		}
+	}
+
+	// Call the actual function.
+	bool cacheable = false;
+	int ret = getThumbnail_int(romData, reqSize, pOutParams, &cacheable);
+	if (ret == RPCT_SUCCESS && cacheable && !cache_filename.empty()) {
+		saveThumbToCache(cache_filename, pOutParams);
+	}
+	return ret;
+}
+
+/**
+ * Create a thumbnail for the specified ROM file.
+ * Internal function; does not check the thumbnail cache.
+ * @param romData	[in] RomData object.
+ * @param reqSize	[in] Requested image size. (single dimension; assuming square image)
+ * @param pOutParams	[out] Output parameters.
+ * @param pCacheable	[out,opt] Set to true if the thumbnail can be cached.
+ * @return 0 on success; non-zero on error.
+ */
+template<typename ImgClass>
+int TCreateThumbnail<ImgClass>::getThumbnail_int(const RomData *romData, int reqSize, GetThumbnailOutParams_t *pOutParams, bool *pCacheable)
+{
+	assert(romData != nullptr);
+	assert(reqSize > 0);
+	assert(pOutParams != nullptr);
+	if (pCacheable) {
+		*pCacheable = false;
+	}
+	if (reqSize <= 0) {
+		// Invalid parameter...
+		return RPCT_INVALID_IMAGE_SIZE;
+	}
+
+	// If a higher-priority external image couldn't be retrieved,
+	// e.g. due to a network error, the fallback image must not
+	// be cached, since the external image may be available later.
+	bool ext_img_failed = false;
+
 	// Zero out the output parameters initially.
 	pOutParams->thumbSize.width = 0;
 	pOutParams->thumbSize.height = 0;
@@ -341,6 +581,11 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const RomData *romData, int reqSize
 			break;
 		}
 
+		if (imgType > RomData::IMG_INT_MAX) {
+			// External image wasn't available.
+			ext_img_failed = true;
+		}
+
 		// Make sure we don't check this image type again
 		// in case there are duplicate entries in the
 		// priority list.
@@ -444,6 +689,9 @@ skip_image_check:
 	}
 
 	// Image retrieved successfully.
+	if (pCacheable) {
+		*pCacheable = !ext_img_failed;
+	}
 	return RPCT_SUCCESS;
 }
 
@@ -465,6 +713,17 @@ int TCreateThumbnail<ImgClass>::getThumbnail(IRpFile *file, int reqSize, GetThum
 		return RPCT_INVALID_IMAGE_SIZE;
 	}
 
+	// Check the thumbnail cache before creating the RomData object.
+	std::string cache_filename;
+	const std::string filename = file->filename();
+	if (!filename.empty()) {
+		cache_filename = getThumbCacheFilename(filename.c_str(), reqSize);
+		if (!cache_filename.empty() && loadThumbFromCache(cache_filename, pOutParams) == 0) {
+			// Thumbnail loaded from the cache.
+			return RPCT_SUCCESS;
+		}
+	}
+
 	// Get the appropriate RomData class for this ROM.
 	// RomData class *must* support at least one image type.
 	RomData *romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_THUMBNAIL);
@@ -474,8 +733,12 @@ int TCreateThumbnail<ImgClass>::getThumbnail(IRpFile *file, int reqSize, GetThum
 	}
 
 	// Call the actual function.
-	int ret = getThumbnail(romData, reqSize, pOutParams);
+	bool cacheable = false;
+	int ret = getThumbnail_int(romData, reqSize, pOutParams, &cacheable);
 	romData->unref();
+	if (ret == RPCT_SUCCESS && cacheable && !cache_filename.empty()) {
+		saveThumbToCache(cache_filename, pOutParams);
+	}
 	return ret;
 }
 
@@ -497,6 +760,13 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const char *filename, int reqSize,
 		return RPCT_INVALID_IMAGE_SIZE;
 	}
 
+	// Check the thumbnail cache before opening the ROM file.
+	const std::string cache_filename = getThumbCacheFilename(filename, reqSize);
+	if (!cache_filename.empty() && loadThumbFromCache(cache_filename, pOutParams) == 0) {
+		// Thumbnail loaded from the cache.
+		return RPCT_SUCCESS;
+	}
+
 	// Attempt to open the ROM file.
 	// TODO: OS-specific wrappers, e.g. RpQFile or RpGVfsFile.
 	// For now, using RpFile, which is an stdio wrapper.
@@ -517,8 +787,12 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const char *filename, int reqSize,
 	}
 
 	// Call the actual function.
-	int ret = getThumbnail(romData, reqSize, pOutParams);
+	bool cacheable = false;
+	int ret = getThumbnail_int(romData, reqSize, pOutParams, &cacheable);
 	romData->unref();
+	if (ret == RPCT_SUCCESS && cacheable && !cache_filename.empty()) {
+		saveThumbToCache(cache_filename, pOutParams);
+	}
 	return ret;
 }
 
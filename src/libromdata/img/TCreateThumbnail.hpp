@@ -166,6 +166,61 @@ class TCreateThumbnail
 		 */
 		int getThumbnail(const char *filename, int reqSize, GetThumbnailOutParams_t *pOutParams);
 
+	private:
+		/**
+		 * Create a thumbnail for the specified ROM file.
+		 * Internal function; does not check the thumbnail cache.
+		 * @param romData	[in] RomData object.
+		 * @param reqSize	[in] Requested image size. (single dimension; assuming square image)
+		 * @param pOutParams	[out] Output parameters.
+		 * @param pCacheable	[out,opt] Set to true if the thumbnail can be cached.
+		 * @return 0 on success; non-zero on error.
+		 */
+		int getThumbnail_int(const LibRpBase::RomData *romData, int reqSize,
+			GetThumbnailOutParams_t *pOutParams, bool *pCacheable = nullptr);
+
+	private:
+		/** Thumbnail cache **/
+
+		/**
+		 * Thumbnail cache file header.
+		 * The PNG image data immediately follows the header.
+		 *
+		 * NOTE: Host-endian, since the cache is local to this system.
+		 */
+		struct ThumbCacheHeader {
+			uint32_t magic;		// [0x000] 'RPTC'
+			uint32_t version;	// [0x004] Cache file version
+			ImgSize thumbSize;	// [0x008] Thumbnail size
+			ImgSize fullSize;	// [0x010] Full image size
+			LibRpTexture::rp_image::sBIT_t sBIT;	// [0x018] sBIT metadata
+			uint8_t reserved[3];	// [0x01D]
+		};
+
+		/**
+		 * Get the thumbnail cache filename for the specified ROM file.
+		 * @param filename	[in] ROM filename.
+		 * @param reqSize	[in] Requested image size.
+		 * @return Cache filename, or empty string if the thumbnail cache is disabled or unavailable.
+		 */
+		std::string getThumbCacheFilename(const char *filename, int reqSize) const;
+
+		/**
+		 * Load a thumbnail from the thumbnail cache.
+		 * @param cache_filename	[in] Cache filename.
+		 * @param pOutParams		[out] Output parameters.
+		 * @return 0 on success; non-zero on error.
+		 */
+		int loadThumbFromCache(const std::string &cache_filename, GetThumbnailOutParams_t *pOutParams);
+
+		/**
+		 * Save a thumbnail to the thumbnail cache.
+		 * @param cache_filename	[in] Cache filename.
+		 * @param pOutParams		[in] Output parameters from getThumbnail_int().
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int saveThumbToCache(const std::string &cache_filename, const GetThumbnailOutParams_t *pOutParams);
+
 	protected:
 		/**
 		 * Rescale a size while maintaining the aspect ratio.
@@ -185,6 +240,21 @@ class TCreateThumbnail
 		 */
 		virtual ImgClass rpImageToImgClass(const LibRpTexture::rp_image *img) const = 0;
 
+		/**
+		 * Wrapper function to convert ImgClass to rp_image*.
+		 *
+		 * This is used to store rendered thumbnails in the thumbnail cache.
+		 * If this function isn't reimplemented, thumbnails won't be cached.
+		 *
+		 * @param imgClass ImgClass
+		 * @return rp_image (ARGB32), or nullptr if not supported.
+		 */
+		virtual LibRpTexture::rp_image *imgClassToRpImage(const ImgClass &imgClass) const
+		{
+			((void)imgClass);
+			return nullptr;
+		}
+
 		/**
 		 * Wrapper function to check if an ImgClass is valid.
 		 * @param imgClass ImgClass
@@ -155,6 +155,26 @@ typedef enum {
 						// Could be used for files larger than 4 GB, but generally isn't.
 } ISO_File_Flags_t;
 
+/**
+ * Path table entry, excluding the variable-length directory identifier.
+ *
+ * The path table lists every directory on the disc in
+ * breadth-first order. Entry 1 is the root directory.
+ * The directory identifier is padded to an even length.
+ *
+ * NOTE: The L path table has little-endian values;
+ * the M path table has big-endian values.
+ */
+#pragma pack(1)
+typedef struct PACKED _ISO_PathTableEntry {
+	uint8_t name_length;		// Length of the directory identifier.
+	uint8_t xattr_length;		// Extended Attribute Record length.
+	uint32_t block;			// Starting LBA of the directory.
+	uint16_t parent_dir_num;	// Parent directory number. (1-based)
+} ISO_PathTableEntry;
+ASSERT_STRUCT(ISO_PathTableEntry, 8);
+#pragma pack()
+
 /**
  * Volume descriptor header.
  */
@@ -0,0 +1,303 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * FieldCacheRomOpsTest.cpp: Field cache test for RomData subclasses.      *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpbase, librpcpu, librpfile
+#include "librpbase/FieldCache.hpp"
+#include "librpbase/RomFields.hpp"
+#include "librpcpu/byteswap.h"
+#include "librpfile/RpFile.hpp"
+using namespace LibRpBase;
+using LibRpFile::RpFile;
+
+// RomData subclasses
+#include "Console/NES.hpp"
+#include "Console/nes_structs.h"
+#include "Handheld/NintendoDS.hpp"
+#include "Handheld/nds_structs.h"
+
+// C includes.
+#include <ftw.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// C++ includes.
+#include <memory>
+#include <string>
+#include <vector>
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+// Temporary directory. Used as $XDG_CONFIG_HOME and $XDG_CACHE_HOME.
+static string tmp_dir;
+
+class FieldCacheRomOpsTest : public ::testing::Test
+{
+	protected:
+		FieldCacheRomOpsTest() { }
+
+	public:
+		/**
+		 * Write a test file.
+		 * @param filename Filename, relative to tmp_dir.
+		 * @param buf Data.
+		 * @param size Size of data.
+		 * @return Full filename, or empty string on error.
+		 */
+		static string writeFile(const char *filename, const uint8_t *buf, size_t size);
+
+		/**
+		 * Find a field by name.
+		 * @param fields RomFields.
+		 * @param name Field name.
+		 * @return Field, or nullptr if not found.
+		 */
+		static const RomFields::Field *findField(const RomFields *fields, const char *name);
+
+		/**
+		 * Seed a stale field cache entry for a file.
+		 * @param filename Filename.
+		 * @param className RomData class name.
+		 * @return 0 on success; non-zero on error.
+		 */
+		static int seedStaleCache(const string &filename, const char *className);
+};
+
+/**
+ * Write a test file.
+ * @param filename Filename, relative to tmp_dir.
+ * @param buf Data.
+ * @param size Size of data.
+ * @return Full filename, or empty string on error.
+ */
+string FieldCacheRomOpsTest::writeFile(const char *filename, const uint8_t *buf, size_t size)
+{
+	string full_filename = tmp_dir;
+	full_filename += '/';
+	full_filename += filename;
+
+	FILE *f = fopen(full_filename.c_str(), "wb");
+	if (!f) {
+		return string();
+	}
+	const size_t written = fwrite(buf, 1, size, f);
+	fclose(f);
+	if (written != size) {
+		return string();
+	}
+	return full_filename;
+}
+
+/**
+ * Find a field by name.
+ * @param fields RomFields.
+ * @param name Field name.
+ * @return Field, or nullptr if not found.
+ */
+const RomFields::Field *FieldCacheRomOpsTest::findField(const RomFields *fields, const char *name)
+{
+	const int count = fields->count();
+	for (int i = 0; i < count; i++) {
+		const RomFields::Field *const field = fields->at(i);
+		if (field && field->name == name) {
+			return field;
+		}
+	}
+	return nullptr;
+}
+
+/**
+ * Seed a stale field cache entry for a file.
+ * @param filename Filename.
+ * @param className RomData class name.
+ * @return 0 on success; non-zero on error.
+ */
+int FieldCacheRomOpsTest::seedStaleCache(const string &filename, const char *className)
+{
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ);
+	if (!file->isOpen()) {
+		file->unref();
+		return -1;
+	}
+	const string cache_filename = FieldCache::getCacheFilename(
+		filename.c_str(), className, file, FieldCache::CacheType::Fields);
+	file->unref();
+	if (cache_filename.empty()) {
+		return -2;
+	}
+
+	RomFields fields;
+	fields.addField_string("Stale", "This field is from the cache.");
+	ao::uvector<uint8_t> buf;
+	int ret = FieldCache::serializeFields(&fields, buf);
+	if (ret != 0) {
+		return ret;
+	}
+	return FieldCache::saveCacheFile(cache_filename, buf);
+}
+
+/**
+ * Make sure a class without ROM operations uses the field cache.
+ */
+TEST_F(FieldCacheRomOpsTest, cacheableClass)
+{
+	// iNES ROM with one 16 KB PRG bank.
+	unique_ptr<uint8_t[]> rom(new uint8_t[sizeof(INES_RomHeader) + INES_PRG_BANK_SIZE]);
+	memset(rom.get(), 0, sizeof(INES_RomHeader) + INES_PRG_BANK_SIZE);
+	INES_RomHeader *const inesHeader = reinterpret_cast<INES_RomHeader*>(rom.get());
+	inesHeader->magic = cpu_to_be32(INES_MAGIC);
+	inesHeader->prg_banks = 1;
+
+	const string filename = writeFile("test.nes", rom.get(),
+		sizeof(INES_RomHeader) + INES_PRG_BANK_SIZE);
+	ASSERT_FALSE(filename.empty());
+	ASSERT_EQ(0, seedStaleCache(filename, "NES"));
+
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ);
+	ASSERT_TRUE(file->isOpen());
+	NES *const nes = new NES(file);
+	file->unref();
+	ASSERT_TRUE(nes->isValid());
+
+	// The stale fields should be served from the cache.
+	const RomFields *const fields = nes->fields();
+	ASSERT_TRUE(fields != nullptr);
+	EXPECT_TRUE(findField(fields, "Stale") != nullptr);
+	nes->unref();
+}
+
+/**
+ * Make sure a Nintendo DS ROM doesn't use the field cache,
+ * and that ROM operations still work afterwards.
+ */
+TEST_F(FieldCacheRomOpsTest, nintendoDSRomOp)
+{
+	// Untrimmed Nintendo DS ROM: 128 KB, with 96 KB used.
+	static const size_t rom_size = 128*1024;
+	static const uint32_t total_used_rom_size = 96*1024;
+	static const uint8_t nintendo_gba_logo[16] = {
+		0x24, 0xFF, 0xAE, 0x51, 0x69, 0x9A, 0xA2, 0x21,
+		0x3D, 0x84, 0x82, 0x0A, 0x84, 0xE4, 0x09, 0xAD
+	};
+
+	unique_ptr<uint8_t[]> rom(new uint8_t[rom_size]);
+	memset(rom.get(), 0, rom_size);
+	NDS_RomHeader *const romHeader = reinterpret_cast<NDS_RomHeader*>(rom.get());
+	memcpy(romHeader->title, "FIELDCACHE", 10);
+	memcpy(romHeader->nintendo_logo, nintendo_gba_logo, sizeof(nintendo_gba_logo));
+	romHeader->nintendo_logo_checksum = cpu_to_le16(0xCF56);
+	romHeader->total_used_rom_size = cpu_to_le32(total_used_rom_size);
+
+	const string filename = writeFile("test.nds", rom.get(), rom_size);
+	ASSERT_FALSE(filename.empty());
+	rom.reset();
+	ASSERT_EQ(0, seedStaleCache(filename, "NintendoDS"));
+
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_WRITE);
+	ASSERT_TRUE(file->isOpen());
+	NintendoDS *const nds = new NintendoDS(file, false);
+	file->unref();
+	ASSERT_TRUE(nds->isValid());
+
+	// NintendoDS has ROM operations, so the stale fields
+	// must not be served from the cache.
+	const RomFields *fields = nds->fields();
+	ASSERT_TRUE(fields != nullptr);
+	EXPECT_TRUE(findField(fields, "Stale") == nullptr);
+	EXPECT_TRUE(findField(fields, "Secure Area") != nullptr);
+	EXPECT_TRUE(findField(fields, "Security Data") != nullptr);
+	const int field_count = fields->count();
+
+	// Trim the ROM.
+	// NOTE: The encrypt/decrypt operation requires nds-blowfish.bin,
+	// which isn't available here.
+	vector<RomData::RomOp> ops = nds->romOps();
+	ASSERT_FALSE(ops.empty());
+	EXPECT_STREQ("&Trim ROM", ops[0].desc);
+	EXPECT_NE(0U, ops[0].flags & RomData::RomOp::ROF_ENABLED);
+
+	RomData::RomOpParams params;
+	EXPECT_EQ(0, nds->doRomOp(0, &params));
+	EXPECT_EQ(0, params.status);
+
+	struct stat sbuf;
+	ASSERT_EQ(0, stat(filename.c_str(), &sbuf));
+	EXPECT_EQ(static_cast<off_t>(total_used_rom_size), sbuf.st_size);
+
+	// The ROM operation list and fields must reflect the trimmed ROM.
+	ops = nds->romOps();
+	ASSERT_FALSE(ops.empty());
+	EXPECT_STREQ("&Untrim ROM", ops[0].desc);
+	fields = nds->fields();
+	ASSERT_TRUE(fields != nullptr);
+	EXPECT_EQ(field_count, fields->count());
+	EXPECT_TRUE(findField(fields, "Stale") == nullptr);
+	nds->unref();
+}
+
+/**
+ * nftw() callback to remove the temporary directory.
+ */
+static int rm_callback(const char *fpath, const struct stat *sb, int typeflag, struct FTW *ftwbuf)
+{
+	((void)sb);
+	((void)typeflag);
+	((void)ftwbuf);
+	return remove(fpath);
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: Field cache with ROM operations tests.\n\n");
+	fflush(nullptr);
+
+	// Use a temporary directory for the configuration and cache.
+	// NOTE: This must be done before Config or FileSystem are used.
+	char tmpl[] = "/tmp/rp-FieldCacheRomOpsTest.XXXXXX";
+	if (!mkdtemp(tmpl)) {
+		fprintf(stderr, "*** ERROR: Unable to create a temporary directory.\n");
+		return EXIT_FAILURE;
+	}
+	LibRomData::Tests::tmp_dir = tmpl;
+	setenv("XDG_CONFIG_HOME", tmpl, 1);
+	setenv("XDG_CACHE_HOME", tmpl, 1);
+
+	// Enable the field cache.
+	string conf_dir = LibRomData::Tests::tmp_dir + "/rom-properties";
+	mkdir(conf_dir.c_str(), 0700);
+	FILE *f = fopen((conf_dir + "/rom-properties.conf").c_str(), "w");
+	if (!f) {
+		fprintf(stderr, "*** ERROR: Unable to write rom-properties.conf.\n");
+		return EXIT_FAILURE;
+	}
+	fputs("[Options]\nEnableFieldCache=true\n", f);
+	fclose(f);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	const int ret = RUN_ALL_TESTS();
+
+	nftw(tmpl, LibRomData::Tests::rm_callback, 16, FTW_DEPTH | FTW_PHYS);
+	return ret;
+}
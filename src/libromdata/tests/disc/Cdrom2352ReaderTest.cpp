@@ -0,0 +1,241 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * Cdrom2352ReaderTest.cpp: CD-ROM reader for 2352-byte sector images.     *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpfile
+#include "librpfile/RpMemFile.hpp"
+using LibRpFile::RpMemFile;
+
+// libromdata
+#include "disc/Cdrom2352Reader.hpp"
+#include "cdrom_structs.h"
+using LibRomData::Cdrom2352Reader;
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class Cdrom2352ReaderTest : public ::testing::Test
+{
+	protected:
+		Cdrom2352ReaderTest()
+			: cdromReader(nullptr)
+		{ }
+
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		// Number of sectors in the test image.
+		static const unsigned int SECTOR_COUNT = 1000;
+
+		// Number of sectors in the benchmark image. (~18 MiB)
+		static const unsigned int BENCHMARK_SECTOR_COUNT = 8192;
+
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 100;
+
+		/**
+		 * Build a synthetic 2352-byte sector image.
+		 * Sectors alternate between Mode 1, Mode 2 Form 1, and
+		 * Mode 2 Form 2. All areas other than the user data are
+		 * filled with 0xEE.
+		 * @param sectorCount	[in] Number of sectors.
+		 * @param user_data	[out] Expected user data.
+		 * @return Disc image.
+		 */
+		static vector<uint8_t> buildImage(unsigned int sectorCount, vector<uint8_t> &user_data);
+
+	public:
+		vector<uint8_t> image;
+		vector<uint8_t> user_data;
+		Cdrom2352Reader *cdromReader;
+};
+
+/**
+ * Build a synthetic 2352-byte sector image.
+ * Sectors alternate between Mode 1, Mode 2 Form 1, and
+ * Mode 2 Form 2. All areas other than the user data are
+ * filled with 0xEE.
+ * @param sectorCount	[in] Number of sectors.
+ * @param user_data	[out] Expected user data.
+ * @return Disc image.
+ */
+vector<uint8_t> Cdrom2352ReaderTest::buildImage(unsigned int sectorCount, vector<uint8_t> &user_data)
+{
+	static const uint8_t sync[12] =
+		{0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x00};
+
+	vector<uint8_t> img(sectorCount * sizeof(CDROM_2352_Sector_t), 0xEE);
+	user_data.resize(sectorCount * 2048);
+
+	uint32_t seed = 0x12345678;
+	for (unsigned int i = 0; i < sectorCount; i++) {
+		CDROM_2352_Sector_t *const sector = reinterpret_cast<CDROM_2352_Sector_t*>(&img[i * sizeof(CDROM_2352_Sector_t)]);
+		memcpy(sector->sync, sync, sizeof(sync));
+
+		uint8_t *data;
+		switch (i % 3) {
+			default:
+			case 0:
+				// Mode 1
+				sector->mode = 1;
+				data = sector->m1.data;
+				break;
+			case 1:
+				// Mode 2 Form 1
+				sector->mode = 2;
+				sector->m2xa_f1.sub.submode = 0x08;
+				data = sector->m2xa_f1.data;
+				break;
+			case 2:
+				// Mode 2 Form 2
+				sector->mode = 2;
+				sector->m2xa_f2.sub.submode = 0x28;
+				data = sector->m2xa_f2.data;
+				break;
+		}
+
+		uint8_t *const expected = &user_data[i * 2048];
+		for (unsigned int j = 0; j < 2048; j++) {
+			seed = seed * 1103515245 + 12345;
+			data[j] = static_cast<uint8_t>(seed >> 16);
+			expected[j] = data[j];
+		}
+	}
+
+	return img;
+}
+
+void Cdrom2352ReaderTest::SetUp(void)
+{
+	image = buildImage(SECTOR_COUNT, user_data);
+
+	RpMemFile *const memFile = new RpMemFile(image.data(), image.size());
+	cdromReader = new Cdrom2352Reader(memFile);
+	memFile->unref();
+	ASSERT_TRUE(cdromReader->isOpen());
+	ASSERT_EQ(static_cast<off64_t>(SECTOR_COUNT * 2048), cdromReader->size());
+}
+
+void Cdrom2352ReaderTest::TearDown(void)
+{
+	UNREF_AND_NULL(cdromReader);
+}
+
+/**
+ * Read the entire disc with a single read.
+ */
+TEST_F(Cdrom2352ReaderTest, readAllTest)
+{
+	vector<uint8_t> buf(user_data.size() + 4096);
+	cdromReader->rewind();
+	ASSERT_EQ(user_data.size(), cdromReader->read(buf.data(), buf.size()));
+	EXPECT_EQ(0, memcmp(user_data.data(), buf.data(), user_data.size()));
+
+	// At the end of the disc.
+	EXPECT_EQ(0U, cdromReader->read(buf.data(), buf.size()));
+}
+
+/**
+ * Read the disc using reads of various sizes and alignments.
+ */
+TEST_F(Cdrom2352ReaderTest, unalignedReadTest)
+{
+	vector<uint8_t> buf(256 * 1024);
+	uint32_t seed = 0x87654321;
+	for (unsigned int i = 0; i < 1000; i++) {
+		seed = seed * 1103515245 + 12345;
+		const size_t pos = (seed >> 8) % user_data.size();
+		seed = seed * 1103515245 + 12345;
+		size_t size = (seed >> 8) % buf.size();
+		if (pos + size > user_data.size()) {
+			size = user_data.size() - pos;
+		}
+
+		ASSERT_EQ(0, cdromReader->seek(pos));
+		ASSERT_EQ(size, cdromReader->read(buf.data(), size)) << "pos: " << pos;
+		EXPECT_EQ(0, memcmp(&user_data[pos], buf.data(), size)) <<
+			"pos: " << pos << ", size: " << size;
+	}
+}
+
+/**
+ * Read sectors directly from a file.
+ */
+TEST_F(Cdrom2352ReaderTest, readSectorsTest)
+{
+	RpMemFile *const memFile = new RpMemFile(image.data(), image.size());
+	vector<uint8_t> buf(user_data.size());
+
+	// Single sector.
+	EXPECT_EQ(1U, Cdrom2352Reader::readSectors(memFile, 5 * 2352, buf.data(), 1));
+	EXPECT_EQ(0, memcmp(&user_data[5 * 2048], buf.data(), 2048));
+
+	// Multiple batches.
+	EXPECT_EQ(100U, Cdrom2352Reader::readSectors(memFile, 7 * 2352, buf.data(), 100));
+	EXPECT_EQ(0, memcmp(&user_data[7 * 2048], buf.data(), 100 * 2048));
+
+	// Short read at the end of the file.
+	EXPECT_EQ(10U, Cdrom2352Reader::readSectors(memFile, (SECTOR_COUNT - 10) * 2352, buf.data(), 50));
+	EXPECT_EQ(0, memcmp(&user_data[(SECTOR_COUNT - 10) * 2048], buf.data(), 10 * 2048));
+
+	memFile->unref();
+}
+
+/**
+ * Benchmark reading a disc image in 64 KiB chunks.
+ */
+TEST_F(Cdrom2352ReaderTest, readBenchmark)
+{
+	vector<uint8_t> bm_user_data;
+	vector<uint8_t> bm_image = buildImage(BENCHMARK_SECTOR_COUNT, bm_user_data);
+	RpMemFile *const memFile = new RpMemFile(bm_image.data(), bm_image.size());
+	Cdrom2352Reader *const reader = new Cdrom2352Reader(memFile);
+	memFile->unref();
+	ASSERT_TRUE(reader->isOpen());
+
+	vector<uint8_t> buf(65536);
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		reader->rewind();
+		size_t total = 0;
+		size_t size;
+		while ((size = reader->read(buf.data(), buf.size())) > 0) {
+			total += size;
+		}
+		ASSERT_EQ(bm_user_data.size(), total);
+	}
+
+	// Verify the last chunk.
+	EXPECT_EQ(0, memcmp(&bm_user_data[bm_user_data.size() - buf.size()], buf.data(), buf.size()));
+	reader->unref();
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: Cdrom2352Reader tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
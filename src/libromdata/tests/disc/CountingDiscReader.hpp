@@ -0,0 +1,54 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * CountingDiscReader.hpp: DiscReader that counts seeks and bytes read.    *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBROMDATA_TESTS_DISC_COUNTINGDISCREADER_HPP__
+#define __ROMPROPERTIES_LIBROMDATA_TESTS_DISC_COUNTINGDISCREADER_HPP__
+
+#include "librpbase/disc/DiscReader.hpp"
+
+namespace LibRomData { namespace Tests {
+
+/**
+ * DiscReader that counts seeks and bytes read.
+ * Used to check how much I/O a partition reader does.
+ */
+class CountingDiscReader : public LibRpBase::DiscReader
+{
+	public:
+		explicit CountingDiscReader(LibRpFile::IRpFile *file)
+			: DiscReader(file)
+			, seekCount(0)
+			, bytesRead(0)
+		{ }
+
+	private:
+		typedef DiscReader super;
+		RP_DISABLE_COPY(CountingDiscReader)
+
+	public:
+		size_t read(void *ptr, size_t size) final
+		{
+			const size_t ret = super::read(ptr, size);
+			bytesRead += ret;
+			return ret;
+		}
+
+		int seek(off64_t pos) final
+		{
+			seekCount++;
+			return super::seek(pos);
+		}
+
+	public:
+		unsigned int seekCount;
+		size_t bytesRead;
+};
+
+} }
+
+#endif /* __ROMPROPERTIES_LIBROMDATA_TESTS_DISC_COUNTINGDISCREADER_HPP__ */
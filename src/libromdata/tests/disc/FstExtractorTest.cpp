@@ -0,0 +1,705 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * FstExtractorTest.cpp: File system lister and extractor test.            *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpbase, librpfile
+#include "librpbase/TextFuncs.hpp"
+#include "librpbase/disc/DiscReader.hpp"
+#include "librpcpu/byteswap.h"
+#include "librpfile/FileSystem.hpp"
+#include "librpfile/RpFile.hpp"
+#include "librpfile/RpMemFile.hpp"
+using namespace LibRpBase;
+using namespace LibRpFile;
+
+// libromdata
+#include "disc/FstExtractor.hpp"
+#include "disc/GcnPartition.hpp"
+#include "disc/IsoPartition.hpp"
+#include "Console/gcn_structs.h"
+#include "iso_structs.h"
+using LibRomData::FstExtractor;
+using LibRomData::GcnPartition;
+using LibRomData::IsoPartition;
+
+// C includes.
+#ifdef _WIN32
+# include <direct.h>
+# define rmdir(dirname) _rmdir(dirname)
+#else /* !_WIN32 */
+# include <unistd.h>
+#endif /* _WIN32 */
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <algorithm>
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+#ifdef _WIN32
+static const char dir_sep_chr = '\\';
+#else /* !_WIN32 */
+static const char dir_sep_chr = '/';
+#endif /* _WIN32 */
+
+namespace LibRomData { namespace Tests {
+
+/**
+ * DiscReader that records seek positions.
+ */
+class RecordingDiscReader : public DiscReader
+{
+	public:
+		explicit RecordingDiscReader(IRpFile *file)
+			: DiscReader(file)
+		{ }
+
+	private:
+		typedef DiscReader super;
+		RP_DISABLE_COPY(RecordingDiscReader)
+
+	public:
+		int seek(off64_t pos) final
+		{
+			seeks.push_back(pos);
+			return super::seek(pos);
+		}
+
+	public:
+		vector<off64_t> seeks;
+};
+
+/**
+ * Synthetic file or directory.
+ */
+struct FstTestNode {
+	string name;
+	string path;			// Full path, with a leading slash
+	bool isDir;
+	vector<FstTestNode> children;
+	vector<uint8_t> data;		// File contents
+	uint32_t address;		// Starting address, in bytes
+	uint32_t size;			// Directory size (ISO only)
+
+	FstTestNode(const string &name, bool isDir)
+		: name(name), isDir(isDir), address(0), size(0) { }
+};
+
+/**
+ * Synthetic image type.
+ */
+enum class ImageType {
+	GCN,
+	ISO,
+};
+
+class FstExtractorTest : public ::testing::TestWithParam<ImageType>
+{
+	protected:
+		FstExtractorTest()
+			: root("", true)
+			, discReader(nullptr)
+			, partition(nullptr)
+		{ }
+
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		// Size of the large file.
+		static const unsigned int BIG_FILE_SIZE = 50000;
+
+		// Start of the file data area.
+		static const uint32_t DATA_START = 0x8000;
+
+		// GameCube FST address.
+		static const uint32_t GCN_FST_ADDRESS = 0x2440;
+
+		// ISO-9660 block size.
+		static const unsigned int BLOCK_SIZE = 2048;
+
+		// ISO-9660 root directory block.
+		static const unsigned int ROOT_DIR_LBA = 20;
+
+		/**
+		 * Build the synthetic directory tree.
+		 * File data is stored in reverse order on the disc,
+		 * so listing order is the opposite of address order.
+		 * @param root	[out] Root directory.
+		 * @param iso	[in] If true, use ISO-9660 names.
+		 */
+		static void buildTree(FstTestNode &root, bool iso);
+
+		/**
+		 * Build a synthetic GameCube disc image.
+		 * @param root [in/out] Root directory.
+		 * @return GameCube disc image.
+		 */
+		static vector<uint8_t> buildGcn(FstTestNode &root);
+
+		/**
+		 * Build a synthetic ISO-9660 image.
+		 * @param root [in/out] Root directory.
+		 * @return ISO-9660 image.
+		 */
+		static vector<uint8_t> buildIso(FstTestNode &root);
+
+		/**
+		 * Get all nodes in the tree, in listing order.
+		 * @param node	[in] Directory.
+		 * @param nodes	[out] Nodes.
+		 */
+		static void getNodes(const FstTestNode &node, vector<const FstTestNode*> &nodes);
+
+		/**
+		 * Read a file from the host file system.
+		 * @param filename Filename.
+		 * @param data	[out] File contents.
+		 * @return True on success; false on error.
+		 */
+		static bool readHostFile(const string &filename, vector<uint8_t> &data);
+
+		/**
+		 * Remove extracted files and directories.
+		 * @param nodes	[in] Extracted nodes, in listing order.
+		 * @param prefixLen	[in] Length of the path prefix to remove.
+		 */
+		void removeExtracted(const vector<const FstTestNode*> &nodes, size_t prefixLen);
+
+	public:
+		vector<uint8_t> img_data;
+		FstTestNode root;
+		string outDir;
+
+		RecordingDiscReader *discReader;
+		IPartition *partition;
+};
+
+const uint32_t FstExtractorTest::DATA_START;
+const unsigned int FstExtractorTest::BLOCK_SIZE;
+
+/**
+ * Build the synthetic directory tree.
+ * File data is stored in reverse order on the disc,
+ * so listing order is the opposite of address order.
+ * @param root	[out] Root directory.
+ * @param iso	[in] If true, use ISO-9660 names.
+ */
+void FstExtractorTest::buildTree(FstTestNode &root, bool iso)
+{
+	// Directory tree:
+	// - /opening.bnr
+	// - /data/big.bin
+	// - /data/empty.bin
+	// - /data/sub/deep.txt
+	// - /zzz.txt
+	root = FstTestNode("", true);
+	root.children.emplace_back(iso ? "README.TXT" : "opening.bnr", false);
+	root.children.back().data.resize(100);
+	root.children.emplace_back(iso ? "DATA" : "data", true);
+	{
+		FstTestNode &data = root.children.back();
+		data.children.emplace_back(iso ? "BIG.BIN" : "big.bin", false);
+		data.children.back().data.resize(BIG_FILE_SIZE);
+		data.children.emplace_back(iso ? "EMPTY.BIN" : "empty.bin", false);
+		data.children.emplace_back(iso ? "SUB" : "sub", true);
+		data.children.back().children.emplace_back(iso ? "DEEP.TXT" : "deep.txt", false);
+		data.children.back().children.back().data.resize(30);
+	}
+	root.children.emplace_back(iso ? "ZZZ.TXT" : "zzz.txt", false);
+	root.children.back().data.resize(10);
+
+	// Set the paths and file contents.
+	struct {
+		uint32_t seed;
+		void operator()(FstTestNode &node) {
+			for (auto iter = node.children.begin(); iter != node.children.end(); ++iter) {
+				iter->path = node.path + '/' + iter->name;
+				if (iter->isDir) {
+					(*this)(*iter);
+					continue;
+				}
+				for (auto p = iter->data.begin(); p != iter->data.end(); ++p) {
+					seed = seed * 1103515245 + 12345;
+					*p = static_cast<uint8_t>(seed >> 16);
+				}
+			}
+		}
+	} initTree;
+	initTree.seed = 0x12345678;
+	initTree(root);
+}
+
+/**
+ * Get all nodes in the tree, in listing order.
+ * @param node	[in] Directory.
+ * @param nodes	[out] Nodes.
+ */
+void FstExtractorTest::getNodes(const FstTestNode &node, vector<const FstTestNode*> &nodes)
+{
+	for (auto iter = node.children.cbegin(); iter != node.children.cend(); ++iter) {
+		nodes.push_back(&(*iter));
+		if (iter->isDir) {
+			getNodes(*iter, nodes);
+		}
+	}
+}
+
+/**
+ * Assign file addresses in reverse listing order.
+ * @param root		[in/out] Root directory.
+ * @param address	[in] Starting address.
+ * @param align		[in] Alignment.
+ * @return End address.
+ */
+static uint32_t assignFileAddresses(FstTestNode &root, uint32_t address, uint32_t align)
+{
+	vector<const FstTestNode*> nodes;
+	FstExtractorTest::getNodes(root, nodes);
+	for (auto iter = nodes.rbegin(); iter != nodes.rend(); ++iter) {
+		FstTestNode *const node = const_cast<FstTestNode*>(*iter);
+		if (node->isDir) {
+			continue;
+		}
+		node->address = address;
+		address += (static_cast<uint32_t>(node->data.size()) + align - 1) & ~(align - 1);
+	}
+	return address;
+}
+
+/**
+ * Write file data to an image.
+ * @param img	[in/out] Image.
+ * @param node	[in] Directory.
+ */
+static void writeFileData(vector<uint8_t> &img, const FstTestNode &node)
+{
+	for (auto iter = node.children.cbegin(); iter != node.children.cend(); ++iter) {
+		if (iter->isDir) {
+			writeFileData(img, *iter);
+		} else if (!iter->data.empty()) {
+			memcpy(&img[iter->address], iter->data.data(), iter->data.size());
+		}
+	}
+}
+
+/**
+ * Flatten a directory into GameCube FST entries.
+ * @param node		[in] Directory.
+ * @param dirIdx	[in] Directory index.
+ * @param fst		[in/out] FST entries.
+ * @param strtab	[in/out] String table.
+ */
+static void flattenGcnDir(const FstTestNode &node, uint32_t dirIdx,
+	vector<GCN_FST_Entry> &fst, string &strtab)
+{
+	for (auto iter = node.children.cbegin(); iter != node.children.cend(); ++iter) {
+		const uint32_t idx = static_cast<uint32_t>(fst.size());
+		GCN_FST_Entry entry;
+		entry.file_type_name_offset = cpu_to_be32(
+			(iter->isDir ? 0x01000000U : 0) | static_cast<uint32_t>(strtab.size()));
+		strtab += iter->name;
+		strtab += '\0';
+		fst.push_back(entry);
+
+		if (iter->isDir) {
+			flattenGcnDir(*iter, idx, fst, strtab);
+			fst[idx].dir.parent_dir_idx = cpu_to_be32(dirIdx);
+			fst[idx].dir.next_offset = cpu_to_be32(static_cast<uint32_t>(fst.size()));
+		} else {
+			fst[idx].file.offset = cpu_to_be32(iter->address);
+			fst[idx].file.size = cpu_to_be32(static_cast<uint32_t>(iter->data.size()));
+		}
+	}
+}
+
+/**
+ * Build a synthetic GameCube disc image.
+ * @param root [in/out] Root directory.
+ * @return GameCube disc image.
+ */
+vector<uint8_t> FstExtractorTest::buildGcn(FstTestNode &root)
+{
+	const uint32_t end = assignFileAddresses(root, DATA_START, 32);
+
+	// Root directory entry.
+	vector<GCN_FST_Entry> fst(1);
+	string strtab(1, '\0');
+	fst[0].file_type_name_offset = cpu_to_be32(0x01000000U);
+	fst[0].root_dir.unused = 0;
+	flattenGcnDir(root, 0, fst, strtab);
+	fst[0].root_dir.file_count = cpu_to_be32(static_cast<uint32_t>(fst.size()));
+
+	const uint32_t fst_size = static_cast<uint32_t>(
+		((fst.size() * sizeof(GCN_FST_Entry)) + strtab.size() + 3) & ~3U);
+	EXPECT_LE(GCN_FST_ADDRESS + fst_size, DATA_START);
+
+	vector<uint8_t> img(end);
+	memcpy(&img[GCN_FST_ADDRESS], fst.data(), fst.size() * sizeof(GCN_FST_Entry));
+	memcpy(&img[GCN_FST_ADDRESS + fst.size() * sizeof(GCN_FST_Entry)], strtab.data(), strtab.size());
+	writeFileData(img, root);
+
+	// Boot block.
+	GCN_Boot_Block *const bootBlock = reinterpret_cast<GCN_Boot_Block*>(&img[GCN_Boot_Block_ADDRESS]);
+	bootBlock->fst_offset = cpu_to_be32(GCN_FST_ADDRESS);
+	bootBlock->fst_size = cpu_to_be32(fst_size);
+	bootBlock->fst_max_size = cpu_to_be32(fst_size);
+	return img;
+}
+
+// Set an ISO-9660 LSB/MSB value.
+// NOTE: Macros are used because the fields are packed.
+#define SET16(v, val) do { \
+	(v).le = cpu_to_le16(val); \
+	(v).be = cpu_to_be16(val); \
+} while (0)
+#define SET32(v, val) do { \
+	(v).le = cpu_to_le32(val); \
+	(v).be = cpu_to_be32(val); \
+} while (0)
+
+/**
+ * Add an ISO-9660 directory record to a buffer.
+ * @param buf		[in/out] Directory buffer.
+ * @param name		[in] Filename.
+ * @param block		[in] Starting block.
+ * @param size		[in] Size, in bytes.
+ * @param isDir		[in] True for a directory.
+ */
+static void addDirRecord(vector<uint8_t> &buf, const string &name,
+	uint32_t block, uint32_t size, bool isDir)
+{
+	const size_t rec_size = sizeof(ISO_DirEntry) + name.size() + (~name.size() & 1);
+	const size_t pos = buf.size();
+	buf.resize(pos + rec_size);
+	ISO_DirEntry *const dirEntry = reinterpret_cast<ISO_DirEntry*>(&buf[pos]);
+	dirEntry->entry_length = static_cast<uint8_t>(rec_size);
+	SET32(dirEntry->block, block);
+	SET32(dirEntry->size, size);
+	dirEntry->mtime.year = 2020 - 1900;
+	dirEntry->mtime.month = 1;
+	dirEntry->mtime.day = 1;
+	dirEntry->flags = (isDir ? ISO_FLAG_DIRECTORY : 0);
+	SET16(dirEntry->volume_seq_num, 1);
+	dirEntry->filename_length = static_cast<uint8_t>(name.size());
+	memcpy(&buf[pos + sizeof(*dirEntry)], name.data(), name.size());
+}
+
+/**
+ * Assign ISO-9660 directory blocks. (one block per directory)
+ * @param node	[in/out] Directory.
+ * @param block	[in/out] Next free block.
+ */
+static void assignIsoDirBlocks(FstTestNode &node, uint32_t &block)
+{
+	node.address = block * FstExtractorTest::BLOCK_SIZE;
+	node.size = FstExtractorTest::BLOCK_SIZE;
+	block++;
+	for (auto iter = node.children.begin(); iter != node.children.end(); ++iter) {
+		if (iter->isDir) {
+			assignIsoDirBlocks(*iter, block);
+		}
+	}
+}
+
+/**
+ * Write ISO-9660 directories.
+ * @param img		[in/out] ISO-9660 image.
+ * @param node		[in] Directory.
+ * @param parent	[in] Parent directory.
+ */
+static void writeIsoDirs(vector<uint8_t> &img, const FstTestNode &node, const FstTestNode &parent)
+{
+	const unsigned int bs = FstExtractorTest::BLOCK_SIZE;
+	vector<uint8_t> buf;
+	addDirRecord(buf, string(1, '\0'), node.address / bs, node.size, true);
+	addDirRecord(buf, string(1, '\1'), parent.address / bs, parent.size, true);
+	for (auto iter = node.children.cbegin(); iter != node.children.cend(); ++iter) {
+		if (iter->isDir) {
+			addDirRecord(buf, iter->name, iter->address / bs, iter->size, true);
+		} else {
+			addDirRecord(buf, iter->name + ";1", iter->address / bs,
+				static_cast<uint32_t>(iter->data.size()), false);
+		}
+	}
+	EXPECT_LE(buf.size(), node.size);
+	memcpy(&img[node.address], buf.data(), buf.size());
+
+	for (auto iter = node.children.cbegin(); iter != node.children.cend(); ++iter) {
+		if (iter->isDir) {
+			writeIsoDirs(img, *iter, node);
+		}
+	}
+}
+
+/**
+ * Build a synthetic ISO-9660 image.
+ * The path table is omitted, so directories are found
+ * by walking the directory tree.
+ * @param root [in/out] Root directory.
+ * @return ISO-9660 image.
+ */
+vector<uint8_t> FstExtractorTest::buildIso(FstTestNode &root)
+{
+	uint32_t block = ROOT_DIR_LBA;
+	assignIsoDirBlocks(root, block);
+	const uint32_t end = assignFileAddresses(root, block * BLOCK_SIZE, BLOCK_SIZE);
+
+	vector<uint8_t> img(end);
+	writeIsoDirs(img, root, root);
+	writeFileData(img, root);
+
+	ISO_Primary_Volume_Descriptor *const pvd =
+		reinterpret_cast<ISO_Primary_Volume_Descriptor*>(&img[ISO_PVD_ADDRESS_2048]);
+	pvd->header.type = ISO_VDT_PRIMARY;
+	memcpy(pvd->header.identifier, ISO_VD_MAGIC, sizeof(pvd->header.identifier));
+	pvd->header.version = ISO_VD_VERSION;
+	SET32(pvd->volume_space_size, end / BLOCK_SIZE);
+	SET16(pvd->logical_block_size, BLOCK_SIZE);
+	vector<uint8_t> rootRec;
+	addDirRecord(rootRec, string(1, '\0'), root.address / BLOCK_SIZE, root.size, true);
+	memcpy(&pvd->dir_entry_root, rootRec.data(), sizeof(pvd->dir_entry_root));
+	pvd->file_structure_version = 1;
+	return img;
+}
+
+/**
+ * Read a file from the host file system.
+ * @param filename Filename.
+ * @param data	[out] File contents.
+ * @return True on success; false on error.
+ */
+bool FstExtractorTest::readHostFile(const string &filename, vector<uint8_t> &data)
+{
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ);
+	if (!file->isOpen()) {
+		file->unref();
+		return false;
+	}
+
+	data.resize(static_cast<size_t>(file->size()));
+	const size_t size = (data.empty() ? 0 : file->read(data.data(), data.size()));
+	file->unref();
+	return (size == data.size());
+}
+
+/**
+ * Remove extracted files and directories.
+ * @param nodes	[in] Extracted nodes, in listing order.
+ * @param prefixLen	[in] Length of the path prefix to remove.
+ */
+void FstExtractorTest::removeExtracted(const vector<const FstTestNode*> &nodes, size_t prefixLen)
+{
+	for (auto iter = nodes.crbegin(); iter != nodes.crend(); ++iter) {
+		string path = outDir + dir_sep_chr + (*iter)->path.substr(prefixLen);
+		if ((*iter)->isDir) {
+			rmdir(path.c_str());
+		} else {
+			FileSystem::delete_file(path);
+		}
+	}
+	rmdir(outDir.c_str());
+}
+
+void FstExtractorTest::SetUp(void)
+{
+	const bool iso = (GetParam() == ImageType::ISO);
+	buildTree(root, iso);
+	img_data = (iso ? buildIso(root) : buildGcn(root));
+
+	RpMemFile *const memFile = new RpMemFile(img_data.data(), img_data.size());
+	discReader = new RecordingDiscReader(memFile);
+	memFile->unref();
+	ASSERT_TRUE(discReader->isOpen());
+
+	if (iso) {
+		partition = new IsoPartition(discReader, 0, 0);
+	} else {
+		partition = new GcnPartition(discReader, 0);
+	}
+	ASSERT_TRUE(partition->isOpen());
+
+	// Output directory.
+	outDir = rp_sprintf("FstExtractorTest.%s.out", (iso ? "iso" : "gcn"));
+}
+
+void FstExtractorTest::TearDown(void)
+{
+	UNREF_AND_NULL(partition);
+	UNREF_AND_NULL(discReader);
+}
+
+/**
+ * List the entire file system.
+ */
+TEST_P(FstExtractorTest, listTest)
+{
+	vector<const FstTestNode*> nodes;
+	getNodes(root, nodes);
+
+	FstExtractor extractor(partition);
+	vector<FstExtractor::Entry> entries;
+	ASSERT_EQ(0, extractor.list("/", entries));
+	ASSERT_EQ(nodes.size(), entries.size());
+	for (size_t i = 0; i < nodes.size(); i++) {
+		EXPECT_EQ(nodes[i]->path, entries[i].path);
+		EXPECT_EQ(nodes[i]->isDir ? DT_DIR : DT_REG, entries[i].type);
+		if (!nodes[i]->isDir) {
+			EXPECT_EQ(static_cast<off64_t>(nodes[i]->address), entries[i].offset) << nodes[i]->path;
+			EXPECT_EQ(static_cast<off64_t>(nodes[i]->data.size()), entries[i].size) << nodes[i]->path;
+		}
+	}
+
+	// List a subdirectory.
+	ASSERT_EQ(0, extractor.list(root.children[1].path.c_str(), entries));
+	ASSERT_EQ(4U, entries.size());
+	EXPECT_EQ(root.children[1].children[2].children[0].path, entries[3].path);
+
+	// Nonexistent directory.
+	EXPECT_NE(0, extractor.list("/nonexistent", entries));
+	EXPECT_TRUE(entries.empty());
+}
+
+/**
+ * Extract the entire file system.
+ * Small buffers are used in order to test multiple
+ * buffers per file and buffer reuse.
+ */
+TEST_P(FstExtractorTest, extractAllTest)
+{
+	vector<const FstTestNode*> nodes;
+	getNodes(root, nodes);
+
+	FstExtractor extractor(partition);
+	extractor.setBufferSize(4096);
+	extractor.setBufferCount(3);
+	extractor.setWriterCount(2);
+	ASSERT_EQ(0, extractor.extract("/", outDir.c_str()));
+
+	unsigned int fileCount = 0;
+	off64_t byteCount = 0;
+	for (auto iter = nodes.cbegin(); iter != nodes.cend(); ++iter) {
+		if ((*iter)->isDir) {
+			continue;
+		}
+		fileCount++;
+		byteCount += (*iter)->data.size();
+
+		string path = outDir + (*iter)->path;
+#ifdef _WIN32
+		std::replace(path.begin(), path.end(), '/', dir_sep_chr);
+#endif /* _WIN32 */
+		vector<uint8_t> data;
+		ASSERT_TRUE(readHostFile(path, data)) << path;
+		EXPECT_TRUE(data == (*iter)->data) << path;
+	}
+	EXPECT_EQ(fileCount, extractor.filesExtracted());
+	EXPECT_EQ(byteCount, extractor.bytesExtracted());
+
+	// Extract again using the same buffers.
+	ASSERT_EQ(0, extractor.extract("/", outDir.c_str()));
+	EXPECT_EQ(fileCount, extractor.filesExtracted());
+
+	removeExtracted(nodes, 1);
+}
+
+/**
+ * File data should be read in order of starting addresses,
+ * not in directory order.
+ */
+TEST_P(FstExtractorTest, sequentialReadTest)
+{
+	vector<const FstTestNode*> nodes;
+	getNodes(root, nodes);
+
+	FstExtractor extractor(partition);
+	extractor.setBufferSize(4096);
+	vector<FstExtractor::Entry> entries;
+	ASSERT_EQ(0, extractor.list("/", entries));
+
+	// Only check reads from the file data area.
+	discReader->seeks.clear();
+	ASSERT_EQ(0, extractor.extract("/", outDir.c_str()));
+	off64_t dataStart = img_data.size();
+	for (auto iter = nodes.cbegin(); iter != nodes.cend(); ++iter) {
+		if (!(*iter)->isDir && (*iter)->address < dataStart) {
+			dataStart = (*iter)->address;
+		}
+	}
+
+	off64_t lastPos = -1;
+	unsigned int dataSeeks = 0;
+	for (auto iter = discReader->seeks.cbegin(); iter != discReader->seeks.cend(); ++iter) {
+		if (*iter < dataStart) {
+			continue;
+		}
+		EXPECT_GE(*iter, lastPos);
+		lastPos = *iter;
+		dataSeeks++;
+	}
+	EXPECT_GT(dataSeeks, 0U);
+
+	removeExtracted(nodes, 1);
+}
+
+/**
+ * Extract a subdirectory and a single file.
+ */
+TEST_P(FstExtractorTest, extractPartialTest)
+{
+	const FstTestNode &dataDir = root.children[1];
+	const FstTestNode &bigFile = dataDir.children[0];
+	vector<const FstTestNode*> nodes;
+	getNodes(dataDir, nodes);
+
+	FstExtractor extractor(partition);
+	ASSERT_EQ(0, extractor.extract(dataDir.path.c_str(), outDir.c_str()));
+	EXPECT_EQ(3U, extractor.filesExtracted());
+
+	vector<uint8_t> data;
+	ASSERT_TRUE(readHostFile(outDir + dir_sep_chr + bigFile.name, data));
+	EXPECT_TRUE(data == bigFile.data);
+	removeExtracted(nodes, dataDir.path.size() + 1);
+
+	// Single file.
+	ASSERT_EQ(0, extractor.extract(bigFile.path.c_str(), outDir.c_str()));
+	EXPECT_EQ(1U, extractor.filesExtracted());
+	ASSERT_TRUE(readHostFile(outDir + dir_sep_chr + bigFile.name, data));
+	EXPECT_TRUE(data == bigFile.data);
+	FileSystem::delete_file(outDir + dir_sep_chr + bigFile.name);
+	rmdir(outDir.c_str());
+
+	// Nonexistent file.
+	EXPECT_EQ(-ENOENT, extractor.extract("/nonexistent", outDir.c_str()));
+}
+
+INSTANTIATE_TEST_CASE_P(FstExtractor, FstExtractorTest,
+	::testing::Values(ImageType::GCN, ImageType::ISO));
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: FstExtractor tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
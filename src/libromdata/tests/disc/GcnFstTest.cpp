@@ -129,6 +129,29 @@ class GcnFstTest : public ::testing::TestWithParam<GcnFstTest_mode>
 		 */
 		void checkNoDuplicateFilenames(const char *subdir);
 
+		/**
+		 * Directory entry with a full path.
+		 */
+		struct PathEnt {
+			string path;
+			off64_t offset;
+			off64_t size;
+			uint8_t type;
+		};
+
+		/**
+		 * Recursively get all paths in a subdirectory.
+		 * If a directory has duplicate filenames, only the
+		 * first one is added, since that's the one that
+		 * find_file() will return.
+		 * @param subdir	[in] Subdirectory path.
+		 * @param paths		[out] Paths.
+		 */
+		void getAllPaths(const string &subdir, vector<PathEnt> &paths);
+
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 4;
+
 	public:
 		/** Test case parameters. **/
 
@@ -376,6 +399,49 @@ void GcnFstTest::checkNoDuplicateFilenames(const char *subdir)
 	m_fst->closedir(dirp);
 }
 
+/**
+ * Recursively get all paths in a subdirectory.
+ * If a directory has duplicate filenames, only the
+ * first one is added, since that's the one that
+ * find_file() will return.
+ * @param subdir	[in] Subdirectory path.
+ * @param paths		[out] Paths.
+ */
+void GcnFstTest::getAllPaths(const string &subdir, vector<PathEnt> &paths)
+{
+	unordered_set<string> filenames;
+	vector<string> subdirs;
+
+	IFst::Dir *dirp = m_fst->opendir(subdir.c_str());
+	ASSERT_TRUE(dirp != nullptr) <<
+		"Failed to open directory '" << subdir << "'.";
+
+	IFst::DirEnt *dirent = m_fst->readdir(dirp);
+	while (dirent != nullptr) {
+		if (filenames.insert(dirent->name).second) {
+			PathEnt pathEnt;
+			pathEnt.path = subdir + '/' + dirent->name;
+			pathEnt.offset = dirent->offset;
+			pathEnt.size = dirent->size;
+			pathEnt.type = dirent->type;
+			if (dirent->type == DT_DIR) {
+				subdirs.push_back(pathEnt.path);
+			}
+			paths.push_back(std::move(pathEnt));
+		}
+
+		// Next entry.
+		dirent = m_fst->readdir(dirp);
+	}
+	m_fst->closedir(dirp);
+
+	// Check subdirectories.
+	const auto subdirs_cend = subdirs.cend();
+	for (auto iter = subdirs.cbegin(); iter != subdirs_cend; ++iter) {
+		ASSERT_NO_FATAL_FAILURE(getAllPaths(*iter, paths));
+	}
+}
+
 /**
  * Verify that '/' is collapsed correctly.
  */
@@ -400,6 +466,44 @@ TEST_P(GcnFstTest, NoDuplicateFilenames)
 	EXPECT_FALSE(m_fst->hasErrors());
 }
 
+/**
+ * Look up every file and directory in the FST.
+ */
+TEST_P(GcnFstTest, FindFileBenchmark)
+{
+	vector<PathEnt> paths;
+	ASSERT_NO_FATAL_FAILURE(getAllPaths(string(), paths));
+	ASSERT_FALSE(paths.empty());
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		const auto paths_cend = paths.cend();
+		for (auto iter = paths.cbegin(); iter != paths_cend; ++iter) {
+			IFst::DirEnt dirent;
+			ASSERT_EQ(0, m_fst->find_file(iter->path.c_str(), &dirent)) <<
+				"Failed to find '" << iter->path << "'.";
+			EXPECT_EQ(iter->type, dirent.type) << "Path: " << iter->path;
+			EXPECT_EQ(iter->offset, dirent.offset) << "Path: " << iter->path;
+			EXPECT_EQ(iter->size, dirent.size) << "Path: " << iter->path;
+		}
+	}
+
+	// Paths with extra slashes must be handled the same way.
+	const PathEnt &last = paths.back();
+	string path = "//" + last.path + "//";
+	IFst::DirEnt dirent;
+	ASSERT_EQ(0, m_fst->find_file(path.c_str(), &dirent));
+	EXPECT_EQ(last.offset, dirent.offset);
+
+	// Nonexistent paths.
+	EXPECT_EQ(-ENOENT, m_fst->find_file("/this_file_does_not_exist.bin", &dirent));
+	path = last.path + "/x";
+	if (last.type != DT_DIR) {
+		// Files can't have subdirectories.
+		EXPECT_EQ(-ENOENT, m_fst->find_file(path.c_str(), &dirent));
+	}
+	EXPECT_FALSE(m_fst->hasErrors());
+}
+
 /**
  * Print the FST directory structure and compare it to a known-good version.
  */
@@ -0,0 +1,523 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * IsoPartitionTest.cpp: ISO-9660 partition reader test.                   *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpbase, librpfile
+#include "librpbase/TextFuncs.hpp"
+#include "librpcpu/byteswap.h"
+#include "librpfile/RpMemFile.hpp"
+using namespace LibRpBase;
+using LibRpFile::IRpFile;
+using LibRpFile::RpMemFile;
+
+// libromdata
+#include "disc/IsoPartition.hpp"
+#include "iso_structs.h"
+using LibRomData::IsoPartition;
+
+#include "CountingDiscReader.hpp"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class IsoPartitionTest : public ::testing::Test
+{
+	protected:
+		IsoPartitionTest()
+			: discReader(nullptr)
+			, isoPartition(nullptr)
+		{ }
+
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		// Block size.
+		static const unsigned int BLOCK_SIZE = 2048;
+
+		// Directory tree:
+		// - DIR00-DIR07, each with SUB00-SUB07, each with FILE00-FILE03.
+		// - LARGE, with FILE000-FILE099. (spans multiple blocks)
+		static const unsigned int DIR_COUNT = 8;
+		static const unsigned int SUBDIR_COUNT = 8;
+		static const unsigned int SUBDIR_FILE_COUNT = 4;
+		static const unsigned int LARGE_FILE_COUNT = 100;
+
+		// Block addresses.
+		static const unsigned int PATH_TABLE_L_LBA = 18;
+		static const unsigned int PATH_TABLE_M_LBA = 19;
+		static const unsigned int ROOT_DIR_LBA = 20;
+
+		// Timestamp for all directory entries: 2020/01/02 03:04:05 UTC
+		static const time_t FILE_MTIME = 1577934245;
+
+		/**
+		 * Build a synthetic ISO-9660 image.
+		 * File contents are the file's full path.
+		 * @param filenames	[out] Full paths of all files.
+		 * @return ISO-9660 image.
+		 */
+		static vector<uint8_t> buildIso(vector<string> &filenames);
+
+		/**
+		 * Get the Primary Volume Descriptor in a synthetic ISO-9660 image.
+		 * @param iso ISO-9660 image.
+		 * @return Primary Volume Descriptor.
+		 */
+		static inline ISO_Primary_Volume_Descriptor *getPVD(vector<uint8_t> &iso)
+		{
+			return reinterpret_cast<ISO_Primary_Volume_Descriptor*>(&iso[ISO_PVD_ADDRESS_2048]);
+		}
+
+		/**
+		 * Open an IsoPartition from an ISO-9660 image.
+		 * @param iso ISO-9660 image.
+		 */
+		void openIso(const vector<uint8_t> &iso);
+
+		/**
+		 * Open and read a file from the IsoPartition.
+		 * @param filename Filename.
+		 * @return File contents, or an empty string on error.
+		 */
+		string readFile(const char *filename);
+
+	public:
+		vector<uint8_t> iso_data;
+		vector<string> filenames;
+
+		CountingDiscReader *discReader;
+		IsoPartition *isoPartition;
+};
+
+const unsigned int IsoPartitionTest::BLOCK_SIZE;
+const time_t IsoPartitionTest::FILE_MTIME;
+
+/**
+ * Synthetic directory for buildIso().
+ */
+struct IsoTestDir {
+	string name;			// ISO name (root == "")
+	string path;			// Full path
+	unsigned int parent;		// Parent directory index
+	vector<unsigned int> subdirs;	// Subdirectory indexes
+	vector<string> files;		// Filenames (without ";1")
+	vector<uint32_t> file_blocks;	// File starting blocks
+	uint32_t block;			// Starting block
+	uint32_t size;			// Directory size, in bytes
+};
+
+// Set an ISO-9660 LSB/MSB value.
+// NOTE: Macros are used because the fields are packed.
+#define SET16(v, val) do { \
+	(v).le = cpu_to_le16(val); \
+	(v).be = cpu_to_be16(val); \
+} while (0)
+#define SET32(v, val) do { \
+	(v).le = cpu_to_le32(val); \
+	(v).be = cpu_to_be32(val); \
+} while (0)
+
+/**
+ * Get the size of a directory record.
+ * @param name_len Filename length.
+ * @return Directory record size.
+ */
+static inline unsigned int dirRecordSize(size_t name_len)
+{
+	return static_cast<unsigned int>(sizeof(ISO_DirEntry) + name_len + (~name_len & 1));
+}
+
+/**
+ * Add a directory record to a buffer.
+ * Records are not allowed to cross block boundaries.
+ * @param buf		[in/out] Directory buffer.
+ * @param name		[in] Filename. (If nullptr, only the size is reserved.)
+ * @param name_len	[in] Filename length.
+ * @param block		[in] Starting block.
+ * @param size		[in] Size, in bytes.
+ * @param isDir		[in] True for a directory.
+ */
+static void addDirRecord(vector<uint8_t> &buf, const char *name, size_t name_len,
+	uint32_t block, uint32_t size, bool isDir)
+{
+	const unsigned int rec_size = dirRecordSize(name_len);
+	const size_t block_remain = IsoPartitionTest::BLOCK_SIZE - (buf.size() % IsoPartitionTest::BLOCK_SIZE);
+	if (rec_size > block_remain) {
+		// Pad to the next block.
+		buf.resize(buf.size() + block_remain);
+	}
+
+	const size_t pos = buf.size();
+	buf.resize(pos + rec_size);
+	ISO_DirEntry *const dirEntry = reinterpret_cast<ISO_DirEntry*>(&buf[pos]);
+	dirEntry->entry_length = static_cast<uint8_t>(rec_size);
+	SET32(dirEntry->block, block);
+	SET32(dirEntry->size, size);
+	dirEntry->mtime.year = 2020 - 1900;
+	dirEntry->mtime.month = 1;
+	dirEntry->mtime.day = 2;
+	dirEntry->mtime.hour = 3;
+	dirEntry->mtime.minute = 4;
+	dirEntry->mtime.second = 5;
+	dirEntry->mtime.tz_offset = 0;
+	dirEntry->flags = (isDir ? ISO_FLAG_DIRECTORY : 0);
+	SET16(dirEntry->volume_seq_num, 1);
+	dirEntry->filename_length = static_cast<uint8_t>(name_len);
+	if (name) {
+		memcpy(&buf[pos + sizeof(*dirEntry)], name, name_len);
+	}
+}
+
+/**
+ * Build a synthetic ISO-9660 image.
+ * File contents are the file's full path.
+ * @param filenames	[out] Full paths of all files.
+ * @return ISO-9660 image.
+ */
+vector<uint8_t> IsoPartitionTest::buildIso(vector<string> &filenames)
+{
+	// Create the directory tree in breadth-first order,
+	// which is the same order used by the path table.
+	vector<IsoTestDir> dirs;
+	dirs.resize(1);
+	dirs[0].parent = 0;
+	for (unsigned int i = 0; i < DIR_COUNT; i++) {
+		IsoTestDir dir;
+		dir.name = rp_sprintf("DIR%02u", i);
+		dir.path = dir.name;
+		dir.parent = 0;
+		dirs[0].subdirs.push_back(static_cast<unsigned int>(dirs.size()));
+		dirs.push_back(std::move(dir));
+	}
+	{
+		IsoTestDir dir;
+		dir.name = "LARGE";
+		dir.path = dir.name;
+		dir.parent = 0;
+		for (unsigned int i = 0; i < LARGE_FILE_COUNT; i++) {
+			dir.files.push_back(rp_sprintf("FILE%03u.BIN", i));
+		}
+		dirs[0].subdirs.push_back(static_cast<unsigned int>(dirs.size()));
+		dirs.push_back(std::move(dir));
+	}
+	for (unsigned int i = 1; i <= DIR_COUNT; i++) {
+		for (unsigned int j = 0; j < SUBDIR_COUNT; j++) {
+			IsoTestDir dir;
+			dir.name = rp_sprintf("SUB%02u", j);
+			dir.path = dirs[i].path + '/' + dir.name;
+			dir.parent = i;
+			for (unsigned int k = 0; k < SUBDIR_FILE_COUNT; k++) {
+				dir.files.push_back(rp_sprintf("FILE%02u.BIN", k));
+			}
+			dirs[i].subdirs.push_back(static_cast<unsigned int>(dirs.size()));
+			dirs.push_back(std::move(dir));
+		}
+	}
+
+	// Calculate directory sizes and assign directory blocks.
+	uint32_t block = ROOT_DIR_LBA;
+	for (auto iter = dirs.begin(); iter != dirs.end(); ++iter) {
+		vector<uint8_t> tmp;
+		addDirRecord(tmp, "\0", 1, 0, 0, true);
+		addDirRecord(tmp, "\1", 1, 0, 0, true);
+		for (auto sub_iter = iter->subdirs.cbegin(); sub_iter != iter->subdirs.cend(); ++sub_iter) {
+			addDirRecord(tmp, nullptr, dirs[*sub_iter].name.size(), 0, 0, true);
+		}
+		for (auto file_iter = iter->files.cbegin(); file_iter != iter->files.cend(); ++file_iter) {
+			addDirRecord(tmp, nullptr, file_iter->size() + 2, 0, 0, false);
+		}
+		iter->size = static_cast<uint32_t>((tmp.size() + BLOCK_SIZE - 1) & ~(BLOCK_SIZE - 1));
+		iter->block = block;
+		block += iter->size / BLOCK_SIZE;
+	}
+
+	// Assign file blocks. (one block per file)
+	filenames.clear();
+	for (auto iter = dirs.begin(); iter != dirs.end(); ++iter) {
+		for (auto file_iter = iter->files.cbegin(); file_iter != iter->files.cend(); ++file_iter) {
+			iter->file_blocks.push_back(block++);
+			filenames.push_back(iter->path + '/' + *file_iter);
+		}
+	}
+
+	vector<uint8_t> iso;
+	iso.resize(block * BLOCK_SIZE);
+
+	// Write the directories and file data.
+	for (auto iter = dirs.begin(); iter != dirs.end(); ++iter) {
+		const IsoTestDir &parent = dirs[iter->parent];
+		vector<uint8_t> buf;
+		addDirRecord(buf, "\0", 1, iter->block, iter->size, true);
+		addDirRecord(buf, "\1", 1, parent.block, parent.size, true);
+		for (auto sub_iter = iter->subdirs.cbegin(); sub_iter != iter->subdirs.cend(); ++sub_iter) {
+			const IsoTestDir &subdir = dirs[*sub_iter];
+			addDirRecord(buf, subdir.name.data(), subdir.name.size(), subdir.block, subdir.size, true);
+		}
+		for (size_t i = 0; i < iter->files.size(); i++) {
+			const string name = iter->files[i] + ";1";
+			const string path = iter->path + '/' + iter->files[i];
+			addDirRecord(buf, name.data(), name.size(), iter->file_blocks[i],
+				static_cast<uint32_t>(path.size()), false);
+			memcpy(&iso[iter->file_blocks[i] * BLOCK_SIZE], path.data(), path.size());
+		}
+		EXPECT_LE(buf.size(), iter->size);
+		memcpy(&iso[iter->block * BLOCK_SIZE], buf.data(), buf.size());
+	}
+
+	// Write the path tables.
+	uint8_t *pt_L = &iso[PATH_TABLE_L_LBA * BLOCK_SIZE];
+	uint8_t *pt_M = &iso[PATH_TABLE_M_LBA * BLOCK_SIZE];
+	unsigned int pt_size = 0;
+	for (auto iter = dirs.cbegin(); iter != dirs.cend(); ++iter) {
+		const size_t name_len = (iter->name.empty() ? 1 : iter->name.size());
+		ISO_PathTableEntry *const ptL = reinterpret_cast<ISO_PathTableEntry*>(pt_L + pt_size);
+		ISO_PathTableEntry *const ptM = reinterpret_cast<ISO_PathTableEntry*>(pt_M + pt_size);
+		ptL->name_length = static_cast<uint8_t>(name_len);
+		ptL->block = cpu_to_le32(iter->block);
+		ptL->parent_dir_num = cpu_to_le16(static_cast<uint16_t>(iter->parent + 1));
+		ptM->name_length = static_cast<uint8_t>(name_len);
+		ptM->block = cpu_to_be32(iter->block);
+		ptM->parent_dir_num = cpu_to_be16(static_cast<uint16_t>(iter->parent + 1));
+		memcpy(ptL + 1, iter->name.data(), iter->name.size());
+		memcpy(ptM + 1, iter->name.data(), iter->name.size());
+		pt_size += static_cast<unsigned int>(sizeof(*ptL) + name_len + (name_len & 1));
+	}
+	EXPECT_LE(pt_size, BLOCK_SIZE);
+
+	// Write the volume descriptors.
+	ISO_Primary_Volume_Descriptor *const pvd = getPVD(iso);
+	pvd->header.type = ISO_VDT_PRIMARY;
+	memcpy(pvd->header.identifier, ISO_VD_MAGIC, sizeof(pvd->header.identifier));
+	pvd->header.version = ISO_VD_VERSION;
+	memset(pvd->sysID, ' ', sizeof(pvd->sysID));
+	memset(pvd->volID, ' ', sizeof(pvd->volID));
+	memcpy(pvd->volID, "ISOPARTITIONTEST", 16);
+	SET32(pvd->volume_space_size, block);
+	SET16(pvd->volume_set_size, 1);
+	SET16(pvd->volume_seq_number, 1);
+	SET16(pvd->logical_block_size, BLOCK_SIZE);
+	SET32(pvd->path_table_size, pt_size);
+	pvd->path_table_lba_L = cpu_to_le32(PATH_TABLE_L_LBA);
+	pvd->path_table_lba_M = cpu_to_be32(PATH_TABLE_M_LBA);
+	vector<uint8_t> root;
+	addDirRecord(root, "\0", 1, dirs[0].block, dirs[0].size, true);
+	memcpy(&pvd->dir_entry_root, root.data(), sizeof(pvd->dir_entry_root) + 1);
+	pvd->file_structure_version = 1;
+
+	ISO_Volume_Descriptor_Header *const term =
+		reinterpret_cast<ISO_Volume_Descriptor_Header*>(&iso[ISO_PVD_ADDRESS_2048 + BLOCK_SIZE]);
+	term->type = ISO_VDT_TERMINATOR;
+	memcpy(term->identifier, ISO_VD_MAGIC, sizeof(term->identifier));
+	term->version = ISO_VD_VERSION;
+
+	return iso;
+}
+
+/**
+ * Open an IsoPartition from an ISO-9660 image.
+ * @param iso ISO-9660 image.
+ */
+void IsoPartitionTest::openIso(const vector<uint8_t> &iso)
+{
+	TearDown();
+
+	RpMemFile *const memFile = new RpMemFile(iso.data(), iso.size());
+	discReader = new CountingDiscReader(memFile);
+	memFile->unref();
+	ASSERT_TRUE(discReader->isOpen());
+
+	isoPartition = new IsoPartition(discReader, 0, 0);
+	ASSERT_TRUE(isoPartition->isOpen());
+}
+
+/**
+ * Open and read a file from the IsoPartition.
+ * @param filename Filename.
+ * @return File contents, or an empty string on error.
+ */
+string IsoPartitionTest::readFile(const char *filename)
+{
+	IRpFile *const file = isoPartition->open(filename);
+	if (!file) {
+		return string();
+	}
+
+	string s_data;
+	s_data.resize(static_cast<size_t>(file->size()));
+	size_t size = file->read(&s_data[0], s_data.size());
+	file->unref();
+	if (size != s_data.size()) {
+		return string();
+	}
+	return s_data;
+}
+
+void IsoPartitionTest::SetUp(void)
+{
+	iso_data = buildIso(filenames);
+	openIso(iso_data);
+}
+
+void IsoPartitionTest::TearDown(void)
+{
+	UNREF_AND_NULL(isoPartition);
+	UNREF_AND_NULL(discReader);
+}
+
+/**
+ * Open every file in the image.
+ */
+TEST_F(IsoPartitionTest, openAllFilesTest)
+{
+	ASSERT_EQ(DIR_COUNT * SUBDIR_COUNT * SUBDIR_FILE_COUNT + LARGE_FILE_COUNT, filenames.size());
+	for (auto iter = filenames.cbegin(); iter != filenames.cend(); ++iter) {
+		EXPECT_EQ(*iter, readFile(iter->c_str()));
+		EXPECT_EQ(FILE_MTIME, isoPartition->get_mtime(iter->c_str())) << *iter;
+	}
+}
+
+/**
+ * Lookups are case-insensitive, and accept backslashes
+ * and leading or duplicate slashes.
+ */
+TEST_F(IsoPartitionTest, pathVariantsTest)
+{
+	EXPECT_EQ("DIR03/SUB05/FILE02.BIN", readFile("dir03/sub05/file02.bin"));
+	EXPECT_EQ("DIR03/SUB05/FILE02.BIN", readFile("/DIR03/SUB05/FILE02.BIN"));
+	EXPECT_EQ("DIR03/SUB05/FILE02.BIN", readFile("DIR03\\SUB05\\FILE02.BIN"));
+	EXPECT_EQ("DIR04/SUB06/FILE01.BIN", readFile("DIR04//SUB06/FILE01.BIN"));
+	EXPECT_EQ("LARGE/FILE099.BIN", readFile("/large/file099.bin"));
+
+	// Nonexistent files and directories.
+	EXPECT_TRUE(isoPartition->open("DIR03/SUB05/FILE04.BIN") == nullptr);
+	EXPECT_TRUE(isoPartition->open("DIR03/SUB08/FILE00.BIN") == nullptr);
+	EXPECT_TRUE(isoPartition->open("DIR09/SUB00/FILE00.BIN") == nullptr);
+
+	// Directories can't be opened as files.
+	EXPECT_TRUE(isoPartition->open("DIR03/SUB05") == nullptr);
+	EXPECT_EQ(EISDIR, isoPartition->lastError());
+}
+
+/**
+ * Loading a directory using the path table should take a single seek,
+ * regardless of the directory depth.
+ */
+TEST_F(IsoPartitionTest, pathTableSeekTest)
+{
+	// First lookup: Path table + directory.
+	discReader->seekCount = 0;
+	EXPECT_EQ("DIR03/SUB05/FILE02.BIN", readFile("DIR03/SUB05/FILE02.BIN"));
+	EXPECT_EQ(2U + 1U, discReader->seekCount);
+
+	// Second lookup: Directory only.
+	discReader->seekCount = 0;
+	EXPECT_EQ("DIR06/SUB01/FILE00.BIN", readFile("DIR06/SUB01/FILE00.BIN"));
+	EXPECT_EQ(1U + 1U, discReader->seekCount);
+
+	// Multi-block directory: Still only one seek.
+	discReader->seekCount = 0;
+	EXPECT_EQ("LARGE/FILE099.BIN", readFile("LARGE/FILE099.BIN"));
+	EXPECT_EQ(1U + 1U, discReader->seekCount);
+
+	// Cached directory: No seeks.
+	discReader->seekCount = 0;
+	EXPECT_EQ("DIR06/SUB01/FILE03.BIN", readFile("DIR06/SUB01/FILE03.BIN"));
+	EXPECT_EQ(0U + 1U, discReader->seekCount);
+}
+
+/**
+ * The M path table is used if the L path table is missing.
+ */
+TEST_F(IsoPartitionTest, mPathTableTest)
+{
+	getPVD(iso_data)->path_table_lba_L = 0;
+	openIso(iso_data);
+
+	discReader->seekCount = 0;
+	EXPECT_EQ("DIR07/SUB07/FILE03.BIN", readFile("DIR07/SUB07/FILE03.BIN"));
+	EXPECT_EQ(2U + 1U, discReader->seekCount);
+
+	for (auto iter = filenames.cbegin(); iter != filenames.cend(); ++iter) {
+		EXPECT_EQ(*iter, readFile(iter->c_str()));
+	}
+}
+
+/**
+ * If the path table is missing, directories are found
+ * by walking the directory tree.
+ */
+TEST_F(IsoPartitionTest, noPathTableTest)
+{
+	SET32(getPVD(iso_data)->path_table_size, 0);
+	openIso(iso_data);
+
+	discReader->seekCount = 0;
+	EXPECT_EQ("DIR07/SUB07/FILE03.BIN", readFile("DIR07/SUB07/FILE03.BIN"));
+	EXPECT_EQ(2U + 1U, discReader->seekCount);
+
+	for (auto iter = filenames.cbegin(); iter != filenames.cend(); ++iter) {
+		EXPECT_EQ(*iter, readFile(iter->c_str()));
+	}
+}
+
+/**
+ * If the path table is invalid, directories are found
+ * by walking the directory tree.
+ */
+TEST_F(IsoPartitionTest, invalidPathTableTest)
+{
+	// Second entry: Set the parent directory to itself.
+	static const unsigned int ptEntry_offset =
+		PATH_TABLE_L_LBA * BLOCK_SIZE + sizeof(ISO_PathTableEntry) + 2;
+	ISO_PathTableEntry *ptEntry = reinterpret_cast<ISO_PathTableEntry*>(&iso_data[ptEntry_offset]);
+	ASSERT_EQ(5U, ptEntry->name_length);
+	ptEntry->parent_dir_num = cpu_to_le16(2);
+	openIso(iso_data);
+
+	for (auto iter = filenames.cbegin(); iter != filenames.cend(); ++iter) {
+		EXPECT_EQ(*iter, readFile(iter->c_str()));
+	}
+
+	// Point a directory at the wrong block.
+	// The directory tree should be used instead.
+	iso_data = buildIso(filenames);
+	ptEntry = reinterpret_cast<ISO_PathTableEntry*>(&iso_data[ptEntry_offset]);
+	ptEntry->parent_dir_num = cpu_to_le16(1);
+	ptEntry->block = cpu_to_le32(PATH_TABLE_M_LBA);
+	openIso(iso_data);
+
+	EXPECT_EQ("DIR00/SUB00/FILE00.BIN", readFile("DIR00/SUB00/FILE00.BIN"));
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: IsoPartition tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
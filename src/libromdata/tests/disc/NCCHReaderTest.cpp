@@ -0,0 +1,189 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * NCCHReaderTest.cpp: Nintendo 3DS NCCH reader test.                      *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpbase, librpfile
+#include "librpcpu/byteswap.h"
+#include "librpbase/crypto/AesCipherFactory.hpp"
+#include "librpbase/crypto/IAesCipher.hpp"
+#include "librpfile/RpMemFile.hpp"
+using LibRpBase::AesCipherFactory;
+using LibRpBase::IAesCipher;
+using LibRpFile::RpMemFile;
+
+// libromdata
+#include "disc/NCCHReader.hpp"
+#include "crypto/N3DSVerifyKeys.hpp"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <memory>
+#include <vector>
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class NCCHReaderTest : public ::testing::Test
+{
+	protected:
+		NCCHReaderTest()
+			: reader(nullptr)
+		{ }
+
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		// RomFS location. (NCCH-relative)
+		static const uint32_t ROMFS_OFFSET = 0x200;
+		static const uint32_t ROMFS_SIZE = 0x32000;	// 3 cache blocks + 8 KB
+
+		vector<uint8_t> image;
+		vector<uint8_t> romfs_plain;
+		NCCHReader *reader;
+};
+
+const uint32_t NCCHReaderTest::ROMFS_OFFSET;
+const uint32_t NCCHReaderTest::ROMFS_SIZE;
+
+void NCCHReaderTest::SetUp(void)
+{
+	image.assign(ROMFS_OFFSET + ROMFS_SIZE, 0);
+
+	// NCCH header.
+	// Fixed-key (zero key) encryption is used, so no
+	// keys need to be loaded from keys.conf.
+	N3DS_NCCH_Header_t *const ncch_header = reinterpret_cast<N3DS_NCCH_Header_t*>(image.data());
+	N3DS_NCCH_Header_NoSig_t *const hdr = &ncch_header->hdr;
+	hdr->magic = cpu_to_be32(N3DS_NCCH_HEADER_MAGIC);
+	hdr->content_size = cpu_to_le32(static_cast<uint32_t>(image.size() >> 9));
+	hdr->title_id.id = cpu_to_le64(0x0004000000123400ULL);
+	hdr->program_id.id = hdr->title_id.id;
+	hdr->flags[N3DS_NCCH_FLAG_BIT_MASKS] = N3DS_NCCH_BIT_MASK_FixedCryptoKey;
+	hdr->romfs_offset = cpu_to_le32(ROMFS_OFFSET >> 9);
+	hdr->romfs_size = cpu_to_le32(ROMFS_SIZE >> 9);
+
+	// RomFS plaintext.
+	romfs_plain.resize(ROMFS_SIZE);
+	uint32_t seed = 0x12345678;
+	for (auto iter = romfs_plain.begin(); iter != romfs_plain.end(); ++iter) {
+		seed = (seed * 1103515245U) + 12345U;
+		*iter = static_cast<uint8_t>(seed >> 16);
+	}
+
+	// Encrypt the RomFS.
+	// NOTE: CTR mode is symmetric, so decrypt() encrypts the data.
+	memcpy(&image[ROMFS_OFFSET], romfs_plain.data(), ROMFS_SIZE);
+	unique_ptr<IAesCipher> cipher(AesCipherFactory::create());
+	ASSERT_TRUE(cipher->isInit());
+	const uint8_t zero_key[16] = {0};
+	ASSERT_EQ(0, cipher->setChainingMode(IAesCipher::ChainingMode::CTR));
+	ASSERT_EQ(0, cipher->setKey(zero_key, sizeof(zero_key)));
+	u128_t ctr;
+	ctr.init_ctr(__swab64(hdr->title_id.id), N3DS_NCCH_SECTION_ROMFS, 0);
+	ASSERT_EQ(0, cipher->setIV(ctr.u8, sizeof(ctr.u8)));
+	ASSERT_EQ(ROMFS_SIZE, cipher->decrypt(&image[ROMFS_OFFSET], ROMFS_SIZE));
+
+	RpMemFile *const memFile = new RpMemFile(image.data(), image.size());
+	reader = new NCCHReader(memFile, 9, 0, static_cast<uint32_t>(image.size()));
+	memFile->unref();
+}
+
+void NCCHReaderTest::TearDown(void)
+{
+	UNREF_AND_NULL(reader);
+}
+
+/**
+ * Read the RomFS in small sequential chunks.
+ * Each cache block should only be decrypted once.
+ */
+TEST_F(NCCHReaderTest, smallReadTest)
+{
+	ASSERT_TRUE(reader->isOpen());
+	ASSERT_EQ(0, reader->seek(ROMFS_OFFSET));
+
+	const unsigned int CHUNK_SIZE = 0x200;
+	vector<uint8_t> buf(ROMFS_SIZE);
+	for (unsigned int i = 0; i < ROMFS_SIZE; i += CHUNK_SIZE) {
+		ASSERT_EQ(CHUNK_SIZE, reader->read(&buf[i], CHUNK_SIZE)) << "offset " << i;
+	}
+	EXPECT_EQ(0, memcmp(romfs_plain.data(), buf.data(), ROMFS_SIZE));
+
+	const NCCHReader::DecryptStats stats = reader->decryptStats();
+	EXPECT_EQ(ROMFS_SIZE, stats.bytesDecrypted);
+	EXPECT_EQ(4U, stats.cacheMisses);
+	EXPECT_EQ((ROMFS_SIZE / CHUNK_SIZE) - 4, stats.cacheHits);
+}
+
+/**
+ * Read the entire RomFS in one call.
+ * Whole cache blocks should bypass the cache.
+ */
+TEST_F(NCCHReaderTest, largeReadTest)
+{
+	ASSERT_TRUE(reader->isOpen());
+	ASSERT_EQ(0, reader->seek(ROMFS_OFFSET));
+
+	vector<uint8_t> buf(ROMFS_SIZE);
+	ASSERT_EQ(ROMFS_SIZE, reader->read(buf.data(), buf.size()));
+	EXPECT_EQ(0, memcmp(romfs_plain.data(), buf.data(), ROMFS_SIZE));
+
+	// Only the last partial block is cached.
+	const NCCHReader::DecryptStats stats = reader->decryptStats();
+	EXPECT_EQ(ROMFS_SIZE, stats.bytesDecrypted);
+	EXPECT_EQ(1U, stats.cacheMisses);
+	EXPECT_EQ(0U, stats.cacheHits);
+}
+
+/**
+ * Read a range that isn't aligned to a cache block.
+ */
+TEST_F(NCCHReaderTest, unalignedReadTest)
+{
+	ASSERT_TRUE(reader->isOpen());
+
+	const uint32_t pos = 0xFF00;
+	const size_t size = 0x20210;
+	ASSERT_EQ(0, reader->seek(ROMFS_OFFSET + pos));
+	vector<uint8_t> buf(size);
+	ASSERT_EQ(size, reader->read(buf.data(), size));
+	EXPECT_EQ(0, memcmp(&romfs_plain[pos], buf.data(), size));
+
+	// Read a range from the last cached block.
+	ASSERT_EQ(0, reader->seek(ROMFS_OFFSET + pos + size - 0x10));
+	uint8_t tmp[0x10];
+	ASSERT_EQ(sizeof(tmp), reader->read(tmp, sizeof(tmp)));
+	EXPECT_EQ(0, memcmp(&romfs_plain[pos + size - 0x10], tmp, sizeof(tmp)));
+
+	const NCCHReader::DecryptStats stats = reader->decryptStats();
+	EXPECT_EQ(2U, stats.cacheMisses);
+	EXPECT_EQ(1U, stats.cacheHits);
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: NCCHReader tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,238 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * StfsReaderTest.cpp: Microsoft Xbox 360 STFS file reader test.           *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpbase, librpfile
+#include "librpcpu/byteswap.h"
+#include "librpfile/RpMemFile.hpp"
+using LibRpFile::RpMemFile;
+
+// libromdata
+#include "disc/StfsReader.hpp"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class StfsReaderTest : public ::testing::Test
+{
+	protected:
+		StfsReaderTest()
+			: tableStep(1)
+		{
+			memset(&metadata, 0, sizeof(metadata));
+			// Data area starts at 0xA000.
+			metadata.header_size = cpu_to_be32(0x971A);
+		}
+
+	public:
+		// Offset of physical block 0.
+		static const uint32_t DATA_OFFSET = 0xA000;
+
+		STFS_Package_Metadata metadata;
+		int tableStep;
+		vector<uint8_t> image;
+
+		/**
+		 * Convert a data block number to a physical block number.
+		 * @param dataBlock Data block number.
+		 * @return Physical block number.
+		 */
+		int32_t phys(int32_t dataBlock) const
+		{
+			int32_t ret = dataBlock + (((dataBlock + 0xAA) / 0xAA) * tableStep);
+			if (dataBlock >= 0xAA) {
+				ret += ((dataBlock + 0x70E4) / 0x70E4) * tableStep;
+			}
+			return ret;
+		}
+
+		/**
+		 * Get a pointer to a physical block in the image.
+		 * @param physBlock Physical block number.
+		 * @return Pointer to the block.
+		 */
+		uint8_t *block(int32_t physBlock)
+		{
+			return &image[DATA_OFFSET + (physBlock * STFS_BLOCK_SIZE)];
+		}
+
+		/**
+		 * Create an image with the specified number of data blocks.
+		 * Each data block is filled with its data block number.
+		 * @param blockCount Number of data blocks.
+		 */
+		void createImage(int32_t blockCount)
+		{
+			metadata.stfs_desc.total_alloc_block_count = cpu_to_be32(blockCount);
+			image.assign(DATA_OFFSET + ((phys(blockCount - 1) + 1) * STFS_BLOCK_SIZE), 0);
+			for (int32_t i = 0; i < blockCount; i++) {
+				uint8_t *const p = block(phys(i));
+				memset(p, i & 0xFF, STFS_BLOCK_SIZE);
+				const uint32_t be = cpu_to_be32(i);
+				memcpy(p, &be, sizeof(be));
+			}
+		}
+
+		/**
+		 * Set the next block in a level 0 hash table.
+		 * @param l0Block Physical block number of the level 0 table.
+		 * @param dataBlock Data block number.
+		 * @param nextBlock Next data block number.
+		 */
+		void setNext(int32_t l0Block, int32_t dataBlock, int32_t nextBlock)
+		{
+			STFS_Hash_Table *const table = reinterpret_cast<STFS_Hash_Table*>(block(l0Block));
+			STFS_Hash_Entry *const entry = &table->entries[dataBlock % STFS_HASH_ENTRIES_PER_BLOCK];
+			entry->next_block[0] = (nextBlock >> 16) & 0xFF;
+			entry->next_block[1] = (nextBlock >>  8) & 0xFF;
+			entry->next_block[2] =  nextBlock & 0xFF;
+		}
+
+		/**
+		 * Check that a buffer contains the specified data blocks.
+		 * @param buf Buffer.
+		 * @param blocks Data block numbers.
+		 */
+		static void checkBlocks(const uint8_t *buf, const vector<int32_t> &blocks)
+		{
+			for (size_t i = 0; i < blocks.size(); i++) {
+				const uint8_t *const p = &buf[i * STFS_BLOCK_SIZE];
+				uint32_t be;
+				memcpy(&be, p, sizeof(be));
+				EXPECT_EQ(static_cast<uint32_t>(blocks[i]), be32_to_cpu(be)) << "file block " << i;
+				EXPECT_EQ(static_cast<uint8_t>(blocks[i] & 0xFF), p[STFS_BLOCK_SIZE - 1]) << "file block " << i;
+			}
+		}
+};
+
+/**
+ * Consecutive blocks crossing the level 0 and level 1 hash tables.
+ */
+TEST_F(StfsReaderTest, consecutiveTest)
+{
+	createImage(0x180);
+	RpMemFile *const memFile = new RpMemFile(image.data(), image.size());
+
+	// 0xA0 to 0xBF. Hash tables are inserted between 0xA9 and 0xAA.
+	const off64_t length = (0x20 * STFS_BLOCK_SIZE) - 100;
+	StfsReader *const reader = new StfsReader(memFile, &metadata, false, 0xA0, 0x20, length, true);
+	ASSERT_TRUE(reader->isOpen());
+	EXPECT_EQ(length, reader->size());
+	EXPECT_EQ(0x20 * STFS_BLOCK_SIZE, reader->partition_size());
+
+	vector<uint8_t> buf(0x20 * STFS_BLOCK_SIZE);
+	EXPECT_EQ(static_cast<size_t>(length), reader->read(buf.data(), buf.size()));
+	vector<int32_t> expected;
+	for (int32_t i = 0; i < 0x1F; i++) {
+		expected.push_back(0xA0 + i);
+	}
+	checkBlocks(buf.data(), expected);
+
+	// Unaligned read across the hash table gap.
+	const off64_t pos = (9 * STFS_BLOCK_SIZE) + 0x800;
+	ASSERT_EQ(0, reader->seek(pos));
+	uint8_t tmp[STFS_BLOCK_SIZE];
+	EXPECT_EQ(sizeof(tmp), reader->read(tmp, sizeof(tmp)));
+	EXPECT_EQ(0, memcmp(tmp, &buf[pos], sizeof(tmp)));
+	EXPECT_EQ(pos + static_cast<off64_t>(sizeof(tmp)), reader->tell());
+
+	reader->unref();
+	memFile->unref();
+}
+
+/**
+ * Non-consecutive blocks using the level 0 hash table chain.
+ */
+TEST_F(StfsReaderTest, chainTest)
+{
+	createImage(0x100);
+
+	// Chain: 5 -> 2 -> 0xB0 -> 3
+	setNext(0, 5, 2);
+	setNext(0, 2, 0xB0);
+	setNext(phys(0xAA) - tableStep, 0xB0, 3);
+
+	RpMemFile *const memFile = new RpMemFile(image.data(), image.size());
+	StfsReader *const reader = new StfsReader(memFile, &metadata, false,
+		5, 4, 4 * STFS_BLOCK_SIZE, false);
+	ASSERT_TRUE(reader->isOpen());
+
+	uint8_t buf[4 * STFS_BLOCK_SIZE];
+	EXPECT_EQ(sizeof(buf), reader->read(buf, sizeof(buf)));
+	checkBlocks(buf, {5, 2, 0xB0, 3});
+
+	reader->unref();
+	memFile->unref();
+}
+
+/**
+ * CON package with two copies of each hash table.
+ * The second copy is active.
+ */
+TEST_F(StfsReaderTest, conAltTableTest)
+{
+	tableStep = 2;
+	metadata.stfs_desc.block_separation = 2;	// Top table uses the second copy.
+	createImage(0x40);
+
+	// First copy: 1 -> 2 (stale)
+	// Second copy: 1 -> 0x20
+	setNext(0, 1, 2);
+	setNext(1, 1, 0x20);
+
+	RpMemFile *const memFile = new RpMemFile(image.data(), image.size());
+	StfsReader *const reader = new StfsReader(memFile, &metadata, true,
+		1, 2, 2 * STFS_BLOCK_SIZE, false);
+	ASSERT_TRUE(reader->isOpen());
+
+	uint8_t buf[2 * STFS_BLOCK_SIZE];
+	EXPECT_EQ(sizeof(buf), reader->read(buf, sizeof(buf)));
+	checkBlocks(buf, {1, 0x20});
+
+	reader->unref();
+	memFile->unref();
+}
+
+/**
+ * A file length larger than its blocks is rejected.
+ */
+TEST_F(StfsReaderTest, invalidLengthTest)
+{
+	createImage(0x10);
+	RpMemFile *const memFile = new RpMemFile(image.data(), image.size());
+	StfsReader *const reader = new StfsReader(memFile, &metadata, false,
+		0, 1, STFS_BLOCK_SIZE + 1, true);
+	EXPECT_FALSE(reader->isOpen());
+	reader->unref();
+	memFile->unref();
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: StfsReader tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,161 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * WbfsReaderTest.cpp: WBFS disc image reader test.                        *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpbase, librpfile
+#include "librpcpu/byteswap.h"
+#include "librpfile/RpMemFile.hpp"
+using LibRpFile::RpMemFile;
+
+// libromdata
+#include "disc/WbfsReader.hpp"
+#include "disc/libwbfs.h"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class WbfsReaderTest : public ::testing::Test
+{
+	protected:
+		WbfsReaderTest()
+			: reader(nullptr)
+		{ }
+
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		// 1 MiB WBFS blocks.
+		static const unsigned int WBFS_SEC_SZ_S = 20;
+		static const unsigned int WBFS_SEC_SZ = (1U << WBFS_SEC_SZ_S);
+
+		// Logical block -> physical block. (0 == empty)
+		static const uint16_t wlba[7];
+
+		vector<uint8_t> image;
+		WbfsReader *reader;
+
+		/**
+		 * Get the expected contents of a logical block.
+		 * @param blockIdx Logical block index.
+		 * @param buf Output buffer. (WBFS_SEC_SZ bytes)
+		 */
+		static void expectedBlock(unsigned int blockIdx, uint8_t *buf)
+		{
+			const uint16_t phys = wlba[blockIdx];
+			memset(buf, (phys != 0 ? (0x40 + phys) : 0), WBFS_SEC_SZ);
+		}
+};
+
+// 0-1: Contiguous; 2: Empty; 3: Single block; 4-5: Contiguous; 6: Single block
+const uint16_t WbfsReaderTest::wlba[7] = {2, 3, 0, 4, 7, 8, 5};
+
+void WbfsReaderTest::SetUp(void)
+{
+	image.assign(9 * WBFS_SEC_SZ, 0);
+
+	// WBFS header.
+	wbfs_head_t *const head = reinterpret_cast<wbfs_head_t*>(image.data());
+	head->magic = cpu_to_be32(WBFS_MAGIC);
+	head->n_hd_sec = cpu_to_be32(0x100000);	// 512 MiB
+	head->hd_sec_sz_s = 9;
+	head->wbfs_sec_sz_s = WBFS_SEC_SZ_S;
+	image[sizeof(wbfs_head_t)] = 1;		// disc_table[0]
+
+	// Disc info for disc 0.
+	wbfs_disc_info_t *const info = reinterpret_cast<wbfs_disc_info_t*>(&image[512]);
+	for (unsigned int i = 0; i < ARRAY_SIZE(wlba); i++) {
+		info->wlba_table[i] = cpu_to_be16(wlba[i]);
+		if (wlba[i] != 0) {
+			memset(&image[wlba[i] * WBFS_SEC_SZ], 0x40 + wlba[i], WBFS_SEC_SZ);
+		}
+	}
+
+	RpMemFile *const memFile = new RpMemFile(image.data(), image.size());
+	reader = new WbfsReader(memFile);
+	memFile->unref();
+}
+
+void WbfsReaderTest::TearDown(void)
+{
+	UNREF_AND_NULL(reader);
+}
+
+/**
+ * Read the entire disc in one call.
+ */
+TEST_F(WbfsReaderTest, readAllTest)
+{
+	ASSERT_TRUE(reader->isOpen());
+	EXPECT_EQ(static_cast<off64_t>(ARRAY_SIZE(wlba)) * WBFS_SEC_SZ, reader->size());
+
+	vector<uint8_t> buf(ARRAY_SIZE(wlba) * WBFS_SEC_SZ);
+	EXPECT_EQ(buf.size(), reader->read(buf.data(), buf.size()));
+
+	vector<uint8_t> expected(WBFS_SEC_SZ);
+	for (unsigned int i = 0; i < ARRAY_SIZE(wlba); i++) {
+		expectedBlock(i, expected.data());
+		EXPECT_EQ(0, memcmp(&buf[i * WBFS_SEC_SZ], expected.data(), WBFS_SEC_SZ)) << "block " << i;
+	}
+}
+
+/**
+ * Unaligned read spanning an empty block.
+ */
+TEST_F(WbfsReaderTest, unalignedReadTest)
+{
+	ASSERT_TRUE(reader->isOpen());
+
+	const off64_t pos = WBFS_SEC_SZ + 0x1234;
+	const size_t size = (3 * WBFS_SEC_SZ) - 0x100;
+	ASSERT_EQ(0, reader->seek(pos));
+	vector<uint8_t> buf(size);
+	EXPECT_EQ(size, reader->read(buf.data(), size));
+
+	vector<uint8_t> expected(WBFS_SEC_SZ);
+	for (size_t i = 0; i < size; i += 0x1000) {
+		const off64_t cur = pos + i;
+		const unsigned int blockIdx = static_cast<unsigned int>(cur / WBFS_SEC_SZ);
+		expectedBlock(blockIdx, expected.data());
+		EXPECT_EQ(expected[0], buf[i]) << "offset " << cur;
+	}
+}
+
+/**
+ * Used size excludes empty blocks.
+ */
+TEST_F(WbfsReaderTest, sizeUsedTest)
+{
+	ASSERT_TRUE(reader->isOpen());
+	EXPECT_EQ(static_cast<off64_t>(ARRAY_SIZE(wlba) - 1) * WBFS_SEC_SZ, reader->partition_size_used());
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: WbfsReader tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,535 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * XDVDFSPartitionTest.cpp: Microsoft Xbox XDVDFS partition reader test.   *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpbase, librpfile
+#include "librpbase/TextFuncs.hpp"
+#include "librpcpu/byteswap.h"
+#include "librpfile/RpMemFile.hpp"
+using namespace LibRpBase;
+using LibRpFile::IRpFile;
+using LibRpFile::RpMemFile;
+
+// libromdata
+#include "disc/XDVDFSPartition.hpp"
+#include "disc/xdvdfs_structs.h"
+using LibRomData::XDVDFSPartition;
+
+#include "CountingDiscReader.hpp"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <algorithm>
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+/**
+ * Synthetic file or directory for buildImage().
+ */
+struct XdvdfsTestNode {
+	string name;
+	string path;				// Full path, with a leading slash
+	bool isDir;
+	vector<XdvdfsTestNode> children;	// Sorted by name
+	uint32_t sector;			// Starting sector
+	uint32_t size;				// Size, in bytes
+
+	XdvdfsTestNode(const string &name, bool isDir)
+		: name(name), isDir(isDir), sector(0), size(0) { }
+};
+
+class XDVDFSPartitionTest : public ::testing::Test
+{
+	protected:
+		XDVDFSPartitionTest()
+			: root("", true)
+			, discReader(nullptr)
+			, xdvdfsPartition(nullptr)
+		{ }
+
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		// Number of files in /media.
+		static const unsigned int MEDIA_FILE_COUNT = 2000;
+
+		/**
+		 * Compare two filenames using XDVDFS rules.
+		 * @param a Filename A
+		 * @param b Filename B
+		 * @return True if a < b.
+		 */
+		static bool xdvdfsLess(const string &a, const string &b);
+
+		/**
+		 * Build a directory table as a balanced binary tree.
+		 * @param children Directory entries, sorted by name.
+		 * @return Directory table.
+		 */
+		static vector<uint8_t> buildDirTable(const vector<XdvdfsTestNode> &children);
+
+		/**
+		 * Build a synthetic XDVDFS image.
+		 * File contents are the file's full path.
+		 * @param root		[out] Root directory.
+		 * @return XDVDFS image.
+		 */
+		static vector<uint8_t> buildImage(XdvdfsTestNode &root);
+
+		/**
+		 * Find a node in the synthetic directory tree.
+		 * @param path Path, with a leading slash.
+		 * @return Node, or nullptr if not found.
+		 */
+		const XdvdfsTestNode *findNode(const char *path) const;
+
+		/**
+		 * Open an XDVDFSPartition from an XDVDFS image.
+		 * @param img XDVDFS image.
+		 */
+		void openImage(const vector<uint8_t> &img);
+
+		/**
+		 * Open and read a file from the XDVDFSPartition.
+		 * @param filename Filename.
+		 * @return File contents, or an empty string on error.
+		 */
+		string readFile(const char *filename);
+
+	public:
+		vector<uint8_t> img_data;
+		XdvdfsTestNode root;
+		vector<string> filenames;
+
+		CountingDiscReader *discReader;
+		XDVDFSPartition *xdvdfsPartition;
+};
+
+const unsigned int XDVDFSPartitionTest::MEDIA_FILE_COUNT;
+
+/**
+ * Compare two filenames using XDVDFS rules.
+ * @param a Filename A
+ * @param b Filename B
+ * @return True if a < b.
+ */
+bool XDVDFSPartitionTest::xdvdfsLess(const string &a, const string &b)
+{
+	string ua(a), ub(b);
+	std::transform(ua.begin(), ua.end(), ua.begin(), ::toupper);
+	std::transform(ub.begin(), ub.end(), ub.begin(), ::toupper);
+	return ua < ub;
+}
+
+/**
+ * Write a subtree of a directory table.
+ * @param buf		[in/out] Directory table.
+ * @param children	[in] Directory entries, sorted by name.
+ * @param lo		[in] First entry index.
+ * @param hi		[in] Last entry index, plus one.
+ * @return Offset of the subtree's root node, in DWORDs.
+ */
+static uint16_t writeSubtree(vector<uint8_t> &buf, const vector<XdvdfsTestNode> &children, size_t lo, size_t hi)
+{
+	if (lo >= hi) {
+		// Empty subtree.
+		return 0;
+	}
+
+	// Entries can't cross sector boundaries.
+	const size_t mid = lo + (hi - lo) / 2;
+	const XdvdfsTestNode &child = children[mid];
+	const size_t entry_size = (sizeof(XDVDFS_DirEntry) + child.name.size() + 3) & ~3;
+	if ((buf.size() % XDVDFS_BLOCK_SIZE) + entry_size > XDVDFS_BLOCK_SIZE) {
+		buf.resize((buf.size() + XDVDFS_BLOCK_SIZE - 1) & ~(XDVDFS_BLOCK_SIZE - 1), 0xFF);
+	}
+
+	// Pre-order layout: This node, then the left and right subtrees.
+	const size_t pos = buf.size();
+	buf.resize(pos + entry_size, 0xFF);
+	XDVDFS_DirEntry dirEntry;
+	dirEntry.start_sector = cpu_to_le32(child.sector);
+	dirEntry.file_size = cpu_to_le32(child.size);
+	dirEntry.attributes = (child.isDir ? XDVDFS_ATTR_DIRECTORY : XDVDFS_ATTR_NORMAL);
+	dirEntry.name_length = static_cast<uint8_t>(child.name.size());
+	memcpy(&buf[pos + sizeof(dirEntry)], child.name.data(), child.name.size());
+
+	dirEntry.left_offset = cpu_to_le16(writeSubtree(buf, children, lo, mid));
+	dirEntry.right_offset = cpu_to_le16(writeSubtree(buf, children, mid + 1, hi));
+	memcpy(&buf[pos], &dirEntry, sizeof(dirEntry));
+	return static_cast<uint16_t>(pos / sizeof(uint32_t));
+}
+
+/**
+ * Build a directory table as a balanced binary tree.
+ * @param children Directory entries, sorted by name.
+ * @return Directory table.
+ */
+vector<uint8_t> XDVDFSPartitionTest::buildDirTable(const vector<XdvdfsTestNode> &children)
+{
+	vector<uint8_t> buf;
+	writeSubtree(buf, children, 0, children.size());
+	buf.resize((buf.size() + XDVDFS_BLOCK_SIZE - 1) & ~(XDVDFS_BLOCK_SIZE - 1), 0xFF);
+	return buf;
+}
+
+/**
+ * Assign sectors to all directories in a tree.
+ * @param node		[in/out] Directory.
+ * @param sector	[in/out] Next free sector.
+ */
+static void assignDirSectors(XdvdfsTestNode &node, uint32_t &sector)
+{
+	node.size = static_cast<uint32_t>(XDVDFSPartitionTest::buildDirTable(node.children).size());
+	node.sector = (node.size > 0 ? sector : 0);
+	sector += node.size / XDVDFS_BLOCK_SIZE;
+	for (auto iter = node.children.begin(); iter != node.children.end(); ++iter) {
+		if (iter->isDir) {
+			assignDirSectors(*iter, sector);
+		}
+	}
+}
+
+/**
+ * Assign sectors to all files in a tree.
+ * @param node		[in/out] Directory.
+ * @param sector	[in/out] Next free sector.
+ */
+static void assignFileSectors(XdvdfsTestNode &node, uint32_t &sector)
+{
+	for (auto iter = node.children.begin(); iter != node.children.end(); ++iter) {
+		if (iter->isDir) {
+			assignFileSectors(*iter, sector);
+		} else {
+			iter->sector = sector++;
+			iter->size = static_cast<uint32_t>(iter->path.size());
+		}
+	}
+}
+
+/**
+ * Write all directory tables and files in a tree.
+ * @param img	[in/out] XDVDFS image.
+ * @param node	[in] Directory.
+ */
+static void writeTree(vector<uint8_t> &img, const XdvdfsTestNode &node)
+{
+	const vector<uint8_t> table = XDVDFSPartitionTest::buildDirTable(node.children);
+	if (!table.empty()) {
+		memcpy(&img[node.sector * XDVDFS_BLOCK_SIZE], table.data(), table.size());
+	}
+
+	for (auto iter = node.children.cbegin(); iter != node.children.cend(); ++iter) {
+		if (iter->isDir) {
+			writeTree(img, *iter);
+		} else {
+			memcpy(&img[iter->sector * XDVDFS_BLOCK_SIZE], iter->path.data(), iter->path.size());
+		}
+	}
+}
+
+/**
+ * Build a synthetic XDVDFS image.
+ * File contents are the file's full path.
+ * @param root		[out] Root directory.
+ * @return XDVDFS image.
+ */
+vector<uint8_t> XDVDFSPartitionTest::buildImage(XdvdfsTestNode &root)
+{
+	// Directory tree:
+	// - /default.xex
+	// - /DATA/SUB/deep.bin
+	// - /EMPTY/
+	// - /media/file0000.bin - /media/file1999.bin
+	root = XdvdfsTestNode("", true);
+	root.path = "";
+	root.children.emplace_back("default.xex", false);
+	root.children.emplace_back("DATA", true);
+	root.children.back().children.emplace_back("SUB", true);
+	root.children.back().children.back().children.emplace_back("deep.bin", false);
+	root.children.emplace_back("EMPTY", true);
+	root.children.emplace_back("media", true);
+	for (unsigned int i = 0; i < MEDIA_FILE_COUNT; i++) {
+		root.children.back().children.emplace_back(rp_sprintf("file%04u.bin", i), false);
+	}
+
+	// Sort all directories and set the paths.
+	struct {
+		void operator()(XdvdfsTestNode &node) {
+			std::sort(node.children.begin(), node.children.end(),
+				[](const XdvdfsTestNode &a, const XdvdfsTestNode &b) {
+					return xdvdfsLess(a.name, b.name);
+				});
+			for (auto iter = node.children.begin(); iter != node.children.end(); ++iter) {
+				iter->path = node.path + '/' + iter->name;
+				if (iter->isDir) {
+					(*this)(*iter);
+				}
+			}
+		}
+	} sortTree;
+	sortTree(root);
+
+	// Assign sectors.
+	uint32_t sector = XDVDFS_HEADER_LBA_OFFSET + 1;
+	assignDirSectors(root, sector);
+	assignFileSectors(root, sector);
+
+	vector<uint8_t> img(sector * XDVDFS_BLOCK_SIZE);
+	writeTree(img, root);
+
+	// Write the XDVDFS header.
+	XDVDFS_Header *const header = reinterpret_cast<XDVDFS_Header*>(&img[XDVDFS_HEADER_LBA_OFFSET * XDVDFS_BLOCK_SIZE]);
+	memcpy(header->magic, XDVDFS_MAGIC, sizeof(header->magic));
+	header->root_dir_sector = cpu_to_le32(root.sector);
+	header->root_dir_size = cpu_to_le32(root.size);
+	memcpy(header->magic_footer, XDVDFS_MAGIC, sizeof(header->magic_footer));
+
+	return img;
+}
+
+/**
+ * Find a node in the synthetic directory tree.
+ * @param path Path, with a leading slash.
+ * @return Node, or nullptr if not found.
+ */
+const XdvdfsTestNode *XDVDFSPartitionTest::findNode(const char *path) const
+{
+	const XdvdfsTestNode *node = &root;
+	while (*path == '/') {
+		path++;
+		const char *const sl = strchr(path, '/');
+		const string name(path, (sl ? sl - path : strlen(path)));
+		const XdvdfsTestNode *next = nullptr;
+		for (auto iter = node->children.cbegin(); iter != node->children.cend(); ++iter) {
+			if (iter->name == name) {
+				next = &(*iter);
+				break;
+			}
+		}
+		if (!next) {
+			return nullptr;
+		}
+		node = next;
+		path += name.size();
+	}
+	return node;
+}
+
+/**
+ * Open an XDVDFSPartition from an XDVDFS image.
+ * @param img XDVDFS image.
+ */
+void XDVDFSPartitionTest::openImage(const vector<uint8_t> &img)
+{
+	TearDown();
+
+	RpMemFile *const memFile = new RpMemFile(img.data(), img.size());
+	discReader = new CountingDiscReader(memFile);
+	memFile->unref();
+	ASSERT_TRUE(discReader->isOpen());
+
+	xdvdfsPartition = new XDVDFSPartition(discReader, 0, static_cast<off64_t>(img.size()));
+	ASSERT_TRUE(xdvdfsPartition->isOpen());
+}
+
+/**
+ * Open and read a file from the XDVDFSPartition.
+ * @param filename Filename.
+ * @return File contents, or an empty string on error.
+ */
+string XDVDFSPartitionTest::readFile(const char *filename)
+{
+	IRpFile *const file = xdvdfsPartition->open(filename);
+	if (!file) {
+		return string();
+	}
+
+	string s_data;
+	s_data.resize(static_cast<size_t>(file->size()));
+	size_t size = file->read(&s_data[0], s_data.size());
+	file->unref();
+	if (size != s_data.size()) {
+		return string();
+	}
+	return s_data;
+}
+
+void XDVDFSPartitionTest::SetUp(void)
+{
+	img_data = buildImage(root);
+	openImage(img_data);
+}
+
+void XDVDFSPartitionTest::TearDown(void)
+{
+	UNREF_AND_NULL(xdvdfsPartition);
+	UNREF_AND_NULL(discReader);
+}
+
+/**
+ * Open files in the root directory and in subdirectories.
+ */
+TEST_F(XDVDFSPartitionTest, openFilesTest)
+{
+	EXPECT_EQ("/default.xex", readFile("/default.xex"));
+	EXPECT_EQ("/DATA/SUB/deep.bin", readFile("/DATA/SUB/deep.bin"));
+	const XdvdfsTestNode *const media = findNode("/media");
+	ASSERT_TRUE(media != nullptr);
+	ASSERT_EQ(MEDIA_FILE_COUNT, media->children.size());
+	for (auto iter = media->children.cbegin(); iter != media->children.cend(); ++iter) {
+		EXPECT_EQ(iter->path, readFile(iter->path.c_str()));
+	}
+}
+
+/**
+ * Lookups are case-insensitive, and accept backslashes,
+ * relative paths, and duplicate slashes.
+ */
+TEST_F(XDVDFSPartitionTest, pathVariantsTest)
+{
+	EXPECT_EQ("/default.xex", readFile("/DEFAULT.XEX"));
+	EXPECT_EQ("/default.xex", readFile("default.xex"));
+	EXPECT_EQ("/DATA/SUB/deep.bin", readFile("/data/sub/DEEP.BIN"));
+	EXPECT_EQ("/DATA/SUB/deep.bin", readFile("\\DATA\\SUB\\deep.bin"));
+	EXPECT_EQ("/media/file1234.bin", readFile("//media//file1234.bin"));
+}
+
+/**
+ * Error handling.
+ */
+TEST_F(XDVDFSPartitionTest, errorsTest)
+{
+	EXPECT_TRUE(xdvdfsPartition->open("/default.xbe") == nullptr);
+	EXPECT_EQ(ENOENT, xdvdfsPartition->lastError());
+	EXPECT_TRUE(xdvdfsPartition->open("/media/file2000.bin") == nullptr);
+	EXPECT_EQ(ENOENT, xdvdfsPartition->lastError());
+	EXPECT_TRUE(xdvdfsPartition->open("/EMPTY/file.bin") == nullptr);
+	EXPECT_EQ(ENOENT, xdvdfsPartition->lastError());
+	EXPECT_TRUE(xdvdfsPartition->open("/media") == nullptr);
+	EXPECT_EQ(EISDIR, xdvdfsPartition->lastError());
+	EXPECT_TRUE(xdvdfsPartition->open("/default.xex/file.bin") == nullptr);
+	EXPECT_EQ(ENOTDIR, xdvdfsPartition->lastError());
+	EXPECT_TRUE(xdvdfsPartition->open("") == nullptr);
+	EXPECT_EQ(EINVAL, xdvdfsPartition->lastError());
+
+	EXPECT_TRUE(xdvdfsPartition->opendir("/default.xex") == nullptr);
+	EXPECT_EQ(ENOTDIR, xdvdfsPartition->lastError());
+	EXPECT_TRUE(xdvdfsPartition->opendir("/nonexistent") == nullptr);
+	EXPECT_EQ(ENOENT, xdvdfsPartition->lastError());
+}
+
+/**
+ * List directories. Entries are returned in sorted order.
+ */
+TEST_F(XDVDFSPartitionTest, readdirTest)
+{
+	static const char *const dirs[] = {"/", "/DATA", "/DATA/SUB", "/EMPTY", "/media"};
+	for (size_t i = 0; i < ARRAY_SIZE(dirs); i++) {
+		const XdvdfsTestNode *const node = findNode(dirs[i][1] ? dirs[i] : "");
+		ASSERT_TRUE(node != nullptr) << dirs[i];
+
+		IFst::Dir *const dirp = xdvdfsPartition->opendir(dirs[i]);
+		ASSERT_TRUE(dirp != nullptr) << dirs[i];
+
+		auto iter = node->children.cbegin();
+		const IFst::DirEnt *dirent;
+		while ((dirent = xdvdfsPartition->readdir(dirp)) != nullptr) {
+			ASSERT_TRUE(iter != node->children.cend()) << dirs[i] << ": too many entries";
+			EXPECT_STREQ(iter->name.c_str(), dirent->name);
+			EXPECT_EQ(iter->isDir ? DT_DIR : DT_REG, dirent->type);
+			EXPECT_EQ(static_cast<off64_t>(iter->sector) * XDVDFS_BLOCK_SIZE, dirent->offset);
+			EXPECT_EQ(static_cast<off64_t>(iter->size), dirent->size);
+			++iter;
+		}
+		EXPECT_TRUE(iter == node->children.cend()) << dirs[i] << ": not enough entries";
+		EXPECT_EQ(0, xdvdfsPartition->closedir(dirp));
+	}
+}
+
+/**
+ * A lookup should only read the directory sectors
+ * containing the nodes that it visits.
+ */
+TEST_F(XDVDFSPartitionTest, lookupReadsTest)
+{
+	const XdvdfsTestNode *const media = findNode("/media");
+	ASSERT_TRUE(media != nullptr);
+	ASSERT_GT(media->size, 16U * XDVDFS_BLOCK_SIZE);
+
+	discReader->seekCount = 0;
+	discReader->bytesRead = 0;
+	IRpFile *const file = xdvdfsPartition->open("/media/file1234.bin");
+	ASSERT_TRUE(file != nullptr);
+	file->unref();
+
+	// Tree depth is log2(2000) + 1 == 11.
+	EXPECT_LE(discReader->seekCount, 11U);
+	EXPECT_LE(discReader->bytesRead, 11U * XDVDFS_BLOCK_SIZE);
+	EXPECT_LT(discReader->bytesRead, static_cast<size_t>(media->size));
+}
+
+/**
+ * A corrupted directory with a loop must not hang.
+ */
+TEST_F(XDVDFSPartitionTest, corruptedTreeTest)
+{
+	// Make the left child of the /media root node point to itself.
+	const XdvdfsTestNode *const media = findNode("/media");
+	ASSERT_TRUE(media != nullptr);
+	uint8_t *const table = &img_data[media->sector * XDVDFS_BLOCK_SIZE];
+	XDVDFS_DirEntry *const rootEntry = reinterpret_cast<XDVDFS_DirEntry*>(table);
+	const uint16_t left = le16_to_cpu(rootEntry->left_offset);
+	ASSERT_NE(0U, left);
+	XDVDFS_DirEntry *const leftEntry = reinterpret_cast<XDVDFS_DirEntry*>(&table[left * sizeof(uint32_t)]);
+	leftEntry->left_offset = cpu_to_le16(left);
+	leftEntry->right_offset = cpu_to_le16(left);
+	openImage(img_data);
+
+	// Lookups in the looped subtree fail.
+	EXPECT_TRUE(xdvdfsPartition->open("/media/file0000.bin") == nullptr);
+
+	// Lookups in the other subtree still work.
+	EXPECT_EQ("/media/file1999.bin", readFile("/media/file1999.bin"));
+
+	// readdir() must terminate.
+	IFst::Dir *const dirp = xdvdfsPartition->opendir("/media");
+	ASSERT_TRUE(dirp != nullptr);
+	unsigned int count = 0;
+	while (xdvdfsPartition->readdir(dirp) != nullptr) {
+		count++;
+	}
+	EXPECT_LT(count, MEDIA_FILE_COUNT);
+	xdvdfsPartition->closedir(dirp);
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: XDVDFSPartition tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
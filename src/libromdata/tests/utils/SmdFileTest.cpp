@@ -0,0 +1,290 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * SmdFileTest.cpp: SmdFile class test.                                    *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpfile
+#include "librpfile/RpMemFile.hpp"
+using LibRpFile::RpMemFile;
+
+// librpbase
+#include "librpbase/crypto/StreamHasher.hpp"
+using LibRpBase::Hash;
+using LibRpBase::StreamHasher;
+
+// libromdata
+#include "utils/SmdFile.hpp"
+#include "utils/SuperMagicDrive.hpp"
+#include "Console/MegaDrive.hpp"
+using LibRomData::MegaDrive;
+using LibRomData::SmdFile;
+using LibRomData::SuperMagicDrive;
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <algorithm>
+#include <vector>
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class SmdFileTest : public ::testing::Test
+{
+	protected:
+		SmdFileTest()
+			: smdFile(nullptr)
+		{ }
+
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		// Number of SMD blocks in the test image.
+		static const unsigned int BLOCK_COUNT = 24;
+
+		// Number of SMD blocks in the benchmark image. (4 MiB)
+		static const unsigned int BENCHMARK_BLOCK_COUNT = 256;
+
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 100;
+
+		/**
+		 * Build a synthetic SMD image.
+		 * The SMD image has a 512-byte header and a few bytes
+		 * of trailing garbage that must be ignored.
+		 * @param blockCount	[in] Number of 16 KB blocks.
+		 * @param bin_data	[out] Expected binary ROM data.
+		 * @return SMD image.
+		 */
+		static vector<uint8_t> buildImage(unsigned int blockCount, vector<uint8_t> &bin_data);
+
+	public:
+		vector<uint8_t> image;
+		vector<uint8_t> bin_data;
+		SmdFile *smdFile;
+};
+
+/**
+ * Build a synthetic SMD image.
+ * The SMD image has a 512-byte header and a few bytes
+ * of trailing garbage that must be ignored.
+ * @param blockCount	[in] Number of 16 KB blocks.
+ * @param bin_data	[out] Expected binary ROM data.
+ * @return SMD image.
+ */
+vector<uint8_t> SmdFileTest::buildImage(unsigned int blockCount, vector<uint8_t> &bin_data)
+{
+	static const unsigned int BLOCK_SIZE = SuperMagicDrive::SMD_BLOCK_SIZE;
+	vector<uint8_t> img(512 + (blockCount * BLOCK_SIZE) + 100, 0xEE);
+	bin_data.resize(blockCount * BLOCK_SIZE);
+
+	uint32_t seed = 0x12345678;
+	for (auto iter = bin_data.begin(); iter != bin_data.end(); ++iter) {
+		seed = seed * 1103515245 + 12345;
+		*iter = static_cast<uint8_t>(seed >> 16);
+	}
+
+	// Interleave the data.
+	// First 8 KB of each block is ODD bytes;
+	// second 8 KB of each block is EVEN bytes.
+	for (unsigned int i = 0; i < blockCount; i++) {
+		const uint8_t *const src = &bin_data[i * BLOCK_SIZE];
+		uint8_t *const dest = &img[512 + (i * BLOCK_SIZE)];
+		for (unsigned int j = 0; j < BLOCK_SIZE / 2; j++) {
+			dest[j] = src[(j * 2) + 1];
+			dest[(BLOCK_SIZE / 2) + j] = src[j * 2];
+		}
+	}
+
+	return img;
+}
+
+void SmdFileTest::SetUp(void)
+{
+	image = buildImage(BLOCK_COUNT, bin_data);
+
+	RpMemFile *const memFile = new RpMemFile(image.data(), image.size());
+	smdFile = new SmdFile(memFile);
+	memFile->unref();
+	ASSERT_TRUE(smdFile->isOpen());
+	ASSERT_EQ(static_cast<off64_t>(bin_data.size()), smdFile->size());
+}
+
+void SmdFileTest::TearDown(void)
+{
+	UNREF_AND_NULL(smdFile);
+}
+
+/**
+ * Read the entire ROM with a single read.
+ */
+TEST_F(SmdFileTest, readAllTest)
+{
+	// NOTE: vector<> data is usually 16-byte aligned,
+	// so this should use the direct decoding path.
+	vector<uint8_t> buf(bin_data.size() + 4096);
+	smdFile->rewind();
+	ASSERT_EQ(bin_data.size(), smdFile->read(buf.data(), buf.size()));
+	EXPECT_EQ(0, memcmp(bin_data.data(), buf.data(), bin_data.size()));
+
+	// At the end of the ROM.
+	EXPECT_EQ(0U, smdFile->read(buf.data(), buf.size()));
+
+	// Unaligned output buffer.
+	smdFile->rewind();
+	ASSERT_EQ(bin_data.size(), smdFile->read(&buf[1], bin_data.size()));
+	EXPECT_EQ(0, memcmp(bin_data.data(), &buf[1], bin_data.size()));
+}
+
+/**
+ * Read the ROM using reads of various sizes and alignments.
+ */
+TEST_F(SmdFileTest, unalignedReadTest)
+{
+	vector<uint8_t> buf(80 * 1024);
+	uint32_t seed = 0x87654321;
+	for (unsigned int i = 0; i < 1000; i++) {
+		seed = seed * 1103515245 + 12345;
+		const size_t pos = (seed >> 8) % bin_data.size();
+		seed = seed * 1103515245 + 12345;
+		size_t size = (seed >> 8) % buf.size();
+		if (pos + size > bin_data.size()) {
+			size = bin_data.size() - pos;
+		}
+
+		ASSERT_EQ(0, smdFile->seek(pos));
+		ASSERT_EQ(size, smdFile->read(buf.data(), size)) << "pos: " << pos;
+		EXPECT_EQ(0, memcmp(&bin_data[pos], buf.data(), size)) <<
+			"pos: " << pos << ", size: " << size;
+		EXPECT_EQ(static_cast<off64_t>(pos + size), smdFile->tell());
+	}
+}
+
+/**
+ * Read the ROM sequentially using small reads.
+ */
+TEST_F(SmdFileTest, sequentialReadTest)
+{
+	vector<uint8_t> buf(bin_data.size());
+	smdFile->rewind();
+	size_t pos = 0;
+	for (unsigned int size = 1; pos < buf.size(); size = (size * 3) + 1) {
+		if (size > 40000) {
+			size = 7;
+		}
+		const size_t expected = std::min<size_t>(size, buf.size() - pos);
+		ASSERT_EQ(expected, smdFile->read(&buf[pos], size)) << "pos: " << pos;
+		pos += expected;
+	}
+	EXPECT_EQ(0, memcmp(bin_data.data(), buf.data(), buf.size()));
+}
+
+/**
+ * Invalid SMD images.
+ */
+TEST_F(SmdFileTest, invalidImageTest)
+{
+	// No file.
+	SmdFile *file = new SmdFile(nullptr);
+	EXPECT_FALSE(file->isOpen());
+	EXPECT_EQ(-1, file->size());
+	file->unref();
+
+	// Too small for a single block.
+	RpMemFile *const memFile = new RpMemFile(image.data(), 512 + SuperMagicDrive::SMD_BLOCK_SIZE - 1);
+	file = new SmdFile(memFile);
+	memFile->unref();
+	EXPECT_FALSE(file->isOpen());
+	file->unref();
+
+	// Writing isn't supported.
+	EXPECT_EQ(0U, smdFile->write(bin_data.data(), 16));
+	EXPECT_NE(0, smdFile->truncate(0));
+}
+
+/**
+ * MegaDrive::hashContents() must hash the deinterleaved ROM image.
+ */
+TEST_F(SmdFileTest, megaDriveHashContentsTest)
+{
+	// Add an SMD header so MegaDrive detects the image.
+	vector<uint8_t> smd_image(image);
+	memset(smd_image.data(), 0, 512);
+	smd_image[1] = 3;	// SMD_FDT_68K_PROGRAM
+	smd_image[8] = 0xAA;
+	smd_image[9] = 0xBB;
+	smd_image[10] = 6;	// SMD_FT_SMD_GAME_FILE
+
+	RpMemFile *memFile = new RpMemFile(smd_image.data(), smd_image.size());
+	MegaDrive *const romData = new MegaDrive(memFile);
+	memFile->unref();
+	ASSERT_TRUE(romData->isValid());
+
+	const uint32_t algorithms = (1U << static_cast<int>(Hash::Algorithm::CRC32)) |
+	                            (1U << static_cast<int>(Hash::Algorithm::SHA1));
+	StreamHasher smdHasher(algorithms);
+	EXPECT_EQ(0, romData->hashContents(&smdHasher));
+	romData->unref();
+
+	memFile = new RpMemFile(bin_data.data(), bin_data.size());
+	StreamHasher binHasher(algorithms);
+	EXPECT_EQ(0, binHasher.process(memFile));
+	memFile->unref();
+
+	EXPECT_EQ(static_cast<off64_t>(bin_data.size()), smdHasher.bytesHashed());
+	EXPECT_EQ(binHasher.getHashString(Hash::Algorithm::CRC32),
+		smdHasher.getHashString(Hash::Algorithm::CRC32));
+	EXPECT_EQ(binHasher.getHashString(Hash::Algorithm::SHA1),
+		smdHasher.getHashString(Hash::Algorithm::SHA1));
+}
+
+/**
+ * Benchmark reading an SMD image with SmdFile.
+ */
+TEST_F(SmdFileTest, readAll_benchmark)
+{
+	vector<uint8_t> bm_bin_data;
+	const vector<uint8_t> bm_image = buildImage(BENCHMARK_BLOCK_COUNT, bm_bin_data);
+
+	RpMemFile *const memFile = new RpMemFile(bm_image.data(), bm_image.size());
+	SmdFile *const file = new SmdFile(memFile);
+	memFile->unref();
+	ASSERT_TRUE(file->isOpen());
+
+	// Read the ROM in 64 KB chunks, as a hashing function would.
+	vector<uint8_t> buf(64 * 1024);
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		file->rewind();
+		while (file->read(buf.data(), buf.size()) == buf.size()) { }
+	}
+
+	// Verify the last chunk.
+	EXPECT_EQ(0, memcmp(&bm_bin_data[bm_bin_data.size() - buf.size()], buf.data(), buf.size()));
+	file->unref();
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: SmdFile tests.\n\n");
+	fprintf(stderr, "Benchmark iterations: %u\n", LibRomData::Tests::SmdFileTest::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
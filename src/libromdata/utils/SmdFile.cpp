@@ -0,0 +1,275 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * SmdFile.cpp: IRpFile wrapper for Super Magic Drive interleaved ROMs.    *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "SmdFile.hpp"
+#include "SuperMagicDrive.hpp"
+
+// librpbase
+#include "librpbase/aligned_malloc.h"
+
+// librpfile
+using LibRpFile::IRpFile;
+
+// C++ STL classes.
+using std::string;
+
+namespace LibRomData {
+
+// SMD header size.
+static const unsigned int SMD_HEADER_SIZE = 512;
+
+/**
+ * Open a Super Magic Drive ROM image as a plain binary ROM image.
+ * NOTE: These files are read-only.
+ *
+ * The SMD file must have a 512-byte header, followed by
+ * one or more 16 KB interleaved blocks. Trailing data
+ * that isn't a full block is ignored.
+ *
+ * @param file SMD file.
+ */
+SmdFile::SmdFile(IRpFile *file)
+	: super()
+	, m_file(nullptr)
+	, m_size(0)
+	, m_pos(0)
+	, m_smdBuf(nullptr)
+	, m_binBuf(nullptr)
+	, m_binBlockIdx(-1)
+{
+	if (!file) {
+		m_lastError = EBADF;
+		return;
+	}
+
+	// Make sure there's at least one full SMD block.
+	const off64_t fileSize = file->size();
+	if (fileSize < static_cast<off64_t>(SMD_HEADER_SIZE + SuperMagicDrive::SMD_BLOCK_SIZE)) {
+		m_lastError = EIO;
+		return;
+	}
+
+	m_smdBuf = static_cast<uint8_t*>(aligned_malloc(16, SuperMagicDrive::SMD_BLOCK_SIZE * 2));
+	if (!m_smdBuf) {
+		m_lastError = ENOMEM;
+		return;
+	}
+	m_binBuf = m_smdBuf + SuperMagicDrive::SMD_BLOCK_SIZE;
+
+	m_size = (fileSize - SMD_HEADER_SIZE) & ~(static_cast<off64_t>(SuperMagicDrive::SMD_BLOCK_SIZE) - 1);
+	m_file = file->ref();
+}
+
+SmdFile::~SmdFile()
+{
+	UNREF(m_file);
+	aligned_free(m_smdBuf);
+}
+
+/**
+ * Is the file open?
+ * This usually only returns false if an error occurred.
+ * @return True if the file is open; false if it isn't.
+ */
+bool SmdFile::isOpen(void) const
+{
+	return (m_file != nullptr);
+}
+
+/**
+ * Close the file.
+ */
+void SmdFile::close(void)
+{
+	UNREF_AND_NULL(m_file);
+	m_binBlockIdx = -1;
+}
+
+/**
+ * Read and decode an SMD block.
+ * @param pDest		[out] Destination buffer. (Must be 16 KB, 16-byte aligned.)
+ * @param blockIdx	[in] Block index.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int SmdFile::readBlock(uint8_t *pDest, unsigned int blockIdx)
+{
+	ASSERT_ALIGNMENT(16, pDest);
+
+	const off64_t addr = SMD_HEADER_SIZE +
+		(static_cast<off64_t>(blockIdx) * SuperMagicDrive::SMD_BLOCK_SIZE);
+	m_file->clearError();
+	const size_t size = m_file->seekAndRead(addr, m_smdBuf, SuperMagicDrive::SMD_BLOCK_SIZE);
+	if (size != SuperMagicDrive::SMD_BLOCK_SIZE) {
+		m_lastError = m_file->lastError();
+		if (m_lastError == 0) {
+			m_lastError = EIO;
+		}
+		return -m_lastError;
+	}
+
+	SuperMagicDrive::decodeBlock(pDest, m_smdBuf);
+	return 0;
+}
+
+/**
+ * Read data from the file.
+ * @param ptr Output data buffer.
+ * @param size Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t SmdFile::read(void *ptr, size_t size)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	// Check if size is in bounds.
+	if (m_pos > m_size - static_cast<off64_t>(size)) {
+		// Not enough data.
+		// Copy whatever's left in the file.
+		size = static_cast<size_t>(m_size - m_pos);
+	}
+
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t ret = 0;
+	while (size > 0) {
+		const unsigned int blockIdx = static_cast<unsigned int>(m_pos / SuperMagicDrive::SMD_BLOCK_SIZE);
+		const unsigned int blockPos = static_cast<unsigned int>(m_pos % SuperMagicDrive::SMD_BLOCK_SIZE);
+
+		if (blockPos == 0 && size >= SuperMagicDrive::SMD_BLOCK_SIZE &&
+		    (reinterpret_cast<uintptr_t>(ptr8) % 16) == 0)
+		{
+			// Full block, and the output buffer is aligned.
+			// Decode directly into the output buffer.
+			if (readBlock(ptr8, blockIdx) != 0)
+				break;
+			ptr8 += SuperMagicDrive::SMD_BLOCK_SIZE;
+			size -= SuperMagicDrive::SMD_BLOCK_SIZE;
+			ret += SuperMagicDrive::SMD_BLOCK_SIZE;
+			m_pos += SuperMagicDrive::SMD_BLOCK_SIZE;
+			continue;
+		}
+
+		// Partial block, or the output buffer isn't aligned.
+		// Decode into the block cache.
+		if (m_binBlockIdx != static_cast<int>(blockIdx)) {
+			m_binBlockIdx = -1;
+			if (readBlock(m_binBuf, blockIdx) != 0)
+				break;
+			m_binBlockIdx = static_cast<int>(blockIdx);
+		}
+
+		size_t toCopy = SuperMagicDrive::SMD_BLOCK_SIZE - blockPos;
+		if (toCopy > size) {
+			toCopy = size;
+		}
+		memcpy(ptr8, &m_binBuf[blockPos], toCopy);
+		ptr8 += toCopy;
+		size -= toCopy;
+		ret += toCopy;
+		m_pos += toCopy;
+	}
+
+	return ret;
+}
+
+/**
+ * Write data to the file.
+ * (NOTE: Not valid for SmdFile; this will always return 0.)
+ * @param ptr Input data buffer.
+ * @param size Amount of data to read, in bytes.
+ * @return Number of bytes written.
+ */
+size_t SmdFile::write(const void *ptr, size_t size)
+{
+	// Not a valid operation for SmdFile.
+	RP_UNUSED(ptr);
+	RP_UNUSED(size);
+	m_lastError = EBADF;
+	return 0;
+}
+
+/**
+ * Set the file position.
+ * @param pos File position.
+ * @return 0 on success; -1 on error.
+ */
+int SmdFile::seek(off64_t pos)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	if (pos <= 0) {
+		m_pos = 0;
+	} else if (pos >= m_size) {
+		m_pos = m_size;
+	} else {
+		m_pos = pos;
+	}
+
+	return 0;
+}
+
+/**
+ * Get the file position.
+ * @return File position, or -1 on error.
+ */
+off64_t SmdFile::tell(void)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	return m_pos;
+}
+
+/**
+ * Truncate the file.
+ * @param size New size. (default is 0)
+ * @return 0 on success; -1 on error.
+ */
+int SmdFile::truncate(off64_t size)
+{
+	// Not supported.
+	RP_UNUSED(size);
+	m_lastError = ENOTSUP;
+	return -m_lastError;
+}
+
+/** File properties. **/
+
+/**
+ * Get the file size.
+ * This is the size of the decoded binary ROM image.
+ * @return File size, or negative on error.
+ */
+off64_t SmdFile::size(void)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	return m_size;
+}
+
+/**
+ * Get the filename.
+ * @return Filename. (May be empty if the filename is not available.)
+ */
+string SmdFile::filename(void) const
+{
+	return (m_file ? m_file->filename() : string());
+}
+
+}
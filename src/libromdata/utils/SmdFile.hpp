@@ -0,0 +1,137 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * SmdFile.hpp: IRpFile wrapper for Super Magic Drive interleaved ROMs.    *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBROMDATA_UTILS_SMDFILE_HPP__
+#define __ROMPROPERTIES_LIBROMDATA_UTILS_SMDFILE_HPP__
+
+#include "librpfile/IRpFile.hpp"
+
+namespace LibRomData {
+
+/**
+ * Read-only IRpFile that presents a Super Magic Drive ROM image
+ * as a plain binary ROM image.
+ *
+ * SMD blocks are decoded on demand. The most recently decoded block
+ * is cached for small reads; reads that cover entire blocks are decoded
+ * directly into the caller's buffer if it's 16-byte aligned.
+ */
+class SmdFile final : public LibRpFile::IRpFile
+{
+	public:
+		/**
+		 * Open a Super Magic Drive ROM image as a plain binary ROM image.
+		 * NOTE: These files are read-only.
+		 *
+		 * The SMD file must have a 512-byte header, followed by
+		 * one or more 16 KB interleaved blocks. Trailing data
+		 * that isn't a full block is ignored.
+		 *
+		 * @param file SMD file.
+		 */
+		explicit SmdFile(LibRpFile::IRpFile *file);
+	protected:
+		virtual ~SmdFile();	// call unref() instead
+
+	private:
+		typedef IRpFile super;
+		RP_DISABLE_COPY(SmdFile)
+
+	public:
+		/**
+		 * Is the file open?
+		 * This usually only returns false if an error occurred.
+		 * @return True if the file is open; false if it isn't.
+		 */
+		bool isOpen(void) const final;
+
+		/**
+		 * Close the file.
+		 */
+		void close(void) final;
+
+		/**
+		 * Read data from the file.
+		 * @param ptr Output data buffer.
+		 * @param size Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 2, 3)
+		size_t read(void *ptr, size_t size) final;
+
+		/**
+		 * Write data to the file.
+		 * (NOTE: Not valid for SmdFile; this will always return 0.)
+		 * @param ptr Input data buffer.
+		 * @param size Amount of data to read, in bytes.
+		 * @return Number of bytes written.
+		 */
+		ATTR_ACCESS_SIZE(read_only, 2, 3)
+		size_t write(const void *ptr, size_t size) final;
+
+		/**
+		 * Set the file position.
+		 * @param pos File position.
+		 * @return 0 on success; -1 on error.
+		 */
+		int seek(off64_t pos) final;
+
+		/**
+		 * Get the file position.
+		 * @return File position, or -1 on error.
+		 */
+		off64_t tell(void) final;
+
+		/**
+		 * Truncate the file.
+		 * @param size New size. (default is 0)
+		 * @return 0 on success; -1 on error.
+		 */
+		int truncate(off64_t size = 0) final;
+
+	public:
+		/** File properties. **/
+
+		/**
+		 * Get the file size.
+		 * This is the size of the decoded binary ROM image.
+		 * @return File size, or negative on error.
+		 */
+		off64_t size(void) final;
+
+		/**
+		 * Get the filename.
+		 * @return Filename. (May be empty if the filename is not available.)
+		 */
+		std::string filename(void) const final;
+
+	private:
+		/**
+		 * Read and decode an SMD block.
+		 * @param pDest		[out] Destination buffer. (Must be 16 KB, 16-byte aligned.)
+		 * @param blockIdx	[in] Block index.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int readBlock(uint8_t *pDest, unsigned int blockIdx);
+
+	protected:
+		LibRpFile::IRpFile *m_file;
+		off64_t m_size;		// Decoded file size.
+		off64_t m_pos;		// Current position.
+
+		// Block buffers. (16-byte aligned)
+		// - m_smdBuf: Interleaved SMD block.
+		// - m_binBuf: Cached decoded block.
+		uint8_t *m_smdBuf;
+		uint8_t *m_binBuf;
+		int m_binBlockIdx;	// Cached block index. (-1 for none)
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBROMDATA_UTILS_SMDFILE_HPP__ */
@@ -24,6 +24,7 @@
 #  define SMD_HAS_MMX 1
 # endif
 # define SMD_HAS_SSE2 1
+# define SMD_HAS_AVX2 1
 #endif
 #ifdef RP_CPU_AMD64
 # define SMD_ALWAYS_HAS_SSE2 1
@@ -73,6 +74,17 @@ class SuperMagicDrive
 		static void decodeBlock_sse2(uint8_t *RESTRICT pDest, const uint8_t *RESTRICT pSrc);
 #endif /* SMD_HAS_SSE2 */
 
+#if SMD_HAS_AVX2
+		/**
+		 * Decode a Super Magic Drive interleaved block.
+		 * AVX2-optimized version.
+		 * NOTE: Pointers must be 16-byte aligned.
+		 * @param pDest	[out] Destination block. (Must be 16 KB.)
+		 * @param pSrc	[in] Source block. (Must be 16 KB.)
+		 */
+		static void decodeBlock_avx2(uint8_t *RESTRICT pDest, const uint8_t *RESTRICT pSrc);
+#endif /* SMD_HAS_AVX2 */
+
 	public:
 		// SMD block size.
 		static const unsigned int SMD_BLOCK_SIZE = 16384;
@@ -83,7 +95,7 @@ class SuperMagicDrive
 		 * @param pDest	[out] Destination block. (Must be 16 KB.)
 		 * @param pSrc	[in] Source block. (Must be 16 KB.)
 		 */
-		static IFUNC_SSE2_INLINE void decodeBlock(uint8_t *RESTRICT pDest, const uint8_t *RESTRICT pSrc);
+		static IFUNC_INLINE void decodeBlock(uint8_t *RESTRICT pDest, const uint8_t *RESTRICT pSrc);
 };
 
 // TODO: Use gcc target-specific function attributes if available?
@@ -91,25 +103,6 @@ class SuperMagicDrive
 
 /** Dispatch functions. **/
 
-#if defined(RP_HAS_IFUNC) && defined(SMD_ALWAYS_HAS_SSE2)
-
-// System does support IFUNC, but it's always guaranteed to have SSE2.
-// Eliminate the IFUNC dispatch on this system.
-
-/**
- * Decode a Super Magic Drive interleaved block.
- * NOTE: Pointers must be 16-byte aligned if using SSE2.
- * @param dest	[out] Destination block. (Must be 16 KB.)
- * @param src	[in] Source block. (Must be 16 KB.)
- */
-inline void SuperMagicDrive::decodeBlock(uint8_t *RESTRICT pDest, const uint8_t *RESTRICT pSrc)
-{
-	// amd64 always has SSE2.
-	decodeBlock_sse2(pDest, pSrc);
-}
-
-#endif /* defined(RP_HAS_IFUNC) && defined(SMD_ALWAYS_HAS_SSE2) */
-
 #if !defined(RP_HAS_IFUNC) || (!defined(RP_CPU_I386) && !defined(RP_CPU_AMD64))
 
 /**
@@ -120,9 +113,16 @@ inline void SuperMagicDrive::decodeBlock(uint8_t *RESTRICT pDest, const uint8_t
  */
 inline void SuperMagicDrive::decodeBlock(uint8_t *RESTRICT pDest, const uint8_t *RESTRICT pSrc)
 {
+#ifdef SMD_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		decodeBlock_avx2(pDest, pSrc);
+	} else
+#endif /* SMD_HAS_AVX2 */
 #ifdef SMD_ALWAYS_HAS_SSE2
-	// amd64 always has SSE2.
-	decodeBlock_sse2(pDest, pSrc);
+	{
+		// amd64 always has SSE2.
+		decodeBlock_sse2(pDest, pSrc);
+	}
 #else /* SMD_ALWAYS_HAS_SSE2 */
 # ifdef SMD_HAS_SSE2
 	if (RP_CPU_HasSSE2()) {
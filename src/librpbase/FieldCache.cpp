@@ -0,0 +1,920 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * FieldCache.cpp: RomFields/RomMetaData binary serialization.             *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "FieldCache.hpp"
+#include "RomFields.hpp"
+#include "RomMetaData.hpp"
+#include "SystemRegion.hpp"
+#include "config/Config.hpp"
+#include "config.version.h"
+#ifdef ENABLE_DECRYPTION
+# include "crypto/KeyManager.hpp"
+#endif /* ENABLE_DECRYPTION */
+
+// libcachecommon
+#include "libcachecommon/DerivedCache.hpp"
+
+// librpfile
+#include "librpfile/FileSystem.hpp"
+using LibRpFile::IRpFile;
+using LibRpFile::RpFile;
+namespace FileSystem = LibRpFile::FileSystem;
+
+// C++ STL classes.
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+/**
+ * Serialized data format:
+ * - All integers are little-endian.
+ * - "varint" is an unsigned LEB128 value. (up to 32 bits)
+ * - Strings are a varint length followed by UTF-8 data.
+ *   No NULL terminator is stored.
+ * - Optional values are prefixed with a uint8_t:
+ *   0 == not present, 1 == present.
+ *
+ * RomFields:
+ * - uint32_t magic ('RPFC')
+ * - uint32_t version
+ * - uint32_t default language code
+ * - varint: tab count, followed by tab names
+ * - varint: field count, followed by fields
+ *   - uint8_t type, uint8_t tabIdx, string name
+ *   - Type-specific data.
+ *
+ * RomMetaData:
+ * - uint32_t magic ('RPMC')
+ * - uint32_t version
+ * - varint: property count, followed by properties
+ *   - uint8_t name, uint8_t type
+ *   - Type-specific data.
+ */
+#define FIELD_CACHE_MAGIC	'RPFC'
+#define METADATA_CACHE_MAGIC	'RPMC'
+#define FIELD_CACHE_VERSION	1
+
+// Cache subdirectory and size limits.
+#define FIELD_CACHE_SUBDIR		"fields"
+#define FIELD_CACHE_MAX_SIZE		(16LL*1024*1024)
+#define FIELD_CACHE_MAX_FILE_SIZE	(4*1024*1024)
+
+// Number of bytes at the start of the file to use for
+// the header fingerprint.
+#define FIELD_CACHE_FINGERPRINT_SIZE	4096
+
+namespace LibRpBase {
+
+/**
+ * Serialization buffer writer.
+ */
+class FieldCacheWriter
+{
+	public:
+		explicit FieldCacheWriter(ao::uvector<uint8_t> &buf)
+			: buf(buf) { }
+
+	private:
+		RP_DISABLE_COPY(FieldCacheWriter)
+
+	public:
+		ao::uvector<uint8_t> &buf;
+
+	public:
+		inline void u8(uint8_t val)
+		{
+			buf.push_back(val);
+		}
+
+		inline void u32(uint32_t val)
+		{
+			const uint8_t b[4] = {
+				static_cast<uint8_t>(val),
+				static_cast<uint8_t>(val >> 8),
+				static_cast<uint8_t>(val >> 16),
+				static_cast<uint8_t>(val >> 24),
+			};
+			buf.insert(buf.end(), b, b + sizeof(b));
+		}
+
+		inline void s64(int64_t val)
+		{
+			const uint64_t uval = static_cast<uint64_t>(val);
+			u32(static_cast<uint32_t>(uval));
+			u32(static_cast<uint32_t>(uval >> 32));
+		}
+
+		inline void varint(uint32_t val)
+		{
+			while (val >= 0x80) {
+				buf.push_back(static_cast<uint8_t>(val | 0x80));
+				val >>= 7;
+			}
+			buf.push_back(static_cast<uint8_t>(val));
+		}
+
+		inline void str(const string &s)
+		{
+			varint(static_cast<uint32_t>(s.size()));
+			const uint8_t *const p = reinterpret_cast<const uint8_t*>(s.data());
+			buf.insert(buf.end(), p, p + s.size());
+		}
+
+		void strVector(const vector<string> *vec)
+		{
+			if (!vec) {
+				u8(0);
+				return;
+			}
+			u8(1);
+			varint(static_cast<uint32_t>(vec->size()));
+			for (auto iter = vec->cbegin(); iter != vec->cend(); ++iter) {
+				str(*iter);
+			}
+		}
+
+		void listData(const RomFields::ListData_t *list_data)
+		{
+			if (!list_data) {
+				u8(0);
+				return;
+			}
+			u8(1);
+			varint(static_cast<uint32_t>(list_data->size()));
+			for (auto iter = list_data->cbegin(); iter != list_data->cend(); ++iter) {
+				varint(static_cast<uint32_t>(iter->size()));
+				for (auto col = iter->cbegin(); col != iter->cend(); ++col) {
+					str(*col);
+				}
+			}
+		}
+};
+
+/**
+ * Serialization buffer reader.
+ * All functions return false if the buffer is exhausted.
+ */
+class FieldCacheReader
+{
+	public:
+		FieldCacheReader(const uint8_t *buf, size_t size)
+			: p(buf), end(buf + size) { }
+
+	private:
+		RP_DISABLE_COPY(FieldCacheReader)
+
+	public:
+		const uint8_t *p;
+		const uint8_t *const end;
+
+	public:
+		inline bool atEnd(void) const
+		{
+			return (p == end);
+		}
+
+		inline bool u8(uint8_t &val)
+		{
+			if (p >= end)
+				return false;
+			val = *p++;
+			return true;
+		}
+
+		inline bool u32(uint32_t &val)
+		{
+			if (end - p < 4)
+				return false;
+			val =  static_cast<uint32_t>(p[0]) |
+			      (static_cast<uint32_t>(p[1]) << 8) |
+			      (static_cast<uint32_t>(p[2]) << 16) |
+			      (static_cast<uint32_t>(p[3]) << 24);
+			p += 4;
+			return true;
+		}
+
+		inline bool s64(int64_t &val)
+		{
+			uint32_t lo, hi;
+			if (!u32(lo) || !u32(hi))
+				return false;
+			val = static_cast<int64_t>((static_cast<uint64_t>(hi) << 32) | lo);
+			return true;
+		}
+
+		bool varint(uint32_t &val)
+		{
+			val = 0;
+			for (unsigned int shift = 0; shift < 35; shift += 7) {
+				if (p >= end)
+					return false;
+				const uint8_t b = *p++;
+				val |= static_cast<uint32_t>(b & 0x7F) << shift;
+				if (!(b & 0x80))
+					return true;
+			}
+			// Too many bytes.
+			return false;
+		}
+
+		bool str(string &s)
+		{
+			uint32_t len;
+			if (!varint(len) || static_cast<size_t>(end - p) < len)
+				return false;
+			s.assign(reinterpret_cast<const char*>(p), len);
+			p += len;
+			return true;
+		}
+
+		/**
+		 * Read a count value.
+		 * The count is checked against the remaining buffer size,
+		 * assuming each element takes up at least one byte.
+		 */
+		inline bool count(uint32_t &val)
+		{
+			return (varint(val) && val <= static_cast<size_t>(end - p));
+		}
+
+		/**
+		 * Read an optional string vector.
+		 * @param pVec [out] Allocated vector, or nullptr if not present.
+		 */
+		bool strVector(vector<string> **pVec)
+		{
+			*pVec = nullptr;
+			uint8_t present;
+			if (!u8(present))
+				return false;
+			if (!present)
+				return true;
+
+			uint32_t cnt;
+			if (!count(cnt))
+				return false;
+			unique_ptr<vector<string> > vec(new vector<string>(cnt));
+			for (auto iter = vec->begin(); iter != vec->end(); ++iter) {
+				if (!str(*iter))
+					return false;
+			}
+			*pVec = vec.release();
+			return true;
+		}
+
+		/**
+		 * Read optional ListData.
+		 * @param list_data [out] ListData. (nullptr if not present)
+		 */
+		bool listData(unique_ptr<RomFields::ListData_t> &list_data)
+		{
+			list_data.reset();
+			uint8_t present;
+			if (!u8(present))
+				return false;
+			if (!present)
+				return true;
+
+			uint32_t rows;
+			if (!count(rows))
+				return false;
+			list_data.reset(new RomFields::ListData_t(rows));
+			for (auto iter = list_data->begin(); iter != list_data->end(); ++iter) {
+				uint32_t cols;
+				if (!count(cols))
+					return false;
+				iter->resize(cols);
+				for (auto col = iter->begin(); col != iter->end(); ++col) {
+					if (!str(*col))
+						return false;
+				}
+			}
+			return true;
+		}
+};
+
+/**
+ * Serialize a RomFields object.
+ *
+ * RFT_LISTDATA fields with icons can't be serialized,
+ * since the icons are rp_image objects.
+ *
+ * @param fields	[in] RomFields.
+ * @param buf		[out] Output buffer.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int FieldCache::serializeFields(const RomFields *fields, ao::uvector<uint8_t> &buf)
+{
+	assert(fields != nullptr);
+	if (!fields)
+		return -EINVAL;
+
+	buf.clear();
+	FieldCacheWriter w(buf);
+	w.u32(FIELD_CACHE_MAGIC);
+	w.u32(FIELD_CACHE_VERSION);
+	w.u32(fields->defaultLanguageCode());
+
+	// Tab names.
+	const int tabCount = fields->tabCount();
+	w.varint(static_cast<uint32_t>(tabCount));
+	for (int i = 0; i < tabCount; i++) {
+		const char *const name = fields->tabName(i);
+		w.str(name ? string(name) : string());
+	}
+
+	// Fields.
+	// NOTE: Invalid fields are skipped by the UI frontends,
+	// so they aren't stored here.
+	uint32_t fieldCount = 0;
+	for (auto iter = fields->cbegin(); iter != fields->cend(); ++iter) {
+		if (iter->isValid && iter->type != RomFields::RFT_INVALID) {
+			fieldCount++;
+		}
+	}
+	w.varint(fieldCount);
+
+	for (auto iter = fields->cbegin(); iter != fields->cend(); ++iter) {
+		const RomFields::Field &field = *iter;
+		if (!field.isValid || field.type == RomFields::RFT_INVALID)
+			continue;
+
+		w.u8(field.type);
+		w.u8(field.tabIdx);
+		w.str(field.name);
+
+		switch (field.type) {
+			case RomFields::RFT_STRING:
+				w.varint(field.desc.flags);
+				if (field.data.str) {
+					w.u8(1);
+					w.str(*field.data.str);
+				} else {
+					w.u8(0);
+				}
+				break;
+
+			case RomFields::RFT_BITFIELD:
+				w.varint(static_cast<uint32_t>(field.desc.bitfield.elemsPerRow));
+				w.u32(field.data.bitfield);
+				w.strVector(field.desc.bitfield.names);
+				break;
+
+			case RomFields::RFT_LISTDATA: {
+				const unsigned int flags = field.desc.list_data.flags;
+				if (flags & RomFields::RFT_LISTDATA_ICONS) {
+					// Icons can't be serialized.
+					buf.clear();
+					return -ENOTSUP;
+				}
+
+				w.varint(flags);
+				w.varint(static_cast<uint32_t>(field.desc.list_data.rows_visible));
+				w.u32(field.desc.list_data.alignment.headers);
+				w.u32(field.desc.list_data.alignment.data);
+				w.strVector(field.desc.list_data.names);
+				if (flags & RomFields::RFT_LISTDATA_CHECKBOXES) {
+					w.u32(field.data.list_data.mxd.checkboxes);
+				}
+
+				if (flags & RomFields::RFT_LISTDATA_MULTI) {
+					const RomFields::ListDataMultiMap_t *const multi = field.data.list_data.data.multi;
+					if (!multi) {
+						w.u8(0);
+						break;
+					}
+					w.u8(1);
+					w.varint(static_cast<uint32_t>(multi->size()));
+					for (auto ldm = multi->cbegin(); ldm != multi->cend(); ++ldm) {
+						w.u32(ldm->first);
+						w.listData(&ldm->second);
+					}
+				} else {
+					w.listData(field.data.list_data.data.single);
+				}
+				break;
+			}
+
+			case RomFields::RFT_DATETIME:
+				w.varint(field.desc.flags);
+				w.s64(static_cast<int64_t>(field.data.date_time));
+				break;
+
+			case RomFields::RFT_AGE_RATINGS: {
+				const RomFields::age_ratings_t *const age_ratings = field.data.age_ratings;
+				for (size_t i = 0; i < RomFields::AGE_MAX; i++) {
+					w.varint(age_ratings ? (*age_ratings)[i] : 0);
+				}
+				break;
+			}
+
+			case RomFields::RFT_DIMENSIONS:
+				w.u32(static_cast<uint32_t>(field.data.dimensions[0]));
+				w.u32(static_cast<uint32_t>(field.data.dimensions[1]));
+				w.u32(static_cast<uint32_t>(field.data.dimensions[2]));
+				break;
+
+			case RomFields::RFT_STRING_MULTI: {
+				w.varint(field.desc.flags);
+				const RomFields::StringMultiMap_t *const str_multi = field.data.str_multi;
+				if (!str_multi) {
+					w.u8(0);
+					break;
+				}
+				w.u8(1);
+				w.varint(static_cast<uint32_t>(str_multi->size()));
+				for (auto sm = str_multi->cbegin(); sm != str_multi->cend(); ++sm) {
+					w.u32(sm->first);
+					w.str(sm->second);
+				}
+				break;
+			}
+
+			default:
+				// Unsupported field type.
+				assert(!"Unsupported RomFields::RomFieldsType.");
+				buf.clear();
+				return -ENOTSUP;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Deserialize a RomFields object.
+ * Fields are appended to the RomFields object.
+ * @param fields	[out] RomFields.
+ * @param buf		[in] Serialized data.
+ * @param size		[in] Size of buf.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int FieldCache::deserializeFields(RomFields *fields, const uint8_t *buf, size_t size)
+{
+	assert(fields != nullptr);
+	assert(buf != nullptr);
+	if (!fields || !buf)
+		return -EINVAL;
+
+	FieldCacheReader r(buf, size);
+	uint32_t magic, version, def_lc;
+	if (!r.u32(magic) || magic != FIELD_CACHE_MAGIC ||
+	    !r.u32(version) || version != FIELD_CACHE_VERSION ||
+	    !r.u32(def_lc))
+	{
+		// Incorrect header.
+		return -EIO;
+	}
+
+	// Tab names.
+	uint32_t tabCount;
+	if (!r.count(tabCount) || tabCount > 256)
+		return -EIO;
+	if (tabCount > 1) {
+		fields->reserveTabs(static_cast<int>(tabCount));
+	}
+	string str;
+	for (uint32_t i = 0; i < tabCount; i++) {
+		if (!r.str(str))
+			return -EIO;
+		if (!str.empty()) {
+			fields->setTabName(static_cast<int>(i), str.c_str());
+		}
+	}
+
+	// Fields.
+	uint32_t fieldCount;
+	if (!r.count(fieldCount))
+		return -EIO;
+	fields->reserve(static_cast<int>(fieldCount));
+
+	string name;
+	for (uint32_t i = 0; i < fieldCount; i++) {
+		uint8_t type, tabIdx;
+		if (!r.u8(type) || !r.u8(tabIdx) || !r.str(name))
+			return -EIO;
+		fields->setTabIndex(tabIdx);
+
+		switch (type) {
+			case RomFields::RFT_STRING: {
+				uint32_t flags;
+				uint8_t present;
+				if (!r.varint(flags) || !r.u8(present))
+					return -EIO;
+				if (present) {
+					if (!r.str(str))
+						return -EIO;
+					fields->addField_string(name.c_str(), str.c_str(), flags);
+				} else {
+					fields->addField_string(name.c_str(), nullptr, flags);
+				}
+				break;
+			}
+
+			case RomFields::RFT_BITFIELD: {
+				uint32_t elemsPerRow, bitfield;
+				vector<string> *bit_names;
+				if (!r.varint(elemsPerRow) || !r.u32(bitfield) ||
+				    !r.strVector(&bit_names) || !bit_names)
+				{
+					return -EIO;
+				}
+				fields->addField_bitfield(name.c_str(), bit_names,
+					static_cast<int>(elemsPerRow), bitfield);
+				break;
+			}
+
+			case RomFields::RFT_LISTDATA: {
+				RomFields::AFLD_PARAMS params;
+				uint32_t rows_visible;
+				vector<string> *headers;
+				if (!r.varint(params.flags) || !r.varint(rows_visible) ||
+				    !r.u32(params.alignment.headers) ||
+				    !r.u32(params.alignment.data) ||
+				    !r.strVector(&headers))
+				{
+					return -EIO;
+				}
+				unique_ptr<vector<string> > u_headers(headers);
+				if (params.flags & RomFields::RFT_LISTDATA_ICONS)
+					return -EIO;
+				params.rows_visible = static_cast<int>(rows_visible);
+				if (params.flags & RomFields::RFT_LISTDATA_CHECKBOXES) {
+					if (!r.u32(params.mxd.checkboxes))
+						return -EIO;
+				}
+
+				if (params.flags & RomFields::RFT_LISTDATA_MULTI) {
+					uint8_t present;
+					if (!r.u8(present))
+						return -EIO;
+					unique_ptr<RomFields::ListDataMultiMap_t> multi;
+					if (present) {
+						uint32_t lcCount;
+						if (!r.count(lcCount))
+							return -EIO;
+						multi.reset(new RomFields::ListDataMultiMap_t());
+						for (uint32_t j = 0; j < lcCount; j++) {
+							uint32_t lc;
+							unique_ptr<RomFields::ListData_t> list_data;
+							if (!r.u32(lc) || !r.listData(list_data) || !list_data)
+								return -EIO;
+							(*multi)[lc] = std::move(*list_data);
+						}
+					}
+					params.def_lc = def_lc;
+					params.data.multi = multi.release();
+				} else {
+					unique_ptr<RomFields::ListData_t> list_data;
+					if (!r.listData(list_data))
+						return -EIO;
+					params.data.single = list_data.release();
+				}
+
+				params.headers = u_headers.release();
+				fields->addField_listData(name.c_str(), &params);
+				break;
+			}
+
+			case RomFields::RFT_DATETIME: {
+				uint32_t flags;
+				int64_t date_time;
+				if (!r.varint(flags) || !r.s64(date_time))
+					return -EIO;
+				fields->addField_dateTime(name.c_str(), static_cast<time_t>(date_time), flags);
+				break;
+			}
+
+			case RomFields::RFT_AGE_RATINGS: {
+				RomFields::age_ratings_t age_ratings;
+				for (size_t j = 0; j < age_ratings.size(); j++) {
+					uint32_t rating;
+					if (!r.varint(rating))
+						return -EIO;
+					age_ratings[j] = static_cast<uint16_t>(rating);
+				}
+				fields->addField_ageRatings(name.c_str(), age_ratings);
+				break;
+			}
+
+			case RomFields::RFT_DIMENSIONS: {
+				uint32_t dim[3];
+				if (!r.u32(dim[0]) || !r.u32(dim[1]) || !r.u32(dim[2]))
+					return -EIO;
+				fields->addField_dimensions(name.c_str(),
+					static_cast<int>(dim[0]),
+					static_cast<int>(dim[1]),
+					static_cast<int>(dim[2]));
+				break;
+			}
+
+			case RomFields::RFT_STRING_MULTI: {
+				uint32_t flags;
+				uint8_t present;
+				if (!r.varint(flags) || !r.u8(present))
+					return -EIO;
+				unique_ptr<RomFields::StringMultiMap_t> str_multi;
+				if (present) {
+					uint32_t lcCount;
+					if (!r.count(lcCount))
+						return -EIO;
+					str_multi.reset(new RomFields::StringMultiMap_t());
+					for (uint32_t j = 0; j < lcCount; j++) {
+						uint32_t lc;
+						if (!r.u32(lc) || !r.str(str))
+							return -EIO;
+						(*str_multi)[lc] = std::move(str);
+					}
+				}
+				fields->addField_string_multi(name.c_str(), str_multi.release(), def_lc, flags);
+				break;
+			}
+
+			default:
+				// Unsupported field type.
+				return -EIO;
+		}
+	}
+
+	// Make sure the entire buffer was used.
+	return (r.atEnd() ? 0 : -EIO);
+}
+
+/**
+ * Serialize a RomMetaData object.
+ * @param metaData	[in] RomMetaData.
+ * @param buf		[out] Output buffer.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int FieldCache::serializeMetaData(const RomMetaData *metaData, ao::uvector<uint8_t> &buf)
+{
+	assert(metaData != nullptr);
+	if (!metaData)
+		return -EINVAL;
+
+	buf.clear();
+	FieldCacheWriter w(buf);
+	w.u32(METADATA_CACHE_MAGIC);
+	w.u32(FIELD_CACHE_VERSION);
+
+	const int count = metaData->count();
+	w.varint(static_cast<uint32_t>(count));
+	for (int i = 0; i < count; i++) {
+		const RomMetaData::MetaData *const prop = metaData->prop(i);
+		assert(prop != nullptr);
+		if (!prop) {
+			buf.clear();
+			return -EINVAL;
+		}
+
+		w.u8(static_cast<uint8_t>(prop->name));
+		w.u8(static_cast<uint8_t>(prop->type));
+		switch (prop->type) {
+			case PropertyType::Integer:
+				w.u32(static_cast<uint32_t>(prop->data.ivalue));
+				break;
+			case PropertyType::UnsignedInteger:
+				w.u32(prop->data.uvalue);
+				break;
+			case PropertyType::String:
+				w.str(prop->data.str ? *prop->data.str : string());
+				break;
+			case PropertyType::Timestamp:
+				w.s64(static_cast<int64_t>(prop->data.timestamp));
+				break;
+			default:
+				// Unsupported property type.
+				assert(!"Unsupported PropertyType.");
+				buf.clear();
+				return -ENOTSUP;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Deserialize a RomMetaData object.
+ * Properties are added to the RomMetaData object.
+ * @param metaData	[out] RomMetaData.
+ * @param buf		[in] Serialized data.
+ * @param size		[in] Size of buf.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int FieldCache::deserializeMetaData(RomMetaData *metaData, const uint8_t *buf, size_t size)
+{
+	assert(metaData != nullptr);
+	assert(buf != nullptr);
+	if (!metaData || !buf)
+		return -EINVAL;
+
+	FieldCacheReader r(buf, size);
+	uint32_t magic, version, count;
+	if (!r.u32(magic) || magic != METADATA_CACHE_MAGIC ||
+	    !r.u32(version) || version != FIELD_CACHE_VERSION ||
+	    !r.count(count) || count > Property::PropertyCount)
+	{
+		// Incorrect header.
+		return -EIO;
+	}
+	metaData->reserve(static_cast<int>(count));
+
+	string str;
+	for (uint32_t i = 0; i < count; i++) {
+		uint8_t name, type;
+		if (!r.u8(name) || !r.u8(type))
+			return -EIO;
+		if (name <= Property::FirstProperty || name > Property::LastProperty)
+			return -EIO;
+		const Property::Property prop = static_cast<Property::Property>(name);
+
+		switch (type) {
+			case PropertyType::Integer:
+			case PropertyType::UnsignedInteger: {
+				uint32_t val;
+				if (!r.u32(val))
+					return -EIO;
+				if (type == PropertyType::Integer) {
+					metaData->addMetaData_integer(prop, static_cast<int>(val));
+				} else {
+					metaData->addMetaData_uint(prop, val);
+				}
+				break;
+			}
+			case PropertyType::String:
+				if (!r.str(str))
+					return -EIO;
+				metaData->addMetaData_string(prop, str);
+				break;
+			case PropertyType::Timestamp: {
+				int64_t timestamp;
+				if (!r.s64(timestamp))
+					return -EIO;
+				metaData->addMetaData_timestamp(prop, static_cast<time_t>(timestamp));
+				break;
+			}
+			default:
+				// Unsupported property type.
+				return -EIO;
+		}
+	}
+
+	// Make sure the entire buffer was used.
+	return (r.atEnd() ? 0 : -EIO);
+}
+
+/** Cache files **/
+
+/**
+ * Get the field cache filename for a ROM file.
+ *
+ * The cache key includes the file identity, the RomData
+ * class name, a fingerprint of the file's header, and
+ * the current language code.
+ *
+ * NOTE: This function checks if the field cache is enabled.
+ *
+ * @param filename	[in] Local filename. (UTF-8)
+ * @param className	[in] RomData class name.
+ * @param file		[in] Opened file, used for the header fingerprint.
+ * @param type		[in] Cache type.
+ * @return Cache filename, or empty string if the file can't be cached.
+ */
+string FieldCache::getCacheFilename(const char *filename, const char *className,
+	IRpFile *file, CacheType type)
+{
+	if (!filename || filename[0] == '\0' || !className || !file) {
+		// Can't cache this file.
+		return string();
+	}
+
+	const Config *const config = Config::instance();
+	if (!config->enableFieldCache()) {
+		// Field cache is disabled.
+		return string();
+	}
+
+	// Header fingerprint.
+	// The file identity usually catches modifications, but mtime
+	// only has a resolution of one second on some filesystems.
+	uint8_t header[FIELD_CACHE_FINGERPRINT_SIZE];
+	const size_t size = file->seekAndRead(0, header, sizeof(header));
+	if (size == 0) {
+		// Read error.
+		return string();
+	}
+	uint32_t fingerprint = 0x811C9DC5U;	// FNV-1a (32-bit)
+	for (size_t i = 0; i < size; i++) {
+		fingerprint ^= header[i];
+		fingerprint *= 0x01000193U;
+	}
+
+	// Variant data: Everything other than the file itself
+	// that affects the field contents.
+	ao::uvector<uint8_t> variant;
+	FieldCacheWriter w(variant);
+	w.u32(FIELD_CACHE_VERSION);
+	// Program version: RomData parsers may change between
+	// releases without a cache format change.
+	w.str(RP_VERSION_STRING);
+	w.u8(static_cast<uint8_t>(type));
+	w.str(className);
+	w.u32(fingerprint);
+	w.u32(static_cast<uint32_t>(size));
+	w.u32(SystemRegion::getLanguageCode());
+	w.u32(SystemRegion::getCountryCode());
+	w.u8(config->showHashTab() ? 1 : 0);
+	w.u8(config->verifyContentHashes() ? 1 : 0);
+
+#ifdef ENABLE_DECRYPTION
+	// Encryption keys affect decryption status fields.
+	const char *const keys_filename = KeyManager::instance()->filename();
+	LibCacheCommon::FileIdentity keysId;
+	if (keys_filename && LibCacheCommon::getFileIdentity(keys_filename, &keysId) == 0) {
+		w.s64(keysId.size);
+		w.s64(keysId.mtime);
+	}
+#endif /* ENABLE_DECRYPTION */
+
+	return LibCacheCommon::getDerivedCacheFilename(FIELD_CACHE_SUBDIR,
+		filename, variant.data(), variant.size(),
+		(type == CacheType::MetaData ? ".rpmc" : ".rpfc"));
+}
+
+/**
+ * Load a field cache file.
+ * @param cache_filename	[in] Cache filename.
+ * @param buf			[out] File contents.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int FieldCache::loadCacheFile(const string &cache_filename, ao::uvector<uint8_t> &buf)
+{
+	unique_RefBase<RpFile> file(new RpFile(cache_filename, RpFile::FM_OPEN_READ));
+	if (!file->isOpen()) {
+		// Not cached.
+		return -ENOENT;
+	}
+
+	const off64_t fileSize = file->size();
+	if (fileSize <= 0 || fileSize > FIELD_CACHE_MAX_FILE_SIZE) {
+		// Invalid cache file.
+		return -EIO;
+	}
+	const size_t size = static_cast<size_t>(fileSize);
+	buf.resize(size);
+	if (file->read(buf.data(), size) != size) {
+		// Read error.
+		buf.clear();
+		return -EIO;
+	}
+	file->close();
+
+	// Mark the cache file as recently used.
+	LibCacheCommon::touchDerivedCacheFile(cache_filename);
+	return 0;
+}
+
+/**
+ * Save a field cache file.
+ * The field cache will be pruned afterwards if it's too big.
+ * @param cache_filename	[in] Cache filename.
+ * @param buf			[in] File contents.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int FieldCache::saveCacheFile(const string &cache_filename, const ao::uvector<uint8_t> &buf)
+{
+	if (buf.empty() || buf.size() > FIELD_CACHE_MAX_FILE_SIZE) {
+		// Don't bother caching this.
+		return -EINVAL;
+	}
+
+	// Make sure the cache subdirectory exists.
+	if (FileSystem::rmkdir(cache_filename) != 0) {
+		return -EIO;
+	}
+
+	unique_RefBase<RpFile> file(new RpFile(cache_filename, RpFile::FM_CREATE_WRITE));
+	if (!file->isOpen()) {
+		const int ret = -file->lastError();
+		return (ret != 0 ? ret : -EIO);
+	}
+	if (file->write(buf.data(), buf.size()) != buf.size()) {
+		// Write error. Delete the incomplete file.
+		file->close();
+		FileSystem::delete_file(cache_filename);
+		return -EIO;
+	}
+	file->close();
+
+	// Prune the field cache if it's too big.
+	LibCacheCommon::pruneDerivedCache(FIELD_CACHE_SUBDIR, FIELD_CACHE_MAX_SIZE);
+	return 0;
+}
+
+}
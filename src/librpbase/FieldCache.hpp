@@ -0,0 +1,125 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * FieldCache.hpp: RomFields/RomMetaData binary serialization.             *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_FIELDCACHE_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_FIELDCACHE_HPP__
+
+#include "common.h"
+#include "uvector.h"
+
+// C includes.
+#include <stdint.h>
+
+// C++ includes.
+#include <string>
+
+namespace LibRpFile {
+	class IRpFile;
+}
+
+namespace LibRpBase {
+
+class RomFields;
+class RomMetaData;
+
+class FieldCache
+{
+	private:
+		// FieldCache is a static class.
+		FieldCache();
+		~FieldCache();
+		RP_DISABLE_COPY(FieldCache)
+
+	public:
+		/**
+		 * Serialize a RomFields object.
+		 *
+		 * RFT_LISTDATA fields with icons can't be serialized,
+		 * since the icons are rp_image objects.
+		 *
+		 * @param fields	[in] RomFields.
+		 * @param buf		[out] Output buffer.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int serializeFields(const RomFields *fields, ao::uvector<uint8_t> &buf);
+
+		/**
+		 * Deserialize a RomFields object.
+		 * Fields are appended to the RomFields object.
+		 * @param fields	[out] RomFields.
+		 * @param buf		[in] Serialized data.
+		 * @param size		[in] Size of buf.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int deserializeFields(RomFields *fields, const uint8_t *buf, size_t size);
+
+		/**
+		 * Serialize a RomMetaData object.
+		 * @param metaData	[in] RomMetaData.
+		 * @param buf		[out] Output buffer.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int serializeMetaData(const RomMetaData *metaData, ao::uvector<uint8_t> &buf);
+
+		/**
+		 * Deserialize a RomMetaData object.
+		 * Properties are added to the RomMetaData object.
+		 * @param metaData	[out] RomMetaData.
+		 * @param buf		[in] Serialized data.
+		 * @param size		[in] Size of buf.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int deserializeMetaData(RomMetaData *metaData, const uint8_t *buf, size_t size);
+
+	public:
+		/** Cache files **/
+
+		enum class CacheType {
+			Fields,		// RomFields
+			MetaData,	// RomMetaData
+		};
+
+		/**
+		 * Get the field cache filename for a ROM file.
+		 *
+		 * The cache key includes the file identity, the RomData
+		 * class name, a fingerprint of the file's header, and
+		 * the current language code.
+		 *
+		 * NOTE: This function checks if the field cache is enabled.
+		 *
+		 * @param filename	[in] Local filename. (UTF-8)
+		 * @param className	[in] RomData class name.
+		 * @param file		[in] Opened file, used for the header fingerprint.
+		 * @param type		[in] Cache type.
+		 * @return Cache filename, or empty string if the file can't be cached.
+		 */
+		static std::string getCacheFilename(const char *filename, const char *className,
+			LibRpFile::IRpFile *file, CacheType type);
+
+		/**
+		 * Load a field cache file.
+		 * @param cache_filename	[in] Cache filename.
+		 * @param buf			[out] File contents.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int loadCacheFile(const std::string &cache_filename, ao::uvector<uint8_t> &buf);
+
+		/**
+		 * Save a field cache file.
+		 * The field cache will be pruned afterwards if it's too big.
+		 * @param cache_filename	[in] Cache filename.
+		 * @param buf			[in] File contents.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int saveCacheFile(const std::string &cache_filename, const ao::uvector<uint8_t> &buf);
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_FIELDCACHE_HPP__ */
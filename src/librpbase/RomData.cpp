@@ -9,7 +9,10 @@
 #include "stdafx.h"
 #include "RomData.hpp"
 #include "RomData_p.hpp"
+#include "FieldCache.hpp"
 
+#include "crypto/StreamHasher.hpp"
+#include "disc/IDiscReader.hpp"
 #include "libi18n/i18n.h"
 
 // libcachecommon
@@ -39,12 +42,14 @@ RomDataPrivate::RomDataPrivate(RomData *q, IRpFile *file)
 	: q_ptr(q)
 	, isValid(false)
 	, isCompressed(false)
+	, showHashTab(false)
 	, file(nullptr)
 	, fields(new RomFields())
 	, metaData(nullptr)
 	, className(nullptr)
 	, mimeType(nullptr)
 	, fileType(RomData::FileType::ROM_Image)
+	, fieldCacheable(false)
 {
 	// Initialize i18n.
 	rp_i18n_init();
@@ -457,6 +462,37 @@ time_t RomDataPrivate::pvd_time_to_unix_time(const char pvd_time[16], int8_t tz_
 	return unixtime;
 }
 
+/**
+ * Add a tab with the ROM image's hashes.
+ * Called by RomData::fields() if showHashTab is set.
+ */
+void RomDataPrivate::addHashTab(void)
+{
+	RP_Q(RomData);
+	StreamHasher hasher;
+	if (q->hashContents(&hasher) != 0) {
+		// Unable to hash the ROM image.
+		return;
+	}
+
+	// If the main tab isn't named, name it after the system.
+	// Otherwise, addTab() would rename the main tab.
+	if (!fields->tabName(0)) {
+		const char *const sysName = q->systemName(
+			RomData::SYSNAME_TYPE_SHORT | RomData::SYSNAME_REGION_GENERIC);
+		fields->setTabName(0, sysName ? sysName : C_("RomData", "ROM"));
+	}
+	fields->addTab(C_("RomData", "Hashes"));
+
+	for (int i = 0; i < static_cast<int>(Hash::Algorithm::Max); i++) {
+		const Hash::Algorithm algorithm = static_cast<Hash::Algorithm>(i);
+		if (!hasher.hasHash(algorithm))
+			continue;
+		fields->addField_string(Hash::algorithmName(algorithm),
+			hasher.getHashString(algorithm), RomFields::STRF_MONOSPACE);
+	}
+}
+
 /** RomData **/
 
 /**
@@ -767,10 +803,43 @@ const RomFields *RomData::fields(void) const
 	RP_D(const RomData);
 	if (d->fields->empty()) {
 		// Data has not been loaded.
+		// Check the field cache first.
+		// NOTE: Classes with ROM operations update their fields
+		// after an operation, so they can't use the cache.
+		string cache_filename;
+		if (d->fieldCacheable && romOps_int().empty()) {
+			cache_filename = FieldCache::getCacheFilename(
+				d->filename.c_str(), d->className, d->file,
+				FieldCache::CacheType::Fields);
+		}
+		ao::uvector<uint8_t> buf;
+		if (!cache_filename.empty() &&
+		    FieldCache::loadCacheFile(cache_filename, buf) == 0)
+		{
+			if (FieldCache::deserializeFields(d->fields, buf.data(), buf.size()) == 0) {
+				// Fields loaded from the cache.
+				return d->fields;
+			}
+			// Invalid cache file. Discard any partially-loaded fields.
+			d->fields->clear();
+		}
+
 		// Load it now.
 		int ret = const_cast<RomData*>(this)->loadFieldData();
 		if (ret < 0)
 			return nullptr;
+
+		// Add the hash tab, if enabled.
+		if (d->showHashTab) {
+			const_cast<RomDataPrivate*>(d)->addHashTab();
+		}
+
+		// Save the fields in the cache.
+		if (!cache_filename.empty() && !d->fields->empty() &&
+		    FieldCache::serializeFields(d->fields, buf) == 0)
+		{
+			FieldCache::saveCacheFile(cache_filename, buf);
+		}
 	}
 	return d->fields;
 }
@@ -784,10 +853,40 @@ const RomMetaData *RomData::metaData(void) const
 	RP_D(const RomData);
 	if (!d->metaData || d->metaData->empty()) {
 		// Data has not been loaded.
+		// Check the field cache first.
+		string cache_filename;
+		if (d->fieldCacheable && romOps_int().empty()) {
+			cache_filename = FieldCache::getCacheFilename(
+				d->filename.c_str(), d->className, d->file,
+				FieldCache::CacheType::MetaData);
+		}
+		ao::uvector<uint8_t> buf;
+		if (!cache_filename.empty() &&
+		    FieldCache::loadCacheFile(cache_filename, buf) == 0)
+		{
+			RomMetaData *const metaData = new RomMetaData();
+			if (FieldCache::deserializeMetaData(metaData, buf.data(), buf.size()) == 0) {
+				// Metadata loaded from the cache.
+				RomDataPrivate *const dw = const_cast<RomDataPrivate*>(d);
+				delete dw->metaData;
+				dw->metaData = metaData;
+				return d->metaData;
+			}
+			// Invalid cache file.
+			delete metaData;
+		}
+
 		// Load it now.
 		int ret = const_cast<RomData*>(this)->loadMetaData();
 		if (ret < 0)
 			return nullptr;
+
+		// Save the metadata in the cache.
+		if (!cache_filename.empty() && d->metaData && !d->metaData->empty() &&
+		    FieldCache::serializeMetaData(d->metaData, buf) == 0)
+		{
+			FieldCache::saveCacheFile(cache_filename, buf);
+		}
 	}
 	return d->metaData;
 }
@@ -953,6 +1052,79 @@ bool RomData::hasDangerousPermissions(void) const
 	return false;
 }
 
+/**
+ * Open the partition containing this ROM image's file system.
+ *
+ * The partition's IFst wrapper functions can be used to list
+ * and extract files, e.g. for rpcli's file system commands.
+ *
+ * NOTE: The caller must unref() the partition when done.
+ *
+ * @return New reference to the IPartition, or nullptr if this ROM image doesn't have a file system.
+ */
+IPartition *RomData::openFstPartition(void)
+{
+	// No file system by default.
+	return nullptr;
+}
+
+/**
+ * Open a reader for this ROM image's logical contents.
+ *
+ * This is used for compressed disc images, e.g. GCZ, CSO,
+ * and WBFS, where the decompressed data should be hashed
+ * instead of the compressed file.
+ *
+ * NOTE: The caller must unref() the reader when done.
+ *
+ * @return New reference to the IDiscReader, or nullptr if the file can be read directly.
+ */
+IDiscReader *RomData::openDataReader(void)
+{
+	// The file can be read directly by default.
+	return nullptr;
+}
+
+/**
+ * Show a tab with the ROM image's hashes in fields()?
+ *
+ * This is set by RomDataFactory if ShowHashTab is enabled.
+ * It must be set before fields() is called.
+ *
+ * @param showHashTab True to show the hash tab.
+ */
+void RomData::setShowHashTab(bool showHashTab)
+{
+	RP_D(RomData);
+	d->showHashTab = showHashTab;
+}
+
+/**
+ * Hash this ROM image's contents.
+ * If openDataReader() returns a reader, its logical
+ * contents are hashed; otherwise, the file is hashed.
+ * @param hasher StreamHasher.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RomData::hashContents(StreamHasher *hasher)
+{
+	assert(hasher != nullptr);
+	if (!hasher)
+		return -EINVAL;
+
+	IDiscReader *const discReader = openDataReader();
+	if (discReader) {
+		const int ret = hasher->process(discReader);
+		discReader->unref();
+		return ret;
+	}
+
+	RP_D(RomData);
+	if (!d->file)
+		return -EBADF;
+	return hasher->process(d->file);
+}
+
 /**
  * Get the list of operations that can be performed on this ROM.
  * @return List of operations.
@@ -30,7 +30,10 @@ namespace LibRpTexture {
 
 namespace LibRpBase {
 
+class IDiscReader;
+class IPartition;
 class RomFields;
+class StreamHasher;
 class RomMetaData;
 struct IconAnimData;
 
@@ -557,6 +560,51 @@ class RomData : public RefBase
 		 */
 		virtual bool hasDangerousPermissions(void) const;
 
+	public:
+		/**
+		 * Open the partition containing this ROM image's file system.
+		 *
+		 * The partition's IFst wrapper functions can be used to list
+		 * and extract files, e.g. for rpcli's file system commands.
+		 *
+		 * NOTE: The caller must unref() the partition when done.
+		 *
+		 * @return New reference to the IPartition, or nullptr if this ROM image doesn't have a file system.
+		 */
+		virtual IPartition *openFstPartition(void);
+
+		/**
+		 * Open a reader for this ROM image's logical contents.
+		 *
+		 * This is used for compressed disc images, e.g. GCZ, CSO,
+		 * and WBFS, where the decompressed data should be hashed
+		 * instead of the compressed file.
+		 *
+		 * NOTE: The caller must unref() the reader when done.
+		 *
+		 * @return New reference to the IDiscReader, or nullptr if the file can be read directly.
+		 */
+		virtual IDiscReader *openDataReader(void);
+
+		/**
+		 * Show a tab with the ROM image's hashes in fields()?
+		 *
+		 * This is set by RomDataFactory if ShowHashTab is enabled.
+		 * It must be set before fields() is called.
+		 *
+		 * @param showHashTab True to show the hash tab.
+		 */
+		void setShowHashTab(bool showHashTab);
+
+		/**
+		 * Hash this ROM image's contents.
+		 * If openDataReader() returns a reader, its logical
+		 * contents are hashed; otherwise, the file is hashed.
+		 * @param hasher StreamHasher.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int hashContents(StreamHasher *hasher);
+
 	public:
 		/**
 		 * ROF_SAVE_FILE information.
@@ -256,6 +256,30 @@ class klass final : public LibRpBase::RomData { \
 		 */ \
 		bool hasDangerousPermissions(void) const final;
 
+/**
+ * RomData subclass function declaration for opening the file system partition.
+ */
+#define ROMDATA_DECL_FSTPARTITION() \
+	public: \
+		/** \
+		 * Open the partition containing this ROM image's file system. \
+		 * NOTE: The caller must unref() the partition when done. \
+		 * @return New reference to the IPartition, or nullptr if this ROM image doesn't have a file system. \
+		 */ \
+		LibRpBase::IPartition *openFstPartition(void) final;
+
+/**
+ * RomData subclass function declaration for opening a logical data reader.
+ */
+#define ROMDATA_DECL_DATAREADER() \
+	public: \
+		/** \
+		 * Open a reader for this ROM image's logical contents. \
+		 * NOTE: The caller must unref() the reader when done. \
+		 * @return New reference to the IDiscReader, or nullptr if the file can be read directly. \
+		 */ \
+		LibRpBase::IDiscReader *openDataReader(void) final;
+
 /**
  * RomData subclass function declaration for indicating ROM operations are possible.
  */
@@ -55,6 +55,7 @@ class RomDataPrivate
 	public:
 		bool isValid;			// Subclass must set this to true if the ROM is valid.
 		bool isCompressed;		// True if the file is compressed. (transparent decompression)
+		bool showHashTab;		// True to add a hash tab in fields().
 		LibRpFile::IRpFile *file;	// Open file.
 		std::string filename;		// Copy of the filename.
 		RomFields *const fields;	// ROM fields. (NOTE: allocated by the base class)
@@ -66,6 +67,19 @@ class RomDataPrivate
 		const char *mimeType;		// MIME type. (ASCII) (default is nullptr)
 		RomData::FileType fileType;	// File type. (default is FileType::ROM_Image)
 
+		// Set to true if loadFieldData() and loadMetaData() only fill in
+		// fields and metaData, i.e. no other state is set that the rest
+		// of the subclass depends on. Only these classes use the field
+		// cache. (default is false)
+		bool fieldCacheable;
+
+	public:
+		/**
+		 * Add a tab with the ROM image's hashes.
+		 * Called by RomData::fields() if showHashTab is set.
+		 */
+		void addHashTab(void);
+
 	public:
 		/** Convenience functions. **/
 
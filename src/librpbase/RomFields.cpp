@@ -483,6 +483,18 @@ RomFields::const_iterator RomFields::cend(void) const
 	return d->fields.cend();
 }
 
+/**
+ * Remove all fields and tabs.
+ */
+void RomFields::clear(void)
+{
+	RP_D(RomFields);
+	d->delete_data();
+	d->tabNames.clear();
+	d->tabIdx = 0;
+	d->def_lc = 0;
+}
+
 /** Convenience functions for RomData subclasses. **/
 
 /** Tabs **/
@@ -330,6 +330,11 @@ class RomFields
 		 */
 		const_iterator cend(void) const;
 
+		/**
+		 * Remove all fields and tabs.
+		 */
+		void clear(void);
+
 	public:
 		/**
 		 * Get the abbreviation of an age rating organization.
@@ -54,6 +54,33 @@ public:
 	}
 };
 
+/**
+ * Binary output using CBOR. (RFC 7049)
+ *
+ * The document layout is similar to JSONROMOutput, but all
+ * top-level keys are always present, and RomMetaData properties
+ * are included as a map of Property values.
+ */
+class CBORROMOutput {
+	const RomData *const romdata;
+	uint32_t lc;
+public:
+	explicit CBORROMOutput(const RomData *romdata, uint32_t lc = 0);
+	friend std::ostream& operator<<(std::ostream& os, const CBORROMOutput& fo);
+};
+
+/**
+ * CBOR error record, e.g. if a file couldn't be opened.
+ * This is written as a map with "error" and, if non-zero, "code".
+ */
+class CBORErrorOutput {
+	const char *const error;
+	int code;
+public:
+	explicit CBORErrorOutput(const char *error, int code = 0);
+	friend std::ostream& operator<<(std::ostream& os, const CBORErrorOutput& fo);
+};
+
 }
 
 #endif /* __ROMPROPERTIES_LIBRPBASE_TEXTOUT_HPP__ */
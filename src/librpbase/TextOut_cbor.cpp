@@ -0,0 +1,707 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * TextOut.hpp: Text output for RomData. (CBOR output)                     *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "TextOut.hpp"
+
+// C includes. (C++ namespace)
+#include <cassert>
+
+// C++ includes.
+using std::ostream;
+using std::string;
+using std::vector;
+
+// librpbase
+#include "RomData.hpp"
+#include "RomFields.hpp"
+#include "RomMetaData.hpp"
+#include "img/IconAnimData.hpp"
+
+// librptexture
+#include "librptexture/img/rp_image.hpp"
+using LibRpTexture::rp_image;
+
+namespace LibRpBase {
+
+/**
+ * Minimal CBOR (RFC 7049) writer.
+ *
+ * Only definite-length items are written, so the number of
+ * elements in each array and map must be known beforehand.
+ * Output is collected in a fixed-size buffer and written
+ * to the std::ostream in blocks.
+ */
+class CBORWriter {
+public:
+	explicit CBORWriter(ostream &os)
+		: os(os), pos(0) { }
+	~CBORWriter() { Flush(); }
+
+private:
+	RP_DISABLE_COPY(CBORWriter)
+
+public:
+	// Major types.
+	enum MajorType : uint8_t {
+		MT_UINT		= (0U << 5),
+		MT_NEGINT	= (1U << 5),
+		MT_BYTES	= (2U << 5),
+		MT_TEXT		= (3U << 5),
+		MT_ARRAY	= (4U << 5),
+		MT_MAP		= (5U << 5),
+		MT_TAG		= (6U << 5),
+		MT_SIMPLE	= (7U << 5),
+	};
+
+	// Tags.
+	enum CBORTag : uint8_t {
+		TAG_EPOCH_DATETIME	= 1,	// Epoch-based date/time
+	};
+
+private:
+	inline void Put(uint8_t c)
+	{
+		if (pos == sizeof(buf)) {
+			os.write(reinterpret_cast<const char*>(buf), pos);
+			pos = 0;
+		}
+		buf[pos++] = c;
+	}
+
+	void Write(const void *data, size_t size)
+	{
+		if (size > sizeof(buf) - pos) {
+			Flush();
+			if (size >= sizeof(buf)) {
+				// Too big for the buffer. Write it directly.
+				os.write(static_cast<const char*>(data), size);
+				return;
+			}
+		}
+		memcpy(&buf[pos], data, size);
+		pos += size;
+	}
+
+	/**
+	 * Write an initial byte and its argument.
+	 * The shortest possible encoding is used.
+	 * @param mt Major type.
+	 * @param val Argument.
+	 */
+	void Head(MajorType mt, uint64_t val)
+	{
+		if (val < 24) {
+			Put(mt | static_cast<uint8_t>(val));
+			return;
+		}
+
+		uint8_t tmp[9];
+		unsigned int len;
+		if (val <= 0xFFU) {
+			tmp[0] = mt | 24;
+			len = 1;
+		} else if (val <= 0xFFFFU) {
+			tmp[0] = mt | 25;
+			len = 2;
+		} else if (val <= 0xFFFFFFFFU) {
+			tmp[0] = mt | 26;
+			len = 4;
+		} else {
+			tmp[0] = mt | 27;
+			len = 8;
+		}
+
+		// Big-endian argument.
+		for (unsigned int i = len; i > 0; i--, val >>= 8) {
+			tmp[i] = static_cast<uint8_t>(val & 0xFF);
+		}
+		Write(tmp, len + 1);
+	}
+
+public:
+	void Flush(void)
+	{
+		if (pos > 0) {
+			os.write(reinterpret_cast<const char*>(buf), pos);
+			pos = 0;
+		}
+	}
+
+	inline void Uint(uint64_t val)
+	{
+		Head(MT_UINT, val);
+	}
+
+	inline void Int(int64_t val)
+	{
+		if (val >= 0) {
+			Head(MT_UINT, static_cast<uint64_t>(val));
+		} else {
+			// Negative integers are encoded as (-1 - val).
+			Head(MT_NEGINT, ~static_cast<uint64_t>(val));
+		}
+	}
+
+	inline void String(const char *str, size_t len)
+	{
+		Head(MT_TEXT, len);
+		Write(str, len);
+	}
+
+	inline void String(const char *str)
+	{
+		String(str, strlen(str));
+	}
+
+	inline void String(const string &str)
+	{
+		String(str.data(), str.size());
+	}
+
+	inline void Bool(bool val)
+	{
+		Put(MT_SIMPLE | (val ? 21 : 20));
+	}
+
+	inline void Null(void)
+	{
+		Put(MT_SIMPLE | 22);
+	}
+
+	inline void StartArray(size_t count)
+	{
+		Head(MT_ARRAY, count);
+	}
+
+	inline void StartMap(size_t count)
+	{
+		Head(MT_MAP, count);
+	}
+
+	inline void Tag(CBORTag tag)
+	{
+		Head(MT_TAG, tag);
+	}
+
+	/**
+	 * Write a date/time value. (epoch-based)
+	 * @param timestamp UNIX timestamp.
+	 */
+	inline void DateTime(int64_t timestamp)
+	{
+		Tag(TAG_EPOCH_DATETIME);
+		Int(timestamp);
+	}
+
+private:
+	ostream &os;
+	size_t pos;
+	uint8_t buf[16384];
+};
+
+class CBORFieldsOutput {
+	const RomFields& fields;
+public:
+	explicit CBORFieldsOutput(const RomFields& fields) :fields(fields) {}
+
+private:
+	/**
+	 * Write a language code as a CBOR string.
+	 * @param writer CBOR writer.
+	 * @param lc Language code.
+	 */
+	static void writeLc(CBORWriter &writer, uint32_t lc)
+	{
+		char s_lc[8];
+		int s_lc_pos = 0;
+		for (; lc != 0; lc <<= 8) {
+			char chr = (char)(lc >> 24);
+			if (chr != 0) {
+				s_lc[s_lc_pos++] = chr;
+			}
+		}
+
+		writer.String(s_lc, s_lc_pos);
+	}
+
+	/**
+	 * Write ListData rows as a CBOR array.
+	 * If there's no data, null is written instead.
+	 * @param writer CBOR writer.
+	 * @param field RomFields::Field
+	 * @param list_data ListData.
+	 */
+	static void writeListData(CBORWriter &writer, const RomFields::Field &field,
+		const RomFields::ListData_t *list_data)
+	{
+		assert(list_data != nullptr);
+		if (!list_data) {
+			// No data...
+			writer.Null();
+			return;
+		}
+
+		// NOTE: Checkbox states are written as the first column,
+		// same as JSON output.
+		writer.StartArray(list_data->size());	// data
+		const bool has_checkboxes = !!(field.desc.list_data.flags & RomFields::RFT_LISTDATA_CHECKBOXES);
+		uint32_t checkboxes = field.data.list_data.mxd.checkboxes;
+		const auto list_data_cend = list_data->cend();
+		for (auto it = list_data->cbegin(); it != list_data_cend; ++it) {
+			writer.StartArray(it->size() + (has_checkboxes ? 1 : 0));
+			if (has_checkboxes) {
+				writer.Bool((checkboxes & 1) ? true : false);
+				checkboxes >>= 1;
+			}
+
+			const auto it_cend = it->cend();
+			for (auto jt = it->cbegin(); jt != it_cend; ++jt) {
+				writer.String(*jt);
+			}
+		}
+	}
+
+public:
+	/**
+	 * Count the fields to write.
+	 * @return Number of valid fields.
+	 */
+	size_t validFieldCount(void) const
+	{
+		size_t count = 0;
+		const auto fields_cend = fields.cend();
+		for (auto iter = fields.cbegin(); iter != fields_cend; ++iter) {
+			if (iter->isValid)
+				count++;
+		}
+		return count;
+	}
+
+	void writeToCBOR(CBORWriter &writer)
+	{
+		writer.StartArray(validFieldCount());	// fields
+
+		const auto fields_cend = fields.cend();
+		for (auto iter = fields.cbegin(); iter != fields_cend; ++iter) {
+			const auto &romField = *iter;
+			if (!romField.isValid)
+				continue;
+
+			// Each field has the same five keys:
+			// type, name, tab, desc, data
+			writer.StartMap(5);	// field
+
+			writer.String("type");
+			switch (romField.type) {
+				case RomFields::RFT_STRING:		writer.String("STRING"); break;
+				case RomFields::RFT_BITFIELD:		writer.String("BITFIELD"); break;
+				case RomFields::RFT_LISTDATA:		writer.String("LISTDATA"); break;
+				case RomFields::RFT_DATETIME:		writer.String("DATETIME"); break;
+				case RomFields::RFT_AGE_RATINGS:	writer.String("AGE_RATINGS"); break;
+				case RomFields::RFT_DIMENSIONS:		writer.String("DIMENSIONS"); break;
+				case RomFields::RFT_STRING_MULTI:	writer.String("STRING_MULTI"); break;
+				case RomFields::RFT_INVALID:
+					assert(!"INVALID field type");
+					writer.String("INVALID");
+					break;
+				default:
+					assert(!"Unknown RomFieldType");
+					writer.String("NYI");
+					break;
+			}
+
+			writer.String("name"); writer.String(romField.name);
+			writer.String("tab"); writer.Uint(romField.tabIdx);
+
+			writer.String("desc");
+			switch (romField.type) {
+				case RomFields::RFT_STRING: {
+					writer.StartMap(1);
+					writer.String("format"); writer.Uint(romField.desc.flags);
+
+					writer.String("data");
+					if (romField.data.str) {
+						writer.String(*(romField.data.str));
+					} else {
+						writer.Null();
+					}
+					break;
+				}
+
+				case RomFields::RFT_BITFIELD: {
+					const auto &bitfieldDesc = romField.desc.bitfield;
+					writer.StartMap(2);
+					writer.String("elementsPerRow"); writer.Int(bitfieldDesc.elemsPerRow);
+
+					// NOTE: Empty names are written as null so the
+					// array index matches the bit number.
+					writer.String("names");
+					assert(bitfieldDesc.names != nullptr);
+					if (bitfieldDesc.names) {
+						writer.StartArray(bitfieldDesc.names->size());	// names
+						const auto names_cend = bitfieldDesc.names->cend();
+						for (auto iter = bitfieldDesc.names->cbegin(); iter != names_cend; ++iter) {
+							if (!iter->empty()) {
+								writer.String(*iter);
+							} else {
+								writer.Null();
+							}
+						}
+					} else {
+						writer.Null();
+					}
+
+					writer.String("data"); writer.Uint(romField.data.bitfield);
+					break;
+				}
+
+				case RomFields::RFT_LISTDATA: {
+					const auto &listDataDesc = romField.desc.list_data;
+					writer.StartMap(2);
+					writer.String("flags"); writer.Uint(listDataDesc.flags);
+
+					writer.String("names");
+					if (listDataDesc.names) {
+						const bool has_checkboxes = !!(listDataDesc.flags & RomFields::RFT_LISTDATA_CHECKBOXES);
+						writer.StartArray(listDataDesc.names->size() + (has_checkboxes ? 1 : 0));
+						if (has_checkboxes) {
+							writer.String("checked");
+						}
+						const auto names_cend = listDataDesc.names->cend();
+						for (auto iter = listDataDesc.names->cbegin();
+						     iter != names_cend; ++iter)
+						{
+							writer.String(*iter);
+						}
+					} else {
+						writer.Null();
+					}
+
+					writer.String("data");
+					if (!(listDataDesc.flags & RomFields::RFT_LISTDATA_MULTI)) {
+						// Single-language ListData.
+						writeListData(writer, romField, romField.data.list_data.data.single);
+					} else {
+						// Multi-language ListData.
+						const auto *const list_data = romField.data.list_data.data.multi;
+						assert(list_data != nullptr);
+						if (!list_data) {
+							// No data...
+							writer.Null();
+							break;
+						}
+
+						writer.StartMap(list_data->size());	// data
+						const auto list_data_cend = list_data->cend();
+						for (auto mapIter = list_data->cbegin(); mapIter != list_data_cend; ++mapIter) {
+							// Key: Language code
+							// Value: Vector of string data
+							writeLc(writer, mapIter->first);
+							writeListData(writer, romField, &mapIter->second);
+						}
+					}
+					break;
+				}
+
+				case RomFields::RFT_DATETIME: {
+					writer.StartMap(1);
+					writer.String("flags"); writer.Uint(romField.desc.flags);
+
+					writer.String("data");
+					if (romField.data.date_time != -1) {
+						writer.DateTime(static_cast<int64_t>(romField.data.date_time));
+					} else {
+						// Invalid date/time.
+						writer.Null();
+					}
+					break;
+				}
+
+				case RomFields::RFT_AGE_RATINGS: {
+					writer.StartMap(0);
+
+					writer.String("data");
+					const RomFields::age_ratings_t *age_ratings = romField.data.age_ratings;
+					assert(age_ratings != nullptr);
+					if (!age_ratings) {
+						writer.Null();
+						break;
+					}
+
+					// Count the active age ratings first.
+					const unsigned int age_ratings_max = static_cast<unsigned int>(age_ratings->size());
+					size_t count = 0;
+					for (unsigned int j = 0; j < age_ratings_max; j++) {
+						if (age_ratings->at(j) & RomFields::AGEBF_ACTIVE)
+							count++;
+					}
+
+					writer.StartArray(count);	// data
+					for (unsigned int j = 0; j < age_ratings_max; j++) {
+						const uint16_t rating = age_ratings->at(j);
+						if (!(rating & RomFields::AGEBF_ACTIVE))
+							continue;
+
+						writer.StartMap(3);
+						writer.String("name");
+						const char *const abbrev = RomFields::ageRatingAbbrev(j);
+						if (abbrev) {
+							writer.String(abbrev);
+						} else {
+							// Invalid age rating.
+							// Use the numeric index.
+							writer.Uint(j);
+						}
+
+						writer.String("rating");
+						writer.String(RomFields::ageRatingDecode(j, rating));
+						writer.String("raw");
+						writer.Uint(rating);
+					}
+					break;
+				}
+
+				case RomFields::RFT_DIMENSIONS: {
+					writer.StartMap(0);
+
+					// Unused dimensions are omitted.
+					const int *const dimensions = romField.data.dimensions;
+					writer.String("data");
+					const unsigned int count = (dimensions[1] > 0 ? (dimensions[2] > 0 ? 3 : 2) : 1);
+					writer.StartArray(count);
+					for (unsigned int j = 0; j < count; j++) {
+						writer.Int(dimensions[j]);
+					}
+					break;
+				}
+
+				case RomFields::RFT_STRING_MULTI: {
+					writer.StartMap(1);
+					writer.String("format"); writer.Uint(romField.desc.flags);
+
+					writer.String("data");
+					const auto *const pStr_multi = romField.data.str_multi;
+					assert(pStr_multi != nullptr);
+					if (!pStr_multi) {
+						writer.Null();
+						break;
+					}
+
+					writer.StartMap(pStr_multi->size());
+					const auto pStr_multi_cend = pStr_multi->cend();
+					for (auto iter = pStr_multi->cbegin(); iter != pStr_multi_cend; ++iter) {
+						writeLc(writer, iter->first);
+						writer.String(iter->second);
+					}
+					break;
+				}
+
+				default: {
+					writer.StartMap(0);
+					writer.String("data"); writer.Null();
+					break;
+				}
+			}
+		}
+	}
+};
+
+/**
+ * Write RomMetaData properties as a CBOR map.
+ * Keys are Property values; values are integers, strings,
+ * or epoch-based date/time values.
+ * @param writer CBOR writer.
+ * @param metaData RomMetaData. (may be nullptr)
+ */
+static void writeMetaData(CBORWriter &writer, const RomMetaData *metaData)
+{
+	const int count = (metaData ? metaData->count() : 0);
+	writer.StartMap(count);
+	for (int i = 0; i < count; i++) {
+		const RomMetaData::MetaData *const prop = metaData->prop(i);
+		assert(prop != nullptr);
+		if (!prop) {
+			// Keep the map count consistent.
+			writer.Uint(Property::Empty);
+			writer.Null();
+			continue;
+		}
+
+		writer.Uint(prop->name);
+		switch (prop->type) {
+			case PropertyType::Integer:
+				writer.Int(prop->data.ivalue);
+				break;
+			case PropertyType::UnsignedInteger:
+				writer.Uint(prop->data.uvalue);
+				break;
+			case PropertyType::String:
+				if (prop->data.str) {
+					writer.String(*prop->data.str);
+				} else {
+					writer.Null();
+				}
+				break;
+			case PropertyType::Timestamp:
+				writer.DateTime(static_cast<int64_t>(prop->data.timestamp));
+				break;
+			default:
+				assert(!"Unsupported PropertyType");
+				writer.Null();
+				break;
+		}
+	}
+}
+
+CBORROMOutput::CBORROMOutput(const RomData *romdata, uint32_t lc)
+	: romdata(romdata)
+	, lc(lc) { }
+std::ostream& operator<<(std::ostream& os, const CBORROMOutput& fo) {
+	auto romdata = fo.romdata;
+	assert(romdata && romdata->isValid());
+
+	const char *const systemName = romdata->systemName(RomData::SYSNAME_TYPE_LONG | RomData::SYSNAME_REGION_ROM_LOCAL);
+	const char *const fileType = romdata->fileType_string();
+	assert(systemName != nullptr);
+	assert(fileType != nullptr);
+
+	// Find valid internal images and external image URLs first,
+	// since CBOR arrays need to know the element count.
+	// NOTE: RomData caches internal images, so this doesn't
+	// load the images twice.
+	const uint32_t imgbf = romdata->supportedImageTypes();
+	vector<std::pair<RomData::ImageType, const rp_image*> > imgints;
+	vector<std::pair<RomData::ImageType, vector<RomData::ExtURL> > > imgexts;
+	if (imgbf != 0) {
+		for (int i = RomData::IMG_INT_MIN; i <= RomData::IMG_INT_MAX; i++) {
+			if (!(imgbf & (1U << i)))
+				continue;
+
+			auto image = romdata->image((RomData::ImageType)i);
+			if (!image || !image->isValid())
+				continue;
+
+			imgints.emplace_back((RomData::ImageType)i, image);
+		}
+
+		vector<RomData::ExtURL> extURLs;
+		for (int i = RomData::IMG_EXT_MIN; i <= RomData::IMG_EXT_MAX; i++) {
+			if (!(imgbf & (1U << i)))
+				continue;
+
+			// NOTE: extURLs may be empty even though the class supports it.
+			extURLs.clear();
+			int ret = romdata->extURLs((RomData::ImageType)i, &extURLs, RomData::IMAGE_SIZE_DEFAULT);
+			if (ret != 0 || extURLs.empty())
+				continue;
+
+			imgexts.emplace_back((RomData::ImageType)i, std::move(extURLs));
+		}
+	}
+
+	CBORWriter writer(os);
+
+	// All top-level keys are always present, even if empty.
+	writer.StartMap(6);	// document
+	writer.String("system"); writer.String(systemName ? systemName : "unknown");
+	writer.String("filetype"); writer.String(fileType ? fileType : "unknown");
+
+	// Fields.
+	writer.String("fields");
+	const RomFields *const fields = romdata->fields();
+	assert(fields != nullptr);
+	if (fields) {
+		CBORFieldsOutput fieldsOut(*fields);
+		fieldsOut.writeToCBOR(writer);
+	} else {
+		writer.StartArray(0);
+	}
+
+	// Metadata.
+	writer.String("metadata");
+	writeMetaData(writer, romdata->metaData());
+
+	// Internal images.
+	writer.String("imgint"); writer.StartArray(imgints.size());
+	const auto imgints_cend = imgints.cend();
+	for (auto iter = imgints.cbegin(); iter != imgints_cend; ++iter) {
+		const RomData::ImageType imageType = iter->first;
+		const rp_image *const image = iter->second;
+
+		const uint32_t ppf = romdata->imgpf(imageType);
+		const IconAnimData *const animdata = (ppf & RomData::IMGPF_ICON_ANIMATED)
+			? romdata->iconAnimData() : nullptr;
+
+		writer.StartMap(animdata ? 7 : 4);
+		writer.String("type"); writer.String(RomData::getImageTypeName(imageType));
+		writer.String("format"); writer.String(rp_image::getFormatName(image->format()));
+
+		writer.String("size"); writer.StartArray(2);
+		writer.Int(image->width());
+		writer.Int(image->height());
+
+		writer.String("postprocessing"); writer.Uint(ppf);
+
+		if (animdata) {
+			writer.String("frames"); writer.Int(animdata->count);
+
+			writer.String("sequence"); writer.StartArray(animdata->seq_count);
+			for (int j = 0; j < animdata->seq_count; j++) {
+				writer.Uint(animdata->seq_index[j]);
+			}
+
+			writer.String("delay"); writer.StartArray(animdata->seq_count);
+			for (int j = 0; j < animdata->seq_count; j++) {
+				writer.Int(animdata->delays[j].ms);
+			}
+		}
+	}
+
+	// External images.
+	// NOTE: Unlike JSON output, each URL is a separate map,
+	// since duplicate map keys aren't allowed in CBOR.
+	writer.String("imgext"); writer.StartArray(imgexts.size());
+	const auto imgexts_cend = imgexts.cend();
+	for (auto iter = imgexts.cbegin(); iter != imgexts_cend; ++iter) {
+		writer.StartMap(2);
+		writer.String("type"); writer.String(RomData::getImageTypeName(iter->first));
+
+		writer.String("exturls"); writer.StartArray(iter->second.size());
+		const auto extURLs_cend = iter->second.cend();
+		for (auto urlIter = iter->second.cbegin(); urlIter != extURLs_cend; ++urlIter) {
+			writer.StartMap(2);
+			writer.String("url"); writer.String(urlPartialUnescape(urlIter->url));
+			writer.String("cache_key"); writer.String(urlIter->cache_key);
+		}
+	}
+
+	writer.Flush();
+	os.flush();
+	return os;
+}
+
+CBORErrorOutput::CBORErrorOutput(const char *error, int code)
+	: error(error)
+	, code(code) { }
+std::ostream& operator<<(std::ostream& os, const CBORErrorOutput& fo) {
+	assert(fo.error != nullptr);
+
+	CBORWriter writer(os);
+	writer.StartMap(fo.code != 0 ? 2 : 1);
+	writer.String("error"); writer.String(fo.error ? fo.error : "unknown");
+	if (fo.code != 0) {
+		writer.String("code"); writer.Int(fo.code);
+	}
+
+	writer.Flush();
+	os.flush();
+	return os;
+}
+
+}
@@ -30,21 +30,78 @@ using std::vector;
 using LibRpTexture::rp_image;
 
 // rapidjson
-#include "rapidjson/document.h"
-#include "rapidjson/ostreamwrapper.h"
 #include "rapidjson/prettywriter.h"
 using namespace rapidjson;
 
 namespace LibRpBase {
 
-template<typename Allocator>
+/**
+ * Buffered std::ostream wrapper for rapidjson.
+ *
+ * rapidjson's OStreamWrapper calls ostream::put() for every
+ * character, which is slow. This wrapper collects characters
+ * in a fixed-size buffer and writes them in blocks.
+ */
+class BufferedOStreamWrapper {
+public:
+	typedef char Ch;
+	explicit BufferedOStreamWrapper(ostream &os)
+		: os(os), pos(0) { }
+	~BufferedOStreamWrapper() { Flush(); }
+
+private:
+	RP_DISABLE_COPY(BufferedOStreamWrapper)
+
+public:
+	inline void Put(Ch c)
+	{
+		if (pos == sizeof(buf)) {
+			os.write(buf, pos);
+			pos = 0;
+		}
+		buf[pos++] = c;
+	}
+
+	void Flush(void)
+	{
+		if (pos > 0) {
+			os.write(buf, pos);
+			pos = 0;
+		}
+	}
+
+	// Not implemented
+	char Peek() const { assert(false); return 0; }
+	char Take() { assert(false); return 0; }
+	size_t Tell() const { assert(false); return 0; }
+	char* PutBegin() { assert(false); return 0; }
+	size_t PutEnd(char*) { assert(false); return 0; }
+
+private:
+	ostream &os;
+	size_t pos;
+	char buf[16384];
+};
+
+typedef PrettyWriter<BufferedOStreamWrapper> JSONWriter;
+
+/**
+ * Write a string to a JSON writer.
+ * @param writer JSON writer.
+ * @param str String.
+ */
+static inline void writeString(JSONWriter &writer, const string &str)
+{
+	writer.String(str.data(), static_cast<SizeType>(str.size()));
+}
+
 class JSONFieldsOutput {
 	const RomFields& fields;
 public:
 	explicit JSONFieldsOutput(const RomFields& fields) :fields(fields) {}
 
 private:
-	static Value lcToValue(uint32_t lc, Allocator &allocator)
+	static void writeLcKey(JSONWriter &writer, uint32_t lc)
 	{
 		char s_lc[8];
 		int s_lc_pos = 0;
@@ -56,283 +113,306 @@ private:
 		}
 		s_lc[s_lc_pos] = '\0';
 
-		Value s_lc_name;
-		s_lc_name.SetString(s_lc, s_lc_pos, allocator);
-		return s_lc_name;
+		writer.Key(s_lc, static_cast<SizeType>(s_lc_pos));
 	}
 
-	static Value listDataToValue(const RomFields::Field &field,
-		const RomFields::ListData_t *list_data, Allocator &allocator)
+	/**
+	 * Write ListData rows as a JSON array.
+	 * If there's no data, "ERROR" is written instead.
+	 * @param writer JSON writer.
+	 * @param field RomFields::Field
+	 * @param list_data ListData.
+	 */
+	static void writeListData(JSONWriter &writer, const RomFields::Field &field,
+		const RomFields::ListData_t *list_data)
 	{
-		Value data_array(kArrayType);	// data
 		assert(list_data != nullptr);
-		if (!list_data) {
+		if (!list_data || list_data->empty()) {
 			// No data...
-			return data_array;
+			writer.String("ERROR");
+			return;
 		}
 
+		writer.StartArray();	// data
 		const bool has_checkboxes = !!(field.desc.list_data.flags & RomFields::RFT_LISTDATA_CHECKBOXES);
 		uint32_t checkboxes = field.data.list_data.mxd.checkboxes;
 		const auto list_data_cend = list_data->cend();
 		for (auto it = list_data->cbegin(); it != list_data_cend; ++it) {
-			Value row_array(kArrayType);
+			writer.StartArray();
 			if (has_checkboxes) {
 				// TODO: Better JSON schema for RFT_LISTDATA_CHECKBOXES?
-				row_array.PushBack((checkboxes & 1) ? true : false, allocator);
+				writer.Bool((checkboxes & 1) ? true : false);
 				checkboxes >>= 1;
 			}
 
 			const auto it_cend = it->cend();
 			for (auto jt = it->cbegin(); jt != it_cend; ++jt) {
-				row_array.PushBack(StringRef(*jt), allocator);
+				writeString(writer, *jt);
 			}
 
-			data_array.PushBack(row_array, allocator);
+			writer.EndArray();
 		}
-
-		return data_array;
+		writer.EndArray();
 	}
 
 public:
-	void writeToJSON(Value &fields_array, Allocator &allocator)
+	/**
+	 * Are there any fields to write?
+	 * @return True if at least one field is valid.
+	 */
+	bool hasValidFields(void) const
 	{
+		const auto fields_cend = fields.cend();
+		for (auto iter = fields.cbegin(); iter != fields_cend; ++iter) {
+			if (iter->isValid)
+				return true;
+		}
+		return false;
+	}
+
+	void writeToJSON(JSONWriter &writer)
+	{
+		writer.StartArray();	// fields
+
 		const auto fields_cend = fields.cend();
 		for (auto iter = fields.cbegin(); iter != fields_cend; ++iter) {
 			const auto &romField = *iter;
 			if (!romField.isValid)
 				continue;
 
-			Value field_obj(kObjectType);	// field
+			writer.StartObject();	// field
 
 			switch (romField.type) {
 				case RomFields::RFT_INVALID: {
 					assert(!"INVALID field type");
-					field_obj.AddMember("type", "INVALID", allocator);
+					writer.Key("type"); writer.String("INVALID");
 					break;
 				}
 
 				case RomFields::RFT_STRING: {
-					field_obj.AddMember("type", "STRING", allocator);
+					writer.Key("type"); writer.String("STRING");
 
-					Value desc_obj(kObjectType);	// desc
-					desc_obj.AddMember("name", StringRef(romField.name), allocator);
-					desc_obj.AddMember("format", romField.desc.flags, allocator);
-					field_obj.AddMember("desc", desc_obj, allocator);
+					writer.Key("desc"); writer.StartObject();
+					writer.Key("name"); writeString(writer, romField.name);
+					writer.Key("format"); writer.Uint(romField.desc.flags);
+					writer.EndObject();
 
-					field_obj.AddMember("data", StringRef(*(romField.data.str)), allocator);
+					writer.Key("data");
+					if (romField.data.str) {
+						writeString(writer, *(romField.data.str));
+					} else {
+						writer.String("");
+					}
 					break;
 				}
 
 				case RomFields::RFT_BITFIELD: {
-					field_obj.AddMember("type", "BITFIELD", allocator);
+					writer.Key("type"); writer.String("BITFIELD");
 					const auto &bitfieldDesc = romField.desc.bitfield;
 
-					Value desc_obj(kObjectType);	// desc
-					desc_obj.AddMember("name", StringRef(romField.name), allocator);
-					desc_obj.AddMember("elementsPerRow", bitfieldDesc.elemsPerRow, allocator);
+					writer.Key("desc"); writer.StartObject();
+					writer.Key("name"); writeString(writer, romField.name);
+					writer.Key("elementsPerRow"); writer.Int(bitfieldDesc.elemsPerRow);
 
+					// Check if we have any names first.
+					// If not, "ERROR" is written instead of an array.
+					// NOTE: The bitfield data is 32-bit, so only the
+					// first 32 names are used.
 					assert(bitfieldDesc.names != nullptr);
+					bool hasNames = false;
+					vector<string>::const_iterator names_cbegin, names_cend;
 					if (bitfieldDesc.names) {
-						Value names_array(kArrayType);	// names
 						unsigned int count = static_cast<unsigned int>(bitfieldDesc.names->size());
 						assert(count <= 32);
 						if (count > 32)
 							count = 32;
-						const auto names_cend = bitfieldDesc.names->cend();
-						for (auto iter = bitfieldDesc.names->cbegin(); iter != names_cend; ++iter) {
+						names_cbegin = bitfieldDesc.names->cbegin();
+						names_cend = names_cbegin + count;
+						for (auto iter = names_cbegin; iter != names_cend; ++iter) {
+							if (!iter->empty()) {
+								hasNames = true;
+								break;
+							}
+						}
+					}
+
+					writer.Key("names");
+					if (hasNames) {
+						writer.StartArray();	// names
+						for (auto iter = names_cbegin; iter != names_cend; ++iter) {
 							const string &name = *iter;
 							if (name.empty())
 								continue;
 
-							names_array.PushBack(StringRef(name), allocator);
-						}
-						if (!names_array.Empty()) {
-							desc_obj.AddMember("names", names_array, allocator);
-						} else {
-							desc_obj.AddMember("names", "ERROR", allocator);
+							writeString(writer, name);
 						}
+						writer.EndArray();
 					} else {
-						desc_obj.AddMember("names", "ERROR", allocator);
+						writer.String("ERROR");
 					}
+					writer.EndObject();
 
-					field_obj.AddMember("desc", desc_obj, allocator);
-					field_obj.AddMember("data", romField.data.bitfield, allocator);
+					writer.Key("data"); writer.Uint(romField.data.bitfield);
 					break;
 				}
 
 				case RomFields::RFT_LISTDATA: {
-					field_obj.AddMember("type", "LISTDATA", allocator);
+					writer.Key("type"); writer.String("LISTDATA");
 					const auto &listDataDesc = romField.desc.list_data;
 
-					Value desc_obj(kObjectType);	// desc
-					desc_obj.AddMember("name", StringRef(romField.name), allocator);
+					writer.Key("desc"); writer.StartObject();
+					writer.Key("name"); writeString(writer, romField.name);
 
-					Value names_array(kArrayType);	// names
+					writer.Key("names"); writer.StartArray();
 					if (listDataDesc.names) {
 						if (listDataDesc.flags & RomFields::RFT_LISTDATA_CHECKBOXES) {
 							// TODO: Better JSON schema for RFT_LISTDATA_CHECKBOXES?
-							names_array.PushBack("checked", allocator);
+							writer.String("checked");
 						}
 						const auto names_cend = listDataDesc.names->cend();
 						for (auto iter = listDataDesc.names->cbegin();
 						     iter != names_cend; ++iter)
 						{
-							const string &name = *iter;
-							names_array.PushBack(StringRef(name), allocator);
+							writeString(writer, *iter);
 						}
 					}
-					desc_obj.AddMember("names", names_array, allocator);
-					field_obj.AddMember("desc", desc_obj, allocator);
+					writer.EndArray();
+					writer.EndObject();
 
+					writer.Key("data");
 					if (!(listDataDesc.flags & RomFields::RFT_LISTDATA_MULTI)) {
 						// Single-language ListData.
-						Value data_array = listDataToValue(romField,
-							romField.data.list_data.data.single, allocator);
-						if (!data_array.Empty()) {
-							field_obj.AddMember("data", data_array, allocator);
-						} else {
-							// No data...
-							field_obj.AddMember("data", "ERROR", allocator);
-							break;
-						}
+						writeListData(writer, romField, romField.data.list_data.data.single);
 					} else {
 						// Multi-language ListData.
-						Value data_obj(kObjectType);	// data
 						const auto *const list_data = romField.data.list_data.data.multi;
 						assert(list_data != nullptr);
 						if (!list_data) {
 							// No data...
-							field_obj.AddMember("data", "ERROR", allocator);
+							writer.String("ERROR");
 							break;
 						}
 
+						writer.StartObject();	// data
 						const auto list_data_cend = list_data->cend();
 						for (auto mapIter = list_data->cbegin(); mapIter != list_data_cend; ++mapIter) {
 							// Key: Language code
 							// Value: Vector of string data
-							Value s_lc_name = lcToValue(mapIter->first, allocator);
-
-							Value lc_array = listDataToValue(romField,
-								&mapIter->second, allocator);
-							if (!lc_array.Empty()) {
-								data_obj.AddMember(s_lc_name, lc_array, allocator);
-							} else {
-								// No data...
-								data_obj.AddMember(s_lc_name, "ERROR", allocator);
-								continue;
-							}
+							writeLcKey(writer, mapIter->first);
+							writeListData(writer, romField, &mapIter->second);
 						}
-
-						field_obj.AddMember("data", data_obj, allocator);
+						writer.EndObject();
 					}
 					break;
 				}
 
 				case RomFields::RFT_DATETIME: {
-					field_obj.AddMember("type", "DATETIME", allocator);
+					writer.Key("type"); writer.String("DATETIME");
 
-					Value desc_obj(kObjectType);	// desc
-					desc_obj.AddMember("name", StringRef(romField.name), allocator);
-					desc_obj.AddMember("flags", romField.desc.flags, allocator);
-					field_obj.AddMember("desc", desc_obj, allocator);
+					writer.Key("desc"); writer.StartObject();
+					writer.Key("name"); writeString(writer, romField.name);
+					writer.Key("flags"); writer.Uint(romField.desc.flags);
+					writer.EndObject();
 
-					field_obj.AddMember("data", static_cast<int64_t>(romField.data.date_time), allocator);
+					writer.Key("data"); writer.Int64(static_cast<int64_t>(romField.data.date_time));
 					break;
 				}
 
 				case RomFields::RFT_AGE_RATINGS: {
-					field_obj.AddMember("type", "AGE_RATINGS", allocator);
+					writer.Key("type"); writer.String("AGE_RATINGS");
 
-					Value desc_obj(kObjectType);	// desc
-					desc_obj.AddMember("name", StringRef(romField.name), allocator);
-					field_obj.AddMember("desc", desc_obj, allocator);
+					writer.Key("desc"); writer.StartObject();
+					writer.Key("name"); writeString(writer, romField.name);
+					writer.EndObject();
 
+					writer.Key("data");
 					const RomFields::age_ratings_t *age_ratings = romField.data.age_ratings;
 					assert(age_ratings != nullptr);
 					if (!age_ratings) {
-						field_obj.AddMember("data", "ERROR", allocator);
+						writer.String("ERROR");
 						break;
 					}
 
-					Value data_array(kArrayType);	// data
+					writer.StartArray();	// data
 					const unsigned int age_ratings_max = static_cast<unsigned int>(age_ratings->size());
 					for (unsigned int j = 0; j < age_ratings_max; j++) {
 						const uint16_t rating = age_ratings->at(j);
 						if (!(rating & RomFields::AGEBF_ACTIVE))
 							continue;
 
-						Value rating_obj(kObjectType);
+						writer.StartObject();
+						writer.Key("name");
 						const char *const abbrev = RomFields::ageRatingAbbrev(j);
 						if (abbrev) {
-							rating_obj.AddMember("name", StringRef(abbrev), allocator);
+							writer.String(abbrev);
 						} else {
 							// Invalid age rating.
 							// Use the numeric index.
-							rating_obj.AddMember("name", j, allocator);
+							writer.Uint(j);
 						}
 
-						const string s_age_rating = RomFields::ageRatingDecode(j, rating);
-						Value rating_val;
-						rating_val.SetString(s_age_rating, allocator);
-						rating_obj.AddMember("rating", rating_val, allocator);
-
-						data_array.PushBack(rating_obj, allocator);
+						writer.Key("rating");
+						writeString(writer, RomFields::ageRatingDecode(j, rating));
+						writer.EndObject();
 					}
-
-					field_obj.AddMember("data", data_array, allocator);
+					writer.EndArray();
 					break;
 				}
 
 				case RomFields::RFT_DIMENSIONS: {
-					field_obj.AddMember("type", "DIMENSIONS", allocator);
+					writer.Key("type"); writer.String("DIMENSIONS");
 
 					const int *const dimensions = romField.data.dimensions;
-					Value data_obj(kObjectType);	// data
-					data_obj.AddMember("w", dimensions[0], allocator);
+					writer.Key("data"); writer.StartObject();
+					writer.Key("w"); writer.Int(dimensions[0]);
 					if (dimensions[1] > 0) {
-						data_obj.AddMember("h", dimensions[1], allocator);
+						writer.Key("h"); writer.Int(dimensions[1]);
 						if (dimensions[2] > 0) {
-							data_obj.AddMember("d", dimensions[2], allocator);
+							writer.Key("d"); writer.Int(dimensions[2]);
 						}
 					}
-					field_obj.AddMember("data", data_obj, allocator);
+					writer.EndObject();
 					break;
 				}
 
 				case RomFields::RFT_STRING_MULTI: {
 					// TODO: Act like RFT_STRING if there's only one language?
-					field_obj.AddMember("type", "STRING_MULTI", allocator);
+					writer.Key("type"); writer.String("STRING_MULTI");
 
-					Value desc_obj(kObjectType);	// desc
-					desc_obj.AddMember("name", StringRef(romField.name), allocator);
-					desc_obj.AddMember("format", romField.desc.flags, allocator);
-					field_obj.AddMember("desc", desc_obj, allocator);
+					writer.Key("desc"); writer.StartObject();
+					writer.Key("name"); writeString(writer, romField.name);
+					writer.Key("format"); writer.Uint(romField.desc.flags);
+					writer.EndObject();
 
-					Value data_obj(kObjectType);	// data
+					writer.Key("data"); writer.StartObject();
 					const auto *const pStr_multi = romField.data.str_multi;
-					const auto pStr_multi_cend = pStr_multi->cend();
-					for (auto iter = pStr_multi->cbegin(); iter != pStr_multi_cend; ++iter) {
-						Value s_lc_name = lcToValue(iter->first, allocator);
-						data_obj.AddMember(s_lc_name, StringRef(iter->second), allocator);
+					assert(pStr_multi != nullptr);
+					if (pStr_multi) {
+						const auto pStr_multi_cend = pStr_multi->cend();
+						for (auto iter = pStr_multi->cbegin(); iter != pStr_multi_cend; ++iter) {
+							writeLcKey(writer, iter->first);
+							writeString(writer, iter->second);
+						}
 					}
-
-					field_obj.AddMember("data", data_obj, allocator);
+					writer.EndObject();
 					break;
 				}
 
 				default: {
 					assert(!"Unknown RomFieldType");
-					field_obj.AddMember("type", "NYI", allocator);
+					writer.Key("type"); writer.String("NYI");
 
-					Value desc_obj(kObjectType);	// desc
-					desc_obj.AddMember("name", StringRef(romField.name), allocator);
-					field_obj.AddMember("desc", desc_obj, allocator);
+					writer.Key("desc"); writer.StartObject();
+					writer.Key("name"); writeString(writer, romField.name);
+					writer.EndObject();
 					break;
 				}
 			}
 
-			fields_array.PushBack(field_obj, allocator);
+			writer.EndObject();
 		}
+
+		writer.EndArray();
 	}
 };
 
@@ -350,28 +430,35 @@ std::ostream& operator<<(std::ostream& os, const JSONROMOutput& fo) {
 	assert(systemName != nullptr);
 	assert(fileType != nullptr);
 
-	Document document;
-	document.SetObject();	// document should be an object, not an array
-	Document::AllocatorType& allocator = document.GetAllocator();
-	document.AddMember("system", StringRef(systemName ? systemName : "unknown"), allocator);
-	document.AddMember("filetype", StringRef(fileType ? fileType : "unknown"), allocator);
+	// NOTE: The document is written directly to the output stream
+	// without building a DOM first. Arrays that are omitted if empty
+	// are checked before writing their keys.
+	BufferedOStreamWrapper oswr(os);
+	JSONWriter writer(oswr);
+	writer.SetNewlineMode(fo.crlf_);
+
+	writer.StartObject();	// document should be an object, not an array
+	writer.Key("system"); writer.String(systemName ? systemName : "unknown");
+	writer.Key("filetype"); writer.String(fileType ? fileType : "unknown");
 
 	// Fields.
 	const RomFields *const fields = romdata->fields();
 	assert(fields != nullptr);
 	if (fields) {
-		Value fields_array(kArrayType);	// fields
-		JSONFieldsOutput<Document::AllocatorType>(*fields).writeToJSON(fields_array, allocator);
-		if (!fields_array.Empty()) {
-			document.AddMember("fields", fields_array, allocator);
+		JSONFieldsOutput fieldsOut(*fields);
+		if (fieldsOut.hasValidFields()) {
+			writer.Key("fields");
+			fieldsOut.writeToJSON(writer);
 		}
 	}
 
 	// Internal images.
 	const uint32_t imgbf = romdata->supportedImageTypes();
 	if (imgbf != 0) {
-		Value imgint_array(kArrayType);	// imgint
-
+		// Find valid internal images first.
+		// NOTE: RomData caches internal images, so this doesn't
+		// load the images twice.
+		vector<std::pair<RomData::ImageType, const rp_image*> > imgints;
 		for (int i = RomData::IMG_INT_MIN; i <= RomData::IMG_INT_MAX; i++) {
 			if (!(imgbf & (1U << i)))
 				continue;
@@ -380,48 +467,60 @@ std::ostream& operator<<(std::ostream& os, const JSONROMOutput& fo) {
 			if (!image || !image->isValid())
 				continue;
 
-			Value imgint_obj(kObjectType);
-			imgint_obj.AddMember("type", StringRef(RomData::getImageTypeName((RomData::ImageType)i)), allocator);
-			imgint_obj.AddMember("format", StringRef(rp_image::getFormatName(image->format())), allocator);
+			imgints.emplace_back((RomData::ImageType)i, image);
+		}
 
-			Value size_array(kArrayType);	// size
-			size_array.PushBack(image->width(), allocator);
-			size_array.PushBack(image->height(), allocator);
-			imgint_obj.AddMember("size", size_array, allocator);
+		if (!imgints.empty()) {
+			writer.Key("imgint"); writer.StartArray();
 
-			const uint32_t ppf = romdata->imgpf((RomData::ImageType)i);
-			if (ppf) {
-				imgint_obj.AddMember("postprocessing", ppf, allocator);
-			}
+			const auto imgints_cend = imgints.cend();
+			for (auto iter = imgints.cbegin(); iter != imgints_cend; ++iter) {
+				const RomData::ImageType imageType = iter->first;
+				const rp_image *const image = iter->second;
 
-			if (ppf & RomData::IMGPF_ICON_ANIMATED) {
-				auto animdata = romdata->iconAnimData();
-				if (animdata) {
-					imgint_obj.AddMember("frames", animdata->count, allocator);
+				writer.StartObject();
+				writer.Key("type"); writer.String(RomData::getImageTypeName(imageType));
+				writer.Key("format"); writer.String(rp_image::getFormatName(image->format()));
 
-					Value animseq(kArrayType);	// sequence
-					for (int j = 0; j < animdata->seq_count; j++) {
-						animseq.PushBack((unsigned)animdata->seq_index[j], allocator);
-					}
-					imgint_obj.AddMember("sequence", animseq, allocator);
+				writer.Key("size"); writer.StartArray();
+				writer.Int(image->width());
+				writer.Int(image->height());
+				writer.EndArray();
+
+				const uint32_t ppf = romdata->imgpf(imageType);
+				if (ppf) {
+					writer.Key("postprocessing"); writer.Uint(ppf);
+				}
+
+				if (ppf & RomData::IMGPF_ICON_ANIMATED) {
+					auto animdata = romdata->iconAnimData();
+					if (animdata) {
+						writer.Key("frames"); writer.Int(animdata->count);
+
+						writer.Key("sequence"); writer.StartArray();
+						for (int j = 0; j < animdata->seq_count; j++) {
+							writer.Uint((unsigned)animdata->seq_index[j]);
+						}
+						writer.EndArray();
 
-					Value animdelay(kArrayType);	// delay
-					for (int j = 0; j < animdata->seq_count; j++) {
-						animdelay.PushBack(animdata->delays[j].ms, allocator);
+						writer.Key("delay"); writer.StartArray();
+						for (int j = 0; j < animdata->seq_count; j++) {
+							writer.Int(animdata->delays[j].ms);
+						}
+						writer.EndArray();
 					}
-					imgint_obj.AddMember("delay", animdelay, allocator);
 				}
+
+				writer.EndObject();
 			}
 
-			imgint_array.PushBack(imgint_obj, allocator);
-		}
-		if (!imgint_array.Empty()) {
-			document.AddMember("imgint", imgint_array, allocator);
+			writer.EndArray();
 		}
 
 		// External images.
 		// NOTE: IMGPF_ICON_ANIMATED won't ever appear in external image
-		Value imgext_array(kArrayType);	// imgext
+		// Find types with URLs first.
+		vector<std::pair<RomData::ImageType, vector<RomData::ExtURL> > > imgexts;
 		vector<RomData::ExtURL> extURLs;
 		for (int i = RomData::IMG_EXT_MIN; i <= RomData::IMG_EXT_MAX; i++) {
 			if (!(imgbf & (1U << i)))
@@ -437,33 +536,36 @@ std::ostream& operator<<(std::ostream& os, const JSONROMOutput& fo) {
 			if (ret != 0 || extURLs.empty())
 				continue;
 
-			Value imgext_obj(kObjectType);
-			imgext_obj.AddMember("type", StringRef(RomData::getImageTypeName((RomData::ImageType)i)), allocator);
+			imgexts.emplace_back((RomData::ImageType)i, std::move(extURLs));
+		}
 
-			Value exturls_obj(kObjectType);
-			const auto extURLs_cend = extURLs.cend();
-			for (auto iter = extURLs.cbegin(); iter != extURLs_cend; ++iter) {
-				Value url_val;
-				const string url_str = urlPartialUnescape(iter->url);
-				url_val.SetString(url_str, allocator);
-				exturls_obj.AddMember("url", url_val, allocator);
+		if (!imgexts.empty()) {
+			writer.Key("imgext"); writer.StartArray();
+
+			const auto imgexts_cend = imgexts.cend();
+			for (auto iter = imgexts.cbegin(); iter != imgexts_cend; ++iter) {
+				writer.StartObject();
+				writer.Key("type"); writer.String(RomData::getImageTypeName(iter->first));
+
+				writer.Key("exturls"); writer.StartObject();
+				const auto extURLs_cend = iter->second.cend();
+				for (auto urlIter = iter->second.cbegin(); urlIter != extURLs_cend; ++urlIter) {
+					writer.Key("url");
+					writeString(writer, urlPartialUnescape(urlIter->url));
+					writer.Key("cache_key");
+					writeString(writer, urlIter->cache_key);
+				}
+				writer.EndObject();
 
-				Value cache_key_val;
-				cache_key_val.SetString(iter->cache_key, allocator);
-				exturls_obj.AddMember("cache_key", cache_key_val, allocator);
+				writer.EndObject();
 			}
-			imgext_obj.AddMember("exturls", exturls_obj, allocator);
-			imgext_array.PushBack(imgext_obj, allocator);
-		}
-		if (!imgext_array.Empty()) {
-			document.AddMember("imgext", imgext_array, allocator);
+
+			writer.EndArray();
 		}
 	}
 
-	OStreamWrapper oswr(os);
-	PrettyWriter<OStreamWrapper> writer(oswr);
-	writer.SetNewlineMode(fo.crlf_);
-	document.Accept(writer);
+	writer.EndObject();
+	oswr.Flush();
 
 	os.flush();
 	return os;
@@ -88,6 +88,10 @@ class ConfigPrivate : public ConfReaderPrivate
 		// Other options.
 		bool showDangerousPermissionsOverlayIcon;
 		bool enableThumbnailOnNetworkFS;
+		bool enableThumbnailCache;
+		bool enableFieldCache;
+		bool showHashTab;
+		bool verifyContentHashes;
 };
 
 /** ConfigPrivate **/
@@ -126,6 +130,14 @@ ConfigPrivate::ConfigPrivate()
 	, showDangerousPermissionsOverlayIcon(true)
 	/* Enable thumbnailing and metadata on network FS */
 	, enableThumbnailOnNetworkFS(false)
+	/* Rendered thumbnail cache */
+	, enableThumbnailCache(false)
+	/* Parsed field cache */
+	, enableFieldCache(false)
+	/* Hash tab */
+	, showHashTab(false)
+	/* Content hash verification */
+	, verifyContentHashes(false)
 {
 	// NOTE: Configuration is also initialized in the reset() function.
 	memset(dmgTSMode, 0, sizeof(dmgTSMode));
@@ -162,6 +174,14 @@ void ConfigPrivate::reset(void)
 	showDangerousPermissionsOverlayIcon = true;
 	// Enable thumbnail and metadata on network FS
 	enableThumbnailOnNetworkFS = false;
+	// Rendered thumbnail cache
+	enableThumbnailCache = false;
+	// Parsed field cache
+	enableFieldCache = false;
+	// Hash tab
+	showHashTab = false;
+	// Content hash verification
+	verifyContentHashes = false;
 }
 
 /**
@@ -248,6 +268,14 @@ int ConfigPrivate::processConfigLine(const char *section, const char *name, cons
 			param = &showDangerousPermissionsOverlayIcon;
 		} else if (!strcasecmp(name, "EnableThumbnailOnNetworkFS")) {
 			param = &enableThumbnailOnNetworkFS;
+		} else if (!strcasecmp(name, "EnableThumbnailCache")) {
+			param = &enableThumbnailCache;
+		} else if (!strcasecmp(name, "EnableFieldCache")) {
+			param = &enableFieldCache;
+		} else if (!strcasecmp(name, "ShowHashTab")) {
+			param = &showHashTab;
+		} else if (!strcasecmp(name, "VerifyContentHashes")) {
+			param = &verifyContentHashes;
 		} else {
 			// Invalid option.
 			return 1;
@@ -508,6 +536,37 @@ void Config::getDefImgTypePrio(ImgTypePrio_t *imgTypePrio) const
 	}
 }
 
+/**
+ * Get a checksum of all image type priority data.
+ * This changes if the priority for any class is changed,
+ * and can be used to invalidate cached thumbnails.
+ * NOTE: Call load() before using this function.
+ * @return Image type priority checksum.
+ */
+uint32_t Config::imgTypePrioChecksum(void) const
+{
+	// NOTE: unordered_map iteration order is unspecified,
+	// so each entry is hashed separately and summed.
+	// FNV-1a is used for each entry.
+	RP_D(const Config);
+	uint32_t checksum = 0;
+	const auto mapImgTypePrio_cend = d->mapImgTypePrio.cend();
+	for (auto iter = d->mapImgTypePrio.cbegin(); iter != mapImgTypePrio_cend; ++iter) {
+		uint32_t hash = 0x811C9DC5U;
+		for (const char *p = iter->first.c_str(); *p != '\0'; p++) {
+			hash = (hash ^ static_cast<uint8_t>(*p)) * 0x01000193U;
+		}
+
+		const uint32_t idx = (iter->second & 0xFFFFFF);
+		const uint8_t len = ((iter->second >> 24) & 0xFF);
+		for (unsigned int i = 0; i < len && idx + i < d->vImgTypePrio.size(); i++) {
+			hash = (hash ^ d->vImgTypePrio[idx + i]) * 0x01000193U;
+		}
+		checksum += hash;
+	}
+	return checksum;
+}
+
 /** Download options **/
 
 /**
@@ -601,4 +660,48 @@ bool Config::enableThumbnailOnNetworkFS(void) const
 	return d->enableThumbnailOnNetworkFS;
 }
 
+/**
+ * Enable the rendered thumbnail cache?
+ * NOTE: Call load() before using this function.
+ * @return True if we should enable; false if not.
+ */
+bool Config::enableThumbnailCache(void) const
+{
+	RP_D(const Config);
+	return d->enableThumbnailCache;
+}
+
+/**
+ * Enable the parsed field and metadata cache?
+ * NOTE: Call load() before using this function.
+ * @return True if we should enable; false if not.
+ */
+bool Config::enableFieldCache(void) const
+{
+	RP_D(const Config);
+	return d->enableFieldCache;
+}
+
+/**
+ * Show a tab with CRC32, MD5, SHA-1, and SHA-256 hashes?
+ * NOTE: Call load() before using this function.
+ * @return True if we should show the tab; false if not.
+ */
+bool Config::showHashTab(void) const
+{
+	RP_D(const Config);
+	return d->showHashTab;
+}
+
+/**
+ * Verify content hashes stored in the ROM image's headers?
+ * NOTE: Call load() before using this function.
+ * @return True if we should verify content hashes; false if not.
+ */
+bool Config::verifyContentHashes(void) const
+{
+	RP_D(const Config);
+	return d->verifyContentHashes;
+}
+
 }
@@ -84,6 +84,15 @@ class Config : public ConfReader
 		 */
 		void getDefImgTypePrio(ImgTypePrio_t *imgTypePrio) const;
 
+		/**
+		 * Get a checksum of all image type priority data.
+		 * This changes if the priority for any class is changed,
+		 * and can be used to invalidate cached thumbnails.
+		 * NOTE: Call load() before using this function.
+		 * @return Image type priority checksum.
+		 */
+		uint32_t imgTypePrioChecksum(void) const;
+
 		/** Download options **/
 
 		/**
@@ -147,6 +156,34 @@ class Config : public ConfReader
 		 * @return True if we should enable; false if not.
 		 */
 		bool enableThumbnailOnNetworkFS(void) const;
+
+		/**
+		 * Enable the rendered thumbnail cache?
+		 * NOTE: Call load() before using this function.
+		 * @return True if we should enable; false if not.
+		 */
+		bool enableThumbnailCache(void) const;
+
+		/**
+		 * Enable the parsed field and metadata cache?
+		 * NOTE: Call load() before using this function.
+		 * @return True if we should enable; false if not.
+		 */
+		bool enableFieldCache(void) const;
+
+		/**
+		 * Show a tab with CRC32, MD5, SHA-1, and SHA-256 hashes?
+		 * NOTE: Call load() before using this function.
+		 * @return True if we should show the tab; false if not.
+		 */
+		bool showHashTab(void) const;
+
+		/**
+		 * Verify content hashes stored in the ROM image's headers?
+		 * NOTE: Call load() before using this function.
+		 * @return True if we should verify content hashes; false if not.
+		 */
+		bool verifyContentHashes(void) const;
 };
 
 }
@@ -0,0 +1,565 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * Hash.cpp: Incremental hash class. (CRC32, MD5, SHA-1, SHA-256)          *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "config.librpbase.h"
+
+#include "Hash.hpp"
+#include "crc32_pclmul.hpp"
+#include "sha256_shani.hpp"
+
+// librpcpu
+#include "librpcpu/byteswap.h"
+#if defined(CRC32_HAS_PCLMUL) || defined(SHA256_HAS_SHANI)
+# include "librpcpu/cpuflags_x86.h"
+#endif /* CRC32_HAS_PCLMUL || SHA256_HAS_SHANI */
+
+// zlib for crc32()
+#include <zlib.h>
+
+#if defined(ENABLE_DECRYPTION)
+# if defined(_WIN32)
+// libwin32common
+#  include "libwin32common/RpWin32_sdk.h"
+#  include "libwin32common/w32err.h"
+#  include <wincrypt.h>
+#  define HASH_USE_CAPI 1
+# elif defined(HAVE_NETTLE)
+// Nettle hash functions.
+#  include <nettle/md5.h>
+#  include <nettle/sha1.h>
+#  include <nettle/sha2.h>
+#  define HASH_USE_NETTLE 1
+# endif
+#endif /* ENABLE_DECRYPTION */
+
+namespace LibRpBase {
+
+class HashPrivate
+{
+	public:
+		explicit HashPrivate(Hash::Algorithm algorithm);
+		~HashPrivate();
+
+	private:
+		RP_DISABLE_COPY(HashPrivate)
+
+	public:
+		Hash::Algorithm algorithm;
+		bool usable;
+
+		// Hash state.
+		uint32_t crc;
+#if defined(HASH_USE_CAPI)
+		HCRYPTPROV hProvider;
+		HCRYPTHASH hHash;
+#elif defined(HASH_USE_NETTLE)
+		union {
+			struct md5_ctx md5;
+			struct sha1_ctx sha1;
+			struct sha256_ctx sha256;
+		} ctx;
+#endif
+
+#ifdef SHA256_HAS_SHANI
+		// SHA-256 using the SHA extensions.
+		// If set, this is used instead of the crypto library.
+		bool use_shani;
+		struct {
+			uint32_t state[8];
+			uint64_t length;	// Total length, in bytes.
+			uint8_t block[64];	// Partial block.
+			unsigned int block_len;	// Bytes in block[].
+		} shani;
+
+		/**
+		 * Process data using SHA-256 with the SHA extensions.
+		 * @param buf Data buffer.
+		 * @param len Data length.
+		 */
+		void shani_update(const uint8_t *buf, size_t len);
+
+		/**
+		 * Finalize SHA-256 with the SHA extensions.
+		 * @param pHash Output hash buffer. (32 bytes)
+		 */
+		void shani_digest(uint8_t *pHash);
+#endif /* SHA256_HAS_SHANI */
+
+		/**
+		 * Reset the hash state.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int reset(void);
+
+		/**
+		 * Update a CRC32.
+		 * @param crc	[in] Initial CRC32.
+		 * @param buf	[in] Data buffer.
+		 * @param len	[in] Data length.
+		 * @return Updated CRC32.
+		 */
+		static uint32_t updateCRC32(uint32_t crc, const uint8_t *buf, size_t len);
+};
+
+/** HashPrivate **/
+
+HashPrivate::HashPrivate(Hash::Algorithm algorithm)
+	: algorithm(algorithm)
+	, usable(false)
+	, crc(0)
+#ifdef HASH_USE_CAPI
+	, hProvider(0)
+	, hHash(0)
+#endif /* HASH_USE_CAPI */
+#ifdef SHA256_HAS_SHANI
+	, use_shani(false)
+#endif /* SHA256_HAS_SHANI */
+{
+	switch (algorithm) {
+		case Hash::Algorithm::CRC32:
+			usable = true;
+			break;
+
+#if defined(HASH_USE_CAPI)
+		case Hash::Algorithm::MD5:
+		case Hash::Algorithm::SHA1:
+		case Hash::Algorithm::SHA256:
+			// PROV_RSA_AES is needed for SHA-256.
+			usable = !!CryptAcquireContext(&hProvider, nullptr, nullptr,
+				PROV_RSA_AES, CRYPT_VERIFYCONTEXT | CRYPT_SILENT);
+			break;
+#elif defined(HASH_USE_NETTLE)
+		case Hash::Algorithm::MD5:
+		case Hash::Algorithm::SHA1:
+		case Hash::Algorithm::SHA256:
+			usable = true;
+			break;
+#endif
+
+		default:
+			// Not supported.
+			break;
+	}
+
+#ifdef SHA256_HAS_SHANI
+	// NOTE: SHA-256 is still only considered usable if
+	// the crypto library is available, so the set of
+	// available algorithms doesn't depend on the CPU.
+	use_shani = (usable && algorithm == Hash::Algorithm::SHA256 && RP_CPU_HasSHA());
+#endif /* SHA256_HAS_SHANI */
+
+	if (usable) {
+		usable = (reset() == 0);
+	}
+}
+
+HashPrivate::~HashPrivate()
+{
+#ifdef HASH_USE_CAPI
+	if (hHash) {
+		CryptDestroyHash(hHash);
+	}
+	if (hProvider) {
+		CryptReleaseContext(hProvider, 0);
+	}
+#endif /* HASH_USE_CAPI */
+}
+
+/**
+ * Reset the hash state.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int HashPrivate::reset(void)
+{
+	if (algorithm == Hash::Algorithm::CRC32) {
+		crc = 0;
+		return 0;
+	}
+
+#ifdef SHA256_HAS_SHANI
+	if (use_shani) {
+		static const uint32_t sha256_init_state[8] = {
+			0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+			0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+		};
+		memcpy(shani.state, sha256_init_state, sizeof(shani.state));
+		shani.length = 0;
+		shani.block_len = 0;
+		return 0;
+	}
+#endif /* SHA256_HAS_SHANI */
+
+#if defined(HASH_USE_CAPI)
+	ALG_ID alg_id;
+	switch (algorithm) {
+		case Hash::Algorithm::MD5:
+			alg_id = CALG_MD5;
+			break;
+		case Hash::Algorithm::SHA1:
+			alg_id = CALG_SHA1;
+			break;
+		case Hash::Algorithm::SHA256:
+			alg_id = CALG_SHA_256;
+			break;
+		default:
+			return -ENOTSUP;
+	}
+
+	if (hHash) {
+		CryptDestroyHash(hHash);
+		hHash = 0;
+	}
+	if (!CryptCreateHash(hProvider, alg_id, 0, 0, &hHash)) {
+		// Error creating the hash object.
+		hHash = 0;
+		return -w32err_to_posix(GetLastError());
+	}
+	return 0;
+#elif defined(HASH_USE_NETTLE)
+	switch (algorithm) {
+		case Hash::Algorithm::MD5:
+			md5_init(&ctx.md5);
+			break;
+		case Hash::Algorithm::SHA1:
+			sha1_init(&ctx.sha1);
+			break;
+		case Hash::Algorithm::SHA256:
+			sha256_init(&ctx.sha256);
+			break;
+		default:
+			return -ENOTSUP;
+	}
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
+/**
+ * Update a CRC32.
+ * @param crc	[in] Initial CRC32.
+ * @param buf	[in] Data buffer.
+ * @param len	[in] Data length.
+ * @return Updated CRC32.
+ */
+uint32_t HashPrivate::updateCRC32(uint32_t crc, const uint8_t *buf, size_t len)
+{
+#ifdef CRC32_HAS_PCLMUL
+	if (len >= CRC32_PCLMUL_MIN_LENGTH && RP_CPU_HasPCLMULQDQ()) {
+		// Process all 16-byte blocks with PCLMULQDQ.
+		const size_t chunk_len = len & ~static_cast<size_t>(15);
+		crc = crc32_pclmul(crc, buf, chunk_len);
+		buf += chunk_len;
+		len -= chunk_len;
+	}
+#endif /* CRC32_HAS_PCLMUL */
+
+	// zlib's crc32() takes a 32-bit length.
+	while (len > 0) {
+		const uInt chunk_len = (len > 0x40000000U ? 0x40000000U : static_cast<uInt>(len));
+		crc = crc32(crc, buf, chunk_len);
+		buf += chunk_len;
+		len -= chunk_len;
+	}
+	return crc;
+}
+
+#ifdef SHA256_HAS_SHANI
+/**
+ * Process data using SHA-256 with the SHA extensions.
+ * @param buf Data buffer.
+ * @param len Data length.
+ */
+void HashPrivate::shani_update(const uint8_t *buf, size_t len)
+{
+	shani.length += len;
+
+	if (shani.block_len > 0) {
+		// Fill the partial block first.
+		const size_t fill = std::min(len, static_cast<size_t>(64 - shani.block_len));
+		memcpy(&shani.block[shani.block_len], buf, fill);
+		shani.block_len += static_cast<unsigned int>(fill);
+		buf += fill;
+		len -= fill;
+		if (shani.block_len < 64) {
+			// Still not a full block.
+			return;
+		}
+		sha256_shani_compress(shani.state, shani.block, 1);
+		shani.block_len = 0;
+	}
+
+	// Process full blocks directly from the buffer.
+	const size_t blocks = len / 64;
+	if (blocks > 0) {
+		sha256_shani_compress(shani.state, buf, blocks);
+		buf += blocks * 64;
+		len -= blocks * 64;
+	}
+
+	// Save the remaining data.
+	if (len > 0) {
+		memcpy(shani.block, buf, len);
+		shani.block_len = static_cast<unsigned int>(len);
+	}
+}
+
+/**
+ * Finalize SHA-256 with the SHA extensions.
+ * @param pHash Output hash buffer. (32 bytes)
+ */
+void HashPrivate::shani_digest(uint8_t *pHash)
+{
+	// Append the '1' bit, then pad with zeroes until
+	// there's room for the 64-bit length.
+	const uint64_t bit_length = shani.length * 8;
+	unsigned int pos = shani.block_len;
+	shani.block[pos++] = 0x80;
+	if (pos > 56) {
+		memset(&shani.block[pos], 0, 64 - pos);
+		sha256_shani_compress(shani.state, shani.block, 1);
+		pos = 0;
+	}
+	memset(&shani.block[pos], 0, 56 - pos);
+	const uint64_t bit_length_be = cpu_to_be64(bit_length);
+	memcpy(&shani.block[56], &bit_length_be, sizeof(bit_length_be));
+	sha256_shani_compress(shani.state, shani.block, 1);
+	shani.block_len = 0;
+
+	// Hash value is stored in big-endian.
+	for (unsigned int i = 0; i < 8; i++) {
+		const uint32_t h_be = cpu_to_be32(shani.state[i]);
+		memcpy(&pHash[i * 4], &h_be, sizeof(h_be));
+	}
+}
+#endif /* SHA256_HAS_SHANI */
+
+/** Hash **/
+
+/**
+ * Create a hash object for the specified algorithm.
+ * Check isUsable() before using it.
+ * @param algorithm Hash algorithm.
+ */
+Hash::Hash(Algorithm algorithm)
+	: d_ptr(new HashPrivate(algorithm))
+{ }
+
+Hash::~Hash()
+{
+	delete d_ptr;
+}
+
+/**
+ * Is the hash algorithm usable?
+ *
+ * CRC32 is always usable. The other algorithms require
+ * a crypto library, which is only available if
+ * decryption is enabled.
+ *
+ * @return True if usable; false if not.
+ */
+bool Hash::isUsable(void) const
+{
+	RP_D(const Hash);
+	return d->usable;
+}
+
+/**
+ * Get the hash algorithm.
+ * @return Hash algorithm.
+ */
+Hash::Algorithm Hash::algorithm(void) const
+{
+	RP_D(const Hash);
+	return d->algorithm;
+}
+
+/**
+ * Get the hash length for an algorithm.
+ * @param algorithm Hash algorithm.
+ * @return Hash length, in bytes. (0 if invalid)
+ */
+size_t Hash::hashLength(Algorithm algorithm)
+{
+	static const uint8_t lengths[] = {
+		4,	// CRC32
+		16,	// MD5
+		20,	// SHA-1
+		32,	// SHA-256
+	};
+	static_assert(ARRAY_SIZE(lengths) == static_cast<size_t>(Algorithm::Max),
+		"lengths[] is out of sync with Hash::Algorithm.");
+
+	const size_t idx = static_cast<size_t>(algorithm);
+	return (idx < ARRAY_SIZE(lengths) ? lengths[idx] : 0);
+}
+
+/**
+ * Get the hash algorithm name, e.g. "SHA-1".
+ * @param algorithm Hash algorithm.
+ * @return Algorithm name, or nullptr if invalid.
+ */
+const char *Hash::algorithmName(Algorithm algorithm)
+{
+	static const char names[][8] = {
+		"CRC32", "MD5", "SHA-1", "SHA-256",
+	};
+	static_assert(ARRAY_SIZE(names) == static_cast<size_t>(Algorithm::Max),
+		"names[] is out of sync with Hash::Algorithm.");
+
+	const size_t idx = static_cast<size_t>(algorithm);
+	return (idx < ARRAY_SIZE(names) ? names[idx] : nullptr);
+}
+
+/**
+ * Reset the hash state.
+ * This must be called before reusing the object
+ * after calling getHash().
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int Hash::reset(void)
+{
+	RP_D(Hash);
+	if (!d->usable) {
+		return -ENOTSUP;
+	}
+	return d->reset();
+}
+
+/**
+ * Process a block of data.
+ * @param pData	[in] Input data.
+ * @param len	[in] Data length.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int Hash::process(const void *pData, size_t len)
+{
+	RP_D(Hash);
+	assert(pData != nullptr || len == 0);
+	if (!d->usable) {
+		return -ENOTSUP;
+	} else if (len == 0) {
+		// Nothing to do.
+		return 0;
+	} else if (!pData) {
+		return -EINVAL;
+	}
+
+	const uint8_t *const buf = static_cast<const uint8_t*>(pData);
+	if (d->algorithm == Algorithm::CRC32) {
+		d->crc = HashPrivate::updateCRC32(d->crc, buf, len);
+		return 0;
+	}
+#ifdef SHA256_HAS_SHANI
+	if (d->use_shani) {
+		d->shani_update(buf, len);
+		return 0;
+	}
+#endif /* SHA256_HAS_SHANI */
+
+#if defined(HASH_USE_CAPI)
+	if (!d->hHash) {
+		return -EBADF;
+	}
+	// CryptHashData() takes a 32-bit length.
+	for (size_t pos = 0; pos < len; ) {
+		const DWORD chunk_len = (len - pos > 0x40000000U
+			? 0x40000000U : static_cast<DWORD>(len - pos));
+		if (!CryptHashData(d->hHash, &buf[pos], chunk_len, 0)) {
+			return -w32err_to_posix(GetLastError());
+		}
+		pos += chunk_len;
+	}
+	return 0;
+#elif defined(HASH_USE_NETTLE)
+	switch (d->algorithm) {
+		case Algorithm::MD5:
+			md5_update(&d->ctx.md5, len, buf);
+			break;
+		case Algorithm::SHA1:
+			sha1_update(&d->ctx.sha1, len, buf);
+			break;
+		case Algorithm::SHA256:
+			sha256_update(&d->ctx.sha256, len, buf);
+			break;
+		default:
+			return -ENOTSUP;
+	}
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
+/**
+ * Finalize the hash and get the hash value.
+ * CRC32 is returned in big-endian format.
+ * @param pHash		[out] Output hash buffer.
+ * @param hash_len	[in] Size of hash buffer. (Must match hashLength().)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int Hash::getHash(uint8_t *pHash, size_t hash_len)
+{
+	RP_D(Hash);
+	assert(pHash != nullptr);
+	assert(hash_len == hashLength(d->algorithm));
+	if (!d->usable) {
+		return -ENOTSUP;
+	} else if (!pHash || hash_len != hashLength(d->algorithm)) {
+		// Invalid parameters.
+		return -EINVAL;
+	}
+
+	if (d->algorithm == Algorithm::CRC32) {
+		const uint32_t crc_be = cpu_to_be32(d->crc);
+		memcpy(pHash, &crc_be, sizeof(crc_be));
+		return 0;
+	}
+#ifdef SHA256_HAS_SHANI
+	if (d->use_shani) {
+		d->shani_digest(pHash);
+		return 0;
+	}
+#endif /* SHA256_HAS_SHANI */
+
+#if defined(HASH_USE_CAPI)
+	if (!d->hHash) {
+		return -EBADF;
+	}
+	DWORD cbHash = static_cast<DWORD>(hash_len);
+	if (!CryptGetHashParam(d->hHash, HP_HASHVAL, pHash, &cbHash, 0)) {
+		// Error getting the hash.
+		return -w32err_to_posix(GetLastError());
+	} else if (cbHash != static_cast<DWORD>(hash_len)) {
+		// Wrong hash length.
+		return -EINVAL;
+	}
+	return 0;
+#elif defined(HASH_USE_NETTLE)
+	switch (d->algorithm) {
+		case Algorithm::MD5:
+			md5_digest(&d->ctx.md5, hash_len, pHash);
+			break;
+		case Algorithm::SHA1:
+			sha1_digest(&d->ctx.sha1, hash_len, pHash);
+			break;
+		case Algorithm::SHA256:
+			sha256_digest(&d->ctx.sha256, hash_len, pHash);
+			break;
+		default:
+			return -ENOTSUP;
+	}
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
+}
@@ -0,0 +1,110 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * Hash.hpp: Incremental hash class. (CRC32, MD5, SHA-1, SHA-256)          *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_CRYPTO_HASH_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_CRYPTO_HASH_HPP__
+
+#include "common.h"
+
+// C includes.
+#include <stddef.h>	/* size_t */
+#include <stdint.h>
+
+namespace LibRpBase {
+
+class HashPrivate;
+class Hash
+{
+	public:
+		enum class Algorithm : uint8_t {
+			CRC32	= 0,	// zlib-compatible CRC32
+			MD5	= 1,
+			SHA1	= 2,
+			SHA256	= 3,
+
+			Max
+		};
+
+		/**
+		 * Create a hash object for the specified algorithm.
+		 * Check isUsable() before using it.
+		 * @param algorithm Hash algorithm.
+		 */
+		explicit Hash(Algorithm algorithm);
+		~Hash();
+
+	private:
+		RP_DISABLE_COPY(Hash)
+	private:
+		friend class HashPrivate;
+		HashPrivate *const d_ptr;
+
+	public:
+		/**
+		 * Is the hash algorithm usable?
+		 *
+		 * CRC32 is always usable. The other algorithms require
+		 * a crypto library, which is only available if
+		 * decryption is enabled.
+		 *
+		 * @return True if usable; false if not.
+		 */
+		bool isUsable(void) const;
+
+		/**
+		 * Get the hash algorithm.
+		 * @return Hash algorithm.
+		 */
+		Algorithm algorithm(void) const;
+
+		/**
+		 * Get the hash length for an algorithm.
+		 * @param algorithm Hash algorithm.
+		 * @return Hash length, in bytes. (0 if invalid)
+		 */
+		static size_t hashLength(Algorithm algorithm);
+
+		/**
+		 * Get the hash algorithm name, e.g. "SHA-1".
+		 * @param algorithm Hash algorithm.
+		 * @return Algorithm name, or nullptr if invalid.
+		 */
+		static const char *algorithmName(Algorithm algorithm);
+
+	public:
+		/**
+		 * Reset the hash state.
+		 * This must be called before reusing the object
+		 * after calling getHash().
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int reset(void);
+
+		/**
+		 * Process a block of data.
+		 * @param pData	[in] Input data.
+		 * @param len	[in] Data length.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		ATTR_ACCESS_SIZE(read_only, 2, 3)
+		int process(const void *pData, size_t len);
+
+		/**
+		 * Finalize the hash and get the hash value.
+		 * CRC32 is returned in big-endian format.
+		 * @param pHash		[out] Output hash buffer.
+		 * @param hash_len	[in] Size of hash buffer. (Must match hashLength().)
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 2, 3)
+		int getHash(uint8_t *pHash, size_t hash_len);
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_CRYPTO_HASH_HPP__ */
@@ -0,0 +1,552 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * StreamHasher.cpp: Single-pass multi-algorithm stream hasher.            *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "StreamHasher.hpp"
+
+// librpbase, librpfile
+#include "disc/IDiscReader.hpp"
+using LibRpFile::IRpFile;
+
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+#include "librpthreads/Semaphore.hpp"
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+using LibRpThreads::Semaphore;
+
+// C++ STL classes.
+#include <deque>
+#include <thread>
+using std::deque;
+using std::string;
+using std::vector;
+
+namespace LibRpBase {
+
+class StreamHasherPrivate
+{
+	public:
+		explicit StreamHasherPrivate(uint32_t algorithms);
+		~StreamHasherPrivate();
+
+	private:
+		RP_DISABLE_COPY(StreamHasherPrivate)
+
+	public:
+		// Hash objects. (nullptr if not selected or not usable)
+		Hash *hashes[static_cast<int>(Hash::Algorithm::Max)];
+
+		// Hash values from the last process().
+		uint8_t results[static_cast<int>(Hash::Algorithm::Max)][32];
+		bool hasResult[static_cast<int>(Hash::Algorithm::Max)];
+		off64_t bytesHashed;
+
+		// Options.
+		size_t bufferSize;
+		unsigned int bufferCount;
+
+		// Reusable buffers.
+		vector<ao::uvector<uint8_t> > buffers;
+
+		/**
+		 * Buffer hash request for a worker thread.
+		 */
+		struct HashTask {
+			int bufIdx;	// Buffer index, or -1 to stop the thread.
+			size_t size;	// Amount of data in the buffer.
+		};
+
+		/**
+		 * Worker thread queue.
+		 */
+		struct WorkerQueue {
+			Hash *hash;
+			Semaphore sem;		// Number of queued tasks.
+			Mutex mutex;
+			deque<HashTask> tasks;
+
+			WorkerQueue() : hash(nullptr), sem(0) { }
+		};
+
+		// Free buffers.
+		// A buffer is returned to the free list once
+		// all worker threads have processed it.
+		Semaphore *freeSem;
+		Mutex freeMutex;
+		vector<int> freeList;
+		vector<unsigned int> bufRefs;
+
+		// First error encountered by a worker thread.
+		Mutex resultMutex;
+		int hashError;
+
+		/**
+		 * Release a buffer reference.
+		 * The buffer is returned to the free list once
+		 * all references have been released.
+		 * @param bufIdx Buffer index.
+		 */
+		void releaseBuffer(int bufIdx);
+
+		/**
+		 * Worker thread function.
+		 * @param queue Worker queue.
+		 */
+		void workerThread(WorkerQueue *queue);
+
+		/**
+		 * Hash a stream.
+		 * @tparam T IRpFile or IDiscReader
+		 * @param stream Stream.
+		 * @param offset Starting offset.
+		 * @param length Length to hash, or -1 to hash until the end of the stream.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		template<typename T>
+		int processStream(T *stream, off64_t offset, off64_t length);
+};
+
+/** StreamHasherPrivate **/
+
+StreamHasherPrivate::StreamHasherPrivate(uint32_t algorithms)
+	: bytesHashed(0)
+	, bufferSize(1024*1024)
+	, bufferCount(4)
+	, freeSem(nullptr)
+	, hashError(0)
+{
+	for (int i = 0; i < static_cast<int>(Hash::Algorithm::Max); i++) {
+		hashes[i] = nullptr;
+		hasResult[i] = false;
+		if (!(algorithms & (1U << i)))
+			continue;
+
+		Hash *const hash = new Hash(static_cast<Hash::Algorithm>(i));
+		if (hash->isUsable()) {
+			hashes[i] = hash;
+		} else {
+			delete hash;
+		}
+	}
+}
+
+StreamHasherPrivate::~StreamHasherPrivate()
+{
+	for (int i = 0; i < static_cast<int>(Hash::Algorithm::Max); i++) {
+		delete hashes[i];
+	}
+}
+
+/**
+ * Release a buffer reference.
+ * The buffer is returned to the free list once
+ * all references have been released.
+ * @param bufIdx Buffer index.
+ */
+void StreamHasherPrivate::releaseBuffer(int bufIdx)
+{
+	{
+		MutexLocker locker(freeMutex);
+		assert(bufRefs[bufIdx] > 0);
+		if (--bufRefs[bufIdx] > 0) {
+			// Still in use by another worker thread.
+			return;
+		}
+		freeList.push_back(bufIdx);
+	}
+	freeSem->release();
+}
+
+/**
+ * Worker thread function.
+ * @param queue Worker queue.
+ */
+void StreamHasherPrivate::workerThread(WorkerQueue *queue)
+{
+	bool error = false;
+	while (true) {
+		queue->sem.obtain();
+		HashTask task;
+		{
+			MutexLocker locker(queue->mutex);
+			task = queue->tasks.front();
+			queue->tasks.pop_front();
+		}
+
+		if (task.bufIdx < 0) {
+			// Stop the thread.
+			break;
+		}
+
+		if (!error) {
+			const int ret = queue->hash->process(buffers[task.bufIdx].data(), task.size);
+			if (ret != 0) {
+				// Keep releasing buffers so the reader doesn't stall.
+				error = true;
+				MutexLocker locker(resultMutex);
+				if (hashError == 0) {
+					hashError = ret;
+				}
+			}
+		}
+		releaseBuffer(task.bufIdx);
+	}
+}
+
+/**
+ * Hash a stream.
+ * @tparam T IRpFile or IDiscReader
+ * @param stream Stream.
+ * @param offset Starting offset.
+ * @param length Length to hash, or -1 to hash until the end of the stream.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+template<typename T>
+int StreamHasherPrivate::processStream(T *stream, off64_t offset, off64_t length)
+{
+	for (int i = 0; i < static_cast<int>(Hash::Algorithm::Max); i++) {
+		hasResult[i] = false;
+	}
+	bytesHashed = 0;
+
+	assert(stream != nullptr);
+	assert(offset >= 0);
+	if (!stream || offset < 0) {
+		return -EINVAL;
+	}
+
+	// Set up a worker queue for each hash algorithm.
+	unsigned int nWorkers = 0;
+	for (int i = 0; i < static_cast<int>(Hash::Algorithm::Max); i++) {
+		if (hashes[i]) {
+			nWorkers++;
+		}
+	}
+	if (nWorkers == 0) {
+		// No usable hash algorithms.
+		return -ENOTSUP;
+	}
+	vector<WorkerQueue> queues(nWorkers);
+	auto queue_iter = queues.begin();
+	for (int i = 0; i < static_cast<int>(Hash::Algorithm::Max); i++) {
+		if (hashes[i]) {
+			hashes[i]->reset();
+			(queue_iter++)->hash = hashes[i];
+		}
+	}
+
+	// Allocate the buffers.
+	// Buffers are kept allocated for subsequent process() calls.
+	const unsigned int nBuffers = (bufferCount > 0 ? bufferCount : 1);
+	if (buffers.size() != nBuffers || (!buffers.empty() && buffers[0].size() != bufferSize)) {
+		buffers.clear();
+		buffers.resize(nBuffers);
+		for (auto iter = buffers.begin(); iter != buffers.end(); ++iter) {
+			iter->resize(bufferSize);
+		}
+	}
+
+	Semaphore sem(static_cast<int>(nBuffers));
+	freeSem = &sem;
+	freeList.clear();
+	for (int i = static_cast<int>(nBuffers) - 1; i >= 0; i--) {
+		freeList.push_back(i);
+	}
+	bufRefs.assign(nBuffers, 0);
+	hashError = 0;
+
+	// Start the worker threads.
+	vector<std::thread> threads;
+	threads.reserve(nWorkers);
+	for (auto iter = queues.begin(); iter != queues.end(); ++iter) {
+		threads.emplace_back(&StreamHasherPrivate::workerThread, this, &(*iter));
+	}
+
+	// Read the stream and queue the buffers.
+	int ret = 0;
+	stream->clearError();
+	if (stream->seek(offset) != 0) {
+		ret = -stream->lastError();
+		if (ret == 0) {
+			ret = -EIO;
+		}
+		// Don't read anything.
+		length = 0;
+	}
+	off64_t remain = length;
+	while (remain != 0) {
+		// Get a free buffer.
+		freeSem->obtain();
+		int bufIdx;
+		{
+			MutexLocker locker(freeMutex);
+			bufIdx = freeList.back();
+			freeList.pop_back();
+		}
+
+		const size_t req_size = (remain > 0 && remain < static_cast<off64_t>(bufferSize)
+			? static_cast<size_t>(remain) : bufferSize);
+		const size_t size = stream->read(buffers[bufIdx].data(), req_size);
+		if (size == 0) {
+			// End of stream, or read error.
+			{
+				MutexLocker locker(freeMutex);
+				freeList.push_back(bufIdx);
+			}
+			freeSem->release();
+			break;
+		}
+
+		// All worker threads process the same buffer.
+		{
+			MutexLocker locker(freeMutex);
+			bufRefs[bufIdx] = nWorkers;
+		}
+		HashTask task;
+		task.bufIdx = bufIdx;
+		task.size = size;
+		for (auto iter = queues.begin(); iter != queues.end(); ++iter) {
+			{
+				MutexLocker locker(iter->mutex);
+				iter->tasks.push_back(task);
+			}
+			iter->sem.release();
+		}
+		bytesHashed += size;
+		if (remain > 0) {
+			remain -= size;
+		}
+	}
+
+	const int err = stream->lastError();
+	if (err != 0) {
+		// Read error.
+		ret = -err;
+	} else if (ret == 0 && remain > 0) {
+		// Short read within the requested range.
+		ret = -EIO;
+	}
+
+	// Stop the worker threads.
+	for (auto iter = queues.begin(); iter != queues.end(); ++iter) {
+		HashTask task;
+		task.bufIdx = -1;
+		task.size = 0;
+		{
+			MutexLocker locker(iter->mutex);
+			iter->tasks.push_back(task);
+		}
+		iter->sem.release();
+	}
+	for (auto iter = threads.begin(); iter != threads.end(); ++iter) {
+		iter->join();
+	}
+
+	// Semaphores must be fully released before deletion.
+	freeSem = nullptr;
+	if (ret == 0) {
+		ret = hashError;
+	}
+	if (ret != 0) {
+		return ret;
+	}
+
+	// Get the hash values.
+	for (auto iter = queues.begin(); iter != queues.end(); ++iter) {
+		const int i = static_cast<int>(iter->hash->algorithm());
+		const size_t hash_len = Hash::hashLength(iter->hash->algorithm());
+		hasResult[i] = (iter->hash->getHash(results[i], hash_len) == 0);
+	}
+	return 0;
+}
+
+/** StreamHasher **/
+
+/**
+ * Create a StreamHasher.
+ *
+ * Algorithms that aren't usable on this system,
+ * e.g. SHA-1 if no crypto library is available,
+ * are skipped.
+ *
+ * @param algorithms Bitfield of hash algorithms. (1U << Hash::Algorithm)
+ */
+StreamHasher::StreamHasher(uint32_t algorithms)
+	: d_ptr(new StreamHasherPrivate(algorithms))
+{ }
+
+StreamHasher::~StreamHasher()
+{
+	delete d_ptr;
+}
+
+/**
+ * Set the size of each read buffer.
+ * Default is 1 MiB.
+ * @param bufferSize Buffer size, in bytes.
+ */
+void StreamHasher::setBufferSize(size_t bufferSize)
+{
+	RP_D(StreamHasher);
+	assert(bufferSize > 0);
+	d->bufferSize = (bufferSize > 0 ? bufferSize : 1024*1024);
+}
+
+/**
+ * Set the number of read buffers.
+ * More buffers allow the reader to get further
+ * ahead of the slowest hash algorithm.
+ * Default is 4.
+ * @param bufferCount Number of buffers.
+ */
+void StreamHasher::setBufferCount(unsigned int bufferCount)
+{
+	RP_D(StreamHasher);
+	assert(bufferCount > 0);
+	d->bufferCount = (bufferCount > 0 ? bufferCount : 4);
+}
+
+/**
+ * Hash the contents of a file.
+ *
+ * The file is read once from the beginning. Each buffer
+ * is processed by all hash algorithms in parallel using
+ * one worker thread per algorithm.
+ *
+ * @param file File.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int StreamHasher::process(IRpFile *file)
+{
+	RP_D(StreamHasher);
+	return d->processStream(file, 0, -1);
+}
+
+/**
+ * Hash part of a file.
+ * @param file File.
+ * @param offset Starting offset.
+ * @param length Length to hash.
+ * @return 0 on success; negative POSIX error code on error. (-EIO if the range is past EOF)
+ */
+int StreamHasher::process(IRpFile *file, off64_t offset, off64_t length)
+{
+	RP_D(StreamHasher);
+	assert(length >= 0);
+	if (length < 0) {
+		return -EINVAL;
+	}
+	return d->processStream(file, offset, length);
+}
+
+/**
+ * Hash the logical contents of a disc image.
+ * For compressed disc images, e.g. GCZ and CSO,
+ * the decompressed data is hashed.
+ * @param discReader Disc reader.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int StreamHasher::process(IDiscReader *discReader)
+{
+	RP_D(StreamHasher);
+	return d->processStream(discReader, 0, -1);
+}
+
+/**
+ * Hash part of a disc image's logical contents.
+ *
+ * This can be used to verify a section of a partition,
+ * e.g. an encrypted partition where the disc reader
+ * decrypts the data as it's read.
+ *
+ * @param discReader Disc reader.
+ * @param offset Starting offset.
+ * @param length Length to hash.
+ * @return 0 on success; negative POSIX error code on error. (-EIO if the range is past EOF)
+ */
+int StreamHasher::process(IDiscReader *discReader, off64_t offset, off64_t length)
+{
+	RP_D(StreamHasher);
+	assert(length >= 0);
+	if (length < 0) {
+		return -EINVAL;
+	}
+	return d->processStream(discReader, offset, length);
+}
+
+/**
+ * Was a hash calculated for the specified algorithm?
+ * @param algorithm Hash algorithm.
+ * @return True if available; false if not.
+ */
+bool StreamHasher::hasHash(Hash::Algorithm algorithm) const
+{
+	RP_D(const StreamHasher);
+	const int i = static_cast<int>(algorithm);
+	if (i < 0 || i >= static_cast<int>(Hash::Algorithm::Max))
+		return false;
+	return d->hasResult[i];
+}
+
+/**
+ * Get a hash value.
+ * @param algorithm	[in] Hash algorithm.
+ * @param pHash		[out] Output hash buffer.
+ * @param hash_len	[in] Size of hash buffer. (Must match Hash::hashLength().)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int StreamHasher::getHash(Hash::Algorithm algorithm, uint8_t *pHash, size_t hash_len) const
+{
+	RP_D(const StreamHasher);
+	assert(pHash != nullptr);
+	if (!pHash || hash_len != Hash::hashLength(algorithm)) {
+		return -EINVAL;
+	} else if (!hasHash(algorithm)) {
+		return -ENOENT;
+	}
+
+	memcpy(pHash, d->results[static_cast<int>(algorithm)], hash_len);
+	return 0;
+}
+
+/**
+ * Get a hash value as a lowercase hexadecimal string.
+ * @param algorithm Hash algorithm.
+ * @return Hash string, or empty string if not available.
+ */
+string StreamHasher::getHashString(Hash::Algorithm algorithm) const
+{
+	RP_D(const StreamHasher);
+	if (!hasHash(algorithm)) {
+		return string();
+	}
+
+	static const char hex_lookup[] = "0123456789abcdef";
+	const uint8_t *const pHash = d->results[static_cast<int>(algorithm)];
+	const size_t hash_len = Hash::hashLength(algorithm);
+	string s;
+	s.resize(hash_len * 2);
+	for (size_t i = 0; i < hash_len; i++) {
+		s[i*2] = hex_lookup[pHash[i] >> 4];
+		s[i*2+1] = hex_lookup[pHash[i] & 0x0F];
+	}
+	return s;
+}
+
+/**
+ * Get the number of bytes hashed.
+ * @return Number of bytes hashed.
+ */
+off64_t StreamHasher::bytesHashed(void) const
+{
+	RP_D(const StreamHasher);
+	return d->bytesHashed;
+}
+
+}
@@ -0,0 +1,148 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * StreamHasher.hpp: Single-pass multi-algorithm stream hasher.            *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_CRYPTO_STREAMHASHER_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_CRYPTO_STREAMHASHER_HPP__
+
+#include "Hash.hpp"
+
+// C++ includes.
+#include <string>
+
+namespace LibRpFile {
+	class IRpFile;
+}
+
+namespace LibRpBase {
+
+class IDiscReader;
+
+class StreamHasherPrivate;
+class StreamHasher
+{
+	public:
+		/**
+		 * Create a StreamHasher.
+		 *
+		 * Algorithms that aren't usable on this system,
+		 * e.g. SHA-1 if no crypto library is available,
+		 * are skipped.
+		 *
+		 * @param algorithms Bitfield of hash algorithms. (1U << Hash::Algorithm)
+		 */
+		explicit StreamHasher(uint32_t algorithms = ALL_ALGORITHMS);
+		~StreamHasher();
+
+	private:
+		RP_DISABLE_COPY(StreamHasher)
+	private:
+		friend class StreamHasherPrivate;
+		StreamHasherPrivate *const d_ptr;
+
+	public:
+		// All hash algorithms.
+		static const uint32_t ALL_ALGORITHMS = (1U << static_cast<int>(Hash::Algorithm::Max)) - 1;
+
+		/**
+		 * Set the size of each read buffer.
+		 * Default is 1 MiB.
+		 * @param bufferSize Buffer size, in bytes.
+		 */
+		void setBufferSize(size_t bufferSize);
+
+		/**
+		 * Set the number of read buffers.
+		 * More buffers allow the reader to get further
+		 * ahead of the slowest hash algorithm.
+		 * Default is 4.
+		 * @param bufferCount Number of buffers.
+		 */
+		void setBufferCount(unsigned int bufferCount);
+
+	public:
+		/**
+		 * Hash the contents of a file.
+		 *
+		 * The file is read once from the beginning. Each buffer
+		 * is processed by all hash algorithms in parallel using
+		 * one worker thread per algorithm.
+		 *
+		 * @param file File.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int process(LibRpFile::IRpFile *file);
+
+		/**
+		 * Hash part of a file.
+		 * @param file File.
+		 * @param offset Starting offset.
+		 * @param length Length to hash.
+		 * @return 0 on success; negative POSIX error code on error. (-EIO if the range is past EOF)
+		 */
+		int process(LibRpFile::IRpFile *file, off64_t offset, off64_t length);
+
+		/**
+		 * Hash the logical contents of a disc image.
+		 * For compressed disc images, e.g. GCZ and CSO,
+		 * the decompressed data is hashed.
+		 * @param discReader Disc reader.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int process(IDiscReader *discReader);
+
+		/**
+		 * Hash part of a disc image's logical contents.
+		 *
+		 * This can be used to verify a section of a partition,
+		 * e.g. an encrypted partition where the disc reader
+		 * decrypts the data as it's read.
+		 *
+		 * @param discReader Disc reader.
+		 * @param offset Starting offset.
+		 * @param length Length to hash.
+		 * @return 0 on success; negative POSIX error code on error. (-EIO if the range is past EOF)
+		 */
+		int process(IDiscReader *discReader, off64_t offset, off64_t length);
+
+	public:
+		/** Results from the last process() **/
+
+		/**
+		 * Was a hash calculated for the specified algorithm?
+		 * @param algorithm Hash algorithm.
+		 * @return True if available; false if not.
+		 */
+		bool hasHash(Hash::Algorithm algorithm) const;
+
+		/**
+		 * Get a hash value.
+		 * @param algorithm	[in] Hash algorithm.
+		 * @param pHash		[out] Output hash buffer.
+		 * @param hash_len	[in] Size of hash buffer. (Must match Hash::hashLength().)
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 3, 4)
+		int getHash(Hash::Algorithm algorithm, uint8_t *pHash, size_t hash_len) const;
+
+		/**
+		 * Get a hash value as a lowercase hexadecimal string.
+		 * @param algorithm Hash algorithm.
+		 * @return Hash string, or empty string if not available.
+		 */
+		std::string getHashString(Hash::Algorithm algorithm) const;
+
+		/**
+		 * Get the number of bytes hashed.
+		 * @return Number of bytes hashed.
+		 */
+		off64_t bytesHashed(void) const;
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_CRYPTO_STREAMHASHER_HPP__ */
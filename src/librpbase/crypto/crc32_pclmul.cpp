@@ -0,0 +1,128 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * crc32_pclmul.cpp: CRC32 calculation using PCLMULQDQ folding.            *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "crc32_pclmul.hpp"
+
+// SSE2 and PCLMULQDQ intrinsics.
+#include <emmintrin.h>
+#include <wmmintrin.h>
+
+namespace LibRpBase {
+
+/**
+ * Update a CRC32 using PCLMULQDQ folding.
+ *
+ * Reference: "Fast CRC Computation for Generic Polynomials
+ * Using PCLMULQDQ Instruction", Intel, 2009.
+ *
+ * NOTE: Check RP_CPU_HasPCLMULQDQ() before calling this function.
+ *
+ * @param crc	[in] Initial CRC32, as returned by zlib's crc32().
+ * @param buf	[in] Data buffer.
+ * @param len	[in] Data length. (Must be >= 64 and a multiple of 16.)
+ * @return Updated CRC32.
+ */
+uint32_t crc32_pclmul(uint32_t crc, const uint8_t *buf, size_t len)
+{
+	assert(len >= CRC32_PCLMUL_MIN_LENGTH);
+	assert(len % 16 == 0);
+
+	// Bit-reflected folding constants for the CRC32 polynomial. (0x04C11DB7)
+	// k1/k2: Fold by 4 (512 bits)
+	// k3/k4: Fold by 1 (128 bits)
+	// k5: Fold 96 bits to 64 bits
+	// poly: Barrett reduction constants (P(x)' and u')
+	static const ALIGNED_VAR(16, uint64_t k1k2[2]) = { 0x0154442bd4ULL, 0x01c6e41596ULL };
+	static const ALIGNED_VAR(16, uint64_t k3k4[2]) = { 0x01751997d0ULL, 0x00ccaa009eULL };
+	static const ALIGNED_VAR(16, uint64_t k5k0[2]) = { 0x0163cd6124ULL, 0x0000000000ULL };
+	static const ALIGNED_VAR(16, uint64_t poly[2]) = { 0x01db710641ULL, 0x01f7011641ULL };
+
+	__m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+	// Load the first 64 bytes and apply the initial CRC.
+	x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x00));
+	x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x10));
+	x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x20));
+	x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x30));
+	x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(~crc)));
+	buf += 64;
+	len -= 64;
+
+	// Fold 64 bytes at a time.
+	x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2));
+	for (; len >= 64; buf += 64, len -= 64) {
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+		x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+		x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+		x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+		x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x5),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x00)));
+		x2 = _mm_xor_si128(_mm_xor_si128(x2, x6),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x10)));
+		x3 = _mm_xor_si128(_mm_xor_si128(x3, x7),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x20)));
+		x4 = _mm_xor_si128(_mm_xor_si128(x4, x8),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x30)));
+	}
+
+	// Fold the four 128-bit values into one.
+	x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+	// Fold the remaining 16-byte blocks.
+	for (; len >= 16; buf += 16, len -= 16) {
+		x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf));
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+	}
+
+	// Fold 128 bits to 64 bits.
+	x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+	x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+	x1 = _mm_srli_si128(x1, 8);
+	x1 = _mm_xor_si128(x1, x2);
+
+	x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+	x2 = _mm_srli_si128(x1, 4);
+	x1 = _mm_and_si128(x1, x3);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	// Barrett reduction to 32 bits.
+	x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+	x2 = _mm_and_si128(x1, x3);
+	x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+	x2 = _mm_and_si128(x2, x3);
+	x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	// The CRC is in bits 32-63.
+	// NOTE: _mm_extract_epi32() requires SSE4.1.
+	return ~static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(x1, 4)));
+}
+
+}
@@ -0,0 +1,53 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * crc32_pclmul.hpp: CRC32 calculation using PCLMULQDQ folding.            *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_CRYPTO_CRC32_PCLMUL_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_CRYPTO_CRC32_PCLMUL_HPP__
+
+#include "common.h"
+
+// C includes.
+#include <stddef.h>	/* size_t */
+#include <stdint.h>
+
+#if defined(__i386__) || defined(__x86_64__) || \
+    defined(_M_IX86) || defined(_M_X64)
+# define CRC32_HAS_PCLMUL 1
+#endif
+
+#ifdef CRC32_HAS_PCLMUL
+
+namespace LibRpBase {
+
+/**
+ * Minimum length for crc32_pclmul().
+ * Shorter blocks should use zlib's crc32().
+ */
+#define CRC32_PCLMUL_MIN_LENGTH 64
+
+/**
+ * Update a CRC32 using PCLMULQDQ folding.
+ *
+ * Reference: "Fast CRC Computation for Generic Polynomials
+ * Using PCLMULQDQ Instruction", Intel, 2009.
+ *
+ * NOTE: Check RP_CPU_HasPCLMULQDQ() before calling this function.
+ *
+ * @param crc	[in] Initial CRC32, as returned by zlib's crc32().
+ * @param buf	[in] Data buffer.
+ * @param len	[in] Data length. (Must be >= 64 and a multiple of 16.)
+ * @return Updated CRC32.
+ */
+ATTR_ACCESS_SIZE(read_only, 2, 3)
+uint32_t crc32_pclmul(uint32_t crc, const uint8_t *buf, size_t len);
+
+}
+
+#endif /* CRC32_HAS_PCLMUL */
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_CRYPTO_CRC32_PCLMUL_HPP__ */
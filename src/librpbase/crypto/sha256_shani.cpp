@@ -0,0 +1,133 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * sha256_shani.cpp: SHA-256 block function using the SHA extensions.     *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "sha256_shani.hpp"
+
+// SSSE3, SSE4.1, and SHA intrinsics.
+#include <tmmintrin.h>
+#include <smmintrin.h>
+#include <immintrin.h>
+
+namespace LibRpBase {
+
+// SHA-256 round constants.
+static const ALIGNED_VAR(16, uint32_t K256[64]) = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+	0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+	0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+	0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+	0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+	0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+	0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+	0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+	0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+/**
+ * Process SHA-256 blocks using the SHA extensions.
+ *
+ * NOTE: Check RP_CPU_HasSHA() before calling this function.
+ *
+ * @param state		[in/out] SHA-256 state. (H0-H7)
+ * @param data		[in] Data. (Must be blocks * 64 bytes.)
+ * @param blocks	[in] Number of 64-byte blocks.
+ */
+void sha256_shani_compress(uint32_t state[8], const uint8_t *data, size_t blocks)
+{
+	// Byteswap mask for loading big-endian message words.
+	const __m128i MASK = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+	// Load the state and rearrange it into ABEF and CDGH.
+	__m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0]));	// DCBA
+	__m128i state1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4]));	// HGFE
+	tmp = _mm_shuffle_epi32(tmp, 0xB1);		// CDAB
+	state1 = _mm_shuffle_epi32(state1, 0x1B);	// EFGH
+	__m128i state0 = _mm_alignr_epi8(tmp, state1, 8);	// ABEF
+	state1 = _mm_blend_epi16(state1, tmp, 0xF0);		// CDGH
+
+	for (; blocks > 0; blocks--, data += 64) {
+		const __m128i abef_save = state0;
+		const __m128i cdgh_save = state1;
+		__m128i msg, msgtmp;
+
+		// Load the message and convert it to big-endian.
+		__m128i msg0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00)), MASK);
+		__m128i msg1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10)), MASK);
+		__m128i msg2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20)), MASK);
+		__m128i msg3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30)), MASK);
+
+		// Rounds 0-3
+		msg = _mm_add_epi32(msg0, _mm_load_si128(reinterpret_cast<const __m128i*>(&K256[0])));
+		state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+		msg = _mm_shuffle_epi32(msg, 0x0E);
+		state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+		// Rounds 4-7
+		msg = _mm_add_epi32(msg1, _mm_load_si128(reinterpret_cast<const __m128i*>(&K256[4])));
+		state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+		msg = _mm_shuffle_epi32(msg, 0x0E);
+		state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+		msg0 = _mm_sha256msg1_epu32(msg0, msg1);
+
+		// Rounds 8-11
+		msg = _mm_add_epi32(msg2, _mm_load_si128(reinterpret_cast<const __m128i*>(&K256[8])));
+		state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+		msg = _mm_shuffle_epi32(msg, 0x0E);
+		state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+		msg1 = _mm_sha256msg1_epu32(msg1, msg2);
+
+		// Rounds 12-59: The message schedule repeats every 16 rounds.
+		// Each group of 4 rounds uses msg3, then rotates the message words.
+		for (unsigned int i = 12; i < 60; i += 4) {
+			msg = _mm_add_epi32(msg3, _mm_load_si128(reinterpret_cast<const __m128i*>(&K256[i])));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			msgtmp = _mm_alignr_epi8(msg3, msg2, 4);
+			msg0 = _mm_add_epi32(msg0, msgtmp);
+			msg0 = _mm_sha256msg2_epu32(msg0, msg3);
+			msg = _mm_shuffle_epi32(msg, 0x0E);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+			msg2 = _mm_sha256msg1_epu32(msg2, msg3);
+
+			// Rotate the message words: (msg0, msg1, msg2, msg3) -> (msg1, msg2, msg3, msg0)
+			msgtmp = msg0;
+			msg0 = msg1;
+			msg1 = msg2;
+			msg2 = msg3;
+			msg3 = msgtmp;
+		}
+
+		// Rounds 60-63
+		msg = _mm_add_epi32(msg3, _mm_load_si128(reinterpret_cast<const __m128i*>(&K256[60])));
+		state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+		msg = _mm_shuffle_epi32(msg, 0x0E);
+		state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+		// Add this block's hash to the state.
+		state0 = _mm_add_epi32(state0, abef_save);
+		state1 = _mm_add_epi32(state1, cdgh_save);
+	}
+
+	// Rearrange ABEF and CDGH back into DCBA and HGFE.
+	tmp = _mm_shuffle_epi32(state0, 0x1B);		// FEBA
+	state1 = _mm_shuffle_epi32(state1, 0xB1);	// DCHG
+	state0 = _mm_blend_epi16(tmp, state1, 0xF0);	// DCBA
+	state1 = _mm_alignr_epi8(state1, tmp, 8);	// HGFE
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+}
+
+}
@@ -0,0 +1,42 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * sha256_shani.hpp: SHA-256 block function using the SHA extensions.     *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_CRYPTO_SHA256_SHANI_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_CRYPTO_SHA256_SHANI_HPP__
+
+#include "common.h"
+
+// C includes.
+#include <stddef.h>	/* size_t */
+#include <stdint.h>
+
+#if defined(__i386__) || defined(__x86_64__) || \
+    defined(_M_IX86) || defined(_M_X64)
+# define SHA256_HAS_SHANI 1
+#endif
+
+#ifdef SHA256_HAS_SHANI
+
+namespace LibRpBase {
+
+/**
+ * Process SHA-256 blocks using the SHA extensions.
+ *
+ * NOTE: Check RP_CPU_HasSHA() before calling this function.
+ *
+ * @param state		[in/out] SHA-256 state. (H0-H7)
+ * @param data		[in] Data. (Must be blocks * 64 bytes.)
+ * @param blocks	[in] Number of 64-byte blocks.
+ */
+void sha256_shani_compress(uint32_t state[8], const uint8_t *data, size_t blocks);
+
+}
+
+#endif /* SHA256_HAS_SHANI */
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_CRYPTO_SHA256_SHANI_HPP__ */
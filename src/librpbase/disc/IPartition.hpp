@@ -10,6 +10,10 @@
 #define __ROMPROPERTIES_LIBRPBASE_DISC_IPARTITION_HPP__
 
 #include "IDiscReader.hpp"
+#include "IFst.hpp"
+
+// C includes. (C++ namespace)
+#include <cerrno>
 
 namespace LibRpBase {
 
@@ -59,6 +63,70 @@ class IPartition : public IDiscReader
 		 * @return Used partition size, or -1 on error.
 		 */
 		virtual off64_t partition_size_used(void) const = 0;
+
+	public:
+		/** IFst wrapper functions. **/
+
+		// These functions are optional. The default implementations
+		// indicate that the partition doesn't have a file system.
+
+		/**
+		 * Open a directory.
+		 * @param path	[in] Directory path.
+		 * @return IFst::Dir*, or nullptr on error.
+		 */
+		virtual IFst::Dir *opendir(const char *path)
+		{
+			RP_UNUSED(path);
+			m_lastError = ENOTSUP;
+			return nullptr;
+		}
+
+		/**
+		 * Open a directory.
+		 * @param path	[in] Directory path.
+		 * @return IFst::Dir*, or nullptr on error.
+		 */
+		inline IFst::Dir *opendir(const std::string &path)
+		{
+			return opendir(path.c_str());
+		}
+
+		/**
+		 * Read a directory entry.
+		 * @param dirp IFst::Dir pointer.
+		 * @return IFst::DirEnt, or nullptr if end of directory or on error.
+		 * (TODO: Add lastError()?)
+		 */
+		virtual IFst::DirEnt *readdir(IFst::Dir *dirp)
+		{
+			RP_UNUSED(dirp);
+			m_lastError = ENOTSUP;
+			return nullptr;
+		}
+
+		/**
+		 * Close an opened directory.
+		 * @param dirp IFst::Dir pointer.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		virtual int closedir(IFst::Dir *dirp)
+		{
+			RP_UNUSED(dirp);
+			return -ENOTSUP;
+		}
+
+		/**
+		 * Open a file. (read-only)
+		 * @param filename Filename.
+		 * @return IRpFile*, or nullptr on error.
+		 */
+		virtual LibRpFile::IRpFile *open(const char *filename)
+		{
+			RP_UNUSED(filename);
+			m_lastError = ENOTSUP;
+			return nullptr;
+		}
 };
 
 /**
@@ -104,16 +104,19 @@ size_t SparseDiscReader::read(void *ptr, size_t size)
 	}
 
 	// Read entire blocks.
-	for (; size >= block_size;
-	    size -= block_size, ptr8 += block_size,
-	    ret += block_size, d->pos += block_size)
-	{
+	if (size >= block_size) {
 		assert(d->pos % block_size == 0);
 		const unsigned int blockIdx = static_cast<unsigned int>(d->pos / block_size);
-		int rd = this->readBlock(blockIdx, 0, ptr8, block_size);
-		if (rd < 0 || rd != static_cast<int>(block_size)) {
+		const size_t blockCount = size / block_size;
+		const size_t blocksRead = this->readBlocks(blockIdx, ptr8, blockCount);
+		const size_t bytesRead = blocksRead * block_size;
+		size -= bytesRead;
+		ptr8 += bytesRead;
+		ret += bytesRead;
+		d->pos += bytesRead;
+		if (blocksRead != blockCount) {
 			// Error reading the data.
-			return ret + (rd > 0 ? rd : 0);
+			return ret;
 		}
 	}
 
@@ -263,4 +266,32 @@ int SparseDiscReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t si
 	return (sz_read > 0 ? (int)sz_read : -1);
 }
 
+/**
+ * Read multiple full blocks.
+ *
+ * The default implementation calls readBlock() for each block.
+ * Subclasses can override this to read multiple blocks with
+ * a single I/O operation.
+ *
+ * @param blockIdx	[in] First block index.
+ * @param ptr		[out] Output data buffer. (Must be at least blockCount * block_size bytes!)
+ * @param blockCount	[in] Number of blocks to read.
+ * @return Number of full blocks read.
+ */
+size_t SparseDiscReader::readBlocks(uint32_t blockIdx, void *ptr, size_t blockCount)
+{
+	RP_D(const SparseDiscReader);
+	const unsigned int block_size = d->block_size;
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t blocksRead = 0;
+	for (; blocksRead < blockCount; blocksRead++, blockIdx++, ptr8 += block_size) {
+		int rd = this->readBlock(blockIdx, 0, ptr8, block_size);
+		if (rd != static_cast<int>(block_size)) {
+			// Error reading the data.
+			break;
+		}
+	}
+	return blocksRead;
+}
+
 }
@@ -94,6 +94,20 @@ class SparseDiscReader : public IDiscReader
 		 */
 		ATTR_ACCESS_SIZE(write_only, 4, 5)
 		virtual int readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size);
+
+		/**
+		 * Read multiple full blocks.
+		 *
+		 * The default implementation calls readBlock() for each block.
+		 * Subclasses can override this to read multiple blocks with
+		 * a single I/O operation.
+		 *
+		 * @param blockIdx	[in] First block index.
+		 * @param ptr		[out] Output data buffer. (Must be at least blockCount * block_size bytes!)
+		 * @param blockCount	[in] Number of blocks to read.
+		 * @return Number of full blocks read.
+		 */
+		virtual size_t readBlocks(uint32_t blockIdx, void *ptr, size_t blockCount);
 };
 
 }
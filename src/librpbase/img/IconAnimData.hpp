@@ -2,7 +2,7 @@
  * ROM Properties Page shell extension. (librpbase)                        *
  * IconAnimData.hpp: Icon animation data.                                  *
  *                                                                         *
- * Copyright (c) 2016 by David Korth.                                      *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
  * SPDX-License-Identifier: GPL-2.0-or-later                               *
  ***************************************************************************/
 
@@ -16,6 +16,7 @@
 #include <stdint.h>
 
 // C includes. (C++ namespace)
+#include <cassert>
 #include <cstring>
 
 // C++ includes.
@@ -61,14 +62,22 @@ struct IconAnimData : public RefBase
 	// the previous frame should be used.
 	// NOTE 2: Frames stored here must be ref()'d.
 	// They will be automatically unref()'d in the destructor.
+	// NOTE 3: Frames should be unique. Repeated frames should
+	// be added once using addFrame() and referenced multiple
+	// times in seq_index[].
 	std::array<LibRpTexture::rp_image*, MAX_FRAMES> frames;
 
+	// Source data hashes for each frame. (See hashData().)
+	// 0 indicates the frame has no hash.
+	std::array<uint64_t, MAX_FRAMES> frame_hash;
+
 	IconAnimData()
 		: count(0)
 		, seq_count(0)
 	{
 		seq_index.fill(0);
 		frames.fill(0);
+		frame_hash.fill(0);
 
 		// MSVC 2010 doesn't support initializer lists,
 		// so create a dummy struct.
@@ -112,6 +121,100 @@ public:
 	{
 		const_cast<IconAnimData*>(this)->RefBase::unref();
 	}
+
+public:
+	/** Frame deduplication **/
+
+	// Initial value for hashData(). (64-bit FNV-1a offset basis)
+	static const uint64_t HASH_INIT = 0xCBF29CE484222325ULL;
+
+	/**
+	 * Hash a frame's source data. (64-bit FNV-1a)
+	 *
+	 * Calls can be chained to hash the bitmap and palette
+	 * of a frame by passing the previous return value as hash.
+	 * The hash should be calculated *before* decoding so
+	 * repeated frames don't have to be decoded again.
+	 *
+	 * @param data Source data.
+	 * @param size Size of data.
+	 * @param hash Previous hash value.
+	 * @return New hash value.
+	 */
+	static inline uint64_t hashData(const void *data, size_t size, uint64_t hash = HASH_INIT)
+	{
+		const uint8_t *p = static_cast<const uint8_t*>(data);
+		for (; size > 0; size--, p++) {
+			hash ^= *p;
+			hash *= 0x100000001B3ULL;
+		}
+		// 0 is reserved for "no hash".
+		return (hash != 0 ? hash : 1);
+	}
+
+	/**
+	 * Find a frame that was added with the specified source data hash.
+	 * @param hash Source data hash from hashData().
+	 * @return Frame index, or -1 if not found.
+	 */
+	inline int findFrame(uint64_t hash) const
+	{
+		if (hash == 0)
+			return -1;
+		for (int i = 0; i < count; i++) {
+			if (frame_hash[i] == hash && frames[i] != nullptr)
+				return i;
+		}
+		return -1;
+	}
+
+	/**
+	 * Add a unique frame.
+	 * The frame is owned by IconAnimData on success.
+	 * On failure, the caller must unref() the frame.
+	 * @param img Frame. (may be nullptr for a blank frame)
+	 * @param hash Source data hash from hashData(), or 0 if none.
+	 * @return Frame index, or -1 if the frame array is full.
+	 */
+	inline int addFrame(LibRpTexture::rp_image *img, uint64_t hash)
+	{
+		assert(count >= 0 && count <= MAX_FRAMES);
+		if (count < 0 || count >= MAX_FRAMES)
+			return -1;
+		frames[count] = img;
+		frame_hash[count] = hash;
+		return count++;
+	}
+
+	/**
+	 * Do all CI8 frames share the same palette?
+	 *
+	 * If so, an animated PNG can be written using a single
+	 * PLTE chunk. Otherwise, the frames must be converted
+	 * to ARGB32 first.
+	 *
+	 * @return True if all valid CI8 frames have identical palettes, or if there are no CI8 frames.
+	 */
+	bool hasSharedPalette(void) const
+	{
+		const uint32_t *pal0 = nullptr;
+		int pal0_len = 0;
+		for (int i = 0; i < count; i++) {
+			const LibRpTexture::rp_image *const img = frames[i];
+			if (!img || img->format() != LibRpTexture::rp_image::Format::CI8)
+				continue;
+
+			if (!pal0) {
+				pal0 = img->palette();
+				pal0_len = img->palette_len();
+			} else if (img->palette() != pal0 && (img->palette_len() != pal0_len ||
+			           memcmp(img->palette(), pal0, pal0_len * sizeof(uint32_t)) != 0))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
 };
 
 }
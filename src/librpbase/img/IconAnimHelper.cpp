@@ -18,9 +18,11 @@ namespace LibRpBase {
 void IconAnimHelper::reset(void)
 {
 	if (m_iconAnimData) {
-		assert(m_iconAnimData->count > 1);
+		// NOTE: count may be 1 if all frames in the
+		// sequence were identical and deduplicated.
+		assert(m_iconAnimData->count > 0);
 		assert(m_iconAnimData->count <= (int)m_iconAnimData->frames.size());
-		assert(m_iconAnimData->seq_count > 1);
+		assert(m_iconAnimData->seq_count > 0);
 		assert(m_iconAnimData->seq_count <= (int)m_iconAnimData->seq_index.size());
 		m_seq_idx = 0;
 		m_frame = m_iconAnimData->seq_index[0];
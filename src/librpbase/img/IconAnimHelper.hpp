@@ -72,14 +72,17 @@ class IconAnimHelper
 		 * This checks if iconAnimData is set and has an animation
 		 * sequence that refers to more than one frame.
 		 *
+		 * NOTE: IconAnimData frames are unique, so an animation
+		 * whose frames are all identical has a single frame and
+		 * is not considered to be animated.
+		 *
 		 * @return True if this is an animated icon; false if not.
 		 */
 		bool isAnimated(void) const
 		{
-			// TODO: Verify that the sequence references more than one frame?
 			return (m_iconAnimData &&
-				m_iconAnimData->count > 0 &&
-				m_iconAnimData->seq_count > 0);
+				m_iconAnimData->count > 1 &&
+				m_iconAnimData->seq_count > 1);
 		}
 
 		/**
@@ -166,6 +166,13 @@ class RpPngWriterPrivate
 		void init(IRpFile *file, const rp_image *img);
 		void init(IRpFile *file, const IconAnimData *iconAnimData);
 
+		/**
+		 * Initialize the APNG frame list from iconAnimData.
+		 * cache must be initialized from the first frame.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int init_APNG_frames(void);
+
 	private:
 		RP_DISABLE_COPY(RpPngWriterPrivate)
 
@@ -276,6 +283,20 @@ class RpPngWriterPrivate
 		// Current state.
 		bool IHDR_written;
 
+		// APNG frames.
+		// Consecutive sequence entries that reference the
+		// same IconAnimData frame are merged into one APNG frame.
+		struct apng_frame_t {
+			const rp_image *img;
+			uint16_t numer;
+			uint16_t denom;
+		};
+		vector<apng_frame_t> apng_frames;
+
+		// Temporary ARGB32 frames, used if the CI8 frames
+		// don't share a palette. These must be unref()'d.
+		vector<rp_image*> apng_tmp_frames;
+
 	public:
 		/**
 		 * Initialize the PNG write structs.
@@ -496,11 +517,17 @@ void RpPngWriterPrivate::init(IRpFile *file, const IconAnimData *iconAnimData)
 	}
 #endif /* defined(_MSC_VER) && (defined(ZLIB_IS_DLL) || defined(PNG_IS_DLL)) */
 
-	if (iconAnimData->seq_count > 1) {
+	if (iconAnimData->seq_count > 1 && iconAnimData->count > 1) {
 		// Load APNG.
+		// NOTE: If all frames were deduplicated into a single frame,
+		// a standard PNG image will be written instead.
 		int ret = APNG_ref();
 		if (ret != 0) {
 			// Error loading APNG.
+			// NOTE: APNG_unref() must be called even on failure.
+			// Otherwise, the next APNG_ref() will succeed without
+			// actually loading APNG.
+			APNG_unref();
 			lastError = ENOTSUP;
 			return;
 		}
@@ -545,6 +572,16 @@ void RpPngWriterPrivate::init(IRpFile *file, const IconAnimData *iconAnimData)
 			imageTag = ImageTag::Invalid;
 		}
 		cache.setFrom(img0);
+
+		ret = init_APNG_frames();
+		if (ret != 0) {
+			// Invalid animated image.
+			// NOTE: The destructor won't unreference APNG
+			// if imageTag is Invalid, so do it here.
+			APNG_unref();
+			lastError = -ret;
+			imageTag = ImageTag::Invalid;
+		}
 	} else {
 		this->img = iconAnimData->frames[iconAnimData->seq_index[0]];
 		cache.setFrom(img);
@@ -562,10 +599,90 @@ void RpPngWriterPrivate::init(IRpFile *file, const IconAnimData *iconAnimData)
 	}
 }
 
+/**
+ * Initialize the APNG frame list from iconAnimData.
+ * cache must be initialized from the first frame.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpPngWriterPrivate::init_APNG_frames(void)
+{
+	assert(iconAnimData != nullptr);
+	if (!iconAnimData) {
+		return -EINVAL;
+	}
+
+	// If the CI8 frames have different palettes, they can't
+	// share a single PLTE chunk. Convert them to ARGB32.
+	// This is also needed if CI8 and ARGB32 frames are mixed.
+	bool has_CI8 = false, has_ARGB32 = false;
+	for (int i = 0; i < iconAnimData->count; i++) {
+		const rp_image *const img = iconAnimData->frames[i];
+		if (!img)
+			continue;
+		if (img->format() == rp_image::Format::CI8) {
+			has_CI8 = true;
+		} else {
+			has_ARGB32 = true;
+		}
+	}
+	const bool convert = (has_CI8 && (has_ARGB32 || !iconAnimData->hasSharedPalette()));
+
+	array<const rp_image*, IconAnimData::MAX_FRAMES> frames;
+	frames.fill(nullptr);
+	for (int i = 0; i < iconAnimData->count; i++) {
+		const rp_image *img = iconAnimData->frames[i];
+		if (convert && img && img->format() == rp_image::Format::CI8) {
+			rp_image *const img32 = img->dup_ARGB32();
+			if (img32) {
+				apng_tmp_frames.push_back(img32);
+			}
+			img = img32;
+		}
+		frames[i] = img;
+	}
+	if (convert) {
+		// Re-cache the image parameters from the converted first frame.
+		cache.setFrom(frames[iconAnimData->seq_index[0]]);
+	}
+
+	// Build the frame list. Consecutive sequence entries that
+	// reference the same frame are written as a single frame.
+	apng_frames.reserve(iconAnimData->seq_count);
+	int last_frame = -1;
+	for (int i = 0; i < iconAnimData->seq_count; i++) {
+		const int frame = iconAnimData->seq_index[i];
+		assert(frame < iconAnimData->count);
+		if (frame >= iconAnimData->count || !frames[frame])
+			break;
+
+		const IconAnimData::delay_t &delay = iconAnimData->delays[i];
+		if (frame == last_frame) {
+			apng_frame_t &prev = apng_frames.back();
+			if (prev.denom == delay.denom &&
+			    static_cast<unsigned int>(prev.numer) + delay.numer <= 0xFFFFU)
+			{
+				// Same frame. Extend the previous frame's delay.
+				prev.numer += delay.numer;
+				continue;
+			}
+		}
+
+		const apng_frame_t apng_frame = {frames[frame], delay.numer, delay.denom};
+		apng_frames.push_back(apng_frame);
+		last_frame = frame;
+	}
+
+	return (!apng_frames.empty() ? 0 : -EINVAL);
+}
+
 RpPngWriterPrivate::~RpPngWriterPrivate()
 {
 	this->close();
 
+	for (auto iter = apng_tmp_frames.begin(); iter != apng_tmp_frames.end(); ++iter) {
+		(*iter)->unref();
+	}
+
 	if (imageTag == ImageTag::IconAnimData) {
 		// Unreference APNG.
 		APNG_unref();
@@ -877,10 +994,9 @@ int RpPngWriterPrivate::write_IDAT_APNG(void)
 	}
 
 	// Write the images.
-	for (int i = 0; i < iconAnimData->seq_count; i++) {
-		const rp_image *const img = iconAnimData->frames[iconAnimData->seq_index[i]];
-		if (!img)
-			break;
+	for (size_t i = 0; i < apng_frames.size(); i++) {
+		const apng_frame_t &apng_frame = apng_frames[i];
+		const rp_image *const img = apng_frame.img;
 
 		// Initialize the row pointers array.
 		for (int y = cache.height-1; y >= 0; y--) {
@@ -890,13 +1006,15 @@ int RpPngWriterPrivate::write_IDAT_APNG(void)
 		// Frame header.
 		png_write_frame_head(png_ptr, info_ptr, (png_bytepp)row_pointers,
 				cache.width, cache.height, 0, 0,	// width, height, x offset, y offset
-				iconAnimData->delays[i].numer,
-				iconAnimData->delays[i].denom,
+				apng_frame.numer,
+				apng_frame.denom,
 				PNG_DISPOSE_OP_NONE,
 				PNG_BLEND_OP_SOURCE);
 
 		// Write the image data.
-		// TODO: Individual palette for CI8?
+		// NOTE: CI8 frames share the first frame's palette.
+		// If the palettes differ, the frames were converted
+		// to ARGB32 by init_APNG_frames().
 		png_write_image(png_ptr, (png_bytepp)row_pointers);
 
 		// Frame tail.
@@ -1170,7 +1288,9 @@ int RpPngWriter::write_IHDR(void)
 
 	if (d->imageTag == RpPngWriterPrivate::ImageTag::IconAnimData) {
 		// Write an acTL chunk to indicate that this is an APNG image.
-		png_set_acTL(d->png_ptr, d->info_ptr, d->iconAnimData->seq_count, 0);
+		// NOTE: Merged frames are only counted once.
+		png_set_acTL(d->png_ptr, d->info_ptr,
+			static_cast<png_uint_32>(d->apng_frames.size()), 0);
 	}
 
 #ifdef PNG_sBIT_SUPPORTED
@@ -0,0 +1,285 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * FieldCacheTest.cpp: FieldCache serialization test.                      *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+#include "../FieldCache.hpp"
+#include "../RomFields.hpp"
+#include "../RomMetaData.hpp"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRpBase { namespace Tests {
+
+class FieldCacheTest : public ::testing::Test
+{
+	protected:
+		/**
+		 * Create a RomFields object with every serializable field type.
+		 * @param fields RomFields.
+		 */
+		static void initFields(RomFields *fields);
+};
+
+/**
+ * Create a RomFields object with every serializable field type.
+ * @param fields RomFields.
+ */
+void FieldCacheTest::initFields(RomFields *fields)
+{
+	fields->setTabName(0, "General");
+	fields->addField_string("String", "Test string", RomFields::STRF_MONOSPACE);
+	fields->addField_string("Null string", nullptr);
+
+	static const char *const bitfield_names[] = {
+		"Bit 0", "Bit 1", nullptr, "Bit 3",
+	};
+	vector<string> *const v_bitfield_names = RomFields::strArrayToVector(
+		bitfield_names, ARRAY_SIZE(bitfield_names));
+	fields->addField_bitfield("Bitfield", v_bitfield_names, 3, 0x0B);
+
+	fields->addField_dateTime("Date/Time", 1234567890,
+		RomFields::RFT_DATETIME_HAS_DATE | RomFields::RFT_DATETIME_HAS_TIME);
+	fields->addField_dimensions("Dimensions", 640, 480, -1);
+
+	fields->addTab("Lists");
+	RomFields::age_ratings_t age_ratings;
+	age_ratings.fill(0);
+	age_ratings[RomFields::AGE_USA] = RomFields::AGEBF_ACTIVE | 13;
+	age_ratings[RomFields::AGE_EUROPE] = RomFields::AGEBF_ACTIVE | RomFields::AGEBF_ONLINE_PLAY | 12;
+	fields->addField_ageRatings("Age Ratings", age_ratings);
+
+	// Single-language ListData with checkboxes.
+	static const char *const headers[] = {"Name", "Value"};
+	vector<string> *const v_headers = RomFields::strArrayToVector(headers, ARRAY_SIZE(headers));
+	auto *const list_data = new RomFields::ListData_t(3);
+	(*list_data)[0].push_back("a");
+	(*list_data)[0].push_back("1");
+	(*list_data)[1].push_back("b");
+	(*list_data)[1].push_back("");
+	(*list_data)[2].push_back("\xE6\x97\xA5\xE6\x9C\xAC");	// UTF-8
+	(*list_data)[2].push_back("3");
+	RomFields::AFLD_PARAMS params(RomFields::RFT_LISTDATA_CHECKBOXES | RomFields::RFT_LISTDATA_SEPARATE_ROW, 4);
+	params.alignment.headers = AFLD_ALIGN2(TXA_L, TXA_R);
+	params.alignment.data = AFLD_ALIGN2(TXA_C, TXA_D);
+	params.headers = v_headers;
+	params.data.single = list_data;
+	params.mxd.checkboxes = 0x5;
+	fields->addField_listData("ListData", &params);
+
+	// Multi-language ListData.
+	auto *const list_data_multi = new RomFields::ListDataMultiMap_t();
+	(*list_data_multi)['en'].resize(1);
+	(*list_data_multi)['en'][0].push_back("Hello");
+	(*list_data_multi)['es'].resize(1);
+	(*list_data_multi)['es'][0].push_back("Hola");
+	RomFields::AFLD_PARAMS params_multi(RomFields::RFT_LISTDATA_MULTI, 0);
+	params_multi.def_lc = 'es';
+	params_multi.data.multi = list_data_multi;
+	fields->addField_listData("ListData (multi)", &params_multi);
+
+	// Multi-language string.
+	auto *const str_multi = new RomFields::StringMultiMap_t();
+	(*str_multi)['en'] = "Title";
+	(*str_multi)['fr'] = "Titre";
+	fields->addField_string_multi("String (multi)", str_multi, 'es');
+}
+
+/**
+ * Compare two RomFields objects.
+ * @param expected Expected RomFields.
+ * @param actual Actual RomFields.
+ */
+static void compareFields(const RomFields *expected, const RomFields *actual)
+{
+	ASSERT_EQ(expected->count(), actual->count());
+	ASSERT_EQ(expected->tabCount(), actual->tabCount());
+	EXPECT_EQ(expected->defaultLanguageCode(), actual->defaultLanguageCode());
+	for (int i = 0; i < expected->tabCount(); i++) {
+		const char *const tabExp = expected->tabName(i);
+		const char *const tabAct = actual->tabName(i);
+		EXPECT_EQ(string(tabExp ? tabExp : ""), string(tabAct ? tabAct : ""));
+	}
+
+	for (int i = 0; i < expected->count(); i++) {
+		const RomFields::Field *const exp = expected->at(i);
+		const RomFields::Field *const act = actual->at(i);
+		ASSERT_TRUE(exp != nullptr);
+		ASSERT_TRUE(act != nullptr);
+		EXPECT_EQ(exp->name, act->name);
+		ASSERT_EQ(exp->type, act->type);
+		EXPECT_EQ(exp->tabIdx, act->tabIdx);
+		EXPECT_EQ(exp->isValid, act->isValid);
+
+		switch (exp->type) {
+			case RomFields::RFT_STRING:
+				EXPECT_EQ(exp->desc.flags, act->desc.flags);
+				ASSERT_EQ(exp->data.str == nullptr, act->data.str == nullptr);
+				if (exp->data.str) {
+					EXPECT_EQ(*exp->data.str, *act->data.str);
+				}
+				break;
+			case RomFields::RFT_BITFIELD:
+				EXPECT_EQ(exp->desc.bitfield.elemsPerRow, act->desc.bitfield.elemsPerRow);
+				EXPECT_EQ(*exp->desc.bitfield.names, *act->desc.bitfield.names);
+				EXPECT_EQ(exp->data.bitfield, act->data.bitfield);
+				break;
+			case RomFields::RFT_LISTDATA:
+				EXPECT_EQ(exp->desc.list_data.flags, act->desc.list_data.flags);
+				EXPECT_EQ(exp->desc.list_data.rows_visible, act->desc.list_data.rows_visible);
+				EXPECT_EQ(exp->desc.list_data.alignment.headers, act->desc.list_data.alignment.headers);
+				EXPECT_EQ(exp->desc.list_data.alignment.data, act->desc.list_data.alignment.data);
+				ASSERT_EQ(exp->desc.list_data.names == nullptr, act->desc.list_data.names == nullptr);
+				if (exp->desc.list_data.names) {
+					EXPECT_EQ(*exp->desc.list_data.names, *act->desc.list_data.names);
+				}
+				if (exp->desc.list_data.flags & RomFields::RFT_LISTDATA_CHECKBOXES) {
+					EXPECT_EQ(exp->data.list_data.mxd.checkboxes, act->data.list_data.mxd.checkboxes);
+				}
+				if (exp->desc.list_data.flags & RomFields::RFT_LISTDATA_MULTI) {
+					EXPECT_EQ(*exp->data.list_data.data.multi, *act->data.list_data.data.multi);
+				} else {
+					EXPECT_EQ(*exp->data.list_data.data.single, *act->data.list_data.data.single);
+				}
+				break;
+			case RomFields::RFT_DATETIME:
+				EXPECT_EQ(exp->desc.flags, act->desc.flags);
+				EXPECT_EQ(exp->data.date_time, act->data.date_time);
+				break;
+			case RomFields::RFT_AGE_RATINGS:
+				EXPECT_EQ(*exp->data.age_ratings, *act->data.age_ratings);
+				break;
+			case RomFields::RFT_DIMENSIONS:
+				EXPECT_EQ(exp->data.dimensions[0], act->data.dimensions[0]);
+				EXPECT_EQ(exp->data.dimensions[1], act->data.dimensions[1]);
+				EXPECT_EQ(exp->data.dimensions[2], act->data.dimensions[2]);
+				break;
+			case RomFields::RFT_STRING_MULTI:
+				EXPECT_EQ(exp->desc.flags, act->desc.flags);
+				EXPECT_EQ(*exp->data.str_multi, *act->data.str_multi);
+				break;
+			default:
+				FAIL() << "Unexpected field type: " << static_cast<int>(exp->type);
+				break;
+		}
+	}
+}
+
+/**
+ * Serialize and deserialize a RomFields object.
+ */
+TEST_F(FieldCacheTest, fieldsRoundTrip)
+{
+	RomFields fields;
+	initFields(&fields);
+
+	ao::uvector<uint8_t> buf;
+	ASSERT_EQ(0, FieldCache::serializeFields(&fields, buf));
+	ASSERT_FALSE(buf.empty());
+
+	RomFields fields2;
+	ASSERT_EQ(0, FieldCache::deserializeFields(&fields2, buf.data(), buf.size()));
+	compareFields(&fields, &fields2);
+
+	// Serializing the deserialized fields should produce identical data.
+	ao::uvector<uint8_t> buf2;
+	ASSERT_EQ(0, FieldCache::serializeFields(&fields2, buf2));
+	ASSERT_EQ(buf.size(), buf2.size());
+	EXPECT_EQ(0, memcmp(buf.data(), buf2.data(), buf.size()));
+}
+
+/**
+ * Truncated data must be rejected.
+ */
+TEST_F(FieldCacheTest, fieldsTruncated)
+{
+	RomFields fields;
+	initFields(&fields);
+
+	ao::uvector<uint8_t> buf;
+	ASSERT_EQ(0, FieldCache::serializeFields(&fields, buf));
+
+	for (size_t size = 0; size < buf.size(); size++) {
+		RomFields fields2;
+		EXPECT_NE(0, FieldCache::deserializeFields(&fields2, buf.data(), size)) <<
+			"size == " << size;
+	}
+}
+
+/**
+ * Serialize and deserialize a RomMetaData object.
+ */
+TEST_F(FieldCacheTest, metaDataRoundTrip)
+{
+	RomMetaData metaData;
+	metaData.addMetaData_string(Property::Title, "Test Title");
+	metaData.addMetaData_integer(Property::Width, -1);
+	metaData.addMetaData_uint(Property::ReleaseYear, 2020);
+	metaData.addMetaData_timestamp(Property::CreationDate, 1234567890);
+
+	ao::uvector<uint8_t> buf;
+	ASSERT_EQ(0, FieldCache::serializeMetaData(&metaData, buf));
+
+	RomMetaData metaData2;
+	ASSERT_EQ(0, FieldCache::deserializeMetaData(&metaData2, buf.data(), buf.size()));
+	ASSERT_EQ(metaData.count(), metaData2.count());
+	for (int i = 0; i < metaData.count(); i++) {
+		const RomMetaData::MetaData *const exp = metaData.prop(i);
+		const RomMetaData::MetaData *const act = metaData2.prop(i);
+		ASSERT_TRUE(exp != nullptr);
+		ASSERT_TRUE(act != nullptr);
+		EXPECT_EQ(exp->name, act->name);
+		ASSERT_EQ(exp->type, act->type);
+		switch (exp->type) {
+			case PropertyType::Integer:
+				EXPECT_EQ(exp->data.ivalue, act->data.ivalue);
+				break;
+			case PropertyType::UnsignedInteger:
+				EXPECT_EQ(exp->data.uvalue, act->data.uvalue);
+				break;
+			case PropertyType::String:
+				EXPECT_EQ(*exp->data.str, *act->data.str);
+				break;
+			case PropertyType::Timestamp:
+				EXPECT_EQ(exp->data.timestamp, act->data.timestamp);
+				break;
+			default:
+				FAIL() << "Unexpected property type: " << static_cast<int>(exp->type);
+				break;
+		}
+	}
+
+	// Truncated data must be rejected.
+	RomMetaData metaData3;
+	EXPECT_NE(0, FieldCache::deserializeMetaData(&metaData3, buf.data(), buf.size() - 1));
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: FieldCache tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,432 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * HashTest.cpp: Hash and StreamHasher class tests.                        *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// Hash, StreamHasher
+#include "../crypto/Hash.hpp"
+#include "../crypto/StreamHasher.hpp"
+#include "../disc/DiscReader.hpp"
+
+// librpfile
+#include "librpfile/RpMemFile.hpp"
+using LibRpFile::RpMemFile;
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRpBase { namespace Tests {
+
+struct HashTest_mode
+{
+	// String to hash.
+	const char *str;
+
+	// Expected hashes, as lowercase hex strings.
+	const char *hashes[static_cast<int>(Hash::Algorithm::Max)];
+};
+
+class HashTest : public ::testing::TestWithParam<HashTest_mode>
+{
+	public:
+		/**
+		 * Convert a hash to a lowercase hex string.
+		 * @param pHash Hash.
+		 * @param len Hash length.
+		 * @return Hex string.
+		 */
+		static string toHex(const uint8_t *pHash, size_t len);
+
+		/**
+		 * Calculate a hash using a single Hash object.
+		 * @param algorithm Hash algorithm.
+		 * @param pData Data.
+		 * @param len Data length.
+		 * @param chunk_len Chunk length for process(). (0 for all at once)
+		 * @return Hex string, or empty string on error.
+		 */
+		static string calcHash(Hash::Algorithm algorithm,
+			const uint8_t *pData, size_t len, size_t chunk_len = 0);
+
+		/**
+		 * Calculate a CRC32 using the bitwise algorithm.
+		 * @param pData Data.
+		 * @param len Data length.
+		 * @return CRC32.
+		 */
+		static uint32_t refCRC32(const uint8_t *pData, size_t len);
+
+		/**
+		 * Generate test data.
+		 * @param data	[out] Data buffer.
+		 * @param size	[in] Data size.
+		 */
+		static void genData(vector<uint8_t> &data, size_t size);
+};
+
+/**
+ * Convert a hash to a lowercase hex string.
+ * @param pHash Hash.
+ * @param len Hash length.
+ * @return Hex string.
+ */
+string HashTest::toHex(const uint8_t *pHash, size_t len)
+{
+	string s;
+	s.reserve(len * 2);
+	for (size_t i = 0; i < len; i++) {
+		char buf[4];
+		snprintf(buf, sizeof(buf), "%02x", pHash[i]);
+		s += buf;
+	}
+	return s;
+}
+
+/**
+ * Calculate a hash using a single Hash object.
+ * @param algorithm Hash algorithm.
+ * @param pData Data.
+ * @param len Data length.
+ * @param chunk_len Chunk length for process(). (0 for all at once)
+ * @return Hex string, or empty string on error.
+ */
+string HashTest::calcHash(Hash::Algorithm algorithm,
+	const uint8_t *pData, size_t len, size_t chunk_len)
+{
+	Hash hash(algorithm);
+	if (!hash.isUsable()) {
+		return string();
+	}
+	if (chunk_len == 0) {
+		chunk_len = (len > 0 ? len : 1);
+	}
+
+	for (size_t pos = 0; pos < len; pos += chunk_len) {
+		const size_t size = (len - pos > chunk_len ? chunk_len : len - pos);
+		EXPECT_EQ(0, hash.process(&pData[pos], size));
+	}
+
+	uint8_t buf[32];
+	const size_t hash_len = Hash::hashLength(algorithm);
+	EXPECT_EQ(0, hash.getHash(buf, hash_len));
+	return toHex(buf, hash_len);
+}
+
+/**
+ * Calculate a CRC32 using the bitwise algorithm.
+ * @param pData Data.
+ * @param len Data length.
+ * @return CRC32.
+ */
+uint32_t HashTest::refCRC32(const uint8_t *pData, size_t len)
+{
+	uint32_t crc = ~0U;
+	for (size_t i = 0; i < len; i++) {
+		crc ^= pData[i];
+		for (int bit = 0; bit < 8; bit++) {
+			crc = (crc >> 1) ^ (0xEDB88320U & (0U - (crc & 1)));
+		}
+	}
+	return ~crc;
+}
+
+/**
+ * Generate test data.
+ * @param data	[out] Data buffer.
+ * @param size	[in] Data size.
+ */
+void HashTest::genData(vector<uint8_t> &data, size_t size)
+{
+	data.resize(size);
+	uint32_t seed = 0x12345678;
+	for (auto iter = data.begin(); iter != data.end(); ++iter) {
+		seed = seed * 1103515245 + 12345;
+		*iter = static_cast<uint8_t>(seed >> 16);
+	}
+}
+
+/**
+ * Hash a string with all algorithms.
+ */
+TEST_P(HashTest, stringHashTest)
+{
+	const HashTest_mode &mode = GetParam();
+	const uint8_t *const pData = reinterpret_cast<const uint8_t*>(mode.str);
+	const size_t len = strlen(mode.str);
+
+	for (int i = 0; i < static_cast<int>(Hash::Algorithm::Max); i++) {
+		const Hash::Algorithm algorithm = static_cast<Hash::Algorithm>(i);
+		Hash hash(algorithm);
+		if (!hash.isUsable()) {
+			// Not available in this build.
+			EXPECT_NE(Hash::Algorithm::CRC32, algorithm);
+			continue;
+		}
+
+		EXPECT_EQ(mode.hashes[i], calcHash(algorithm, pData, len)) << Hash::algorithmName(algorithm);
+		EXPECT_EQ(mode.hashes[i], calcHash(algorithm, pData, len, 3)) << Hash::algorithmName(algorithm);
+	}
+}
+
+INSTANTIATE_TEST_SUITE_P(HashStringTest, HashTest,
+	::testing::Values(
+		HashTest_mode{"", {
+			"00000000",
+			"d41d8cd98f00b204e9800998ecf8427e",
+			"da39a3ee5e6b4b0d3255bfef95601890afd80709",
+			"e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"}},
+		HashTest_mode{"abc", {
+			"352441c2",
+			"900150983cd24fb0d6963f7d28e17f72",
+			"a9993e364706816aba3e25717850c26c9cd0d89d",
+			"ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"}},
+		HashTest_mode{"The quick brown fox jumps over the lazy dog.", {
+			"519025e9",
+			"e4d909c290d0fb1ca068ffaddf22cbd0",
+			"408d94384216f890ff7a0c3528e8bed1e0b01621",
+			"ef537f25c895bfa782526529a9b63d97aa631564d5d789c2b765448c8635fb6c"}}
+		)
+	);
+
+/**
+ * CRC32 with various lengths and alignments.
+ * This covers both the PCLMULQDQ and table-based code paths.
+ */
+TEST_F(HashTest, crc32LengthTest)
+{
+	vector<uint8_t> data;
+	genData(data, 4096 + 16);
+
+	for (size_t offset = 0; offset < 16; offset += 5) {
+		for (size_t len = 0; len <= 300; len++) {
+			const uint32_t crc = refCRC32(&data[offset], len);
+			char exp[16];
+			snprintf(exp, sizeof(exp), "%08x", crc);
+			EXPECT_EQ(exp, calcHash(Hash::Algorithm::CRC32, &data[offset], len))
+				<< "offset == " << offset << ", len == " << len;
+		}
+
+		// Large block with an odd chunk size.
+		const uint32_t crc = refCRC32(&data[offset], 4096);
+		char exp[16];
+		snprintf(exp, sizeof(exp), "%08x", crc);
+		EXPECT_EQ(exp, calcHash(Hash::Algorithm::CRC32, &data[offset], 4096, 1000));
+	}
+}
+
+/**
+ * SHA-256 with various lengths and chunk sizes.
+ * This covers the partial block and padding handling
+ * in the SHA extensions code path.
+ */
+TEST_F(HashTest, sha256LengthTest)
+{
+	if (!Hash(Hash::Algorithm::SHA256).isUsable()) {
+		// SHA-256 is not available in this build.
+		return;
+	}
+
+	// NIST test vector: 448 bits. (Padding requires a second block.)
+	static const char str448[] = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+	EXPECT_EQ("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+		calcHash(Hash::Algorithm::SHA256, reinterpret_cast<const uint8_t*>(str448), sizeof(str448)-1));
+
+	// NIST test vector: One million 'a's.
+	const vector<uint8_t> a_million(1000000, 'a');
+	static const char sha256_a_million[] = "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0";
+	EXPECT_EQ(sha256_a_million, calcHash(Hash::Algorithm::SHA256, a_million.data(), a_million.size()));
+	EXPECT_EQ(sha256_a_million, calcHash(Hash::Algorithm::SHA256, a_million.data(), a_million.size(), 1000));
+	EXPECT_EQ(sha256_a_million, calcHash(Hash::Algorithm::SHA256, a_million.data(), a_million.size(), 63));
+
+	// Chunked hashing must match one-shot hashing.
+	vector<uint8_t> data;
+	genData(data, 300);
+	for (size_t len = 0; len <= data.size(); len++) {
+		EXPECT_EQ(calcHash(Hash::Algorithm::SHA256, data.data(), len),
+			  calcHash(Hash::Algorithm::SHA256, data.data(), len, 7))
+			<< "len == " << len;
+	}
+}
+
+/**
+ * Invalid parameters.
+ */
+TEST_F(HashTest, invalidParamsTest)
+{
+	uint8_t buf[32];
+	Hash badHash(Hash::Algorithm::Max);
+	EXPECT_FALSE(badHash.isUsable());
+	EXPECT_EQ(-ENOTSUP, badHash.process(buf, sizeof(buf)));
+	EXPECT_EQ(0U, Hash::hashLength(Hash::Algorithm::Max));
+	EXPECT_EQ(nullptr, Hash::algorithmName(Hash::Algorithm::Max));
+}
+
+/**
+ * StreamHasher: Hash a file with all algorithms.
+ * Small buffers are used to test buffer reuse.
+ */
+TEST_F(HashTest, streamHasherFileTest)
+{
+	vector<uint8_t> data;
+	genData(data, 3*1024*1024 + 123);
+
+	RpMemFile *const memFile = new RpMemFile(data.data(), data.size());
+	StreamHasher hasher;
+	hasher.setBufferSize(64*1024 + 7);
+	hasher.setBufferCount(3);
+	ASSERT_EQ(0, hasher.process(memFile));
+	EXPECT_EQ(static_cast<off64_t>(data.size()), hasher.bytesHashed());
+
+	for (int i = 0; i < static_cast<int>(Hash::Algorithm::Max); i++) {
+		const Hash::Algorithm algorithm = static_cast<Hash::Algorithm>(i);
+		const string exp = calcHash(algorithm, data.data(), data.size());
+		if (exp.empty()) {
+			// Not available in this build.
+			EXPECT_FALSE(hasher.hasHash(algorithm));
+			continue;
+		}
+		ASSERT_TRUE(hasher.hasHash(algorithm)) << Hash::algorithmName(algorithm);
+		EXPECT_EQ(exp, hasher.getHashString(algorithm)) << Hash::algorithmName(algorithm);
+	}
+
+	// Hash the file again with the same buffers.
+	const string crc32 = hasher.getHashString(Hash::Algorithm::CRC32);
+	ASSERT_EQ(0, hasher.process(memFile));
+	EXPECT_EQ(crc32, hasher.getHashString(Hash::Algorithm::CRC32));
+	memFile->unref();
+}
+
+/**
+ * StreamHasher: Hash a disc image using a subset of algorithms.
+ */
+TEST_F(HashTest, streamHasherDiscReaderTest)
+{
+	vector<uint8_t> data;
+	genData(data, 100000);
+
+	RpMemFile *const memFile = new RpMemFile(data.data(), data.size());
+	DiscReader *const discReader = new DiscReader(memFile);
+	memFile->unref();
+
+	StreamHasher hasher(1U << static_cast<int>(Hash::Algorithm::CRC32));
+	hasher.setBufferSize(4096);
+	ASSERT_EQ(0, hasher.process(discReader));
+	discReader->unref();
+
+	EXPECT_EQ(static_cast<off64_t>(data.size()), hasher.bytesHashed());
+	char exp[16];
+	snprintf(exp, sizeof(exp), "%08x", refCRC32(data.data(), data.size()));
+	EXPECT_EQ(exp, hasher.getHashString(Hash::Algorithm::CRC32));
+	EXPECT_FALSE(hasher.hasHash(Hash::Algorithm::MD5));
+	EXPECT_TRUE(hasher.getHashString(Hash::Algorithm::MD5).empty());
+
+	uint8_t buf[4];
+	EXPECT_EQ(0, hasher.getHash(Hash::Algorithm::CRC32, buf, sizeof(buf)));
+	EXPECT_EQ(exp, toHex(buf, sizeof(buf)));
+	uint8_t sha1[20];
+	EXPECT_EQ(-ENOENT, hasher.getHash(Hash::Algorithm::SHA1, sha1, sizeof(sha1)));
+}
+
+/**
+ * StreamHasher: Hash part of a disc image.
+ */
+TEST_F(HashTest, streamHasherRangeTest)
+{
+	vector<uint8_t> data;
+	genData(data, 100000);
+
+	RpMemFile *const memFile = new RpMemFile(data.data(), data.size());
+	DiscReader *const discReader = new DiscReader(memFile);
+
+	StreamHasher hasher(1U << static_cast<int>(Hash::Algorithm::CRC32));
+	hasher.setBufferSize(4096 + 3);
+	ASSERT_EQ(0, hasher.process(discReader, 1000, 50000));
+	EXPECT_EQ(50000, hasher.bytesHashed());
+	char exp[16];
+	snprintf(exp, sizeof(exp), "%08x", refCRC32(&data[1000], 50000));
+	EXPECT_EQ(exp, hasher.getHashString(Hash::Algorithm::CRC32));
+
+	// Same range, using the IRpFile overload.
+	ASSERT_EQ(0, hasher.process(memFile, 1000, 50000));
+	EXPECT_EQ(exp, hasher.getHashString(Hash::Algorithm::CRC32));
+
+	// Range extends past EOF.
+	EXPECT_EQ(-EIO, hasher.process(discReader, 90000, 20000));
+	EXPECT_FALSE(hasher.hasHash(Hash::Algorithm::CRC32));
+
+	discReader->unref();
+	memFile->unref();
+}
+
+/**
+ * StreamHasher: Empty file.
+ */
+TEST_F(HashTest, streamHasherEmptyTest)
+{
+	uint8_t dummy = 0;
+	RpMemFile *const memFile = new RpMemFile(&dummy, 0);
+	StreamHasher hasher;
+	ASSERT_EQ(0, hasher.process(memFile));
+	memFile->unref();
+
+	EXPECT_EQ(0, hasher.bytesHashed());
+	EXPECT_EQ("00000000", hasher.getHashString(Hash::Algorithm::CRC32));
+}
+
+/**
+ * Benchmark CRC32 calculation.
+ */
+TEST_F(HashTest, crc32Benchmark)
+{
+	vector<uint8_t> data;
+	genData(data, 64*1024*1024);
+
+	Hash hash(Hash::Algorithm::CRC32);
+	for (int i = 0; i < 16; i++) {
+		hash.reset();
+		EXPECT_EQ(0, hash.process(data.data(), data.size()));
+	}
+}
+
+/**
+ * Benchmark StreamHasher with all algorithms.
+ */
+TEST_F(HashTest, streamHasherBenchmark)
+{
+	vector<uint8_t> data;
+	genData(data, 256*1024*1024);
+
+	RpMemFile *const memFile = new RpMemFile(data.data(), data.size());
+	StreamHasher hasher;
+	EXPECT_EQ(0, hasher.process(memFile));
+	memFile->unref();
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: Hash tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
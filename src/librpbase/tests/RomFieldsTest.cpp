@@ -0,0 +1,138 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * RomFieldsTest.cpp: RomFields tests.                                     *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+#include "../RomFields.hpp"
+#include "../TextFuncs.hpp"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+
+// C++ includes.
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRpBase { namespace Tests {
+
+class RomFieldsTest : public ::testing::Test
+{
+	public:
+		// Number of rows for the benchmark.
+		static const unsigned int BENCHMARK_LIST_ROWS = 100000;
+
+		/**
+		 * Add a large RFT_LISTDATA field, e.g. a file system listing.
+		 * @param fields RomFields.
+		 * @param rows Number of rows.
+		 */
+		static void addLargeListData(RomFields *fields, unsigned int rows);
+};
+
+/**
+ * Add a large RFT_LISTDATA field, e.g. a file system listing.
+ * @param fields RomFields.
+ * @param rows Number of rows.
+ */
+void RomFieldsTest::addLargeListData(RomFields *fields, unsigned int rows)
+{
+	static const char *const headers[] = {"Name", "Offset", "Size"};
+	auto *const list_data = new RomFields::ListData_t(rows);
+	unsigned int i = 0;
+	for (auto iter = list_data->begin(); iter != list_data->end(); ++iter, i++) {
+		auto &data_row = *iter;
+		data_row.reserve(3);
+		data_row.push_back(rp_sprintf("directory/subdirectory/file_%08u.bin", i));
+		data_row.push_back(rp_sprintf("0x%08X", i * 0x800));
+		data_row.push_back(rp_sprintf("%u", i * 3));
+	}
+
+	RomFields::AFLD_PARAMS params(RomFields::RFT_LISTDATA_SEPARATE_ROW, 0);
+	params.headers = RomFields::strArrayToVector(headers, ARRAY_SIZE(headers));
+	params.data.single = list_data;
+	fields->addField_listData("Files", &params);
+}
+
+/** RomFields **/
+
+/**
+ * Field data must survive copying to another RomFields object
+ * after the original object is deleted.
+ */
+TEST_F(RomFieldsTest, addFieldsRomFieldsTest)
+{
+	RomFields *const fields = new RomFields();
+	fields->addField_string("String", "Test string");
+	RomFields::age_ratings_t age_ratings;
+	age_ratings.fill(0);
+	age_ratings[RomFields::AGE_USA] = RomFields::AGEBF_ACTIVE | 13;
+	fields->addField_ageRatings("Age Ratings", age_ratings);
+	addLargeListData(fields, 16);
+
+	RomFields fields2;
+	fields2.addFields_romFields(fields, 0);
+	delete fields;
+
+	ASSERT_EQ(3, fields2.count());
+	const RomFields::Field *field = fields2.at(0);
+	ASSERT_TRUE(field->data.str != nullptr);
+	EXPECT_EQ("Test string", *field->data.str);
+
+	field = fields2.at(1);
+	ASSERT_TRUE(field->data.age_ratings != nullptr);
+	EXPECT_EQ(age_ratings, *field->data.age_ratings);
+
+	field = fields2.at(2);
+	ASSERT_TRUE(field->data.list_data.data.single != nullptr);
+	ASSERT_EQ(16U, field->data.list_data.data.single->size());
+	EXPECT_EQ("directory/subdirectory/file_00000015.bin",
+		field->data.list_data.data.single->at(15).at(0));
+
+	// Clearing the fields allows them to be reloaded.
+	fields2.clear();
+	EXPECT_TRUE(fields2.empty());
+	fields2.addField_string("String", "Another string");
+	ASSERT_EQ(1, fields2.count());
+	EXPECT_EQ("Another string", *fields2.at(0)->data.str);
+}
+
+/**
+ * Benchmark construction and destruction of a RomFields object
+ * with a large RFT_LISTDATA field.
+ */
+TEST_F(RomFieldsTest, largeListDataBenchmark)
+{
+	for (unsigned int i = 10; i > 0; i--) {
+		RomFields *const fields = new RomFields();
+		for (unsigned int j = 0; j < 32; j++) {
+			fields->addField_string("String", "Test string with a longer value");
+		}
+		addLargeListData(fields, BENCHMARK_LIST_ROWS);
+		EXPECT_EQ(33, fields->count());
+		delete fields;
+	}
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: RomFields tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
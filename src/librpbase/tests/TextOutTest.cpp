@@ -0,0 +1,724 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * TextOutTest.cpp: TextOut test.                                          *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+#include "../RomData.hpp"
+#include "../RomData_p.hpp"
+#include "../RomMetaData.hpp"
+#include "../TextOut.hpp"
+#include "../TextFuncs.hpp"
+#include "librptexture/img/rp_image.hpp"
+using LibRpTexture::rp_image;
+
+// C includes. (C++ namespace)
+#include <cstdio>
+
+// C++ includes.
+#include <sstream>
+#include <string>
+#include <vector>
+using std::ostringstream;
+using std::string;
+using std::vector;
+
+namespace LibRpBase { namespace Tests {
+
+/**
+ * RomData subclass with fixed test fields.
+ */
+class TextOutTestRomData : public RomData
+{
+	public:
+		/**
+		 * Create a test RomData object.
+		 * @param listRows Number of rows for the large RFT_LISTDATA field. (0 for none)
+		 * @param hasImages If true, add an internal image and external image URLs.
+		 */
+		TextOutTestRomData(unsigned int listRows, bool hasImages);
+
+	protected:
+		~TextOutTestRomData() override
+		{
+			UNREF(img);
+		}
+
+	private:
+		typedef RomData super;
+		RP_DISABLE_COPY(TextOutTestRomData)
+
+	private:
+		unsigned int listRows;
+		bool hasImages;
+		rp_image *img;
+
+	public:
+		int isRomSupported(const DetectInfo *info) const final
+		{
+			RP_UNUSED(info);
+			return -1;
+		}
+
+		const char *systemName(unsigned int type) const final
+		{
+			RP_UNUSED(type);
+			return "Test \"System\"";
+		}
+
+		const char *const *supportedFileExtensions(void) const final
+		{
+			static const char *const exts[] = {".test", nullptr};
+			return exts;
+		}
+
+		const char *const *supportedMimeTypes(void) const final
+		{
+			static const char *const mimeTypes[] = {nullptr};
+			return mimeTypes;
+		}
+
+		uint32_t supportedImageTypes(void) const final
+		{
+			return (hasImages ? (IMGBF_INT_ICON | IMGBF_EXT_MEDIA | IMGBF_EXT_COVER) : 0);
+		}
+
+		int extURLs(ImageType imageType, vector<ExtURL> *pExtURLs, int size) const final;
+
+	protected:
+		int loadFieldData(void) final;
+		int loadMetaData(void) final;
+		int loadInternalImage(ImageType imageType, const rp_image **pImage) final;
+};
+
+TextOutTestRomData::TextOutTestRomData(unsigned int listRows, bool hasImages)
+	: super(new RomDataPrivate(this, nullptr))
+	, listRows(listRows)
+	, hasImages(hasImages)
+	, img(nullptr)
+{
+	RP_D(RomData);
+	d->isValid = true;
+	d->className = "TextOutTest";
+}
+
+int TextOutTestRomData::loadFieldData(void)
+{
+	RP_D(RomData);
+	RomFields *const fields = d->fields;
+	if (!fields->empty()) {
+		// Field data *has* been loaded...
+		return 0;
+	}
+
+	fields->addField_string("String", "Test \"string\"\twith\nescapes \xE2\x80\x94 \x01",
+		RomFields::STRF_MONOSPACE);
+	fields->addField_string("Empty string", "");
+
+	static const char *const bitfield_names[] = {
+		"Bit 0", nullptr, "Bit 2", "Bit 3",
+	};
+	fields->addField_bitfield("Bitfield",
+		RomFields::strArrayToVector(bitfield_names, ARRAY_SIZE(bitfield_names)), 3, 0x0D);
+	fields->addField_bitfield("Bitfield (no names)",
+		RomFields::strArrayToVector(bitfield_names + 1, 1), 3, 0);
+
+	fields->addField_dateTime("Date/Time", 1234567890,
+		RomFields::RFT_DATETIME_HAS_DATE | RomFields::RFT_DATETIME_HAS_TIME);
+	fields->addField_dateTime("Invalid Date/Time", -1);
+
+	RomFields::age_ratings_t age_ratings;
+	age_ratings.fill(0);
+	age_ratings[RomFields::AGE_JAPAN] = RomFields::AGEBF_ACTIVE | RomFields::AGEBF_PENDING;
+	age_ratings[RomFields::AGE_USA] = RomFields::AGEBF_ACTIVE | 13;
+	age_ratings[RomFields::AGE_EUROPE] = RomFields::AGEBF_ACTIVE | RomFields::AGEBF_ONLINE_PLAY | 12;
+	fields->addField_ageRatings("Age Ratings", age_ratings);
+
+	fields->addField_dimensions("Dimensions (1D)", 256);
+	fields->addField_dimensions("Dimensions (2D)", 640, 480);
+	fields->addField_dimensions("Dimensions (3D)", 64, 64, 16);
+
+	// ListData with checkboxes.
+	static const char *const headers[] = {"Name", "Value"};
+	auto *list_data = new RomFields::ListData_t(3);
+	(*list_data)[0].push_back("a");
+	(*list_data)[0].push_back("1");
+	(*list_data)[1].push_back("b");
+	(*list_data)[1].push_back("");
+	(*list_data)[2].push_back("c");
+	(*list_data)[2].push_back("3");
+	RomFields::AFLD_PARAMS params(RomFields::RFT_LISTDATA_CHECKBOXES, 0);
+	params.headers = RomFields::strArrayToVector(headers, ARRAY_SIZE(headers));
+	params.data.single = list_data;
+	params.mxd.checkboxes = 0x5;
+	fields->addField_listData("ListData", &params);
+
+	// ListData without headers or data.
+	RomFields::AFLD_PARAMS params_empty;
+	params_empty.data.single = new RomFields::ListData_t();
+	fields->addField_listData("ListData (empty)", &params_empty);
+
+	// Multi-language ListData.
+	auto *const list_data_multi = new RomFields::ListDataMultiMap_t();
+	(*list_data_multi)['en'].resize(1);
+	(*list_data_multi)['en'][0].push_back("Hello");
+	(*list_data_multi)['es'].resize(1);
+	(*list_data_multi)['es'][0].push_back("Hola");
+	(*list_data_multi)['fr'];	// empty
+	RomFields::AFLD_PARAMS params_multi(RomFields::RFT_LISTDATA_MULTI, 0);
+	params_multi.headers = RomFields::strArrayToVector(headers, 1);
+	params_multi.def_lc = 'en';
+	params_multi.data.multi = list_data_multi;
+	fields->addField_listData("ListData (multi)", &params_multi);
+
+	// Multi-language string.
+	auto *const str_multi = new RomFields::StringMultiMap_t();
+	(*str_multi)['en'] = "Title";
+	(*str_multi)['fr'] = "Titre";
+	fields->addField_string_multi("String (multi)", str_multi, 'en');
+
+	if (listRows > 0) {
+		// Large ListData, e.g. a file system listing.
+		static const char *const big_headers[] = {"Name", "Offset", "Size", "Type"};
+		list_data = new RomFields::ListData_t(listRows);
+		unsigned int i = 0;
+		for (auto iter = list_data->begin(); iter != list_data->end(); ++iter, i++) {
+			auto &data_row = *iter;
+			data_row.reserve(4);
+			data_row.push_back(rp_sprintf("directory/subdirectory/file_%08u.bin", i));
+			data_row.push_back(rp_sprintf("0x%08X", i * 0x800));
+			data_row.push_back(rp_sprintf("%u", i * 3));
+			data_row.push_back((i & 1) ? "File" : "Dir \"quoted\"");
+		}
+		RomFields::AFLD_PARAMS params_big(RomFields::RFT_LISTDATA_SEPARATE_ROW, 0);
+		params_big.headers = RomFields::strArrayToVector(big_headers, ARRAY_SIZE(big_headers));
+		params_big.data.single = list_data;
+		fields->addField_listData("Large ListData", &params_big);
+	}
+
+	return fields->count();
+}
+
+int TextOutTestRomData::loadMetaData(void)
+{
+	RP_D(RomData);
+	if (d->metaData != nullptr) {
+		// Metadata *has* been loaded...
+		return 0;
+	}
+
+	d->metaData = new RomMetaData();
+	d->metaData->addMetaData_string(Property::Title, "Test Title");
+	d->metaData->addMetaData_integer(Property::Width, -2);
+	d->metaData->addMetaData_uint(Property::ReleaseYear, 2020);
+	d->metaData->addMetaData_timestamp(Property::CreationDate, 1234567890);
+	return static_cast<int>(d->metaData->count());
+}
+
+int TextOutTestRomData::loadInternalImage(ImageType imageType, const rp_image **pImage)
+{
+	if (!hasImages || imageType != IMG_INT_ICON) {
+		*pImage = nullptr;
+		return -ENOENT;
+	}
+	if (!img) {
+		img = new rp_image(32, 16, rp_image::Format::ARGB32);
+	}
+	*pImage = img;
+	return 0;
+}
+
+int TextOutTestRomData::extURLs(ImageType imageType, vector<ExtURL> *pExtURLs, int size) const
+{
+	RP_UNUSED(size);
+	if (!hasImages || imageType != IMG_EXT_MEDIA) {
+		// IMG_EXT_COVER is "supported", but has no URLs.
+		return -ENOENT;
+	}
+
+	pExtURLs->resize(2);
+	ExtURL &extURL0 = pExtURLs->at(0);
+	extURL0.url = "https://example.com/media/US/TEST01%20%28Test%29.png";
+	extURL0.cache_key = "test/media/US/TEST01.png";
+	ExtURL &extURL1 = pExtURLs->at(1);
+	extURL1.url = "https://example.com/media/EN/TEST01.png";
+	extURL1.cache_key = "test/media/EN/TEST01.png";
+	return 0;
+}
+
+class TextOutTest : public ::testing::Test
+{
+	public:
+		// Number of rows for the benchmark.
+		static const unsigned int BENCHMARK_LIST_ROWS = 200000;
+
+		/**
+		 * Get JSON output for a RomData object.
+		 * @param romData RomData object.
+		 * @param crlf Use CRLF newlines.
+		 * @return JSON output.
+		 */
+		static string jsonOutput(const RomData *romData, bool crlf = false)
+		{
+			ostringstream oss;
+			JSONROMOutput jsonOut(romData);
+			jsonOut.setCrlf(crlf);
+			oss << jsonOut;
+			return oss.str();
+		}
+
+		/**
+		 * Get CBOR output for a RomData object.
+		 * @param romData RomData object.
+		 * @return CBOR output.
+		 */
+		static string cborOutput(const RomData *romData)
+		{
+			ostringstream oss;
+			oss << CBORROMOutput(romData);
+			return oss.str();
+		}
+
+		/**
+		 * Convert a CBOR data item to diagnostic notation. (RFC 7049 section 6)
+		 * Only the data item types written by CBORROMOutput are supported.
+		 * @param p	[in/out] Data pointer.
+		 * @param end	[in] End of data.
+		 * @param diag	[out] Diagnostic notation.
+		 * @return True on success; false on error.
+		 */
+		static bool cborToDiag(const uint8_t *&p, const uint8_t *end, string &diag);
+};
+
+bool TextOutTest::cborToDiag(const uint8_t *&p, const uint8_t *end, string &diag)
+{
+	if (p >= end)
+		return false;
+
+	const uint8_t mt = *p >> 5;
+	const uint8_t ai = *p & 0x1F;
+	p++;
+
+	// Argument.
+	uint64_t val;
+	if (ai < 24) {
+		val = ai;
+	} else if (ai <= 27) {
+		const unsigned int len = 1U << (ai - 24);
+		if (end - p < static_cast<ptrdiff_t>(len))
+			return false;
+		val = 0;
+		for (unsigned int i = 0; i < len; i++, p++) {
+			val = (val << 8) | *p;
+		}
+	} else {
+		// Indefinite-length items and reserved values aren't supported.
+		return false;
+	}
+
+	switch (mt) {
+		case 0:	// unsigned integer
+			diag += rp_sprintf("%llu", static_cast<unsigned long long>(val));
+			break;
+		case 1:	// negative integer
+			diag += rp_sprintf("-%llu", static_cast<unsigned long long>(val) + 1);
+			break;
+		case 3:	// text string
+			if (static_cast<uint64_t>(end - p) < val)
+				return false;
+			diag += '"';
+			for (; val > 0; val--, p++) {
+				if (*p == '"' || *p == '\\') {
+					diag += '\\';
+					diag += static_cast<char>(*p);
+				} else if (*p < 0x20) {
+					diag += rp_sprintf("\\u%04X", *p);
+				} else {
+					diag += static_cast<char>(*p);
+				}
+			}
+			diag += '"';
+			break;
+		case 4:	// array
+			diag += '[';
+			for (uint64_t i = 0; i < val; i++) {
+				if (i > 0)
+					diag += ", ";
+				if (!cborToDiag(p, end, diag))
+					return false;
+			}
+			diag += ']';
+			break;
+		case 5:	// map
+			diag += '{';
+			for (uint64_t i = 0; i < val; i++) {
+				if (i > 0)
+					diag += ", ";
+				if (!cborToDiag(p, end, diag))
+					return false;
+				diag += ": ";
+				if (!cborToDiag(p, end, diag))
+					return false;
+			}
+			diag += '}';
+			break;
+		case 6:	// tag
+			diag += rp_sprintf("%llu(", static_cast<unsigned long long>(val));
+			if (!cborToDiag(p, end, diag))
+				return false;
+			diag += ')';
+			break;
+		case 7:	// simple values
+			switch (val) {
+				case 20:	diag += "false"; break;
+				case 21:	diag += "true"; break;
+				case 22:	diag += "null"; break;
+				default:	return false;
+			}
+			break;
+		default:
+			// Byte strings aren't used.
+			return false;
+	}
+
+	return true;
+}
+
+// Expected JSON output for the test fields.
+static const char json_expected[] =
+	"{\n"
+	"    \"system\": \"Test \\\"System\\\"\",\n"
+	"    \"filetype\": \"ROM Image\",\n"
+	"    \"fields\": [\n"
+	"        {\n"
+	"            \"type\": \"STRING\",\n"
+	"            \"desc\": {\n"
+	"                \"name\": \"String\",\n"
+	"                \"format\": 1\n"
+	"            },\n"
+	"            \"data\": \"Test \\\"string\\\"\\twith\\nescapes \xE2\x80\x94 \\u0001\"\n"
+	"        },\n"
+	"        {\n"
+	"            \"type\": \"STRING\",\n"
+	"            \"desc\": {\n"
+	"                \"name\": \"Empty string\",\n"
+	"                \"format\": 0\n"
+	"            },\n"
+	"            \"data\": \"\"\n"
+	"        },\n"
+	"        {\n"
+	"            \"type\": \"BITFIELD\",\n"
+	"            \"desc\": {\n"
+	"                \"name\": \"Bitfield\",\n"
+	"                \"elementsPerRow\": 3,\n"
+	"                \"names\": [\n"
+	"                    \"Bit 0\",\n"
+	"                    \"Bit 2\",\n"
+	"                    \"Bit 3\"\n"
+	"                ]\n"
+	"            },\n"
+	"            \"data\": 13\n"
+	"        },\n"
+	"        {\n"
+	"            \"type\": \"BITFIELD\",\n"
+	"            \"desc\": {\n"
+	"                \"name\": \"Bitfield (no names)\",\n"
+	"                \"elementsPerRow\": 3,\n"
+	"                \"names\": \"ERROR\"\n"
+	"            },\n"
+	"            \"data\": 0\n"
+	"        },\n"
+	"        {\n"
+	"            \"type\": \"DATETIME\",\n"
+	"            \"desc\": {\n"
+	"                \"name\": \"Date/Time\",\n"
+	"                \"flags\": 3\n"
+	"            },\n"
+	"            \"data\": 1234567890\n"
+	"        },\n"
+	"        {\n"
+	"            \"type\": \"DATETIME\",\n"
+	"            \"desc\": {\n"
+	"                \"name\": \"Invalid Date/Time\",\n"
+	"                \"flags\": 0\n"
+	"            },\n"
+	"            \"data\": -1\n"
+	"        },\n"
+	"        {\n"
+	"            \"type\": \"AGE_RATINGS\",\n"
+	"            \"desc\": {\n"
+	"                \"name\": \"Age Ratings\"\n"
+	"            },\n"
+	"            \"data\": [\n"
+	"                {\n"
+	"                    \"name\": \"CERO\",\n"
+	"                    \"rating\": \"RP\"\n"
+	"                },\n"
+	"                {\n"
+	"                    \"name\": \"ESRB\",\n"
+	"                    \"rating\": \"T\"\n"
+	"                },\n"
+	"                {\n"
+	"                    \"name\": \"PEGI\",\n"
+	"                    \"rating\": \"12\xC2\xB0\"\n"
+	"                }\n"
+	"            ]\n"
+	"        },\n"
+	"        {\n"
+	"            \"type\": \"DIMENSIONS\",\n"
+	"            \"data\": {\n"
+	"                \"w\": 256\n"
+	"            }\n"
+	"        },\n"
+	"        {\n"
+	"            \"type\": \"DIMENSIONS\",\n"
+	"            \"data\": {\n"
+	"                \"w\": 640,\n"
+	"                \"h\": 480\n"
+	"            }\n"
+	"        },\n"
+	"        {\n"
+	"            \"type\": \"DIMENSIONS\",\n"
+	"            \"data\": {\n"
+	"                \"w\": 64,\n"
+	"                \"h\": 64,\n"
+	"                \"d\": 16\n"
+	"            }\n"
+	"        },\n"
+	"        {\n"
+	"            \"type\": \"LISTDATA\",\n"
+	"            \"desc\": {\n"
+	"                \"name\": \"ListData\",\n"
+	"                \"names\": [\n"
+	"                    \"checked\",\n"
+	"                    \"Name\",\n"
+	"                    \"Value\"\n"
+	"                ]\n"
+	"            },\n"
+	"            \"data\": [\n"
+	"                [\n"
+	"                    true,\n"
+	"                    \"a\",\n"
+	"                    \"1\"\n"
+	"                ],\n"
+	"                [\n"
+	"                    false,\n"
+	"                    \"b\",\n"
+	"                    \"\"\n"
+	"                ],\n"
+	"                [\n"
+	"                    true,\n"
+	"                    \"c\",\n"
+	"                    \"3\"\n"
+	"                ]\n"
+	"            ]\n"
+	"        },\n"
+	"        {\n"
+	"            \"type\": \"LISTDATA\",\n"
+	"            \"desc\": {\n"
+	"                \"name\": \"ListData (empty)\",\n"
+	"                \"names\": []\n"
+	"            },\n"
+	"            \"data\": \"ERROR\"\n"
+	"        },\n"
+	"        {\n"
+	"            \"type\": \"LISTDATA\",\n"
+	"            \"desc\": {\n"
+	"                \"name\": \"ListData (multi)\",\n"
+	"                \"names\": [\n"
+	"                    \"Name\"\n"
+	"                ]\n"
+	"            },\n"
+	"            \"data\": {\n"
+	"                \"en\": [\n"
+	"                    [\n"
+	"                        \"Hello\"\n"
+	"                    ]\n"
+	"                ],\n"
+	"                \"es\": [\n"
+	"                    [\n"
+	"                        \"Hola\"\n"
+	"                    ]\n"
+	"                ],\n"
+	"                \"fr\": \"ERROR\"\n"
+	"            }\n"
+	"        },\n"
+	"        {\n"
+	"            \"type\": \"STRING_MULTI\",\n"
+	"            \"desc\": {\n"
+	"                \"name\": \"String (multi)\",\n"
+	"                \"format\": 0\n"
+	"            },\n"
+	"            \"data\": {\n"
+	"                \"en\": \"Title\",\n"
+	"                \"fr\": \"Titre\"\n"
+	"            }\n"
+	"        }\n"
+	"    ],\n"
+	"    \"imgint\": [\n"
+	"        {\n"
+	"            \"type\": \"Internal icon\",\n"
+	"            \"format\": \"ARGB32\",\n"
+	"            \"size\": [\n"
+	"                32,\n"
+	"                16\n"
+	"            ]\n"
+	"        }\n"
+	"    ],\n"
+	"    \"imgext\": [\n"
+	"        {\n"
+	"            \"type\": \"External media scan\",\n"
+	"            \"exturls\": {\n"
+	"                \"url\": \"https://example.com/media/US/TEST01%20(Test).png\",\n"
+	"                \"cache_key\": \"test/media/US/TEST01.png\",\n"
+	"                \"url\": \"https://example.com/media/EN/TEST01.png\",\n"
+	"                \"cache_key\": \"test/media/EN/TEST01.png\"\n"
+	"            }\n"
+	"        }\n"
+	"    ]\n"
+	"}";
+
+// Expected CBOR output for the test fields, in diagnostic notation.
+static const char cbor_expected[] =
+	"{\"system\": \"Test \\\"System\\\"\", \"filetype\": \"ROM Image\", \"fields\": ["
+	"{\"type\": \"STRING\", \"name\": \"String\", \"tab\": 0, \"desc\": {\"format\": 1}, \"data\": \"Test \\\"string\\\"\\u0009with\\u000Aescapes \xE2\x80\x94 \\u0001\"}, "
+	"{\"type\": \"STRING\", \"name\": \"Empty string\", \"tab\": 0, \"desc\": {\"format\": 0}, \"data\": \"\"}, "
+	"{\"type\": \"BITFIELD\", \"name\": \"Bitfield\", \"tab\": 0, \"desc\": {\"elementsPerRow\": 3, \"names\": [\"Bit 0\", null, \"Bit 2\", \"Bit 3\"]}, \"data\": 13}, "
+	"{\"type\": \"BITFIELD\", \"name\": \"Bitfield (no names)\", \"tab\": 0, \"desc\": {\"elementsPerRow\": 3, \"names\": [null]}, \"data\": 0}, "
+	"{\"type\": \"DATETIME\", \"name\": \"Date/Time\", \"tab\": 0, \"desc\": {\"flags\": 3}, \"data\": 1(1234567890)}, "
+	"{\"type\": \"DATETIME\", \"name\": \"Invalid Date/Time\", \"tab\": 0, \"desc\": {\"flags\": 0}, \"data\": null}, "
+	"{\"type\": \"AGE_RATINGS\", \"name\": \"Age Ratings\", \"tab\": 0, \"desc\": {}, \"data\": [{\"name\": \"CERO\", \"rating\": \"RP\", \"raw\": 96}, {\"name\": \"ESRB\", \"rating\": \"T\", \"raw\": 45}, {\"name\": \"PEGI\", \"rating\": \"12\xC2\xB0\", \"raw\": 300}]}, "
+	"{\"type\": \"DIMENSIONS\", \"name\": \"Dimensions (1D)\", \"tab\": 0, \"desc\": {}, \"data\": [256]}, "
+	"{\"type\": \"DIMENSIONS\", \"name\": \"Dimensions (2D)\", \"tab\": 0, \"desc\": {}, \"data\": [640, 480]}, "
+	"{\"type\": \"DIMENSIONS\", \"name\": \"Dimensions (3D)\", \"tab\": 0, \"desc\": {}, \"data\": [64, 64, 16]}, "
+	"{\"type\": \"LISTDATA\", \"name\": \"ListData\", \"tab\": 0, \"desc\": {\"flags\": 2, \"names\": [\"checked\", \"Name\", \"Value\"]}, \"data\": [[true, \"a\", \"1\"], [false, \"b\", \"\"], [true, \"c\", \"3\"]]}, "
+	"{\"type\": \"LISTDATA\", \"name\": \"ListData (empty)\", \"tab\": 0, \"desc\": {\"flags\": 0, \"names\": null}, \"data\": []}, "
+	"{\"type\": \"LISTDATA\", \"name\": \"ListData (multi)\", \"tab\": 0, \"desc\": {\"flags\": 8, \"names\": [\"Name\"]}, \"data\": {\"en\": [[\"Hello\"]], \"es\": [[\"Hola\"]], \"fr\": []}}, "
+	"{\"type\": \"STRING_MULTI\", \"name\": \"String (multi)\", \"tab\": 0, \"desc\": {\"format\": 0}, \"data\": {\"en\": \"Title\", \"fr\": \"Titre\"}}], "
+	"\"metadata\": {15: \"Test Title\", 26: -2, 7: 2020, 24: 1(1234567890)}, "
+	"\"imgint\": [{\"type\": \"Internal icon\", \"format\": \"ARGB32\", \"size\": [32, 16], \"postprocessing\": 0}], "
+	"\"imgext\": [{\"type\": \"External media scan\", \"exturls\": [{\"url\": \"https://example.com/media/US/TEST01%20(Test).png\", \"cache_key\": \"test/media/US/TEST01.png\"}, {\"url\": \"https://example.com/media/EN/TEST01.png\", \"cache_key\": \"test/media/EN/TEST01.png\"}]}]}";
+
+/**
+ * Verify the JSON output for all field types.
+ */
+TEST_F(TextOutTest, jsonOutputTest)
+{
+	TextOutTestRomData *const romData = new TextOutTestRomData(0, true);
+	const string json = jsonOutput(romData);
+	romData->unref();
+	EXPECT_EQ(string(json_expected), json);
+}
+
+/**
+ * Verify that CRLF mode only changes the newlines.
+ */
+TEST_F(TextOutTest, jsonOutputCrlfTest)
+{
+	TextOutTestRomData *const romData = new TextOutTestRomData(0, true);
+	const string json_lf = jsonOutput(romData, false);
+	const string json_crlf = jsonOutput(romData, true);
+	romData->unref();
+
+	string json_crlf_conv;
+	json_crlf_conv.reserve(json_crlf.size());
+	for (size_t i = 0; i < json_crlf.size(); i++) {
+		if (json_crlf[i] == '\r' && i+1 < json_crlf.size() && json_crlf[i+1] == '\n')
+			continue;
+		json_crlf_conv += json_crlf[i];
+	}
+	EXPECT_NE(json_lf, json_crlf);
+	EXPECT_EQ(json_lf, json_crlf_conv);
+}
+
+/**
+ * Verify the CBOR output for all field types.
+ */
+TEST_F(TextOutTest, cborOutputTest)
+{
+	TextOutTestRomData *const romData = new TextOutTestRomData(0, true);
+	const string cbor = cborOutput(romData);
+	romData->unref();
+
+	const uint8_t *p = reinterpret_cast<const uint8_t*>(cbor.data());
+	const uint8_t *const end = p + cbor.size();
+	string diag;
+	ASSERT_TRUE(cborToDiag(p, end, diag));
+	EXPECT_EQ(end, p) << "Trailing data after the CBOR document.";
+	EXPECT_EQ(string(cbor_expected), diag);
+}
+
+/**
+ * Verify the CBOR error output.
+ */
+TEST_F(TextOutTest, cborErrorOutputTest)
+{
+	ostringstream oss;
+	oss << CBORErrorOutput("couldn't open file", 2);
+	oss << CBORErrorOutput("rom is not supported");
+	const string cbor = oss.str();
+
+	// Two records are written as a CBOR sequence.
+	const uint8_t *p = reinterpret_cast<const uint8_t*>(cbor.data());
+	const uint8_t *const end = p + cbor.size();
+	string diag;
+	ASSERT_TRUE(cborToDiag(p, end, diag));
+	EXPECT_EQ("{\"error\": \"couldn't open file\", \"code\": 2}", diag);
+	diag.clear();
+	ASSERT_TRUE(cborToDiag(p, end, diag));
+	EXPECT_EQ("{\"error\": \"rom is not supported\"}", diag);
+	EXPECT_EQ(end, p);
+}
+
+/**
+ * Benchmark JSON output with a large RFT_LISTDATA field.
+ */
+TEST_F(TextOutTest, jsonLargeListDataBenchmark)
+{
+	TextOutTestRomData *const romData = new TextOutTestRomData(BENCHMARK_LIST_ROWS, false);
+	// Load the fields before the benchmark.
+	ASSERT_TRUE(romData->fields() != nullptr);
+
+	for (unsigned int i = 5; i > 0; i--) {
+		const string json = jsonOutput(romData);
+		EXPECT_GT(json.size(), BENCHMARK_LIST_ROWS * 64U);
+	}
+	romData->unref();
+}
+
+/**
+ * Benchmark CBOR output with a large RFT_LISTDATA field.
+ */
+TEST_F(TextOutTest, cborLargeListDataBenchmark)
+{
+	TextOutTestRomData *const romData = new TextOutTestRomData(BENCHMARK_LIST_ROWS, false);
+	// Load the fields before the benchmark.
+	ASSERT_TRUE(romData->fields() != nullptr);
+
+	for (unsigned int i = 5; i > 0; i--) {
+		const string cbor = cborOutput(romData);
+		EXPECT_GT(cbor.size(), BENCHMARK_LIST_ROWS * 48U);
+	}
+	romData->unref();
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: TextOut tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
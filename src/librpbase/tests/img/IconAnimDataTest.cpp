@@ -0,0 +1,368 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * IconAnimDataTest.cpp: IconAnimData frame deduplication tests.           *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpbase
+#include "common.h"
+#include "img/IconAnimData.hpp"
+#include "img/IconAnimHelper.hpp"
+#include "img/RpPng.hpp"
+
+// librpfile
+#include "librpfile/RpVectorFile.hpp"
+using LibRpFile::RpVectorFile;
+
+// librptexture
+#include "librptexture/img/rp_image.hpp"
+using LibRpTexture::rp_image;
+
+// C includes.
+#include <stdint.h>
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibRpBase { namespace Tests {
+
+class IconAnimDataTest : public ::testing::Test
+{
+	protected:
+		IconAnimDataTest()
+			: iconAnimData(nullptr)
+		{ }
+
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		/**
+		 * Create a CI8 test frame.
+		 * @param fill Pixel value.
+		 * @param pal_seed Palette seed.
+		 * @return CI8 rp_image.
+		 */
+		static rp_image *createFrameCI8(uint8_t fill, uint32_t pal_seed);
+
+		/**
+		 * Find a chunk in a PNG image.
+		 * @param png PNG image.
+		 * @param type Chunk type.
+		 * @return Offset of the chunk data, or -1 if not found.
+		 */
+		static int findChunk(const vector<uint8_t> &png, const char *type);
+
+		/**
+		 * Read a big-endian 32-bit value.
+		 * @param p Data.
+		 * @return Value.
+		 */
+		static inline uint32_t readBE32(const uint8_t *p)
+		{
+			return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+		}
+
+		/**
+		 * Save iconAnimData as a PNG image.
+		 * @param png [out] PNG image.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int savePng(vector<uint8_t> &png);
+
+	public:
+		IconAnimData *iconAnimData;
+
+		// Test frame size.
+		static const int FRAME_W = 8;
+		static const int FRAME_H = 8;
+};
+
+/**
+ * SetUp() function.
+ * Run before each test.
+ */
+void IconAnimDataTest::SetUp(void)
+{
+	iconAnimData = new IconAnimData();
+}
+
+/**
+ * TearDown() function.
+ * Run after each test.
+ */
+void IconAnimDataTest::TearDown(void)
+{
+	UNREF_AND_NULL(iconAnimData);
+}
+
+/**
+ * Create a CI8 test frame.
+ * @param fill Pixel value.
+ * @param pal_seed Palette seed.
+ * @return CI8 rp_image.
+ */
+rp_image *IconAnimDataTest::createFrameCI8(uint8_t fill, uint32_t pal_seed)
+{
+	rp_image *const img = new rp_image(FRAME_W, FRAME_H, rp_image::Format::CI8);
+	for (int y = 0; y < FRAME_H; y++) {
+		memset(img->scanLine(y), fill, FRAME_W);
+	}
+	uint32_t *const palette = img->palette();
+	for (int i = 0; i < img->palette_len(); i++) {
+		pal_seed = (pal_seed * 1103515245U) + 12345U;
+		palette[i] = pal_seed | 0xFF000000U;
+	}
+	return img;
+}
+
+/**
+ * Find a chunk in a PNG image.
+ * @param png PNG image.
+ * @param type Chunk type.
+ * @return Offset of the chunk data, or -1 if not found.
+ */
+int IconAnimDataTest::findChunk(const vector<uint8_t> &png, const char *type)
+{
+	// Skip the PNG signature.
+	size_t pos = 8;
+	while (pos + 8 <= png.size()) {
+		const uint32_t len = readBE32(&png[pos]);
+		if (!memcmp(&png[pos + 4], type, 4)) {
+			return static_cast<int>(pos + 8);
+		}
+		// Length, type, data, CRC32.
+		pos += 12 + len;
+	}
+	return -1;
+}
+
+/**
+ * Save iconAnimData as a PNG image.
+ * @param png [out] PNG image.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int IconAnimDataTest::savePng(vector<uint8_t> &png)
+{
+	RpVectorFile *const file = new RpVectorFile();
+	const int ret = RpPng::save(file, iconAnimData);
+	png = file->vector();
+	file->unref();
+	return ret;
+}
+
+/**
+ * Test IconAnimData::hashData().
+ */
+TEST_F(IconAnimDataTest, hashDataTest)
+{
+	static const uint8_t data1[] = {0x01, 0x02, 0x03, 0x04};
+	static const uint8_t data2[] = {0x01, 0x02, 0x03, 0x05};
+	static const uint8_t data12[] = {0x01, 0x02, 0x03, 0x04, 0x01, 0x02, 0x03, 0x05};
+
+	EXPECT_EQ(IconAnimData::hashData(data1, sizeof(data1)), IconAnimData::hashData(data1, sizeof(data1)));
+	EXPECT_NE(IconAnimData::hashData(data1, sizeof(data1)), IconAnimData::hashData(data2, sizeof(data2)));
+	EXPECT_NE(0U, IconAnimData::hashData(data1, 0));
+
+	// Chained hashes are equivalent to hashing the concatenated data.
+	EXPECT_EQ(IconAnimData::hashData(data12, sizeof(data12)),
+		IconAnimData::hashData(data2, sizeof(data2),
+			IconAnimData::hashData(data1, sizeof(data1))));
+}
+
+/**
+ * Test IconAnimData::addFrame() and IconAnimData::findFrame().
+ */
+TEST_F(IconAnimDataTest, addFindFrameTest)
+{
+	EXPECT_EQ(-1, iconAnimData->findFrame(1234));
+
+	EXPECT_EQ(0, iconAnimData->addFrame(createFrameCI8(0, 1), 1234));
+	EXPECT_EQ(1, iconAnimData->addFrame(nullptr, 5678));
+	EXPECT_EQ(2, iconAnimData->addFrame(createFrameCI8(1, 1), 9999));
+	EXPECT_EQ(3, iconAnimData->count);
+
+	EXPECT_EQ(0, iconAnimData->findFrame(1234));
+	EXPECT_EQ(2, iconAnimData->findFrame(9999));
+	// Blank frames and "no hash" are never matched.
+	EXPECT_EQ(-1, iconAnimData->findFrame(5678));
+	EXPECT_EQ(-1, iconAnimData->findFrame(0));
+
+	// Fill the frame array.
+	for (int i = iconAnimData->count; i < IconAnimData::MAX_FRAMES; i++) {
+		ASSERT_EQ(i, iconAnimData->addFrame(nullptr, 0));
+	}
+	EXPECT_EQ(-1, iconAnimData->addFrame(nullptr, 0));
+	EXPECT_EQ((int)IconAnimData::MAX_FRAMES, iconAnimData->count);
+}
+
+/**
+ * Test IconAnimData::hasSharedPalette().
+ */
+TEST_F(IconAnimDataTest, hasSharedPaletteTest)
+{
+	// No frames.
+	EXPECT_TRUE(iconAnimData->hasSharedPalette());
+
+	iconAnimData->addFrame(createFrameCI8(0, 1), 1);
+	iconAnimData->addFrame(createFrameCI8(1, 1), 2);
+	iconAnimData->addFrame(new rp_image(FRAME_W, FRAME_H, rp_image::Format::ARGB32), 3);
+	EXPECT_TRUE(iconAnimData->hasSharedPalette());
+
+	iconAnimData->addFrame(createFrameCI8(2, 2), 4);
+	EXPECT_FALSE(iconAnimData->hasSharedPalette());
+}
+
+/**
+ * IconAnimHelper: An animation with a single unique frame isn't animated.
+ */
+TEST_F(IconAnimDataTest, iconAnimHelperTest)
+{
+	iconAnimData->addFrame(createFrameCI8(0, 1), 1);
+	for (int i = 0; i < 3; i++) {
+		iconAnimData->seq_index[i] = 0;
+		iconAnimData->delays[i].numer = 1;
+		iconAnimData->delays[i].denom = 10;
+		iconAnimData->delays[i].ms = 100;
+	}
+	iconAnimData->seq_count = 3;
+
+	IconAnimHelper helper;
+	helper.setIconAnimData(iconAnimData);
+	EXPECT_FALSE(helper.isAnimated());
+	EXPECT_EQ(0, helper.frameNumber());
+
+	// Add a second frame.
+	iconAnimData->addFrame(createFrameCI8(1, 1), 2);
+	iconAnimData->seq_index[1] = 1;
+	helper.setIconAnimData(iconAnimData);
+	EXPECT_TRUE(helper.isAnimated());
+
+	int delay = 0;
+	EXPECT_EQ(1, helper.nextFrame(&delay));
+	EXPECT_EQ(100, delay);
+	EXPECT_EQ(0, helper.nextFrame(&delay));
+	EXPECT_EQ(0, helper.nextFrame(&delay));
+	EXPECT_EQ(1, helper.nextFrame(&delay));
+}
+
+/**
+ * RpPng: A sequence with a single unique frame is saved as a standard PNG.
+ */
+TEST_F(IconAnimDataTest, savePngSingleFrameTest)
+{
+	iconAnimData->addFrame(createFrameCI8(0, 1), 1);
+	for (int i = 0; i < 4; i++) {
+		iconAnimData->seq_index[i] = 0;
+		iconAnimData->delays[i].numer = 1;
+		iconAnimData->delays[i].denom = 10;
+		iconAnimData->delays[i].ms = 100;
+	}
+	iconAnimData->seq_count = 4;
+
+	vector<uint8_t> png;
+	ASSERT_EQ(0, savePng(png));
+	ASSERT_GT(png.size(), 8U);
+	EXPECT_GE(findChunk(png, "IHDR"), 0);
+	EXPECT_GE(findChunk(png, "PLTE"), 0);
+	EXPECT_EQ(-1, findChunk(png, "acTL"));
+}
+
+/**
+ * RpPng: Consecutive repeated frames are merged into a single APNG frame.
+ */
+TEST_F(IconAnimDataTest, saveApngMergeTest)
+{
+	// Sequence: A, A, B, A
+	iconAnimData->addFrame(createFrameCI8(0, 1), 1);
+	iconAnimData->addFrame(createFrameCI8(1, 1), 2);
+	static const uint8_t seq[] = {0, 0, 1, 0};
+	for (int i = 0; i < (int)ARRAY_SIZE(seq); i++) {
+		iconAnimData->seq_index[i] = seq[i];
+		iconAnimData->delays[i].numer = 1;
+		iconAnimData->delays[i].denom = 10;
+		iconAnimData->delays[i].ms = 100;
+	}
+	iconAnimData->seq_count = ARRAY_SIZE(seq);
+
+	vector<uint8_t> png;
+	const int ret = savePng(png);
+	if (ret == -ENOTSUP) {
+		fprintf(stderr, "*** APNG is not supported by libpng. Skipping test.\n");
+		return;
+	}
+	ASSERT_EQ(0, ret);
+
+	// acTL: num_frames, num_plays
+	const int acTL = findChunk(png, "acTL");
+	ASSERT_GE(acTL, 0);
+	EXPECT_EQ(3U, readBE32(&png[acTL]));
+
+	// First fcTL has the merged delay.
+	// fcTL: seq, width, height, x, y, delay_num (16-bit), delay_den (16-bit), ...
+	const int fcTL = findChunk(png, "fcTL");
+	ASSERT_GE(fcTL, 0);
+	EXPECT_EQ(2U, (unsigned int)((png[fcTL + 20] << 8) | png[fcTL + 21]));
+	EXPECT_EQ(10U, (unsigned int)((png[fcTL + 22] << 8) | png[fcTL + 23]));
+
+	// Shared palette: Saved as CI8.
+	const int IHDR = findChunk(png, "IHDR");
+	ASSERT_GE(IHDR, 0);
+	EXPECT_EQ(3U, png[IHDR + 9]);	// PNG_COLOR_TYPE_PALETTE
+}
+
+/**
+ * RpPng: CI8 frames with different palettes are saved as ARGB32.
+ */
+TEST_F(IconAnimDataTest, saveApngPaletteTest)
+{
+	iconAnimData->addFrame(createFrameCI8(0, 1), 1);
+	iconAnimData->addFrame(createFrameCI8(0, 2), 2);
+	for (int i = 0; i < 2; i++) {
+		iconAnimData->seq_index[i] = i;
+		iconAnimData->delays[i].numer = 1;
+		iconAnimData->delays[i].denom = 10;
+		iconAnimData->delays[i].ms = 100;
+	}
+	iconAnimData->seq_count = 2;
+
+	vector<uint8_t> png;
+	const int ret = savePng(png);
+	if (ret == -ENOTSUP) {
+		fprintf(stderr, "*** APNG is not supported by libpng. Skipping test.\n");
+		return;
+	}
+	ASSERT_EQ(0, ret);
+
+	const int IHDR = findChunk(png, "IHDR");
+	ASSERT_GE(IHDR, 0);
+	EXPECT_NE(3U, png[IHDR + 9]);	// not PNG_COLOR_TYPE_PALETTE
+	EXPECT_EQ(-1, findChunk(png, "PLTE"));
+}
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: IconAnimData tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,143 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpcpu)                         *
+ * byteswap_avx512.c: Byteswapping functions.                              *
+ * AVX-512BW-optimized version.                                            *
+ *                                                                         *
+ * Copyright (c) 2008-2020 by David Korth                                  *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "byteswap.h"
+
+// C includes.
+#include <assert.h>
+
+// AVX-512 intrinsics.
+#include <immintrin.h>
+
+// NOTE: Partial vectors at the start and end of the array are handled
+// using XMM registers and scalar swaps instead of masked loads/stores.
+// Masked stores can't be forwarded to subsequent loads, which makes
+// them very slow if the data is read again soon after swapping.
+
+/**
+ * 16-bit byteswap function.
+ * AVX-512BW-optimized version.
+ * @param ptr Pointer to array to swap. (MUST be 16-bit aligned!)
+ * @param n Number of bytes to swap. (Must be divisible by 2; an extra odd byte will be ignored.)
+ */
+void __byte_swap_16_array_avx512(uint16_t *ptr, size_t n)
+{
+	const __m128i shuf_mask_xmm = _mm_setr_epi8(1,0, 3,2, 5,4, 7,6, 9,8, 11,10, 13,12, 15,14);
+	const __m512i shuf_mask = _mm512_broadcast_i32x4(shuf_mask_xmm);
+
+	// Verify the block is 16-bit aligned
+	// and is a multiple of 2 bytes.
+	assert(((uintptr_t)ptr & 1) == 0);
+	assert((n & 1) == 0);
+	n &= ~1;
+
+	// If vptr isn't 16-byte aligned, swap WORDs
+	// manually until we get to 16-byte alignment.
+	for (; ((uintptr_t)ptr % 16 != 0) && n > 0; n -= 2, ptr++) {
+		*ptr = __swab16(*ptr);
+	}
+
+	// If vptr isn't 64-byte aligned, swap 8 WORDs at a time
+	// using SSSE3 until we get to 64-byte alignment.
+	for (; ((uintptr_t)ptr % 64 != 0) && n >= 16; n -= 16, ptr += 8) {
+		__m128i *xmm_ptr = (__m128i*)ptr;
+		_mm_store_si128(xmm_ptr, _mm_shuffle_epi8(_mm_load_si128(xmm_ptr), shuf_mask_xmm));
+	}
+
+	// Process 64 WORDs per iteration using AVX-512BW.
+	for (; n >= 128; n -= 128, ptr += 64) {
+		__m512i *zmm_ptr = (__m512i*)ptr;
+
+		__m512i zmm0 = _mm512_load_si512(&zmm_ptr[0]);
+		__m512i zmm1 = _mm512_load_si512(&zmm_ptr[1]);
+
+		_mm512_store_si512(&zmm_ptr[0], _mm512_shuffle_epi8(zmm0, shuf_mask));
+		_mm512_store_si512(&zmm_ptr[1], _mm512_shuffle_epi8(zmm1, shuf_mask));
+	}
+
+	// Process 32 WORDs if there's enough data left.
+	if (n >= 64) {
+		__m512i *zmm_ptr = (__m512i*)ptr;
+		_mm512_store_si512(zmm_ptr, _mm512_shuffle_epi8(_mm512_load_si512(zmm_ptr), shuf_mask));
+		n -= 64;
+		ptr += 32;
+	}
+
+	// Process 8 WORDs at a time using SSSE3.
+	for (; n >= 16; n -= 16, ptr += 8) {
+		__m128i *xmm_ptr = (__m128i*)ptr;
+		_mm_store_si128(xmm_ptr, _mm_shuffle_epi8(_mm_load_si128(xmm_ptr), shuf_mask_xmm));
+	}
+
+	// Process the remaining data, one WORD at a time.
+	for (; n > 0; n -= 2, ptr++) {
+		*ptr = __swab16(*ptr);
+	}
+}
+
+/**
+ * 32-bit byteswap function.
+ * AVX-512BW-optimized version.
+ * @param ptr Pointer to array to swap. (MUST be 32-bit aligned!)
+ * @param n Number of bytes to swap. (Must be divisible by 4; extra bytes will be ignored.)
+ */
+void __byte_swap_32_array_avx512(uint32_t *ptr, size_t n)
+{
+	const __m128i shuf_mask_xmm = _mm_setr_epi8(3,2,1,0, 7,6,5,4, 11,10,9,8, 15,14,13,12);
+	const __m512i shuf_mask = _mm512_broadcast_i32x4(shuf_mask_xmm);
+
+	// Verify the block is 32-bit aligned
+	// and is a multiple of 4 bytes.
+	assert(((uintptr_t)ptr & 3) == 0);
+	assert((n & 3) == 0);
+	n &= ~3;
+
+	// If vptr isn't 16-byte aligned, swap DWORDs
+	// manually until we get to 16-byte alignment.
+	for (; ((uintptr_t)ptr % 16 != 0) && n > 0; n -= 4, ptr++) {
+		*ptr = __swab32(*ptr);
+	}
+
+	// If vptr isn't 64-byte aligned, swap 4 DWORDs at a time
+	// using SSSE3 until we get to 64-byte alignment.
+	for (; ((uintptr_t)ptr % 64 != 0) && n >= 16; n -= 16, ptr += 4) {
+		__m128i *xmm_ptr = (__m128i*)ptr;
+		_mm_store_si128(xmm_ptr, _mm_shuffle_epi8(_mm_load_si128(xmm_ptr), shuf_mask_xmm));
+	}
+
+	// Process 32 DWORDs per iteration using AVX-512BW.
+	for (; n >= 128; n -= 128, ptr += 32) {
+		__m512i *zmm_ptr = (__m512i*)ptr;
+
+		__m512i zmm0 = _mm512_load_si512(&zmm_ptr[0]);
+		__m512i zmm1 = _mm512_load_si512(&zmm_ptr[1]);
+
+		_mm512_store_si512(&zmm_ptr[0], _mm512_shuffle_epi8(zmm0, shuf_mask));
+		_mm512_store_si512(&zmm_ptr[1], _mm512_shuffle_epi8(zmm1, shuf_mask));
+	}
+
+	// Process 16 DWORDs if there's enough data left.
+	if (n >= 64) {
+		__m512i *zmm_ptr = (__m512i*)ptr;
+		_mm512_store_si512(zmm_ptr, _mm512_shuffle_epi8(_mm512_load_si512(zmm_ptr), shuf_mask));
+		n -= 64;
+		ptr += 16;
+	}
+
+	// Process 4 DWORDs at a time using SSSE3.
+	for (; n >= 16; n -= 16, ptr += 4) {
+		__m128i *xmm_ptr = (__m128i*)ptr;
+		_mm_store_si128(xmm_ptr, _mm_shuffle_epi8(_mm_load_si128(xmm_ptr), shuf_mask_xmm));
+	}
+
+	// Process the remaining data, one DWORD at a time.
+	for (; n > 0; n -= 4, ptr++) {
+		*ptr = __swab32(*ptr);
+	}
+}
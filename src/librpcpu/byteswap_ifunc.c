@@ -17,6 +17,16 @@
  */
 static __typeof__(&__byte_swap_16_array_c) __byte_swap_16_array_resolve(void)
 {
+#ifdef BYTESWAP_HAS_AVX512
+	if (RP_CPU_HasAVX512BW()) {
+		return &__byte_swap_16_array_avx512;
+	} else
+#endif /* BYTESWAP_HAS_AVX512 */
+#ifdef BYTESWAP_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &__byte_swap_16_array_avx2;
+	} else
+#endif /* BYTESWAP_HAS_AVX2 */
 #ifdef BYTESWAP_HAS_SSSE3
 	if (RP_CPU_HasSSSE3()) {
 		return &__byte_swap_16_array_ssse3;
@@ -49,6 +59,16 @@ static __typeof__(&__byte_swap_16_array_c) __byte_swap_16_array_resolve(void)
  */
 static __typeof__(&__byte_swap_32_array_c) __byte_swap_32_array_resolve(void)
 {
+#ifdef BYTESWAP_HAS_AVX512
+	if (RP_CPU_HasAVX512BW()) {
+		return &__byte_swap_32_array_avx512;
+	} else
+#endif /* BYTESWAP_HAS_AVX512 */
+#ifdef BYTESWAP_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &__byte_swap_32_array_avx2;
+	} else
+#endif /* BYTESWAP_HAS_AVX2 */
 #ifdef BYTESWAP_HAS_SSSE3
 	if (RP_CPU_HasSSSE3()) {
 		return &__byte_swap_32_array_ssse3;
@@ -43,6 +43,7 @@
 
 // Flags stored in the %ecx register.
 #define CPUFLAG_IA32_ECX_SSE3		((uint32_t)(1U << 0))
+#define CPUFLAG_IA32_ECX_PCLMULQDQ	((uint32_t)(1U << 1))
 #define CPUFLAG_IA32_ECX_SSSE3		((uint32_t)(1U << 9))
 #define CPUFLAG_IA32_ECX_SSE41		((uint32_t)(1U << 19))
 #define CPUFLAG_IA32_ECX_SSE42		((uint32_t)(1U << 20))
@@ -51,10 +52,25 @@
 #define CPUFLAG_IA32_ECX_AVX		((uint32_t)(1U << 28))
 #define CPUFLAG_IA32_ECX_FMA3		((uint32_t)(1U << 12))
 
+// XCR0: Extended control register.
+// If both of these bits are set, the OS saves the YMM registers.
+#define IA32_XCR0_SSE_STATE		((uint32_t)(1U << 1))
+#define IA32_XCR0_AVX_STATE		((uint32_t)(1U << 2))
+// If all three of these bits are set, the OS saves the
+// AVX-512 opmask registers and the full ZMM registers.
+#define IA32_XCR0_OPMASK_STATE		((uint32_t)(1U << 5))
+#define IA32_XCR0_ZMM_HI256_STATE	((uint32_t)(1U << 6))
+#define IA32_XCR0_HI16_ZMM_STATE	((uint32_t)(1U << 7))
+#define IA32_XCR0_AVX512_STATE \
+	(IA32_XCR0_OPMASK_STATE | IA32_XCR0_ZMM_HI256_STATE | IA32_XCR0_HI16_ZMM_STATE)
+
 // CPUID function 7: Extended Features
 
 // Flags stored in the %ebx register.
 #define CPUFLAG_IA32_FN7_EBX_AVX2	((uint32_t)(1U << 5))
+#define CPUFLAG_IA32_FN7_EBX_AVX512F	((uint32_t)(1U << 16))
+#define CPUFLAG_IA32_FN7_EBX_SHA	((uint32_t)(1U << 29))
+#define CPUFLAG_IA32_FN7_EBX_AVX512BW	((uint32_t)(1U << 30))
 
 // CPUID function 0x80000001: Extended Processor Info and Feature Bits
 
@@ -185,6 +201,71 @@ static FORCEINLINE void cpuid(unsigned int level, unsigned int regs[4])
 #endif
 }
 
+/**
+ * Run the `cpuid` instruction with a subfunction.
+ * @param level
+ * @param count Subfunction. (%ecx)
+ * @param regs Registers. (%eax, %ebx, %ecx, %edx)
+ */
+static FORCEINLINE void cpuid_count(unsigned int level, unsigned int count, unsigned int regs[4])
+{
+#if defined(__GNUC__)
+# ifdef ASM_RESERVE_EBX
+	__asm__ (
+		"xchgl	%%ebx, %1\n"
+		"cpuid\n"
+		"xchgl	%%ebx, %1\n"
+		: "=a" (regs[0]), "=r" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+		: "0" (level), "2" (count)
+		);
+# else /* !ASM_RESERVE_EBX */
+	__asm__ (
+		"cpuid\n"
+		: "=a" (regs[0]), "=b" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+		: "0" (level), "2" (count)
+		);
+# endif
+#elif defined(_MSC_VER) && (_MSC_VER > 1500 || (_MSC_VER == 1500 && _MSC_FULL_VER >= 150030729))
+	// MSVC 2008 SP1+ has the __cpuidex() intrinsic.
+	__cpuidex((int*)regs, level, count);
+#else
+	// Subfunctions aren't supported.
+	// Return no features.
+	RP_UNUSED(level);
+	RP_UNUSED(count);
+	regs[0] = 0; regs[1] = 0; regs[2] = 0; regs[3] = 0;
+#endif
+}
+
+/**
+ * Run the `xgetbv` instruction.
+ * Only valid if CPUID reports OSXSAVE.
+ * @param xcr Extended control register index.
+ * @return Low 32 bits of the extended control register.
+ */
+static FORCEINLINE uint32_t xgetbv(unsigned int xcr)
+{
+#if defined(__GNUC__)
+	// NOTE: Using the opcode bytes directly, since older
+	// assemblers don't recognize the `xgetbv` mnemonic.
+	uint32_t __eax, __edx;
+	__asm__ (
+		".byte 0x0f, 0x01, 0xd0\n"
+		: "=a" (__eax), "=d" (__edx)
+		: "c" (xcr)
+		);
+	return __eax;
+#elif defined(_MSC_VER) && (_MSC_VER > 1600 || (_MSC_VER == 1600 && _MSC_FULL_VER >= 160040219))
+	// MSVC 2010 SP1+ has the _xgetbv() intrinsic.
+	return (uint32_t)_xgetbv(xcr);
+#else
+	// xgetbv isn't supported.
+	// Report no OS support for extended states.
+	RP_UNUSED(xcr);
+	return 0;
+#endif
+}
+
 // Register indexes.
 #define REG_EAX 0
 #define REG_EBX 1
@@ -202,6 +283,7 @@ static void RP_CPU_InitCPUFlags_int(void)
 {
 	unsigned int regs[4];	// %eax, %ebx, %ecx, %edx
 	unsigned int maxFunc;
+	uint32_t xcr0 = 0;
 #if defined(__i386__) || defined(_M_IX86)
 	uint8_t can_FXSAVE = 0;
 #endif /* defined(__i386__) || defined(_M_IX86) */
@@ -295,6 +377,8 @@ static void RP_CPU_InitCPUFlags_int(void)
 				RP_CPU_Flags |= RP_CPUFLAG_X86_SSE41;
 			if (regs[REG_ECX] & CPUFLAG_IA32_ECX_SSE42)
 				RP_CPU_Flags |= RP_CPUFLAG_X86_SSE42;
+			if (regs[REG_ECX] & CPUFLAG_IA32_ECX_PCLMULQDQ)
+				RP_CPU_Flags |= RP_CPUFLAG_X86_PCLMULQDQ;
 		}
 #else /* !(defined(__i386__) || defined(_M_IX86)) */
 		// AMD64: SSE2 and lower are always supported.
@@ -307,7 +391,47 @@ static void RP_CPU_InitCPUFlags_int(void)
 			RP_CPU_Flags |= RP_CPUFLAG_X86_SSE41;
 		if (regs[REG_ECX] & CPUFLAG_IA32_ECX_SSE42)
 			RP_CPU_Flags |= RP_CPUFLAG_X86_SSE42;
+		if (regs[REG_ECX] & CPUFLAG_IA32_ECX_PCLMULQDQ)
+			RP_CPU_Flags |= RP_CPUFLAG_X86_PCLMULQDQ;
 #endif /* defined(__i386__) || defined(_M_IX86) */
+
+		// AVX requires OS support for saving the YMM registers.
+		// NOTE: Only checked if SSE is usable, since the OS
+		// must support saving the XMM registers, too.
+		if ((RP_CPU_Flags & RP_CPUFLAG_X86_SSE) &&
+		    (regs[REG_ECX] & (CPUFLAG_IA32_ECX_OSXSAVE | CPUFLAG_IA32_ECX_AVX)) ==
+		     (CPUFLAG_IA32_ECX_OSXSAVE | CPUFLAG_IA32_ECX_AVX))
+		{
+			xcr0 = xgetbv(0);
+			if ((xcr0 & (IA32_XCR0_SSE_STATE | IA32_XCR0_AVX_STATE)) ==
+			    (IA32_XCR0_SSE_STATE | IA32_XCR0_AVX_STATE))
+			{
+				RP_CPU_Flags |= RP_CPUFLAG_X86_AVX;
+			}
+		}
+	}
+
+	// NOTE: The SHA extensions use XMM registers,
+	// so SSE must be usable on i386.
+	if (maxFunc >= CPUID_EXT_FEATURES && (RP_CPU_Flags & RP_CPUFLAG_X86_SSE41)) {
+		// Get the extended features.
+		cpuid_count(CPUID_EXT_FEATURES, 0, regs);
+		if (regs[REG_EBX] & CPUFLAG_IA32_FN7_EBX_SHA)
+			RP_CPU_Flags |= RP_CPUFLAG_X86_SHA;
+		// AVX2 uses the YMM registers, so AVX must be usable.
+		if ((RP_CPU_Flags & RP_CPUFLAG_X86_AVX) && (regs[REG_EBX] & CPUFLAG_IA32_FN7_EBX_AVX2))
+			RP_CPU_Flags |= RP_CPUFLAG_X86_AVX2;
+
+		// AVX-512 requires OS support for saving the
+		// opmask registers and the upper ZMM registers.
+		if ((RP_CPU_Flags & RP_CPUFLAG_X86_AVX) &&
+		    (xcr0 & IA32_XCR0_AVX512_STATE) == IA32_XCR0_AVX512_STATE &&
+		    (regs[REG_EBX] & CPUFLAG_IA32_FN7_EBX_AVX512F))
+		{
+			RP_CPU_Flags |= RP_CPUFLAG_X86_AVX512F;
+			if (regs[REG_EBX] & CPUFLAG_IA32_FN7_EBX_AVX512BW)
+				RP_CPU_Flags |= RP_CPUFLAG_X86_AVX512BW;
+		}
 	}
 
 	// CPU flags initialized.
@@ -29,6 +29,12 @@ extern "C" {
 #define RP_CPUFLAG_X86_SSSE3		((uint32_t)(1U << 4))
 #define RP_CPUFLAG_X86_SSE41		((uint32_t)(1U << 5))
 #define RP_CPUFLAG_X86_SSE42		((uint32_t)(1U << 6))
+#define RP_CPUFLAG_X86_PCLMULQDQ	((uint32_t)(1U << 7))
+#define RP_CPUFLAG_X86_SHA		((uint32_t)(1U << 8))
+#define RP_CPUFLAG_X86_AVX		((uint32_t)(1U << 9))
+#define RP_CPUFLAG_X86_AVX2		((uint32_t)(1U << 10))
+#define RP_CPUFLAG_X86_AVX512F		((uint32_t)(1U << 11))
+#define RP_CPUFLAG_X86_AVX512BW		((uint32_t)(1U << 12))
 
 #endif /* defined(__i386__) || defined(__amd64__) || defined(__x86_64__) */
 
@@ -99,6 +105,82 @@ static FORCEINLINE int RP_CPU_HasSSE41(void)
 	return (RP_CPU_Flags & RP_CPUFLAG_X86_SSE41);
 }
 
+/**
+ * Check if the CPU supports PCLMULQDQ.
+ * @return Non-zero if PCLMULQDQ is supported; 0 if not.
+ */
+static FORCEINLINE int RP_CPU_HasPCLMULQDQ(void)
+{
+	if (unlikely(!RP_CPU_Flags_Init)) {
+		RP_CPU_InitCPUFlags();
+	}
+	return (RP_CPU_Flags & RP_CPUFLAG_X86_PCLMULQDQ);
+}
+
+/**
+ * Check if the CPU supports the SHA extensions.
+ * @return Non-zero if SHA is supported; 0 if not.
+ */
+static FORCEINLINE int RP_CPU_HasSHA(void)
+{
+	if (unlikely(!RP_CPU_Flags_Init)) {
+		RP_CPU_InitCPUFlags();
+	}
+	return (RP_CPU_Flags & RP_CPUFLAG_X86_SHA);
+}
+
+/**
+ * Check if the CPU supports AVX.
+ * This also checks if the OS saves the YMM registers.
+ * @return Non-zero if AVX is supported; 0 if not.
+ */
+static FORCEINLINE int RP_CPU_HasAVX(void)
+{
+	if (unlikely(!RP_CPU_Flags_Init)) {
+		RP_CPU_InitCPUFlags();
+	}
+	return (RP_CPU_Flags & RP_CPUFLAG_X86_AVX);
+}
+
+/**
+ * Check if the CPU supports AVX2.
+ * This also checks if the OS saves the YMM registers.
+ * @return Non-zero if AVX2 is supported; 0 if not.
+ */
+static FORCEINLINE int RP_CPU_HasAVX2(void)
+{
+	if (unlikely(!RP_CPU_Flags_Init)) {
+		RP_CPU_InitCPUFlags();
+	}
+	return (RP_CPU_Flags & RP_CPUFLAG_X86_AVX2);
+}
+
+/**
+ * Check if the CPU supports AVX-512F.
+ * This also checks if the OS saves the ZMM registers.
+ * @return Non-zero if AVX-512F is supported; 0 if not.
+ */
+static FORCEINLINE int RP_CPU_HasAVX512F(void)
+{
+	if (unlikely(!RP_CPU_Flags_Init)) {
+		RP_CPU_InitCPUFlags();
+	}
+	return (RP_CPU_Flags & RP_CPUFLAG_X86_AVX512F);
+}
+
+/**
+ * Check if the CPU supports AVX-512BW.
+ * This also checks if the OS saves the ZMM registers.
+ * @return Non-zero if AVX-512BW is supported; 0 if not.
+ */
+static FORCEINLINE int RP_CPU_HasAVX512BW(void)
+{
+	if (unlikely(!RP_CPU_Flags_Init)) {
+		RP_CPU_InitCPUFlags();
+	}
+	return (RP_CPU_Flags & RP_CPUFLAG_X86_AVX512BW);
+}
+
 #ifdef __cplusplus
 }
 #endif
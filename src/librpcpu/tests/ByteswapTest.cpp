@@ -16,6 +16,10 @@
 
 // C includes. (C++ namespace)
 #include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <chrono>
 
 namespace LibRpCpu { namespace Tests {
 
@@ -366,8 +370,33 @@ DO_ARRAY_32_unQWORD_TEST	(ssse3, RP_CPU_HasSSSE3(), "*** SSSE3 is not supported
 DO_ARRAY_32_unQWORD_BENCHMARK	(ssse3, RP_CPU_HasSSSE3(), "*** SSSE3 is not supported on this CPU. Skipping test.\n")
 #endif /* BYTESWAP_HAS_SSSE3 */
 
+#ifdef BYTESWAP_HAS_AVX2
+// AVX2-optimized tests.
+DO_ARRAY_16_TEST		(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_16_BENCHMARK		(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_16_unDWORD_TEST	(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_16_unDWORD_BENCHMARK	(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_32_TEST		(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_32_BENCHMARK		(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_32_unQWORD_TEST	(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_32_unQWORD_BENCHMARK	(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+#endif /* BYTESWAP_HAS_AVX2 */
+
+#ifdef BYTESWAP_HAS_AVX512
+// AVX-512BW-optimized tests.
+DO_ARRAY_16_TEST		(avx512, RP_CPU_HasAVX512BW(), "*** AVX-512BW is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_16_BENCHMARK		(avx512, RP_CPU_HasAVX512BW(), "*** AVX-512BW is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_16_unDWORD_TEST	(avx512, RP_CPU_HasAVX512BW(), "*** AVX-512BW is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_16_unDWORD_BENCHMARK	(avx512, RP_CPU_HasAVX512BW(), "*** AVX-512BW is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_32_TEST		(avx512, RP_CPU_HasAVX512BW(), "*** AVX-512BW is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_32_BENCHMARK		(avx512, RP_CPU_HasAVX512BW(), "*** AVX-512BW is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_32_unQWORD_TEST	(avx512, RP_CPU_HasAVX512BW(), "*** AVX-512BW is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_32_unQWORD_BENCHMARK	(avx512, RP_CPU_HasAVX512BW(), "*** AVX-512BW is not supported on this CPU. Skipping test.\n")
+#endif /* BYTESWAP_HAS_AVX512 */
+
 // NOTE: Add more instruction sets to the #ifdef if other optimizations are added.
-#if defined(BYTESWAP_HAS_MMX) || defined(BYTESWAP_HAS_SSE2) || defined(BYTESWAP_HAS_SSSE3)
+#if defined(BYTESWAP_HAS_MMX) || defined(BYTESWAP_HAS_SSE2) || defined(BYTESWAP_HAS_SSSE3) || \
+    defined(BYTESWAP_HAS_AVX2) || defined(BYTESWAP_HAS_AVX512)
 // Dispatch functions.
 DO_ARRAY_16_TEST		(dispatch, true, "")
 DO_ARRAY_16_BENCHMARK		(dispatch, true, "")
@@ -377,7 +406,171 @@ DO_ARRAY_32_TEST		(dispatch, true, "")
 DO_ARRAY_32_BENCHMARK		(dispatch, true, "")
 DO_ARRAY_32_unQWORD_TEST	(dispatch, true, "")
 DO_ARRAY_32_unQWORD_BENCHMARK	(dispatch, true, "")
-#endif /* BYTESWAP_HAS_MMX || BYTESWAP_HAS_SSE2 || BYTESWAP_HAS_SSSE3 */
+#endif /* BYTESWAP_HAS_MMX || BYTESWAP_HAS_SSE2 || BYTESWAP_HAS_SSSE3 || BYTESWAP_HAS_AVX2 || BYTESWAP_HAS_AVX512 */
+
+/** Buffer size and alignment sweeps. **/
+
+/**
+ * Byteswap function implementation.
+ */
+struct ByteswapImpl {
+	const char *name;
+	int (*isSupported)(void);
+	void (*fn16)(uint16_t *ptr, size_t n);
+	void (*fn32)(uint32_t *ptr, size_t n);
+};
+
+/**
+ * Dummy CPU check for the standard version.
+ * @return 1
+ */
+static int AlwaysSupported(void)
+{
+	return 1;
+}
+
+static const ByteswapImpl byteswapImpls[] = {
+	{"c", AlwaysSupported, __byte_swap_16_array_c, __byte_swap_32_array_c},
+#ifdef BYTESWAP_HAS_MMX
+	{"mmx", RP_CPU_HasMMX, __byte_swap_16_array_mmx, __byte_swap_32_array_mmx},
+#endif /* BYTESWAP_HAS_MMX */
+#ifdef BYTESWAP_HAS_SSE2
+	{"sse2", RP_CPU_HasSSE2, __byte_swap_16_array_sse2, __byte_swap_32_array_sse2},
+#endif /* BYTESWAP_HAS_SSE2 */
+#ifdef BYTESWAP_HAS_SSSE3
+	{"ssse3", RP_CPU_HasSSSE3, __byte_swap_16_array_ssse3, __byte_swap_32_array_ssse3},
+#endif /* BYTESWAP_HAS_SSSE3 */
+#ifdef BYTESWAP_HAS_AVX2
+	{"avx2", RP_CPU_HasAVX2, __byte_swap_16_array_avx2, __byte_swap_32_array_avx2},
+#endif /* BYTESWAP_HAS_AVX2 */
+#ifdef BYTESWAP_HAS_AVX512
+	{"avx512", RP_CPU_HasAVX512BW, __byte_swap_16_array_avx512, __byte_swap_32_array_avx512},
+#endif /* BYTESWAP_HAS_AVX512 */
+};
+
+/**
+ * Test all byteswap implementations with every buffer alignment
+ * within a 64-byte block and a range of buffer sizes.
+ *
+ * The SIMD versions have separate code paths for unaligned heads,
+ * full vectors, and short tails, so make sure all of them are used.
+ * Data outside of the buffer must not be modified.
+ */
+TEST_F(ByteswapTest, alignmentSweepTest)
+{
+	static const size_t MAX_SIZE = 512;
+	static const size_t BUF_SIZE = 64 + MAX_SIZE + 64;
+	uint8_t *const buf = static_cast<uint8_t*>(aligned_malloc(64, BUF_SIZE));
+	ASSERT_TRUE(buf != nullptr);
+
+	// Source data. The guard bytes around the buffer
+	// are compared, too, so the whole block is checked.
+	uint8_t src[BUF_SIZE], expected[BUF_SIZE];
+	for (size_t i = 0; i < BUF_SIZE; i++) {
+		src[i] = static_cast<uint8_t>((i * 7) + 1);
+	}
+
+	for (const ByteswapImpl &impl : byteswapImpls) {
+		if (!impl.isSupported()) {
+			fprintf(stderr, "*** %s is not supported on this CPU. Skipping.\n", impl.name);
+			continue;
+		}
+
+		for (size_t offset = 0; offset < 64; offset += 2) {
+			for (size_t size = 0; size <= MAX_SIZE; size += 2) {
+				// 16-bit
+				memcpy(expected, src, BUF_SIZE);
+				for (size_t i = offset; i < offset + size; i++) {
+					expected[i] = src[i ^ 1];
+				}
+				memcpy(buf, src, BUF_SIZE);
+				impl.fn16(reinterpret_cast<uint16_t*>(&buf[offset]), size);
+				ASSERT_EQ(0, memcmp(expected, buf, BUF_SIZE)) <<
+					"impl " << impl.name << ", 16-bit, offset " << offset << ", size " << size;
+
+				// 32-bit
+				if (offset % 4 != 0 || size % 4 != 0)
+					continue;
+				memcpy(expected, src, BUF_SIZE);
+				for (size_t i = offset; i < offset + size; i++) {
+					expected[i] = src[i ^ 3];
+				}
+				memcpy(buf, src, BUF_SIZE);
+				impl.fn32(reinterpret_cast<uint32_t*>(&buf[offset]), size);
+				ASSERT_EQ(0, memcmp(expected, buf, BUF_SIZE)) <<
+					"impl " << impl.name << ", 32-bit, offset " << offset << ", size " << size;
+			}
+		}
+	}
+
+	aligned_free(buf);
+}
+
+/**
+ * Measure the throughput of all byteswap implementations
+ * for various buffer sizes and alignments.
+ *
+ * Results are printed in MB/s. Each measurement swaps
+ * THROUGHPUT_BYTES bytes in total, split into buffers
+ * of the specified size.
+ */
+TEST_F(ByteswapTest, throughput_benchmark)
+{
+	static const size_t THROUGHPUT_BYTES = 256U * 1024U * 1024U;
+	static const size_t sizes[] = {64, 256, 1024, 4096, 65536, 1048576};
+	static const size_t offsets[] = {0, 2, 4, 8, 16, 32};
+	static const size_t MAX_SIZE = 1048576;
+
+	uint8_t *const buf = static_cast<uint8_t*>(aligned_malloc(64, MAX_SIZE + 64));
+	ASSERT_TRUE(buf != nullptr);
+	memset(buf, 0x55, MAX_SIZE + 64);
+
+	for (unsigned int bits = 16; bits <= 32; bits += 16) {
+		fprintf(stderr, "%u-bit byteswap throughput (MB/s):\n", bits);
+		fprintf(stderr, "%-8s %8s", "impl", "size");
+		for (size_t offset : offsets) {
+			fprintf(stderr, "   off %-2u", static_cast<unsigned int>(offset));
+		}
+		fputc('\n', stderr);
+
+		for (const ByteswapImpl &impl : byteswapImpls) {
+			if (!impl.isSupported())
+				continue;
+
+			for (size_t size : sizes) {
+				fprintf(stderr, "%-8s %8u", impl.name, static_cast<unsigned int>(size));
+				for (size_t offset : offsets) {
+					if (bits == 32 && offset % 4 != 0) {
+						fprintf(stderr, " %8s", "-");
+						continue;
+					}
+
+					uint8_t *const ptr = &buf[offset];
+					const size_t iterations = THROUGHPUT_BYTES / size;
+					const auto start = std::chrono::steady_clock::now();
+					if (bits == 16) {
+						for (size_t i = iterations; i > 0; i--) {
+							impl.fn16(reinterpret_cast<uint16_t*>(ptr), size);
+						}
+					} else {
+						for (size_t i = iterations; i > 0; i--) {
+							impl.fn32(reinterpret_cast<uint32_t*>(ptr), size);
+						}
+					}
+					const auto end = std::chrono::steady_clock::now();
+
+					const double secs = std::chrono::duration<double>(end - start).count();
+					const double mbps = (secs > 0 ? ((double)(iterations * size) / (1024.0 * 1024.0)) / secs : 0);
+					fprintf(stderr, " %8.0f", mbps);
+				}
+				fputc('\n', stderr);
+			}
+		}
+		fputc('\n', stderr);
+	}
+
+	aligned_free(buf);
+}
 
 } }
 
@@ -24,6 +24,8 @@
 # include "librpcpu/cpuflags_x86.h"
 # define IMAGEDECODER_HAS_SSE2 1
 # define IMAGEDECODER_HAS_SSSE3 1
+# define IMAGEDECODER_HAS_SSE41 1
+# define IMAGEDECODER_HAS_AVX2 1
 #endif
 #ifdef RP_CPU_AMD64
 # define IMAGEDECODER_ALWAYS_HAS_SSE2 1
@@ -174,6 +176,113 @@ rp_image *fromLinearCI8(PixelFormat px_format,
 	const uint8_t *RESTRICT img_buf, int img_siz,
 	const void *RESTRICT pal_buf, int pal_siz);
 
+/** Color index expansion **/
+
+/**
+ * Expand a CI8 image buffer to ARGB32.
+ * Standard version using regular C++ code.
+ * @param dest		[out] ARGB32 destination buffer.
+ * @param dest_stride	[in] Destination stride, in bytes.
+ * @param src		[in] CI8 source buffer.
+ * @param src_stride	[in] Source stride, in bytes.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param palette	[in] Palette. (must have 256 entries)
+ */
+void expandCI8toARGB32_cpp(uint32_t *RESTRICT dest, int dest_stride,
+	const uint8_t *RESTRICT src, int src_stride,
+	int width, int height, const uint32_t *RESTRICT palette);
+
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Expand a CI8 image buffer to ARGB32.
+ * SSSE3-optimized version.
+ *
+ * Images that only use the first 16 palette entries are expanded
+ * with PSHUFB. Other images fall back to table lookups.
+ *
+ * @param dest		[out] ARGB32 destination buffer.
+ * @param dest_stride	[in] Destination stride, in bytes.
+ * @param src		[in] CI8 source buffer.
+ * @param src_stride	[in] Source stride, in bytes.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param palette	[in] Palette. (must have 256 entries)
+ */
+void expandCI8toARGB32_ssse3(uint32_t *RESTRICT dest, int dest_stride,
+	const uint8_t *RESTRICT src, int src_stride,
+	int width, int height, const uint32_t *RESTRICT palette);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Expand a CI8 image buffer to ARGB32.
+ * AVX2-optimized version.
+ *
+ * Runs of 32 pixels that only use the first 16 palette entries
+ * are expanded with VPSHUFB. Other pixels use VPGATHERDD.
+ *
+ * @param dest		[out] ARGB32 destination buffer.
+ * @param dest_stride	[in] Destination stride, in bytes.
+ * @param src		[in] CI8 source buffer.
+ * @param src_stride	[in] Source stride, in bytes.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param palette	[in] Palette. (must have 256 entries)
+ */
+void expandCI8toARGB32_avx2(uint32_t *RESTRICT dest, int dest_stride,
+	const uint8_t *RESTRICT src, int src_stride,
+	int width, int height, const uint32_t *RESTRICT palette);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+/**
+ * Expand a CI8 image buffer to ARGB32.
+ * @param dest		[out] ARGB32 destination buffer.
+ * @param dest_stride	[in] Destination stride, in bytes.
+ * @param src		[in] CI8 source buffer.
+ * @param src_stride	[in] Source stride, in bytes.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param palette	[in] Palette. (must have 256 entries)
+ */
+IFUNC_STATIC_INLINE void expandCI8toARGB32(uint32_t *RESTRICT dest, int dest_stride,
+	const uint8_t *RESTRICT src, int src_stride,
+	int width, int height, const uint32_t *RESTRICT palette);
+#else
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Expand a CI8 image buffer to ARGB32.
+ * @param dest		[out] ARGB32 destination buffer.
+ * @param dest_stride	[in] Destination stride, in bytes.
+ * @param src		[in] CI8 source buffer.
+ * @param src_stride	[in] Source stride, in bytes.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param palette	[in] Palette. (must have 256 entries)
+ */
+static inline void expandCI8toARGB32(uint32_t *RESTRICT dest, int dest_stride,
+	const uint8_t *RESTRICT src, int src_stride,
+	int width, int height, const uint32_t *RESTRICT palette)
+{
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		expandCI8toARGB32_avx2(dest, dest_stride, src, src_stride, width, height, palette);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		expandCI8toARGB32_ssse3(dest, dest_stride, src, src_stride, width, height, palette);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		expandCI8toARGB32_cpp(dest, dest_stride, src, src_stride, width, height, palette);
+	}
+}
+#endif /* !RP_HAS_IFUNC || (!RP_CPU_I386 && !RP_CPU_AMD64) */
+
 /**
  * Convert a linear monochrome image to rp_image.
  * @param width Image width.
@@ -236,31 +345,26 @@ rp_image *fromLinear16_sse2(PixelFormat px_format,
 	const uint16_t *RESTRICT img_buf, int img_siz, int stride = 0);
 #endif /* IMAGEDECODER_HAS_SSE2 */
 
-#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
-
-#  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
-// System does support IFUNC, but it's always guaranteed to have SSE2.
-// Eliminate the IFUNC dispatch on this system.
-
+#ifdef IMAGEDECODER_HAS_AVX2
 /**
  * Convert a linear 16-bit RGB image to rp_image.
+ * AVX2-optimized version.
  * @param px_format	[in] 16-bit pixel format.
  * @param width		[in] Image width.
  * @param height	[in] Image height.
- * @param img_buf	[in] Image buffer.
- * @param img_siz	[in] Size of image data. [must be >= (w*h)*3]
+ * @param img_buf	[in] 16-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*2]
  * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
  * @return rp_image, or nullptr on error.
  */
-static inline rp_image *fromLinear16(PixelFormat px_format,
+rp_image *fromLinear16_avx2(PixelFormat px_format,
 	int width, int height,
-	const uint16_t *img_buf, int img_siz, int stride = 0)
-{
-	// amd64 always has SSE2.
-	return fromLinear16_sse2(px_format, width, height, img_buf, img_siz, stride);
-}
-#  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
-// System supports IFUNC and is not guaranteed to always have SSE2.
+	const uint16_t *RESTRICT img_buf, int img_siz, int stride = 0);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+// NOTE: amd64 always has SSE2, but IFUNC dispatch is
+// still needed in order to check for AVX2.
 
 /**
  * Convert a linear 16-bit RGB image to rp_image.
@@ -272,10 +376,9 @@ static inline rp_image *fromLinear16(PixelFormat px_format,
  * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
  * @return rp_image, or nullptr on error.
  */
-IFUNC_SSE2_STATIC_INLINE rp_image *fromLinear16(PixelFormat px_format,
+IFUNC_STATIC_INLINE rp_image *fromLinear16(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *RESTRICT img_buf, int img_siz, int stride = 0);
-#  endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
 
 #else /* !RP_HAS_IFUNC or not i386/amd64 */
 // System does not support IFUNC, or we aren't guaranteed to have
@@ -287,7 +390,7 @@ IFUNC_SSE2_STATIC_INLINE rp_image *fromLinear16(PixelFormat px_format,
  * @param width		[in] Image width.
  * @param height	[in] Image height.
  * @param img_buf	[in] Image buffer.
- * @param img_siz	[in] Size of image data. [must be >= (w*h)*3]
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*2]
  * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
  * @return rp_image, or nullptr on error.
  */
@@ -295,9 +398,16 @@ static inline rp_image *fromLinear16(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *RESTRICT img_buf, int img_siz, int stride = 0)
 {
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return fromLinear16_avx2(px_format, width, height, img_buf, img_siz, stride);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
 #  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
-	// amd64 always has SSE2.
-	return fromLinear16_sse2(px_format, width, height, img_buf, img_siz, stride);
+	{
+		// amd64 always has SSE2.
+		return fromLinear16_sse2(px_format, width, height, img_buf, img_siz, stride);
+	}
 #  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
 #    ifdef IMAGEDECODER_HAS_SSE2
 	if (RP_CPU_HasSSE2()) {
@@ -348,6 +458,24 @@ rp_image *fromLinear24_ssse3(PixelFormat px_format,
 	const uint8_t *RESTRICT img_buf, int img_siz, int stride = 0);
 #endif /* IMAGEDECODER_HAS_SSSE3 */
 
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Convert a linear 24-bit RGB image to rp_image.
+ * AVX2-optimized version.
+ * @param px_format	[in] 24-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] Image buffer. (must be byte-addressable)
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*3]
+ * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 4, 5)
+rp_image *fromLinear24_avx2(PixelFormat px_format,
+	int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz, int stride = 0);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
 #if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
 /**
  * Convert a linear 24-bit RGB image to rp_image.
@@ -382,6 +510,11 @@ static inline rp_image *fromLinear24(PixelFormat px_format,
 	int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz, int stride = 0)
 {
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return fromLinear24_avx2(px_format, width, height, img_buf, img_siz, stride);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
 #  ifdef IMAGEDECODER_HAS_SSSE3
 	if (RP_CPU_HasSSSE3()) {
 		return fromLinear24_ssse3(px_format, width, height, img_buf, img_siz, stride);
@@ -427,6 +560,23 @@ rp_image *fromLinear32_ssse3(PixelFormat px_format,
 	const uint32_t *RESTRICT img_buf, int img_siz, int stride = 0);
 #endif /* IMAGEDECODER_HAS_SSSE3 */
 
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Convert a linear 32-bit RGB image to rp_image.
+ * AVX2-optimized version.
+ * @param px_format	[in] 32-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] 32-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*4]
+ * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromLinear32_avx2(PixelFormat px_format,
+	int width, int height,
+	const uint32_t *RESTRICT img_buf, int img_siz, int stride = 0);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
 #if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
 /**
  * Convert a linear 32-bit RGB image to rp_image.
@@ -459,6 +609,11 @@ static inline rp_image *fromLinear32(PixelFormat px_format,
 	int width, int height,
 	const uint32_t *RESTRICT img_buf, int img_siz, int stride = 0)
 {
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return fromLinear32_avx2(px_format, width, height, img_buf, img_siz, stride);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
 #  ifdef IMAGEDECODER_HAS_SSSE3
 	if (RP_CPU_HasSSSE3()) {
 		return fromLinear32_ssse3(px_format, width, height, img_buf, img_siz, stride);
@@ -472,6 +627,53 @@ static inline rp_image *fromLinear32(PixelFormat px_format,
 
 /** GameCube **/
 
+/**
+ * Convert a GameCube 16-bit image to rp_image.
+ * Standard version using regular C++ code.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB5A3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromGcn16_cpp(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz);
+
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Convert a GameCube 16-bit image to rp_image.
+ * SSSE3-optimized version.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB5A3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromGcn16_ssse3(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Convert a GameCube 16-bit image to rp_image.
+ * AVX2-optimized version.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB5A3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromGcn16_avx2(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
 /**
  * Convert a GameCube 16-bit image to rp_image.
  * @param px_format 16-bit pixel format.
@@ -481,9 +683,41 @@ static inline rp_image *fromLinear32(PixelFormat px_format,
  * @param img_siz Size of image data. [must be >= (w*h)*2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromGcn16(PixelFormat px_format,
+IFUNC_STATIC_INLINE rp_image *fromGcn16(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *RESTRICT img_buf, int img_siz);
+#else
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Convert a GameCube 16-bit image to rp_image.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB5A3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+static inline rp_image *fromGcn16(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return fromGcn16_avx2(px_format, width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromGcn16_ssse3(px_format, width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromGcn16_cpp(px_format, width, height, img_buf, img_siz);
+	}
+}
+#endif /* !RP_HAS_IFUNC || (!RP_CPU_I386 && !RP_CPU_AMD64) */
 
 /**
  * Convert a GameCube CI8 image to rp_image.
@@ -533,85 +767,265 @@ rp_image *fromNDS_CI4(int width, int height,
 
 /**
  * Convert a Nintendo 3DS RGB565 tiled icon to rp_image.
+ * Standard version using regular C++ code.
  * @param width Image width.
  * @param height Image height.
  * @param img_buf RGB565 tiled image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)*2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromN3DSTiledRGB565(int width, int height,
+rp_image *fromN3DSTiledRGB565_cpp(int width, int height,
 	const uint16_t *RESTRICT img_buf, int img_siz);
 
+#ifdef IMAGEDECODER_HAS_SSE2
 /**
- * Convert a Nintendo 3DS RGB565+A4 tiled icon to rp_image.
+ * Convert a Nintendo 3DS RGB565 tiled icon to rp_image.
+ * SSE2-optimized version.
  * @param width Image width.
  * @param height Image height.
  * @param img_buf RGB565 tiled image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)*2]
- * @param alpha_buf A4 tiled alpha buffer.
- * @param alpha_siz Size of alpha data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-ATTR_ACCESS_SIZE(read_only, 5, 6)
-rp_image *fromN3DSTiledRGB565_A4(int width, int height,
-	const uint16_t *RESTRICT img_buf, int img_siz,
-	const uint8_t *RESTRICT alpha_buf, int alpha_siz);
+rp_image *fromN3DSTiledRGB565_sse2(int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSE2 */
 
-/* S3TC */
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+
+#  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
+// System does support IFUNC, but it's always guaranteed to have SSE2.
+// Eliminate the IFUNC dispatch on this system.
 
 /**
- * Convert a GameCube DXT1 image to rp_image.
- * The GameCube variant has 2x2 block tiling in addition to 4x4 pixel tiling.
- * S3TC palette index 3 will be interpreted as fully transparent.
- *
+ * Convert a Nintendo 3DS RGB565 tiled icon to rp_image.
  * @param width Image width.
  * @param height Image height.
- * @param img_buf DXT1 image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @param img_buf RGB565 tiled image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
  * @return rp_image, or nullptr on error.
  */
-ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromDXT1_GCN(int width, int height,
-	const uint8_t *RESTRICT img_buf, int img_siz);
+static inline rp_image *fromN3DSTiledRGB565(int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+	// amd64 always has SSE2.
+	return fromN3DSTiledRGB565_sse2(width, height, img_buf, img_siz);
+}
+#  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
+// System supports IFUNC and is not guaranteed to always have SSE2.
 
 /**
- * Convert a DXT1 image to rp_image.
- * S3TC palette index 3 will be interpreted as black.
- *
+ * Convert a Nintendo 3DS RGB565 tiled icon to rp_image.
  * @param width Image width.
  * @param height Image height.
- * @param img_buf DXT1 image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @param img_buf RGB565 tiled image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
  * @return rp_image, or nullptr on error.
  */
-ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromDXT1(int width, int height,
-	const uint8_t *RESTRICT img_buf, int img_siz);
+IFUNC_SSE2_STATIC_INLINE rp_image *fromN3DSTiledRGB565(int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz);
+#  endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+
+#else /* !RP_HAS_IFUNC or not i386/amd64 */
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
 
 /**
- * Convert a DXT1 image to rp_image.
- * S3TC palette index 3 will be interpreted as fully transparent.
- *
+ * Convert a Nintendo 3DS RGB565 tiled icon to rp_image.
  * @param width Image width.
  * @param height Image height.
- * @param img_buf DXT1 image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @param img_buf RGB565 tiled image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
  * @return rp_image, or nullptr on error.
  */
-ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromDXT1_A1(int width, int height,
-	const uint8_t *RESTRICT img_buf, int img_siz);
+static inline rp_image *fromN3DSTiledRGB565(int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
+	// amd64 always has SSE2.
+	return fromN3DSTiledRGB565_sse2(width, height, img_buf, img_siz);
+#  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
+#    ifdef IMAGEDECODER_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return fromN3DSTiledRGB565_sse2(width, height, img_buf, img_siz);
+	} else
+#    endif /* IMAGEDECODER_HAS_SSE2 */
+	{
+		return fromN3DSTiledRGB565_cpp(width, height, img_buf, img_siz);
+	}
+#  endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+}
+
+#endif /* RP_HAS_IFUNC */
 
 /**
- * Convert a DXT2 image to rp_image.
+ * Convert a Nintendo 3DS RGB565+A4 tiled icon to rp_image.
+ * Standard version using regular C++ code.
  * @param width Image width.
  * @param height Image height.
- * @param img_buf DXT2 image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)]
+ * @param img_buf RGB565 tiled image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param alpha_buf A4 tiled alpha buffer.
+ * @param alpha_siz Size of alpha data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromDXT2(int width, int height,
+ATTR_ACCESS_SIZE(read_only, 5, 6)
+rp_image *fromN3DSTiledRGB565_A4_cpp(int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz,
+	const uint8_t *RESTRICT alpha_buf, int alpha_siz);
+
+#ifdef IMAGEDECODER_HAS_SSE2
+/**
+ * Convert a Nintendo 3DS RGB565+A4 tiled icon to rp_image.
+ * SSE2-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB565 tiled image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param alpha_buf A4 tiled alpha buffer.
+ * @param alpha_siz Size of alpha data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 5, 6)
+rp_image *fromN3DSTiledRGB565_A4_sse2(int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz,
+	const uint8_t *RESTRICT alpha_buf, int alpha_siz);
+#endif /* IMAGEDECODER_HAS_SSE2 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+
+#  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
+// System does support IFUNC, but it's always guaranteed to have SSE2.
+// Eliminate the IFUNC dispatch on this system.
+
+/**
+ * Convert a Nintendo 3DS RGB565+A4 tiled icon to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB565 tiled image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param alpha_buf A4 tiled alpha buffer.
+ * @param alpha_siz Size of alpha data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 5, 6)
+static inline rp_image *fromN3DSTiledRGB565_A4(int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz,
+	const uint8_t *RESTRICT alpha_buf, int alpha_siz)
+{
+	// amd64 always has SSE2.
+	return fromN3DSTiledRGB565_A4_sse2(width, height, img_buf, img_siz, alpha_buf, alpha_siz);
+}
+#  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
+// System supports IFUNC and is not guaranteed to always have SSE2.
+
+/**
+ * Convert a Nintendo 3DS RGB565+A4 tiled icon to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB565 tiled image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param alpha_buf A4 tiled alpha buffer.
+ * @param alpha_siz Size of alpha data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 5, 6)
+IFUNC_SSE2_STATIC_INLINE rp_image *fromN3DSTiledRGB565_A4(int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz,
+	const uint8_t *RESTRICT alpha_buf, int alpha_siz);
+#  endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+
+#else /* !RP_HAS_IFUNC or not i386/amd64 */
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Convert a Nintendo 3DS RGB565+A4 tiled icon to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB565 tiled image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param alpha_buf A4 tiled alpha buffer.
+ * @param alpha_siz Size of alpha data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 5, 6)
+static inline rp_image *fromN3DSTiledRGB565_A4(int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz,
+	const uint8_t *RESTRICT alpha_buf, int alpha_siz)
+{
+#  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
+	// amd64 always has SSE2.
+	return fromN3DSTiledRGB565_A4_sse2(width, height, img_buf, img_siz, alpha_buf, alpha_siz);
+#  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
+#    ifdef IMAGEDECODER_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return fromN3DSTiledRGB565_A4_sse2(width, height, img_buf, img_siz, alpha_buf, alpha_siz);
+	} else
+#    endif /* IMAGEDECODER_HAS_SSE2 */
+	{
+		return fromN3DSTiledRGB565_A4_cpp(width, height, img_buf, img_siz, alpha_buf, alpha_siz);
+	}
+#  endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+}
+
+#endif /* RP_HAS_IFUNC */
+
+/* S3TC */
+
+/**
+ * Convert a GameCube DXT1 image to rp_image.
+ * The GameCube variant has 2x2 block tiling in addition to 4x4 pixel tiling.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT1_GCN(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as black.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT1_A1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a DXT2 image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT2 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT2(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
 
 /**
@@ -696,6 +1110,61 @@ int fromRed8ToL8(rp_image *img);
 
 /* Dreamcast */
 
+/**
+ * Convert a Dreamcast square twiddled 16-bit image to rp_image.
+ * Standard version using regular C++ code.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf 16-bit image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDreamcastSquareTwiddled16_cpp(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz);
+
+#ifdef IMAGEDECODER_HAS_SSE2
+/**
+ * Convert a Dreamcast square twiddled 16-bit image to rp_image.
+ * SSE2-optimized version.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf 16-bit image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDreamcastSquareTwiddled16_sse2(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSE2 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+
+#  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
+// System does support IFUNC, but it's always guaranteed to have SSE2.
+// Eliminate the IFUNC dispatch on this system.
+
+/**
+ * Convert a Dreamcast square twiddled 16-bit image to rp_image.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf 16-bit image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+static inline rp_image *fromDreamcastSquareTwiddled16(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+	// amd64 always has SSE2.
+	return fromDreamcastSquareTwiddled16_sse2(px_format, width, height, img_buf, img_siz);
+}
+#  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
+// System supports IFUNC and is not guaranteed to always have SSE2.
+
 /**
  * Convert a Dreamcast square twiddled 16-bit image to rp_image.
  * @param px_format 16-bit pixel format.
@@ -705,12 +1174,48 @@ int fromRed8ToL8(rp_image *img);
  * @param img_siz Size of image data. [must be >= (w*h)*2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromDreamcastSquareTwiddled16(PixelFormat px_format,
+IFUNC_SSE2_STATIC_INLINE rp_image *fromDreamcastSquareTwiddled16(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *RESTRICT img_buf, int img_siz);
+#  endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+
+#else /* !RP_HAS_IFUNC or not i386/amd64 */
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Convert a Dreamcast square twiddled 16-bit image to rp_image.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf 16-bit image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+static inline rp_image *fromDreamcastSquareTwiddled16(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
+	// amd64 always has SSE2.
+	return fromDreamcastSquareTwiddled16_sse2(px_format, width, height, img_buf, img_siz);
+#  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
+#    ifdef IMAGEDECODER_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return fromDreamcastSquareTwiddled16_sse2(px_format, width, height, img_buf, img_siz);
+	} else
+#    endif /* IMAGEDECODER_HAS_SSE2 */
+	{
+		return fromDreamcastSquareTwiddled16_cpp(px_format, width, height, img_buf, img_siz);
+	}
+#  endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+}
+
+#endif /* RP_HAS_IFUNC */
 
 /**
  * Convert a Dreamcast vector-quantized image to rp_image.
+ * Standard version using regular C++ code.
  * @param px_format Palette pixel format.
  * @param smallVQ If true, handle this image as SmallVQ.
  * @param hasMipmaps If true, the image has mipmaps. (Needed for SmallVQ.)
@@ -723,12 +1228,133 @@ rp_image *fromDreamcastSquareTwiddled16(PixelFormat px_format,
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 6, 7)
-rp_image *fromDreamcastVQ16(PixelFormat px_format,
+rp_image *fromDreamcastVQ16_cpp(PixelFormat px_format,
 	bool smallVQ, bool hasMipmaps,
 	int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz,
 	const uint16_t *RESTRICT pal_buf, int pal_siz);
 
+#ifdef IMAGEDECODER_HAS_SSE2
+/**
+ * Convert a Dreamcast vector-quantized image to rp_image.
+ * SSE2-optimized version.
+ * @param px_format Palette pixel format.
+ * @param smallVQ If true, handle this image as SmallVQ.
+ * @param hasMipmaps If true, the image has mipmaps. (Needed for SmallVQ.)
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf VQ image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param pal_buf Palette buffer.
+ * @param pal_siz Size of palette data. [must be >= 1024*2; for SmallVQ, 64*2, 256*2, or 512*2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 6, 7)
+rp_image *fromDreamcastVQ16_sse2(PixelFormat px_format,
+	bool smallVQ, bool hasMipmaps,
+	int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	const uint16_t *RESTRICT pal_buf, int pal_siz);
+#endif /* IMAGEDECODER_HAS_SSE2 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+
+#  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
+// System does support IFUNC, but it's always guaranteed to have SSE2.
+// Eliminate the IFUNC dispatch on this system.
+
+/**
+ * Convert a Dreamcast vector-quantized image to rp_image.
+ * @param px_format Palette pixel format.
+ * @param smallVQ If true, handle this image as SmallVQ.
+ * @param hasMipmaps If true, the image has mipmaps. (Needed for SmallVQ.)
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf VQ image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param pal_buf Palette buffer.
+ * @param pal_siz Size of palette data. [must be >= 1024*2; for SmallVQ, 64*2, 256*2, or 512*2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 6, 7)
+static inline rp_image *fromDreamcastVQ16(PixelFormat px_format,
+	bool smallVQ, bool hasMipmaps,
+	int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	const uint16_t *RESTRICT pal_buf, int pal_siz)
+{
+	// amd64 always has SSE2.
+	return fromDreamcastVQ16_sse2(px_format, smallVQ, hasMipmaps,
+		width, height, img_buf, img_siz, pal_buf, pal_siz);
+}
+#  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
+// System supports IFUNC and is not guaranteed to always have SSE2.
+
+/**
+ * Convert a Dreamcast vector-quantized image to rp_image.
+ * @param px_format Palette pixel format.
+ * @param smallVQ If true, handle this image as SmallVQ.
+ * @param hasMipmaps If true, the image has mipmaps. (Needed for SmallVQ.)
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf VQ image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param pal_buf Palette buffer.
+ * @param pal_siz Size of palette data. [must be >= 1024*2; for SmallVQ, 64*2, 256*2, or 512*2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 6, 7)
+IFUNC_SSE2_STATIC_INLINE rp_image *fromDreamcastVQ16(PixelFormat px_format,
+	bool smallVQ, bool hasMipmaps,
+	int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	const uint16_t *RESTRICT pal_buf, int pal_siz);
+#  endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+
+#else /* !RP_HAS_IFUNC or not i386/amd64 */
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Convert a Dreamcast vector-quantized image to rp_image.
+ * @param px_format Palette pixel format.
+ * @param smallVQ If true, handle this image as SmallVQ.
+ * @param hasMipmaps If true, the image has mipmaps. (Needed for SmallVQ.)
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf VQ image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param pal_buf Palette buffer.
+ * @param pal_siz Size of palette data. [must be >= 1024*2; for SmallVQ, 64*2, 256*2, or 512*2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 6, 7)
+static inline rp_image *fromDreamcastVQ16(PixelFormat px_format,
+	bool smallVQ, bool hasMipmaps,
+	int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	const uint16_t *RESTRICT pal_buf, int pal_siz)
+{
+#  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
+	// amd64 always has SSE2.
+	return fromDreamcastVQ16_sse2(px_format, smallVQ, hasMipmaps,
+		width, height, img_buf, img_siz, pal_buf, pal_siz);
+#  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
+#    ifdef IMAGEDECODER_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return fromDreamcastVQ16_sse2(px_format, smallVQ, hasMipmaps,
+		width, height, img_buf, img_siz, pal_buf, pal_siz);
+	} else
+#    endif /* IMAGEDECODER_HAS_SSE2 */
+	{
+		return fromDreamcastVQ16_cpp(px_format, smallVQ, hasMipmaps,
+		width, height, img_buf, img_siz, pal_buf, pal_siz);
+	}
+#  endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+}
+
+#endif /* RP_HAS_IFUNC */
+
 /**
  * Get the number of palette entries for Dreamcast SmallVQ textures.
  * This version is for textures without mipmaps.
@@ -832,14 +1458,162 @@ enum PVRTC_Mode_e {
 	PVRTC_ALPHA_NONE	= (0U << 1),
 	PVRTC_ALPHA_YES		= (1U << 1),
 	PVRTC_ALPHA_MASK	= (1U << 1),
+
+	// Format (used by the row decoders)
+	PVRTC_TYPE_I		= (0U << 2),
+	PVRTC_TYPE_II		= (1U << 2),
+	PVRTC_TYPE_MASK		= (1U << 2),
 };
 
+/**
+ * Calculate the size of a PVRTC or PVRTC-II image's data.
+ * The image is padded to whole words, and PVRTC textures
+ * are always at least 2x2 words, so small textures
+ * (e.g. mipmaps) are larger than (w*h)/4 or (w*h)/2.
+ * @param width Image width.
+ * @param height Image height.
+ * @param mode Mode bitfield. (See PVRTC_Mode_e; only the bpp is used.)
+ * @return Size of the image data, in bytes.
+ */
+static inline unsigned int calcPVRTCImageSize(int width, int height, uint8_t mode)
+{
+	// 2bpp words are 8x4 pixels; 4bpp words are 4x4 pixels.
+	// Each word is 64 bits.
+	const bool is2bpp = ((mode & PVRTC_BPP_MASK) == PVRTC_2BPP);
+	unsigned int xWords = (is2bpp ? ((width + 7) / 8) : ((width + 3) / 4));
+	unsigned int yWords = (height + 3) / 4;
+	if (xWords < 2) {
+		xWords = 2;
+	}
+	if (yWords < 2) {
+		yWords = 2;
+	}
+	return xWords * yWords * 8;
+}
+
+// PVRTC modulation weight for punch-through alpha.
+// Color is blended using a weight of 4. PVRTC-I sets
+// alpha to 0; PVRTC-II sets the entire pixel to 0.
+#define PVRTC_MOD_PUNCHTHROUGH 9
+
+/**
+ * Decode a single pixel row of a PVRTC or PVRTC-II image.
+ * Standard version using regular C++ code.
+ *
+ * Each word has eight int16_t color components:
+ * Color A {B,G,R,A}, followed by Color B {B,G,R,A}.
+ * RGB components are 5-bit; alpha components are 4-bit.
+ *
+ * @param dest		[out] ARGB32 destination row.
+ * @param width		[in] Image width. (must be a multiple of the word width)
+ * @param colorsP	[in] Word colors for the word row above this pixel row.
+ * @param colorsR	[in] Word colors for the word row below this pixel row.
+ * @param j		[in] Vertical distance from the word centers in colorsP. (0-3)
+ * @param mod		[in] Modulation weights. (0-8, or PVRTC_MOD_PUNCHTHROUGH)
+ * @param mode		[in] Mode bitfield. (See PVRTC_Mode_e.)
+ */
+void decodePVRTCRow_cpp(uint32_t *RESTRICT dest, int width,
+	const int16_t *RESTRICT colorsP, const int16_t *RESTRICT colorsR, int j,
+	const uint8_t *RESTRICT mod, uint8_t mode);
+
+#ifdef IMAGEDECODER_HAS_SSE41
+/**
+ * Decode a single pixel row of a PVRTC or PVRTC-II image.
+ * SSE4.1-optimized version.
+ *
+ * Each word has eight int16_t color components:
+ * Color A {B,G,R,A}, followed by Color B {B,G,R,A}.
+ * RGB components are 5-bit; alpha components are 4-bit.
+ *
+ * @param dest		[out] ARGB32 destination row.
+ * @param width		[in] Image width. (must be a multiple of the word width)
+ * @param colorsP	[in] Word colors for the word row above this pixel row.
+ * @param colorsR	[in] Word colors for the word row below this pixel row.
+ * @param j		[in] Vertical distance from the word centers in colorsP. (0-3)
+ * @param mod		[in] Modulation weights. (0-8, or PVRTC_MOD_PUNCHTHROUGH)
+ * @param mode		[in] Mode bitfield. (See PVRTC_Mode_e.)
+ */
+void decodePVRTCRow_sse41(uint32_t *RESTRICT dest, int width,
+	const int16_t *RESTRICT colorsP, const int16_t *RESTRICT colorsR, int j,
+	const uint8_t *RESTRICT mod, uint8_t mode);
+#endif /* IMAGEDECODER_HAS_SSE41 */
+
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Decode a single pixel row of a PVRTC or PVRTC-II image.
+ * AVX2-optimized version.
+ *
+ * Each word has eight int16_t color components:
+ * Color A {B,G,R,A}, followed by Color B {B,G,R,A}.
+ * RGB components are 5-bit; alpha components are 4-bit.
+ *
+ * @param dest		[out] ARGB32 destination row.
+ * @param width		[in] Image width. (must be a multiple of the word width)
+ * @param colorsP	[in] Word colors for the word row above this pixel row.
+ * @param colorsR	[in] Word colors for the word row below this pixel row.
+ * @param j		[in] Vertical distance from the word centers in colorsP. (0-3)
+ * @param mod		[in] Modulation weights. (0-8, or PVRTC_MOD_PUNCHTHROUGH)
+ * @param mode		[in] Mode bitfield. (See PVRTC_Mode_e.)
+ */
+void decodePVRTCRow_avx2(uint32_t *RESTRICT dest, int width,
+	const int16_t *RESTRICT colorsP, const int16_t *RESTRICT colorsR, int j,
+	const uint8_t *RESTRICT mod, uint8_t mode);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+/**
+ * Decode a single pixel row of a PVRTC or PVRTC-II image.
+ * @param dest		[out] ARGB32 destination row.
+ * @param width		[in] Image width. (must be a multiple of the word width)
+ * @param colorsP	[in] Word colors for the word row above this pixel row.
+ * @param colorsR	[in] Word colors for the word row below this pixel row.
+ * @param j		[in] Vertical distance from the word centers in colorsP. (0-3)
+ * @param mod		[in] Modulation weights. (0-8, or PVRTC_MOD_PUNCHTHROUGH)
+ * @param mode		[in] Mode bitfield. (See PVRTC_Mode_e.)
+ */
+IFUNC_STATIC_INLINE void decodePVRTCRow(uint32_t *RESTRICT dest, int width,
+	const int16_t *RESTRICT colorsP, const int16_t *RESTRICT colorsR, int j,
+	const uint8_t *RESTRICT mod, uint8_t mode);
+#else
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Decode a single pixel row of a PVRTC or PVRTC-II image.
+ * @param dest		[out] ARGB32 destination row.
+ * @param width		[in] Image width. (must be a multiple of the word width)
+ * @param colorsP	[in] Word colors for the word row above this pixel row.
+ * @param colorsR	[in] Word colors for the word row below this pixel row.
+ * @param j		[in] Vertical distance from the word centers in colorsP. (0-3)
+ * @param mod		[in] Modulation weights. (0-8, or PVRTC_MOD_PUNCHTHROUGH)
+ * @param mode		[in] Mode bitfield. (See PVRTC_Mode_e.)
+ */
+static inline void decodePVRTCRow(uint32_t *RESTRICT dest, int width,
+	const int16_t *RESTRICT colorsP, const int16_t *RESTRICT colorsR, int j,
+	const uint8_t *RESTRICT mod, uint8_t mode)
+{
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		decodePVRTCRow_avx2(dest, width, colorsP, colorsR, j, mod, mode);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
+#  ifdef IMAGEDECODER_HAS_SSE41
+	if (RP_CPU_HasSSE41()) {
+		decodePVRTCRow_sse41(dest, width, colorsP, colorsR, j, mod, mode);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSE41 */
+	{
+		decodePVRTCRow_cpp(dest, width, colorsP, colorsR, j, mod, mode);
+	}
+}
+#endif /* !RP_HAS_IFUNC || (!RP_CPU_I386 && !RP_CPU_AMD64) */
+
 /**
  * Convert a PVRTC 2bpp or 4bpp image to rp_image.
  * @param width Image width.
  * @param height Image height.
  * @param img_buf PVRTC image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)/4]
+ * @param img_siz Size of image data. [must be >= calcPVRTCImageSize()]
  * @param mode Mode bitfield. (See PVRTC_Mode_e.)
  * @return rp_image, or nullptr on error.
  */
@@ -853,7 +1627,7 @@ rp_image *fromPVRTC(int width, int height,
  * @param width Image width.
  * @param height Image height.
  * @param img_buf PVRTC image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)/4]
+ * @param img_siz Size of image data. [must be >= calcPVRTCImageSize()]
  * @param mode Mode bitfield. (See PVRTC_Mode_e.)
  * @return rp_image, or nullptr on error.
  */
@@ -61,6 +61,7 @@ static FORCEINLINE void initDreamcastTwiddleMap(void)
 
 /**
  * Convert a Dreamcast square twiddled 16-bit image to rp_image.
+ * Standard version using regular C++ code.
  * @param px_format 16-bit pixel format.
  * @param width Image width. (Maximum is 4096.)
  * @param height Image height. (Must be equal to width.)
@@ -68,7 +69,7 @@ static FORCEINLINE void initDreamcastTwiddleMap(void)
  * @param img_siz Size of image data. [must be >= (w*h)*2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromDreamcastSquareTwiddled16(PixelFormat px_format,
+rp_image *fromDreamcastSquareTwiddled16_cpp(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *RESTRICT img_buf, int img_siz)
 {
@@ -158,6 +159,7 @@ rp_image *fromDreamcastSquareTwiddled16(PixelFormat px_format,
 
 /**
  * Convert a Dreamcast vector-quantized image to rp_image.
+ * Standard version using regular C++ code.
  * @param px_format Palette pixel format.
  * @param smallVQ If true, handle this image as SmallVQ.
  * @param hasMipmaps If true, the image has mipmaps. (Needed for SmallVQ.)
@@ -169,7 +171,7 @@ rp_image *fromDreamcastSquareTwiddled16(PixelFormat px_format,
  * @param pal_siz Size of palette data. [must be >= 1024*2; for SmallVQ, 64*2, 256*2, or 512*2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromDreamcastVQ16(PixelFormat px_format,
+rp_image *fromDreamcastVQ16_cpp(PixelFormat px_format,
 	bool smallVQ, bool hasMipmaps,
 	int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz,
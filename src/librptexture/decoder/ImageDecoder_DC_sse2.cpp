@@ -0,0 +1,405 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_DC.cpp: Image decoding functions. (Dreamcast)              *
+ * SSE2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+// SSE2 intrinsics.
+#include <emmintrin.h>
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Extract the even bits of a Morton-order (twiddled) index.
+ * Bit 2n of the index becomes bit n of the result.
+ * @param v Twiddled index.
+ * @return Even bits, compacted.
+ */
+static inline unsigned int morton_compact(unsigned int v)
+{
+	v &= 0x55555555U;
+	v = (v | (v >> 1)) & 0x33333333U;
+	v = (v | (v >> 2)) & 0x0F0F0F0FU;
+	v = (v | (v >> 4)) & 0x00FF00FFU;
+	v = (v | (v >> 8)) & 0x0000FFFFU;
+	return v;
+}
+
+/**
+ * Convert 8 Dreamcast 16-bit pixels to ARGB32.
+ * @tparam px_format 16-bit pixel format.
+ * @param px16	[in] 16-bit pixels.
+ * @param pLo	[out] ARGB32 pixels 0-3.
+ * @param pHi	[out] ARGB32 pixels 4-7.
+ */
+template<PixelFormat px_format>
+static FORCEINLINE void T_DC16_to_ARGB32_sse2(__m128i px16, __m128i *pLo, __m128i *pHi)
+{
+	const __m128i Mask4 = _mm_set1_epi16(0x0F);
+	const __m128i Mask5 = _mm_set1_epi16(0x1F);
+	const __m128i MaskFF = _mm_set1_epi16(0xFF);
+	__m128i sR, sG, sB, sA;
+
+	switch (px_format) {
+		case PXF_ARGB1555:
+			// ARGB1555: ARRRRRGG GGGBBBBB
+			sR = _mm_and_si128(_mm_srli_epi16(px16, 10), Mask5);
+			sG = _mm_and_si128(_mm_srli_epi16(px16, 5), Mask5);
+			sB = _mm_and_si128(px16, Mask5);
+			sR = _mm_or_si128(_mm_slli_epi16(sR, 3), _mm_srli_epi16(sR, 2));
+			sG = _mm_or_si128(_mm_slli_epi16(sG, 3), _mm_srli_epi16(sG, 2));
+			sB = _mm_or_si128(_mm_slli_epi16(sB, 3), _mm_srli_epi16(sB, 2));
+			sA = _mm_and_si128(_mm_srai_epi16(px16, 15), MaskFF);
+			break;
+
+		case PXF_RGB565: {
+			// RGB565: RRRRRGGG GGGBBBBB
+			const __m128i Mask6 = _mm_set1_epi16(0x3F);
+			sR = _mm_srli_epi16(px16, 11);
+			sG = _mm_and_si128(_mm_srli_epi16(px16, 5), Mask6);
+			sB = _mm_and_si128(px16, Mask5);
+			sR = _mm_or_si128(_mm_slli_epi16(sR, 3), _mm_srli_epi16(sR, 2));
+			sG = _mm_or_si128(_mm_slli_epi16(sG, 2), _mm_srli_epi16(sG, 4));
+			sB = _mm_or_si128(_mm_slli_epi16(sB, 3), _mm_srli_epi16(sB, 2));
+			sA = MaskFF;
+			break;
+		}
+
+		case PXF_ARGB4444:
+			// ARGB4444: AAAARRRR GGGGBBBB
+			sA = _mm_srli_epi16(px16, 12);
+			sR = _mm_and_si128(_mm_srli_epi16(px16, 8), Mask4);
+			sG = _mm_and_si128(_mm_srli_epi16(px16, 4), Mask4);
+			sB = _mm_and_si128(px16, Mask4);
+			sA = _mm_or_si128(_mm_slli_epi16(sA, 4), sA);
+			sR = _mm_or_si128(_mm_slli_epi16(sR, 4), sR);
+			sG = _mm_or_si128(_mm_slli_epi16(sG, 4), sG);
+			sB = _mm_or_si128(_mm_slli_epi16(sB, 4), sB);
+			break;
+
+		default:
+			assert(!"Unsupported pixel format.");
+			*pLo = _mm_setzero_si128();
+			*pHi = _mm_setzero_si128();
+			return;
+	}
+
+	// Combine the components into ARGB32.
+	const __m128i sGB = _mm_or_si128(_mm_slli_epi16(sG, 8), sB);
+	const __m128i sAR = _mm_or_si128(_mm_slli_epi16(sA, 8), sR);
+	*pLo = _mm_unpacklo_epi16(sGB, sAR);
+	*pHi = _mm_unpackhi_epi16(sGB, sAR);
+}
+
+/**
+ * Decode a Dreamcast square twiddled 16-bit image one 4x4 block at a time.
+ *
+ * Twiddled images use Morton order, with Y in the even bits and X in
+ * the odd bits. Each 4x4 block is 16 consecutive pixels, and the blocks
+ * are also in Morton order, so the source data is read sequentially.
+ *
+ * @tparam px_format 16-bit pixel format.
+ * @param img		[out] rp_image. (ARGB32; width must be a power of 2)
+ * @param img_buf	[in] 16-bit image buffer.
+ */
+template<PixelFormat px_format>
+static void T_fromDreamcastSquareTwiddled16_sse2(rp_image *RESTRICT img, const uint16_t *RESTRICT img_buf)
+{
+	const int stride_px = img->stride() / sizeof(uint32_t);
+	uint32_t *const bits = static_cast<uint32_t*>(img->bits());
+	const __m128i *xmm_src = reinterpret_cast<const __m128i*>(img_buf);
+
+	const unsigned int blocks_per_row = static_cast<unsigned int>(img->width()) / 4;
+	const unsigned int blocks = blocks_per_row * blocks_per_row;
+	for (unsigned int i = 0; i < blocks; i++, xmm_src += 2) {
+		const unsigned int bx = morton_compact(i >> 1);
+		const unsigned int by = morton_compact(i);
+		uint32_t *row = bits + (by * 4 * stride_px) + (bx * 4);
+
+		// Within a block, row n has pixels [n&1 | (n&2)<<1] + {0, 2, 8, 10}.
+		// Rows 0-1 are in the low qwords; rows 2-3 are in the high qwords.
+		const __m128i a = _mm_loadu_si128(&xmm_src[0]);
+		const __m128i b = _mm_loadu_si128(&xmm_src[1]);
+		__m128i rows01 = _mm_unpacklo_epi64(a, b);	// 0,1,2,3,8,9,10,11
+		__m128i rows23 = _mm_unpackhi_epi64(a, b);	// 4,5,6,7,12,13,14,15
+
+		// Reorder to 0,2,8,10,1,3,9,11.
+		rows01 = _mm_shufflelo_epi16(rows01, _MM_SHUFFLE(3,1,2,0));
+		rows01 = _mm_shufflehi_epi16(rows01, _MM_SHUFFLE(3,1,2,0));
+		rows01 = _mm_shuffle_epi32(rows01, _MM_SHUFFLE(3,1,2,0));
+		rows23 = _mm_shufflelo_epi16(rows23, _MM_SHUFFLE(3,1,2,0));
+		rows23 = _mm_shufflehi_epi16(rows23, _MM_SHUFFLE(3,1,2,0));
+		rows23 = _mm_shuffle_epi32(rows23, _MM_SHUFFLE(3,1,2,0));
+
+		__m128i sLo, sHi;
+		T_DC16_to_ARGB32_sse2<px_format>(rows01, &sLo, &sHi);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(row), sLo);
+		row += stride_px;
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(row), sHi);
+		row += stride_px;
+		T_DC16_to_ARGB32_sse2<px_format>(rows23, &sLo, &sHi);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(row), sLo);
+		row += stride_px;
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(row), sHi);
+	}
+}
+
+/**
+ * Convert a Dreamcast square twiddled 16-bit image to rp_image.
+ * SSE2-optimized version.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf 16-bit image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDreamcastSquareTwiddled16_sse2(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(width == height);
+	assert(width <= 4096);
+	assert(img_siz >= ((width * height) * 2));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    width != height || width > 4096 ||
+	    img_siz < ((width * height) * 2))
+	{
+		return nullptr;
+	}
+
+	if (width < 4 || !isPow2(static_cast<unsigned int>(width))) {
+		// Block decoding requires a power-of-2 width.
+		return fromDreamcastSquareTwiddled16_cpp(px_format, width, height, img_buf, img_siz);
+	}
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	switch (px_format) {
+		case PXF_ARGB1555: {
+			T_fromDreamcastSquareTwiddled16_sse2<PXF_ARGB1555>(img, img_buf);
+			// Set the sBIT metadata.
+			static const rp_image::sBIT_t sBIT = {5,5,5,0,1};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		case PXF_RGB565: {
+			T_fromDreamcastSquareTwiddled16_sse2<PXF_RGB565>(img, img_buf);
+			// Set the sBIT metadata.
+			static const rp_image::sBIT_t sBIT = {5,6,5,0,0};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		case PXF_ARGB4444: {
+			T_fromDreamcastSquareTwiddled16_sse2<PXF_ARGB4444>(img, img_buf);
+			// Set the sBIT metadata.
+			static const rp_image::sBIT_t sBIT = {4,4,4,0,4};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		default:
+			assert(!"Invalid pixel format for this function.");
+			img->unref();
+			return nullptr;
+	}
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert a Dreamcast palette to ARGB32.
+ * @tparam px_format Palette pixel format.
+ * @param palette	[out] ARGB32 palette.
+ * @param pal_buf	[in] 16-bit palette.
+ * @param count		[in] Number of palette entries. (must be a multiple of 8)
+ */
+template<PixelFormat px_format>
+static inline void T_DC16_palette_sse2(uint32_t *RESTRICT palette, const uint16_t *RESTRICT pal_buf, unsigned int count)
+{
+	const __m128i *xmm_src = reinterpret_cast<const __m128i*>(pal_buf);
+	__m128i *xmm_dest = reinterpret_cast<__m128i*>(palette);
+	for (; count > 0; count -= 8, xmm_src++, xmm_dest += 2) {
+		T_DC16_to_ARGB32_sse2<px_format>(_mm_loadu_si128(xmm_src), &xmm_dest[0], &xmm_dest[1]);
+	}
+}
+
+/**
+ * Convert a Dreamcast vector-quantized image to rp_image.
+ * SSE2-optimized version.
+ * @param px_format Palette pixel format.
+ * @param smallVQ If true, handle this image as SmallVQ.
+ * @param hasMipmaps If true, the image has mipmaps. (Needed for SmallVQ.)
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf VQ image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param pal_buf Palette buffer.
+ * @param pal_siz Size of palette data. [must be >= 1024*2; for SmallVQ, 64*2, 256*2, or 512*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDreamcastVQ16_sse2(PixelFormat px_format,
+	bool smallVQ, bool hasMipmaps,
+	int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	const uint16_t *RESTRICT pal_buf, int pal_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(pal_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(width == height);
+	assert(width <= 4096);
+	assert(img_siz > 0);
+	assert(pal_siz > 0);
+	if (!img_buf || !pal_buf || width <= 0 || height <= 0 ||
+	    width != height || width > 4096 ||
+	    img_siz == 0 || pal_siz == 0)
+	{
+		return nullptr;
+	}
+
+	// Each VQ code is a 2x2 block of pixels.
+	const unsigned int codes_per_row = static_cast<unsigned int>(width) / 2;
+	if (width < 4 || !isPow2(static_cast<unsigned int>(width)) ||
+	    static_cast<unsigned int>(img_siz) < codes_per_row * codes_per_row)
+	{
+		// Block decoding requires a power-of-2 width.
+		// The standard version also handles truncated images.
+		return fromDreamcastVQ16_cpp(px_format, smallVQ, hasMipmaps,
+			width, height, img_buf, img_siz, pal_buf, pal_siz);
+	}
+
+	// Determine the number of palette entries.
+	int pal_entry_count;
+	if (smallVQ) {
+		pal_entry_count = (hasMipmaps
+			? calcDreamcastSmallVQPaletteEntries_WithMipmaps(width)
+			: calcDreamcastSmallVQPaletteEntries_NoMipmaps(width));
+	} else {
+		pal_entry_count = 1024;
+	}
+
+	assert(pal_entry_count % 8 == 0);
+	assert(pal_entry_count * 2 >= pal_siz);
+	if ((pal_entry_count % 8 != 0) ||
+	    (pal_entry_count * 2 < pal_siz))
+	{
+		// Palette isn't large enough,
+		// or palette isn't an even multiple.
+		return nullptr;
+	}
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	// Convert the palette.
+	auto palette = aligned_uptr<uint32_t>(16, pal_entry_count);
+	switch (px_format) {
+		case PXF_ARGB1555: {
+			T_DC16_palette_sse2<PXF_ARGB1555>(palette.get(), pal_buf, pal_entry_count);
+			// Set the sBIT metadata.
+			static const rp_image::sBIT_t sBIT = {5,5,5,0,1};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		case PXF_RGB565: {
+			T_DC16_palette_sse2<PXF_RGB565>(palette.get(), pal_buf, pal_entry_count);
+			// Set the sBIT metadata.
+			static const rp_image::sBIT_t sBIT = {5,6,5,0,0};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		case PXF_ARGB4444: {
+			T_DC16_palette_sse2<PXF_ARGB4444>(palette.get(), pal_buf, pal_entry_count);
+			// Set the sBIT metadata.
+			static const rp_image::sBIT_t sBIT = {4,4,4,0,4};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		default:
+			assert(!"Invalid pixel format for this function.");
+			img->unref();
+			return nullptr;
+	}
+
+	// Decode one 4x4 block of pixels at a time.
+	// Each block has four consecutive VQ codes in Morton order:
+	// [0] = top-left, [1] = bottom-left, [2] = top-right, [3] = bottom-right.
+	// Each code's palette entries are also in Morton order.
+	const int stride_px = img->stride() / sizeof(uint32_t);
+	uint32_t *const bits = static_cast<uint32_t*>(img->bits());
+	const unsigned int blocks_per_row = static_cast<unsigned int>(width) / 4;
+	const unsigned int blocks = blocks_per_row * blocks_per_row;
+	const __m128 *const pal128 = reinterpret_cast<const __m128*>(palette.get());
+	for (unsigned int i = 0; i < blocks; i++, img_buf += 4) {
+		const unsigned int bx = morton_compact(i >> 1);
+		const unsigned int by = morton_compact(i);
+		uint32_t *row = bits + (by * 4 * stride_px) + (bx * 4);
+
+		// Palette index.
+		// Each block of 2x2 pixels uses a 4-element block of
+		// the palette, so the code is the index into pal128[].
+		if (smallVQ) {
+			const unsigned int maxIdx = std::max(std::max(img_buf[0], img_buf[1]), std::max(img_buf[2], img_buf[3]));
+			assert(maxIdx * 4 < static_cast<unsigned int>(pal_entry_count));
+			if (maxIdx * 4 >= static_cast<unsigned int>(pal_entry_count)) {
+				// Palette index is out of bounds.
+				// NOTE: This can only happen with SmallVQ,
+				// since VQ always has 1024 palette entries.
+				img->unref();
+				return nullptr;
+			}
+		}
+
+		const __m128 q0 = pal128[img_buf[0]];
+		const __m128 q1 = pal128[img_buf[1]];
+		const __m128 q2 = pal128[img_buf[2]];
+		const __m128 q3 = pal128[img_buf[3]];
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(row),
+			_mm_castps_si128(_mm_shuffle_ps(q0, q2, _MM_SHUFFLE(2,0,2,0))));
+		row += stride_px;
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(row),
+			_mm_castps_si128(_mm_shuffle_ps(q0, q2, _MM_SHUFFLE(3,1,3,1))));
+		row += stride_px;
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(row),
+			_mm_castps_si128(_mm_shuffle_ps(q1, q3, _MM_SHUFFLE(2,0,2,0))));
+		row += stride_px;
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(row),
+			_mm_castps_si128(_mm_shuffle_ps(q1, q3, _MM_SHUFFLE(3,1,3,1))));
+	}
+
+	// Image has been converted.
+	return img;
+}
+
+} }
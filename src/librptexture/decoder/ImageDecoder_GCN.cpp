@@ -17,6 +17,7 @@ namespace LibRpTexture { namespace ImageDecoder {
 
 /**
  * Convert a GameCube 16-bit image to rp_image.
+ * Standard version using regular C++ code.
  * @param px_format 16-bit pixel format.
  * @param width Image width.
  * @param height Image height.
@@ -24,7 +25,7 @@ namespace LibRpTexture { namespace ImageDecoder {
  * @param img_siz Size of image data. [must be >= (w*h)*2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromGcn16(PixelFormat px_format,
+rp_image *fromGcn16_cpp(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *RESTRICT img_buf, int img_siz)
 {
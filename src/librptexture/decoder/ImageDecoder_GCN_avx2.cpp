@@ -0,0 +1,245 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_GCN.cpp: Image decoding functions. (GameCube)              *
+ * AVX2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+// AVX2 intrinsics.
+#include <immintrin.h>
+
+// MSVC complains when the high bit is set in hex values
+// when setting SSE2 registers.
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable: 4309)
+#endif
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Convert 16 GameCube 16-bit pixels to ARGB32.
+ * NOTE: AVX2 shuffles and unpacks operate within 128-bit lanes,
+ * so the output pixels are interleaved by lane.
+ * @tparam px_format 16-bit pixel format.
+ * @param src	[in] 16 big-endian 16-bit pixels.
+ * @param pLo	[out] ARGB32 pixels 0-3 and 8-11.
+ * @param pHi	[out] ARGB32 pixels 4-7 and 12-15.
+ */
+template<PixelFormat px_format>
+static FORCEINLINE void T_Gcn16_to_ARGB32_avx2(__m256i src, __m256i *pLo, __m256i *pHi)
+{
+	if (px_format == PXF_IA8) {
+		// IA8: IIIIIIII AAAAAAAA (big-endian)
+		// The intensity byte is copied to R, G, and B.
+		const __m256i shuf_lo = _mm256_setr_epi8(0,0,0,1, 2,2,2,3, 4,4,4,5, 6,6,6,7,
+			0,0,0,1, 2,2,2,3, 4,4,4,5, 6,6,6,7);
+		const __m256i shuf_hi = _mm256_setr_epi8(8,8,8,9, 10,10,10,11, 12,12,12,13, 14,14,14,15,
+			8,8,8,9, 10,10,10,11, 12,12,12,13, 14,14,14,15);
+		*pLo = _mm256_shuffle_epi8(src, shuf_lo);
+		*pHi = _mm256_shuffle_epi8(src, shuf_hi);
+		return;
+	}
+
+	// Byteswap the source pixels.
+	const __m256i shuf_bswap = _mm256_setr_epi8(1,0, 3,2, 5,4, 7,6, 9,8, 11,10, 13,12, 15,14,
+		1,0, 3,2, 5,4, 7,6, 9,8, 11,10, 13,12, 15,14);
+	const __m256i px16 = _mm256_shuffle_epi8(src, shuf_bswap);
+
+	const __m256i Mask5 = _mm256_set1_epi16(0x1F);
+	const __m256i MaskFF = _mm256_set1_epi16(0xFF);
+	__m256i sR, sG, sB, sA;
+
+	switch (px_format) {
+		case PXF_RGB565: {
+			// RGB565: RRRRRGGG GGGBBBBB
+			const __m256i Mask6 = _mm256_set1_epi16(0x3F);
+			sR = _mm256_srli_epi16(px16, 11);
+			sG = _mm256_and_si256(_mm256_srli_epi16(px16, 5), Mask6);
+			sB = _mm256_and_si256(px16, Mask5);
+
+			// Expand from 5-bit/6-bit to 8-bit.
+			sR = _mm256_or_si256(_mm256_slli_epi16(sR, 3), _mm256_srli_epi16(sR, 2));
+			sG = _mm256_or_si256(_mm256_slli_epi16(sG, 2), _mm256_srli_epi16(sG, 4));
+			sB = _mm256_or_si256(_mm256_slli_epi16(sB, 3), _mm256_srli_epi16(sB, 2));
+			sA = MaskFF;
+			break;
+		}
+
+		case PXF_RGB5A3: {
+			// High bit set:   xRRRRRGG GGGBBBBB (RGB555)
+			// High bit clear: xAAARRRR GGGGBBBB (ARGB3444)
+			const __m256i Mask4 = _mm256_set1_epi16(0x0F);
+			const __m256i Mask3 = _mm256_set1_epi16(0x07);
+			const __m256i is555 = _mm256_srai_epi16(px16, 15);
+
+			// RGB555
+			__m256i r5 = _mm256_and_si256(_mm256_srli_epi16(px16, 10), Mask5);
+			__m256i g5 = _mm256_and_si256(_mm256_srli_epi16(px16, 5), Mask5);
+			__m256i b5 = _mm256_and_si256(px16, Mask5);
+			r5 = _mm256_or_si256(_mm256_slli_epi16(r5, 3), _mm256_srli_epi16(r5, 2));
+			g5 = _mm256_or_si256(_mm256_slli_epi16(g5, 3), _mm256_srli_epi16(g5, 2));
+			b5 = _mm256_or_si256(_mm256_slli_epi16(b5, 3), _mm256_srli_epi16(b5, 2));
+
+			// ARGB3444
+			__m256i r4 = _mm256_and_si256(_mm256_srli_epi16(px16, 8), Mask4);
+			__m256i g4 = _mm256_and_si256(_mm256_srli_epi16(px16, 4), Mask4);
+			__m256i b4 = _mm256_and_si256(px16, Mask4);
+			r4 = _mm256_or_si256(_mm256_slli_epi16(r4, 4), r4);
+			g4 = _mm256_or_si256(_mm256_slli_epi16(g4, 4), g4);
+			b4 = _mm256_or_si256(_mm256_slli_epi16(b4, 4), b4);
+			__m256i a3 = _mm256_and_si256(_mm256_srli_epi16(px16, 12), Mask3);
+			a3 = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(a3, 5), _mm256_slli_epi16(a3, 2)),
+				_mm256_srli_epi16(a3, 1));
+
+			// Select RGB555 or ARGB3444 based on the high bit.
+			sR = _mm256_or_si256(_mm256_and_si256(is555, r5), _mm256_andnot_si256(is555, r4));
+			sG = _mm256_or_si256(_mm256_and_si256(is555, g5), _mm256_andnot_si256(is555, g4));
+			sB = _mm256_or_si256(_mm256_and_si256(is555, b5), _mm256_andnot_si256(is555, b4));
+			sA = _mm256_or_si256(_mm256_and_si256(is555, MaskFF), _mm256_andnot_si256(is555, a3));
+			break;
+		}
+
+		default:
+			assert(!"Unsupported pixel format.");
+			*pLo = _mm256_setzero_si256();
+			*pHi = _mm256_setzero_si256();
+			return;
+	}
+
+	// Combine the components into ARGB32.
+	const __m256i sGB = _mm256_or_si256(_mm256_slli_epi16(sG, 8), sB);
+	const __m256i sAR = _mm256_or_si256(_mm256_slli_epi16(sA, 8), sR);
+	*pLo = _mm256_unpacklo_epi16(sGB, sAR);
+	*pHi = _mm256_unpackhi_epi16(sGB, sAR);
+}
+
+/**
+ * Decode GameCube 4x4 16-bit tiles directly into an ARGB32 rp_image.
+ * @tparam px_format 16-bit pixel format.
+ * @param img		[out] rp_image. (ARGB32)
+ * @param img_buf	[in] Tiled 16-bit image buffer.
+ * @param tilesX	[in] Number of horizontal tiles.
+ * @param tilesY	[in] Number of vertical tiles.
+ */
+template<PixelFormat px_format>
+static void T_fromGcn16_avx2(rp_image *RESTRICT img, const uint16_t *RESTRICT img_buf,
+	unsigned int tilesX, unsigned int tilesY)
+{
+	const int stride_px = img->stride() / sizeof(uint32_t);
+	uint32_t *const bits = static_cast<uint32_t*>(img->bits());
+	const __m256i *ymm_src = reinterpret_cast<const __m256i*>(img_buf);
+
+	for (unsigned int y = 0; y < tilesY; y++) {
+		uint32_t *px_dest = bits + (y * 4 * stride_px);
+		for (unsigned int x = 0; x < tilesX; x++, px_dest += 4, ymm_src++) {
+			// Each tile is 32 bytes, so it fits in a single YMM register.
+			// Low lane: Rows 0 and 1; high lane: Rows 2 and 3.
+			__m256i sLo, sHi;
+			T_Gcn16_to_ARGB32_avx2<px_format>(_mm256_loadu_si256(ymm_src), &sLo, &sHi);
+
+			uint32_t *row = px_dest;
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(row), _mm256_castsi256_si128(sLo));
+			row += stride_px;
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(row), _mm256_castsi256_si128(sHi));
+			row += stride_px;
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(row), _mm256_extracti128_si256(sLo, 1));
+			row += stride_px;
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(row), _mm256_extracti128_si256(sHi, 1));
+		}
+	}
+}
+
+/**
+ * Convert a GameCube 16-bit image to rp_image.
+ * AVX2-optimized version.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB5A3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromGcn16_avx2(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(img_siz >= ((width * height) * 2));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < ((width * height) * 2))
+	{
+		return nullptr;
+	}
+
+	// GameCube 16-bit formats use 4x4 tiles.
+	assert(width % 4 == 0);
+	assert(height % 4 == 0);
+	if (width % 4 != 0 || height % 4 != 0)
+		return nullptr;
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(width / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(height / 4);
+
+	switch (px_format) {
+		case PXF_RGB5A3: {
+			T_fromGcn16_avx2<PXF_RGB5A3>(img, img_buf, tilesX, tilesY);
+			// Set the sBIT metadata.
+			// NOTE: Pixels may be RGB555 or ARGB4444.
+			// We'll use 555 for RGB, and 4 for alpha.
+			static const rp_image::sBIT_t sBIT = {5,5,5,0,4};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		case PXF_RGB565: {
+			T_fromGcn16_avx2<PXF_RGB565>(img, img_buf, tilesX, tilesY);
+			// Set the sBIT metadata.
+			static const rp_image::sBIT_t sBIT = {5,6,5,0,0};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		case PXF_IA8: {
+			T_fromGcn16_avx2<PXF_IA8>(img, img_buf, tilesX, tilesY);
+			// Set the sBIT metadata.
+			// NOTE: Setting the grayscale value, though we're
+			// not saving grayscale PNGs at the moment.
+			static const rp_image::sBIT_t sBIT = {8,8,8,8,8};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		default:
+			assert(!"Invalid pixel format for this function.");
+			img->unref();
+			return nullptr;
+	}
+
+	// Image has been converted.
+	return img;
+}
+
+} }
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
@@ -0,0 +1,238 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_GCN.cpp: Image decoding functions. (GameCube)              *
+ * SSSE3-optimized version.                                                *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+// SSSE3 headers.
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+// MSVC complains when the high bit is set in hex values
+// when setting SSE2 registers.
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable: 4309)
+#endif
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Convert 8 GameCube 16-bit pixels to ARGB32.
+ * @tparam px_format 16-bit pixel format.
+ * @param src	[in] 8 big-endian 16-bit pixels.
+ * @param pLo	[out] ARGB32 pixels 0-3.
+ * @param pHi	[out] ARGB32 pixels 4-7.
+ */
+template<PixelFormat px_format>
+static FORCEINLINE void T_Gcn16_to_ARGB32_ssse3(__m128i src, __m128i *pLo, __m128i *pHi)
+{
+	if (px_format == PXF_IA8) {
+		// IA8: IIIIIIII AAAAAAAA (big-endian)
+		// The intensity byte is copied to R, G, and B.
+		const __m128i shuf_lo = _mm_setr_epi8(0,0,0,1, 2,2,2,3, 4,4,4,5, 6,6,6,7);
+		const __m128i shuf_hi = _mm_setr_epi8(8,8,8,9, 10,10,10,11, 12,12,12,13, 14,14,14,15);
+		*pLo = _mm_shuffle_epi8(src, shuf_lo);
+		*pHi = _mm_shuffle_epi8(src, shuf_hi);
+		return;
+	}
+
+	// Byteswap the source pixels.
+	const __m128i shuf_bswap = _mm_setr_epi8(1,0, 3,2, 5,4, 7,6, 9,8, 11,10, 13,12, 15,14);
+	const __m128i px16 = _mm_shuffle_epi8(src, shuf_bswap);
+
+	const __m128i Mask5 = _mm_set1_epi16(0x1F);
+	const __m128i MaskFF = _mm_set1_epi16(0xFF);
+	__m128i sR, sG, sB, sA;
+
+	switch (px_format) {
+		case PXF_RGB565: {
+			// RGB565: RRRRRGGG GGGBBBBB
+			const __m128i Mask6 = _mm_set1_epi16(0x3F);
+			sR = _mm_srli_epi16(px16, 11);
+			sG = _mm_and_si128(_mm_srli_epi16(px16, 5), Mask6);
+			sB = _mm_and_si128(px16, Mask5);
+
+			// Expand from 5-bit/6-bit to 8-bit.
+			sR = _mm_or_si128(_mm_slli_epi16(sR, 3), _mm_srli_epi16(sR, 2));
+			sG = _mm_or_si128(_mm_slli_epi16(sG, 2), _mm_srli_epi16(sG, 4));
+			sB = _mm_or_si128(_mm_slli_epi16(sB, 3), _mm_srli_epi16(sB, 2));
+			sA = MaskFF;
+			break;
+		}
+
+		case PXF_RGB5A3: {
+			// High bit set:   xRRRRRGG GGGBBBBB (RGB555)
+			// High bit clear: xAAARRRR GGGGBBBB (ARGB3444)
+			const __m128i Mask4 = _mm_set1_epi16(0x0F);
+			const __m128i Mask3 = _mm_set1_epi16(0x07);
+			const __m128i is555 = _mm_srai_epi16(px16, 15);
+
+			// RGB555
+			__m128i r5 = _mm_and_si128(_mm_srli_epi16(px16, 10), Mask5);
+			__m128i g5 = _mm_and_si128(_mm_srli_epi16(px16, 5), Mask5);
+			__m128i b5 = _mm_and_si128(px16, Mask5);
+			r5 = _mm_or_si128(_mm_slli_epi16(r5, 3), _mm_srli_epi16(r5, 2));
+			g5 = _mm_or_si128(_mm_slli_epi16(g5, 3), _mm_srli_epi16(g5, 2));
+			b5 = _mm_or_si128(_mm_slli_epi16(b5, 3), _mm_srli_epi16(b5, 2));
+
+			// ARGB3444
+			__m128i r4 = _mm_and_si128(_mm_srli_epi16(px16, 8), Mask4);
+			__m128i g4 = _mm_and_si128(_mm_srli_epi16(px16, 4), Mask4);
+			__m128i b4 = _mm_and_si128(px16, Mask4);
+			r4 = _mm_or_si128(_mm_slli_epi16(r4, 4), r4);
+			g4 = _mm_or_si128(_mm_slli_epi16(g4, 4), g4);
+			b4 = _mm_or_si128(_mm_slli_epi16(b4, 4), b4);
+			__m128i a3 = _mm_and_si128(_mm_srli_epi16(px16, 12), Mask3);
+			a3 = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(a3, 5), _mm_slli_epi16(a3, 2)),
+				_mm_srli_epi16(a3, 1));
+
+			// Select RGB555 or ARGB3444 based on the high bit.
+			sR = _mm_or_si128(_mm_and_si128(is555, r5), _mm_andnot_si128(is555, r4));
+			sG = _mm_or_si128(_mm_and_si128(is555, g5), _mm_andnot_si128(is555, g4));
+			sB = _mm_or_si128(_mm_and_si128(is555, b5), _mm_andnot_si128(is555, b4));
+			sA = _mm_or_si128(_mm_and_si128(is555, MaskFF), _mm_andnot_si128(is555, a3));
+			break;
+		}
+
+		default:
+			assert(!"Unsupported pixel format.");
+			*pLo = _mm_setzero_si128();
+			*pHi = _mm_setzero_si128();
+			return;
+	}
+
+	// Combine the components into ARGB32.
+	const __m128i sGB = _mm_or_si128(_mm_slli_epi16(sG, 8), sB);
+	const __m128i sAR = _mm_or_si128(_mm_slli_epi16(sA, 8), sR);
+	*pLo = _mm_unpacklo_epi16(sGB, sAR);
+	*pHi = _mm_unpackhi_epi16(sGB, sAR);
+}
+
+/**
+ * Decode GameCube 4x4 16-bit tiles directly into an ARGB32 rp_image.
+ * @tparam px_format 16-bit pixel format.
+ * @param img		[out] rp_image. (ARGB32)
+ * @param img_buf	[in] Tiled 16-bit image buffer.
+ * @param tilesX	[in] Number of horizontal tiles.
+ * @param tilesY	[in] Number of vertical tiles.
+ */
+template<PixelFormat px_format>
+static void T_fromGcn16_ssse3(rp_image *RESTRICT img, const uint16_t *RESTRICT img_buf,
+	unsigned int tilesX, unsigned int tilesY)
+{
+	const int stride_px = img->stride() / sizeof(uint32_t);
+	uint32_t *const bits = static_cast<uint32_t*>(img->bits());
+	const __m128i *xmm_src = reinterpret_cast<const __m128i*>(img_buf);
+
+	for (unsigned int y = 0; y < tilesY; y++) {
+		uint32_t *px_dest = bits + (y * 4 * stride_px);
+		for (unsigned int x = 0; x < tilesX; x++, px_dest += 4) {
+			// Each tile is 32 bytes: two tile rows per XMM register.
+			uint32_t *row = px_dest;
+			for (unsigned int i = 2; i > 0; i--, xmm_src++) {
+				__m128i sLo, sHi;
+				T_Gcn16_to_ARGB32_ssse3<px_format>(_mm_loadu_si128(xmm_src), &sLo, &sHi);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(row), sLo);
+				row += stride_px;
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(row), sHi);
+				row += stride_px;
+			}
+		}
+	}
+}
+
+/**
+ * Convert a GameCube 16-bit image to rp_image.
+ * SSSE3-optimized version.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB5A3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromGcn16_ssse3(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(img_siz >= ((width * height) * 2));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < ((width * height) * 2))
+	{
+		return nullptr;
+	}
+
+	// GameCube 16-bit formats use 4x4 tiles.
+	assert(width % 4 == 0);
+	assert(height % 4 == 0);
+	if (width % 4 != 0 || height % 4 != 0)
+		return nullptr;
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(width / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(height / 4);
+
+	switch (px_format) {
+		case PXF_RGB5A3: {
+			T_fromGcn16_ssse3<PXF_RGB5A3>(img, img_buf, tilesX, tilesY);
+			// Set the sBIT metadata.
+			// NOTE: Pixels may be RGB555 or ARGB4444.
+			// We'll use 555 for RGB, and 4 for alpha.
+			static const rp_image::sBIT_t sBIT = {5,5,5,0,4};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		case PXF_RGB565: {
+			T_fromGcn16_ssse3<PXF_RGB565>(img, img_buf, tilesX, tilesY);
+			// Set the sBIT metadata.
+			static const rp_image::sBIT_t sBIT = {5,6,5,0,0};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		case PXF_IA8: {
+			T_fromGcn16_ssse3<PXF_IA8>(img, img_buf, tilesX, tilesY);
+			// Set the sBIT metadata.
+			// NOTE: Setting the grayscale value, though we're
+			// not saving grayscale PNGs at the moment.
+			static const rp_image::sBIT_t sBIT = {8,8,8,8,8};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		default:
+			assert(!"Invalid pixel format for this function.");
+			img->unref();
+			return nullptr;
+	}
+
+	// Image has been converted.
+	return img;
+}
+
+} }
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
@@ -464,6 +464,54 @@ rp_image *fromLinearCI8(PixelFormat px_format,
 	return img;
 }
 
+/**
+ * Expand a CI8 image buffer to ARGB32.
+ * Standard version using regular C++ code.
+ * @param dest		[out] ARGB32 destination buffer.
+ * @param dest_stride	[in] Destination stride, in bytes.
+ * @param src		[in] CI8 source buffer.
+ * @param src_stride	[in] Source stride, in bytes.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param palette	[in] Palette. (must have 256 entries)
+ */
+void expandCI8toARGB32_cpp(uint32_t *RESTRICT dest, int dest_stride,
+	const uint8_t *RESTRICT src, int src_stride,
+	int width, int height, const uint32_t *RESTRICT palette)
+{
+	assert(dest != nullptr);
+	assert(src != nullptr);
+	assert(palette != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+
+	const int dest_adj = (dest_stride / sizeof(uint32_t)) - width;
+	const int src_adj = src_stride - width;
+
+	for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
+		// Convert up to 4 pixels per loop iteration.
+		unsigned int x;
+		for (x = static_cast<unsigned int>(width); x > 3; x -= 4) {
+			dest[0] = palette[src[0]];
+			dest[1] = palette[src[1]];
+			dest[2] = palette[src[2]];
+			dest[3] = palette[src[3]];
+			dest += 4;
+			src += 4;
+		}
+		// Remaining pixels.
+		for (; x > 0; x--) {
+			*dest = palette[*src];
+			dest++;
+			src++;
+		}
+
+		// Next line.
+		dest += dest_adj;
+		src += src_adj;
+	}
+}
+
 /**
  * Convert a linear monochrome image to rp_image.
  * @param width Image width.
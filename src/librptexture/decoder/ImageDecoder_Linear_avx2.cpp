@@ -0,0 +1,856 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_Linear.cpp: Image decoding functions. (Linear)             *
+ * AVX2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+#include "PixelConversion.hpp"
+using namespace LibRpTexture::PixelConversion;
+
+// AVX2 intrinsics.
+#include <immintrin.h>
+
+// MSVC complains when the high bit is set in hex values
+// when setting SSE2 registers.
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable: 4309)
+#endif
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Interleave 16-bit GB and AR words into 32-bit pixels.
+ * AVX2 unpack instructions operate within 128-bit lanes,
+ * so the results have to be recombined to keep the pixels in order.
+ * @param sB		[in] GB words.
+ * @param sR		[in] AR words.
+ * @param px_dest	[out] Destination image buffer. (16 pixels)
+ */
+static FORCEINLINE void T_store16_avx2(const __m256i &sB, const __m256i &sR, uint32_t *RESTRICT px_dest)
+{
+	// lo: Pixels 0-3, 8-11; hi: Pixels 4-7, 12-15
+	const __m256i lo = _mm256_unpacklo_epi16(sB, sR);
+	const __m256i hi = _mm256_unpackhi_epi16(sB, sR);
+
+	__m256i *ymm_dest = reinterpret_cast<__m256i*>(px_dest);
+	_mm256_storeu_si256(&ymm_dest[0], _mm256_permute2x128_si256(lo, hi, 0x20));
+	_mm256_storeu_si256(&ymm_dest[1], _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+/**
+ * Templated function for 15/16-bit RGB conversion using AVX2. (no alpha channel)
+ * Processes 16 pixels per iteration.
+ * Use this in the inner loop of the main code.
+ *
+ * @tparam Rshift_W	[in] Red shift amount in the high word.
+ * @tparam Gshift_W	[in] Green shift amount in the low word.
+ * @tparam Bshift_W	[in] Blue shift amount in the low word.
+ * @tparam Rbits	[in] Red bit count.
+ * @tparam Gbits	[in] Green bit count.
+ * @tparam Bbits	[in] Blue bit count.
+ * @tparam isBGR	[in] If true, this is BGR instead of RGB.
+ * @param Rmask		[in] AVX2 mask for the Red channel.
+ * @param Gmask		[in] AVX2 mask for the Green channel.
+ * @param Bmask		[in] AVX2 mask for the Blue channel.
+ * @param img_buf	[in] 16-bit image buffer.
+ * @param px_dest	[out] Destination image buffer.
+ */
+template<uint8_t Rshift_W, uint8_t Gshift_W, uint8_t Bshift_W,
+	uint8_t Rbits, uint8_t Gbits, uint8_t Bbits, bool isBGR>
+static inline void T_RGB16_avx2(
+	const __m256i &Rmask, const __m256i &Gmask, const __m256i &Bmask,
+	const uint16_t *RESTRICT img_buf, uint32_t *RESTRICT px_dest)
+{
+	// Mask for the high byte for Green and Alpha.
+	const __m256i MaskAG_Hi8 = _mm256_set1_epi16(0xFF00);
+
+	const __m256i src = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(img_buf));
+
+	// Mask the G and B components and shift them into place.
+	__m256i sG = _mm256_slli_epi16(_mm256_and_si256(Gmask, src), Gshift_W);
+	__m256i sB;
+	if (isBGR) {
+		sB = _mm256_srli_epi16(_mm256_and_si256(Bmask, src), Bshift_W);
+	} else {
+		sB = _mm256_slli_epi16(_mm256_and_si256(Bmask, src), Bshift_W);
+	}
+	sG = _mm256_or_si256(sG, _mm256_srli_epi16(sG, Gbits));
+	sB = _mm256_or_si256(sB, _mm256_srli_epi16(sB, Bbits));
+	// Combine G and B.
+	if (Gbits > 4) {
+		// NOTE: G low byte has to be masked due to the shift.
+		sB = _mm256_or_si256(sB, _mm256_and_si256(sG, MaskAG_Hi8));
+	} else {
+		// Not enough Gbits to need masking.
+		// FIXME: If less than 4, need to shift multiple times.
+		sB = _mm256_or_si256(sB, sG);
+	}
+
+	// Mask the R component and shift it into place.
+	__m256i sR;
+	if (isBGR) {
+		sR = _mm256_slli_epi16(_mm256_and_si256(Rmask, src), Rshift_W);
+	} else {
+		sR = _mm256_srli_epi16(_mm256_and_si256(Rmask, src), Rshift_W);
+	}
+	sR = _mm256_or_si256(sR, _mm256_srli_epi16(sR, Rbits));
+	// Apply the alpha channel.
+	sR = _mm256_or_si256(sR, MaskAG_Hi8);
+
+	T_store16_avx2(sB, sR, px_dest);
+}
+
+/**
+ * Templated function for 15/16-bit RGB conversion using AVX2. (with alpha channel)
+ * Processes 16 pixels per iteration.
+ * Use this in the inner loop of the main code.
+ *
+ * @tparam Ashift_W	[in] Alpha shift amount in the high word. (16 for 1555 alpha handling; 17 for 5551 alpha handling)
+ * @tparam Rshift_W	[in] Red shift amount in the high word.
+ * @tparam Gshift_W	[in] Green shift amount in the low word.
+ * @tparam Bshift_W	[in] Blue shift amount in the low word.
+ * @tparam Abits	[in] Alpha bit count.
+ * @tparam Rbits	[in] Red bit count.
+ * @tparam Gbits	[in] Green bit count.
+ * @tparam Bbits	[in] Blue bit count.
+ * @tparam isBGR	[in] If true, this is BGR instead of RGB.
+ * @param Amask		[in] AVX2 mask for the Alpha channel.
+ * @param Rmask		[in] AVX2 mask for the Red channel.
+ * @param Gmask		[in] AVX2 mask for the Green channel.
+ * @param Bmask		[in] AVX2 mask for the Blue channel.
+ * @param img_buf	[in] 16-bit image buffer.
+ * @param px_dest	[out] Destination image buffer.
+ */
+template<uint8_t Ashift_W, uint8_t Rshift_W, uint8_t Gshift_W, uint8_t Bshift_W,
+	uint8_t Abits, uint8_t Rbits, uint8_t Gbits, uint8_t Bbits, bool isBGR>
+static inline void T_ARGB16_avx2(
+	const __m256i &Amask, const __m256i &Rmask, const __m256i &Gmask, const __m256i &Bmask,
+	const uint16_t *RESTRICT img_buf, uint32_t *RESTRICT px_dest)
+{
+	static_assert(Ashift_W <= 17, "Ashift_W is invalid.");
+	static_assert(Rshift_W < 16, "Rshift_W is invalid.");
+	static_assert(Gshift_W < 16, "Gshift_W is invalid.");
+	static_assert(Bshift_W < 16, "Bshift_W is invalid.");
+	static_assert(Abits < 16, "Abits is invalid.");
+	static_assert(Rbits < 16, "Rbits is invalid.");
+	static_assert(Gbits < 16, "Gbits is invalid.");
+	static_assert(Bbits < 16, "Bbits is invalid.");
+	static_assert(Abits + Rbits + Gbits + Bbits <= 16, "Total number of bits is invalid.");
+
+	// Mask for the high byte for Green and Alpha.
+	const __m256i MaskAG_Hi8 = _mm256_set1_epi16(0xFF00);
+
+	const __m256i src = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(img_buf));
+
+	// Mask the G and B components and shift them into place.
+	__m256i sG = _mm256_slli_epi16(_mm256_and_si256(Gmask, src), Gshift_W);
+	__m256i sB;
+	if (isBGR) {
+		sB = _mm256_srli_epi16(_mm256_and_si256(Bmask, src), Bshift_W);
+	} else {
+		sB = _mm256_slli_epi16(_mm256_and_si256(Bmask, src), Bshift_W);
+	}
+	sG = _mm256_or_si256(sG, _mm256_srli_epi16(sG, Gbits));
+	sB = _mm256_or_si256(sB, _mm256_srli_epi16(sB, Bbits));
+	// Combine G and B.
+	if (Gbits > 4) {
+		// NOTE: G low byte has to be masked due to the shift.
+		sB = _mm256_or_si256(sB, _mm256_and_si256(sG, MaskAG_Hi8));
+	} else {
+		// Not enough Gbits to need masking.
+		// FIXME: If less than 4, need to shift multiple times.
+		sB = _mm256_or_si256(sB, sG);
+	}
+
+	// Mask the R component and shift it into place.
+	__m256i sR;
+	if (isBGR) {
+		sR = _mm256_slli_epi16(_mm256_and_si256(Rmask, src), Rshift_W);
+	} else {
+		sR = _mm256_srli_epi16(_mm256_and_si256(Rmask, src), Rshift_W);
+	}
+	sR = _mm256_or_si256(sR, _mm256_srli_epi16(sR, Rbits));
+	// Mask the A components, shift it into place, and combine with R.
+	__m256i sA;
+	if (Ashift_W == 16) {
+		// 1555 alpha handling.
+		// Using a bytewise comparison so we don't have to mask off the low byte.
+		// NOTE: AVX2 only has a signed greater-than comparison.
+		// Amask must be 0x0080, which will match:
+		// - 0x00 > 0x80-0xFF
+		// - 0x80 > Nothing
+		sA = _mm256_cmpgt_epi8(Amask, src);
+		// Combine A and R.
+		sR = _mm256_or_si256(sR, sA);
+	} else if (Ashift_W == 17) {
+		// 5551 alpha handling.
+		// Amask has only bit 0 set for each word.
+		// This will mask off bit 0, then compare it to the Amask value.
+		// Any that have bit 0 set will be set to 0x00FF; otherwise, 0x0000.
+		// This can then be shifted into place.
+		sA = _mm256_slli_epi16(_mm256_cmpeq_epi8(_mm256_and_si256(src, Amask), Amask), 8);
+		// Combine A and R.
+		sR = _mm256_or_si256(sR, sA);
+	} else {
+		// Standard alpha handling.
+		sA = _mm256_slli_epi16(_mm256_and_si256(Amask, src), Ashift_W);
+		sA = _mm256_or_si256(sA, _mm256_srli_epi16(sA, Abits));
+		// Combine A and R.
+		if (Abits > 4) {
+			// NOTE: A low byte has to be masked due to the shift.
+			sR = _mm256_or_si256(sR, _mm256_and_si256(sA, MaskAG_Hi8));
+		} else {
+			// Not enough Abits to need masking.
+			// FIXME: If less than 4, need to shift multiple times.
+			sR = _mm256_or_si256(sR, sA);
+		}
+	}
+
+	T_store16_avx2(sB, sR, px_dest);
+}
+
+/**
+ * Convert a linear 16-bit RGB image to rp_image.
+ * AVX2-optimized version.
+ * @param px_format	[in] 16-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] 16-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*2]
+ * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromLinear16_avx2(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz, int stride)
+{
+	static const int bytespp = 2;
+
+	// FIXME: Add support for these formats.
+	// For now, redirect back to the SSE2 version.
+	switch (px_format) {
+		case PXF_ARGB8332:
+		case PXF_RGB5A3:
+		case PXF_IA8:
+		case PXF_BGR555_PS1:
+		case PXF_BGR5A3:
+		case PXF_L16:
+		case PXF_A8L8:
+		case PXF_L8A8:
+		case PXF_RG88:
+		case PXF_GR88:
+			return fromLinear16_sse2(px_format, width, height, img_buf, img_siz, stride);
+
+		default:
+			break;
+	}
+
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(img_siz >= ((width * height) * bytespp));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < ((width * height) * bytespp))
+	{
+		return nullptr;
+	}
+
+	// Stride adjustment.
+	// NOTE: Unaligned loads are used, so the stride
+	// doesn't need to be a multiple of 16 pixels.
+	int src_stride_adj = 0;
+	assert(stride >= 0);
+	if (stride > 0) {
+		// Set src_stride_adj to the number of pixels we need to
+		// add to the end of each line to get to the next row.
+		assert(stride % bytespp == 0);
+		assert(stride >= (width * bytespp));
+		if (unlikely(stride % bytespp != 0 || stride < (width * bytespp))) {
+			// Invalid stride.
+			return nullptr;
+		}
+		src_stride_adj = (stride / bytespp) - width;
+	}
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	const int dest_stride_adj = (img->stride() / sizeof(uint32_t)) - img->width();
+	uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
+
+	// TODO: Only initialize what's required for the current pixel format?
+
+	// AND masks for 565 channels.
+	const __m256i Mask565_Hi5  = _mm256_set1_epi16(0xF800);
+	const __m256i Mask565_Mid6 = _mm256_set1_epi16(0x07E0);
+	const __m256i Mask565_Lo5  = _mm256_set1_epi16(0x001F);
+
+	// AND masks for 555 channels.
+	const __m256i Mask555_Hi5  = _mm256_set1_epi16(0x7C00);
+	const __m256i Mask555_Mid5 = _mm256_set1_epi16(0x03E0);
+	const __m256i Mask555_Lo5  = _mm256_set1_epi16(0x001F);
+
+	// AND masks for 4444 channels.
+	const __m256i Mask4444_Nyb3 = _mm256_set1_epi16(0xF000);
+	const __m256i Mask4444_Nyb2 = _mm256_set1_epi16(0x0F00);
+	const __m256i Mask4444_Nyb1 = _mm256_set1_epi16(0x00F0);
+	const __m256i Mask4444_Nyb0 = _mm256_set1_epi16(0x000F);
+
+	// AND masks for 1555 channels.
+	const __m256i Cmp1555_A     = _mm256_set1_epi16(0x0080);
+	const __m256i Mask1555_Hi5  = _mm256_set1_epi16(0x7C00);
+	const __m256i Mask1555_Mid5 = _mm256_set1_epi16(0x03E0);
+	const __m256i Mask1555_Lo5  = _mm256_set1_epi16(0x001F);
+
+	// AND masks for 5551 channels.
+	const __m256i Cmp5551_A     = _mm256_set1_epi16(0x0101);
+	const __m256i Mask5551_Hi5  = _mm256_set1_epi16(0xF800);
+	const __m256i Mask5551_Mid5 = _mm256_set1_epi16(0x07C0);
+	const __m256i Mask5551_Lo5  = _mm256_set1_epi16(0x003E);
+
+	// sBIT metadata.
+	static const rp_image::sBIT_t sBIT_RGB565   = {5,6,5,0,0};
+	static const rp_image::sBIT_t sBIT_ARGB1555 = {5,5,5,0,1};
+	static const rp_image::sBIT_t sBIT_xRGB4444 = {4,4,4,0,0};
+	static const rp_image::sBIT_t sBIT_ARGB4444 = {4,4,4,0,4};
+	static const rp_image::sBIT_t sBIT_RGB555   = {5,5,5,0,0};
+
+	// Macro for 16-bit formats with no alpha channel.
+#define fromLinear16_convert(fmt, sBIT, Rshift_W, Gshift_W, Bshift_W, Rbits, Gbits, Bbits, isBGR, Rmask, Gmask, Bmask) \
+		case PXF_##fmt: { \
+			for (unsigned int y = (unsigned int)height; y > 0; y--) { \
+				/* Process 16 pixels per iteration using AVX2. */ \
+				unsigned int x = (unsigned int)width; \
+				for (; x > 15; x -= 16, px_dest += 16, img_buf += 16) { \
+					T_RGB16_avx2<Rshift_W, Gshift_W, Bshift_W, Rbits, Gbits, Bbits, isBGR>( \
+						Rmask, Gmask, Bmask, img_buf, px_dest); \
+				} \
+				\
+				/* Remaining pixels. */ \
+				for (; x > 0; x--) { \
+					*px_dest = fmt##_to_ARGB32(*img_buf); \
+					img_buf++; \
+					px_dest++; \
+				} \
+				\
+				/* Next line. */ \
+				img_buf += src_stride_adj; \
+				px_dest += dest_stride_adj; \
+			} \
+			/* Set the sBIT metadata. */ \
+			img->set_sBIT(&sBIT); \
+		} break
+
+	// Macro for 16-bit formats with an alpha channel.
+#define fromLinear16A_convert(fmt, sBIT, Ashift_W, Rshift_W, Gshift_W, Bshift_W, Abits, Rbits, Gbits, Bbits, isBGR, Amask, Rmask, Gmask, Bmask) \
+		case PXF_##fmt: { \
+			for (unsigned int y = (unsigned int)height; y > 0; y--) { \
+				/* Process 16 pixels per iteration using AVX2. */ \
+				unsigned int x = (unsigned int)width; \
+				for (; x > 15; x -= 16, px_dest += 16, img_buf += 16) { \
+					T_ARGB16_avx2<Ashift_W, Rshift_W, Gshift_W, Bshift_W, Abits, Rbits, Gbits, Bbits, isBGR>( \
+						Amask, Rmask, Gmask, Bmask, img_buf, px_dest); \
+				} \
+				\
+				/* Remaining pixels. */ \
+				for (; x > 0; x--) { \
+					*px_dest = fmt##_to_ARGB32(*img_buf); \
+					img_buf++; \
+					px_dest++; \
+				} \
+				\
+				/* Next line. */ \
+				img_buf += src_stride_adj; \
+				px_dest += dest_stride_adj; \
+			} \
+			/* Set the sBIT metadata. */ \
+			img->set_sBIT(&sBIT); \
+		} break
+
+	switch (px_format) {
+		/** RGB565 **/
+		fromLinear16_convert(RGB565, sBIT_RGB565, 8, 5, 3, 5, 6, 5, false, Mask565_Hi5, Mask565_Mid6, Mask565_Lo5);
+		fromLinear16_convert(BGR565, sBIT_RGB565, 3, 5, 8, 5, 6, 5, true,  Mask565_Lo5, Mask565_Mid6, Mask565_Hi5);
+
+		/** ARGB1555 **/
+		fromLinear16A_convert(ARGB1555, sBIT_ARGB1555, 16, 7, 6, 3, 1, 5, 5, 5, false, Cmp1555_A, Mask1555_Hi5, Mask1555_Mid5, Mask1555_Lo5);
+		fromLinear16A_convert(ABGR1555, sBIT_ARGB1555, 16, 3, 6, 7, 1, 5, 5, 5, true,  Cmp1555_A, Mask1555_Lo5, Mask1555_Mid5, Mask1555_Hi5);
+		fromLinear16A_convert(RGBA5551, sBIT_ARGB1555, 17, 8, 5, 2, 1, 5, 5, 5, false, Cmp5551_A, Mask5551_Hi5, Mask5551_Mid5, Mask5551_Lo5);
+		fromLinear16A_convert(BGRA5551, sBIT_ARGB1555, 17, 2, 5, 8, 1, 5, 5, 5, true,  Cmp5551_A, Mask5551_Lo5, Mask5551_Mid5, Mask5551_Hi5);
+
+		/** ARGB4444 **/
+		fromLinear16A_convert(ARGB4444, sBIT_ARGB4444,  0, 4, 8, 4, 4, 4, 4, 4, false, Mask4444_Nyb3, Mask4444_Nyb2, Mask4444_Nyb1, Mask4444_Nyb0);
+		fromLinear16A_convert(ABGR4444, sBIT_ARGB4444,  0, 4, 8, 4, 4, 4, 4, 4, true,  Mask4444_Nyb3, Mask4444_Nyb0, Mask4444_Nyb1, Mask4444_Nyb2);
+		fromLinear16A_convert(RGBA4444, sBIT_ARGB4444, 12, 8, 4, 0, 4, 4, 4, 4, false, Mask4444_Nyb0, Mask4444_Nyb3, Mask4444_Nyb2, Mask4444_Nyb1);
+		fromLinear16A_convert(BGRA4444, sBIT_ARGB4444, 12, 0, 4, 8, 4, 4, 4, 4, true,  Mask4444_Nyb0, Mask4444_Nyb1, Mask4444_Nyb2, Mask4444_Nyb3);
+
+		/** xRGB4444 **/
+		fromLinear16_convert(xRGB4444, sBIT_xRGB4444, 4, 8, 4, 4, 4, 4, false, Mask4444_Nyb2, Mask4444_Nyb1, Mask4444_Nyb0);
+		fromLinear16_convert(xBGR4444, sBIT_xRGB4444, 4, 8, 4, 4, 4, 4, true,  Mask4444_Nyb0, Mask4444_Nyb1, Mask4444_Nyb2);
+		fromLinear16_convert(RGBx4444, sBIT_xRGB4444, 8, 4, 0, 4, 4, 4, false, Mask4444_Nyb3, Mask4444_Nyb2, Mask4444_Nyb1);
+		fromLinear16_convert(BGRx4444, sBIT_xRGB4444, 0, 4, 8, 4, 4, 4, true,  Mask4444_Nyb1, Mask4444_Nyb2, Mask4444_Nyb3);
+
+		/** RGB555 **/
+		fromLinear16_convert(RGB555, sBIT_RGB555, 7, 6, 3, 5, 5, 5, false, Mask555_Hi5, Mask555_Mid5, Mask555_Lo5);
+		fromLinear16_convert(BGR555, sBIT_RGB555, 3, 6, 7, 5, 5, 5, true,  Mask555_Lo5, Mask555_Mid5, Mask555_Hi5);
+
+		default:
+			assert(!"Pixel format not supported.");
+			img->unref();
+			return nullptr;
+	}
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert a linear 24-bit RGB image to rp_image.
+ * AVX2-optimized version.
+ * @param px_format	[in] 24-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] Image buffer. (must be byte-addressable)
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*3]
+ * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromLinear24_avx2(PixelFormat px_format,
+	int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz, int stride)
+{
+	static const int bytespp = 3;
+
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(img_siz >= ((width * height) * bytespp));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < ((width * height) * bytespp))
+	{
+		return nullptr;
+	}
+
+	// Stride adjustment.
+	// NOTE: Unaligned loads are used, so the stride
+	// doesn't need to be a multiple of 16 bytes.
+	int src_stride_adj = 0;
+	assert(stride >= 0);
+	if (stride > 0) {
+		// Set src_stride_adj to the number of bytes we need to
+		// add to the end of each line to get to the next row.
+		if (unlikely(stride < (width * bytespp))) {
+			// Invalid stride.
+			return nullptr;
+		}
+		// NOTE: Byte addressing, so keep it in units of bytespp.
+		src_stride_adj = stride - (width * bytespp);
+	}
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+	const int dest_stride_adj = (img->stride() / sizeof(argb32_t)) - img->width();
+	argb32_t *px_dest = static_cast<argb32_t*>(img->bits());
+
+	// 24-bit RGB images don't have an alpha channel.
+	const __m256i alpha_mask = _mm256_set1_epi32(0xFF000000);
+
+	// Determine the byte shuffle mask.
+	// NOTE: Shuffles operate within 128-bit lanes, so the
+	// same mask is used for both lanes.
+	__m256i shuf_mask;
+	switch (px_format) {
+		case PXF_RGB888:
+			shuf_mask = _mm256_broadcastsi128_si256(
+				_mm_setr_epi8(0,1,2,-1, 3,4,5,-1, 6,7,8,-1, 9,10,11,-1));
+			break;
+		case PXF_BGR888:
+			shuf_mask = _mm256_broadcastsi128_si256(
+				_mm_setr_epi8(2,1,0,-1, 5,4,3,-1, 8,7,6,-1, 11,10,9,-1));
+			break;
+		default:
+			assert(!"Unsupported 24-bit pixel format.");
+			img->unref();
+			return nullptr;
+	}
+
+	// Each group of 8 pixels is 24 bytes. Move the first 12 bytes into
+	// the low lane and the next 12 bytes into the high lane.
+	// The last group is loaded from offset 64 instead of 72 so we don't
+	// read past the end of the 96-byte block.
+	const __m256i perm_lo = _mm256_setr_epi32(0,1,2,0, 3,4,5,0);
+	const __m256i perm_hi = _mm256_setr_epi32(2,3,4,0, 5,6,7,0);
+
+	for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
+		// Process 32 pixels per iteration using AVX2.
+		unsigned int x = static_cast<unsigned int>(width);
+		for (; x > 31; x -= 32, px_dest += 32, img_buf += 32*3) {
+			__m256i *ymm_dest = reinterpret_cast<__m256i*>(px_dest);
+
+			__m256i sa = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&img_buf[0]));
+			__m256i sb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&img_buf[24]));
+			__m256i sc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&img_buf[48]));
+			__m256i sd = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&img_buf[64]));
+
+			__m256i val = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(sa, perm_lo), shuf_mask);
+			val = _mm256_or_si256(val, alpha_mask);
+			_mm256_storeu_si256(&ymm_dest[0], val);
+			val = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(sb, perm_lo), shuf_mask);
+			val = _mm256_or_si256(val, alpha_mask);
+			_mm256_storeu_si256(&ymm_dest[1], val);
+			val = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(sc, perm_lo), shuf_mask);
+			val = _mm256_or_si256(val, alpha_mask);
+			_mm256_storeu_si256(&ymm_dest[2], val);
+			val = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(sd, perm_hi), shuf_mask);
+			val = _mm256_or_si256(val, alpha_mask);
+			_mm256_storeu_si256(&ymm_dest[3], val);
+		}
+
+		// Remaining pixels.
+		if (x > 0) {
+		switch (px_format) {
+			case PXF_RGB888:
+				for (; x > 0; x--, px_dest++, img_buf += 3) {
+					px_dest->b = img_buf[0];
+					px_dest->g = img_buf[1];
+					px_dest->r = img_buf[2];
+					px_dest->a = 0xFF;
+				}
+				break;
+
+			case PXF_BGR888:
+				for (; x > 0; x--, px_dest++, img_buf += 3) {
+					px_dest->b = img_buf[2];
+					px_dest->g = img_buf[1];
+					px_dest->r = img_buf[0];
+					px_dest->a = 0xFF;
+				}
+				break;
+
+			default:
+				assert(!"Unsupported 24-bit pixel format.");
+				img->unref();
+				return nullptr;
+		} }
+
+		// Next line.
+		img_buf += src_stride_adj;
+		px_dest += dest_stride_adj;
+	}
+
+	// Set the sBIT metadata.
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,0};
+	img->set_sBIT(&sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert a linear 32-bit RGB image to rp_image.
+ * AVX2-optimized version.
+ * @param px_format	[in] 32-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] 32-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*4]
+ * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromLinear32_avx2(PixelFormat px_format,
+	int width, int height,
+	const uint32_t *RESTRICT img_buf, int img_siz, int stride)
+{
+	static const int bytespp = 4;
+
+	// FIXME: Add support for these formats.
+	// For now, redirect back to the C++ version.
+	// NOTE: PXF_HOST_ARGB32 is a straight copy, which
+	// the SSSE3 version already handles with memcpy().
+	switch (px_format) {
+		case PXF_A2R10G10B10:
+		case PXF_A2B10G10R10:
+		case PXF_RGB9_E5:
+		case PXF_BGR888_ABGR7888:
+			return fromLinear32_cpp(px_format, width, height, img_buf, img_siz, stride);
+		case PXF_HOST_ARGB32:
+			return fromLinear32_ssse3(px_format, width, height, img_buf, img_siz, stride);
+
+		default:
+			break;
+	}
+
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(img_siz >= ((width * height) * bytespp));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < ((width * height) * bytespp))
+	{
+		return nullptr;
+	}
+
+	// Stride adjustment.
+	// NOTE: Unaligned loads are used, so the stride
+	// doesn't need to be a multiple of 16 bytes.
+	int src_stride_adj = 0;
+	assert(stride >= 0);
+	if (stride > 0) {
+		// Set src_stride_adj to the number of pixels we need to
+		// add to the end of each line to get to the next row.
+		assert(stride % bytespp == 0);
+		assert(stride >= (width * bytespp));
+		if (unlikely(stride % bytespp != 0 || stride < (width * bytespp))) {
+			// Invalid stride.
+			return nullptr;
+		}
+		src_stride_adj = (stride / bytespp) - width;
+	}
+
+	// Determine the byte shuffle mask.
+	__m128i shuf_mask_xmm;
+	bool has_alpha;
+	switch (px_format) {
+		case PXF_HOST_xRGB32:
+			// TODO: Only apply the alpha mask instead of shuffling.
+			shuf_mask_xmm = _mm_setr_epi8(0,1,2,3, 4,5,6,7, 8,9,10,11, 12,13,14,15);
+			has_alpha = false;
+			break;
+
+		case PXF_HOST_RGBA32:
+		case PXF_HOST_RGBx32:
+			shuf_mask_xmm = _mm_setr_epi8(1,2,3,0, 5,6,7,4, 9,10,11,8, 13,14,15,12);
+			has_alpha = (px_format == PXF_HOST_RGBA32);
+			break;
+
+		case PXF_SWAP_ARGB32:
+		case PXF_SWAP_xRGB32:
+			shuf_mask_xmm = _mm_setr_epi8(3,2,1,0, 7,6,5,4, 11,10,9,8, 15,14,13,12);
+			has_alpha = (px_format == PXF_SWAP_ARGB32);
+			break;
+
+		case PXF_SWAP_RGBA32:
+		case PXF_SWAP_RGBx32:
+			shuf_mask_xmm = _mm_setr_epi8(2,1,0,3, 6,5,4,7, 10,9,8,11, 14,13,12,15);
+			has_alpha = (px_format == PXF_SWAP_RGBA32);
+			break;
+
+		case PXF_G16R16:
+			// NOTE: Truncates to G8R8.
+			shuf_mask_xmm = _mm_setr_epi8(-1,3,1,-1, -1,7,5,-1, -1,11,9,-1, -1,15,13,-1);
+			has_alpha = false;
+			break;
+
+		case PXF_RABG8888:
+			shuf_mask_xmm = _mm_setr_epi8(1,0,3,2, 5,4,7,6, 9,8,11,10, 13,12,15,14);
+			has_alpha = true;
+			break;
+
+		default:
+			assert(!"Unsupported 32-bit pixel format.");
+			return nullptr;
+	}
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+	const int dest_stride_adj = (img->stride() / sizeof(uint32_t)) - img->width();
+	uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
+
+	// Shuffles operate within 128-bit lanes, so the
+	// same mask is used for both lanes.
+	const __m256i shuf_mask = _mm256_broadcastsi128_si256(shuf_mask_xmm);
+
+	// If the image doesn't have an alpha channel, set it to 0xFF.
+	const __m128i alpha_mask_xmm = (has_alpha
+		? _mm_setzero_si128()
+		: _mm_set1_epi32(0xFF000000));
+	const __m256i alpha_mask = _mm256_broadcastsi128_si256(alpha_mask_xmm);
+
+	for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
+		// Process 16 pixels per iteration using AVX2.
+		unsigned int x = static_cast<unsigned int>(width);
+		for (; x > 15; x -= 16, px_dest += 16, img_buf += 16) {
+			const __m256i *ymm_src = reinterpret_cast<const __m256i*>(img_buf);
+			__m256i *ymm_dest = reinterpret_cast<__m256i*>(px_dest);
+
+			__m256i sa = _mm256_loadu_si256(&ymm_src[0]);
+			__m256i sb = _mm256_loadu_si256(&ymm_src[1]);
+
+			__m256i val = _mm256_shuffle_epi8(sa, shuf_mask);
+			val = _mm256_or_si256(val, alpha_mask);
+			_mm256_storeu_si256(&ymm_dest[0], val);
+
+			val = _mm256_shuffle_epi8(sb, shuf_mask);
+			val = _mm256_or_si256(val, alpha_mask);
+			_mm256_storeu_si256(&ymm_dest[1], val);
+		}
+
+		// Remaining pixels.
+		// Use the same shuffle mask, one pixel at a time.
+		for (; x > 0; x--, px_dest++, img_buf++) {
+			__m128i val = _mm_shuffle_epi8(_mm_cvtsi32_si128(*img_buf), shuf_mask_xmm);
+			val = _mm_or_si128(val, alpha_mask_xmm);
+			*px_dest = _mm_cvtsi128_si32(val);
+		}
+
+		// Next line.
+		img_buf += src_stride_adj;
+		px_dest += dest_stride_adj;
+	}
+
+	// Set the sBIT metadata.
+	if (has_alpha) {
+		static const rp_image::sBIT_t sBIT_A32 = {8,8,8,0,8};
+		img->set_sBIT(&sBIT_A32);
+	} else if (unlikely(px_format == PXF_G16R16)) {
+		static const rp_image::sBIT_t sBIT_G16R16 = {8,8,1,0,0};
+		img->set_sBIT(&sBIT_G16R16);
+	} else {
+		static const rp_image::sBIT_t sBIT_x32 = {8,8,8,0,0};
+		img->set_sBIT(&sBIT_x32);
+	}
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Expand a CI8 image buffer to ARGB32.
+ * AVX2-optimized version.
+ *
+ * Runs of 32 pixels that only use the first 16 palette entries
+ * are expanded with VPSHUFB. Other pixels use VPGATHERDD.
+ *
+ * @param dest		[out] ARGB32 destination buffer.
+ * @param dest_stride	[in] Destination stride, in bytes.
+ * @param src		[in] CI8 source buffer.
+ * @param src_stride	[in] Source stride, in bytes.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param palette	[in] Palette. (must have 256 entries)
+ */
+void expandCI8toARGB32_avx2(uint32_t *RESTRICT dest, int dest_stride,
+	const uint8_t *RESTRICT src, int src_stride,
+	int width, int height, const uint32_t *RESTRICT palette)
+{
+	assert(dest != nullptr);
+	assert(src != nullptr);
+	assert(palette != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+
+	// Split the first 16 palette entries into byte planes.
+	// Each plane is a VPSHUFB lookup table for one byte of the pixel,
+	// copied to both 128-bit lanes.
+	const __m128i shuf_planes = _mm_setr_epi8(0,4,8,12, 1,5,9,13, 2,6,10,14, 3,7,11,15);
+	const __m128i *const xmm_pal = reinterpret_cast<const __m128i*>(palette);
+	const __m128i p0 = _mm_shuffle_epi8(_mm_loadu_si128(&xmm_pal[0]), shuf_planes);
+	const __m128i p1 = _mm_shuffle_epi8(_mm_loadu_si128(&xmm_pal[1]), shuf_planes);
+	const __m128i p2 = _mm_shuffle_epi8(_mm_loadu_si128(&xmm_pal[2]), shuf_planes);
+	const __m128i p3 = _mm_shuffle_epi8(_mm_loadu_si128(&xmm_pal[3]), shuf_planes);
+	const __m128i t0 = _mm_unpacklo_epi32(p0, p1);	// Bytes 0 and 1 of colors 0-7
+	const __m128i t1 = _mm_unpackhi_epi32(p0, p1);	// Bytes 2 and 3 of colors 0-7
+	const __m128i t2 = _mm_unpacklo_epi32(p2, p3);	// Bytes 0 and 1 of colors 8-15
+	const __m128i t3 = _mm_unpackhi_epi32(p2, p3);	// Bytes 2 and 3 of colors 8-15
+	const __m256i plane0 = _mm256_broadcastsi128_si256(_mm_unpacklo_epi64(t0, t2));
+	const __m256i plane1 = _mm256_broadcastsi128_si256(_mm_unpackhi_epi64(t0, t2));
+	const __m256i plane2 = _mm256_broadcastsi128_si256(_mm_unpacklo_epi64(t1, t3));
+	const __m256i plane3 = _mm256_broadcastsi128_si256(_mm_unpackhi_epi64(t1, t3));
+
+	const __m256i MaskHi = _mm256_set1_epi8(static_cast<char>(0xF0));
+	const int *const pal32 = reinterpret_cast<const int*>(palette);
+
+	const int dest_adj = (dest_stride / sizeof(uint32_t)) - width;
+	const int src_adj = src_stride - width;
+
+	for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
+		// Convert 32 pixels per loop iteration.
+		unsigned int x;
+		for (x = static_cast<unsigned int>(width); x > 31; x -= 32, dest += 32, src += 32) {
+			const __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+			__m256i *const ymm_dest = reinterpret_cast<__m256i*>(dest);
+
+			if (!_mm256_testz_si256(idx, MaskHi)) {
+				// At least one index is >= 16. Gather from the full palette.
+				for (unsigned int i = 0; i < 4; i++) {
+					const __m256i idx32 = _mm256_cvtepu8_epi32(
+						_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&src[i*8])));
+					_mm256_storeu_si256(&ymm_dest[i], _mm256_i32gather_epi32(pal32, idx32, 4));
+				}
+				continue;
+			}
+
+			// Look up each byte of the pixels.
+			const __m256i b0 = _mm256_shuffle_epi8(plane0, idx);
+			const __m256i b1 = _mm256_shuffle_epi8(plane1, idx);
+			const __m256i b2 = _mm256_shuffle_epi8(plane2, idx);
+			const __m256i b3 = _mm256_shuffle_epi8(plane3, idx);
+
+			// Interleave the bytes to form 32-bit pixels.
+			// AVX2 unpack instructions operate within 128-bit lanes:
+			// lo: Pixels 0-7, 16-23; hi: Pixels 8-15, 24-31
+			const __m256i b01_lo = _mm256_unpacklo_epi8(b0, b1);
+			const __m256i b01_hi = _mm256_unpackhi_epi8(b0, b1);
+			const __m256i b23_lo = _mm256_unpacklo_epi8(b2, b3);
+			const __m256i b23_hi = _mm256_unpackhi_epi8(b2, b3);
+			const __m256i px0 = _mm256_unpacklo_epi16(b01_lo, b23_lo);	// Pixels 0-3, 16-19
+			const __m256i px1 = _mm256_unpackhi_epi16(b01_lo, b23_lo);	// Pixels 4-7, 20-23
+			const __m256i px2 = _mm256_unpacklo_epi16(b01_hi, b23_hi);	// Pixels 8-11, 24-27
+			const __m256i px3 = _mm256_unpackhi_epi16(b01_hi, b23_hi);	// Pixels 12-15, 28-31
+
+			_mm256_storeu_si256(&ymm_dest[0], _mm256_permute2x128_si256(px0, px1, 0x20));
+			_mm256_storeu_si256(&ymm_dest[1], _mm256_permute2x128_si256(px2, px3, 0x20));
+			_mm256_storeu_si256(&ymm_dest[2], _mm256_permute2x128_si256(px0, px1, 0x31));
+			_mm256_storeu_si256(&ymm_dest[3], _mm256_permute2x128_si256(px2, px3, 0x31));
+		}
+		// Convert 8 pixels per loop iteration.
+		for (; x > 7; x -= 8, dest += 8, src += 8) {
+			const __m256i idx32 = _mm256_cvtepu8_epi32(
+				_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dest),
+				_mm256_i32gather_epi32(pal32, idx32, 4));
+		}
+		// Remaining pixels.
+		for (; x > 0; x--) {
+			*dest = palette[*src];
+			dest++;
+			src++;
+		}
+
+		// Next line.
+		dest += dest_adj;
+		src += src_adj;
+	}
+}
+
+} }
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
@@ -515,4 +515,107 @@ rp_image *fromLinear32_ssse3(PixelFormat px_format,
 	return img;
 }
 
+/**
+ * Expand a CI8 image buffer to ARGB32.
+ * SSSE3-optimized version.
+ *
+ * Images that only use the first 16 palette entries are expanded
+ * with PSHUFB. Other images fall back to table lookups.
+ *
+ * @param dest		[out] ARGB32 destination buffer.
+ * @param dest_stride	[in] Destination stride, in bytes.
+ * @param src		[in] CI8 source buffer.
+ * @param src_stride	[in] Source stride, in bytes.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param palette	[in] Palette. (must have 256 entries)
+ */
+void expandCI8toARGB32_ssse3(uint32_t *RESTRICT dest, int dest_stride,
+	const uint8_t *RESTRICT src, int src_stride,
+	int width, int height, const uint32_t *RESTRICT palette)
+{
+	assert(dest != nullptr);
+	assert(src != nullptr);
+	assert(palette != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+
+	// Split the first 16 palette entries into byte planes.
+	// Each plane is a PSHUFB lookup table for one byte of the pixel.
+	const __m128i shuf_planes = _mm_setr_epi8(0,4,8,12, 1,5,9,13, 2,6,10,14, 3,7,11,15);
+	const __m128i *const xmm_pal = reinterpret_cast<const __m128i*>(palette);
+	const __m128i p0 = _mm_shuffle_epi8(_mm_loadu_si128(&xmm_pal[0]), shuf_planes);
+	const __m128i p1 = _mm_shuffle_epi8(_mm_loadu_si128(&xmm_pal[1]), shuf_planes);
+	const __m128i p2 = _mm_shuffle_epi8(_mm_loadu_si128(&xmm_pal[2]), shuf_planes);
+	const __m128i p3 = _mm_shuffle_epi8(_mm_loadu_si128(&xmm_pal[3]), shuf_planes);
+	const __m128i t0 = _mm_unpacklo_epi32(p0, p1);	// Bytes 0 and 1 of colors 0-7
+	const __m128i t1 = _mm_unpackhi_epi32(p0, p1);	// Bytes 2 and 3 of colors 0-7
+	const __m128i t2 = _mm_unpacklo_epi32(p2, p3);	// Bytes 0 and 1 of colors 8-15
+	const __m128i t3 = _mm_unpackhi_epi32(p2, p3);	// Bytes 2 and 3 of colors 8-15
+	const __m128i plane0 = _mm_unpacklo_epi64(t0, t2);
+	const __m128i plane1 = _mm_unpackhi_epi64(t0, t2);
+	const __m128i plane2 = _mm_unpacklo_epi64(t1, t3);
+	const __m128i plane3 = _mm_unpackhi_epi64(t1, t3);
+
+	const __m128i MaskHi = _mm_set1_epi8(static_cast<char>(0xF0));
+	const __m128i zero = _mm_setzero_si128();
+
+	const int dest_adj = (dest_stride / sizeof(uint32_t)) - width;
+	const int src_adj = src_stride - width;
+
+	// If an index >= 16 is found, the image uses more than 16 colors,
+	// so table lookups are used for the rest of the image.
+	bool use_pshufb = true;
+
+	for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
+		unsigned int x = static_cast<unsigned int>(width);
+		// Convert 16 pixels per loop iteration.
+		for (; use_pshufb && x > 15; x -= 16, dest += 16, src += 16) {
+			const __m128i idx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(idx, MaskHi), zero)) != 0xFFFF) {
+				// At least one index is >= 16.
+				use_pshufb = false;
+				break;
+			}
+
+			// Look up each byte of the pixels.
+			const __m128i b0 = _mm_shuffle_epi8(plane0, idx);
+			const __m128i b1 = _mm_shuffle_epi8(plane1, idx);
+			const __m128i b2 = _mm_shuffle_epi8(plane2, idx);
+			const __m128i b3 = _mm_shuffle_epi8(plane3, idx);
+
+			// Interleave the bytes to form 32-bit pixels.
+			const __m128i b01_lo = _mm_unpacklo_epi8(b0, b1);
+			const __m128i b01_hi = _mm_unpackhi_epi8(b0, b1);
+			const __m128i b23_lo = _mm_unpacklo_epi8(b2, b3);
+			const __m128i b23_hi = _mm_unpackhi_epi8(b2, b3);
+
+			__m128i *const xmm_dest = reinterpret_cast<__m128i*>(dest);
+			_mm_storeu_si128(&xmm_dest[0], _mm_unpacklo_epi16(b01_lo, b23_lo));
+			_mm_storeu_si128(&xmm_dest[1], _mm_unpackhi_epi16(b01_lo, b23_lo));
+			_mm_storeu_si128(&xmm_dest[2], _mm_unpacklo_epi16(b01_hi, b23_hi));
+			_mm_storeu_si128(&xmm_dest[3], _mm_unpackhi_epi16(b01_hi, b23_hi));
+		}
+		// Convert up to 4 pixels per loop iteration.
+		for (; x > 3; x -= 4) {
+			dest[0] = palette[src[0]];
+			dest[1] = palette[src[1]];
+			dest[2] = palette[src[2]];
+			dest[3] = palette[src[3]];
+			dest += 4;
+			src += 4;
+		}
+		// Remaining pixels.
+		for (; x > 0; x--) {
+			*dest = palette[*src];
+			dest++;
+			src++;
+		}
+
+		// Next line.
+		dest += dest_adj;
+		src += src_adj;
+	}
+}
+
 } }
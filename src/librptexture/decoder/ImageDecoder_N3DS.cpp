@@ -28,13 +28,14 @@ static const uint8_t N3DS_tile_order[] = {
 
 /**
  * Convert a Nintendo 3DS RGB565 tiled icon to rp_image.
+ * Standard version using regular C++ code.
  * @param width Image width.
  * @param height Image height.
  * @param img_buf RGB565 tiled image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)*2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromN3DSTiledRGB565(int width, int height,
+rp_image *fromN3DSTiledRGB565_cpp(int width, int height,
 	const uint16_t *RESTRICT img_buf, int img_siz)
 {
 	// Verify parameters.
@@ -92,6 +93,7 @@ rp_image *fromN3DSTiledRGB565(int width, int height,
 
 /**
  * Convert a Nintendo 3DS RGB565+A4 tiled icon to rp_image.
+ * Standard version using regular C++ code.
  * @param width Image width.
  * @param height Image height.
  * @param img_buf RGB565 tiled image buffer.
@@ -100,7 +102,7 @@ rp_image *fromN3DSTiledRGB565(int width, int height,
  * @param alpha_siz Size of alpha data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromN3DSTiledRGB565_A4(int width, int height,
+rp_image *fromN3DSTiledRGB565_A4_cpp(int width, int height,
 	const uint16_t *RESTRICT img_buf, int img_siz,
 	const uint8_t *RESTRICT alpha_buf, int alpha_siz)
 {
@@ -0,0 +1,258 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_N3DS.cpp: Image decoding functions. (Nintendo 3DS)         *
+ * SSE2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+// SSE2 intrinsics.
+#include <emmintrin.h>
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Convert 8 RGB565 pixels to ARGB32.
+ * @param px16	[in] RGB565 pixels.
+ * @param sA	[in] Alpha values. (one byte per word)
+ * @param pLo	[out] ARGB32 pixels 0-3.
+ * @param pHi	[out] ARGB32 pixels 4-7.
+ */
+static FORCEINLINE void RGB565_to_ARGB32_sse2(__m128i px16, __m128i sA, __m128i *pLo, __m128i *pHi)
+{
+	// RGB565: RRRRRGGG GGGBBBBB
+	const __m128i Mask5 = _mm_set1_epi16(0x1F);
+	const __m128i Mask6 = _mm_set1_epi16(0x3F);
+	__m128i sR = _mm_srli_epi16(px16, 11);
+	__m128i sG = _mm_and_si128(_mm_srli_epi16(px16, 5), Mask6);
+	__m128i sB = _mm_and_si128(px16, Mask5);
+
+	// Expand from 5-bit/6-bit to 8-bit.
+	sR = _mm_or_si128(_mm_slli_epi16(sR, 3), _mm_srli_epi16(sR, 2));
+	sG = _mm_or_si128(_mm_slli_epi16(sG, 2), _mm_srli_epi16(sG, 4));
+	sB = _mm_or_si128(_mm_slli_epi16(sB, 3), _mm_srli_epi16(sB, 2));
+
+	// Combine the components into ARGB32.
+	const __m128i sGB = _mm_or_si128(_mm_slli_epi16(sG, 8), sB);
+	const __m128i sAR = _mm_or_si128(_mm_slli_epi16(sA, 8), sR);
+	*pLo = _mm_unpacklo_epi16(sGB, sAR);
+	*pHi = _mm_unpackhi_epi16(sGB, sAR);
+}
+
+/**
+ * Get two image rows from an N3DS tile.
+ *
+ * N3DS tiles use Z-order: bits 0, 2, 4 of the tile index are X,
+ * and bits 1, 3, 5 are Y. Each XMM register has a 4x2 block of
+ * pixels, with 2-pixel runs alternating between the two rows.
+ *
+ * @param a	[in] Left 4x2 block.
+ * @param b	[in] Right 4x2 block.
+ * @param pEven	[out] Even row.
+ * @param pOdd	[out] Odd row.
+ */
+static FORCEINLINE void N3DS_rows_sse2(__m128i a, __m128i b, __m128i *pEven, __m128i *pOdd)
+{
+	const __m128 fa = _mm_castsi128_ps(a);
+	const __m128 fb = _mm_castsi128_ps(b);
+	*pEven = _mm_castps_si128(_mm_shuffle_ps(fa, fb, _MM_SHUFFLE(2,0,2,0)));
+	*pOdd  = _mm_castps_si128(_mm_shuffle_ps(fa, fb, _MM_SHUFFLE(3,1,3,1)));
+}
+
+/**
+ * Indexes of the XMM registers for each pair of rows in an N3DS tile.
+ * Each pair of rows uses two registers.
+ */
+static const uint8_t N3DS_row_regs[4][2] = {
+	{0, 2}, {1, 3}, {4, 6}, {5, 7}
+};
+
+/**
+ * Convert a Nintendo 3DS RGB565 tiled icon to rp_image.
+ * SSE2-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB565 tiled image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromN3DSTiledRGB565_sse2(int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(img_siz >= ((width * height) * 2));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < ((width * height) * 2))
+	{
+		return nullptr;
+	}
+
+	// N3DS tiled images use 8x8 tiles.
+	assert(width % 8 == 0);
+	assert(height % 8 == 0);
+	if (width % 8 != 0 || height % 8 != 0)
+		return nullptr;
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(width / 8);
+	const unsigned int tilesY = static_cast<unsigned int>(height / 8);
+
+	const int stride_px = img->stride() / sizeof(uint32_t);
+	uint32_t *const bits = static_cast<uint32_t*>(img->bits());
+	const __m128i *xmm_src = reinterpret_cast<const __m128i*>(img_buf);
+	const __m128i sA = _mm_set1_epi16(0xFF);
+
+	for (unsigned int y = 0; y < tilesY; y++) {
+		uint32_t *px_dest = bits + (y * 8 * stride_px);
+		for (unsigned int x = 0; x < tilesX; x++, px_dest += 8, xmm_src += 8) {
+			// Load the tile.
+			__m128i tile[8];
+			for (unsigned int i = 0; i < 8; i++) {
+				tile[i] = _mm_loadu_si128(&xmm_src[i]);
+			}
+
+			// De-swizzle and convert two rows at a time.
+			uint32_t *row = px_dest;
+			for (unsigned int i = 0; i < 4; i++) {
+				__m128i rows[2];
+				N3DS_rows_sse2(tile[N3DS_row_regs[i][0]], tile[N3DS_row_regs[i][1]], &rows[0], &rows[1]);
+				for (unsigned int j = 0; j < 2; j++, row += stride_px) {
+					__m128i sLo, sHi;
+					RGB565_to_ARGB32_sse2(rows[j], sA, &sLo, &sHi);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(&row[0]), sLo);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(&row[4]), sHi);
+				}
+			}
+		}
+	}
+
+	// Set the sBIT metadata.
+	static const rp_image::sBIT_t sBIT = {5,6,5,0,0};
+	img->set_sBIT(&sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert a Nintendo 3DS RGB565+A4 tiled icon to rp_image.
+ * SSE2-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB565 tiled image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param alpha_buf A4 tiled alpha buffer.
+ * @param alpha_siz Size of alpha data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromN3DSTiledRGB565_A4_sse2(int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz,
+	const uint8_t *RESTRICT alpha_buf, int alpha_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(alpha_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(img_siz >= ((width * height) * 2));
+	assert(alpha_siz >= ((width * height) / 2));
+	if (!img_buf || !alpha_buf || width <= 0 || height <= 0 ||
+	    img_siz < ((width * height) * 2) ||
+	    alpha_siz < ((width * height) / 2))
+	{
+		return nullptr;
+	}
+
+	// N3DS tiled images use 8x8 tiles.
+	assert(width % 8 == 0);
+	assert(height % 8 == 0);
+	if (width % 8 != 0 || height % 8 != 0)
+		return nullptr;
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(width / 8);
+	const unsigned int tilesY = static_cast<unsigned int>(height / 8);
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	const int stride_px = img->stride() / sizeof(uint32_t);
+	uint32_t *const bits = static_cast<uint32_t*>(img->bits());
+	const __m128i *xmm_src = reinterpret_cast<const __m128i*>(img_buf);
+	const __m128i *xmm_alpha = reinterpret_cast<const __m128i*>(alpha_buf);
+	const __m128i Mask4 = _mm_set1_epi8(0x0F);
+	const __m128i zero = _mm_setzero_si128();
+
+	for (unsigned int y = 0; y < tilesY; y++) {
+		uint32_t *px_dest = bits + (y * 8 * stride_px);
+		for (unsigned int x = 0; x < tilesX; x++, px_dest += 8, xmm_src += 8, xmm_alpha += 2) {
+			// Load the tile.
+			__m128i tile[8];
+			for (unsigned int i = 0; i < 8; i++) {
+				tile[i] = _mm_loadu_si128(&xmm_src[i]);
+			}
+
+			// Expand the A4 values to one word per pixel, in tile order.
+			// FIXME: Nybble ordering for A4?
+			// Assuming LeftLSN, same as NDS CI4.
+			__m128i alpha[8];
+			for (unsigned int i = 0; i < 2; i++) {
+				const __m128i a4 = _mm_loadu_si128(&xmm_alpha[i]);
+				const __m128i a4_lo = _mm_and_si128(a4, Mask4);
+				const __m128i a4_hi = _mm_and_si128(_mm_srli_epi16(a4, 4), Mask4);
+				const __m128i a8_0 = _mm_unpacklo_epi8(a4_lo, a4_hi);
+				const __m128i a8_1 = _mm_unpackhi_epi8(a4_lo, a4_hi);
+				alpha[(i*4)+0] = _mm_unpacklo_epi8(a8_0, zero);
+				alpha[(i*4)+1] = _mm_unpackhi_epi8(a8_0, zero);
+				alpha[(i*4)+2] = _mm_unpacklo_epi8(a8_1, zero);
+				alpha[(i*4)+3] = _mm_unpackhi_epi8(a8_1, zero);
+			}
+
+			// De-swizzle and convert two rows at a time.
+			uint32_t *row = px_dest;
+			for (unsigned int i = 0; i < 4; i++) {
+				__m128i rows[2], rows_a[2];
+				N3DS_rows_sse2(tile[N3DS_row_regs[i][0]], tile[N3DS_row_regs[i][1]], &rows[0], &rows[1]);
+				N3DS_rows_sse2(alpha[N3DS_row_regs[i][0]], alpha[N3DS_row_regs[i][1]], &rows_a[0], &rows_a[1]);
+				for (unsigned int j = 0; j < 2; j++, row += stride_px) {
+					// Expand from 4-bit to 8-bit.
+					const __m128i sA = _mm_or_si128(rows_a[j], _mm_slli_epi16(rows_a[j], 4));
+					__m128i sLo, sHi;
+					RGB565_to_ARGB32_sse2(rows[j], sA, &sLo, &sHi);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(&row[0]), sLo);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(&row[4]), sHi);
+				}
+			}
+		}
+	}
+
+	// Set the sBIT metadata.
+	static const rp_image::sBIT_t sBIT = {5,6,5,0,4};
+	img->set_sBIT(&sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+} }
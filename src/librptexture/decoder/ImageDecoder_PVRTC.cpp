@@ -11,7 +11,14 @@
 #include "ImageDecoder.hpp"
 #include "ImageDecoder_p.hpp"
 
-#include "PVRTDecompress.h"
+// C++ includes.
+#include <algorithm>
+#include <thread>
+#include <vector>
+using std::vector;
+
+// Uninitialized vector class.
+#include "librpbase/uvector.h"
 
 // References:
 // - https://www.khronos.org/registry/OpenGL/extensions/IMG/IMG_texture_compression_pvrtc.txt
@@ -19,15 +26,474 @@
 // - http://downloads.isee.biz/pub/files/igep-dsp-gst-framework-3_40_00/Graphics_SDK_4_05_00_03/GFX_Linux_SDK/OGLES/SDKPackage/Utilities/PVRTC/Documentation/PVRTC%20Texture%20Compression.Usage%20Guide.1.4f.External.pdf
 // - https://s3.amazonaws.com/pvr-sdk-live/sdk-documentation/PVRTC-and-Texture-Compression-User-Guide.pdf
 // - http://cdn2.imgtec.com/documentation/PVRTextureCompression.pdf
+//
+// The decoder produces the same output as the PowerVR Native SDK's
+// PVRTDecompressPVRTC() and PVRTDecompressPVRTCII() functions.
+// Instead of decoding each 2x2 group of words separately, the word
+// colors and modulation values are unpacked once, and the image
+// is decoded one pixel row at a time.
 
 namespace LibRpTexture { namespace ImageDecoder {
 
+// PVRTC words are 4 pixels tall.
+// 4bpp words are 4 pixels wide; 2bpp words are 8 pixels wide.
+static const int PVRTC_WORD_HEIGHT = 4;
+
+// Minimum image dimensions used by the PowerVR Native SDK. (2x2 words)
+static const int PVRTC_MIN_WIDTH_4BPP = 8;
+static const int PVRTC_MIN_WIDTH_2BPP = 16;
+static const int PVRTC_MIN_HEIGHT = 8;
+
+// Minimum number of pixels for multi-threaded decoding.
+static const int PVRTC_MT_MIN_PIXELS = 512*512;
+// Minimum number of pixel rows per thread.
+static const int PVRTC_MT_MIN_ROWS = 64;
+// Maximum number of decoding threads.
+static const unsigned int PVRTC_MT_MAX_THREADS = 8;
+
+// 2bpp modulation map: Values that must be interpolated from
+// the neighboring pixels. Low two bits are the word's mode.
+static const uint8_t PVRTC_MOD_INTERP = 0x80;
+static const uint8_t PVRTC_MOD_INTERP_HV = PVRTC_MOD_INTERP | 1;
+static const uint8_t PVRTC_MOD_INTERP_H  = PVRTC_MOD_INTERP | 2;
+static const uint8_t PVRTC_MOD_INTERP_V  = PVRTC_MOD_INTERP | 3;
+
+/**
+ * Unpack the PVRTC colors from a word's color data.
+ * @param colors	[out] Colors: A {B,G,R,A}, B {B,G,R,A}
+ * @param colorData	[in] Color data.
+ * @param isII		[in] True for PVRTC-II.
+ */
+static void unpackColors(int16_t colors[8], uint32_t colorData, bool isII)
+{
+	// Color A
+	if (colorData & (isII ? 0x80000000 : 0x8000)) {
+		// Opaque: RGB554
+		colors[0] = ((colorData & 0x1E) | ((colorData & 0x1E) >> 4));
+		colors[1] = ((colorData & 0x3E0) >> 5);
+		colors[2] = ((colorData & 0x7C00) >> 10);
+		colors[3] = 0xF;
+	} else {
+		// Transparent: ARGB3443
+		colors[0] = (((colorData & 0xE) << 1) | ((colorData & 0xE) >> 2));
+		colors[1] = (((colorData & 0xF0) >> 3) | ((colorData & 0xF0) >> 7));
+		colors[2] = (((colorData & 0xF00) >> 7) | ((colorData & 0xF00) >> 11));
+		colors[3] = ((colorData & 0x7000) >> 11);
+	}
+
+	// Color B
+	if (colorData & 0x80000000) {
+		// Opaque: RGB555
+		colors[4] = ((colorData & 0x1F0000) >> 16);
+		colors[5] = ((colorData & 0x3E00000) >> 21);
+		colors[6] = ((colorData & 0x7C000000) >> 26);
+		colors[7] = 0xF;
+	} else {
+		// Transparent: ARGB3444
+		colors[4] = (((colorData & 0xF0000) >> 15) | ((colorData & 0xF0000) >> 19));
+		colors[5] = (((colorData & 0xF00000) >> 19) | ((colorData & 0xF00000) >> 23));
+		colors[6] = (((colorData & 0xF000000) >> 23) | ((colorData & 0xF000000) >> 27));
+		colors[7] = ((colorData & 0x70000000) >> 27);
+		if (isII) {
+			// PVRTC-II sets the low alpha bit of Color B to 1, not 0.
+			colors[7] |= 1;
+		}
+	}
+}
+
+/**
+ * Unpack a PVRTC 4bpp word's modulation data.
+ * @param dest		[out] First pixel of the word in the modulation map.
+ * @param stride	[in] Modulation map stride.
+ * @param modData	[in] Modulation data.
+ * @param colorData	[in] Color data.
+ */
+static void unpackModulation4bpp(uint8_t *dest, int stride, uint32_t modData, uint32_t colorData)
+{
+	static const uint8_t modTbl[2][4] = {
+		{0, 3, 5, 8},
+		{0, 4, PVRTC_MOD_PUNCHTHROUGH, 8},
+	};
+	const uint8_t *const tbl = modTbl[colorData & 1];
+
+	for (int y = 0; y < PVRTC_WORD_HEIGHT; y++, dest += stride, modData >>= 8) {
+		// Each byte has one row of modulation values.
+		const uint8_t row[4] = {
+			tbl[modData & 3], tbl[(modData >> 2) & 3],
+			tbl[(modData >> 4) & 3], tbl[(modData >> 6) & 3],
+		};
+		memcpy(dest, row, sizeof(row));
+	}
+}
+
+/**
+ * Unpack a PVRTC 2bpp word's modulation data.
+ * Interpolated pixels are set to PVRTC_MOD_INTERP_*,
+ * and must be resolved once all words are unpacked.
+ * @param dest		[out] First pixel of the word in the modulation map.
+ * @param stride	[in] Modulation map stride.
+ * @param modData	[in] Modulation data.
+ * @param colorData	[in] Color data.
+ */
+static void unpackModulation2bpp(uint8_t *dest, int stride, uint32_t modData, uint32_t colorData)
+{
+	static const uint8_t repVals[4] = {0, 3, 5, 8};
+
+	if (!(colorData & 1)) {
+		// Direct encoding: 1 bit per pixel.
+		for (int y = 0; y < PVRTC_WORD_HEIGHT; y++, dest += stride) {
+			for (int x = 0; x < 8; x++, modData >>= 1) {
+				dest[x] = (modData & 1) ? 8 : 0;
+			}
+		}
+		return;
+	}
+
+	// Interpolated encoding: 2 bits for every other pixel.
+	uint8_t interp = PVRTC_MOD_INTERP_HV;
+	if (modData & 1) {
+		// H-only or V-only interpolation.
+		// The center pixel's LSB indicates which one.
+		interp = (modData & (1U << 20)) ? PVRTC_MOD_INTERP_V : PVRTC_MOD_INTERP_H;
+		// The center pixel's MSB is used for both bits.
+		if (modData & (1U << 21)) {
+			modData |= (1U << 20);
+		} else {
+			modData &= ~(1U << 20);
+		}
+	}
+	// Same for the first pixel.
+	if (modData & 2) {
+		modData |= 1;
+	} else {
+		modData &= ~1U;
+	}
+
+	for (int y = 0; y < PVRTC_WORD_HEIGHT; y++, dest += stride) {
+		for (int x = 0; x < 8; x++) {
+			if (((x ^ y) & 1) == 0) {
+				dest[x] = repVals[modData & 3];
+				modData >>= 2;
+			} else {
+				dest[x] = interp;
+			}
+		}
+	}
+}
+
+/**
+ * Resolve interpolated pixels in a row of a PVRTC 2bpp modulation map.
+ * @param dest		[out] Modulation weights.
+ * @param cur		[in] Modulation map: Current row.
+ * @param up		[in] Modulation map: Previous row. (wrapped)
+ * @param down		[in] Modulation map: Next row. (wrapped)
+ * @param width		[in] Image width.
+ */
+static void resolveModulation2bpp(uint8_t *RESTRICT dest,
+	const uint8_t *RESTRICT cur, const uint8_t *RESTRICT up, const uint8_t *RESTRICT down,
+	int width)
+{
+	// NOTE: Interpolated pixels are never next to other interpolated
+	// pixels, since they're only used for every other pixel, and
+	// the image dimensions are always even.
+	for (int x = 0; x < width; x++) {
+		const uint8_t val = cur[x];
+		switch (val) {
+			default:
+				dest[x] = val;
+				break;
+			case PVRTC_MOD_INTERP_HV: {
+				const int left = cur[(x > 0) ? (x - 1) : (width - 1)];
+				const int right = cur[(x + 1 < width) ? (x + 1) : 0];
+				dest[x] = (up[x] + down[x] + left + right + 2) / 4;
+				break;
+			}
+			case PVRTC_MOD_INTERP_H: {
+				const int left = cur[(x > 0) ? (x - 1) : (width - 1)];
+				const int right = cur[(x + 1 < width) ? (x + 1) : 0];
+				dest[x] = (left + right + 1) / 2;
+				break;
+			}
+			case PVRTC_MOD_INTERP_V:
+				dest[x] = (up[x] + down[x] + 1) / 2;
+				break;
+		}
+	}
+}
+
+/**
+ * Get the index of a PVRTC-I word. (Morton order)
+ * This matches the PowerVR Native SDK, including
+ * its handling of non-square images.
+ * @param xSize Width, in words.
+ * @param ySize Height, in words.
+ * @param xPos X position, in words.
+ * @param yPos Y position, in words.
+ * @return Word index.
+ */
+static uint32_t twiddleUV(uint32_t xSize, uint32_t ySize, uint32_t xPos, uint32_t yPos)
+{
+	uint32_t minDimension = xSize;
+	uint32_t maxValue = yPos;
+	if (ySize < xSize) {
+		minDimension = ySize;
+		maxValue = xPos;
+	}
+
+	uint32_t twiddled = 0;
+	int shiftCount = 0;
+	for (uint32_t srcBitPos = 1, dstBitPos = 1; srcBitPos < minDimension;
+	     srcBitPos <<= 1, dstBitPos <<= 2, shiftCount++)
+	{
+		if (yPos & srcBitPos)
+			twiddled |= dstBitPos;
+		if (xPos & srcBitPos)
+			twiddled |= (dstBitPos << 1);
+	}
+
+	// Append any unused bits.
+	return twiddled | ((maxValue >> shiftCount) << (2 * shiftCount));
+}
+
+/**
+ * Decode PVRTC pixel rows.
+ * @param img		[out] rp_image.
+ * @param colors	[in] Word colors. (8 components per word)
+ * @param mods		[in] Modulation map.
+ * @param yStart	[in] First row to decode.
+ * @param yEnd		[in] Last row to decode, plus one.
+ * @param mode		[in] Mode bitfield. (See PVRTC_Mode_e.)
+ */
+static void decodePVRTCRows(rp_image *img,
+	const int16_t *colors, const uint8_t *mods,
+	int yStart, int yEnd, uint8_t mode)
+{
+	const int width = img->width();
+	const int height = img->height();
+	const bool is2bpp = ((mode & PVRTC_BPP_MASK) == PVRTC_2BPP);
+	const int xWords = width / (is2bpp ? 8 : 4);
+	const int yWords = height / PVRTC_WORD_HEIGHT;
+	const int colorStride = xWords * 8;
+
+	ao::uvector<uint8_t> modRow;
+	if (is2bpp) {
+		modRow.resize(width);
+	}
+
+	for (int y = yStart; y < yEnd; y++) {
+		// Each pixel row is between the centers of two word rows.
+		const int yOffset = y + (PVRTC_WORD_HEIGHT / 2);
+		int wyP = (yOffset / PVRTC_WORD_HEIGHT) - 1;
+		if (wyP < 0) {
+			wyP = yWords - 1;
+		}
+		const int wyR = (wyP + 1 < yWords) ? (wyP + 1) : 0;
+		const int j = yOffset % PVRTC_WORD_HEIGHT;
+
+		const uint8_t *mod = &mods[y * width];
+		if (is2bpp) {
+			const uint8_t *const up = &mods[((y > 0) ? (y - 1) : (height - 1)) * width];
+			const uint8_t *const down = &mods[((y + 1 < height) ? (y + 1) : 0) * width];
+			resolveModulation2bpp(modRow.data(), mod, up, down, width);
+			mod = modRow.data();
+		}
+
+		decodePVRTCRow(static_cast<uint32_t*>(img->scanLine(y)), width,
+			&colors[wyP * colorStride], &colors[wyR * colorStride], j,
+			mod, mode);
+	}
+}
+
+/**
+ * Decode a PVRTC or PVRTC-II image.
+ * @param img		[out] rp_image. (ARGB32; dimensions must be multiples of the word size)
+ * @param img_buf	[in] PVRTC image buffer.
+ * @param mode		[in] Mode bitfield. (See PVRTC_Mode_e.)
+ */
+static void decodePVRTC(rp_image *img, const uint8_t *RESTRICT img_buf, uint8_t mode)
+{
+	const int width = img->width();
+	const int height = img->height();
+	const bool is2bpp = ((mode & PVRTC_BPP_MASK) == PVRTC_2BPP);
+	const bool isII = ((mode & PVRTC_TYPE_MASK) == PVRTC_TYPE_II);
+	const int wordWidth = (is2bpp ? 8 : 4);
+	const unsigned int xWords = static_cast<unsigned int>(width / wordWidth);
+	const unsigned int yWords = static_cast<unsigned int>(height / PVRTC_WORD_HEIGHT);
+	const unsigned int numWords = xWords * yWords;
+
+	// Unpack the colors and modulation values for each word.
+	// Colors are stored in linear order.
+	ao::uvector<int16_t> colors(numWords * 8);
+	ao::uvector<uint8_t> mods(width * height);
+	const uint32_t *const words = reinterpret_cast<const uint32_t*>(img_buf);
+
+	// Word index offsets for each column and row.
+	// PVRTC-I uses Morton order; PVRTC-II uses linear order.
+	// Morton order never combines the X and Y coordinates
+	// into the same bits, so the offsets can be added.
+	ao::uvector<unsigned int> idxX(xWords), idxY(yWords);
+	for (unsigned int wx = 0; wx < xWords; wx++) {
+		idxX[wx] = (isII ? wx : twiddleUV(xWords, yWords, wx, 0));
+	}
+	for (unsigned int wy = 0; wy < yWords; wy++) {
+		idxY[wy] = (isII ? (wy * xWords) : twiddleUV(xWords, yWords, 0, wy));
+	}
+
+	int16_t *pColors = colors.data();
+	for (unsigned int wy = 0; wy < yWords; wy++) {
+		uint8_t *pMods = &mods[wy * PVRTC_WORD_HEIGHT * width];
+		for (unsigned int wx = 0; wx < xWords; wx++, pColors += 8, pMods += wordWidth) {
+			const unsigned int idx = idxX[wx] + idxY[wy];
+			uint32_t modData = 0, colorData = 0;
+			assert(idx < numWords);
+			if (idx < numWords) {
+				modData = le32_to_cpu(words[idx * 2]);
+				colorData = le32_to_cpu(words[(idx * 2) + 1]);
+			}
+
+			unpackColors(pColors, colorData, isII);
+			if (is2bpp) {
+				unpackModulation2bpp(pMods, width, modData, colorData);
+			} else {
+				unpackModulation4bpp(pMods, width, modData, colorData);
+			}
+		}
+	}
+
+	// Decode the pixel rows.
+	// Large images are split into bands that are decoded in parallel.
+	unsigned int nThreads = 1;
+	if (width * height >= PVRTC_MT_MIN_PIXELS) {
+		nThreads = std::min(std::thread::hardware_concurrency(), PVRTC_MT_MAX_THREADS);
+		nThreads = std::min(nThreads, static_cast<unsigned int>(height / PVRTC_MT_MIN_ROWS));
+		if (nThreads < 1) {
+			nThreads = 1;
+		}
+	}
+
+	if (nThreads == 1) {
+		decodePVRTCRows(img, colors.data(), mods.data(), 0, height, mode);
+		return;
+	}
+
+	vector<std::thread> threads;
+	threads.reserve(nThreads - 1);
+	const int rowsPerThread = ALIGN_BYTES(PVRTC_WORD_HEIGHT, (height + nThreads - 1) / nThreads);
+	for (unsigned int i = 1; i < nThreads; i++) {
+		const int yStart = static_cast<int>(i) * rowsPerThread;
+		if (yStart >= height)
+			break;
+		threads.emplace_back(decodePVRTCRows, img, colors.data(), mods.data(),
+			yStart, std::min(yStart + rowsPerThread, height), mode);
+	}
+	decodePVRTCRows(img, colors.data(), mods.data(), 0, std::min(rowsPerThread, height), mode);
+	for (auto iter = threads.begin(); iter != threads.end(); ++iter) {
+		iter->join();
+	}
+}
+
+/**
+ * Standard C++ implementation of decodePVRTCRow().
+ * @tparam wordWidth Word width. (4 for 4bpp; 8 for 2bpp)
+ * @param dest		[out] ARGB32 destination row.
+ * @param width		[in] Image width. (must be a multiple of the word width)
+ * @param colorsP	[in] Word colors for the word row above this pixel row.
+ * @param colorsR	[in] Word colors for the word row below this pixel row.
+ * @param j		[in] Vertical distance from the word centers in colorsP. (0-3)
+ * @param mod		[in] Modulation weights. (0-8, or PVRTC_MOD_PUNCHTHROUGH)
+ * @param mode		[in] Mode bitfield. (See PVRTC_Mode_e.)
+ */
+template<int wordWidth>
+static inline void T_decodePVRTCRow_cpp(uint32_t *RESTRICT dest, int width,
+	const int16_t *RESTRICT colorsP, const int16_t *RESTRICT colorsR, int j,
+	const uint8_t *RESTRICT mod, uint8_t mode)
+{
+	// Total bilinear weight is 16 (4bpp) or 32 (2bpp).
+	// RGB is converted from 5-bit to 8-bit, and alpha
+	// is converted from 4-bit to 8-bit.
+	static const int wShift = (wordWidth == 8 ? 5 : 4);
+
+	// Punch-through alpha clears alpha for PVRTC-I,
+	// and clears the entire pixel for PVRTC-II.
+	const uint32_t punchMask = ((mode & PVRTC_TYPE_MASK) == PVRTC_TYPE_II) ? 0 : 0x00FFFFFF;
+	const int xWords = width / wordWidth;
+
+	// Each span of pixels is between the centers of two words.
+	for (int s = -1; s < xWords; s++) {
+		const int wL = ((s >= 0) ? s : (xWords - 1)) * 8;
+		const int wR = ((s + 1 < xWords) ? (s + 1) : 0) * 8;
+
+		// Interpolate the colors vertically.
+		int vL[8], vR[8];
+		for (int c = 0; c < 8; c++) {
+			vL[c] = ((PVRTC_WORD_HEIGHT - j) * colorsP[wL + c]) + (j * colorsR[wL + c]);
+			vR[c] = ((PVRTC_WORD_HEIGHT - j) * colorsP[wR + c]) + (j * colorsR[wR + c]);
+		}
+
+		const int iStart = (s >= 0 ? 0 : (wordWidth / 2));
+		const int iEnd = (s + 1 < xWords ? wordWidth : (wordWidth / 2));
+		for (int i = iStart; i < iEnd; i++, dest++, mod++) {
+			// Interpolate the colors horizontally.
+			int up[8];
+			for (int c = 0; c < 8; c++) {
+				const int sum = ((wordWidth - i) * vL[c]) + (i * vR[c]);
+				if ((c & 3) == 3) {
+					// Alpha
+					up[c] = (sum >> wShift) + (sum >> (wShift - 4));
+				} else {
+					// RGB
+					up[c] = (sum >> (wShift + 2)) + (sum >> (wShift - 3));
+				}
+			}
+
+			// Blend the colors.
+			const unsigned int m = *mod;
+			const int w = (m == PVRTC_MOD_PUNCHTHROUGH ? 4 : m);
+			uint32_t px = 0;
+			for (int c = 0; c < 4; c++) {
+				px |= static_cast<uint32_t>(((up[c] * (8 - w)) + (up[c + 4] * w)) >> 3) << (c * 8);
+			}
+			if (m == PVRTC_MOD_PUNCHTHROUGH) {
+				px &= punchMask;
+			}
+			*dest = px;
+		}
+	}
+}
+
+/**
+ * Decode a single pixel row of a PVRTC or PVRTC-II image.
+ * Standard version using regular C++ code.
+ *
+ * Each word has eight int16_t color components:
+ * Color A {B,G,R,A}, followed by Color B {B,G,R,A}.
+ * RGB components are 5-bit; alpha components are 4-bit.
+ *
+ * @param dest		[out] ARGB32 destination row.
+ * @param width		[in] Image width. (must be a multiple of the word width)
+ * @param colorsP	[in] Word colors for the word row above this pixel row.
+ * @param colorsR	[in] Word colors for the word row below this pixel row.
+ * @param j		[in] Vertical distance from the word centers in colorsP. (0-3)
+ * @param mod		[in] Modulation weights. (0-8, or PVRTC_MOD_PUNCHTHROUGH)
+ * @param mode		[in] Mode bitfield. (See PVRTC_Mode_e.)
+ */
+void decodePVRTCRow_cpp(uint32_t *RESTRICT dest, int width,
+	const int16_t *RESTRICT colorsP, const int16_t *RESTRICT colorsR, int j,
+	const uint8_t *RESTRICT mod, uint8_t mode)
+{
+	if ((mode & PVRTC_BPP_MASK) == PVRTC_2BPP) {
+		T_decodePVRTCRow_cpp<8>(dest, width, colorsP, colorsR, j, mod, mode);
+	} else {
+		T_decodePVRTCRow_cpp<4>(dest, width, colorsP, colorsR, j, mod, mode);
+	}
+}
+
 /**
  * Convert a PVRTC 2bpp or 4bpp image to rp_image.
  * @param width Image width.
  * @param height Image height.
  * @param img_buf PVRTC image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)/4]
+ * @param img_siz Size of image data. [must be >= calcPVRTCImageSize()]
  * @param mode Mode bitfield. (See PVRTC_Mode_e.)
  * @return rp_image, or nullptr on error.
  */
@@ -40,20 +506,10 @@ rp_image *fromPVRTC(int width, int height,
 	assert(width > 0);
 	assert(height > 0);
 
-	// Expected size to be read by the PowerVR Native SDK.
-	const uint32_t expected_size_in = ((width * height) /
-		(((mode & PVRTC_BPP_MASK) == PVRTC_2BPP) ? 4 : 2));
-
-	assert(img_siz >= static_cast<int>(expected_size_in));
-	if (!img_buf || width <= 0 || height <= 0 ||
-	    img_siz < static_cast<int>(expected_size_in))
-	{
-		return nullptr;
-	}
-
 	// PVRTC 2bpp uses 8x4 tiles.
 	// PVRTC 4bpp uses 4x4 tiles.
-	if ((mode & PVRTC_BPP_MASK) == PVRTC_2BPP) {
+	const bool is2bpp = ((mode & PVRTC_BPP_MASK) == PVRTC_2BPP);
+	if (is2bpp) {
 		// PVRTC 2bpp
 		assert(width % 8 == 0);
 		assert(height % 4 == 0);
@@ -67,28 +523,38 @@ rp_image *fromPVRTC(int width, int height,
 			return nullptr;
 	}
 
+	// PVRTC-I textures are at least 2x2 words.
+	const int physWidth = std::max(width, (is2bpp ? PVRTC_MIN_WIDTH_2BPP : PVRTC_MIN_WIDTH_4BPP));
+	const int physHeight = std::max(height, PVRTC_MIN_HEIGHT);
+
+	// Expected size of the image data.
+	const int expected_size_in = static_cast<int>(calcPVRTCImageSize(width, height, mode));
+
+	assert(img_siz >= expected_size_in);
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < expected_size_in)
+	{
+		return nullptr;
+	}
+
 	// Create an rp_image.
-	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	rp_image *const img = new rp_image(physWidth, physHeight, rp_image::Format::ARGB32);
 	if (!img->isValid()) {
 		// Could not allocate the image.
 		img->unref();
 		return nullptr;
 	}
 
-	// Use the PowerVR Native SDK to decompress the texture.
-	// Return value is the size of the *input* data that was decompressed.
-	// TODO: Row padding?
-	uint32_t size = pvr::PVRTDecompressPVRTC(img_buf, ((mode & PVRTC_BPP_MASK) == PVRTC_2BPP), width, height,
-		static_cast<uint8_t*>(img->bits()));
-	assert(size == expected_size_in);
-	if (size != expected_size_in) {
-		// Read error...
-		img->unref();
-		return nullptr;
-	}
+	// Decode the image.
+	decodePVRTC(img, img_buf, (mode & ~PVRTC_TYPE_MASK) | PVRTC_TYPE_I);
 
 	// TODO: If !has_alpha, make sure the alpha channel is all 0xFF.
 
+	if (width < physWidth || height < physHeight) {
+		// Shrink the image.
+		img->shrink(width, height);
+	}
+
 	// Set the sBIT metadata.
 	static const rp_image::sBIT_t sBIT_alpha  = {8,8,8,0,8};
 	static const rp_image::sBIT_t sBIT_opaque = {8,8,8,0,0};
@@ -103,7 +569,7 @@ rp_image *fromPVRTC(int width, int height,
  * @param width Image width.
  * @param height Image height.
  * @param img_buf PVRTC image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)/4]
+ * @param img_siz Size of image data. [must be >= calcPVRTCImageSize()]
  * @param mode Mode bitfield. (See PVRTC_Mode_e.)
  * @return rp_image, or nullptr on error.
  */
@@ -119,44 +585,36 @@ rp_image *fromPVRTCII(int width, int height,
 	// PVRTC-II uses 4x4 tiles (4bpp) or 8x4 tiles (2bpp), but
 	// PVRTC-II allows the last tile to be cut off, so round
 	// up for the physical tile size.
+	// The PowerVR Native SDK also uses a minimum of 2x2 words.
+	const bool is2bpp = ((mode & PVRTC_BPP_MASK) == PVRTC_2BPP);
 	int physWidth;
-	if ((mode & PVRTC_BPP_MASK) == PVRTC_2BPP) {
-		physWidth = ALIGN_BYTES(8, width);
+	if (is2bpp) {
+		physWidth = std::max(ALIGN_BYTES(8, width), PVRTC_MIN_WIDTH_2BPP);
 	} else {
-		physWidth = ALIGN_BYTES(4, width);
+		physWidth = std::max(ALIGN_BYTES(4, width), PVRTC_MIN_WIDTH_4BPP);
 	}
-	const int physHeight = ALIGN_BYTES(4, height);
+	const int physHeight = std::max(ALIGN_BYTES(4, height), PVRTC_MIN_HEIGHT);
 
-	// Expected size to be read by the PowerVR Native SDK.
-	const uint32_t expected_size_in = ((physWidth * physHeight) /
-		(((mode & PVRTC_BPP_MASK) == PVRTC_2BPP) ? 4 : 2));
+	// Expected size of the image data.
+	const int expected_size_in = static_cast<int>(calcPVRTCImageSize(width, height, mode));
 
-	assert(img_siz >= static_cast<int>(expected_size_in));
+	assert(img_siz >= expected_size_in);
 	if (!img_buf || width <= 0 || height <= 0 ||
-	    img_siz < static_cast<int>(expected_size_in))
+	    img_siz < expected_size_in)
 	{
 		return nullptr;
 	}
 
 	// Create an rp_image.
-	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	rp_image *const img = new rp_image(physWidth, physHeight, rp_image::Format::ARGB32);
 	if (!img->isValid()) {
 		// Could not allocate the image.
 		img->unref();
 		return nullptr;
 	}
 
-	// Use the PowerVR Native SDK to decompress the texture.
-	// Return value is the size of the *input* data that was decompressed.
-	// TODO: Row padding?
-	uint32_t size = pvr::PVRTDecompressPVRTCII(img_buf, ((mode & PVRTC_BPP_MASK) == PVRTC_2BPP),
-		physWidth, physHeight, static_cast<uint8_t*>(img->bits()));
-	assert(size == expected_size_in);
-	if (size != expected_size_in) {
-		// Read error...
-		img->unref();
-		return nullptr;
-	}
+	// Decode the image.
+	decodePVRTC(img, img_buf, (mode & ~PVRTC_TYPE_MASK) | PVRTC_TYPE_II);
 
 	// TODO: If !has_alpha, make sure the alpha channel is all 0xFF.
 
@@ -0,0 +1,152 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_PVRTC.cpp: Image decoding functions. (PVRTC)               *
+ * AVX2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2019-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+
+// AVX2 intrinsics.
+#include <immintrin.h>
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Modulation weights for Color A and Color B.
+ * Indexed by modulation value.
+ */
+static const ALIGNED_VAR(16, int16_t pvrtcModWeights[PVRTC_MOD_PUNCHTHROUGH + 1][8]) = {
+	{8,8,8,8, 0,0,0,0}, {7,7,7,7, 1,1,1,1},
+	{6,6,6,6, 2,2,2,2}, {5,5,5,5, 3,3,3,3},
+	{4,4,4,4, 4,4,4,4}, {3,3,3,3, 5,5,5,5},
+	{2,2,2,2, 6,6,6,6}, {1,1,1,1, 7,7,7,7},
+	{0,0,0,0, 8,8,8,8},
+
+	// PVRTC_MOD_PUNCHTHROUGH
+	{4,4,4,4, 4,4,4,4},
+};
+
+/**
+ * AVX2 implementation of decodePVRTCRow().
+ * Two pixels are processed at once: one pixel per 128-bit lane.
+ * Spans between word centers always have an even number of pixels.
+ * @tparam wordWidth Word width. (4 for 4bpp; 8 for 2bpp)
+ * @param dest		[out] ARGB32 destination row.
+ * @param width		[in] Image width. (must be a multiple of the word width)
+ * @param colorsP	[in] Word colors for the word row above this pixel row.
+ * @param colorsR	[in] Word colors for the word row below this pixel row.
+ * @param j		[in] Vertical distance from the word centers in colorsP. (0-3)
+ * @param mod		[in] Modulation weights. (0-8, or PVRTC_MOD_PUNCHTHROUGH)
+ * @param mode		[in] Mode bitfield. (See PVRTC_Mode_e.)
+ */
+template<int wordWidth>
+static inline void T_decodePVRTCRow_avx2(uint32_t *RESTRICT dest, int width,
+	const int16_t *RESTRICT colorsP, const int16_t *RESTRICT colorsR, int j,
+	const uint8_t *RESTRICT mod, uint8_t mode)
+{
+	// Total bilinear weight is 16 (4bpp) or 32 (2bpp).
+	// RGB is converted from 5-bit to 8-bit, and alpha
+	// is converted from 4-bit to 8-bit.
+	static const int wShift = (wordWidth == 8 ? 5 : 4);
+
+	// Punch-through alpha clears alpha for PVRTC-I,
+	// and clears the entire pixel for PVRTC-II.
+	const uint32_t punchMask = ((mode & PVRTC_TYPE_MASK) == PVRTC_TYPE_II) ? 0 : 0x00FFFFFF;
+	const int xWords = width / wordWidth;
+
+	// Vertical interpolation weights.
+	const __m256i mulP = _mm256_set1_epi16(4 - j);
+	const __m256i mulR = _mm256_set1_epi16(j);
+	const __m256i wWord = _mm256_set1_epi16(wordWidth);
+	// Horizontal position offsets for each lane.
+	const __m256i iLane = _mm256_setr_epi16(0,0,0,0,0,0,0,0, 1,1,1,1,1,1,1,1);
+	// Permutation to move the pixel from each lane into the low 64 bits.
+	const __m256i permIdx = _mm256_setr_epi32(0,4,0,4, 0,4,0,4);
+
+	// Each span of pixels is between the centers of two words.
+	for (int s = -1; s < xWords; s++) {
+		const int wL = ((s >= 0) ? s : (xWords - 1)) * 8;
+		const int wR = ((s + 1 < xWords) ? (s + 1) : 0) * 8;
+
+		// Interpolate the colors vertically.
+		const __m256i vL = _mm256_add_epi16(
+			_mm256_mullo_epi16(_mm256_broadcastsi128_si256(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(&colorsP[wL]))), mulP),
+			_mm256_mullo_epi16(_mm256_broadcastsi128_si256(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(&colorsR[wL]))), mulR));
+		const __m256i vR = _mm256_add_epi16(
+			_mm256_mullo_epi16(_mm256_broadcastsi128_si256(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(&colorsP[wR]))), mulP),
+			_mm256_mullo_epi16(_mm256_broadcastsi128_si256(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(&colorsR[wR]))), mulR));
+
+		// Horizontal interpolation: sum = ((wordWidth - i) * vL) + (i * vR)
+		const int iStart = (s >= 0 ? 0 : (wordWidth / 2));
+		const int iEnd = (s + 1 < xWords ? wordWidth : (wordWidth / 2));
+		const __m256i vDiff = _mm256_sub_epi16(vR, vL);
+		const __m256i vDiff2 = _mm256_slli_epi16(vDiff, 1);
+		__m256i sum = _mm256_add_epi16(_mm256_mullo_epi16(vL, wWord),
+			_mm256_mullo_epi16(vDiff, _mm256_add_epi16(_mm256_set1_epi16(iStart), iLane)));
+
+		for (int i = iStart; i < iEnd; i += 2, dest += 2, mod += 2) {
+			// Convert to 8-bit.
+			const __m256i rgb = _mm256_add_epi16(
+				_mm256_srli_epi16(sum, wShift + 2), _mm256_srli_epi16(sum, wShift - 3));
+			const __m256i alpha = _mm256_add_epi16(
+				_mm256_srli_epi16(sum, wShift), _mm256_srli_epi16(sum, wShift - 4));
+			__m256i px = _mm256_blend_epi16(rgb, alpha, 0x88);
+
+			// Blend the colors.
+			const unsigned int m0 = mod[0];
+			const unsigned int m1 = mod[1];
+			const __m256i w = _mm256_inserti128_si256(_mm256_castsi128_si256(
+				_mm_load_si128(reinterpret_cast<const __m128i*>(pvrtcModWeights[m0]))),
+				_mm_load_si128(reinterpret_cast<const __m128i*>(pvrtcModWeights[m1])), 1);
+			px = _mm256_mullo_epi16(px, w);
+			px = _mm256_add_epi16(px, _mm256_srli_si256(px, 8));
+			px = _mm256_srli_epi16(px, 3);
+			px = _mm256_packus_epi16(px, px);
+			px = _mm256_permutevar8x32_epi32(px, permIdx);
+
+			const __m128i keep = _mm_setr_epi32(
+				(m0 == PVRTC_MOD_PUNCHTHROUGH ? punchMask : 0xFFFFFFFF),
+				(m1 == PVRTC_MOD_PUNCHTHROUGH ? punchMask : 0xFFFFFFFF), 0, 0);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dest),
+				_mm_and_si128(_mm256_castsi256_si128(px), keep));
+			sum = _mm256_add_epi16(sum, vDiff2);
+		}
+	}
+}
+
+/**
+ * Decode a single pixel row of a PVRTC or PVRTC-II image.
+ * AVX2-optimized version.
+ *
+ * Each word has eight int16_t color components:
+ * Color A {B,G,R,A}, followed by Color B {B,G,R,A}.
+ * RGB components are 5-bit; alpha components are 4-bit.
+ *
+ * @param dest		[out] ARGB32 destination row.
+ * @param width		[in] Image width. (must be a multiple of the word width)
+ * @param colorsP	[in] Word colors for the word row above this pixel row.
+ * @param colorsR	[in] Word colors for the word row below this pixel row.
+ * @param j		[in] Vertical distance from the word centers in colorsP. (0-3)
+ * @param mod		[in] Modulation weights. (0-8, or PVRTC_MOD_PUNCHTHROUGH)
+ * @param mode		[in] Mode bitfield. (See PVRTC_Mode_e.)
+ */
+void decodePVRTCRow_avx2(uint32_t *RESTRICT dest, int width,
+	const int16_t *RESTRICT colorsP, const int16_t *RESTRICT colorsR, int j,
+	const uint8_t *RESTRICT mod, uint8_t mode)
+{
+	if ((mode & PVRTC_BPP_MASK) == PVRTC_2BPP) {
+		T_decodePVRTCRow_avx2<8>(dest, width, colorsP, colorsR, j, mod, mode);
+	} else {
+		T_decodePVRTCRow_avx2<4>(dest, width, colorsP, colorsR, j, mod, mode);
+	}
+}
+
+} }
@@ -0,0 +1,135 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_PVRTC.cpp: Image decoding functions. (PVRTC)               *
+ * SSE4.1-optimized version.                                               *
+ *                                                                         *
+ * Copyright (c) 2019-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+
+// SSE4.1 headers.
+#include <emmintrin.h>
+#include <smmintrin.h>
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Modulation weights for Color A and Color B.
+ * Indexed by modulation value.
+ */
+static const ALIGNED_VAR(16, int16_t pvrtcModWeights[PVRTC_MOD_PUNCHTHROUGH + 1][8]) = {
+	{8,8,8,8, 0,0,0,0}, {7,7,7,7, 1,1,1,1},
+	{6,6,6,6, 2,2,2,2}, {5,5,5,5, 3,3,3,3},
+	{4,4,4,4, 4,4,4,4}, {3,3,3,3, 5,5,5,5},
+	{2,2,2,2, 6,6,6,6}, {1,1,1,1, 7,7,7,7},
+	{0,0,0,0, 8,8,8,8},
+
+	// PVRTC_MOD_PUNCHTHROUGH
+	{4,4,4,4, 4,4,4,4},
+};
+
+/**
+ * SSE4.1 implementation of decodePVRTCRow().
+ * Each pixel's Color A and Color B are processed in a single register.
+ * @tparam wordWidth Word width. (4 for 4bpp; 8 for 2bpp)
+ * @param dest		[out] ARGB32 destination row.
+ * @param width		[in] Image width. (must be a multiple of the word width)
+ * @param colorsP	[in] Word colors for the word row above this pixel row.
+ * @param colorsR	[in] Word colors for the word row below this pixel row.
+ * @param j		[in] Vertical distance from the word centers in colorsP. (0-3)
+ * @param mod		[in] Modulation weights. (0-8, or PVRTC_MOD_PUNCHTHROUGH)
+ * @param mode		[in] Mode bitfield. (See PVRTC_Mode_e.)
+ */
+template<int wordWidth>
+static inline void T_decodePVRTCRow_sse41(uint32_t *RESTRICT dest, int width,
+	const int16_t *RESTRICT colorsP, const int16_t *RESTRICT colorsR, int j,
+	const uint8_t *RESTRICT mod, uint8_t mode)
+{
+	// Total bilinear weight is 16 (4bpp) or 32 (2bpp).
+	// RGB is converted from 5-bit to 8-bit, and alpha
+	// is converted from 4-bit to 8-bit.
+	static const int wShift = (wordWidth == 8 ? 5 : 4);
+
+	// Punch-through alpha clears alpha for PVRTC-I,
+	// and clears the entire pixel for PVRTC-II.
+	const uint32_t punchMask = ((mode & PVRTC_TYPE_MASK) == PVRTC_TYPE_II) ? 0 : 0x00FFFFFF;
+	const int xWords = width / wordWidth;
+
+	// Vertical interpolation weights.
+	const __m128i mulP = _mm_set1_epi16(4 - j);
+	const __m128i mulR = _mm_set1_epi16(j);
+	const __m128i wWord = _mm_set1_epi16(wordWidth);
+
+	// Each span of pixels is between the centers of two words.
+	for (int s = -1; s < xWords; s++) {
+		const int wL = ((s >= 0) ? s : (xWords - 1)) * 8;
+		const int wR = ((s + 1 < xWords) ? (s + 1) : 0) * 8;
+
+		// Interpolate the colors vertically.
+		const __m128i vL = _mm_add_epi16(
+			_mm_mullo_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&colorsP[wL])), mulP),
+			_mm_mullo_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&colorsR[wL])), mulR));
+		const __m128i vR = _mm_add_epi16(
+			_mm_mullo_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&colorsP[wR])), mulP),
+			_mm_mullo_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&colorsR[wR])), mulR));
+
+		// Horizontal interpolation: sum = ((wordWidth - i) * vL) + (i * vR)
+		const int iStart = (s >= 0 ? 0 : (wordWidth / 2));
+		const int iEnd = (s + 1 < xWords ? wordWidth : (wordWidth / 2));
+		const __m128i vDiff = _mm_sub_epi16(vR, vL);
+		__m128i sum = _mm_add_epi16(_mm_mullo_epi16(vL, wWord),
+			_mm_mullo_epi16(vDiff, _mm_set1_epi16(iStart)));
+
+		for (int i = iStart; i < iEnd; i++, dest++, mod++) {
+			// Convert to 8-bit.
+			const __m128i rgb = _mm_add_epi16(
+				_mm_srli_epi16(sum, wShift + 2), _mm_srli_epi16(sum, wShift - 3));
+			const __m128i alpha = _mm_add_epi16(
+				_mm_srli_epi16(sum, wShift), _mm_srli_epi16(sum, wShift - 4));
+			__m128i px = _mm_blend_epi16(rgb, alpha, 0x88);
+
+			// Blend the colors.
+			const unsigned int m = *mod;
+			px = _mm_mullo_epi16(px, _mm_load_si128(reinterpret_cast<const __m128i*>(pvrtcModWeights[m])));
+			px = _mm_add_epi16(px, _mm_srli_si128(px, 8));
+			px = _mm_srli_epi16(px, 3);
+			px = _mm_packus_epi16(px, px);
+
+			*dest = static_cast<uint32_t>(_mm_cvtsi128_si32(px)) &
+				(m == PVRTC_MOD_PUNCHTHROUGH ? punchMask : 0xFFFFFFFF);
+			sum = _mm_add_epi16(sum, vDiff);
+		}
+	}
+}
+
+/**
+ * Decode a single pixel row of a PVRTC or PVRTC-II image.
+ * SSE4.1-optimized version.
+ *
+ * Each word has eight int16_t color components:
+ * Color A {B,G,R,A}, followed by Color B {B,G,R,A}.
+ * RGB components are 5-bit; alpha components are 4-bit.
+ *
+ * @param dest		[out] ARGB32 destination row.
+ * @param width		[in] Image width. (must be a multiple of the word width)
+ * @param colorsP	[in] Word colors for the word row above this pixel row.
+ * @param colorsR	[in] Word colors for the word row below this pixel row.
+ * @param j		[in] Vertical distance from the word centers in colorsP. (0-3)
+ * @param mod		[in] Modulation weights. (0-8, or PVRTC_MOD_PUNCHTHROUGH)
+ * @param mode		[in] Mode bitfield. (See PVRTC_Mode_e.)
+ */
+void decodePVRTCRow_sse41(uint32_t *RESTRICT dest, int width,
+	const int16_t *RESTRICT colorsP, const int16_t *RESTRICT colorsR, int j,
+	const uint8_t *RESTRICT mod, uint8_t mode)
+{
+	if ((mode & PVRTC_BPP_MASK) == PVRTC_2BPP) {
+		T_decodePVRTCRow_sse41<8>(dest, width, colorsP, colorsR, j, mod, mode);
+	} else {
+		T_decodePVRTCRow_sse41<4>(dest, width, colorsP, colorsR, j, mod, mode);
+	}
+}
+
+} }
@@ -17,23 +17,33 @@ using namespace LibRpTexture;
 // IFUNC attribute doesn't support C++ name mangling.
 extern "C" {
 
-#ifndef IMAGEDECODER_ALWAYS_HAS_SSE2
 /**
  * IFUNC resolver function for fromLinear16().
  * @return Function pointer.
  */
 static __typeof__(&ImageDecoder::fromLinear16_cpp) fromLinear16_resolve(void)
 {
-#ifdef IMAGEDECODER_HAS_SSE2
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::fromLinear16_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
+#ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
+	{
+		// amd64 always has SSE2.
+		return &ImageDecoder::fromLinear16_sse2;
+	}
+#else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
+# ifdef IMAGEDECODER_HAS_SSE2
 	if (RP_CPU_HasSSE2()) {
 		return &ImageDecoder::fromLinear16_sse2;
 	} else
-#endif /* IMAGEDECODER_HAS_SSE2 */
+# endif /* IMAGEDECODER_HAS_SSE2 */
 	{
 		return &ImageDecoder::fromLinear16_cpp;
 	}
-}
 #endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+}
 
 /**
  * IFUNC resolver function for fromLinear24().
@@ -41,6 +51,11 @@ static __typeof__(&ImageDecoder::fromLinear16_cpp) fromLinear16_resolve(void)
  */
 static __typeof__(&ImageDecoder::fromLinear24_cpp) fromLinear24_resolve(void)
 {
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::fromLinear24_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
 #ifdef IMAGEDECODER_HAS_SSSE3
 	if (RP_CPU_HasSSSE3()) {
 		return &ImageDecoder::fromLinear24_ssse3;
@@ -57,6 +72,11 @@ static __typeof__(&ImageDecoder::fromLinear24_cpp) fromLinear24_resolve(void)
  */
 static __typeof__(&ImageDecoder::fromLinear32_cpp) fromLinear32_resolve(void)
 {
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::fromLinear32_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
 #ifdef IMAGEDECODER_HAS_SSSE3
 	if (RP_CPU_HasSSSE3()) {
 		return &ImageDecoder::fromLinear32_ssse3;
@@ -67,14 +87,143 @@ static __typeof__(&ImageDecoder::fromLinear32_cpp) fromLinear32_resolve(void)
 	}
 }
 
+/**
+ * IFUNC resolver function for fromGcn16().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromGcn16_cpp) fromGcn16_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::fromGcn16_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromGcn16_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromGcn16_cpp;
+	}
 }
 
+/**
+ * IFUNC resolver function for expandCI8toARGB32().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::expandCI8toARGB32_cpp) expandCI8toARGB32_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::expandCI8toARGB32_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::expandCI8toARGB32_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::expandCI8toARGB32_cpp;
+	}
+}
+
+#ifdef ENABLE_PVRTC
+/**
+ * IFUNC resolver function for decodePVRTCRow().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::decodePVRTCRow_cpp) decodePVRTCRow_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::decodePVRTCRow_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
+#ifdef IMAGEDECODER_HAS_SSE41
+	if (RP_CPU_HasSSE41()) {
+		return &ImageDecoder::decodePVRTCRow_sse41;
+	} else
+#endif /* IMAGEDECODER_HAS_SSE41 */
+	{
+		return &ImageDecoder::decodePVRTCRow_cpp;
+	}
+}
+#endif /* ENABLE_PVRTC */
+
 #ifndef IMAGEDECODER_ALWAYS_HAS_SSE2
+/**
+ * IFUNC resolver function for fromN3DSTiledRGB565().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromN3DSTiledRGB565_cpp) fromN3DSTiledRGB565_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return &ImageDecoder::fromN3DSTiledRGB565_sse2;
+	} else
+#endif /* IMAGEDECODER_HAS_SSE2 */
+	{
+		return &ImageDecoder::fromN3DSTiledRGB565_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromN3DSTiledRGB565_A4().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromN3DSTiledRGB565_A4_cpp) fromN3DSTiledRGB565_A4_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return &ImageDecoder::fromN3DSTiledRGB565_A4_sse2;
+	} else
+#endif /* IMAGEDECODER_HAS_SSE2 */
+	{
+		return &ImageDecoder::fromN3DSTiledRGB565_A4_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromDreamcastSquareTwiddled16().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromDreamcastSquareTwiddled16_cpp) fromDreamcastSquareTwiddled16_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return &ImageDecoder::fromDreamcastSquareTwiddled16_sse2;
+	} else
+#endif /* IMAGEDECODER_HAS_SSE2 */
+	{
+		return &ImageDecoder::fromDreamcastSquareTwiddled16_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromDreamcastVQ16().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromDreamcastVQ16_cpp) fromDreamcastVQ16_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return &ImageDecoder::fromDreamcastVQ16_sse2;
+	} else
+#endif /* IMAGEDECODER_HAS_SSE2 */
+	{
+		return &ImageDecoder::fromDreamcastVQ16_cpp;
+	}
+}
+#endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+
+}
+
 rp_image *ImageDecoder::fromLinear16(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *img_buf, int img_siz, int stride)
 	IFUNC_ATTR(fromLinear16_resolve);
-#endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
 
 rp_image *ImageDecoder::fromLinear24(PixelFormat px_format,
 	int width, int height,
@@ -86,4 +235,44 @@ rp_image *ImageDecoder::fromLinear32(PixelFormat px_format,
 	const uint32_t *img_buf, int img_siz, int stride)
 	IFUNC_ATTR(fromLinear32_resolve);
 
+rp_image *ImageDecoder::fromGcn16(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *img_buf, int img_siz)
+	IFUNC_ATTR(fromGcn16_resolve);
+
+void ImageDecoder::expandCI8toARGB32(uint32_t *dest, int dest_stride,
+	const uint8_t *src, int src_stride,
+	int width, int height, const uint32_t *palette)
+	IFUNC_ATTR(expandCI8toARGB32_resolve);
+
+#ifdef ENABLE_PVRTC
+void ImageDecoder::decodePVRTCRow(uint32_t *dest, int width,
+	const int16_t *colorsP, const int16_t *colorsR, int j,
+	const uint8_t *mod, uint8_t mode)
+	IFUNC_ATTR(decodePVRTCRow_resolve);
+#endif /* ENABLE_PVRTC */
+
+#ifndef IMAGEDECODER_ALWAYS_HAS_SSE2
+rp_image *ImageDecoder::fromN3DSTiledRGB565(int width, int height,
+	const uint16_t *img_buf, int img_siz)
+	IFUNC_ATTR(fromN3DSTiledRGB565_resolve);
+
+rp_image *ImageDecoder::fromN3DSTiledRGB565_A4(int width, int height,
+	const uint16_t *img_buf, int img_siz,
+	const uint8_t *alpha_buf, int alpha_siz)
+	IFUNC_ATTR(fromN3DSTiledRGB565_A4_resolve);
+
+rp_image *ImageDecoder::fromDreamcastSquareTwiddled16(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *img_buf, int img_siz)
+	IFUNC_ATTR(fromDreamcastSquareTwiddled16_resolve);
+
+rp_image *ImageDecoder::fromDreamcastVQ16(PixelFormat px_format,
+	bool smallVQ, bool hasMipmaps,
+	int width, int height,
+	const uint8_t *img_buf, int img_siz,
+	const uint16_t *pal_buf, int pal_siz)
+	IFUNC_ATTR(fromDreamcastVQ16_resolve);
+#endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+
 #endif /* RP_HAS_IFUNC */
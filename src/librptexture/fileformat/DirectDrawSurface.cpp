@@ -555,12 +555,16 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 #ifdef ENABLE_PVRTC
 			case DXGI_FORMAT_FAKE_PVRTC_2bpp:
 				// 32 pixels compressed into 64 bits. (2bpp)
-				expected_size = (ddsHeader.dwWidth * ddsHeader.dwHeight) / 4;
+				// NOTE: Width and height are rounded up to a minimum of 2x2 words. (8x4)
+				expected_size = ImageDecoder::calcPVRTCImageSize(
+					ddsHeader.dwWidth, ddsHeader.dwHeight, ImageDecoder::PVRTC_2BPP);
 				break;
 
 			case DXGI_FORMAT_FAKE_PVRTC_4bpp:
 				// 16 pixels compressed into 64 bits. (4bpp)
-				expected_size = (ddsHeader.dwWidth * ddsHeader.dwHeight) / 2;
+				// NOTE: Width and height are rounded up to a minimum of 2x2 words. (4x4)
+				expected_size = ImageDecoder::calcPVRTCImageSize(
+					ddsHeader.dwWidth, ddsHeader.dwHeight, ImageDecoder::PVRTC_4BPP);
 				break;
 #endif /* ENABLE_PVRTC */
 
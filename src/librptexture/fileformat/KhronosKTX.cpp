@@ -199,27 +199,20 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 #ifdef ENABLE_PVRTC
 				case GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG:
 				case GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG:
-					// 32 pixels compressed into 64 bits. (2bpp)
-					expected_size = (ktxHeader.pixelWidth * height) / 4;
-					break;
-
 				case GL_COMPRESSED_RGBA_PVRTC_2BPPV2_IMG:
 					// 32 pixels compressed into 64 bits. (2bpp)
-					// NOTE: Width and height must be rounded to the nearest tile. (8x4)
-					expected_size = ALIGN_BYTES(8, ktxHeader.pixelWidth) *
-					                ALIGN_BYTES(4, (int)height) / 4;
+					// NOTE: Width and height are rounded up to a minimum of 2x2 words. (8x4)
+					expected_size = ImageDecoder::calcPVRTCImageSize(
+						ktxHeader.pixelWidth, height, ImageDecoder::PVRTC_2BPP);
 					break;
 
 				case GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG:
 				case GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG:
-					// 16 pixels compressed into 64 bits. (4bpp)
-					expected_size = (ktxHeader.pixelWidth * height) / 2;
-					break;
-
 				case GL_COMPRESSED_RGBA_PVRTC_4BPPV2_IMG:
-					// NOTE: Width and height must be rounded to the nearest tile. (4x4)
-					expected_size = ALIGN_BYTES(4, ktxHeader.pixelWidth) *
-					                ALIGN_BYTES(4, (int)height) / 2;
+					// 16 pixels compressed into 64 bits. (4bpp)
+					// NOTE: Width and height are rounded up to a minimum of 2x2 words. (4x4)
+					expected_size = ImageDecoder::calcPVRTCImageSize(
+						ktxHeader.pixelWidth, height, ImageDecoder::PVRTC_4BPP);
 					break;
 #endif /* ENABLE_PVRTC */
 
@@ -253,30 +253,20 @@ const rp_image *KhronosKTX2Private::loadImage(int mip)
 #ifdef ENABLE_PVRTC
 		case VK_FORMAT_PVRTC1_2BPP_UNORM_BLOCK_IMG:
 		case VK_FORMAT_PVRTC1_2BPP_SRGB_BLOCK_IMG:
-			// 32 pixels compressed into 64 bits. (2bpp)
-			expected_size = (width * height) / 4;
-			break;
-
 		case VK_FORMAT_PVRTC2_2BPP_UNORM_BLOCK_IMG:
 		case VK_FORMAT_PVRTC2_2BPP_SRGB_BLOCK_IMG:
 			// 32 pixels compressed into 64 bits. (2bpp)
-			// NOTE: Width and height must be rounded to the nearest tile. (8x4)
-			expected_size = ALIGN_BYTES(8, width) *
-			                ALIGN_BYTES(4, height) / 4;
+			// NOTE: Width and height are rounded up to a minimum of 2x2 words. (8x4)
+			expected_size = ImageDecoder::calcPVRTCImageSize(width, height, ImageDecoder::PVRTC_2BPP);
 			break;
 
 		case VK_FORMAT_PVRTC1_4BPP_UNORM_BLOCK_IMG:
 		case VK_FORMAT_PVRTC1_4BPP_SRGB_BLOCK_IMG:
-			// 16 pixels compressed into 64 bits. (4bpp)
-			expected_size = (width * height) / 2;
-			break;
-
 		case VK_FORMAT_PVRTC2_4BPP_UNORM_BLOCK_IMG:
 		case VK_FORMAT_PVRTC2_4BPP_SRGB_BLOCK_IMG:
 			// 16 pixels compressed into 64 bits. (4bpp)
-			// NOTE: Width and height must be rounded to the nearest tile. (8x4)
-			expected_size = ALIGN_BYTES(4, width) *
-			                ALIGN_BYTES(4, height) / 2;
+			// NOTE: Width and height are rounded up to a minimum of 2x2 words. (4x4)
+			expected_size = ImageDecoder::calcPVRTCImageSize(width, height, ImageDecoder::PVRTC_4BPP);
 			break;
 #endif /* ENABLE_PVRTC */
 
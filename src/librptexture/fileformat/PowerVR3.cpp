@@ -318,28 +318,18 @@ const rp_image *PowerVR3Private::loadImage(int mip)
 #ifdef ENABLE_PVRTC
 			case PVR3_PXF_PVRTC_2bpp_RGB:
 			case PVR3_PXF_PVRTC_2bpp_RGBA:
-				// 2bpp formats (PVRTC)
-				expected_size = width * height / 4;
-				break;
-
 			case PVR3_PXF_PVRTCII_2bpp:
-				// 2bpp formats (PVRTC-II)
-				// NOTE: Width and height must be rounded to the nearest tile. (8x4)
-				expected_size = ALIGN_BYTES(8, width) *
-				                ALIGN_BYTES(4, height) / 4;
+				// 2bpp formats (PVRTC, PVRTC-II)
+				// NOTE: Width and height are rounded up to a minimum of 2x2 words. (8x4)
+				expected_size = ImageDecoder::calcPVRTCImageSize(width, height, ImageDecoder::PVRTC_2BPP);
 				break;
 
 			case PVR3_PXF_PVRTC_4bpp_RGB:
 			case PVR3_PXF_PVRTC_4bpp_RGBA:
-				// 4bpp formats (PVRTC)
-				expected_size = width * height / 2;
-				break;
-
 			case PVR3_PXF_PVRTCII_4bpp:
-				// 4bpp formats (PVRTC-II)
-				// NOTE: Width and height must be rounded to the nearest tile. (4x4)
-				expected_size = ALIGN_BYTES(4, width) *
-				                ALIGN_BYTES(4, height) / 2;
+				// 4bpp formats (PVRTC, PVRTC-II)
+				// NOTE: Width and height are rounded up to a minimum of 2x2 words. (4x4)
+				expected_size = ImageDecoder::calcPVRTCImageSize(width, height, ImageDecoder::PVRTC_4BPP);
 				break;
 #endif /* ENABLE_PVRTC */
 
@@ -10,6 +10,7 @@
 #include "rp_image.hpp"
 #include "rp_image_p.hpp"
 #include "rp_image_backend.hpp"
+#include "rp_image_pool.hpp"
 
 // Workaround for RP_D() expecting the no-underscore, UpperCamelCase naming convention.
 #define rp_imagePrivate rp_image_private
@@ -71,6 +72,7 @@ class rp_image_backend_default : public rp_image_backend
 	private:
 		void *m_data;
 		size_t m_data_len;
+		size_t m_data_alloc_len;	// Original m_data_len, for the pool.
 
 		uint32_t *m_palette;
 		int m_palette_len;
@@ -80,6 +82,7 @@ rp_image_backend_default::rp_image_backend_default(int width, int height, rp_ima
 	: super(width, height, format)
 	, m_data(nullptr)
 	, m_data_len(0)
+	, m_data_alloc_len(0)
 	, m_palette(nullptr)
 	, m_palette_len(0)
 {
@@ -100,13 +103,16 @@ rp_image_backend_default::rp_image_backend_default(int width, int height, rp_ima
 		return;
 	}
 
-	m_data = aligned_malloc(16, m_data_len);
+	// NOTE: Buffers are pooled to reduce allocator churn
+	// when processing many images of similar sizes.
+	m_data = rp_image_pool::allocate(m_data_len);
 	assert(m_data != nullptr);
 	if (!m_data) {
 		// Failed to allocate memory.
 		clear_properties();
 		return;
 	}
+	m_data_alloc_len = m_data_len;
 
 	// Do we need to allocate memory for the palette?
 	if (format == rp_image::Format::CI8) {
@@ -114,12 +120,13 @@ rp_image_backend_default::rp_image_backend_default(int width, int height, rp_ima
 		// there's no weird artifacts if the caller
 		// is converting a lower-color image.
 		const size_t palette_sz = 256*sizeof(*m_palette);
-		m_palette = static_cast<uint32_t*>(aligned_malloc(16, palette_sz));
+		m_palette = static_cast<uint32_t*>(rp_image_pool::allocate(palette_sz));
 		if (!m_palette) {
 			// Failed to allocate memory.
-			aligned_free(m_data);
+			rp_image_pool::deallocate(m_data, m_data_alloc_len);
 			m_data = nullptr;
 			m_data_len = 0;
+			m_data_alloc_len = 0;
 			clear_properties();
 			return;
 		}
@@ -132,8 +139,8 @@ rp_image_backend_default::rp_image_backend_default(int width, int height, rp_ima
 
 rp_image_backend_default::~rp_image_backend_default()
 {
-	aligned_free(m_data);
-	aligned_free(m_palette);
+	rp_image_pool::deallocate(m_data, m_data_alloc_len);
+	rp_image_pool::deallocate(m_palette, m_palette_len * sizeof(*m_palette));
 }
 
 /**
@@ -23,6 +23,7 @@
 # include "librpcpu/cpuflags_x86.h"
 # define RP_IMAGE_HAS_SSE2 1
 # define RP_IMAGE_HAS_SSE41 1
+# define RP_IMAGE_HAS_AVX2 1
 #endif
 #ifdef RP_CPU_AMD64
 # define RP_IMAGE_ALWAYS_HAS_SSE2 1
@@ -408,6 +409,18 @@ class rp_image : public RefBase
 		int un_premultiply_sse41(void);
 #endif /* RP_IMAGE_HAS_SSE41 */
 
+#ifdef RP_IMAGE_HAS_AVX2
+		/**
+		 * Un-premultiply this image.
+		 * AVX2-optimized version.
+		 *
+		 * Image must be ARGB32.
+		 *
+		 * @return 0 on success; non-zero on error.
+		 */
+		int un_premultiply_avx2(void);
+#endif /* RP_IMAGE_HAS_AVX2 */
+
 		/**
 		 * Un-premultiply this image.
 		 *
@@ -463,6 +476,22 @@ class rp_image : public RefBase
 		int apply_chroma_key_sse2(uint32_t key);
 #endif /* RP_IMAGE_HAS_SSE2 */
 
+#ifdef RP_IMAGE_HAS_AVX2
+		/**
+		 * Convert a chroma-keyed image to standard ARGB32.
+		 * AVX2-optimized version.
+		 *
+		 * This operates on the image itself, and does not return
+		 * a duplicated image with the adjusted image.
+		 *
+		 * NOTE: The image *must* be ARGB32.
+		 *
+		 * @param key Chroma key color.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int apply_chroma_key_avx2(uint32_t key);
+#endif /* RP_IMAGE_HAS_AVX2 */
+
 		/**
 		 * Convert a chroma-keyed image to standard ARGB32.
 		 *
@@ -513,6 +542,11 @@ class rp_image : public RefBase
 inline int rp_image::un_premultiply(void)
 {
 	// FIXME: Figure out how to get IFUNC working with  C++ member functions.
+#ifdef RP_IMAGE_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return un_premultiply_avx2();
+	} else
+#endif /* RP_IMAGE_HAS_AVX2 */
 #ifdef RP_IMAGE_HAS_SSE41
 	if (RP_CPU_HasSSE41()) {
 		return un_premultiply_sse41();
@@ -537,6 +571,11 @@ inline int rp_image::un_premultiply(void)
 inline int rp_image::apply_chroma_key(uint32_t key)
 {
 	// FIXME: Figure out how to get IFUNC working with  C++ member functions.
+#ifdef RP_IMAGE_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return apply_chroma_key_avx2(key);
+	}
+#endif /* RP_IMAGE_HAS_AVX2 */
 #if defined(RP_IMAGE_ALWAYS_HAS_SSE2)
 	// amd64 always has SSE2.
 	return apply_chroma_key_sse2(key);
@@ -11,6 +11,9 @@
 #include "rp_image_p.hpp"
 #include "rp_image_backend.hpp"
 
+// CI8 -> ARGB32 expansion
+#include "../decoder/ImageDecoder.hpp"
+
 // Workaround for RP_D() expecting the no-underscore, UpperCamelCase naming convention.
 #define rp_imagePrivate rp_image_private
 
@@ -114,34 +117,9 @@ rp_image *rp_image::dup_ARGB32(void) const
 	}
 
 	// Copy the image, converting from CI8 to ARGB32.
-	uint32_t *dest = static_cast<uint32_t*>(img->bits());
-	const uint8_t *src = static_cast<const uint8_t*>(backend->data());
-	const uint32_t *pal = backend->palette();
-	const int dest_adj = (img->stride() / 4) - width;
-	const int src_adj = backend->stride - width;
-
-	for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
-		// Convert up to 4 pixels per loop iteration.
-		unsigned int x;
-		for (x = static_cast<unsigned int>(width); x > 3; x -= 4) {
-			dest[0] = pal[src[0]];
-			dest[1] = pal[src[1]];
-			dest[2] = pal[src[2]];
-			dest[3] = pal[src[3]];
-			dest += 4;
-			src += 4;
-		}
-		// Remaining pixels.
-		for (; x > 0; x--) {
-			*dest = pal[*src];
-			dest++;
-			src++;
-		}
-
-		// Next line.
-		dest += dest_adj;
-		src += src_adj;
-	}
+	ImageDecoder::expandCI8toARGB32(static_cast<uint32_t*>(img->bits()), img->stride(),
+		static_cast<const uint8_t*>(backend->data()), backend->stride,
+		width, height, backend->palette());
 
 	// Copy sBIT if it's set.
 	if (d->has_sBIT) {
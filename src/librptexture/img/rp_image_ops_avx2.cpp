@@ -0,0 +1,95 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_ops.cpp: Image class. (operations)                             *
+ * AVX2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+#include "rp_image_p.hpp"
+#include "rp_image_backend.hpp"
+
+// AVX2 intrinsics.
+#include <immintrin.h>
+
+// Workaround for RP_D() expecting the no-underscore, UpperCamelCase naming convention.
+#define rp_imagePrivate rp_image_private
+
+namespace LibRpTexture {
+
+/** Image operations. **/
+
+/**
+ * Convert a chroma-keyed image to standard ARGB32.
+ * AVX2-optimized version.
+ *
+ * This operates on the image itself, and does not return
+ * a duplicated image with the adjusted image.
+ *
+ * NOTE: The image *must* be ARGB32.
+ *
+ * @param key Chroma key color.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int rp_image::apply_chroma_key_avx2(uint32_t key)
+{
+	RP_D(rp_image);
+	rp_image_backend *const backend = d->backend;
+	assert(backend->format == Format::ARGB32);
+	if (backend->format != Format::ARGB32) {
+		// ARGB32 only.
+		return -EINVAL;
+	}
+
+	const unsigned int diff = (backend->stride - this->row_bytes()) / sizeof(uint32_t);
+	uint32_t *img_buf = static_cast<uint32_t*>(backend->data());
+
+	// AVX2 constants.
+	const __m256i ymm_key = _mm256_set1_epi32(key);
+
+	for (unsigned int y = static_cast<unsigned int>(backend->height); y > 0; y--) {
+		// Process 16 pixels per iteration with AVX2.
+		// NOTE: rp_image rows are only guaranteed to have
+		// 16-byte alignment, so unaligned loads are used.
+		unsigned int x = static_cast<unsigned int>(backend->width);
+		for (; x > 15; x -= 16, img_buf += 16) {
+			__m256i *ymm_data = reinterpret_cast<__m256i*>(img_buf);
+			__m256i px0 = _mm256_loadu_si256(&ymm_data[0]);
+			__m256i px1 = _mm256_loadu_si256(&ymm_data[1]);
+
+			// Compare the pixels to the chroma key.
+			// Equal values will be 0xFFFFFFFF.
+			// Non-equal values will be 0x00000000.
+			// Then, clear the chroma-keyed pixels.
+			px0 = _mm256_andnot_si256(_mm256_cmpeq_epi32(px0, ymm_key), px0);
+			px1 = _mm256_andnot_si256(_mm256_cmpeq_epi32(px1, ymm_key), px1);
+
+			_mm256_storeu_si256(&ymm_data[0], px0);
+			_mm256_storeu_si256(&ymm_data[1], px1);
+		}
+
+		// Remaining pixels.
+		for (; x > 0; x--, img_buf++) {
+			if (*img_buf == key) {
+				*img_buf = 0;
+			}
+		}
+
+		// Next row.
+		img_buf += diff;
+	}
+
+	// Adjust sBIT.
+	// TODO: Only if transparent pixels were found.
+	if (d->has_sBIT && d->sBIT.alpha == 0) {
+		d->sBIT.alpha = 1;
+	}
+
+	// Chroma key applied.
+	return 0;
+}
+
+}
@@ -0,0 +1,286 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_pool.cpp: Pooled allocator for rp_image pixel buffers.         *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image_pool.hpp"
+
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+#include "librpthreads/pthread_once.h"
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+
+namespace LibRpTexture {
+
+const size_t rp_image_pool::ALIGNMENT;
+const size_t rp_image_pool::MIN_POOLED_SIZE;
+const size_t rp_image_pool::MAX_POOLED_SIZE;
+const unsigned int rp_image_pool::SIZE_CLASS_COUNT;
+const unsigned int rp_image_pool::MAX_CACHED_PER_CLASS;
+const size_t rp_image_pool::MAX_CACHED_BYTES;
+
+class rp_image_pool_private
+{
+	public:
+		rp_image_pool_private();
+
+	private:
+		RP_DISABLE_COPY(rp_image_pool_private)
+
+	public:
+		/**
+		 * Release all cached buffers.
+		 * Mutex must be locked by the caller.
+		 */
+		void clear_int(void);
+
+	public:
+		Mutex mutex;
+		bool enabled;
+
+		// Free lists, one per size class.
+		void *buffers[rp_image_pool::SIZE_CLASS_COUNT][rp_image_pool::MAX_CACHED_PER_CLASS];
+		uint8_t count[rp_image_pool::SIZE_CLASS_COUNT];
+
+		// Statistics.
+		rp_image_pool::Stats stats;
+};
+
+// Pool singleton.
+// NOTE: This is intentionally never deleted, since rp_images
+// may be destroyed by other static destructors at exit.
+static rp_image_pool_private *pool = nullptr;
+
+// pthread_once() control variable.
+static pthread_once_t once_control = PTHREAD_ONCE_INIT;
+
+/**
+ * Initialize the pool singleton.
+ * This function MUST be called using pthread_once().
+ */
+static void initPool(void)
+{
+	pool = new rp_image_pool_private();
+}
+
+/**
+ * Get the pool singleton.
+ * @return Pool singleton.
+ */
+static inline rp_image_pool_private *getPool(void)
+{
+	pthread_once(&once_control, initPool);
+	return pool;
+}
+
+rp_image_pool_private::rp_image_pool_private()
+	: enabled(true)
+{
+	memset(buffers, 0, sizeof(buffers));
+	memset(count, 0, sizeof(count));
+	memset(&stats, 0, sizeof(stats));
+}
+
+/**
+ * Release all cached buffers.
+ * Mutex must be locked by the caller.
+ */
+void rp_image_pool_private::clear_int(void)
+{
+	for (unsigned int i = 0; i < rp_image_pool::SIZE_CLASS_COUNT; i++) {
+		for (unsigned int j = 0; j < count[i]; j++) {
+			aligned_free(buffers[i][j]);
+			buffers[i][j] = nullptr;
+		}
+		count[i] = 0;
+	}
+	stats.cached_buffers = 0;
+	stats.cached_bytes = 0;
+}
+
+/** rp_image_pool **/
+
+/**
+ * Get the size class index for the specified size.
+ * @param size		[in] Requested size.
+ * @param pClassSize	[out,opt] Size of the size class.
+ * @return Size class index, or -1 if the size is too large to be pooled.
+ */
+int rp_image_pool::sizeClass(size_t size, size_t *pClassSize)
+{
+	if (size <= MIN_POOLED_SIZE) {
+		if (pClassSize) {
+			*pClassSize = MIN_POOLED_SIZE;
+		}
+		return 0;
+	} else if (size > MAX_POOLED_SIZE) {
+		return -1;
+	}
+
+	// Each power of two is split into four size classes.
+	// k: Highest bit of (size-1). [8, 23]
+	// t: Top three bits of (size-1), plus one. [5, 8]
+	const unsigned int k = uilog2(static_cast<unsigned int>(size - 1));
+	const unsigned int t = static_cast<unsigned int>((size - 1) >> (k - 2)) + 1;
+	if (pClassSize) {
+		*pClassSize = static_cast<size_t>(t) << (k - 2);
+	}
+	return static_cast<int>(((k - 8) * 4) + (t - 5) + 1);
+}
+
+/**
+ * Allocate a buffer.
+ * @param size Requested size, in bytes.
+ * @return Buffer aligned to ALIGNMENT bytes, or nullptr on error.
+ */
+void *rp_image_pool::allocate(size_t size)
+{
+	rp_image_pool_private *const d = getPool();
+
+	size_t class_size;
+	const int idx = sizeClass(size, &class_size);
+	if (idx < 0) {
+		// Too large to be pooled.
+		// Round up to a multiple of the alignment.
+		{
+			MutexLocker locker(d->mutex);
+			d->stats.allocs++;
+			d->stats.oversize++;
+		}
+		return aligned_malloc(ALIGNMENT, (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1));
+	}
+
+	{
+		MutexLocker locker(d->mutex);
+		d->stats.allocs++;
+		if (d->count[idx] > 0) {
+			// Found a cached buffer.
+			d->stats.hits++;
+			d->stats.cached_buffers--;
+			d->stats.cached_bytes -= class_size;
+			void *const ptr = d->buffers[idx][--d->count[idx]];
+			d->buffers[idx][d->count[idx]] = nullptr;
+			return ptr;
+		}
+		d->stats.misses++;
+	}
+
+	// No cached buffer. Allocate the full size class
+	// so the buffer can be reused for any size in the class.
+	return aligned_malloc(ALIGNMENT, class_size);
+}
+
+/**
+ * Release a buffer that was allocated with allocate().
+ * @param ptr Buffer. (nullptr is allowed)
+ * @param size Size that was passed to allocate().
+ */
+void rp_image_pool::deallocate(void *ptr, size_t size)
+{
+	if (!ptr)
+		return;
+
+	rp_image_pool_private *const d = getPool();
+
+	size_t class_size;
+	const int idx = sizeClass(size, &class_size);
+	{
+		MutexLocker locker(d->mutex);
+		d->stats.frees++;
+		if (idx >= 0 && d->enabled &&
+		    d->count[idx] < MAX_CACHED_PER_CLASS &&
+		    d->stats.cached_bytes + class_size <= MAX_CACHED_BYTES)
+		{
+			// Cache the buffer.
+			d->buffers[idx][d->count[idx]++] = ptr;
+			d->stats.cached_buffers++;
+			d->stats.cached_bytes += class_size;
+			if (d->stats.cached_bytes > d->stats.peak_cached_bytes) {
+				d->stats.peak_cached_bytes = d->stats.cached_bytes;
+			}
+			return;
+		}
+		if (idx >= 0) {
+			d->stats.discards++;
+		}
+	}
+
+	// Not cached.
+	aligned_free(ptr);
+}
+
+/**
+ * Get the current pool statistics.
+ * @param pStats [out] Statistics.
+ */
+void rp_image_pool::getStats(Stats *pStats)
+{
+	assert(pStats != nullptr);
+	if (!pStats)
+		return;
+
+	rp_image_pool_private *const d = getPool();
+	MutexLocker locker(d->mutex);
+	*pStats = d->stats;
+}
+
+/**
+ * Reset the pool statistics counters.
+ * Cached buffer counts are not affected.
+ */
+void rp_image_pool::resetStats(void)
+{
+	rp_image_pool_private *const d = getPool();
+	MutexLocker locker(d->mutex);
+	d->stats.allocs = 0;
+	d->stats.hits = 0;
+	d->stats.misses = 0;
+	d->stats.oversize = 0;
+	d->stats.frees = 0;
+	d->stats.discards = 0;
+	d->stats.peak_cached_bytes = d->stats.cached_bytes;
+}
+
+/**
+ * Release all cached buffers to the system allocator.
+ */
+void rp_image_pool::clear(void)
+{
+	rp_image_pool_private *const d = getPool();
+	MutexLocker locker(d->mutex);
+	d->clear_int();
+}
+
+/**
+ * Enable or disable the pool.
+ * When disabled, all cached buffers are released and
+ * allocations go directly to the system allocator.
+ * @param enabled True to enable; false to disable.
+ */
+void rp_image_pool::setEnabled(bool enabled)
+{
+	rp_image_pool_private *const d = getPool();
+	MutexLocker locker(d->mutex);
+	d->enabled = enabled;
+	if (!enabled) {
+		d->clear_int();
+	}
+}
+
+/**
+ * Is the pool enabled?
+ * @return True if enabled; false if not.
+ */
+bool rp_image_pool::isEnabled(void)
+{
+	rp_image_pool_private *const d = getPool();
+	MutexLocker locker(d->mutex);
+	return d->enabled;
+}
+
+}
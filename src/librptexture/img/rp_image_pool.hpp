@@ -0,0 +1,135 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_pool.hpp: Pooled allocator for rp_image pixel buffers.         *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPTEXTURE_IMG_RP_IMAGE_POOL_HPP__
+#define __ROMPROPERTIES_LIBRPTEXTURE_IMG_RP_IMAGE_POOL_HPP__
+
+#include "common.h"
+
+// C includes.
+#include <stddef.h>
+#include <stdint.h>
+
+namespace LibRpTexture {
+
+/**
+ * Size-class pool for rp_image pixel and palette buffers.
+ *
+ * Thumbnailing a batch of files creates and destroys many
+ * images of the same few sizes (decode, dup_ARGB32(), squared(),
+ * resized()), so freed buffers are kept in per-size-class
+ * free lists and handed out again instead of going back
+ * to the system allocator.
+ *
+ * Size classes are quarter-steps between powers of two,
+ * starting at 256 bytes: 256, 320, 384, 448, 512, 640, ...
+ * Requests larger than MAX_POOLED_SIZE bypass the pool.
+ *
+ * All buffers are aligned to ALIGNMENT bytes, which is
+ * sufficient for AVX-512 loads and stores.
+ * Buffers are NOT zero-initialized.
+ */
+class rp_image_pool
+{
+	private:
+		// Static class.
+		rp_image_pool();
+		~rp_image_pool();
+		RP_DISABLE_COPY(rp_image_pool)
+
+	public:
+		// Buffer alignment.
+		static const size_t ALIGNMENT = 64;
+
+		// Smallest size class.
+		static const size_t MIN_POOLED_SIZE = 256;
+		// Largest size class. (16 MiB)
+		static const size_t MAX_POOLED_SIZE = 16U*1024U*1024U;
+		// Number of size classes.
+		static const unsigned int SIZE_CLASS_COUNT = 65;
+
+		// Maximum number of cached buffers per size class.
+		static const unsigned int MAX_CACHED_PER_CLASS = 8;
+		// Maximum total size of all cached buffers. (32 MiB)
+		static const size_t MAX_CACHED_BYTES = 32U*1024U*1024U;
+
+	public:
+		/**
+		 * Get the size class index for the specified size.
+		 * @param size		[in] Requested size.
+		 * @param pClassSize	[out,opt] Size of the size class.
+		 * @return Size class index, or -1 if the size is too large to be pooled.
+		 */
+		static int sizeClass(size_t size, size_t *pClassSize = nullptr);
+
+		/**
+		 * Allocate a buffer.
+		 * @param size Requested size, in bytes.
+		 * @return Buffer aligned to ALIGNMENT bytes, or nullptr on error.
+		 */
+		static void *allocate(size_t size);
+
+		/**
+		 * Release a buffer that was allocated with allocate().
+		 * @param ptr Buffer. (nullptr is allowed)
+		 * @param size Size that was passed to allocate().
+		 */
+		static void deallocate(void *ptr, size_t size);
+
+	public:
+		/**
+		 * Pool statistics.
+		 */
+		struct Stats {
+			uint64_t allocs;	// Total calls to allocate().
+			uint64_t hits;		// Allocations served from the pool.
+			uint64_t misses;	// Pooled size classes that had to be allocated.
+			uint64_t oversize;	// Allocations too large to be pooled.
+			uint64_t frees;		// Total calls to deallocate().
+			uint64_t discards;	// Freed buffers that didn't fit in the pool.
+
+			unsigned int cached_buffers;	// Currently-cached buffers.
+			size_t cached_bytes;		// Currently-cached bytes.
+			size_t peak_cached_bytes;	// Peak cached bytes.
+		};
+
+		/**
+		 * Get the current pool statistics.
+		 * @param pStats [out] Statistics.
+		 */
+		static void getStats(Stats *pStats);
+
+		/**
+		 * Reset the pool statistics counters.
+		 * Cached buffer counts are not affected.
+		 */
+		static void resetStats(void);
+
+		/**
+		 * Release all cached buffers to the system allocator.
+		 */
+		static void clear(void);
+
+		/**
+		 * Enable or disable the pool.
+		 * When disabled, all cached buffers are released and
+		 * allocations go directly to the system allocator.
+		 * @param enabled True to enable; false to disable.
+		 */
+		static void setEnabled(bool enabled);
+
+		/**
+		 * Is the pool enabled?
+		 * @return True if enabled; false if not.
+		 */
+		static bool isEnabled(void);
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPTEXTURE_IMG_RP_IMAGE_POOL_HPP__ */
@@ -0,0 +1,107 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * un-premultiply_avx2.cpp: Un-premultiply function.                       *
+ * AVX2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2017-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+#include "rp_image_p.hpp"
+#include "rp_image_backend.hpp"
+
+// AVX2 intrinsics.
+#include <immintrin.h>
+
+// Workaround for RP_D() expecting the no-underscore, UpperCamelCase naming convention.
+#define rp_imagePrivate rp_image_private
+
+namespace LibRpTexture {
+
+/**
+ * Un-premultiply 8 argb32_t pixels. (AVX2 version)
+ * Based on qt-5.11.0's qrgb.h.
+ * qUnpremultiply()
+ *
+ * This is needed in order to convert DXT2/3 to DXT4/5.
+ *
+ * @param px	[in] 8 ARGB32 pixels.
+ * @return Un-premultiplied pixels.
+ */
+static FORCEINLINE __m256i un_premultiply_pixels_avx2(__m256i px)
+{
+	const __m256i mask_FF = _mm256_set1_epi32(0xFF);
+	const __m256i vr = _mm256_set1_epi32(0x8000);
+
+	// Look up the inverted alpha factors.
+	const __m256i alpha = _mm256_srli_epi32(px, 24);
+	const __m256i via = _mm256_i32gather_epi32(
+		reinterpret_cast<const int*>(rp_image::qt_inv_premul_factor), alpha, 4);
+
+	// (p*(0x00ff00ff/alpha)) >> 16 == (p*255)/alpha for all p and alpha <= 256.
+	// We add 0x8000 to get even rounding.
+	// NOTE: Results are truncated to 8 bits, same as the C++ version.
+	__m256i b = _mm256_and_si256(px, mask_FF);
+	__m256i g = _mm256_and_si256(_mm256_srli_epi32(px, 8), mask_FF);
+	__m256i r = _mm256_and_si256(_mm256_srli_epi32(px, 16), mask_FF);
+	b = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(b, via), vr), 16);
+	g = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(g, via), vr), 16);
+	r = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(r, via), vr), 16);
+	b = _mm256_and_si256(b, mask_FF);
+	g = _mm256_slli_epi32(_mm256_and_si256(g, mask_FF), 8);
+	r = _mm256_slli_epi32(_mm256_and_si256(r, mask_FF), 16);
+
+	__m256i res = _mm256_or_si256(_mm256_or_si256(b, g),
+		_mm256_or_si256(r, _mm256_slli_epi32(alpha, 24)));
+
+	// Pixels with alpha == 0 or alpha == 255 are left as-is.
+	const __m256i keep = _mm256_or_si256(
+		_mm256_cmpeq_epi32(alpha, _mm256_setzero_si256()),
+		_mm256_cmpeq_epi32(alpha, mask_FF));
+	return _mm256_blendv_epi8(res, px, keep);
+}
+
+/**
+ * Un-premultiply an ARGB32 rp_image.
+ * Image must be ARGB32.
+ * @return 0 on success; non-zero on error.
+ */
+int rp_image::un_premultiply_avx2(void)
+{
+	RP_D(const rp_image);
+	rp_image_backend *const backend = d->backend;
+	assert(backend->format == rp_image::Format::ARGB32);
+	if (backend->format != rp_image::Format::ARGB32) {
+		// Incorrect format...
+		return -1;
+	}
+
+	// Lane indexes for masking the remaining pixels.
+	const __m256i lane_idx = _mm256_setr_epi32(0,1,2,3,4,5,6,7);
+
+	const int width = backend->width;
+	uint32_t *px_dest = static_cast<uint32_t*>(backend->data());
+	int dest_stride_adj = (backend->stride / sizeof(*px_dest)) - width;
+	for (int y = backend->height; y > 0; y--, px_dest += dest_stride_adj) {
+		// Process 8 pixels per iteration using AVX2.
+		int x = width;
+		for (; x > 7; x -= 8, px_dest += 8) {
+			__m256i *ymm_px = reinterpret_cast<__m256i*>(px_dest);
+			_mm256_storeu_si256(ymm_px, un_premultiply_pixels_avx2(_mm256_loadu_si256(ymm_px)));
+		}
+
+		// Remaining pixels.
+		if (x > 0) {
+			const __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(x), lane_idx);
+			int *const p = reinterpret_cast<int*>(px_dest);
+			_mm256_maskstore_epi32(p, mask,
+				un_premultiply_pixels_avx2(_mm256_maskload_epi32(p, mask)));
+			px_dest += x;
+		}
+	}
+	return 0;
+}
+
+}
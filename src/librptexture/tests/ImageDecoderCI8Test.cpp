@@ -0,0 +1,294 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture/tests)               *
+ * ImageDecoderCI8Test.cpp: CI8 to ARGB32 expansion tests.                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librptexture, librpcpu
+#include "librptexture/img/rp_image.hpp"
+#include "librptexture/decoder/ImageDecoder.hpp"
+
+// C includes.
+#include <stdint.h>
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRpTexture { namespace Tests {
+
+// Expansion function.
+typedef void (*expandCI8toARGB32_fn)(uint32_t *RESTRICT dest, int dest_stride,
+	const uint8_t *RESTRICT src, int src_stride,
+	int width, int height, const uint32_t *RESTRICT palette);
+
+class ImageDecoderCI8Test : public ::testing::TestWithParam<unsigned int>
+{
+	protected:
+		ImageDecoderCI8Test()
+			: ::testing::TestWithParam<unsigned int>()
+		{ }
+
+		void SetUp(void) final;
+
+	public:
+		// Image dimensions.
+		// NOTE: Width is not a multiple of 32 in order
+		// to test the remaining pixels code.
+		static const int WIDTH = 253;
+		static const int HEIGHT = 256;
+		static const int SRC_STRIDE = 256;
+		static const int DEST_STRIDE = 256 * sizeof(uint32_t);
+
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 10000;
+
+		// Palette. (256 entries)
+		vector<uint32_t> m_palette;
+		// CI8 image. Indexes are limited to the test parameter.
+		vector<uint8_t> m_ci8;
+		// Expected ARGB32 image.
+		vector<uint32_t> m_expected;
+
+		/**
+		 * Expand the CI8 image using the specified function
+		 * and compare it to the expected image.
+		 * @param fn Expansion function.
+		 */
+		void CheckExpand(expandCI8toARGB32_fn fn);
+
+		/**
+		 * Benchmark an expansion function.
+		 * @param fn Expansion function.
+		 */
+		void BenchmarkExpand(expandCI8toARGB32_fn fn);
+
+	public:
+		/** Test case parameters. **/
+
+		/**
+		 * Test case suffix generator.
+		 * @param info Test parameter information.
+		 * @return Test case suffix.
+		 */
+		static string test_case_suffix_generator(const ::testing::TestParamInfo<unsigned int> &info);
+};
+
+const int ImageDecoderCI8Test::WIDTH;
+const int ImageDecoderCI8Test::HEIGHT;
+const int ImageDecoderCI8Test::SRC_STRIDE;
+const int ImageDecoderCI8Test::DEST_STRIDE;
+
+/**
+ * Test case suffix generator.
+ * @param info Test parameter information.
+ * @return Test case suffix.
+ */
+string ImageDecoderCI8Test::test_case_suffix_generator(const ::testing::TestParamInfo<unsigned int> &info)
+{
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%u_colors", info.param);
+	return string(buf);
+}
+
+/**
+ * SetUp() function.
+ * Run before each test.
+ */
+void ImageDecoderCI8Test::SetUp(void)
+{
+	const unsigned int colors = GetParam();
+
+	m_palette.resize(256);
+	uint32_t seed = 0x12345678;
+	for (auto iter = m_palette.begin(); iter != m_palette.end(); ++iter) {
+		seed = (seed * 1103515245U) + 12345U;
+		*iter = seed;
+	}
+
+	// Fill the CI8 image, including the padding bytes.
+	m_ci8.resize(SRC_STRIDE * HEIGHT);
+	for (auto iter = m_ci8.begin(); iter != m_ci8.end(); ++iter) {
+		seed = (seed * 1103515245U) + 12345U;
+		*iter = static_cast<uint8_t>((seed >> 16) % colors);
+	}
+
+	// Expected image. Padding pixels are left as 0.
+	m_expected.assign((DEST_STRIDE / sizeof(uint32_t)) * HEIGHT, 0);
+	for (int y = 0; y < HEIGHT; y++) {
+		const uint8_t *src = &m_ci8[y * SRC_STRIDE];
+		uint32_t *dest = &m_expected[y * (DEST_STRIDE / sizeof(uint32_t))];
+		for (int x = 0; x < WIDTH; x++) {
+			dest[x] = m_palette[src[x]];
+		}
+	}
+}
+
+/**
+ * Expand the CI8 image using the specified function
+ * and compare it to the expected image.
+ * @param fn Expansion function.
+ */
+void ImageDecoderCI8Test::CheckExpand(expandCI8toARGB32_fn fn)
+{
+	vector<uint32_t> actual(m_expected.size(), 0);
+	fn(actual.data(), DEST_STRIDE, m_ci8.data(), SRC_STRIDE, WIDTH, HEIGHT, m_palette.data());
+
+	const int dest_stride_px = DEST_STRIDE / sizeof(uint32_t);
+	for (int y = 0; y < HEIGHT; y++) {
+		ASSERT_EQ(0, memcmp(&m_expected[y * dest_stride_px], &actual[y * dest_stride_px],
+			dest_stride_px * sizeof(uint32_t))) << "row " << y;
+	}
+}
+
+/**
+ * Benchmark an expansion function.
+ * @param fn Expansion function.
+ */
+void ImageDecoderCI8Test::BenchmarkExpand(expandCI8toARGB32_fn fn)
+{
+	vector<uint32_t> actual(m_expected.size());
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		fn(actual.data(), DEST_STRIDE, m_ci8.data(), SRC_STRIDE, WIDTH, HEIGHT, m_palette.data());
+	}
+}
+
+/**
+ * Test ImageDecoder::expandCI8toARGB32(). (Standard version)
+ */
+TEST_P(ImageDecoderCI8Test, expandCI8toARGB32_cpp_test)
+{
+	ASSERT_NO_FATAL_FAILURE(CheckExpand(ImageDecoder::expandCI8toARGB32_cpp));
+}
+
+/**
+ * Benchmark ImageDecoder::expandCI8toARGB32(). (Standard version)
+ */
+TEST_P(ImageDecoderCI8Test, expandCI8toARGB32_cpp_benchmark)
+{
+	BenchmarkExpand(ImageDecoder::expandCI8toARGB32_cpp);
+}
+
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Test ImageDecoder::expandCI8toARGB32(). (SSSE3-optimized version)
+ */
+TEST_P(ImageDecoderCI8Test, expandCI8toARGB32_ssse3_test)
+{
+	if (!RP_CPU_HasSSSE3()) {
+		fprintf(stderr, "*** SSSE3 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	ASSERT_NO_FATAL_FAILURE(CheckExpand(ImageDecoder::expandCI8toARGB32_ssse3));
+}
+
+/**
+ * Benchmark ImageDecoder::expandCI8toARGB32(). (SSSE3-optimized version)
+ */
+TEST_P(ImageDecoderCI8Test, expandCI8toARGB32_ssse3_benchmark)
+{
+	if (!RP_CPU_HasSSSE3()) {
+		fprintf(stderr, "*** SSSE3 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	BenchmarkExpand(ImageDecoder::expandCI8toARGB32_ssse3);
+}
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Test ImageDecoder::expandCI8toARGB32(). (AVX2-optimized version)
+ */
+TEST_P(ImageDecoderCI8Test, expandCI8toARGB32_avx2_test)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	ASSERT_NO_FATAL_FAILURE(CheckExpand(ImageDecoder::expandCI8toARGB32_avx2));
+}
+
+/**
+ * Benchmark ImageDecoder::expandCI8toARGB32(). (AVX2-optimized version)
+ */
+TEST_P(ImageDecoderCI8Test, expandCI8toARGB32_avx2_benchmark)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	BenchmarkExpand(ImageDecoder::expandCI8toARGB32_avx2);
+}
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
+/**
+ * Test rp_image::dup_ARGB32() with a decoded CI8 image.
+ */
+TEST_P(ImageDecoderCI8Test, fromLinearCI8_dup_ARGB32_test)
+{
+	// Use the first 512 bytes of the CI8 image as an RGB565 palette.
+	const int img_siz = WIDTH * HEIGHT;
+	rp_image *const img_ci8 = ImageDecoder::fromLinearCI8(ImageDecoder::PXF_RGB565,
+		WIDTH, HEIGHT, m_ci8.data(), img_siz, m_ci8.data(), 256*2);
+	ASSERT_TRUE(img_ci8 != nullptr);
+	rp_image *const img_argb32 = img_ci8->dup_ARGB32();
+	ASSERT_TRUE(img_argb32 != nullptr);
+	EXPECT_EQ(rp_image::Format::CI8, img_ci8->format());
+	ASSERT_EQ(rp_image::Format::ARGB32, img_argb32->format());
+
+	const uint32_t *const palette = img_ci8->palette();
+	for (int y = 0; y < HEIGHT; y++) {
+		const uint8_t *const src = static_cast<const uint8_t*>(img_ci8->scanLine(y));
+		const uint32_t *const dest = static_cast<const uint32_t*>(img_argb32->scanLine(y));
+		for (int x = 0; x < WIDTH; x++) {
+			ASSERT_EQ(palette[src[x]], dest[x]) << "x " << x << ", y " << y;
+		}
+	}
+
+	rp_image::sBIT_t sBIT_ci8, sBIT_argb32;
+	ASSERT_EQ(0, img_ci8->get_sBIT(&sBIT_ci8));
+	ASSERT_EQ(0, img_argb32->get_sBIT(&sBIT_argb32));
+	EXPECT_EQ(0, memcmp(&sBIT_ci8, &sBIT_argb32, sizeof(sBIT_ci8)));
+
+	img_ci8->unref();
+	img_argb32->unref();
+}
+
+INSTANTIATE_TEST_SUITE_P(expandCI8toARGB32, ImageDecoderCI8Test,
+	::testing::Values(16U, 17U, 256U),
+	ImageDecoderCI8Test::test_case_suffix_generator);
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpTexture test suite: ImageDecoder::expandCI8toARGB32() tests.\n\n");
+	fprintf(stderr, "Benchmark iterations: %u\n",
+		LibRpTexture::Tests::ImageDecoderCI8Test::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
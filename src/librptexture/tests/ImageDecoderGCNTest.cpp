@@ -0,0 +1,298 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture/tests)               *
+ * ImageDecoderGCNTest.cpp: GameCube tiled image decoding tests.           *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librptexture, librpcpu
+#include "librptexture/img/rp_image.hpp"
+#include "librptexture/decoder/ImageDecoder.hpp"
+
+// C includes.
+#include <stdint.h>
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRpTexture { namespace Tests {
+
+class ImageDecoderGCNTest : public ::testing::TestWithParam<ImageDecoder::PixelFormat>
+{
+	protected:
+		ImageDecoderGCNTest()
+			: ::testing::TestWithParam<ImageDecoder::PixelFormat>()
+		{ }
+
+		void SetUp(void) final;
+
+	public:
+		// Image dimensions. (4x4 tiles)
+		static const int WIDTH = 128;
+		static const int HEIGHT = 128;
+
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 10000;
+
+		// Tiled 16-bit image buffer.
+		vector<uint16_t> m_img_buf;
+
+		/**
+		 * Compare two rp_images.
+		 * @param pImgExpected Expected image.
+		 * @param pImgActual Actual image.
+		 */
+		static void CompareImages(const rp_image *pImgExpected, const rp_image *pImgActual);
+
+	public:
+		/** Test case parameters. **/
+
+		/**
+		 * Test case suffix generator.
+		 * @param info Test parameter information.
+		 * @return Test case suffix.
+		 */
+		static string test_case_suffix_generator(const ::testing::TestParamInfo<ImageDecoder::PixelFormat> &info);
+};
+
+const int ImageDecoderGCNTest::WIDTH;
+const int ImageDecoderGCNTest::HEIGHT;
+
+/**
+ * Test case suffix generator.
+ * @param info Test parameter information.
+ * @return Test case suffix.
+ */
+string ImageDecoderGCNTest::test_case_suffix_generator(const ::testing::TestParamInfo<ImageDecoder::PixelFormat> &info)
+{
+	switch (info.param) {
+		case ImageDecoder::PXF_RGB5A3:	return "RGB5A3";
+		case ImageDecoder::PXF_RGB565:	return "RGB565";
+		case ImageDecoder::PXF_IA8:	return "IA8";
+		default:			break;
+	}
+	return "unknown";
+}
+
+/**
+ * SetUp() function.
+ * Run before each test.
+ */
+void ImageDecoderGCNTest::SetUp(void)
+{
+	// Fill the image buffer with pseudo-random data.
+	// This ensures both RGB5A3 modes are tested.
+	m_img_buf.resize(WIDTH * HEIGHT);
+	uint32_t seed = 0x12345678;
+	for (auto iter = m_img_buf.begin(); iter != m_img_buf.end(); ++iter) {
+		seed = (seed * 1103515245U) + 12345U;
+		*iter = static_cast<uint16_t>(seed >> 12);
+	}
+}
+
+/**
+ * Compare two rp_images.
+ * @param pImgExpected Expected image.
+ * @param pImgActual Actual image.
+ */
+void ImageDecoderGCNTest::CompareImages(const rp_image *pImgExpected, const rp_image *pImgActual)
+{
+	ASSERT_TRUE(pImgExpected != nullptr);
+	ASSERT_TRUE(pImgActual != nullptr);
+	ASSERT_EQ(pImgExpected->width(), pImgActual->width());
+	ASSERT_EQ(pImgExpected->height(), pImgActual->height());
+	ASSERT_EQ(rp_image::Format::ARGB32, pImgActual->format());
+
+	const size_t row_bytes = pImgExpected->width() * sizeof(uint32_t);
+	for (int y = 0; y < pImgExpected->height(); y++) {
+		ASSERT_EQ(0, memcmp(pImgExpected->scanLine(y), pImgActual->scanLine(y), row_bytes))
+			<< "row " << y;
+	}
+
+	rp_image::sBIT_t sBIT_expected, sBIT_actual;
+	ASSERT_EQ(0, pImgExpected->get_sBIT(&sBIT_expected));
+	ASSERT_EQ(0, pImgActual->get_sBIT(&sBIT_actual));
+	EXPECT_EQ(0, memcmp(&sBIT_expected, &sBIT_actual, sizeof(sBIT_expected)));
+}
+
+/**
+ * Benchmark the ImageDecoder::fromGcn16() function. (Standard version)
+ */
+TEST_P(ImageDecoderGCNTest, fromGcn16_cpp_benchmark)
+{
+	const ImageDecoder::PixelFormat px_format = GetParam();
+	const int img_siz = static_cast<int>(m_img_buf.size() * sizeof(uint16_t));
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const img = ImageDecoder::fromGcn16_cpp(px_format,
+			WIDTH, HEIGHT, m_img_buf.data(), img_siz);
+		ASSERT_TRUE(img != nullptr);
+		img->unref();
+	}
+}
+
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Test the ImageDecoder::fromGcn16() function. (SSSE3-optimized version)
+ */
+TEST_P(ImageDecoderGCNTest, fromGcn16_ssse3_test)
+{
+	if (!RP_CPU_HasSSSE3()) {
+		fprintf(stderr, "*** SSSE3 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	const ImageDecoder::PixelFormat px_format = GetParam();
+	const int img_siz = static_cast<int>(m_img_buf.size() * sizeof(uint16_t));
+
+	rp_image *const img_cpp = ImageDecoder::fromGcn16_cpp(px_format,
+		WIDTH, HEIGHT, m_img_buf.data(), img_siz);
+	rp_image *const img_ssse3 = ImageDecoder::fromGcn16_ssse3(px_format,
+		WIDTH, HEIGHT, m_img_buf.data(), img_siz);
+	ASSERT_NO_FATAL_FAILURE(CompareImages(img_cpp, img_ssse3));
+	UNREF(img_cpp);
+	UNREF(img_ssse3);
+}
+
+/**
+ * Benchmark the ImageDecoder::fromGcn16() function. (SSSE3-optimized version)
+ */
+TEST_P(ImageDecoderGCNTest, fromGcn16_ssse3_benchmark)
+{
+	if (!RP_CPU_HasSSSE3()) {
+		fprintf(stderr, "*** SSSE3 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	const ImageDecoder::PixelFormat px_format = GetParam();
+	const int img_siz = static_cast<int>(m_img_buf.size() * sizeof(uint16_t));
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const img = ImageDecoder::fromGcn16_ssse3(px_format,
+			WIDTH, HEIGHT, m_img_buf.data(), img_siz);
+		ASSERT_TRUE(img != nullptr);
+		img->unref();
+	}
+}
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Test the ImageDecoder::fromGcn16() function. (AVX2-optimized version)
+ */
+TEST_P(ImageDecoderGCNTest, fromGcn16_avx2_test)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	const ImageDecoder::PixelFormat px_format = GetParam();
+	const int img_siz = static_cast<int>(m_img_buf.size() * sizeof(uint16_t));
+
+	rp_image *const img_cpp = ImageDecoder::fromGcn16_cpp(px_format,
+		WIDTH, HEIGHT, m_img_buf.data(), img_siz);
+	rp_image *const img_avx2 = ImageDecoder::fromGcn16_avx2(px_format,
+		WIDTH, HEIGHT, m_img_buf.data(), img_siz);
+	ASSERT_NO_FATAL_FAILURE(CompareImages(img_cpp, img_avx2));
+	UNREF(img_cpp);
+	UNREF(img_avx2);
+}
+
+/**
+ * Benchmark the ImageDecoder::fromGcn16() function. (AVX2-optimized version)
+ */
+TEST_P(ImageDecoderGCNTest, fromGcn16_avx2_benchmark)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	const ImageDecoder::PixelFormat px_format = GetParam();
+	const int img_siz = static_cast<int>(m_img_buf.size() * sizeof(uint16_t));
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const img = ImageDecoder::fromGcn16_avx2(px_format,
+			WIDTH, HEIGHT, m_img_buf.data(), img_siz);
+		ASSERT_TRUE(img != nullptr);
+		img->unref();
+	}
+}
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
+/**
+ * Test the ImageDecoder::fromGcn16() dispatch function
+ * with a width that isn't a power of two.
+ */
+TEST_P(ImageDecoderGCNTest, fromGcn16_dispatch_test)
+{
+	const ImageDecoder::PixelFormat px_format = GetParam();
+	const int width = 36, height = 8;
+	const int img_siz = width * height * sizeof(uint16_t);
+
+	rp_image *const img_cpp = ImageDecoder::fromGcn16_cpp(px_format,
+		width, height, m_img_buf.data(), img_siz);
+	rp_image *const img = ImageDecoder::fromGcn16(px_format,
+		width, height, m_img_buf.data(), img_siz);
+	ASSERT_NO_FATAL_FAILURE(CompareImages(img_cpp, img));
+	UNREF(img_cpp);
+	UNREF(img);
+}
+
+// NOTE: Add more instruction sets to the #ifdef if other optimizations are added.
+#if defined(IMAGEDECODER_HAS_SSSE3) || defined(IMAGEDECODER_HAS_AVX2)
+/**
+ * Benchmark the ImageDecoder::fromGcn16() dispatch function.
+ */
+TEST_P(ImageDecoderGCNTest, fromGcn16_dispatch_benchmark)
+{
+	const ImageDecoder::PixelFormat px_format = GetParam();
+	const int img_siz = static_cast<int>(m_img_buf.size() * sizeof(uint16_t));
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const img = ImageDecoder::fromGcn16(px_format,
+			WIDTH, HEIGHT, m_img_buf.data(), img_siz);
+		ASSERT_TRUE(img != nullptr);
+		img->unref();
+	}
+}
+#endif /* IMAGEDECODER_HAS_SSSE3 || IMAGEDECODER_HAS_AVX2 */
+
+INSTANTIATE_TEST_SUITE_P(fromGcn16, ImageDecoderGCNTest,
+	::testing::Values(
+		ImageDecoder::PXF_RGB5A3,
+		ImageDecoder::PXF_RGB565,
+		ImageDecoder::PXF_IA8)
+	, ImageDecoderGCNTest::test_case_suffix_generator);
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpTexture test suite: ImageDecoder::fromGcn16() tests.\n\n");
+	fprintf(stderr, "Benchmark iterations: %u\n",
+		LibRpTexture::Tests::ImageDecoderGCNTest::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
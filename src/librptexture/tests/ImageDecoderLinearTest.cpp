@@ -643,8 +643,180 @@ TEST_P(ImageDecoderLinearTest, fromLinear_ssse3_benchmark)
 }
 #endif /* IMAGEDECODER_HAS_SSSE3 */
 
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Test the ImageDecoder::fromLinear*() functions. (AVX2-optimized version)
+ */
+TEST_P(ImageDecoderLinearTest, fromLinear_avx2_test)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	// Parameterized test.
+	const ImageDecoderLinearTest_mode &mode = GetParam();
+
+	// Decode the image.
+	switch (mode.bpp) {
+		case 24:
+			// 24-bit image.
+			m_img = ImageDecoder::fromLinear24_avx2(mode.src_pxf, 128, 128,
+				m_img_buf, static_cast<int>(m_img_buf_len), mode.stride);
+			break;
+
+		case 32:
+			// 32-bit image.
+			m_img = ImageDecoder::fromLinear32_avx2(mode.src_pxf, 128, 128,
+				reinterpret_cast<const uint32_t*>(m_img_buf),
+				static_cast<int>(m_img_buf_len), mode.stride);
+			break;
+
+		case 15:
+		case 16:
+			// 15/16-bit image.
+			m_img = ImageDecoder::fromLinear16_avx2(mode.src_pxf, 128, 128,
+				reinterpret_cast<const uint16_t*>(m_img_buf),
+				static_cast<int>(m_img_buf_len), mode.stride);
+			break;
+
+		default:
+			ASSERT_TRUE(false) << "Invalid bpp: " << mode.bpp;
+			return;
+	}
+
+	ASSERT_TRUE(m_img != nullptr);
+
+	// Validate the image.
+	ASSERT_NO_FATAL_FAILURE(Validate_RpImage(m_img, mode.dest_pixel));
+}
+
+/**
+ * Benchmark the ImageDecoder::fromLinear*() functions. (AVX2-optimized version)
+ */
+TEST_P(ImageDecoderLinearTest, fromLinear_avx2_benchmark)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	// Parameterized test.
+	const ImageDecoderLinearTest_mode &mode = GetParam();
+
+	// Decode the image.
+	switch (mode.bpp) {
+		case 24:
+			// 24-bit image.
+			for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+				m_img = ImageDecoder::fromLinear24_avx2(mode.src_pxf, 128, 128,
+					m_img_buf, static_cast<int>(m_img_buf_len), mode.stride);
+				UNREF_AND_NULL(m_img);
+			}
+			break;
+
+		case 32:
+			// 32-bit image.
+			for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+				m_img = ImageDecoder::fromLinear32_avx2(mode.src_pxf, 128, 128,
+					reinterpret_cast<const uint32_t*>(m_img_buf),
+					static_cast<int>(m_img_buf_len), mode.stride);
+				UNREF_AND_NULL(m_img);
+			}
+			break;
+
+		case 15:
+		case 16:
+			// 15/16-bit image.
+			for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+				m_img = ImageDecoder::fromLinear16_avx2(mode.src_pxf, 128, 128,
+					reinterpret_cast<const uint16_t*>(m_img_buf),
+					static_cast<int>(m_img_buf_len), mode.stride);
+				UNREF_AND_NULL(m_img);
+			}
+			break;
+
+		default:
+			ASSERT_TRUE(false) << "Invalid bpp: " << mode.bpp;
+			return;
+	}
+}
+
+/**
+ * Compare the AVX2 decoders to the C++ decoders using non-uniform
+ * pixel data and an odd image width.
+ *
+ * The parameterized tests use a single pixel value, which won't
+ * detect pixels being reordered across 128-bit lanes.
+ */
+TEST_F(ImageDecoderLinearTest, fromLinear_avx2_noise_test)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	// 77x9 image: 2 full AVX2 iterations plus remaining pixels for
+	// 16-bit and 32-bit; 2 full iterations plus 13 pixels for 24-bit.
+	static const int width = 77;
+	static const int height = 9;
+	const int stride = width * 4;
+	ao::uvector<uint8_t> buf(stride * height);
+	uint32_t seed = 0x12345678;
+	for (auto iter = buf.begin(); iter != buf.end(); ++iter) {
+		seed = (seed * 1103515245U) + 12345U;
+		*iter = static_cast<uint8_t>(seed >> 16);
+	}
+
+	static const ImageDecoder::PixelFormat pxf16[] = {
+		ImageDecoder::PXF_RGB565, ImageDecoder::PXF_BGR565,
+		ImageDecoder::PXF_ARGB1555, ImageDecoder::PXF_ABGR1555,
+		ImageDecoder::PXF_RGBA5551, ImageDecoder::PXF_BGRA5551,
+		ImageDecoder::PXF_ARGB4444, ImageDecoder::PXF_BGRA4444,
+		ImageDecoder::PXF_xRGB4444, ImageDecoder::PXF_RGBx4444,
+		ImageDecoder::PXF_RGB555, ImageDecoder::PXF_BGR555,
+	};
+	static const ImageDecoder::PixelFormat pxf24[] = {
+		ImageDecoder::PXF_RGB888, ImageDecoder::PXF_BGR888,
+	};
+	static const ImageDecoder::PixelFormat pxf32[] = {
+		ImageDecoder::PXF_HOST_xRGB32, ImageDecoder::PXF_HOST_RGBA32,
+		ImageDecoder::PXF_SWAP_ARGB32, ImageDecoder::PXF_SWAP_RGBx32,
+		ImageDecoder::PXF_G16R16, ImageDecoder::PXF_RABG8888,
+	};
+
+	for (unsigned int i = 0; i < ARRAY_SIZE(pxf16) + ARRAY_SIZE(pxf24) + ARRAY_SIZE(pxf32); i++) {
+		unique_ptr<rp_image, void(*)(rp_image*)> img_cpp(nullptr, [](rp_image *img) { UNREF(img); });
+		unique_ptr<rp_image, void(*)(rp_image*)> img_avx2(nullptr, [](rp_image *img) { UNREF(img); });
+		ImageDecoder::PixelFormat pxf;
+		if (i < ARRAY_SIZE(pxf16)) {
+			pxf = pxf16[i];
+			const uint16_t *const p = reinterpret_cast<const uint16_t*>(buf.data());
+			img_cpp.reset(ImageDecoder::fromLinear16_cpp(pxf, width, height, p, static_cast<int>(buf.size()), stride));
+			img_avx2.reset(ImageDecoder::fromLinear16_avx2(pxf, width, height, p, static_cast<int>(buf.size()), stride));
+		} else if (i < ARRAY_SIZE(pxf16) + ARRAY_SIZE(pxf24)) {
+			pxf = pxf24[i - ARRAY_SIZE(pxf16)];
+			img_cpp.reset(ImageDecoder::fromLinear24_cpp(pxf, width, height, buf.data(), static_cast<int>(buf.size()), stride));
+			img_avx2.reset(ImageDecoder::fromLinear24_avx2(pxf, width, height, buf.data(), static_cast<int>(buf.size()), stride));
+		} else {
+			pxf = pxf32[i - ARRAY_SIZE(pxf16) - ARRAY_SIZE(pxf24)];
+			const uint32_t *const p = reinterpret_cast<const uint32_t*>(buf.data());
+			img_cpp.reset(ImageDecoder::fromLinear32_cpp(pxf, width, height, p, static_cast<int>(buf.size()), stride));
+			img_avx2.reset(ImageDecoder::fromLinear32_avx2(pxf, width, height, p, static_cast<int>(buf.size()), stride));
+		}
+		ASSERT_TRUE(img_cpp != nullptr) << pxfToString(pxf);
+		ASSERT_TRUE(img_avx2 != nullptr) << pxfToString(pxf);
+
+		for (int y = 0; y < height; y++) {
+			ASSERT_EQ(0, memcmp(img_cpp->scanLine(y), img_avx2->scanLine(y), width * sizeof(uint32_t)))
+				<< pxfToString(pxf) << ", row " << y;
+		}
+	}
+}
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
 // NOTE: Add more instruction sets to the #ifdef if other optimizations are added.
-#if defined(IMAGEDECODER_HAS_SSE2) || defined(IMAGEDECODER_HAS_SSSE3)
+#if defined(IMAGEDECODER_HAS_SSE2) || defined(IMAGEDECODER_HAS_SSSE3) || defined(IMAGEDECODER_HAS_AVX2)
 /**
  * Test the ImageDecoder::fromLinear*() dispatch functions.
  */
@@ -732,7 +904,7 @@ TEST_P(ImageDecoderLinearTest, fromLinear_dispatch_benchmark)
 			return;
 	}
 }
-#endif /* IMAGEDECODER_HAS_SSE2 || IMAGEDECODER_HAS_SSSE3 */
+#endif /* IMAGEDECODER_HAS_SSE2 || IMAGEDECODER_HAS_SSSE3 || IMAGEDECODER_HAS_AVX2 */
 
 // Test cases.
 
@@ -0,0 +1,482 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture/tests)               *
+ * ImageDecoderPVRTCTest.cpp: PVRTC decoder tests.                         *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librptexture
+#include "librptexture/img/rp_image.hpp"
+#include "librptexture/decoder/ImageDecoder.hpp"
+
+// PowerVR Native SDK. (reference decoder)
+#include "PVRTDecompress.h"
+
+// C includes.
+#include <stdint.h>
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRpTexture { namespace Tests {
+
+struct PVRTCTestParams
+{
+	int width;
+	int height;
+	uint8_t mode;	// ImageDecoder::PVRTC_Mode_e
+	bool isII;	// True for PVRTC-II.
+
+	PVRTCTestParams(int width, int height, uint8_t mode, bool isII)
+		: width(width)
+		, height(height)
+		, mode(mode)
+		, isII(isII)
+	{ }
+};
+
+// Row decoding function.
+typedef void (*decodePVRTCRow_fn)(uint32_t *RESTRICT dest, int width,
+	const int16_t *RESTRICT colorsP, const int16_t *RESTRICT colorsR, int j,
+	const uint8_t *RESTRICT mod, uint8_t mode);
+
+class ImageDecoderPVRTCTest : public ::testing::TestWithParam<PVRTCTestParams>
+{
+	protected:
+		ImageDecoderPVRTCTest()
+			: ::testing::TestWithParam<PVRTCTestParams>()
+		{ }
+
+		void SetUp(void) final;
+
+	public:
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 100;
+
+		// Benchmark image dimensions.
+		static const int BENCHMARK_WIDTH = 1024;
+		static const int BENCHMARK_HEIGHT = 1024;
+
+		/**
+		 * Generate pseudo-random PVRTC image data.
+		 * @param width Image width.
+		 * @param height Image height.
+		 * @param is2bpp True for 2bpp; false for 4bpp.
+		 * @return PVRTC image data.
+		 */
+		static vector<uint8_t> generateImage(int width, int height, bool is2bpp);
+
+		/**
+		 * Decode an image using the PowerVR Native SDK.
+		 * @param img_buf PVRTC image data.
+		 * @param params Test parameters.
+		 * @return ARGB32 image data, with no row padding.
+		 */
+		static vector<uint32_t> decodeSDK(const vector<uint8_t> &img_buf, const PVRTCTestParams &params);
+
+		/**
+		 * Decode an image using ImageDecoder.
+		 * @param img_buf PVRTC image data.
+		 * @param params Test parameters.
+		 * @return rp_image, or nullptr on error.
+		 */
+		static rp_image *decode(const vector<uint8_t> &img_buf, const PVRTCTestParams &params);
+
+		/**
+		 * Compare the output of a row decoder to decodePVRTCRow_cpp().
+		 * @param fn Row decoding function.
+		 */
+		void CheckRows(decodePVRTCRow_fn fn);
+
+		/**
+		 * Benchmark a row decoder.
+		 * @param fn Row decoding function.
+		 */
+		void BenchmarkRows(decodePVRTCRow_fn fn);
+
+		// PVRTC image data.
+		vector<uint8_t> m_img_buf;
+
+	public:
+		/** Test case parameters. **/
+
+		/**
+		 * Test case suffix generator.
+		 * @param info Test parameter information.
+		 * @return Test case suffix.
+		 */
+		static string test_case_suffix_generator(const ::testing::TestParamInfo<PVRTCTestParams> &info);
+};
+
+const int ImageDecoderPVRTCTest::BENCHMARK_WIDTH;
+const int ImageDecoderPVRTCTest::BENCHMARK_HEIGHT;
+
+/**
+ * Test case suffix generator.
+ * @param info Test parameter information.
+ * @return Test case suffix.
+ */
+string ImageDecoderPVRTCTest::test_case_suffix_generator(const ::testing::TestParamInfo<PVRTCTestParams> &info)
+{
+	const PVRTCTestParams &params = info.param;
+	char buf[64];
+	snprintf(buf, sizeof(buf), "%s_%dbpp_%dx%d",
+		(params.isII ? "PVRTCII" : "PVRTC"),
+		((params.mode & ImageDecoder::PVRTC_BPP_MASK) == ImageDecoder::PVRTC_2BPP ? 2 : 4),
+		params.width, params.height);
+	return string(buf);
+}
+
+/**
+ * Generate pseudo-random PVRTC image data.
+ * @param width Image width.
+ * @param height Image height.
+ * @param is2bpp True for 2bpp; false for 4bpp.
+ * @return PVRTC image data.
+ */
+vector<uint8_t> ImageDecoderPVRTCTest::generateImage(int width, int height, bool is2bpp)
+{
+	vector<uint8_t> img_buf((width * height) / (is2bpp ? 4 : 2));
+	uint32_t seed = 0x12345678;
+	for (auto iter = img_buf.begin(); iter != img_buf.end(); ++iter) {
+		seed = (seed * 1103515245U) + 12345U;
+		*iter = static_cast<uint8_t>(seed >> 16);
+	}
+	return img_buf;
+}
+
+/**
+ * Decode an image using the PowerVR Native SDK.
+ * @param img_buf PVRTC image data.
+ * @param params Test parameters.
+ * @return ARGB32 image data, with no row padding.
+ */
+vector<uint32_t> ImageDecoderPVRTCTest::decodeSDK(const vector<uint8_t> &img_buf, const PVRTCTestParams &params)
+{
+	const uint32_t is2bpp = ((params.mode & ImageDecoder::PVRTC_BPP_MASK) == ImageDecoder::PVRTC_2BPP);
+	vector<uint32_t> sdk_buf(params.width * params.height);
+	if (params.isII) {
+		pvr::PVRTDecompressPVRTCII(img_buf.data(), is2bpp, params.width, params.height,
+			reinterpret_cast<uint8_t*>(sdk_buf.data()));
+	} else {
+		pvr::PVRTDecompressPVRTC(img_buf.data(), is2bpp, params.width, params.height,
+			reinterpret_cast<uint8_t*>(sdk_buf.data()));
+	}
+	return sdk_buf;
+}
+
+/**
+ * Decode an image using ImageDecoder.
+ * @param img_buf PVRTC image data.
+ * @param params Test parameters.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *ImageDecoderPVRTCTest::decode(const vector<uint8_t> &img_buf, const PVRTCTestParams &params)
+{
+	if (params.isII) {
+		return ImageDecoder::fromPVRTCII(params.width, params.height,
+			img_buf.data(), static_cast<int>(img_buf.size()), params.mode);
+	} else {
+		return ImageDecoder::fromPVRTC(params.width, params.height,
+			img_buf.data(), static_cast<int>(img_buf.size()), params.mode);
+	}
+}
+
+/**
+ * SetUp() function.
+ * Run before each test.
+ */
+void ImageDecoderPVRTCTest::SetUp(void)
+{
+	const PVRTCTestParams &params = GetParam();
+	m_img_buf = generateImage(params.width, params.height,
+		(params.mode & ImageDecoder::PVRTC_BPP_MASK) == ImageDecoder::PVRTC_2BPP);
+}
+
+/**
+ * Compare the output of a row decoder to decodePVRTCRow_cpp().
+ * @param fn Row decoding function.
+ */
+void ImageDecoderPVRTCTest::CheckRows(decodePVRTCRow_fn fn)
+{
+	const PVRTCTestParams &params = GetParam();
+	const int width = params.width;
+	const int xWords = width / (((params.mode & ImageDecoder::PVRTC_BPP_MASK) == ImageDecoder::PVRTC_2BPP) ? 8 : 4);
+	const uint8_t mode = params.mode | (params.isII ? ImageDecoder::PVRTC_TYPE_II : ImageDecoder::PVRTC_TYPE_I);
+
+	// Pseudo-random colors and modulation values.
+	vector<int16_t> colorsP(xWords * 8), colorsR(xWords * 8);
+	vector<uint8_t> mod(width);
+	uint32_t seed = 0x87654321;
+	for (int i = 0; i < xWords * 8; i++) {
+		// RGB is 5-bit; alpha is 4-bit.
+		const unsigned int mask = ((i & 3) == 3) ? 0xF : 0x1F;
+		seed = (seed * 1103515245U) + 12345U;
+		colorsP[i] = static_cast<int16_t>((seed >> 16) & mask);
+		seed = (seed * 1103515245U) + 12345U;
+		colorsR[i] = static_cast<int16_t>((seed >> 16) & mask);
+	}
+	for (auto iter = mod.begin(); iter != mod.end(); ++iter) {
+		seed = (seed * 1103515245U) + 12345U;
+		*iter = static_cast<uint8_t>((seed >> 16) % (PVRTC_MOD_PUNCHTHROUGH + 1));
+	}
+
+	vector<uint32_t> expected(width), actual(width);
+	for (int j = 0; j < 4; j++) {
+		ImageDecoder::decodePVRTCRow_cpp(expected.data(), width,
+			colorsP.data(), colorsR.data(), j, mod.data(), mode);
+		fn(actual.data(), width, colorsP.data(), colorsR.data(), j, mod.data(), mode);
+		for (int x = 0; x < width; x++) {
+			ASSERT_EQ(expected[x], actual[x]) << "j " << j << ", x " << x;
+		}
+	}
+}
+
+/**
+ * Benchmark a row decoder.
+ * @param fn Row decoding function.
+ */
+void ImageDecoderPVRTCTest::BenchmarkRows(decodePVRTCRow_fn fn)
+{
+	const PVRTCTestParams &params = GetParam();
+	const int width = BENCHMARK_WIDTH;
+	const int xWords = width / (((params.mode & ImageDecoder::PVRTC_BPP_MASK) == ImageDecoder::PVRTC_2BPP) ? 8 : 4);
+	const uint8_t mode = params.mode | (params.isII ? ImageDecoder::PVRTC_TYPE_II : ImageDecoder::PVRTC_TYPE_I);
+
+	vector<int16_t> colors(xWords * 8 * 2);
+	vector<uint8_t> mod(width);
+	uint32_t seed = 0x87654321;
+	for (auto iter = colors.begin(); iter != colors.end(); ++iter) {
+		seed = (seed * 1103515245U) + 12345U;
+		*iter = static_cast<int16_t>((seed >> 16) & 0xF);
+	}
+	for (auto iter = mod.begin(); iter != mod.end(); ++iter) {
+		seed = (seed * 1103515245U) + 12345U;
+		*iter = static_cast<uint8_t>((seed >> 16) % (PVRTC_MOD_PUNCHTHROUGH + 1));
+	}
+
+	vector<uint32_t> row(width);
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		for (int y = 0; y < BENCHMARK_HEIGHT; y++) {
+			fn(row.data(), width, &colors[0], &colors[xWords * 8], y & 3, mod.data(), mode);
+		}
+	}
+}
+
+/**
+ * Compare ImageDecoder to the PowerVR Native SDK.
+ */
+TEST_P(ImageDecoderPVRTCTest, decodeTest)
+{
+	const PVRTCTestParams &params = GetParam();
+	const vector<uint32_t> sdk_buf = decodeSDK(m_img_buf, params);
+
+	rp_image *const img = decode(m_img_buf, params);
+	ASSERT_TRUE(img != nullptr);
+	ASSERT_EQ(params.width, img->width());
+	ASSERT_EQ(params.height, img->height());
+	ASSERT_EQ(rp_image::Format::ARGB32, img->format());
+
+	for (int y = 0; y < params.height; y++) {
+		const uint32_t *const expected = &sdk_buf[y * params.width];
+		const uint32_t *const actual = static_cast<const uint32_t*>(img->scanLine(y));
+		for (int x = 0; x < params.width; x++) {
+			ASSERT_EQ(expected[x], actual[x]) << "x " << x << ", y " << y;
+		}
+	}
+
+	img->unref();
+}
+
+/**
+ * Decode an image smaller than the minimum size.
+ * The PowerVR Native SDK decodes it as a 2x2-word image.
+ */
+TEST_P(ImageDecoderPVRTCTest, smallImageTest)
+{
+	const PVRTCTestParams &params = GetParam();
+	const bool is2bpp = ((params.mode & ImageDecoder::PVRTC_BPP_MASK) == ImageDecoder::PVRTC_2BPP);
+	const PVRTCTestParams minParams(is2bpp ? 16 : 8, 8, params.mode, params.isII);
+	const PVRTCTestParams smallParams(is2bpp ? 8 : 4, 4, params.mode, params.isII);
+
+	// Only the minimum size's data is decoded.
+	const vector<uint8_t> img_buf(m_img_buf.begin(),
+		m_img_buf.begin() + ((minParams.width * minParams.height) / (is2bpp ? 4 : 2)));
+	const vector<uint32_t> sdk_buf = decodeSDK(img_buf, minParams);
+
+	// File format parsers use calcPVRTCImageSize() to determine
+	// how much data to read, so it must include the padding.
+	ASSERT_EQ(img_buf.size(), ImageDecoder::calcPVRTCImageSize(
+		smallParams.width, smallParams.height, params.mode));
+
+	rp_image *const img = decode(img_buf, smallParams);
+	ASSERT_TRUE(img != nullptr);
+	ASSERT_EQ(smallParams.width, img->width());
+	ASSERT_EQ(smallParams.height, img->height());
+
+	for (int y = 0; y < smallParams.height; y++) {
+		const uint32_t *const expected = &sdk_buf[y * minParams.width];
+		const uint32_t *const actual = static_cast<const uint32_t*>(img->scanLine(y));
+		for (int x = 0; x < smallParams.width; x++) {
+			ASSERT_EQ(expected[x], actual[x]) << "x " << x << ", y " << y;
+		}
+	}
+
+	img->unref();
+}
+
+#ifdef IMAGEDECODER_HAS_SSE41
+/**
+ * Test ImageDecoder::decodePVRTCRow(). (SSE4.1-optimized version)
+ */
+TEST_P(ImageDecoderPVRTCTest, decodePVRTCRow_sse41_test)
+{
+	if (!RP_CPU_HasSSE41()) {
+		fprintf(stderr, "*** SSE4.1 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	ASSERT_NO_FATAL_FAILURE(CheckRows(ImageDecoder::decodePVRTCRow_sse41));
+}
+#endif /* IMAGEDECODER_HAS_SSE41 */
+
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Test ImageDecoder::decodePVRTCRow(). (AVX2-optimized version)
+ */
+TEST_P(ImageDecoderPVRTCTest, decodePVRTCRow_avx2_test)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	ASSERT_NO_FATAL_FAILURE(CheckRows(ImageDecoder::decodePVRTCRow_avx2));
+}
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
+/**
+ * Benchmark the PowerVR Native SDK decoder.
+ */
+TEST_P(ImageDecoderPVRTCTest, decodeSDK_benchmark)
+{
+	const PVRTCTestParams &params = GetParam();
+	const PVRTCTestParams bmParams(BENCHMARK_WIDTH, BENCHMARK_HEIGHT, params.mode, params.isII);
+	const vector<uint8_t> img_buf = generateImage(BENCHMARK_WIDTH, BENCHMARK_HEIGHT,
+		(params.mode & ImageDecoder::PVRTC_BPP_MASK) == ImageDecoder::PVRTC_2BPP);
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		const vector<uint32_t> sdk_buf = decodeSDK(img_buf, bmParams);
+	}
+}
+
+/**
+ * Benchmark ImageDecoder.
+ */
+TEST_P(ImageDecoderPVRTCTest, decode_benchmark)
+{
+	const PVRTCTestParams &params = GetParam();
+	const PVRTCTestParams bmParams(BENCHMARK_WIDTH, BENCHMARK_HEIGHT, params.mode, params.isII);
+	const vector<uint8_t> img_buf = generateImage(BENCHMARK_WIDTH, BENCHMARK_HEIGHT,
+		(params.mode & ImageDecoder::PVRTC_BPP_MASK) == ImageDecoder::PVRTC_2BPP);
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const img = decode(img_buf, bmParams);
+		ASSERT_TRUE(img != nullptr);
+		img->unref();
+	}
+}
+
+/**
+ * Benchmark ImageDecoder::decodePVRTCRow(). (Standard version)
+ */
+TEST_P(ImageDecoderPVRTCTest, decodePVRTCRow_cpp_benchmark)
+{
+	BenchmarkRows(ImageDecoder::decodePVRTCRow_cpp);
+}
+
+#ifdef IMAGEDECODER_HAS_SSE41
+/**
+ * Benchmark ImageDecoder::decodePVRTCRow(). (SSE4.1-optimized version)
+ */
+TEST_P(ImageDecoderPVRTCTest, decodePVRTCRow_sse41_benchmark)
+{
+	if (!RP_CPU_HasSSE41()) {
+		fprintf(stderr, "*** SSE4.1 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	BenchmarkRows(ImageDecoder::decodePVRTCRow_sse41);
+}
+#endif /* IMAGEDECODER_HAS_SSE41 */
+
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Benchmark ImageDecoder::decodePVRTCRow(). (AVX2-optimized version)
+ */
+TEST_P(ImageDecoderPVRTCTest, decodePVRTCRow_avx2_benchmark)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	BenchmarkRows(ImageDecoder::decodePVRTCRow_avx2);
+}
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
+// NOTE: Non-square images test the Morton order fallback for
+// the larger dimension. 1024x1024 is large enough to use
+// multi-threaded decoding.
+INSTANTIATE_TEST_SUITE_P(fromPVRTC, ImageDecoderPVRTCTest,
+	::testing::Values(
+		PVRTCTestParams(64, 64, ImageDecoder::PVRTC_4BPP | ImageDecoder::PVRTC_ALPHA_YES, false),
+		PVRTCTestParams(128, 32, ImageDecoder::PVRTC_4BPP | ImageDecoder::PVRTC_ALPHA_YES, false),
+		PVRTCTestParams(32, 256, ImageDecoder::PVRTC_4BPP | ImageDecoder::PVRTC_ALPHA_YES, false),
+		PVRTCTestParams(1024, 1024, ImageDecoder::PVRTC_4BPP | ImageDecoder::PVRTC_ALPHA_YES, false),
+		PVRTCTestParams(64, 64, ImageDecoder::PVRTC_2BPP | ImageDecoder::PVRTC_ALPHA_YES, false),
+		PVRTCTestParams(256, 32, ImageDecoder::PVRTC_2BPP | ImageDecoder::PVRTC_ALPHA_YES, false),
+		PVRTCTestParams(16, 128, ImageDecoder::PVRTC_2BPP | ImageDecoder::PVRTC_ALPHA_YES, false),
+		PVRTCTestParams(1024, 1024, ImageDecoder::PVRTC_2BPP | ImageDecoder::PVRTC_ALPHA_YES, false)),
+	ImageDecoderPVRTCTest::test_case_suffix_generator);
+
+INSTANTIATE_TEST_SUITE_P(fromPVRTCII, ImageDecoderPVRTCTest,
+	::testing::Values(
+		PVRTCTestParams(64, 64, ImageDecoder::PVRTC_4BPP, true),
+		PVRTCTestParams(100, 36, ImageDecoder::PVRTC_4BPP, true),
+		PVRTCTestParams(1024, 1024, ImageDecoder::PVRTC_4BPP, true),
+		PVRTCTestParams(64, 64, ImageDecoder::PVRTC_2BPP, true),
+		PVRTCTestParams(200, 36, ImageDecoder::PVRTC_2BPP, true),
+		PVRTCTestParams(1024, 1024, ImageDecoder::PVRTC_2BPP, true)),
+	ImageDecoderPVRTCTest::test_case_suffix_generator);
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpTexture test suite: ImageDecoder PVRTC tests.\n\n");
+	fprintf(stderr, "Benchmark iterations: %u\n",
+		LibRpTexture::Tests::ImageDecoderPVRTCTest::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,345 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture/tests)               *
+ * ImageDecoderSwizzleTest.cpp: Dreamcast twiddled and 3DS tiled image     *
+ * decoding tests.                                                         *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librptexture, librpcpu
+#include "librptexture/img/rp_image.hpp"
+#include "librptexture/decoder/ImageDecoder.hpp"
+
+// C includes.
+#include <stdint.h>
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibRpTexture { namespace Tests {
+
+class ImageDecoderSwizzleTest : public ::testing::Test
+{
+	protected:
+		void SetUp(void) final;
+
+	public:
+		// Image dimensions.
+		static const int WIDTH = 256;
+		static const int HEIGHT = 256;
+
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 1000;
+
+		// Source data. (pseudo-random)
+		vector<uint8_t> m_buf;
+
+		/**
+		 * Get the source data as 16-bit pixels.
+		 * @return 16-bit pixels.
+		 */
+		inline const uint16_t *buf16(void) const
+		{
+			return reinterpret_cast<const uint16_t*>(m_buf.data());
+		}
+
+		/**
+		 * Compare two rp_images, then unreference them.
+		 * @param pImgExpected Expected image.
+		 * @param pImgActual Actual image.
+		 */
+		static void CompareImages(rp_image *pImgExpected, rp_image *pImgActual);
+};
+
+const int ImageDecoderSwizzleTest::WIDTH;
+const int ImageDecoderSwizzleTest::HEIGHT;
+
+/**
+ * SetUp() function.
+ * Run before each test.
+ */
+void ImageDecoderSwizzleTest::SetUp(void)
+{
+	m_buf.resize(WIDTH * HEIGHT * 2);
+	uint32_t seed = 0x12345678;
+	for (auto iter = m_buf.begin(); iter != m_buf.end(); ++iter) {
+		seed = (seed * 1103515245U) + 12345U;
+		*iter = static_cast<uint8_t>(seed >> 16);
+	}
+}
+
+/**
+ * Compare two rp_images, then unreference them.
+ * @param pImgExpected Expected image.
+ * @param pImgActual Actual image.
+ */
+void ImageDecoderSwizzleTest::CompareImages(rp_image *pImgExpected, rp_image *pImgActual)
+{
+	ASSERT_TRUE(pImgExpected != nullptr);
+	ASSERT_TRUE(pImgActual != nullptr);
+	ASSERT_EQ(pImgExpected->width(), pImgActual->width());
+	ASSERT_EQ(pImgExpected->height(), pImgActual->height());
+
+	const size_t row_bytes = pImgExpected->width() * sizeof(uint32_t);
+	for (int y = 0; y < pImgExpected->height(); y++) {
+		ASSERT_EQ(0, memcmp(pImgExpected->scanLine(y), pImgActual->scanLine(y), row_bytes))
+			<< "row " << y;
+	}
+
+	rp_image::sBIT_t sBIT_expected, sBIT_actual;
+	ASSERT_EQ(0, pImgExpected->get_sBIT(&sBIT_expected));
+	ASSERT_EQ(0, pImgActual->get_sBIT(&sBIT_actual));
+	EXPECT_EQ(0, memcmp(&sBIT_expected, &sBIT_actual, sizeof(sBIT_expected)));
+
+	pImgExpected->unref();
+	pImgActual->unref();
+}
+
+#ifdef IMAGEDECODER_HAS_SSE2
+/**
+ * Test ImageDecoder::fromDreamcastSquareTwiddled16(). (SSE2-optimized version)
+ */
+TEST_F(ImageDecoderSwizzleTest, fromDreamcastSquareTwiddled16_sse2_test)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fprintf(stderr, "*** SSE2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	static const ImageDecoder::PixelFormat pxfs[] = {
+		ImageDecoder::PXF_ARGB1555, ImageDecoder::PXF_RGB565, ImageDecoder::PXF_ARGB4444
+	};
+	// Includes a width that isn't a power of 2.
+	static const int widths[] = {4, 8, 64, 256, 12};
+
+	const int img_siz = static_cast<int>(m_buf.size());
+	for (unsigned int i = 0; i < ARRAY_SIZE(pxfs); i++) {
+		for (unsigned int j = 0; j < ARRAY_SIZE(widths); j++) {
+			const int w = widths[j];
+			SCOPED_TRACE(::testing::Message() << "pxf " << pxfs[i] << ", width " << w);
+			ASSERT_NO_FATAL_FAILURE(CompareImages(
+				ImageDecoder::fromDreamcastSquareTwiddled16_cpp(pxfs[i], w, w, buf16(), img_siz),
+				ImageDecoder::fromDreamcastSquareTwiddled16_sse2(pxfs[i], w, w, buf16(), img_siz)));
+		}
+	}
+}
+
+/**
+ * Test ImageDecoder::fromDreamcastVQ16(). (SSE2-optimized version)
+ */
+TEST_F(ImageDecoderSwizzleTest, fromDreamcastVQ16_sse2_test)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fprintf(stderr, "*** SSE2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	static const ImageDecoder::PixelFormat pxfs[] = {
+		ImageDecoder::PXF_ARGB1555, ImageDecoder::PXF_RGB565, ImageDecoder::PXF_ARGB4444
+	};
+
+	// VQ: 1024-entry palette, followed by the codes.
+	const uint16_t *const pal_buf = buf16();
+	const uint8_t *const img_buf = &m_buf[1024*2];
+	const int img_siz = static_cast<int>(m_buf.size() - (1024*2));
+	for (unsigned int i = 0; i < ARRAY_SIZE(pxfs); i++) {
+		SCOPED_TRACE(::testing::Message() << "pxf " << pxfs[i]);
+		ASSERT_NO_FATAL_FAILURE(CompareImages(
+			ImageDecoder::fromDreamcastVQ16_cpp(pxfs[i], false, false,
+				WIDTH, HEIGHT, img_buf, img_siz, pal_buf, 1024*2),
+			ImageDecoder::fromDreamcastVQ16_sse2(pxfs[i], false, false,
+				WIDTH, HEIGHT, img_buf, img_siz, pal_buf, 1024*2)));
+	}
+
+	// SmallVQ: 32x32 has 128 palette entries, so use codes 0-31.
+	vector<uint8_t> codes(16*16);
+	for (unsigned int i = 0; i < codes.size(); i++) {
+		codes[i] = m_buf[i] & 31;
+	}
+	const int pal_entries = ImageDecoder::calcDreamcastSmallVQPaletteEntries_NoMipmaps(32);
+	ASSERT_NO_FATAL_FAILURE(CompareImages(
+		ImageDecoder::fromDreamcastVQ16_cpp(ImageDecoder::PXF_RGB565, true, false,
+			32, 32, codes.data(), static_cast<int>(codes.size()), pal_buf, pal_entries*2),
+		ImageDecoder::fromDreamcastVQ16_sse2(ImageDecoder::PXF_RGB565, true, false,
+			32, 32, codes.data(), static_cast<int>(codes.size()), pal_buf, pal_entries*2)));
+
+	// SmallVQ with an out-of-range code must fail.
+	codes[codes.size() - 1] = 32;
+	rp_image *const img = ImageDecoder::fromDreamcastVQ16_sse2(ImageDecoder::PXF_RGB565, true, false,
+		32, 32, codes.data(), static_cast<int>(codes.size()), pal_buf, pal_entries*2);
+	EXPECT_TRUE(img == nullptr);
+	UNREF(img);
+}
+
+/**
+ * Test ImageDecoder::fromN3DSTiledRGB565(). (SSE2-optimized version)
+ */
+TEST_F(ImageDecoderSwizzleTest, fromN3DSTiledRGB565_sse2_test)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fprintf(stderr, "*** SSE2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	// 24x24 is the 3DS small icon size.
+	const int img_siz = static_cast<int>(m_buf.size());
+	ASSERT_NO_FATAL_FAILURE(CompareImages(
+		ImageDecoder::fromN3DSTiledRGB565_cpp(WIDTH, HEIGHT, buf16(), img_siz),
+		ImageDecoder::fromN3DSTiledRGB565_sse2(WIDTH, HEIGHT, buf16(), img_siz)));
+	ASSERT_NO_FATAL_FAILURE(CompareImages(
+		ImageDecoder::fromN3DSTiledRGB565_cpp(24, 24, buf16(), img_siz),
+		ImageDecoder::fromN3DSTiledRGB565_sse2(24, 24, buf16(), img_siz)));
+}
+
+/**
+ * Test ImageDecoder::fromN3DSTiledRGB565_A4(). (SSE2-optimized version)
+ */
+TEST_F(ImageDecoderSwizzleTest, fromN3DSTiledRGB565_A4_sse2_test)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fprintf(stderr, "*** SSE2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	// Use the second half of the buffer for the alpha channel.
+	const int w = WIDTH, h = HEIGHT / 2;
+	const int img_siz = w * h * 2;
+	const uint8_t *const alpha_buf = &m_buf[img_siz];
+	const int alpha_siz = (w * h) / 2;
+	ASSERT_NO_FATAL_FAILURE(CompareImages(
+		ImageDecoder::fromN3DSTiledRGB565_A4_cpp(w, h, buf16(), img_siz, alpha_buf, alpha_siz),
+		ImageDecoder::fromN3DSTiledRGB565_A4_sse2(w, h, buf16(), img_siz, alpha_buf, alpha_siz)));
+}
+#endif /* IMAGEDECODER_HAS_SSE2 */
+
+/**
+ * Benchmark ImageDecoder::fromDreamcastSquareTwiddled16(). (Standard version)
+ */
+TEST_F(ImageDecoderSwizzleTest, fromDreamcastSquareTwiddled16_cpp_benchmark)
+{
+	const int img_siz = static_cast<int>(m_buf.size());
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const img = ImageDecoder::fromDreamcastSquareTwiddled16_cpp(
+			ImageDecoder::PXF_ARGB1555, WIDTH, HEIGHT, buf16(), img_siz);
+		ASSERT_TRUE(img != nullptr);
+		img->unref();
+	}
+}
+
+/**
+ * Benchmark ImageDecoder::fromDreamcastVQ16(). (Standard version)
+ */
+TEST_F(ImageDecoderSwizzleTest, fromDreamcastVQ16_cpp_benchmark)
+{
+	const int img_siz = static_cast<int>(m_buf.size() - (1024*2));
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const img = ImageDecoder::fromDreamcastVQ16_cpp(
+			ImageDecoder::PXF_RGB565, false, false, WIDTH, HEIGHT,
+			&m_buf[1024*2], img_siz, buf16(), 1024*2);
+		ASSERT_TRUE(img != nullptr);
+		img->unref();
+	}
+}
+
+/**
+ * Benchmark ImageDecoder::fromN3DSTiledRGB565(). (Standard version)
+ */
+TEST_F(ImageDecoderSwizzleTest, fromN3DSTiledRGB565_cpp_benchmark)
+{
+	const int img_siz = static_cast<int>(m_buf.size());
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const img = ImageDecoder::fromN3DSTiledRGB565_cpp(
+			WIDTH, HEIGHT, buf16(), img_siz);
+		ASSERT_TRUE(img != nullptr);
+		img->unref();
+	}
+}
+
+#ifdef IMAGEDECODER_HAS_SSE2
+/**
+ * Benchmark ImageDecoder::fromDreamcastSquareTwiddled16(). (SSE2-optimized version)
+ */
+TEST_F(ImageDecoderSwizzleTest, fromDreamcastSquareTwiddled16_sse2_benchmark)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fprintf(stderr, "*** SSE2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	const int img_siz = static_cast<int>(m_buf.size());
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const img = ImageDecoder::fromDreamcastSquareTwiddled16_sse2(
+			ImageDecoder::PXF_ARGB1555, WIDTH, HEIGHT, buf16(), img_siz);
+		ASSERT_TRUE(img != nullptr);
+		img->unref();
+	}
+}
+
+/**
+ * Benchmark ImageDecoder::fromDreamcastVQ16(). (SSE2-optimized version)
+ */
+TEST_F(ImageDecoderSwizzleTest, fromDreamcastVQ16_sse2_benchmark)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fprintf(stderr, "*** SSE2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	const int img_siz = static_cast<int>(m_buf.size() - (1024*2));
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const img = ImageDecoder::fromDreamcastVQ16_sse2(
+			ImageDecoder::PXF_RGB565, false, false, WIDTH, HEIGHT,
+			&m_buf[1024*2], img_siz, buf16(), 1024*2);
+		ASSERT_TRUE(img != nullptr);
+		img->unref();
+	}
+}
+
+/**
+ * Benchmark ImageDecoder::fromN3DSTiledRGB565(). (SSE2-optimized version)
+ */
+TEST_F(ImageDecoderSwizzleTest, fromN3DSTiledRGB565_sse2_benchmark)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fprintf(stderr, "*** SSE2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	const int img_siz = static_cast<int>(m_buf.size());
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const img = ImageDecoder::fromN3DSTiledRGB565_sse2(
+			WIDTH, HEIGHT, buf16(), img_siz);
+		ASSERT_TRUE(img != nullptr);
+		img->unref();
+	}
+}
+#endif /* IMAGEDECODER_HAS_SSE2 */
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpTexture test suite: ImageDecoder swizzled texture tests.\n\n");
+	fprintf(stderr, "Benchmark iterations: %u\n",
+		LibRpTexture::Tests::ImageDecoderSwizzleTest::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,386 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture/tests)               *
+ * RpImagePoolTest.cpp: rp_image_pool tests.                               *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librptexture
+#include "librptexture/img/rp_image.hpp"
+#include "librptexture/img/rp_image_pool.hpp"
+
+// C includes.
+#include <stdint.h>
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibRpTexture { namespace Tests {
+
+class RpImagePoolTest : public ::testing::Test
+{
+	protected:
+		RpImagePoolTest()
+			: ::testing::Test()
+		{ }
+
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 200;
+
+		/**
+		 * Simulate thumbnailing a batch of files.
+		 * Each "file" decodes an image, then converts it the
+		 * same way the thumbnailers do.
+		 * @param iterations Number of batches.
+		 */
+		static void thumbnailBatch(unsigned int iterations);
+
+		/**
+		 * Print the pool statistics.
+		 * @param title Title.
+		 */
+		static void printStats(const char *title);
+};
+
+/**
+ * SetUp() function.
+ * Run before each test.
+ */
+void RpImagePoolTest::SetUp(void)
+{
+	rp_image_pool::setEnabled(true);
+	rp_image_pool::clear();
+	rp_image_pool::resetStats();
+}
+
+/**
+ * TearDown() function.
+ * Run after each test.
+ */
+void RpImagePoolTest::TearDown(void)
+{
+	rp_image_pool::setEnabled(true);
+	rp_image_pool::clear();
+}
+
+/**
+ * Simulate thumbnailing a batch of files.
+ * Each "file" decodes an image, then converts it the
+ * same way the thumbnailers do.
+ * @param iterations Number of batches.
+ */
+void RpImagePoolTest::thumbnailBatch(unsigned int iterations)
+{
+	// Typical icon and texture sizes.
+	static const struct {
+		int width, height;
+		rp_image::Format format;
+	} batch[] = {
+		{  32,  32, rp_image::Format::CI8},
+		{  48,  48, rp_image::Format::ARGB32},
+		{  96,  32, rp_image::Format::CI8},	// Banner
+		{ 128, 128, rp_image::Format::ARGB32},
+		{ 256, 192, rp_image::Format::ARGB32},
+		{ 256, 256, rp_image::Format::CI8},
+		{ 512, 512, rp_image::Format::ARGB32},
+	};
+
+	for (; iterations > 0; iterations--) {
+		for (unsigned int i = 0; i < ARRAY_SIZE(batch); i++) {
+			rp_image *const img = new rp_image(batch[i].width, batch[i].height, batch[i].format);
+			rp_image *const argb = img->dup_ARGB32();
+			rp_image *const sq = argb->squared();
+			rp_image *const flipped = sq->flip(rp_image::FLIP_V);
+			flipped->unref();
+			sq->unref();
+			argb->unref();
+			img->unref();
+		}
+	}
+}
+
+/**
+ * Print the pool statistics.
+ * @param title Title.
+ */
+void RpImagePoolTest::printStats(const char *title)
+{
+	rp_image_pool::Stats stats;
+	rp_image_pool::getStats(&stats);
+	fprintf(stderr, "%s: allocs: %llu, hits: %llu, misses: %llu, oversize: %llu, "
+		"frees: %llu, discards: %llu, peak cached: %u KiB\n", title,
+		(unsigned long long)stats.allocs, (unsigned long long)stats.hits,
+		(unsigned long long)stats.misses, (unsigned long long)stats.oversize,
+		(unsigned long long)stats.frees, (unsigned long long)stats.discards,
+		(unsigned int)(stats.peak_cached_bytes / 1024));
+}
+
+/**
+ * Test rp_image_pool::sizeClass().
+ */
+TEST_F(RpImagePoolTest, sizeClassTest)
+{
+	size_t class_size = 0;
+
+	// Smallest size class.
+	EXPECT_EQ(0, rp_image_pool::sizeClass(1, &class_size));
+	EXPECT_EQ(256U, class_size);
+	EXPECT_EQ(0, rp_image_pool::sizeClass(256, &class_size));
+	EXPECT_EQ(256U, class_size);
+
+	// Quarter steps between powers of two.
+	EXPECT_EQ(1, rp_image_pool::sizeClass(257, &class_size));
+	EXPECT_EQ(320U, class_size);
+	EXPECT_EQ(4, rp_image_pool::sizeClass(512, &class_size));
+	EXPECT_EQ(512U, class_size);
+	EXPECT_EQ(5, rp_image_pool::sizeClass(513, &class_size));
+	EXPECT_EQ(640U, class_size);
+	EXPECT_EQ(rp_image_pool::sizeClass(64*1024), rp_image_pool::sizeClass(64*1024 - 1));
+
+	// Largest size class.
+	EXPECT_EQ((int)rp_image_pool::SIZE_CLASS_COUNT - 1,
+		rp_image_pool::sizeClass(rp_image_pool::MAX_POOLED_SIZE, &class_size));
+	EXPECT_EQ(rp_image_pool::MAX_POOLED_SIZE, class_size);
+	EXPECT_EQ(-1, rp_image_pool::sizeClass(rp_image_pool::MAX_POOLED_SIZE + 1));
+
+	// Every size must fit in its class, and the class
+	// must not waste more than 25% of the buffer.
+	int last_idx = 0;
+	for (size_t size = 1; size <= rp_image_pool::MAX_POOLED_SIZE; size += (size / 7) + 1) {
+		const int idx = rp_image_pool::sizeClass(size, &class_size);
+		ASSERT_GE(idx, last_idx) << "size " << size;
+		ASSERT_LT(idx, (int)rp_image_pool::SIZE_CLASS_COUNT) << "size " << size;
+		ASSERT_GE(class_size, size);
+		ASSERT_EQ(0U, class_size % rp_image_pool::ALIGNMENT) << "size " << size;
+		if (size > rp_image_pool::MIN_POOLED_SIZE) {
+			ASSERT_LT(class_size - size, class_size / 4) << "size " << size;
+		}
+		last_idx = idx;
+	}
+}
+
+/**
+ * Allocated buffers must be aligned for SIMD.
+ */
+TEST_F(RpImagePoolTest, alignmentTest)
+{
+	static const size_t sizes[] = {1, 100, 256, 1000, 4096, 65537, 1048576,
+		rp_image_pool::MAX_POOLED_SIZE + 1};
+	for (unsigned int i = 0; i < ARRAY_SIZE(sizes); i++) {
+		void *const ptr = rp_image_pool::allocate(sizes[i]);
+		ASSERT_TRUE(ptr != nullptr);
+		EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(ptr) % rp_image_pool::ALIGNMENT) << "size " << sizes[i];
+		// Make sure the whole buffer is writable.
+		memset(ptr, 0x55, sizes[i]);
+		rp_image_pool::deallocate(ptr, sizes[i]);
+	}
+}
+
+/**
+ * Freed buffers are reused by allocations in the same size class.
+ */
+TEST_F(RpImagePoolTest, reuseTest)
+{
+	void *const ptr1 = rp_image_pool::allocate(1000);
+	ASSERT_TRUE(ptr1 != nullptr);
+	rp_image_pool::deallocate(ptr1, 1000);
+
+	rp_image_pool::Stats stats;
+	rp_image_pool::getStats(&stats);
+	EXPECT_EQ(1U, stats.cached_buffers);
+	EXPECT_EQ(1024U, stats.cached_bytes);
+
+	// Different size, same size class.
+	void *const ptr2 = rp_image_pool::allocate(1020);
+	EXPECT_EQ(ptr1, ptr2);
+
+	// The cached buffer was taken, so this must be a new buffer.
+	void *const ptr3 = rp_image_pool::allocate(1000);
+	EXPECT_NE(ptr2, ptr3);
+
+	rp_image_pool::getStats(&stats);
+	EXPECT_EQ(3U, stats.allocs);
+	EXPECT_EQ(1U, stats.hits);
+	EXPECT_EQ(2U, stats.misses);
+	EXPECT_EQ(0U, stats.cached_buffers);
+	EXPECT_EQ(0U, stats.cached_bytes);
+
+	rp_image_pool::deallocate(ptr2, 1020);
+	rp_image_pool::deallocate(ptr3, 1000);
+	rp_image_pool::getStats(&stats);
+	EXPECT_EQ(3U, stats.frees);
+	EXPECT_EQ(2U, stats.cached_buffers);
+
+	rp_image_pool::clear();
+	rp_image_pool::getStats(&stats);
+	EXPECT_EQ(0U, stats.cached_buffers);
+	EXPECT_EQ(0U, stats.cached_bytes);
+}
+
+/**
+ * The pool must not cache more than MAX_CACHED_PER_CLASS
+ * buffers per size class, or more than MAX_CACHED_BYTES total.
+ */
+TEST_F(RpImagePoolTest, limitsTest)
+{
+	static const unsigned int COUNT = rp_image_pool::MAX_CACHED_PER_CLASS + 4;
+	vector<void*> ptrs(COUNT);
+	for (unsigned int i = 0; i < COUNT; i++) {
+		ptrs[i] = rp_image_pool::allocate(4096);
+		ASSERT_TRUE(ptrs[i] != nullptr);
+	}
+	for (unsigned int i = 0; i < COUNT; i++) {
+		rp_image_pool::deallocate(ptrs[i], 4096);
+	}
+
+	rp_image_pool::Stats stats;
+	rp_image_pool::getStats(&stats);
+	EXPECT_EQ(rp_image_pool::MAX_CACHED_PER_CLASS, stats.cached_buffers);
+	EXPECT_EQ(4U, stats.discards);
+
+	// Two 16 MiB buffers fill the byte budget.
+	// Anything else is discarded.
+	rp_image_pool::clear();
+	void *const big1 = rp_image_pool::allocate(rp_image_pool::MAX_POOLED_SIZE);
+	void *const big2 = rp_image_pool::allocate(rp_image_pool::MAX_POOLED_SIZE);
+	void *const small = rp_image_pool::allocate(256);
+	ASSERT_TRUE(big1 != nullptr);
+	ASSERT_TRUE(big2 != nullptr);
+	ASSERT_TRUE(small != nullptr);
+	rp_image_pool::deallocate(big1, rp_image_pool::MAX_POOLED_SIZE);
+	rp_image_pool::deallocate(big2, rp_image_pool::MAX_POOLED_SIZE);
+	rp_image_pool::deallocate(small, 256);
+	rp_image_pool::getStats(&stats);
+	EXPECT_EQ(2U, stats.cached_buffers);
+	EXPECT_EQ(rp_image_pool::MAX_CACHED_BYTES, stats.cached_bytes);
+}
+
+/**
+ * Oversized allocations bypass the pool.
+ */
+TEST_F(RpImagePoolTest, oversizeTest)
+{
+	const size_t size = rp_image_pool::MAX_POOLED_SIZE + 1;
+	void *const ptr = rp_image_pool::allocate(size);
+	ASSERT_TRUE(ptr != nullptr);
+	rp_image_pool::deallocate(ptr, size);
+
+	rp_image_pool::Stats stats;
+	rp_image_pool::getStats(&stats);
+	EXPECT_EQ(1U, stats.allocs);
+	EXPECT_EQ(1U, stats.oversize);
+	EXPECT_EQ(0U, stats.hits);
+	EXPECT_EQ(0U, stats.misses);
+	EXPECT_EQ(0U, stats.cached_buffers);
+	EXPECT_EQ(0U, stats.discards);
+}
+
+/**
+ * A disabled pool doesn't cache anything.
+ */
+TEST_F(RpImagePoolTest, disabledTest)
+{
+	void *const ptr1 = rp_image_pool::allocate(4096);
+	rp_image_pool::deallocate(ptr1, 4096);
+
+	rp_image_pool::setEnabled(false);
+	EXPECT_FALSE(rp_image_pool::isEnabled());
+
+	rp_image_pool::Stats stats;
+	rp_image_pool::getStats(&stats);
+	EXPECT_EQ(0U, stats.cached_buffers);
+
+	void *const ptr2 = rp_image_pool::allocate(4096);
+	ASSERT_TRUE(ptr2 != nullptr);
+	rp_image_pool::deallocate(ptr2, 4096);
+	rp_image_pool::getStats(&stats);
+	EXPECT_EQ(0U, stats.cached_buffers);
+	EXPECT_EQ(0U, stats.hits);
+}
+
+/**
+ * rp_image uses the pool for image data and palettes.
+ */
+TEST_F(RpImagePoolTest, rpImageTest)
+{
+	rp_image *img = new rp_image(64, 64, rp_image::Format::CI8);
+	ASSERT_TRUE(img->isValid());
+	EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(img->bits()) % rp_image_pool::ALIGNMENT);
+	EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(img->palette()) % rp_image_pool::ALIGNMENT);
+
+	// Palette must be zero-initialized, even if reused.
+	memset(img->palette(), 0xFF, img->palette_len() * sizeof(uint32_t));
+	void *const bits = img->bits();
+	img->unref();
+
+	img = new rp_image(64, 64, rp_image::Format::CI8);
+	ASSERT_TRUE(img->isValid());
+	EXPECT_EQ(bits, img->bits());
+	const uint32_t *const palette = img->palette();
+	for (int i = 0; i < img->palette_len(); i++) {
+		ASSERT_EQ(0U, palette[i]) << "palette entry " << i;
+	}
+
+	// Shrinking must not break deallocation.
+	ASSERT_EQ(0, img->shrink(17, 9));
+	img->unref();
+
+	rp_image_pool::Stats stats;
+	rp_image_pool::getStats(&stats);
+	EXPECT_EQ(4U, stats.allocs);
+	EXPECT_EQ(2U, stats.hits);
+	EXPECT_EQ(4U, stats.frees);
+	EXPECT_EQ(2U, stats.cached_buffers);
+}
+
+/**
+ * Benchmark a thumbnail batch with the pool enabled.
+ */
+TEST_F(RpImagePoolTest, thumbnailBatch_pool_benchmark)
+{
+	thumbnailBatch(BENCHMARK_ITERATIONS);
+	printStats("Pool enabled");
+}
+
+/**
+ * Benchmark a thumbnail batch with the pool disabled.
+ */
+TEST_F(RpImagePoolTest, thumbnailBatch_nopool_benchmark)
+{
+	rp_image_pool::setEnabled(false);
+	thumbnailBatch(BENCHMARK_ITERATIONS);
+	printStats("Pool disabled");
+}
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpTexture test suite: rp_image_pool tests.\n\n");
+	fprintf(stderr, "Benchmark iterations: %u\n",
+		LibRpTexture::Tests::RpImagePoolTest::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -84,8 +84,73 @@ TEST_F(UnPremultiplyTest, un_premultiply_sse41_benchmark)
 }
 #endif /* RP_IMAGE_HAS_SSE41 */
 
+#ifdef RP_IMAGE_HAS_AVX2
+/**
+ * Benchmark the ImageDecoder::un_premultiply() function. (AVX2-optimized version)
+ */
+TEST_F(UnPremultiplyTest, un_premultiply_avx2_benchmark)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		m_img->un_premultiply_avx2();
+	}
+}
+
+/**
+ * Compare the AVX2 un_premultiply() function to the standard version.
+ * The image width isn't a multiple of 8, so the masked remainder is tested.
+ */
+TEST_F(UnPremultiplyTest, un_premultiply_avx2_test)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	rp_image *const img_cpp = new rp_image(61, 7, rp_image::Format::ARGB32);
+	rp_image *const img_avx2 = new rp_image(61, 7, rp_image::Format::ARGB32);
+	ASSERT_TRUE(img_cpp->isValid());
+	ASSERT_TRUE(img_avx2->isValid());
+
+	// Fill the image with pseudo-random premultiplied pixels.
+	// Include some fully transparent and fully opaque pixels.
+	uint32_t seed = 0x12345678;
+	for (int y = 0; y < img_cpp->height(); y++) {
+		uint32_t *const px = static_cast<uint32_t*>(img_cpp->scanLine(y));
+		for (int x = 0; x < img_cpp->width(); x++) {
+			seed = (seed * 1103515245U) + 12345U;
+			unsigned int a = (seed >> 24);
+			switch (x % 5) {
+				case 0:	a = 0; break;
+				case 1:	a = 255; break;
+				default: break;
+			}
+			const unsigned int r = ((seed >> 16) & 0xFF) * a / 255;
+			const unsigned int g = ((seed >>  8) & 0xFF) * a / 255;
+			const unsigned int b = ((seed >> 20) & 0xFF) * a / 255;
+			px[x] = (a << 24) | (r << 16) | (g << 8) | b;
+		}
+		memcpy(img_avx2->scanLine(y), px, img_cpp->width() * sizeof(uint32_t));
+	}
+
+	img_cpp->un_premultiply_cpp();
+	img_avx2->un_premultiply_avx2();
+	for (int y = 0; y < img_cpp->height(); y++) {
+		EXPECT_EQ(0, memcmp(img_cpp->scanLine(y), img_avx2->scanLine(y),
+			img_cpp->width() * sizeof(uint32_t))) << "row " << y;
+	}
+
+	img_cpp->unref();
+	img_avx2->unref();
+}
+#endif /* RP_IMAGE_HAS_AVX2 */
+
 // NOTE: Add more instruction sets to the #ifdef if other optimizations are added.
-#if defined(RP_IMAGE_HAS_SSE41)
+#if defined(RP_IMAGE_HAS_SSE41) || defined(RP_IMAGE_HAS_AVX2)
 /**
  * Benchmark the ImageDecoder::un_premultiply() dispatch function.
  */
@@ -95,7 +160,7 @@ TEST_F(UnPremultiplyTest, un_premultiply_dispatch_benchmark)
 		m_img->un_premultiply();
 	}
 }
-#endif /* RP_IMAGE_HAS_SSE41 */
+#endif /* RP_IMAGE_HAS_SSE41 || RP_IMAGE_HAS_AVX2 */
 
 /**
  * Benchmark the ImageDecoder::premultiply() function. (Standard version)
@@ -22,6 +22,8 @@
 #include "librpbase/img/RpPng.hpp"
 #include "librpbase/img/IconAnimData.hpp"
 #include "librpbase/TextOut.hpp"
+#include "librpbase/crypto/StreamHasher.hpp"
+#include "librpbase/disc/IPartition.hpp"
 #include "libi18n/i18n.h"
 using namespace LibRpBase;
 
@@ -33,7 +35,9 @@ using namespace LibRpFile;
 
 // libromdata
 #include "libromdata/RomDataFactory.hpp"
+#include "libromdata/disc/FstExtractor.hpp"
 using LibRomData::RomDataFactory;
+using LibRomData::FstExtractor;
 
 // librptexture
 #include "librptexture/img/rp_image.hpp"
@@ -42,6 +46,9 @@ using LibRpTexture::rp_image;
 #ifdef _WIN32
 // libwin32common
 # include "libwin32common/RpWin32_sdk.h"
+// _setmode()
+# include <fcntl.h>
+# include <io.h>
 #endif /* _WIN32 */
 
 #ifdef ENABLE_DECRYPTION
@@ -68,6 +75,7 @@ using LibRpTexture::rp_image;
 
 // C++ includes.
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <locale>
 #include <string>
@@ -97,6 +105,14 @@ struct ExtractParam {
 		: filename(filename), image_type(image_type) { }
 };
 
+struct FstExtractParam {
+	const char *path;	// File or directory path within the file system.
+	const char *outDir;	// Output directory. Can be null due to argv[argc]
+
+	FstExtractParam(const char *path, const char *outDir)
+		: path(path), outDir(outDir) { }
+};
+
 /**
 * Extracts images from romdata
 * @param romData RomData containing the images
@@ -164,21 +180,122 @@ static void ExtractImages(const RomData *romData, vector<ExtractParam>& extract)
 	}
 }
 
+/**
+ * Lists and extracts files from the ROM's file system
+ * @param romData RomData containing the file system
+ * @param fstList List the file system?
+ * @param fstExtract Vector of file system extraction parameters
+ */
+static void DoFst(const RomData *romData, bool fstList, const vector<FstExtractParam>& fstExtract)
+{
+	if (!fstList && fstExtract.empty())
+		return;
+
+	IPartition *const partition = const_cast<RomData*>(romData)->openFstPartition();
+	if (!partition) {
+		cerr << "-- " << C_("rpcli", "ROM does not have a file system") << endl;
+		return;
+	}
+
+	FstExtractor extractor(partition);
+	partition->unref();
+
+	if (fstList) {
+		vector<FstExtractor::Entry> entries;
+		int ret = extractor.list("/", entries);
+		if (ret != 0) {
+			cerr << "-- " << rp_sprintf(C_("rpcli", "Couldn't list the file system: %s"), strerror(-ret)) << endl;
+		}
+
+		// Directories are listed without an address or size.
+		const auto entries_cend = entries.cend();
+		for (auto it = entries.cbegin(); it != entries_cend; ++it) {
+			if (it->type == DT_DIR) {
+				cout << "d " << std::setw(12) << "" << ' ' << std::setw(12) << "";
+			} else {
+				cout << "f 0x" << std::hex << std::uppercase << std::setfill('0')
+				     << std::setw(10) << it->offset
+				     << std::dec << std::nouppercase << std::setfill(' ')
+				     << ' ' << std::setw(12) << it->size;
+			}
+			cout << ' ' << it->path << '\n';
+		}
+		cout.flush();
+	}
+
+	const auto fstExtract_cend = fstExtract.cend();
+	for (auto it = fstExtract.cbegin(); it != fstExtract_cend; ++it) {
+		if (!it->outDir)
+			continue;
+
+		cerr << "-- " << rp_sprintf_p(C_("rpcli", "Extracting '%1$s' into '%2$s'"),
+			it->path, it->outDir) << endl;
+		int ret = extractor.extract(it->path, it->outDir);
+		if (ret == 0) {
+			cerr << "   " << rp_sprintf_p(C_("rpcli", "Done: %1$u file(s), %2$lld byte(s)"),
+				extractor.filesExtracted(),
+				static_cast<long long>(extractor.bytesExtracted())) << endl;
+		} else {
+			cerr << "   " << rp_sprintf(C_("rpcli", "Couldn't extract files: %s"), strerror(-ret)) << endl;
+		}
+	}
+}
+
+/**
+ * Hashes the ROM's contents
+ * @param romData RomData, or nullptr if the ROM isn't supported
+ * @param file ROM file (hashed if romData is nullptr)
+ */
+static void DoHash(RomData *romData, IRpFile *file)
+{
+	StreamHasher hasher;
+	cerr << "-- " << C_("rpcli", "Calculating hashes") << endl;
+	const int ret = (romData ? romData->hashContents(&hasher) : hasher.process(file));
+	if (ret != 0) {
+		cerr << "-- " << rp_sprintf(C_("rpcli", "Couldn't calculate hashes: %s"), strerror(-ret)) << endl;
+		return;
+	}
+
+	for (int i = 0; i < static_cast<int>(Hash::Algorithm::Max); i++) {
+		const Hash::Algorithm algorithm = static_cast<Hash::Algorithm>(i);
+		if (!hasher.hasHash(algorithm))
+			continue;
+		cout << std::left << std::setw(9) << (string(Hash::algorithmName(algorithm)) + ':')
+		     << std::right << hasher.getHashString(algorithm) << '\n';
+	}
+	cout.flush();
+}
+
 /**
  * Shows info about file
  * @param filename ROM filename
  * @param json Is program running in json mode?
+ * @param cbor Is program running in CBOR mode?
  * @param extract Vector of image extraction parameters
+ * @param fstList List the ROM's file system?
+ * @param fstExtract Vector of file system extraction parameters
+ * @param hash Calculate the ROM's hashes?
  * @param languageCode Language code. (0 for default)
  */
-static void DoFile(const char *filename, bool json, vector<ExtractParam>& extract, uint32_t languageCode = 0)
+static void DoFile(const char *filename, bool json, bool cbor, vector<ExtractParam>& extract,
+	bool fstList, const vector<FstExtractParam>& fstExtract, bool hash, uint32_t languageCode = 0)
 {
+	if (hash && (json || cbor)) {
+		cerr << "-- " << C_("rpcli", "Hashing is not available in JSON or CBOR mode") << endl;
+		hash = false;
+	}
+
 	cerr << "== " << rp_sprintf(C_("rpcli", "Reading file '%s'..."), filename) << endl;
 	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ);
 	if (file->isOpen()) {
 		RomData *romData = RomDataFactory::create(file);
 		if (romData && romData->isValid()) {
-			if (json) {
+			if (cbor) {
+				// NOTE: Records are written as a CBOR sequence,
+				// so no separators are needed.
+				cerr << "-- " << C_("rpcli", "Outputting CBOR data") << endl;
+				cout << CBORROMOutput(romData, languageCode);
+			} else if (json) {
 				cerr << "-- " << C_("rpcli", "Outputting JSON data") << endl;
 				cout << JSONROMOutput(romData, languageCode) << endl;
 			} else {
@@ -186,15 +303,29 @@ static void DoFile(const char *filename, bool json, vector<ExtractParam>& extrac
 			}
 
 			ExtractImages(romData, extract);
+			if (fstList && (json || cbor)) {
+				cerr << "-- " << C_("rpcli", "File system listing is not available in JSON or CBOR mode") << endl;
+				fstList = false;
+			}
+			DoFst(romData, fstList, fstExtract);
+			if (hash) {
+				DoHash(romData, file);
+			}
 		} else {
 			cerr << "-- " << C_("rpcli", "ROM is not supported") << endl;
-			if (json) cout << "{\"error\":\"rom is not supported\"}" << endl;
+			if (cbor) cout << CBORErrorOutput("rom is not supported");
+			else if (json) cout << "{\"error\":\"rom is not supported\"}" << endl;
+			else if (hash) {
+				// Hash the file as-is.
+				DoHash(nullptr, file);
+			}
 		}
 
 		UNREF(romData);
 	} else {
 		cerr << "-- " << rp_sprintf(C_("rpcli", "Couldn't open file: %s"), strerror(file->lastError())) << endl;
-		if (json) cout << "{\"error\":\"couldn't open file\",\"code\":" << file->lastError() << "}" << endl;
+		if (cbor) cout << CBORErrorOutput("couldn't open file", file->lastError());
+		else if (json) cout << "{\"error\":\"couldn't open file\",\"code\":" << file->lastError() << "}" << endl;
 	}
 	file->unref();
 }
@@ -344,17 +475,21 @@ int RP_C_API main(int argc, char *argv[])
 
 	if(argc < 2){
 #ifdef ENABLE_DECRYPTION
-		cerr << C_("rpcli", "Usage: rpcli [-k] [-c] [-p] [-j] [-l lang] [[-x[b]N outfile]... [-a apngoutfile] filename]...") << endl;
+		cerr << C_("rpcli", "Usage: rpcli [-k] [-c] [-p] [-j] [-b] [-l lang] [[-x[b]N outfile]... [-a apngoutfile] [-fl] [-fx path outdir]... [-h] filename]...") << endl;
 		cerr << "  -k:   " << C_("rpcli", "Verify encryption keys in keys.conf.") << endl;
 #else /* !ENABLE_DECRYPTION */
-		cerr << C_("rpcli", "Usage: rpcli [-c] [-p] [-j] [-l lang] [[-x[b]N outfile]... [-a apngoutfile] filename]...") << endl;
+		cerr << C_("rpcli", "Usage: rpcli [-c] [-p] [-j] [-b] [-l lang] [[-x[b]N outfile]... [-a apngoutfile] [-fl] [-fx path outdir]... [-h] filename]...") << endl;
 #endif /* ENABLE_DECRYPTION */
 		cerr << "  -c:   " << C_("rpcli", "Print system region information.") << endl;
 		cerr << "  -p:   " << C_("rpcli", "Print system path information.") << endl;
 		cerr << "  -j:   " << C_("rpcli", "Use JSON output format.") << endl;
+		cerr << "  -b:   " << C_("rpcli", "Use CBOR binary output format.") << endl;
 		cerr << "  -l:   " << C_("rpcli", "Retrieve the specified language from the ROM image.") << endl;
 		cerr << "  -xN:  " << C_("rpcli", "Extract image N to outfile in PNG format.") << endl;
 		cerr << "  -a:   " << C_("rpcli", "Extract the animated icon to outfile in APNG format.") << endl;
+		cerr << "  -fl:  " << C_("rpcli", "List the files in the ROM's file system.") << endl;
+		cerr << "  -fx:  " << C_("rpcli", "Extract a file or directory from the ROM's file system to outdir.") << endl;
+		cerr << "  -h:   " << C_("rpcli", "Calculate the CRC32, MD5, SHA-1, and SHA-256 hashes of the ROM's contents.") << endl;
 		cerr << endl;
 #ifdef RP_OS_SCSI_SUPPORTED
 		cerr << C_("rpcli", "Special options for devices:") << endl;
@@ -368,18 +503,37 @@ int RP_C_API main(int argc, char *argv[])
 		cerr << "\t " << C_("rpcli", "displays info about s3.gen") << endl;
 		cerr << "* rpcli -x0 icon.png pokeb2.nds" << endl;
 		cerr << "\t " << C_("rpcli", "extracts icon from pokeb2.nds") << endl;
+		cerr << "* rpcli -fx / outdir game.iso" << endl;
+		cerr << "\t " << C_("rpcli", "extracts all files from game.iso") << endl;
+		cerr << "* rpcli -h game.gcz" << endl;
+		cerr << "\t " << C_("rpcli", "calculates the hashes of the decompressed game.gcz") << endl;
 	}
 	
 	assert(RomData::IMG_INT_MIN == 0);
 	// DoFile parameters
 	bool json = false;
+	bool cbor = false;
 	vector<ExtractParam> extract;
+	bool fstList = false;
+	vector<FstExtractParam> fstExtract;
+	bool hash = false;
 
-	for (int i = 1; i < argc; i++) { // figure out the json mode in advance
+	for (int i = 1; i < argc; i++) { // figure out the json/cbor mode in advance
 		if (argv[i][0] == '-' && argv[i][1] == 'j') {
 			json = true;
+		} else if (argv[i][0] == '-' && argv[i][1] == 'b') {
+			cbor = true;
 		}
 	}
+	if (cbor) {
+		// CBOR output takes precedence over JSON output.
+		json = false;
+#ifdef _WIN32
+		// stdout must be in binary mode for CBOR output.
+		fflush(stdout);
+		_setmode(_fileno(stdout), _O_BINARY);
+#endif /* _WIN32 */
+	}
 	if (json) cout << "[\n";
 
 #ifdef RP_OS_SCSI_SUPPORTED
@@ -457,7 +611,33 @@ int RP_C_API main(int argc, char *argv[])
 			case 'a':
 				extract.emplace_back(ExtractParam(argv[++i], -1));
 				break;
+			case 'f':
+				// File system commands.
+				switch (argv[i][2]) {
+					case 'l':
+						// List the file system.
+						fstList = true;
+						break;
+					case 'x':
+						// Extract a file or directory.
+						if (i + 1 >= argc) {
+							cerr << C_("rpcli", "Warning: no path specified for '-fx'") << endl;
+							break;
+						}
+						fstExtract.emplace_back(FstExtractParam(argv[i+1], argv[i+2]));
+						i += 2;
+						break;
+					default:
+						cerr << rp_sprintf(C_("rpcli", "Warning: skipping unknown file system command '%c'"), argv[i][2]) << endl;
+						break;
+				}
+				break;
+			case 'h':
+				// Calculate hashes.
+				hash = true;
+				break;
 			case 'j': // do nothing
+			case 'b': // do nothing
 				break;
 #ifdef RP_OS_SCSI_SUPPORTED
 			case 'i':
@@ -508,7 +688,7 @@ int RP_C_API main(int argc, char *argv[])
 #endif /* RP_OS_SCSI_SUPPORTED */
 			{
 				// Regular file.
-				DoFile(argv[i], json, extract, languageCode);
+				DoFile(argv[i], json, cbor, extract, fstList, fstExtract, hash, languageCode);
 			}
 
 #ifdef RP_OS_SCSI_SUPPORTED
@@ -517,6 +697,9 @@ int RP_C_API main(int argc, char *argv[])
 			inq_ata_packet = false;
 #endif /* RP_OS_SCSI_SUPPORTED */
 			extract.clear();
+			fstList = false;
+			fstExtract.clear();
+			hash = false;
 		}
 	}
 	if (json) cout << "]\n";
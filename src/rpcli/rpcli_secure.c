@@ -26,6 +26,15 @@ int rpcli_do_security_options(void)
 		// TODO: Add more syscalls.
 		// FIXME: glibc-2.31 uses 64-bit time syscalls that may not be
 		// defined in earlier versions, including Ubuntu 14.04.
+
+		// NOTE: Special case for clone(). If it's the first syscall
+		// in the list, it has a parameter restriction added that
+		// ensures it can only be used to create threads.
+		SCMP_SYS(clone),	// FstExtractor writer threads
+		// Other multi-threading syscalls
+		SCMP_SYS(madvise), SCMP_SYS(sched_getaffinity),
+		SCMP_SYS(set_robust_list),
+
 		SCMP_SYS(close),
 		SCMP_SYS(dup),		// gzdopen()
 		SCMP_SYS(fcntl),     SCMP_SYS(fcntl64),		// gcc profiling
@@ -38,6 +47,7 @@ int rpcli_do_security_options(void)
 		SCMP_SYS(ioctl),	// for devices; also afl-fuzz
 		SCMP_SYS(lseek), SCMP_SYS(_llseek),
 		SCMP_SYS(lstat), SCMP_SYS(lstat64),	// LibRpBase::FileSystem::is_symlink(), resolve_symlink()
+		SCMP_SYS(mkdir),	// LibRpFile::FileSystem::rmkdir() [FstExtractor]
 		SCMP_SYS(mmap), SCMP_SYS(mmap2),
 		SCMP_SYS(mprotect),	// dlopen()
 		SCMP_SYS(munmap),